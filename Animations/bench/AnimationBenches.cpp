@@ -0,0 +1,140 @@
+#include "AnimationBenches.h"
+#include "Benchmark.h"
+
+#include "core.h"
+#include "animation/Animation.h"
+#include "animation/AnimationManager.h"
+
+#include <random>
+
+namespace MathAnim
+{
+	namespace AnimationBenches
+	{
+		// -------------------- Constants --------------------
+		static constexpr int sceneObjectCounts[] = { 100, 1'000, 10'000 };
+		static constexpr int sceneLengthFrames = 60 * 60;
+		// Every nth object is a root, the ones in between are its children
+		static constexpr int childrenPerRoot = 9;
+
+		// -------------------- Private functions --------------------
+		static AnimationManagerData* createScene(int numObjects, uint32 seed);
+
+		// -------------------- Benchmarks --------------------
+		static void resetToFrameSequential(Bench::BenchContext& ctx, int numObjects)
+		{
+			AnimationManagerData* am = createScene(numObjects, ctx.getSeed());
+			ctx.setCounter("objects", (double)numObjects);
+			ctx.setItemsPerIteration(1);
+
+			// Plays the scene back one frame at a time, which is what playback and exports do
+			uint32 frame = 0;
+			ctx.measure([&]()
+				{
+					AnimationManager::resetToFrame(am, frame);
+					frame = (frame + 1) % sceneLengthFrames;
+				});
+
+			AnimationManager::free(am);
+		}
+
+		static void resetToFrameRandom(Bench::BenchContext& ctx, int numObjects)
+		{
+			AnimationManagerData* am = createScene(numObjects, ctx.getSeed());
+			ctx.setCounter("objects", (double)numObjects);
+			ctx.setItemsPerIteration(1);
+
+			// Jumps all over the timeline, which is what scrubbing does
+			std::mt19937 rng(ctx.getSeed());
+			std::uniform_int_distribution<uint32> frameDist(0, sceneLengthFrames - 1);
+			std::vector<uint32> frames = {};
+			frames.resize(1024);
+			for (auto& frame : frames)
+			{
+				frame = frameDist(rng);
+			}
+
+			size_t frameIndex = 0;
+			ctx.measure([&]()
+				{
+					AnimationManager::resetToFrame(am, frames[frameIndex]);
+					frameIndex = (frameIndex + 1) % frames.size();
+				});
+
+			AnimationManager::free(am);
+		}
+
+		void registerBenchmarks()
+		{
+			for (int numObjects : sceneObjectCounts)
+			{
+				std::string suffix = "/objects:" + std::to_string(numObjects);
+				Bench::registerBenchmark("AnimationManager/resetToFrame/sequential" + suffix,
+					[numObjects](Bench::BenchContext& ctx) { resetToFrameSequential(ctx, numObjects); });
+				Bench::registerBenchmark("AnimationManager/resetToFrame/random" + suffix,
+					[numObjects](Bench::BenchContext& ctx) { resetToFrameRandom(ctx, numObjects); });
+			}
+		}
+
+		// -------------------- Private functions --------------------
+		static AnimationManagerData* createScene(int numObjects, uint32 seed)
+		{
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> posDist(-10.0f, 10.0f);
+			std::uniform_real_distribution<float> scaleDist(0.5f, 2.0f);
+			std::uniform_int_distribution<int> startDist(0, sceneLengthFrames - 120);
+			std::uniform_int_distribution<int> durationDist(15, 120);
+			std::uniform_int_distribution<int> colorDist(0, 255);
+
+			AnimationManagerData* am = AnimationManager::create();
+
+			std::vector<std::pair<AnimObjId, AnimId>> fillColorLinks = {};
+			AnimObjId rootId = NULL_ANIM_OBJECT;
+			for (int i = 0; i < numObjects; i++)
+			{
+				AnimObject obj = i % (childrenPerRoot + 1) == 0
+					? AnimObject::createDefault(am, AnimObjectTypeV1::Square)
+					: AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::Square, rootId);
+				if (i % (childrenPerRoot + 1) == 0)
+				{
+					rootId = obj.id;
+				}
+				obj.position = Vec3{ posDist(rng), posDist(rng), 0.0f };
+				AnimObjId objId = obj.id;
+				AnimationManager::addAnimObject(am, obj);
+
+				// A few animations per object, spread over the whole timeline. NOTE: Random values are
+				// drawn into locals since argument evaluation order isn't the same on every compiler
+				int moveToStart = startDist(rng);
+				int moveToDuration = durationDist(rng);
+				Animation moveTo = Animation::createDefault(AnimTypeV1::MoveTo, moveToStart, moveToDuration);
+				moveTo.as.moveTo.object = objId;
+				moveTo.as.moveTo.target = Vec3{ posDist(rng), posDist(rng), 0.0f };
+				AnimationManager::addAnimation(am, moveTo);
+
+				int scaleStart = startDist(rng);
+				int scaleDuration = durationDist(rng);
+				Animation scale = Animation::createDefault(AnimTypeV1::AnimateScale, scaleStart, scaleDuration);
+				scale.as.animateScale.object = objId;
+				scale.as.animateScale.target = Vec2{ scaleDist(rng), scaleDist(rng) };
+				AnimationManager::addAnimation(am, scale);
+
+				int fillColorStart = startDist(rng);
+				int fillColorDuration = durationDist(rng);
+				Animation fillColor = Animation::createDefault(AnimTypeV1::AnimateFillColor, fillColorStart, fillColorDuration);
+				fillColor.as.modifyU8Vec4.target = glm::u8vec4{ (uint8)colorDist(rng), (uint8)colorDist(rng), (uint8)colorDist(rng), 255 };
+				fillColorLinks.emplace_back(objId, fillColor.id);
+				AnimationManager::addAnimation(am, fillColor);
+			}
+
+			AnimationManager::endFrame(am);
+			for (const auto& [objId, animId] : fillColorLinks)
+			{
+				AnimationManager::addObjectToAnim(am, objId, animId);
+			}
+			AnimationManager::calculateAnimationKeyFrames(am);
+
+			return am;
+		}
+	}
+}
@@ -0,0 +1,12 @@
+#ifndef MATH_ANIM_ANIMATION_BENCHES_H
+#define MATH_ANIM_ANIMATION_BENCHES_H
+
+namespace MathAnim
+{
+	namespace AnimationBenches
+	{
+		void registerBenchmarks();
+	}
+}
+
+#endif
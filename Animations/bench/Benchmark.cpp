@@ -0,0 +1,246 @@
+#include "Benchmark.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+
+namespace MathAnim
+{
+	namespace Bench
+	{
+		struct RegisteredBenchmark
+		{
+			std::string name;
+			BenchFn fn;
+		};
+
+		// ------- Internal Variables -------
+		static std::vector<RegisteredBenchmark> benchmarks = {};
+
+		// ------- Internal Functions -------
+		static nlohmann::json resultToJson(const BenchResult& result);
+		static nlohmann::json getRunContext(const BenchSettings& settings);
+		static std::string formatNs(double ns);
+
+		BenchResult BenchContext::getResult(const std::string& name) const
+		{
+			BenchResult res = {};
+			res.name = name;
+			res.numSamples = (int)samplesNs.size();
+			res.numCalls = (int64)samplesNs.size() * batchSize;
+			res.counters = counters;
+			res.skipReason = skipReason;
+			if (samplesNs.size() == 0)
+			{
+				return res;
+			}
+
+			std::vector<double> sorted = samplesNs;
+			std::sort(sorted.begin(), sorted.end());
+
+			double sum = 0.0;
+			for (double sample : sorted)
+			{
+				sum += sample;
+			}
+			res.meanNs = sum / (double)sorted.size();
+			res.minNs = sorted.front();
+			res.maxNs = sorted.back();
+			res.medianNs = sorted.size() % 2 == 0
+				? (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2.0
+				: sorted[sorted.size() / 2];
+
+			double variance = 0.0;
+			for (double sample : sorted)
+			{
+				variance += (sample - res.meanNs) * (sample - res.meanNs);
+			}
+			res.stddevNs = sorted.size() > 1
+				? glm::sqrt(variance / (double)(sorted.size() - 1))
+				: 0.0;
+
+			if (res.meanNs > 0.0)
+			{
+				res.itemsPerSecond = (double)itemsPerIteration * 1'000'000'000.0 / res.meanNs;
+				res.bytesPerSecond = (double)bytesPerIteration * 1'000'000'000.0 / res.meanNs;
+			}
+
+			return res;
+		}
+
+		void registerBenchmark(const std::string& name, BenchFn fn)
+		{
+			for (const auto& benchmark : benchmarks)
+			{
+				g_logger_assert(benchmark.name != name, "Benchmark '{}' was registered twice.", name);
+			}
+
+			benchmarks.push_back({ name, fn });
+		}
+
+		void listBenchmarks()
+		{
+			for (const auto& benchmark : benchmarks)
+			{
+				CppUtils::IO::printf("{}\n", benchmark.name);
+			}
+		}
+
+		int runBenchmarks(const BenchSettings& settings, const char* filter, const char* jsonOutputFile)
+		{
+			nlohmann::json output = nlohmann::json();
+			output["context"] = getRunContext(settings);
+			output["benchmarks"] = nlohmann::json::array();
+
+			int numFailed = 0;
+			CppUtils::IO::printf("{ :<64} { :>12} { :>12} { :>12} { :>10}\n", "Benchmark", "Median", "Mean", "StdDev", "Samples");
+			for (const auto& benchmark : benchmarks)
+			{
+				if (filter && benchmark.name.find(filter) == std::string::npos)
+				{
+					continue;
+				}
+
+				BenchContext ctx = BenchContext(settings);
+				benchmark.fn(ctx);
+				BenchResult result = ctx.getResult(benchmark.name);
+
+				if (result.skipReason != "")
+				{
+					CppUtils::IO::printf("{ :<64} skipped: {}\n", result.name, result.skipReason);
+				}
+				else if (result.numSamples == 0)
+				{
+					CppUtils::IO::printf("{ :<64} FAILED: no samples were measured\n", result.name);
+					numFailed++;
+				}
+				else
+				{
+					CppUtils::IO::printf("{ :<64} { :>12} { :>12} { :>12} { :>10}\n",
+						result.name,
+						formatNs(result.medianNs),
+						formatNs(result.meanNs),
+						formatNs(result.stddevNs),
+						std::to_string(result.numSamples)
+					);
+				}
+
+				output["benchmarks"].push_back(resultToJson(result));
+			}
+
+			if (jsonOutputFile)
+			{
+				std::ofstream file(jsonOutputFile);
+				if (!file.is_open())
+				{
+					g_logger_error("Failed to open '{}' to write benchmark results.", jsonOutputFile);
+					return numFailed + 1;
+				}
+
+				file << output.dump(2) << std::endl;
+				g_logger_info("Wrote benchmark results to '{}'.", jsonOutputFile);
+			}
+
+			return numFailed;
+		}
+
+		void free()
+		{
+			benchmarks.clear();
+		}
+
+		// ------- Internal Functions -------
+		static nlohmann::json resultToJson(const BenchResult& result)
+		{
+			nlohmann::json res = nlohmann::json();
+			res["name"] = result.name;
+			if (result.skipReason != "")
+			{
+				res["skipped"] = result.skipReason;
+				return res;
+			}
+
+			res["samples"] = result.numSamples;
+			res["calls"] = result.numCalls;
+			res["meanNs"] = result.meanNs;
+			res["medianNs"] = result.medianNs;
+			res["minNs"] = result.minNs;
+			res["maxNs"] = result.maxNs;
+			res["stddevNs"] = result.stddevNs;
+			if (result.itemsPerSecond > 0.0)
+			{
+				res["itemsPerSecond"] = result.itemsPerSecond;
+			}
+			if (result.bytesPerSecond > 0.0)
+			{
+				res["bytesPerSecond"] = result.bytesPerSecond;
+			}
+
+			res["counters"] = nlohmann::json::object();
+			for (const auto& [name, value] : result.counters)
+			{
+				res["counters"][name] = value;
+			}
+
+			return res;
+		}
+
+		static nlohmann::json getRunContext(const BenchSettings& settings)
+		{
+			nlohmann::json res = nlohmann::json();
+
+			char dateBuffer[64];
+			std::time_t now = std::time(nullptr);
+			std::strftime(dateBuffer, sizeof(dateBuffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+			res["date"] = dateBuffer;
+
+#if defined(_DEBUG)
+			res["buildType"] = "Debug";
+#elif defined(_PROFILER)
+			res["buildType"] = "RelWithProfiler";
+#else
+			res["buildType"] = "Release";
+#endif
+
+#if defined(_MSC_VER)
+			res["compiler"] = "MSVC " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+			res["compiler"] = std::string("Clang ") + __clang_version__;
+#elif defined(__GNUC__)
+			res["compiler"] = std::string("GCC ") + __VERSION__;
+#endif
+
+			res["hardwareThreads"] = std::thread::hardware_concurrency();
+			res["seed"] = settings.seed;
+			res["minTimeSeconds"] = settings.minTimeSeconds;
+			res["minSamples"] = settings.minSamples;
+			res["maxSamples"] = settings.maxSamples;
+
+			return res;
+		}
+
+		static std::string formatNs(double ns)
+		{
+			char buffer[32];
+			if (ns >= 1'000'000'000.0)
+			{
+				snprintf(buffer, sizeof(buffer), "%.3fs", ns / 1'000'000'000.0);
+			}
+			else if (ns >= 1'000'000.0)
+			{
+				snprintf(buffer, sizeof(buffer), "%.3fms", ns / 1'000'000.0);
+			}
+			else if (ns >= 1'000.0)
+			{
+				snprintf(buffer, sizeof(buffer), "%.3fus", ns / 1'000.0);
+			}
+			else
+			{
+				snprintf(buffer, sizeof(buffer), "%.1fns", ns);
+			}
+
+			return std::string(buffer);
+		}
+	}
+}
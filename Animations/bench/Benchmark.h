@@ -0,0 +1,139 @@
+#ifndef MATH_ANIM_BENCHMARK_H
+#define MATH_ANIM_BENCHMARK_H
+#include "core.h"
+
+#include <chrono>
+#include <functional>
+
+namespace MathAnim
+{
+	namespace Bench
+	{
+		// Every benchmark seeds its random number generators with this (or --seed) so
+		// two runs always operate on the exact same synthetic data
+		constexpr uint32 DEFAULT_SEED = 0x4D415448;
+
+		struct BenchResult
+		{
+			std::string name;
+			int numSamples;
+			int64 numCalls;
+			double meanNs;
+			double medianNs;
+			double minNs;
+			double maxNs;
+			double stddevNs;
+			// Zero if the benchmark didn't set items/bytes per iteration
+			double itemsPerSecond;
+			double bytesPerSecond;
+			std::unordered_map<std::string, double> counters;
+			std::string skipReason;
+		};
+
+		struct BenchSettings
+		{
+			// Keep sampling until this much time has been spent timing a benchmark...
+			double minTimeSeconds = 0.5;
+			// ...and until at least this many samples are collected
+			int minSamples = 5;
+			int maxSamples = 10'000;
+			uint32 seed = DEFAULT_SEED;
+		};
+
+		class BenchContext
+		{
+		public:
+			BenchContext(const BenchSettings& settings)
+				: settings(settings), samplesNs(), batchSize(1), itemsPerIteration(0), bytesPerIteration(0),
+				counters(), skipReason(), measured(false)
+			{
+			}
+
+			// Times `fn`. It gets called repeatedly until enough samples have been collected, so
+			// anything done outside of measure is untimed setup or teardown. Very fast functions
+			// get called in batches so the clock overhead doesn't dominate each sample.
+			template<typename Fn>
+			void measure(Fn&& fn)
+			{
+				g_logger_assert(!measured, "Benchmarks can only call measure once.");
+				measured = true;
+
+				// Warm up caches, and figure out how many calls we need per sample
+				constexpr double minBatchNs = 10'000.0;
+				constexpr int64 maxBatchSize = 1 << 20;
+				while (true)
+				{
+					double ns = timeBatch(fn, batchSize);
+					if (ns >= minBatchNs || batchSize >= maxBatchSize)
+					{
+						break;
+					}
+					batchSize *= 2;
+				}
+
+				double totalNs = 0.0;
+				const double minTimeNs = settings.minTimeSeconds * 1'000'000'000.0;
+				while (((int)samplesNs.size() < settings.minSamples || totalNs < minTimeNs) &&
+					(int)samplesNs.size() < settings.maxSamples)
+				{
+					double ns = timeBatch(fn, batchSize);
+					totalNs += ns;
+					samplesNs.push_back(ns / (double)batchSize);
+				}
+			}
+
+			// Used to report throughput, these describe the work done by a single call to the measured function
+			inline void setItemsPerIteration(int64 items) { itemsPerIteration = items; }
+			inline void setBytesPerIteration(int64 bytes) { bytesPerIteration = bytes; }
+
+			// Extra values that show up in the JSON results, like the size of the generated data
+			inline void setCounter(const std::string& name, double value) { counters[name] = value; }
+
+			// Marks the benchmark as skipped. Skipped benchmarks still show up in the results.
+			inline void skip(const std::string& reason) { skipReason = reason; }
+
+			inline uint32 getSeed() const { return settings.seed; }
+
+			BenchResult getResult(const std::string& name) const;
+
+		private:
+			template<typename Fn>
+			static double timeBatch(Fn& fn, int64 numCalls)
+			{
+				auto start = std::chrono::steady_clock::now();
+				for (int64 i = 0; i < numCalls; i++)
+				{
+					fn();
+				}
+				auto end = std::chrono::steady_clock::now();
+				return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+			}
+
+		private:
+			const BenchSettings& settings;
+			// Time per call for each sample
+			std::vector<double> samplesNs;
+			int64 batchSize;
+			int64 itemsPerIteration;
+			int64 bytesPerIteration;
+			std::unordered_map<std::string, double> counters;
+			std::string skipReason;
+			bool measured;
+		};
+
+		typedef std::function<void(BenchContext&)> BenchFn;
+
+		// Names are '/' separated, like "AnimationManager/resetToFrame/objects:1000"
+		void registerBenchmark(const std::string& name, BenchFn fn);
+
+		void listBenchmarks();
+
+		// Runs every benchmark whose name contains `filter` (or all of them if it's null) and writes
+		// the results as JSON to `jsonOutputFile` if it's not null. Returns the number of benchmarks that failed.
+		int runBenchmarks(const BenchSettings& settings, const char* filter, const char* jsonOutputFile);
+
+		void free();
+	}
+}
+
+#endif
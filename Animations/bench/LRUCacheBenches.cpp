@@ -0,0 +1,85 @@
+#include "LRUCacheBenches.h"
+#include "Benchmark.h"
+
+#include "core.h"
+#include "utils/LRUCache.hpp"
+#include "svg/SvgCache.h"
+
+#include <random>
+
+namespace MathAnim
+{
+	namespace LRUCacheBenches
+	{
+		// -------------------- Constants --------------------
+		static constexpr size_t cacheCapacity = 1'024;
+		static constexpr uint64 numKeys = cacheCapacity * 4;
+		static constexpr size_t numAccesses = 1 << 16;
+
+		// -------------------- Private functions --------------------
+		static std::vector<uint64> generateAccesses(uint32 seed, float hotKeyChance);
+
+		// -------------------- Benchmarks --------------------
+		// Same workload SvgCache puts on it: look up an entry, and on a miss evict the
+		// oldest entry once the cache is full before inserting the new one
+		static void churn(Bench::BenchContext& ctx, float hotKeyChance)
+		{
+			std::vector<uint64> accesses = generateAccesses(ctx.getSeed(), hotKeyChance);
+			LRUCache<uint64, _SvgCacheEntryInternal> cache = {};
+			ctx.setItemsPerIteration(1);
+
+			size_t accessIndex = 0;
+			uint64 numHits = 0;
+			uint64 numMisses = 0;
+			ctx.measure([&]()
+				{
+					uint64 key = accesses[accessIndex];
+					accessIndex = (accessIndex + 1) % accesses.size();
+
+					if (cache.get(key).has_value())
+					{
+						numHits++;
+						return;
+					}
+
+					numMisses++;
+					if (cache.size() >= cacheCapacity)
+					{
+						cache.evict(cache.getOldest()->key);
+					}
+					cache.insert(key, _SvgCacheEntryInternal{});
+				});
+
+			ctx.setCounter("hitRate", (double)numHits / (double)(numHits + numMisses));
+			cache.clear();
+		}
+
+		void registerBenchmarks()
+		{
+			Bench::registerBenchmark("LRUCache/churn/uniform",
+				[](Bench::BenchContext& ctx) { churn(ctx, 0.0f); });
+			Bench::registerBenchmark("LRUCache/churn/hotKeys",
+				[](Bench::BenchContext& ctx) { churn(ctx, 0.9f); });
+		}
+
+		// -------------------- Private functions --------------------
+		static std::vector<uint64> generateAccesses(uint32 seed, float hotKeyChance)
+		{
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> chanceDist(0.0f, 1.0f);
+			std::uniform_int_distribution<uint64> keyDist(0, numKeys - 1);
+			// A small set of keys that gets hit most of the time, like the glyphs in a block of text
+			std::uniform_int_distribution<uint64> hotKeyDist(0, cacheCapacity / 8 - 1);
+
+			std::vector<uint64> res = {};
+			res.reserve(numAccesses);
+			for (size_t i = 0; i < numAccesses; i++)
+			{
+				bool hot = chanceDist(rng) < hotKeyChance;
+				res.push_back(hot ? hotKeyDist(rng) : keyDist(rng));
+			}
+
+			return res;
+		}
+	}
+}
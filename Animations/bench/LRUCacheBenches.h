@@ -0,0 +1,12 @@
+#ifndef MATH_ANIM_LRU_CACHE_BENCHES_H
+#define MATH_ANIM_LRU_CACHE_BENCHES_H
+
+namespace MathAnim
+{
+	namespace LRUCacheBenches
+	{
+		void registerBenchmarks();
+	}
+}
+
+#endif
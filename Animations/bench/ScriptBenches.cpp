@@ -0,0 +1,144 @@
+#include "ScriptBenches.h"
+#include "Benchmark.h"
+
+#include "core.h"
+#include "scripting/LuauLayer.h"
+#include "animation/AnimationManager.h"
+
+namespace MathAnim
+{
+	namespace ScriptBenches
+	{
+		// -------------------- Constants --------------------
+		static constexpr const char* benchScriptName = "benchScript.luau";
+
+		// Pure number crunching, so the timings are all VM (or native code) and no time is spent in the
+		// math-anim API
+		static constexpr const char* computeScript = R"(
+local function mandelbrot(width: number, height: number, maxIterations: number): number
+	local inside = 0
+	for py = 0, height - 1 do
+		for px = 0, width - 1 do
+			local x0 = (px / width) * 3.5 - 2.5
+			local y0 = (py / height) * 2.0 - 1.0
+			local x, y = 0, 0
+			local iteration = 0
+			while x * x + y * y <= 4 and iteration < maxIterations do
+				x, y = x * x - y * y + x0, 2 * x * y + y0
+				iteration += 1
+			end
+			if iteration == maxIterations then
+				inside += 1
+			end
+		end
+	end
+	return inside
+end
+
+mandelbrot(64, 64, 64)
+)";
+
+		// -------------------- Private functions --------------------
+		static std::filesystem::path getBenchProjectDirectory();
+
+		// -------------------- Benchmarks --------------------
+		static void executeScript(Bench::BenchContext& ctx, bool native)
+		{
+			std::filesystem::path projectDirectory = getBenchProjectDirectory();
+			AnimationManagerData* am = AnimationManager::create();
+			LuauLayer::init(projectDirectory / "scripts", projectDirectory / "cache", am);
+
+			// Native mode has to be on before compiling, it changes the optimization level
+			LuauLayer::setNativeCodeGenEnabled(native && LuauLayer::isNativeCodeGenSupported());
+
+			if (native && !LuauLayer::isNativeCodeGenSupported())
+			{
+				ctx.skip("Native script compilation is not supported on this platform.");
+			}
+			else if (!LuauLayer::compile(computeScript, benchScriptName))
+			{
+				ctx.skip("Failed to compile the benchmark script.");
+			}
+			else
+			{
+				ctx.setItemsPerIteration(1);
+
+				bool failed = false;
+				ctx.measure([&]()
+					{
+						failed = !LuauLayer::execute(benchScriptName) || failed;
+					});
+
+				if (failed)
+				{
+					ctx.skip("Failed to execute the benchmark script.");
+				}
+			}
+
+			LuauLayer::free();
+			AnimationManager::free(am);
+			std::filesystem::remove_all(projectDirectory);
+		}
+
+		// Compiling a changed script (analysis + compilation) against an unchanged script that gets analyzed
+		// and then loaded straight from the bytecode cache, which is what happens for most scripts on launch
+		static void compileScript(Bench::BenchContext& ctx, bool cached)
+		{
+			std::filesystem::path projectDirectory = getBenchProjectDirectory();
+			AnimationManagerData* am = AnimationManager::create();
+			LuauLayer::init(projectDirectory / "scripts", projectDirectory / "cache", am);
+
+			std::string source = computeScript;
+			if (!LuauLayer::compile(source, benchScriptName))
+			{
+				ctx.skip("Failed to compile the benchmark script.");
+			}
+			else
+			{
+				ctx.setItemsPerIteration(1);
+
+				bool failed = false;
+				uint64 version = 0;
+				ctx.measure([&]()
+					{
+						if (!cached)
+						{
+							// Any change to the source misses the cache
+							source = std::string(computeScript) + "-- " + std::to_string(version++) + "\n";
+						}
+						failed = !LuauLayer::compile(source, benchScriptName) || failed;
+					});
+
+				if (failed)
+				{
+					ctx.skip("Failed to compile the benchmark script.");
+				}
+			}
+
+			LuauLayer::free();
+			AnimationManager::free(am);
+			std::filesystem::remove_all(projectDirectory);
+		}
+
+		void registerBenchmarks()
+		{
+			Bench::registerBenchmark("LuauLayer/execute/interpreted",
+				[](Bench::BenchContext& ctx) { executeScript(ctx, false); });
+			Bench::registerBenchmark("LuauLayer/execute/native",
+				[](Bench::BenchContext& ctx) { executeScript(ctx, true); });
+			Bench::registerBenchmark("LuauLayer/compile/changed",
+				[](Bench::BenchContext& ctx) { compileScript(ctx, false); });
+			Bench::registerBenchmark("LuauLayer/compile/cached",
+				[](Bench::BenchContext& ctx) { compileScript(ctx, true); });
+		}
+
+		// -------------------- Private functions --------------------
+		static std::filesystem::path getBenchProjectDirectory()
+		{
+			// Start from an empty directory every time so a previous run can't warm up the bytecode cache
+			std::filesystem::path res = std::filesystem::temp_directory_path() / "mathAnimBenchScripts";
+			std::filesystem::remove_all(res);
+			return res;
+		}
+	}
+}
@@ -0,0 +1,12 @@
+#ifndef MATH_ANIM_SCRIPT_BENCHES_H
+#define MATH_ANIM_SCRIPT_BENCHES_H
+
+namespace MathAnim
+{
+	namespace ScriptBenches
+	{
+		void registerBenchmarks();
+	}
+}
+
+#endif
@@ -0,0 +1,226 @@
+#include "SvgBenches.h"
+#include "Benchmark.h"
+
+#include "core.h"
+#include "svg/Svg.h"
+#include "svg/SvgParser.h"
+
+#include <random>
+#include <fstream>
+
+namespace MathAnim
+{
+	namespace SvgBenches
+	{
+		// -------------------- Constants --------------------
+		static constexpr int interpolateCurveCounts[] = { 16, 256, 4'096 };
+		static constexpr int numGlyphDefinitions = 64;
+		static constexpr int numGlyphUses = 1'000;
+
+		// -------------------- Private functions --------------------
+		static std::string generatePathText(std::mt19937& rng, int numPaths, int curvesPerPath);
+		static std::string generateSvgDoc(std::mt19937& rng);
+		static SvgObject* parsePath(const std::string& pathText);
+
+		// -------------------- Benchmarks --------------------
+		static void interpolate(Bench::BenchContext& ctx, int numCurves)
+		{
+			std::mt19937 rng(ctx.getSeed());
+			// Mismatched path and curve counts so interpolate has to split things up the way
+			// replacement transforms between different shapes do
+			SvgObject* src = parsePath(generatePathText(rng, 4, numCurves / 4));
+			SvgObject* dst = parsePath(generatePathText(rng, 3, numCurves / 2));
+			ctx.setCounter("srcCurves", (double)numCurves);
+			ctx.setCounter("dstCurves", (double)((numCurves / 2) * 3));
+			ctx.setItemsPerIteration(1);
+
+			float t = 0.0f;
+			ctx.measure([&]()
+				{
+					SvgObject* interpolated = Svg::interpolate(src, dst, t);
+					interpolated->free();
+					g_memory_free(interpolated);
+					t = t >= 1.0f ? 0.0f : t + 1.0f / 60.0f;
+				});
+
+			src->free();
+			g_memory_free(src);
+			dst->free();
+			g_memory_free(dst);
+		}
+
+		// What ReplacementTransform does every frame, the morph is built once up front
+		static void interpolateInto(Bench::BenchContext& ctx, int numCurves)
+		{
+			std::mt19937 rng(ctx.getSeed());
+			SvgObject* src = parsePath(generatePathText(rng, 4, numCurves / 4));
+			SvgObject* dst = parsePath(generatePathText(rng, 3, numCurves / 2));
+			ctx.setCounter("srcCurves", (double)numCurves);
+			ctx.setCounter("dstCurves", (double)((numCurves / 2) * 3));
+			ctx.setItemsPerIteration(1);
+
+			SvgMorph morph = Svg::createMorph(src, dst);
+			SvgObject interpolated = Svg::createDefault();
+			float t = 0.0f;
+			ctx.measure([&]()
+				{
+					Svg::interpolateInto(morph, t, &interpolated);
+					t = t >= 1.0f ? 0.0f : t + 1.0f / 60.0f;
+				});
+
+			interpolated.free();
+			morph.free();
+			src->free();
+			g_memory_free(src);
+			dst->free();
+			g_memory_free(dst);
+		}
+
+		static void parseSvgPath(Bench::BenchContext& ctx)
+		{
+			std::mt19937 rng(ctx.getSeed());
+			std::string pathText = generatePathText(rng, 16, 256);
+			ctx.setBytesPerIteration((int64)pathText.length());
+
+			ctx.measure([&]()
+				{
+					SvgObject obj = Svg::createDefault();
+					SvgParser::parseSvgPath(pathText.c_str(), pathText.length(), &obj);
+					obj.free();
+				});
+		}
+
+		static void parseSvgDoc(Bench::BenchContext& ctx)
+		{
+			std::mt19937 rng(ctx.getSeed());
+			std::string doc = generateSvgDoc(rng);
+
+			std::filesystem::path filepath = std::filesystem::temp_directory_path() / "mathAnimBenchDoc.svg";
+			{
+				std::ofstream file(filepath);
+				file << doc;
+			}
+			std::string filepathStr = filepath.string();
+			ctx.setBytesPerIteration((int64)doc.length());
+			ctx.setCounter("uses", (double)numGlyphUses);
+
+			// Reads the file every iteration, same as SvgFileObject and LaTeX objects do
+			ctx.measure([&]()
+				{
+					SvgGroup* group = SvgParser::parseSvgDoc(filepathStr.c_str());
+					if (group)
+					{
+						group->free();
+						g_memory_free(group);
+					}
+				});
+
+			std::filesystem::remove(filepath);
+		}
+
+		void registerBenchmarks()
+		{
+			for (int numCurves : interpolateCurveCounts)
+			{
+				Bench::registerBenchmark("Svg/interpolate/curves:" + std::to_string(numCurves),
+					[numCurves](Bench::BenchContext& ctx) { interpolate(ctx, numCurves); });
+				Bench::registerBenchmark("Svg/interpolateInto/curves:" + std::to_string(numCurves),
+					[numCurves](Bench::BenchContext& ctx) { interpolateInto(ctx, numCurves); });
+			}
+			Bench::registerBenchmark("SvgParser/parseSvgPath", parseSvgPath);
+			Bench::registerBenchmark("SvgParser/parseSvgDoc", parseSvgDoc);
+		}
+
+		// -------------------- Private functions --------------------
+		static std::string generatePathText(std::mt19937& rng, int numPaths, int curvesPerPath)
+		{
+			std::uniform_real_distribution<float> pointDist(-50.0f, 50.0f);
+			std::uniform_int_distribution<int> curveTypeDist(0, 2);
+
+			std::string res = "";
+			char buffer[128];
+			for (int path = 0; path < numPaths; path++)
+			{
+				float x = pointDist(rng);
+				float y = pointDist(rng);
+				snprintf(buffer, sizeof(buffer), "M%.3f %.3f ", x, y);
+				res += buffer;
+				for (int curve = 0; curve < curvesPerPath; curve++)
+				{
+					// Mix of lines, quadratic and cubic beziers, like glyph outlines
+					int curveType = curveTypeDist(rng);
+					if (curveType == 0)
+					{
+						float x0 = pointDist(rng);
+						float y0 = pointDist(rng);
+						snprintf(buffer, sizeof(buffer), "L%.3f %.3f ", x0, y0);
+					}
+					else if (curveType == 1)
+					{
+						float x0 = pointDist(rng);
+						float y0 = pointDist(rng);
+						float x1 = pointDist(rng);
+						float y1 = pointDist(rng);
+						snprintf(buffer, sizeof(buffer), "Q%.3f %.3f %.3f %.3f ", x0, y0, x1, y1);
+					}
+					else
+					{
+						float x0 = pointDist(rng);
+						float y0 = pointDist(rng);
+						float x1 = pointDist(rng);
+						float y1 = pointDist(rng);
+						float x2 = pointDist(rng);
+						float y2 = pointDist(rng);
+						snprintf(buffer, sizeof(buffer), "C%.3f %.3f %.3f %.3f %.3f %.3f ", x0, y0, x1, y1, x2, y2);
+					}
+					res += buffer;
+				}
+				res += "Z ";
+			}
+
+			return res;
+		}
+
+		static std::string generateSvgDoc(std::mt19937& rng)
+		{
+			// Same layout dvisvgm generates for LaTeX: glyph paths in <defs>, positioned with <use>'s
+			std::uniform_real_distribution<float> offsetDist(0.0f, 500.0f);
+			std::uniform_int_distribution<int> glyphDist(0, numGlyphDefinitions - 1);
+
+			std::string res = "<?xml version='1.0' encoding='UTF-8'?>\n";
+			res += "<svg version='1.1' xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' viewBox='0 0 500 500'>\n";
+			res += "<defs>\n";
+			for (int i = 0; i < numGlyphDefinitions; i++)
+			{
+				res += "<path id='g0-" + std::to_string(i) + "' d='" + generatePathText(rng, 2, 24) + "'/>\n";
+			}
+			res += "</defs>\n";
+
+			res += "<g id='page1'>\n";
+			char buffer[128];
+			for (int i = 0; i < numGlyphUses; i++)
+			{
+				int glyph = glyphDist(rng);
+				float x = offsetDist(rng);
+				float y = offsetDist(rng);
+				snprintf(buffer, sizeof(buffer), "<use x='%.3f' y='%.3f' xlink:href='#g0-%d'/>\n", x, y, glyph);
+				res += buffer;
+			}
+			res += "</g>\n";
+			res += "</svg>\n";
+
+			return res;
+		}
+
+		static SvgObject* parsePath(const std::string& pathText)
+		{
+			SvgObject* res = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+			*res = Svg::createDefault();
+			if (!SvgParser::parseSvgPath(pathText.c_str(), pathText.length(), res))
+			{
+				g_logger_error("Failed to parse generated benchmark path: '{}'", SvgParser::getLastError());
+			}
+			return res;
+		}
+	}
+}
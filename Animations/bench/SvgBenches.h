@@ -0,0 +1,12 @@
+#ifndef MATH_ANIM_SVG_BENCHES_H
+#define MATH_ANIM_SVG_BENCHES_H
+
+namespace MathAnim
+{
+	namespace SvgBenches
+	{
+		void registerBenchmarks();
+	}
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include "TextBenches.h"
+#include "Benchmark.h"
+
+#include "core.h"
+#include "platform/Platform.h"
+#include "renderer/Fonts.h"
+#include "parsers/SyntaxHighlighter.h"
+#include "parsers/SyntaxTheme.h"
+
+#include <random>
+#include <algorithm>
+
+namespace MathAnim
+{
+	namespace TextBenches
+	{
+		// -------------------- Constants --------------------
+		static const char* benchFontFilepath = "./assets/fonts/fira/FiraCode-Regular.ttf";
+		static constexpr int sourceFileLineCounts[] = { 1'000, 10'000 };
+
+		// -------------------- Private functions --------------------
+		static std::string generateCppSource(std::mt19937& rng, int numLines);
+		static std::string generateJsSource(std::mt19937& rng, int numLines);
+
+		// -------------------- Benchmarks --------------------
+		static void loadFont(Bench::BenchContext& ctx)
+		{
+			if (!Platform::fileExists(benchFontFilepath))
+			{
+				ctx.skip(std::string("Missing font '") + benchFontFilepath + "', run from the repository root.");
+				return;
+			}
+
+			uint32 numGlyphs = CharRange::Ascii.lastCharCode - CharRange::Ascii.firstCharCode + 1;
+			ctx.setItemsPerIteration((int64)numGlyphs);
+
+			// Cold load, the font gets fully unloaded every iteration
+			ctx.measure([&]()
+				{
+					Font* font = Fonts::loadFont(benchFontFilepath, CharRange::Ascii);
+					Fonts::unloadFont(font);
+				});
+		}
+
+		static void createOutline(Bench::BenchContext& ctx)
+		{
+			if (!Platform::fileExists(benchFontFilepath))
+			{
+				ctx.skip(std::string("Missing font '") + benchFontFilepath + "', run from the repository root.");
+				return;
+			}
+
+			Font* font = Fonts::loadFont(benchFontFilepath, CharRange{ 'a', 'a' });
+			ctx.setItemsPerIteration(1);
+
+			uint32 codepoint = CharRange::Ascii.firstCharCode;
+			ctx.measure([&]()
+				{
+					GlyphOutline outline = {};
+					if (Fonts::createOutline(font, codepoint, &outline) == 0)
+					{
+						outline.free();
+					}
+					codepoint = codepoint >= CharRange::Ascii.lastCharCode
+						? CharRange::Ascii.firstCharCode
+						: codepoint + 1;
+				});
+
+			Fonts::unloadFont(font);
+		}
+
+		static void highlightSource(Bench::BenchContext& ctx, HighlighterLanguage language, int numLines)
+		{
+			const SyntaxHighlighter* highlighter = Highlighters::getHighlighter(language);
+			const SyntaxTheme* theme = Highlighters::getTheme(HighlighterTheme::OneDark);
+			if (!highlighter || !theme)
+			{
+				ctx.skip("Missing grammars or themes, run from the repository root after building.");
+				return;
+			}
+
+			std::mt19937 rng(ctx.getSeed());
+			std::string source = language == HighlighterLanguage::Cpp
+				? generateCppSource(rng, numLines)
+				: generateJsSource(rng, numLines);
+			ctx.setBytesPerIteration((int64)source.length());
+			ctx.setCounter("lines", (double)std::count(source.begin(), source.end(), '\n'));
+
+			ctx.measure([&]()
+				{
+					highlighter->parse(source.c_str(), source.length(), *theme);
+				});
+		}
+
+		static void highlightInsert(Bench::BenchContext& ctx)
+		{
+			const SyntaxHighlighter* highlighter = Highlighters::getHighlighter(HighlighterLanguage::Cpp);
+			const SyntaxTheme* theme = Highlighters::getTheme(HighlighterTheme::OneDark);
+			if (!highlighter || !theme)
+			{
+				ctx.skip("Missing grammars or themes, run from the repository root after building.");
+				return;
+			}
+
+			std::mt19937 rng(ctx.getSeed());
+			std::string source = generateCppSource(rng, 10'000);
+			CodeHighlights highlights = highlighter->parse(source.c_str(), source.length(), *theme);
+
+			// Typing a character in the middle of a big file, then deleting it again
+			const std::string original = source;
+			size_t insertPos = source.find('\n', source.length() / 2) + 1;
+			std::string inserted = source;
+			inserted.insert(insertPos, "x");
+			ctx.setCounter("lines", (double)std::count(source.begin(), source.end(), '\n'));
+
+			bool insert = true;
+			ctx.measure([&]()
+				{
+					if (insert)
+					{
+						highlighter->insertText(highlights, inserted.c_str(), inserted.length(), insertPos, insertPos + 1);
+					}
+					else
+					{
+						highlighter->removeText(highlights, original.c_str(), original.length(), insertPos, 0);
+					}
+					insert = !insert;
+				});
+		}
+
+		void registerBenchmarks()
+		{
+			Bench::registerBenchmark("Fonts/loadFont/ascii", loadFont);
+			Bench::registerBenchmark("Fonts/createOutline", createOutline);
+
+			for (int numLines : sourceFileLineCounts)
+			{
+				std::string suffix = "/lines:" + std::to_string(numLines);
+				Bench::registerBenchmark("SyntaxHighlighter/parse/cpp" + suffix,
+					[numLines](Bench::BenchContext& ctx) { highlightSource(ctx, HighlighterLanguage::Cpp, numLines); });
+				Bench::registerBenchmark("SyntaxHighlighter/parse/javascript" + suffix,
+					[numLines](Bench::BenchContext& ctx) { highlightSource(ctx, HighlighterLanguage::Javascript, numLines); });
+			}
+			Bench::registerBenchmark("SyntaxHighlighter/insertText/cpp/lines:10000", highlightInsert);
+		}
+
+		// -------------------- Private functions --------------------
+		static std::string generateCppSource(std::mt19937& rng, int numLines)
+		{
+			static const char* types[] = { "int", "float", "uint32", "std::string", "Vec3", "const char*" };
+			std::uniform_int_distribution<int> typeDist(0, (int)(sizeof(types) / sizeof(types[0])) - 1);
+			std::uniform_int_distribution<int> valueDist(0, 10'000);
+
+			std::string res = "#include <string>\n#include \"core.h\"\n\n";
+			int line = 3;
+			int function = 0;
+			while (line < numLines)
+			{
+				res += "// Generated function number " + std::to_string(function) + "\n";
+				res += "static " + std::string(types[typeDist(rng)]) + " function" + std::to_string(function) + "(int arg)\n{\n";
+				res += "\t/* Block comment with a \"string\" inside */\n";
+				res += "\tint value = " + std::to_string(valueDist(rng)) + ";\n";
+				res += "\tfor (int i = 0; i < arg; i++)\n\t{\n";
+				res += "\t\tvalue += i * 0x" + std::to_string(valueDist(rng)) + " + 3.5f;\n";
+				res += "\t\tif (value > " + std::to_string(valueDist(rng)) + ") { break; }\n";
+				res += "\t}\n";
+				res += "\tconst char* str = \"Escaped \\\"quotes\\\" and \\n newlines\";\n";
+				res += "\treturn (" + std::string(types[typeDist(rng)]) + ")value;\n";
+				res += "}\n\n";
+				line += 14;
+				function++;
+			}
+
+			return res;
+		}
+
+		static std::string generateJsSource(std::mt19937& rng, int numLines)
+		{
+			std::uniform_int_distribution<int> valueDist(0, 10'000);
+
+			std::string res = "'use strict';\n\n";
+			int line = 2;
+			int function = 0;
+			while (line < numLines)
+			{
+				res += "// Generated function number " + std::to_string(function) + "\n";
+				res += "export function function" + std::to_string(function) + "(arg, { option = " + std::to_string(valueDist(rng)) + " } = {}) {\n";
+				res += "\tconst values = [1, 2, 3].map((x) => x * option);\n";
+				res += "\tlet str = `Template ${arg} string`;\n";
+				res += "\tif (arg > " + std::to_string(valueDist(rng)) + ") {\n";
+				res += "\t\treturn new RegExp('a+b*', 'g').test(str) ? values : null;\n";
+				res += "\t}\n";
+				res += "\treturn { key: \"value\", number: 0x" + std::to_string(valueDist(rng)) + " };\n";
+				res += "}\n\n";
+				line += 10;
+				function++;
+			}
+
+			return res;
+		}
+	}
+}
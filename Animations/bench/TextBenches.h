@@ -0,0 +1,12 @@
+#ifndef MATH_ANIM_TEXT_BENCHES_H
+#define MATH_ANIM_TEXT_BENCHES_H
+
+namespace MathAnim
+{
+	namespace TextBenches
+	{
+		void registerBenchmarks();
+	}
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "VideoBenches.h"
+#include "Benchmark.h"
+
+#include "core.h"
+#include "video/Encoder.h"
+
+namespace MathAnim
+{
+	namespace VideoBenches
+	{
+		// -------------------- Constants --------------------
+		static constexpr int outputWidth = 1280;
+		static constexpr int outputHeight = 720;
+		static constexpr int outputFramerate = 60;
+		static constexpr int numFramesPerVideo = 30;
+
+		// -------------------- Private functions --------------------
+		static std::vector<uint8> generateYuvFrames(size_t frameSize);
+
+		// -------------------- Benchmarks --------------------
+		// Encodes a short clip end to end, from the first pushed frame until the file is
+		// completely written
+		static void encodeYuvFrames(Bench::BenchContext& ctx, bool zeroCopy)
+		{
+			size_t frameSize = (size_t)(outputWidth * outputHeight) + 2 * (size_t)((outputWidth / 2) * (outputHeight / 2));
+			std::vector<uint8> frames = generateYuvFrames(frameSize);
+			std::string outputFile = (std::filesystem::temp_directory_path() / "mathAnimBenchVideo.ivf").string();
+
+			ctx.setItemsPerIteration(numFramesPerVideo);
+			ctx.setBytesPerIteration((int64)(frameSize * numFramesPerVideo));
+			ctx.setCounter("width", (double)outputWidth);
+			ctx.setCounter("height", (double)outputHeight);
+
+			bool failed = false;
+			ctx.measure([&]()
+				{
+					VideoEncoder* encoder = VideoEncoder::startEncodingFile(
+						outputFile.c_str(),
+						outputWidth,
+						outputHeight,
+						outputFramerate,
+						numFramesPerVideo
+					);
+					if (!encoder)
+					{
+						failed = true;
+						return;
+					}
+
+					for (int i = 0; i < numFramesPerVideo; i++)
+					{
+						const uint8* frame = frames.data() + frameSize * (size_t)i;
+						if (zeroCopy)
+						{
+							g_memory_copyMem(encoder->acquireYuvFrame(), encoder->getFrameSize(), (void*)frame, frameSize);
+							encoder->submitYuvFrame();
+						}
+						else
+						{
+							encoder->pushYuvFrame(frame, frameSize);
+						}
+					}
+
+					VideoEncoder::finalizeEncodingFile(encoder);
+					encoder->destroy();
+					g_memory_delete(encoder);
+				});
+
+			if (failed)
+			{
+				ctx.skip("Failed to start the video encoder.");
+			}
+
+			std::filesystem::remove(outputFile);
+		}
+
+		void registerBenchmarks()
+		{
+			Bench::registerBenchmark("VideoEncoder/encode/pushYuvFrame/720p",
+				[](Bench::BenchContext& ctx) { encodeYuvFrames(ctx, false); });
+			Bench::registerBenchmark("VideoEncoder/encode/acquireYuvFrame/720p",
+				[](Bench::BenchContext& ctx) { encodeYuvFrames(ctx, true); });
+		}
+
+		// -------------------- Private functions --------------------
+		static std::vector<uint8> generateYuvFrames(size_t frameSize)
+		{
+			// Scrolling gradients, so there's motion for the encoder to find without any
+			// frame being trivially compressible
+			std::vector<uint8> res = {};
+			res.resize(frameSize * numFramesPerVideo);
+			for (int frame = 0; frame < numFramesPerVideo; frame++)
+			{
+				uint8* yPlane = res.data() + frameSize * (size_t)frame;
+				for (int y = 0; y < outputHeight; y++)
+				{
+					for (int x = 0; x < outputWidth; x++)
+					{
+						yPlane[y * outputWidth + x] = (uint8)((x + y * 2 + frame * 8) & 0xFF);
+					}
+				}
+
+				uint8* uPlane = yPlane + outputWidth * outputHeight;
+				uint8* vPlane = uPlane + (outputWidth / 2) * (outputHeight / 2);
+				for (int y = 0; y < outputHeight / 2; y++)
+				{
+					for (int x = 0; x < outputWidth / 2; x++)
+					{
+						uPlane[y * (outputWidth / 2) + x] = (uint8)(128 + ((x - frame) & 0x3F) - 32);
+						vPlane[y * (outputWidth / 2) + x] = (uint8)(128 + ((y + frame) & 0x3F) - 32);
+					}
+				}
+			}
+
+			return res;
+		}
+	}
+}
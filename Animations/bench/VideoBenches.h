@@ -0,0 +1,12 @@
+#ifndef MATH_ANIM_VIDEO_BENCHES_H
+#define MATH_ANIM_VIDEO_BENCHES_H
+
+namespace MathAnim
+{
+	namespace VideoBenches
+	{
+		void registerBenchmarks();
+	}
+}
+
+#endif
@@ -0,0 +1,164 @@
+#include "core.h"
+#include "Benchmark.h"
+#include "AnimationBenches.h"
+#include "SvgBenches.h"
+#include "TextBenches.h"
+#include "LRUCacheBenches.h"
+#include "VideoBenches.h"
+#include "ScriptBenches.h"
+
+#include "renderer/Fonts.h"
+#include "svg/Svg.h"
+#include "svg/SvgParser.h"
+#include "parsers/SyntaxHighlighter.h"
+
+using namespace MathAnim;
+
+struct BenchArgs
+{
+	Bench::BenchSettings settings = {};
+	std::string filter = "";
+	std::string outputFile = "";
+	bool listOnly = false;
+};
+
+static void printUsage();
+static bool parseArgs(int argc, char* argv[], BenchArgs* args);
+
+// Everything benchmarked here runs without a window or an OpenGL context, so this
+// works on headless Linux machines. Run it from the repository root so the assets can be found.
+int main(int argc, char* argv[])
+{
+	g_logger_init();
+	g_memory_init_padding(true, 5);
+
+	BenchArgs args = {};
+	if (!parseArgs(argc, argv, &args))
+	{
+		printUsage();
+		return 1;
+	}
+
+	AnimationBenches::registerBenchmarks();
+	SvgBenches::registerBenchmarks();
+	TextBenches::registerBenchmarks();
+	LRUCacheBenches::registerBenchmarks();
+	VideoBenches::registerBenchmarks();
+	ScriptBenches::registerBenchmarks();
+
+	if (args.listOnly)
+	{
+		Bench::listBenchmarks();
+		Bench::free();
+		return 0;
+	}
+
+	OnigEncoding use_encs[1];
+	use_encs[0] = ONIG_ENCODING_ASCII;
+	onig_initialize(use_encs, sizeof(use_encs) / sizeof(use_encs[0]));
+
+	// Only warnings and errors, anything else would end up in the middle of the results table
+	g_logger_set_level(g_logger_level_Warning);
+	Fonts::init();
+	Svg::init();
+	SvgParser::init();
+	Highlighters::init();
+
+	int numFailed = Bench::runBenchmarks(
+		args.settings,
+		args.filter != "" ? args.filter.c_str() : nullptr,
+		args.outputFile != "" ? args.outputFile.c_str() : nullptr
+	);
+
+	Highlighters::free();
+	Fonts::unloadAllFonts();
+	onig_end();
+	Bench::free();
+
+	g_memory_dumpMemoryLeaks();
+	return numFailed == 0 ? 0 : 1;
+}
+
+static void printUsage()
+{
+	CppUtils::IO::printf(
+		"Usage:\n"
+		"  MathAnimationsBench [options]\n"
+		"\n"
+		"Options:\n"
+		"  --out <file>          Write the results as JSON to <file>\n"
+		"  --filter <text>       Only run benchmarks whose name contains <text>\n"
+		"  --min-time <seconds>  Minimum time spent sampling each benchmark (default: 0.5)\n"
+		"  --min-samples <n>     Minimum number of samples per benchmark (default: 5)\n"
+		"  --seed <n>            Seed used to generate the benchmark data (default: {})\n"
+		"  --list                List all benchmarks without running them\n",
+		Bench::DEFAULT_SEED
+	);
+}
+
+static bool parseArgs(int argc, char* argv[], BenchArgs* args)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+
+		// Flags without values
+		if (std::strcmp(arg, "--list") == 0)
+		{
+			args->listOnly = true;
+			continue;
+		}
+		else if (std::strcmp(arg, "--help") == 0)
+		{
+			return false;
+		}
+
+		if (i + 1 >= argc)
+		{
+			g_logger_error("Missing value for argument '{}'.", arg);
+			return false;
+		}
+		const char* value = argv[++i];
+
+		bool isValid = true;
+		char* end = nullptr;
+		if (std::strcmp(arg, "--out") == 0)
+		{
+			args->outputFile = value;
+		}
+		else if (std::strcmp(arg, "--filter") == 0)
+		{
+			args->filter = value;
+		}
+		else if (std::strcmp(arg, "--min-time") == 0)
+		{
+			args->settings.minTimeSeconds = std::strtod(value, &end);
+			isValid = end != value && *end == '\0' && args->settings.minTimeSeconds >= 0.0;
+		}
+		else if (std::strcmp(arg, "--min-samples") == 0)
+		{
+			long minSamples = std::strtol(value, &end, 10);
+			isValid = end != value && *end == '\0' && minSamples > 0 && minSamples <= args->settings.maxSamples;
+			args->settings.minSamples = (int)minSamples;
+		}
+		else if (std::strcmp(arg, "--seed") == 0)
+		{
+			unsigned long seed = std::strtoul(value, &end, 10);
+			isValid = end != value && *end == '\0' && seed <= UINT32_MAX;
+			args->settings.seed = (uint32)seed;
+		}
+		else
+		{
+			g_logger_error("Unknown argument '{}'.", arg);
+			return false;
+		}
+
+		if (!isValid)
+		{
+			g_logger_error("Invalid value '{}' for argument '{}'.", value, arg);
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -19,6 +19,10 @@ namespace MathAnim
 	struct Font;
 	struct SvgObject;
 	struct AnimationManagerData;
+	struct BinaryAnimationRecord;
+	struct BinaryAnimObjectRecord;
+	class BinarySceneWriter;
+	class BinarySceneReader;
 
 	// Constants
 	constexpr uint32 SERIALIZER_VERSION_MAJOR = 3;
@@ -327,6 +331,8 @@ namespace MathAnim
 		void free();
 		void serialize(nlohmann::json& j) const;
 		static Animation deserialize(const nlohmann::json& j, uint32 version);
+		void serializeBinary(BinarySceneWriter& writer) const;
+		static Animation deserializeBinary(const BinarySceneReader& reader, const BinaryAnimationRecord& record, uint32 version);
 		static Animation createDefault(AnimTypeV1 type, int32 frameStart, int32 duration);
 
 		[[deprecated("This is for upgrading legacy projects developed in beta")]]
@@ -485,8 +491,14 @@ namespace MathAnim
 		uint8* name;
 		uint32 nameLength;
 
+		// The geometry this object starts with. This may be shared with other objects (every
+		// glyph of a font is shared by the text objects that use it), so never modify it in place.
 		SvgObject* _svgObjectStart;
+		// The geometry that gets rendered. This points at _svgObjectStart until an animation
+		// needs to change the geometry, use getMutableSvgObject() for that.
 		SvgObject* svgObject;
+		// Private copy of the geometry, allocated the first time it's needed and then reused
+		SvgObject* _svgObjectPrivate;
 		float svgScale;
 		AnimObjectStatus status;
 		bool drawDebugBoxes;
@@ -527,6 +539,15 @@ namespace MathAnim
 		void takeAttributesFrom(const AnimObject& obj);
 		void replacementTransform(AnimationManagerData* am, AnimObjId replacement, float t);
 
+		// Takes ownership of `start` and makes it the geometry this object starts with
+		void setSvgObjectStart(SvgObject* start);
+		// Makes sure svgObject is private to this object and returns it. If keepContents is false,
+		// the caller is going to overwrite all of the geometry so the current one isn't copied.
+		SvgObject* getMutableSvgObject(bool keepContents = true);
+		// Makes sure _svgObjectStart isn't shared with anything else before modifying it
+		SvgObject* getMutableSvgObjectStart();
+		void resetSvgObject();
+		void freeSvgObjects();
 		void resetAllState();
 		void retargetSvgScale();
 		void updateStatus(AnimationManagerData* am, AnimObjectStatus newStatus);
@@ -542,6 +563,8 @@ namespace MathAnim
 		void free();
 		void serialize(nlohmann::json& j) const;
 		static AnimObject deserialize(const nlohmann::json& j, uint32 version);
+		void serializeBinary(BinarySceneWriter& writer) const;
+		static AnimObject deserializeBinary(const BinarySceneReader& reader, const BinaryAnimObjectRecord& record, uint32 version);
 		static AnimObject createDefaultFromParent(AnimationManagerData* am, AnimObjectTypeV1 type, AnimObjId parentId, bool addChildAsGenerated = false);
 		static AnimObject createDefaultFromObj(AnimationManagerData* am, AnimObjectTypeV1 type, const AnimObject& obj);
 		static AnimObject createDefault(AnimationManagerData* am, AnimObjectTypeV1 type);
@@ -11,6 +11,7 @@ namespace MathAnim
 	struct Animation;
 	struct Framebuffer;
 	struct Camera;
+	struct SvgMorph;
 
 	struct AnimationManagerData;
 
@@ -22,6 +23,24 @@ namespace MathAnim
 		void resetToFrame(AnimationManagerData* am, uint32 absoluteFrame);
 		void calculateAnimationKeyFrames(AnimationManagerData* am);
 
+		/**
+		 * @brief Discards any cached timeline checkpoints captured after `fromFrame`. Passing
+		 *        a negative frame discards every checkpoint.
+		 *
+		 * @param am Animation Manager
+		 * @param fromFrame The earliest frame that was affected by a change
+		*/
+		void invalidateCheckpoints(AnimationManagerData* am, int fromFrame);
+
+		/**
+		 * @brief Call this after modifying an animation in place, so that any cached timeline
+		 *        checkpoints that depend on it get recalculated.
+		 *
+		 * @param am Animation Manager
+		 * @param anim The animation that was modified
+		*/
+		void invalidateAnimation(AnimationManagerData* am, AnimId anim);
+
 		/**
 		 * @brief Adds this animation object to the animation manager. 
 		 *        IMPORTANT: This function takes ownership of this object, so any references
@@ -43,6 +62,8 @@ namespace MathAnim
 		void setAnimationTrack(AnimationManagerData* am, AnimId anim, int track);
 
 		void render(AnimationManagerData* am, int deltaFrame);
+		// Same as render, minus the draw calls. Images, LaTeX objects and cameras still get updated.
+		void update(AnimationManagerData* am, int deltaFrame);
 
 		int lastAnimatedFrame(const AnimationManagerData* am);
 		bool isPastLastFrame(const AnimationManagerData* am);
@@ -59,18 +80,34 @@ namespace MathAnim
 		const Animation* getAnimation(const AnimationManagerData* am, AnimId anim);
 		Animation* getMutableAnimation(AnimationManagerData* am, AnimId anim);
 
+		/**
+		 * @brief Gets the curve correspondence used to morph `animObj`'s svg into `replacement`'s
+		 *        svg. This is cached, and only gets rebuilt when either shape changes.
+		 *
+		 * @param am Animation Manager
+		 * @param animObj The object being morphed
+		 * @param replacement The object it's being morphed into
+		 * @return The morph, or nullptr if either object doesn't have an svg
+		*/
+		const SvgMorph* getSvgMorph(AnimationManagerData* am, AnimObjId animObj, AnimObjId replacement);
+
 		const std::vector<AnimObject>& getAnimObjects(const AnimationManagerData* am);
 		const std::vector<Animation>& getAnimations(const AnimationManagerData* am);
 
 		std::vector<AnimId> getAssociatedAnimations(const AnimationManagerData* am, AnimObjId obj);
 		std::vector<AnimObjId> getChildren(const AnimationManagerData* am, AnimObjId obj);
 		AnimObjId getNextSibling(const AnimationManagerData* am, AnimObjId obj);
+		// NOTE: Always reparent objects through here, the manager keeps an index of every object's children
+		void setParent(AnimationManagerData* am, AnimObjId obj, AnimObjId newParent);
 
 		void setRenderAllBoundingBoxes(AnimationManagerData* am, bool shouldRender);
 		void renderAllBoundingBoxes(const AnimationManagerData* am);
 
 		void serialize(const AnimationManagerData* am, nlohmann::json& j);
 		void deserialize(AnimationManagerData* am, const nlohmann::json& j, int currentFrame, uint32 versionMajor, uint32 versionMinor);
+		void serializeBinary(const AnimationManagerData* am, BinarySceneWriter& writer);
+		// Returns false if any records were corrupted. Those get skipped, everything else still loads.
+		bool deserializeBinary(AnimationManagerData* am, const BinarySceneReader& reader, int currentFrame);
 		void sortAnimations(AnimationManagerData* am);
 
 		[[deprecated("This is for upgrading legacy projects developed in beta")]]
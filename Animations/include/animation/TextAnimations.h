@@ -12,11 +12,35 @@ namespace MathAnim
 	struct SvgGroup;
 	struct AnimationManagerData;
 
+	// One character of a TextObject or CodeBlock that generated a child object. Whitespace
+	// doesn't generate children so it has no glyph.
+	struct GlyphInstance
+	{
+		AnimObjId childId;
+		Vec2 position;
+		uint32 textIndex;
+		uint32 codepoint;
+	};
+
+	// Layout of all the glyphs a text object generated, sorted by textIndex. The children
+	// only reference the outlines the font already owns, so regenerating the text reuses
+	// the children of every glyph that's still there instead of recreating all of them.
+	struct GlyphRun
+	{
+		std::vector<GlyphInstance> glyphs;
+
+		// Returns nullptr if the character at textIndex has no glyph
+		const GlyphInstance* getGlyph(uint32 textIndex) const;
+		// Returns NULL_ANIM_OBJECT if the character at textIndex has no glyph
+		AnimObjId getGlyphChild(uint32 textIndex) const;
+	};
+
 	struct TextObject
 	{
 		char* text;
 		int32 textLength;
 		Font* font;
+		GlyphRun* glyphRun;
 
 		void init(AnimationManagerData* am, AnimObjId parentId);
 		void reInit(AnimationManagerData* am, AnimObject* obj);
@@ -43,12 +67,6 @@ namespace MathAnim
 		bool isEquation;
 		bool isParsingLaTex;
 
-		// NOTE: This update function is just used to check if it's
-		// in the middle of parsing latex. If it is, then it checks
-		// if it's ready and then assigns it to the SVG group when it's done
-		// generating the svg
-		void update(AnimationManagerData* am, AnimObjId parentId);
-
 		void init(AnimationManagerData* am, AnimObjId parentId);
 		void reInit(AnimationManagerData* am, AnimObject* obj);
 
@@ -62,6 +80,10 @@ namespace MathAnim
 
 		static LaTexObject createDefault();
 
+		// LaTeX finishes compiling in the background. This regenerates the children of every
+		// object that was waiting on an expression that finished since the last call.
+		static void reInitFinishedObjects(AnimationManagerData* am);
+
 		[[deprecated("This is for upgrading legacy projects developed in beta")]]
 		static LaTexObject legacy_deserialize(RawMemory& memory, uint32 version);
 	};
@@ -72,6 +94,7 @@ namespace MathAnim
 		int32 textLength;
 		HighlighterLanguage language;
 		HighlighterTheme theme;
+		GlyphRun* glyphRun;
 
 		void init(AnimationManagerData* am, AnimObjId parentId);
 		void reInit(AnimationManagerData* am, AnimObject* obj);
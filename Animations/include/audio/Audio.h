@@ -5,11 +5,14 @@
 namespace MathAnim
 {
 	struct WavData;
+	struct AudioStream;
+
 	struct AudioSource
 	{
 		uint32 bufferId;
 		uint32 sourceId;
-		bool isPlaying;
+		// Only set for sources opened with openWavStream
+		AudioStream* stream;
 	};
 
 	namespace Audio
@@ -18,11 +21,16 @@ namespace MathAnim
 
 		AudioSource loadWavFile(const char* filename);
 		AudioSource loadWavFile(const WavData& wav);
+		// Plays `wav` through a few small buffers that a feeder thread keeps topped up instead of
+		// uploading all of it at once. `wav` has to stay loaded until the source gets freed.
+		AudioSource openWavStream(const WavData& wav);
 		AudioSource defaultAudioSource();
 
 		bool isNull(const AudioSource& wav);
 		void play(AudioSource& source, float offsetInSeconds = 0.0f);
 		void stop(AudioSource& source);
+		// Streams stop playing on their own once the feeder reaches the end of the file
+		bool isPlaying(const AudioSource& source);
 
 		void free(AudioSource& source);
 
@@ -4,6 +4,8 @@
 
 namespace MathAnim
 {
+	struct MemMappedFile;
+
 	enum class AudioChannelType : uint8
 	{
 		None,
@@ -25,6 +27,17 @@ namespace MathAnim
 		return ostream;
 	}
 
+	// How the samples in the data chunk are stored. 8 bit PCM is unsigned, everything else is signed.
+	enum class WavSampleFormat : uint8
+	{
+		None,
+		UInt8,
+		Int16,
+		Int24,
+		Float32,
+		Length
+	};
+
 	struct WavData
 	{
 		uint32 sampleRate;
@@ -32,15 +45,70 @@ namespace MathAnim
 		uint16 blockAlignment;
 		uint16 bitsPerSample;
 		AudioChannelType audioChannelType;
+		WavSampleFormat sampleFormat;
 		uint32 dataSize;
-		uint8* audioData;
+		// Points into `file` for wavs loaded from disk, so samples only get paged in once they're read
+		uint8 const* audioData;
+		MemMappedFile* file;
 	};
 
 	namespace WavLoader
 	{
+		// Memory maps the file instead of reading it. Returns a zeroed WavData if the file can't be parsed.
 		WavData loadWavFile(const char* filename);
 
+		// Walks the RIFF chunks of a wav that's already in memory. Unknown chunks like LIST and fact
+		// get skipped. On success `outWav.audioData` points into `fileData`.
+		bool parse(uint8 const* fileData, size_t fileSize, WavData& outWav);
+
 		void free(WavData& wav);
+
+		inline uint16 getBytesPerSample(WavSampleFormat sampleFormat)
+		{
+			switch (sampleFormat)
+			{
+			case WavSampleFormat::UInt8: return 1;
+			case WavSampleFormat::Int16: return 2;
+			case WavSampleFormat::Int24: return 3;
+			case WavSampleFormat::Float32: return 4;
+			case WavSampleFormat::None:
+			case WavSampleFormat::Length:
+				break;
+			}
+
+			return 0;
+		}
+
+		// Reads a single sample as 16 bit PCM, which is what OpenAL and the timeline waveform work with
+		inline int16 readSample(uint8 const* sample, WavSampleFormat sampleFormat)
+		{
+			switch (sampleFormat)
+			{
+			case WavSampleFormat::UInt8:
+				// 8 bit PCM is unsigned and centered on 128
+				return (int16)(((int32)sample[0] - 128) * 256);
+			case WavSampleFormat::Int16:
+			{
+				int16 res;
+				g_memory_copyMem(&res, sizeof(int16), (void*)sample, sizeof(int16));
+				return res;
+			}
+			case WavSampleFormat::Int24:
+				// Little endian, so the top two bytes are the last two
+				return (int16)((uint16)sample[1] | ((uint16)sample[2] << 8));
+			case WavSampleFormat::Float32:
+			{
+				float res;
+				g_memory_copyMem(&res, sizeof(float), (void*)sample, sizeof(float));
+				return (int16)(glm::clamp(res, -1.0f, 1.0f) * (float)INT16_MAX);
+			}
+			case WavSampleFormat::None:
+			case WavSampleFormat::Length:
+				break;
+			}
+
+			return 0;
+		}
 	}
 }
 
@@ -0,0 +1,51 @@
+#ifndef MATH_ANIM_WAVEFORM_PYRAMID_H
+#define MATH_ANIM_WAVEFORM_PYRAMID_H
+#include "core.h"
+
+namespace MathAnim
+{
+	struct WavData;
+	enum class WavSampleFormat : uint8;
+
+	// Samples are normalized to int16 and every channel gets folded into the same bucket
+	struct WaveformBucket
+	{
+		int16 min;
+		int16 max;
+	};
+
+	struct WaveformLevel
+	{
+		uint32 samplesPerBucket;
+		std::vector<WaveformBucket> buckets;
+	};
+
+	// Min/max summaries of an audio track at a few resolutions, finest level first. Each
+	// level gets built from the one below it, so the PCM only gets read once.
+	struct WaveformPyramid
+	{
+		uint32 sampleRate;
+		uint64 numSamples;
+		std::vector<WaveformLevel> levels;
+	};
+
+	namespace Waveform
+	{
+		// Samples per bucket of the finest level, every level after it is branchFactor times coarser
+		constexpr uint32 finestSamplesPerBucket = 256;
+		constexpr uint32 branchFactor = 16;
+		constexpr int numLevels = 3;
+
+		WaveformPyramid build(uint8 const* pcm, size_t numBytes, WavSampleFormat sampleFormat, uint16 blockAlignment, uint16 numChannels, uint32 sampleRate);
+		WaveformPyramid build(WavData const& wav);
+
+		// Coarsest level that still has at least one bucket per `samplesPerPixel` samples
+		WaveformLevel const* chooseLevel(WaveformPyramid const& pyramid, double samplesPerPixel);
+
+		// Min/max of every bucket overlapping the samples [firstSample, lastSample). Returns a
+		// flat { 0, 0 } bucket if the range is past the end of the track.
+		WaveformBucket getRange(WaveformLevel const& level, uint64 firstSample, uint64 lastSample);
+	}
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef MATH_ANIM_APPLICATION_H
 #define MATH_ANIM_APPLICATION_H
 #include "core.h"
+#include "video/Encoder.h"
 
 namespace MathAnim
 {
@@ -19,10 +20,31 @@ namespace MathAnim
 		Pause,
 	};
 
+	struct HeadlessRenderSettings
+	{
+		std::string outputFile = "";
+		// Inclusive range of timeline frames to export. A negative lastFrame
+		// exports until the last animated frame of the scene
+		int firstFrame = 0;
+		int lastFrame = -1;
+		int outputWidth = 3840;
+		int outputHeight = 2160;
+		int framerate = 60;
+		int crf = DEFAULT_VIDEO_CRF;
+		// Rasterize frames on the CPU with the SoftwareRenderer instead of OpenGL
+		bool useSoftwareRenderer = false;
+		// Only measure how long frames take to render, nothing is encoded
+		bool benchmarkOnly = false;
+	};
+
 	namespace Application
 	{
 		void init(const char* projectFile);
 
+		// Exports the current scene of the project straight to a video file without
+		// creating the editor. Returns 0 on success or a non-zero exit code on failure.
+		int renderHeadless(const char* projectFile, const HeadlessRenderSettings& settings);
+
 		void run();
 
 		void free();
@@ -36,6 +58,9 @@ namespace MathAnim
 
 		void saveProject();
 		void saveCurrentScene();
+		// Writes the current scene as formatted JSON next to its binary scene file. Newer JSON
+		// files get imported over the binary scene the next time the scene is loaded.
+		void exportCurrentSceneAsJson();
 		void loadProject(const std::filesystem::path& projectRoot);
 		void loadScene(const std::string& sceneName);
 		void deleteScene(const std::string& sceneName);
@@ -56,6 +81,9 @@ namespace MathAnim
 		const Camera* getEditorCamera();
 		// TODO: Ugly hack
 		SvgCache* getSvgCache();
+		// True when rendering headless with the SoftwareRenderer. There's no OpenGL context,
+		// window or SvgCache in that case, so nothing may touch the GPU.
+		bool isUsingSoftwareRenderer();
 		UndoSystemData* getUndoSystem();
 
 		GlobalThreadPool* threadPool();
@@ -0,0 +1,242 @@
+#ifndef MATH_ANIM_BINARY_SCENE_H
+#define MATH_ANIM_BINARY_SCENE_H
+#include "core.h"
+
+#include <nlohmann/json_fwd.hpp>
+#include <type_traits>
+
+namespace MathAnim
+{
+	struct MemMappedFile;
+
+	// NOTE: Binary scene format spec is listed at the bottom of this file
+	constexpr uint32 BINARY_SCENE_MAGIC_NUMBER = 0x4353414D; // "MASC"
+	constexpr uint32 BINARY_SCENE_FORMAT_VERSION = 1;
+
+	enum class BinarySceneSection : uint32
+	{
+		StringTable = 0,
+		Ids,
+		Blobs,
+		AnimationManager,
+		Animations,
+		AnimObjects,
+		EditorState,
+		Length
+	};
+
+	struct BinarySceneHeader
+	{
+		uint32 magicNumber;
+		uint32 formatVersion;
+		uint32 serializerVersionMajor;
+		uint32 serializerVersionMinor;
+		uint32 numSections;
+		uint32 reserved;
+	};
+
+	struct BinarySceneSectionEntry
+	{
+		uint32 type;
+		uint32 numElements;
+		uint64 offset;
+		uint64 size;
+	};
+
+	// Range of ids in the Ids section
+	struct BinaryIdRange
+	{
+		uint32 first;
+		uint32 count;
+	};
+
+	// Range of bytes in the Blobs section
+	struct BinaryBlobRef
+	{
+		uint64 offset;
+		uint64 size;
+	};
+
+	struct BinaryAnimationManagerRecord
+	{
+		AnimObjId activeCamera;
+	};
+
+	struct BinaryAnimationRecord
+	{
+		AnimId id;
+		BinaryIdRange animObjectIds;
+		// CBOR encoded type specific data
+		BinaryBlobRef typeData;
+		int32 frameStart;
+		int32 duration;
+		int32 timelineTrack;
+		uint32 type;
+		float lagRatio;
+		uint8 easeType;
+		uint8 easeDirection;
+		uint8 playbackType;
+		uint8 padding;
+	};
+
+	enum BinaryAnimObjectFlags : uint32
+	{
+		BinaryAnimObjectFlags_None = 0,
+		BinaryAnimObjectFlags_DrawDebugBoxes = 1 << 0,
+		BinaryAnimObjectFlags_DrawCurveDebugBoxes = 1 << 1,
+	};
+
+	struct BinaryAnimObjectRecord
+	{
+		AnimObjId id;
+		AnimObjId parentId;
+		BinaryIdRange generatedChildrenIds;
+		BinaryIdRange referencedAnimations;
+		// CBOR encoded type specific data
+		BinaryBlobRef typeData;
+		// Raw binary SVG path, only used by SVG objects
+		BinaryBlobRef svgPath;
+		Vec3 position;
+		Vec3 rotation;
+		Vec3 scale;
+		glm::u8vec4 fillColor;
+		glm::u8vec4 strokeColor;
+		float strokeWidth;
+		float svgScale;
+		uint32 objectType;
+		// Index into the string table
+		uint32 name;
+		uint32 flags;
+	};
+
+	static_assert(sizeof(BinarySceneHeader) == 24, "Binary scene header layout changed. Bump BINARY_SCENE_FORMAT_VERSION.");
+	static_assert(sizeof(BinarySceneSectionEntry) == 24, "Binary scene section layout changed. Bump BINARY_SCENE_FORMAT_VERSION.");
+	static_assert(sizeof(BinaryAnimationRecord) == 56, "Binary animation record layout changed. Bump BINARY_SCENE_FORMAT_VERSION.");
+	static_assert(sizeof(BinaryAnimObjectRecord) == 128, "Binary anim object record layout changed. Bump BINARY_SCENE_FORMAT_VERSION.");
+
+	class BinarySceneWriter
+	{
+	public:
+		// Returns the index of the string in the string table. Duplicate strings share an index.
+		uint32 addString(const char* str, size_t length);
+
+		template<typename Iter>
+		BinaryIdRange addIds(Iter begin, Iter end)
+		{
+			BinaryIdRange res = { getNumElements(BinarySceneSection::Ids), 0 };
+			for (Iter it = begin; it != end; it++)
+			{
+				uint64 id = (uint64)*it;
+				append(BinarySceneSection::Ids, &id, sizeof(uint64), 1);
+				res.count++;
+			}
+			return res;
+		}
+
+		BinaryBlobRef addBlob(const uint8* data, size_t size);
+		BinaryBlobRef addCbor(const nlohmann::json& j);
+
+		template<typename T>
+		void addRecord(BinarySceneSection section, const T& record)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Binary scene records must be trivially copyable.");
+			append(section, &record, sizeof(T), 1);
+		}
+
+		void setEditorState(const nlohmann::json& j);
+
+		bool writeToFile(const std::filesystem::path& filepath, uint32 serializerVersionMajor, uint32 serializerVersionMinor);
+		// Lays the scene out exactly like writeToFile does, but into `outData`
+		void writeToMemory(std::vector<uint8>& outData, uint32 serializerVersionMajor, uint32 serializerVersionMinor);
+
+	private:
+		void append(BinarySceneSection section, const void* data, size_t size, uint32 numElements);
+		inline uint32 getNumElements(BinarySceneSection section) const { return numElements[(size_t)section]; }
+
+	private:
+		std::vector<uint8> sections[(size_t)BinarySceneSection::Length];
+		uint32 numElements[(size_t)BinarySceneSection::Length] = {};
+		std::vector<uint32> stringOffsets;
+		std::unordered_map<std::string, uint32> stringIndices;
+	};
+
+	// Reads a binary scene straight out of a memory mapped file. Opening only validates
+	// the header and section table, everything else gets decoded when it's asked for.
+	class BinarySceneReader
+	{
+	public:
+		BinarySceneReader() : file(nullptr), data(nullptr), dataSize(0), sectionEntries(nullptr), header() {}
+
+		bool open(const char* filepath);
+		// Reads a scene that's already in memory. `data` isn't copied, so it has to outlive the reader
+		// and needs to be 8 byte aligned like a mapped file would be.
+		bool openMemory(const uint8* data, size_t dataSize);
+		void close();
+
+		inline uint32 getVersionMajor() const { return header.serializerVersionMajor; }
+		inline uint32 getVersionMinor() const { return header.serializerVersionMinor; }
+
+		template<typename T>
+		const T* getRecords(BinarySceneSection section, size_t* outCount) const
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Binary scene records must be trivially copyable.");
+			const BinarySceneSectionEntry* entry = findSection(section);
+			if (!entry || entry->size != (uint64)entry->numElements * sizeof(T))
+			{
+				*outCount = 0;
+				return nullptr;
+			}
+
+			*outCount = entry->numElements;
+			return (const T*)(getData() + entry->offset);
+		}
+
+		// Returns nullptr if the range is out of bounds
+		const uint64* getIds(const BinaryIdRange& range) const;
+		// Returns nullptr if the string doesn't exist
+		const char* getString(uint32 index, size_t* outLength = nullptr) const;
+		// Returns nullptr if the blob is empty or out of bounds
+		const uint8* getBlob(const BinaryBlobRef& blob) const;
+		// Returns a discarded value if the blob isn't valid CBOR, and null if the blob is empty
+		nlohmann::json decodeCbor(const BinaryBlobRef& blob) const;
+		// Returns null if the editor state is missing or corrupted
+		nlohmann::json getEditorState() const;
+
+	private:
+		bool validate(const char* sourceName);
+		const BinarySceneSectionEntry* findSection(BinarySceneSection section) const;
+		const uint8* getData() const;
+
+	private:
+		MemMappedFile* file;
+		const uint8* data;
+		size_t dataSize;
+		const BinarySceneSectionEntry* sectionEntries;
+		BinarySceneHeader header;
+	};
+}
+
+// Binary Scene Format
+// -------------------
+//
+// Scenes get saved as "<scene>.mscene". All values are little endian. The file starts with
+// a BinarySceneHeader followed by numSections BinarySceneSectionEntry's. Each entry points to
+// the bytes of one section. Sections start on 8 byte boundaries so records can be read in place
+// from the memory mapped file.
+//
+//  * StringTable:      (numElements + 1) uint32 offsets followed by the null terminated strings.
+//                      String i is the bytes between offsets[i] and offsets[i + 1] - 1.
+//  * Ids:              uint64 ids. Records reference runs of these with a BinaryIdRange.
+//  * Blobs:            Raw bytes. Records reference these with a BinaryBlobRef. SVG paths are
+//                      stored in the binary path format from SvgParser.h without the base64 step,
+//                      and data that doesn't have a fixed layout is stored as CBOR.
+//  * AnimationManager: A single BinaryAnimationManagerRecord.
+//  * Animations:       BinaryAnimationRecord's.
+//  * AnimObjects:      BinaryAnimObjectRecord's.
+//  * EditorState:      CBOR encoded timeline, editor cameras and scene hierarchy.
+//
+// Sections that are missing are treated as empty. Any change to the layout of a record needs
+// to bump BINARY_SCENE_FORMAT_VERSION. JSON scenes can still be imported and exported, see
+// Application::exportCurrentSceneAsJson.
+
+#endif
@@ -15,6 +15,8 @@ namespace MathAnim
 	{
 		None,
 		OpenMaximized = 0x1,
+		// Creates the window (and its OpenGL context) without ever showing it
+		Hidden = 0x2,
 	};
     
 	struct Window
@@ -0,0 +1,38 @@
+#ifndef MATH_ANIM_OBJECT_PICKER_H
+#define MATH_ANIM_OBJECT_PICKER_H
+#include "core.h"
+
+namespace MathAnim
+{
+	// Forward Decls
+	struct AnimationManagerData;
+	struct Framebuffer;
+	struct Ray;
+
+	namespace ObjectPicker
+	{
+		void init();
+		void free();
+
+		// ----------- GPU picking -----------
+		// Reads the pixel out of the object id attachment through a small ring of pixel buffers, so
+		// nothing waits on the GPU. The result shows up in pollResult a frame or two later.
+		// Returns false if every pixel buffer is still in flight.
+		bool queuePick(const Framebuffer& framebuffer, int colorAttachment, int x, int y);
+
+		// Pops the oldest pick the GPU has finished with, in the order they were queued.
+		// Never blocks, returns false if the oldest pick isn't done yet.
+		bool pollResult(AnimObjId* outObjId);
+
+		int getNumPicksInFlight();
+
+		// ----------- CPU picking -----------
+		// Builds a BVH out of the oriented bounding boxes of every object that gets rendered
+		void rebuildBvh(const AnimationManagerData* am);
+
+		// Closest object the ray hits, according to the last BVH that got built
+		AnimObjId pickCpu(const Ray& ray);
+	}
+}
+
+#endif
@@ -6,6 +6,7 @@ namespace MathAnim
 {
 	struct TextEditorUndoSystem;
 	struct CodeEditorPanelData;
+	class TextDocument;
 
 	namespace UndoSystem
 	{
@@ -15,9 +16,11 @@ namespace MathAnim
 		void undo(TextEditorUndoSystem* us);
 		void redo(TextEditorUndoSystem* us);
 
-		void insertTextAction(TextEditorUndoSystem* us, uint8 const* utf8String, size_t utf8StringNumBytes, size_t insertOffset, size_t numberCharactersInserted);
-		void deleteTextAction(TextEditorUndoSystem* us, uint8 const* textToBeDeleted, size_t textToBeDeletedLength, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected);
-		void backspaceTextAction(TextEditorUndoSystem* us, uint8 const* textToBeDeleted, size_t textToBeDeletedLength, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected);
+		// Call after the text has been inserted, [insertOffset, insertOffset + numBytesInserted) gets copied out of the document
+		void insertTextAction(TextEditorUndoSystem* us, TextDocument const& document, size_t insertOffset, size_t numBytesInserted);
+		// Call before the text gets removed, [selectionStart, selectionEnd) gets copied out of the document
+		void deleteTextAction(TextEditorUndoSystem* us, TextDocument const& document, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected);
+		void backspaceTextAction(TextEditorUndoSystem* us, TextDocument const& document, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected);
 
 		void imguiStats(TextEditorUndoSystem const* undoSystem);
 	}
@@ -0,0 +1,48 @@
+#ifndef MATH_ANIM_UNDO_SNAPSHOT_STORE_H
+#define MATH_ANIM_UNDO_SNAPSHOT_STORE_H
+#include "core.h"
+
+namespace MathAnim
+{
+	class GlobalThreadPool;
+	struct UndoSnapshotStore;
+
+	typedef uint64 UndoSnapshotId;
+	constexpr UndoSnapshotId NULL_UNDO_SNAPSHOT = 0;
+
+	struct UndoSnapshotStats
+	{
+		size_t numSnapshots;
+		size_t numPendingCompressions;
+		size_t numSpilledSnapshots;
+		// Size of the snapshots before compression
+		size_t uncompressedBytes;
+		size_t memoryBytes;
+		size_t diskBytes;
+	};
+
+	// Holds the serialized objects and animations the undo history needs to rebuild things
+	// that got deleted. Snapshots get zlib compressed on the thread pool, and once the ones
+	// kept in memory go over the memory budget the oldest get written out to the spill
+	// directory and only read back if they get undone.
+	namespace UndoSnapshots
+	{
+		// Compresses on the calling thread if `threadPool` is null
+		UndoSnapshotStore* init(GlobalThreadPool* threadPool, size_t memoryBudget, std::filesystem::path const& spillDir);
+		void free(UndoSnapshotStore* store);
+
+		UndoSnapshotId add(UndoSnapshotStore* store, std::vector<uint8>&& data);
+		// Returns false if the snapshot was released or couldn't be read back from disk
+		bool load(UndoSnapshotStore* store, UndoSnapshotId id, std::vector<uint8>& outData);
+		void release(UndoSnapshotStore* store, UndoSnapshotId id);
+
+		// Picks up finished compressions and spills whatever no longer fits in the budget
+		void update(UndoSnapshotStore* store);
+
+		// Memory plus disk, what the snapshots currently cost
+		size_t getTotalBytes(UndoSnapshotStore const* store);
+		UndoSnapshotStats getStats(UndoSnapshotStore const* store);
+	}
+}
+
+#endif
@@ -10,6 +10,13 @@ namespace MathAnim
 
 	typedef AnimObjId ObjOrAnimId;
 
+	// Deleted objects and animations are kept as compressed snapshots. Once the ones in memory
+	// go over this they start getting spilled to the project's tmp directory.
+	constexpr size_t DEFAULT_UNDO_MEMORY_BUDGET = 64 * 1024 * 1024;
+	// Once the snapshots take up more than this between memory and disk, the oldest commands
+	// get dropped from the history even if it isn't full yet
+	constexpr size_t DEFAULT_UNDO_HISTORY_BUDGET = 1024 * 1024 * 1024;
+
 	enum class U8Vec4PropType : uint8
 	{
 		// Base
@@ -164,7 +171,7 @@ namespace MathAnim
 	{
 		// TODO: Come up with AnimationManagerUndoSystem so that the animation manager and text editor stuff is separate
 
-		UndoSystemData* init(void* userContext, int maxHistory);
+		UndoSystemData* init(void* userContext, int maxHistory, size_t memoryBudget = DEFAULT_UNDO_MEMORY_BUDGET, size_t historyBudget = DEFAULT_UNDO_HISTORY_BUDGET);
 		void free(UndoSystemData* us);
 
 		void setUserContext(UndoSystemData* us, void* ctx);
@@ -172,11 +179,14 @@ namespace MathAnim
 		
 		// Returns the index the command was inserted at
 		uint32 pushCommand(UndoSystemData* us, Command* command);
+		// Call once a frame, picks up snapshots that finished compressing
 		void iterate(UndoSystemData* us);
 
 		void undo(UndoSystemData* us);
 		void redo(UndoSystemData* us);
 
+		void imguiStats(UndoSystemData const* us);
+
 		void setBoolProp(UndoSystemData* us, ObjOrAnimId id, bool oldBool, bool newBool, BoolPropType propType);
 		void applyU8Vec4ToChildren(UndoSystemData* us, ObjOrAnimId id, U8Vec4PropType propType);
 		void setU8Vec4Prop(UndoSystemData* us, ObjOrAnimId id, const glm::u8vec4& oldVec, const glm::u8vec4& newVec, U8Vec4PropType propType);
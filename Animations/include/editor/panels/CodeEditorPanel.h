@@ -1,7 +1,6 @@
 #include "core.h"
 #include "parsers/SyntaxHighlighter.h"
-
-#include <cppUtils/cppStrings.hpp>
+#include "utils/TextDocument.h"
 
 namespace MathAnim
 {
@@ -35,15 +34,14 @@ namespace MathAnim
 		int32 mouseByteDragStart;
 		int32 firstByteInSelection;
 		int32 lastByteInSelection;
-		CppUtils::BasicUtf8StringIter cursor;
+		TextDocumentIter cursor;
 		uint32 cursorCurrentLine;
 		int32 numOfCharsFromBeginningOfLine;
 		int32 beginningOfCurrentLineByte;
 		float timeSinceCursorLastBlinked;
 		bool cursorIsBlinkedOn;
 
-		uint8* visibleCharacterBuffer;
-		size_t visibleCharacterBufferSize;
+		TextDocument document;
 
 		CodeHighlights syntaxHighlightTree;
 		CodeEditorPanelDebugData debugData;
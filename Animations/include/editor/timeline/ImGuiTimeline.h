@@ -4,6 +4,8 @@
 
 namespace MathAnim
 {
+	struct WaveformPyramid;
+
 	typedef int ImGuiTimelineFlags;
 	enum _ImGuiTimelineFlags
 	{
@@ -68,12 +70,8 @@ namespace MathAnim
 	struct ImGuiTimeline_AudioData
 	{
 		uint32 sampleRate;
-		uint32 bytesPerSec;
-		uint16 blockAlignment;
-		uint16 bitsPerSample;
-		int32 numAudioChannels;
-		uint32 dataSize;
-		uint8* data;
+		// Null while the waveform is still being built
+		const WaveformPyramid* waveform;
 	};
 
 	void ImGuiTimeline_SetActiveSegment(int trackIndex, int segmentIndex);
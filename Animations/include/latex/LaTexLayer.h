@@ -1,17 +1,21 @@
 #ifndef MATH_ANIM_LA_TEX_LAYER_H
 #define MATH_ANIM_LA_TEX_LAYER_H
 #include "core.h"
-#include "multithreading/Promise.hpp"
 
 namespace MathAnim
 {
 	struct SvgObject;
 
+	// Called on the main thread once a LaTeX expression finishes compiling, or fails to
+	typedef void (*LaTexCallback)(const std::string& latex, bool succeeded, void* userData);
+
 	namespace LaTexLayer
 	{
 		void init();
 
-		void laTexToSvg(const char* latex, bool isMathTex = false);
+		// Queues the expression to be compiled to "latex/<md5>.svg". Queued expressions are batched
+		// together and compiled by several latex/dvisvgm processes in parallel during update().
+		void laTexToSvg(const char* latex, bool isMathTex = false, LaTexCallback callback = nullptr, void* userData = nullptr);
 
 		bool laTexIsReady(const char* latex, bool isMathTex = false);
 
@@ -23,6 +27,10 @@ namespace MathAnim
 
 		void update();
 
+		// Returns true while there are LaTeX files queued or being compiled
+		bool hasPendingTasks();
+
+		// Drops everything that's queued and blocks until the latex processes that are already running exit
 		void free();
 	}
 }
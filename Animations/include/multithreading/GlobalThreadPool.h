@@ -2,6 +2,12 @@
 #define MATH_ANIM_GLOBAL_THREAD_POOL_H
 #include "core.h"
 
+#include <functional>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
 namespace MathAnim
 {
 	enum class Priority : uint8
@@ -9,26 +15,102 @@ namespace MathAnim
 		High = 0,
 		Medium,
 		Low,
-		None
+		None,
+		Length
 	};
 
 	typedef void (*TaskFunction)(void* data, size_t dataSize);
 	typedef void (*ThreadCallback)(void* data, size_t dataSize);
-	struct ThreadTask
+
+	enum class TaskStatus : uint8
+	{
+		Pending,
+		Running,
+		Completed,
+		Cancelled
+	};
+
+	class GlobalThreadPool;
+
+	// State shared between a TaskHandle and the thread that runs the task
+	struct TaskState
+	{
+		std::atomic<TaskStatus> status{ TaskStatus::Pending };
+		// Tasks that belong together (the chunks of a parallelFor, a task and its continuations)
+		// share a group. Threads waiting on a task may only run queued tasks from its group.
+		uint64 group = 0;
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::vector<std::function<void()>> continuations;
+
+		// Pending -> Running. Fails if the task was cancelled before it got to run.
+		bool tryStart();
+		// Pending -> Cancelled. Fails if the task already started.
+		bool tryCancel();
+		void finish(TaskStatus finalStatus);
+		// Runs continuation once this task completes or gets cancelled. If that already
+		// happened, it runs immediately on the calling thread.
+		void onFinished(std::function<void()> continuation);
+		bool isFinished() const;
+	};
+
+	template<typename T>
+	struct TypedTaskState : public TaskState
+	{
+		std::optional<T> result;
+	};
+
+	template<>
+	struct TypedTaskState<void> : public TaskState
+	{
+	};
+
+	// Return type of a continuation chained to a task that returns T
+	template<typename T, typename Fn>
+	struct ContinuationResult
 	{
-		TaskFunction fn;
-		ThreadCallback callback;
-		uint64 counter;
-		void* data;
-		size_t dataSize;
-		Priority priority;
-		const char* taskName;
+		using type = std::invoke_result_t<Fn, const T&>;
 	};
 
-	struct CompareThreadTask
+	template<typename Fn>
+	struct ContinuationResult<void, Fn>
 	{
-		// Returning true means lesser priority
-		bool operator()(const ThreadTask& a, const ThreadTask& b) const;
+		using type = std::invoke_result_t<Fn>;
+	};
+
+	template<typename T>
+	class TaskHandle
+	{
+	public:
+		TaskHandle() = default;
+		TaskHandle(GlobalThreadPool* pool, std::shared_ptr<TypedTaskState<T>> state)
+			: pool(pool), state(std::move(state)) {}
+
+		bool isValid() const { return state != nullptr; }
+		bool isReady() const { return state && state->status.load() == TaskStatus::Completed; }
+		bool isCancelled() const { return state && state->status.load() == TaskStatus::Cancelled; }
+		bool isFinished() const { return state && state->isFinished(); }
+
+		// Blocks until the task completes or gets cancelled. The waiting thread runs
+		// queued tasks from the same group in the meantime instead of sitting idle.
+		void wait() const;
+
+		// Waits for the task and returns its result. The task must not have been cancelled.
+		template<typename U = T>
+		const std::enable_if_t<!std::is_void_v<U>, U>& get() const;
+
+		// Only tasks that haven't started yet can be cancelled. Anything chained
+		// to this task with then() gets cancelled along with it.
+		bool cancel() { return state && state->tryCancel(); }
+
+		// Queues fn to run once this task completes. fn gets this task's result as
+		// its only argument, or no arguments if this task doesn't return anything.
+		template<typename Fn>
+		auto then(Fn&& fn, const char* taskName = "Continuation", Priority priority = Priority::None);
+
+	private:
+		GlobalThreadPool* pool = nullptr;
+		std::shared_ptr<TypedTaskState<T>> state;
 	};
 
 	class GlobalThreadPool
@@ -49,24 +131,222 @@ namespace MathAnim
 			void* data = nullptr,
 			size_t dataSize = 0,
 			Priority priority = Priority::None,
-			ThreadCallback callback = nullptr
+			ThreadCallback callback = nullptr,
+			bool isBlocking = false
 		);
 		void beginWork(bool notifyAll = true);
 
+		template<typename Fn>
+		auto submit(Fn&& fn, const char* taskName = "Default", Priority priority = Priority::None)
+			-> TaskHandle<std::invoke_result_t<std::decay_t<Fn>>>;
+
+		// Calls fn(rangeBegin, rangeEnd) for every grainSize chunk of [begin, end) in parallel
+		// and returns once all of them are done. The calling thread works on chunks too.
+		template<typename Fn>
+		void parallelFor(size_t begin, size_t end, size_t grainSize, Fn&& fn, const char* taskName = "ParallelFor", Priority priority = Priority::High);
+
+		void waitFor(TaskState& state);
+		uint32 getNumThreads() const { return numThreads; }
+
 	private:
-		std::priority_queue<ThreadTask, std::vector<ThreadTask>, CompareThreadTask>* tasks;
-		std::queue<ThreadTask> finishedTasks;
+		struct PoolTask
+		{
+			std::function<void()> fn;
+			std::shared_ptr<TaskState> state;
+			const char* taskName;
+			Priority priority;
+			uint64 group;
+			// Long running tasks that waiting threads must never pick up to run inline
+			bool isBlocking;
+
+			// Only used by queueTask
+			ThreadCallback callback;
+			void* data;
+			size_t dataSize;
+		};
+
+		// Every worker owns one of these. The owner pushes and pops from the back,
+		// idle workers steal from the front of everyone else's.
+		struct WorkerQueue
+		{
+			std::mutex mtx;
+			std::deque<PoolTask> tasks[(uint8)Priority::Length];
+		};
+
+		// Limits which tasks a thread waiting on a task of the given group may run
+		struct WaitFilter
+		{
+			uint64 group;
+			// Tasks outside the group at or above this priority are fair game too
+			bool helpWithOtherGroups;
+			Priority minPriority;
+
+			bool accepts(const PoolTask& task) const;
+		};
+
+		template<typename Fn>
+		auto submitInGroup(Fn&& fn, const char* taskName, Priority priority, uint64 group)
+			-> TaskHandle<std::invoke_result_t<std::decay_t<Fn>>>;
+
+		void schedule(PoolTask&& task);
+		bool popTask(int32 workerIndex, PoolTask* outTask, const WaitFilter* filter = nullptr);
+		void runTask(PoolTask& task);
+
+		template<typename T>
+		friend class TaskHandle;
+
+	private:
+		WorkerQueue* workerQueues;
+		std::queue<PoolTask> finishedTasks;
 		std::thread* workerThreads;
 		std::condition_variable* cv;
 		std::mutex* generalMtx;
-		std::mutex* queueMtx;
 		std::mutex* finishedQueueMtx;
+		std::atomic<uint32> nextQueue;
+		std::atomic<int32> numQueuedTasks;
+		std::atomic<uint64> nextGroup;
 		bool doWork;
 		uint32 numThreads;
 #ifdef _DEBUG
 		bool forceSynchronous;
 #endif
 	};
+
+	// ------------------ Template implementations ------------------
+	template<typename T>
+	void TaskHandle<T>::wait() const
+	{
+		if (state)
+		{
+			pool->waitFor(*state);
+		}
+	}
+
+	template<typename T>
+	template<typename U>
+	const std::enable_if_t<!std::is_void_v<U>, U>& TaskHandle<T>::get() const
+	{
+		wait();
+		g_logger_assert(state->result.has_value(), "Tried to get the result of a cancelled task.");
+		return *state->result;
+	}
+
+	template<typename T>
+	template<typename Fn>
+	auto TaskHandle<T>::then(Fn&& fn, const char* taskName, Priority priority)
+	{
+		using R = typename ContinuationResult<T, std::decay_t<Fn>>::type;
+
+		g_logger_assert(state != nullptr, "Tried to chain a continuation to an invalid task.");
+		auto next = std::make_shared<TypedTaskState<R>>();
+		next->group = state->group;
+		GlobalThreadPool* nextPool = pool;
+		std::shared_ptr<TypedTaskState<T>> parent = state;
+		state->onFinished([nextPool, parent, next, fn = std::forward<Fn>(fn), taskName, priority]() mutable
+		{
+			if (parent->status.load() != TaskStatus::Completed)
+			{
+				next->tryCancel();
+				return;
+			}
+
+			GlobalThreadPool::PoolTask task = {};
+			task.state = next;
+			task.taskName = taskName;
+			task.priority = priority;
+			task.group = next->group;
+			task.fn = [parent, next, fn = std::move(fn)]() mutable
+			{
+				if constexpr (std::is_void_v<T> && std::is_void_v<R>)
+				{
+					fn();
+				}
+				else if constexpr (std::is_void_v<T>)
+				{
+					next->result.emplace(fn());
+				}
+				else if constexpr (std::is_void_v<R>)
+				{
+					fn(*parent->result);
+				}
+				else
+				{
+					next->result.emplace(fn(*parent->result));
+				}
+				next->finish(TaskStatus::Completed);
+			};
+			nextPool->schedule(std::move(task));
+		});
+
+		return TaskHandle<R>(pool, next);
+	}
+
+	template<typename Fn>
+	auto GlobalThreadPool::submit(Fn&& fn, const char* taskName, Priority priority)
+		-> TaskHandle<std::invoke_result_t<std::decay_t<Fn>>>
+	{
+		return submitInGroup(std::forward<Fn>(fn), taskName, priority, nextGroup.fetch_add(1));
+	}
+
+	template<typename Fn>
+	auto GlobalThreadPool::submitInGroup(Fn&& fn, const char* taskName, Priority priority, uint64 group)
+		-> TaskHandle<std::invoke_result_t<std::decay_t<Fn>>>
+	{
+		using T = std::invoke_result_t<std::decay_t<Fn>>;
+
+		auto state = std::make_shared<TypedTaskState<T>>();
+		state->group = group;
+		PoolTask task = {};
+		task.state = state;
+		task.taskName = taskName;
+		task.priority = priority;
+		task.group = group;
+		task.fn = [state, fn = std::forward<Fn>(fn)]() mutable
+		{
+			if constexpr (std::is_void_v<T>)
+			{
+				fn();
+			}
+			else
+			{
+				state->result.emplace(fn());
+			}
+			state->finish(TaskStatus::Completed);
+		};
+		schedule(std::move(task));
+
+		return TaskHandle<T>(this, state);
+	}
+
+	template<typename Fn>
+	void GlobalThreadPool::parallelFor(size_t begin, size_t end, size_t grainSize, Fn&& fn, const char* taskName, Priority priority)
+	{
+		if (end <= begin)
+		{
+			return;
+		}
+
+		grainSize = glm::max(grainSize, (size_t)1);
+		size_t numChunks = (end - begin + grainSize - 1) / grainSize;
+
+		uint64 group = nextGroup.fetch_add(1);
+		std::vector<TaskHandle<void>> chunks;
+		chunks.reserve(numChunks - 1);
+		for (size_t chunk = 1; chunk < numChunks; chunk++)
+		{
+			size_t chunkBegin = begin + chunk * grainSize;
+			size_t chunkEnd = glm::min(chunkBegin + grainSize, end);
+			// NOTE: Capturing fn by reference is fine since we wait for every chunk before returning
+			chunks.push_back(submitInGroup([&fn, chunkBegin, chunkEnd]() { fn(chunkBegin, chunkEnd); }, taskName, priority, group));
+		}
+
+		fn(begin, glm::min(begin + grainSize, end));
+
+		for (const TaskHandle<void>& chunk : chunks)
+		{
+			chunk.wait();
+		}
+	}
 }
 
-#endif 
\ No newline at end of file
+#endif
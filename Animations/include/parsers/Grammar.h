@@ -3,8 +3,10 @@
 #include "core.h"
 #include "parsers/Common.h"
 #include "parsers/SyntaxTheme.h"
+#include "parsers/ScopeStack.h"
 
 #include <nlohmann/json_fwd.hpp>
+#include <string_view>
 
 namespace MathAnim
 {
@@ -17,6 +19,7 @@ namespace MathAnim
 	struct SyntaxPattern;
 	struct GrammarLineInfo;
 	struct SourceGrammarTree;
+	class GlobalThreadPool;
 
 	// Typedefs
 	typedef uint64 GrammarPatternGid;
@@ -33,12 +36,14 @@ namespace MathAnim
 		std::vector<SyntaxPattern*> patterns;
 		std::unordered_map<uint64, GrammarPatternGid> onigIndexMap;
 		uint64 firstSelfPatternArrayIndex;
-		OnigRegSet* regset;
+		// Begin/match regexes of every pattern in this array (with includes flattened), indexed by the
+		// keys in `onigIndexMap`. These are owned by the patterns themselves.
+		std::vector<OnigRegex> regexes;
 
 		// @returns The overall span of this match
-		MatchSpan tryParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const;
+		MatchSpan tryParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const;
 		// @returns The overall span of all matches contained by this pattern array
-		MatchSpan tryParseAll(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const;
+		MatchSpan tryParseAll(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const;
 
 		void free();
 	};
@@ -89,7 +94,7 @@ namespace MathAnim
 		void popScopeFromAncestorStack(GrammarLineInfo& line) const;
 
 		// @returns The overall span of this match
-		MatchSpan tryParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const;
+		MatchSpan tryParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const;
 
 		void free();
 	};
@@ -107,9 +112,9 @@ namespace MathAnim
 		void popScopeFromAncestorStack(GrammarLineInfo& line) const;
 
 		// @returns The overall span of this match
-		MatchSpan tryParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self, GrammarPatternGid gid) const;
+		MatchSpan tryParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self, GrammarPatternGid gid) const;
 		// @returns The overall span of this match
-		MatchSpan resumeParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t currentByte, std::string const& dynamicEndPattern, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const;
+		MatchSpan resumeParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t currentByte, std::string const& dynamicEndPattern, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const;
 
 		void free();
 	};
@@ -135,7 +140,7 @@ namespace MathAnim
 		uint64 patternArrayIndex;
 		
 		// @returns The overall span of this match
-		MatchSpan tryParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t endOffset, const PatternRepository& repo, OnigRegion* region) const;
+		MatchSpan tryParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t endOffset, const PatternRepository& repo, OnigRegion* region) const;
 
 		void free();
 	};
@@ -152,16 +157,20 @@ namespace MathAnim
 		std::optional<ScopedName> scope;
 	};
 
+	struct SourceSyntaxToken_Debug;
 	struct SourceSyntaxToken
 	{
 		// The byte that this token starts at, relative to the beginning of the line
 		uint32 relativeStart;
+		// Style resolved from the theme when the token was parsed
 		PackedSyntaxStyle style;
-		std::vector<ScopedName> debugAncestorStack;
+		// Ancestors of this token, see ScopeStacks::get
+		ScopeStackId ancestorStackId;
+
+		SourceSyntaxToken_Debug getDebugToken() const;
 	};
 
-	// TODO: Make this the only data structure that adds a debug ancestor stack to every token.
-	//       That way, we don't use this except for fast paths.
+	// Only built on demand, for debug views and tests
 	struct SourceSyntaxToken_Debug
 	{
 		// The byte that this token starts at, relative to the beginning of the line
@@ -226,7 +235,6 @@ namespace MathAnim
 		std::string fileTypes;
 		PatternArray patterns;
 		PatternRepository repository;
-		OnigRegion* region;
 		std::unordered_map<GrammarPatternGid, SyntaxPattern const *const> globalPatternIndex;
 		GrammarPatternGid gidCounter;
 
@@ -238,6 +246,12 @@ namespace MathAnim
 		// @deprecated -- Do it yourself, no really. Do it yourself.
 		SourceGrammarTree Grammar::parseCodeBlock(const char* code, size_t codeLength, SyntaxTheme const& theme) const;
 
+		// Parses the whole code block by splitting it into chunks that get tokenized on `threadPool`. Each chunk
+		// starts at a line that most likely doesn't continue a multiline pattern. Afterwards the pattern stack at
+		// every seam gets verified and any lines that were tokenized with the wrong state get re-parsed.
+		// Falls back to `parseCodeBlock` for small code blocks.
+		SourceGrammarTree parseCodeBlockParallel(const char* code, size_t codeLength, SyntaxTheme const& theme, GlobalThreadPool& threadPool) const;
+
 		static Grammar* importGrammar(const char* filepath);
 		static void free(Grammar* grammar);
 	};
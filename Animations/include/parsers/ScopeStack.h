@@ -0,0 +1,31 @@
+#ifndef MATH_ANIM_SCOPE_STACK_H
+#define MATH_ANIM_SCOPE_STACK_H
+#include "core.h"
+#include "parsers/Common.h"
+
+namespace MathAnim
+{
+	// Id of an interned ancestor stack. Stacks are stored as a tree where every node is one
+	// scope plus the id of the stack below it, so tokens that share ancestors share storage.
+	typedef uint32 ScopeStackId;
+	static constexpr ScopeStackId EMPTY_SCOPE_STACK = 0;
+
+	namespace ScopeStacks
+	{
+		// Thread safe, the same stack always returns the same id
+		ScopeStackId intern(std::vector<ScopedName> const& stack);
+
+		// Builds the full stack from the bottom (index 0) to the top
+		std::vector<ScopedName> get(ScopeStackId id);
+		size_t getDepth(ScopeStackId id);
+		// Returns the scope at the top of the stack, `id` can't be the empty stack
+		ScopedName getTop(ScopeStackId id);
+
+		size_t getNumInternedScopes();
+
+		// Invalidates every id handed out so far
+		void free();
+	}
+}
+
+#endif
@@ -7,6 +7,9 @@
 
 namespace MathAnim
 {
+	class TextDocument;
+	struct TextEdit;
+
 	enum class HighlighterLanguage : uint8
 	{
 		None,
@@ -154,7 +157,8 @@ namespace MathAnim
 
 		CodeHighlightDebugInfo getAncestorsFor(SyntaxTheme const* theme, CodeHighlights const& highlights, size_t cursorPos) const;
 
-		CodeHighlights parse(const char* code, size_t codeLength, const SyntaxTheme& theme) const;
+		// If a thread pool is passed in, large code blocks get tokenized in parallel chunks
+		CodeHighlights parse(const char* code, size_t codeLength, const SyntaxTheme& theme, GlobalThreadPool* threadPool = nullptr) const;
 
 		/**
 		* @brief This function checksand updates any lines starting from `lineToCheckFrom`and ending at
@@ -199,7 +203,31 @@ namespace MathAnim
 		*/
 		Vec2i removeText(CodeHighlights& highlights, const char* newCodeBlock, size_t newCodeBlockLength, size_t removeStart, size_t numLinesRemoved, size_t maxLinesToUpdate = DEFAULT_MAX_LINES_TO_UPDATE) const;
 
-		std::string getStringifiedParseTreeFor(const std::string& code, SyntaxTheme const& theme) const;
+		/**
+		* @brief Same as the other `insertText`, but takes the edit straight from a `TextDocument`. The document
+		*        should already have the insertion applied.
+		*
+		* @param highlights The highlights object that will be modified if any updates are found
+		* @param document The document the edit was made to
+		* @param edit The edit returned by `TextDocument::insert`
+		* @param maxLinesToUpdate The maximum number of lines that can be updated before this function exits early
+		* @returns A span that indicates the first line updated and the last line updated
+		*/
+		Vec2i insertText(CodeHighlights& highlights, TextDocument const& document, TextEdit const& edit, size_t maxLinesToUpdate = DEFAULT_MAX_LINES_TO_UPDATE) const;
+
+		/**
+		* @brief Same as the other `removeText`, but takes the edit straight from a `TextDocument`. The document
+		*        should already have the removal applied.
+		*
+		* @param highlights The highlights object that will be modified if any updates are found
+		* @param document The document the edit was made to
+		* @param edit The edit returned by `TextDocument::remove`
+		* @param maxLinesToUpdate The maximum number of lines that can be updated before this function exits early
+		* @returns A span that indicates the first line updated and the last line updated
+		*/
+		Vec2i removeText(CodeHighlights& highlights, TextDocument const& document, TextEdit const& edit, size_t maxLinesToUpdate = DEFAULT_MAX_LINES_TO_UPDATE) const;
+
+		std::string getStringifiedParseTreeFor(const std::string& code, SyntaxTheme const& theme, GlobalThreadPool* threadPool = nullptr) const;
 
 		void free();
 
@@ -0,0 +1,50 @@
+#ifndef MATH_ANIM_BVH_H
+#define MATH_ANIM_BVH_H
+#include "core.h"
+
+#include "physics/Physics.h"
+
+namespace MathAnim
+{
+	// Bounding volume hierarchy over a list of AABBs. Raycasts only test the boxes whose
+	// parent nodes were hit, instead of every box in the list.
+	class Bvh
+	{
+	public:
+		Bvh()
+			: nodes(), indices()
+		{
+		}
+
+		// Rebuilds the whole tree, box i in the list is reported as index i by raycasts
+		void build(const std::vector<AABB>& boxes);
+		void clear();
+
+		// Appends the index of every box the ray hits to outHits, in no particular order
+		void raycast(const Ray& ray, std::vector<uint32>& outHits) const;
+
+		inline size_t getNumNodes() const { return nodes.size(); }
+
+	public:
+		static constexpr uint32 maxBoxesPerLeaf = 4;
+
+	private:
+		struct Node
+		{
+			AABB bounds;
+			// Leaves store a range of indices, inner nodes store their right child.
+			// The left child always comes right after its parent.
+			uint32 firstIndex;
+			uint32 numIndices;
+			uint32 rightChild;
+		};
+
+		uint32 buildNode(const std::vector<AABB>& boxes, uint32 firstIndex, uint32 numIndices);
+
+	private:
+		std::vector<Node> nodes;
+		std::vector<uint32> indices;
+	};
+}
+
+#endif
@@ -64,6 +64,8 @@ namespace MathAnim
 	{
 		Ray createRay(const Vec3& start, const Vec3& end);
 		AABB createAABB(const Vec3& center, const Vec3& size);
+		// Smallest AABB that contains the whole OBB
+		AABB createAABB(const OBB& obb);
 
 		inline Sphere createSphere(const Vec3& center, float radius) { return Sphere{ center, radius }; }
 		inline Torus createTorus(const Vec3& center, const Vec3& forward, const Vec3& up, float innerRadius, float outerRadius)
@@ -72,6 +74,7 @@ namespace MathAnim
 		}
 
 		RaycastResult rayIntersectsAABB(const Ray& ray, const AABB& aabb);
+		RaycastResult rayIntersectsOBB(const Ray& ray, const OBB& obb);
 		RaycastResult rayIntersectsSphere(const Ray& ray, const Sphere& sphere);
 		RaycastResult rayIntersectsTorus(const Ray& ray, const Torus& torus);
 	}
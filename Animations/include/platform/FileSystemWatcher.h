@@ -2,6 +2,10 @@
 #define MATH_ANIM_FILE_SYSTEM_WATCHER
 #include "core.h"
 
+#include <chrono>
+#include <map>
+#include <atomic>
+
 namespace MathAnim
 {
 	enum NotifyFilters
@@ -16,6 +20,68 @@ namespace MathAnim
 		Security = 256
 	};
 
+	enum class FileSystemEvent : uint8
+	{
+		// Used for files that were created and deleted again within one debounce window
+		None = 0,
+		Created,
+		Changed,
+		Renamed,
+		Deleted,
+	};
+
+	// What the platform layer saw happen to a single file, before any coalescing
+	enum class RawFileSystemEvent : uint8
+	{
+		Created,
+		Modified,
+		Deleted,
+		MovedFrom,
+		MovedTo,
+	};
+
+	// Turns the raw events of a watched tree into at most one reported event per path for
+	// every burst of activity. It has no clock or threads of its own so the rules can be
+	// tested without touching the file system.
+	class FileSystemEventCoalescer
+	{
+	public:
+		// `cookie` ties the MovedFrom and MovedTo halves of one rename together and is 0 for
+		// everything else. A MovedTo onto a file that already exists is reported as a change,
+		// since that's how editors that save atomically replace a file.
+		void addEvent(RawFileSystemEvent event, const std::filesystem::path& file, uint32 cookie, std::chrono::steady_clock::time_point now);
+		// Files that were already there when watching started
+		void addExistingFile(const std::filesystem::path& file);
+		// Forgets every known file below `dir`, for directories that got moved out of the tree
+		void removeDirectory(const std::filesystem::path& dir);
+
+		// Removes and returns the events of every path that's been quiet for `debounceWindow`
+		std::vector<std::pair<std::filesystem::path, FileSystemEvent>> takeReadyEvents(
+			std::chrono::steady_clock::time_point now,
+			std::chrono::milliseconds debounceWindow
+		);
+
+	private:
+		struct PendingEvent
+		{
+			FileSystemEvent event;
+			std::chrono::steady_clock::time_point firstEventTime;
+			std::chrono::steady_clock::time_point lastEventTime;
+		};
+
+		void queueEvent(FileSystemEvent event, const std::filesystem::path& file, std::chrono::steady_clock::time_point now);
+
+	private:
+		std::set<std::filesystem::path> knownFiles;
+		// Sources of renames that are still waiting for their MovedTo half
+		std::unordered_map<uint32, std::filesystem::path> movedFrom;
+		std::map<std::filesystem::path, PendingEvent> pendingEvents;
+	};
+
+	// Watches `path` on its own thread and reports changes from poll(). Every event for a path
+	// that happens within `debounceWindowMs` of the last one gets coalesced into one, so an editor
+	// saving through a temp file and a rename only shows up as a single change. Paths passed to
+	// the callbacks are relative to `path`.
 	class FileSystemWatcher
 	{
 	public:
@@ -24,6 +90,7 @@ namespace MathAnim
 		void start();
 		void stop();
 
+		// Runs the callbacks for every path that's been quiet for the debounce window
 		void poll();
 
 	public:
@@ -39,28 +106,39 @@ namespace MathAnim
 
 		int notifyFilters = 0;
 		bool includeSubdirectories = false;
+		uint32 debounceWindowMs = 100;
 		std::string filter = "";
 		std::filesystem::path path = "";
 
 	private:
-		bool enableRaisingEvents = true;
+		// Called from the watcher thread
+		void queueEvent(RawFileSystemEvent event, const std::filesystem::path& file, uint32 cookie = 0);
+		void addExistingFile(const std::filesystem::path& file);
+		void startThread();
+
+#ifdef __linux
+		void addWatch(const std::filesystem::path& relativeDir, bool reportContents);
+		// Removes the watches for `relativeDir` and everything below it
+		void removeWatches(const std::filesystem::path& relativeDir);
+		void readEvents();
+#endif
+
+	private:
+		std::atomic<bool> enableRaisingEvents = true;
 		std::thread fileWatcherThread;
 		void* stopEventHandle;
 
-		std::set<std::filesystem::path> changedQueue;
-		std::set<std::filesystem::path> renamedQueue;
-		std::set<std::filesystem::path> deletedQueue;
-		std::set<std::filesystem::path> createdQueue;
-
-		std::set<std::filesystem::path> prevChangedQueue;
-		std::set<std::filesystem::path> prevRenamedQueue;
-		std::set<std::filesystem::path> prevDeletedQueue;
-		std::set<std::filesystem::path> prevCreatedQueue;
+#ifdef __linux
+		int inotifyDescriptor = -1;
+		// stop() writes to this to wake the watcher thread up
+		int stopPipe[2] = { -1, -1 };
+		uint32 watchMask = 0;
+		// Only touched by the watcher thread. Watch descriptor -> directory relative to `path`
+		std::unordered_map<int, std::filesystem::path> watchedDirectories;
+#endif
 
+		FileSystemEventCoalescer coalescer;
 		std::mutex queueMtx;
-
-	private:
-		void startThread();
 	};
 }
 
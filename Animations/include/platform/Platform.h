@@ -44,6 +44,9 @@ namespace MathAnim
 
 		MemMappedFile* createTmpMemMappedFile(const std::string& directory, size_t fileSize);
 
+		// Maps an existing file into memory as read only. Returns nullptr if the file can't be mapped.
+		MemMappedFile* openMemMappedFile(const char* filepath);
+
 		void freeMemMappedFile(MemMappedFile* file);
 
 		void createDirIfNotExists(const char* dirName);
@@ -2,6 +2,7 @@
 #define MATH_ANIM_FONTS_H
 #include "core.h"
 #include "renderer/Texture.h"
+#include "utils/AtlasAllocator.h"
 
 namespace MathAnim
 {
@@ -45,19 +46,30 @@ namespace MathAnim
 
 	struct GlyphTexture
 	{
-		uint32 lruCacheId;
+		// Index into SizedFont::atlasPages
+		uint32 atlasPage;
 		Vec2 uvMin;
 		Vec2 uvMax;
 	};
 
+	// Glyphs get packed into a page until it runs out of room, then
+	// a new page is added to the font
+	struct FontAtlasPage
+	{
+		Texture texture;
+		AtlasAllocator allocator;
+	};
+
 	struct SizedFont
 	{
 		Font* unsizedFont;
 		std::unordered_map<uint32, GlyphTexture> glyphTextureCoords;
+		std::vector<FontAtlasPage> atlasPages;
 		int fontSizePixels;
-		Texture texture;
+		bool singleChannelTexture;
 
 		const GlyphTexture& getGlyphTexture(uint32 codepoint) const;
+		const Texture& getAtlasTexture(const GlyphTexture& glyphTexture) const;
 		inline const GlyphOutline& getGlyphInfo(uint32 glyphIndex) const { g_logger_assert(unsizedFont != nullptr, "How did this happen."); return unsizedFont->getGlyphInfo(glyphIndex); }
 		inline float getKerning(uint32 leftCodepoint, uint32 rightCodepoint) const { g_logger_assert(unsizedFont != nullptr, "How did this happen."); return unsizedFont->getKerning(leftCodepoint, rightCodepoint); }
 		inline glm::vec2 getSizeOfString(const std::string& string) const { g_logger_assert(unsizedFont != nullptr, "How did this happen."); return unsizedFont->getSizeOfString(string, fontSizePixels); }
@@ -122,6 +134,12 @@ namespace MathAnim
 		void unloadAllFonts();
 
 		Font* getDefaultMonoFont();
+
+		void endFrame();
+
+		// Glyph bitmaps rendered by freetype and uploaded to a font atlas during the last frame
+		int getNumGlyphsRasterizedLastFrame();
+		uint64 getTotalNumGlyphsRasterized();
 	}
 }
 
@@ -14,6 +14,10 @@ namespace MathAnim
 
 		// Gets the maximum number of texture units able to be bound by the fragment shader
 		int32 getMaxTextureImageUnits();
+		// Whether buffers can be created with bufferStorage and stay mapped while the GPU reads them (GL 4.4)
+		bool supportsPersistentMapping();
+		// Whether multiDrawElementsIndirect is available (GL 4.3)
+		bool supportsMultiDrawIndirect();
 
 		// Blending
 		void blendFunc(GLenum sfactor, GLenum dfactor);
@@ -54,7 +58,14 @@ namespace MathAnim
 		void genBuffers(GLsizei n, GLuint* buffers);
 		void deleteBuffers(GLsizei n, const GLuint* buffers);
 		void* mapBuffer(GLenum target, GLenum access);
+		void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
 		GLboolean unmapBuffer(GLenum target);
+		void bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+		// Sync objects
+		GLsync fenceSync(GLenum condition, GLbitfield flags);
+		GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+		void deleteSync(GLsync sync);
 
 		// Stencil/Scissor stuff
 		void scissor(GLint x, GLint y, GLsizei width, GLsizei height);
@@ -66,6 +77,8 @@ namespace MathAnim
 		void drawArrays(GLenum mode, GLint first, GLsizei count);
 		void drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
 		void drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex);
+		void multiDrawElementsBaseVertex(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawcount, const GLint* basevertex);
+		void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
 
 		// Textures
 		void readPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
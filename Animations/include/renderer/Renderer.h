@@ -12,6 +12,7 @@ namespace MathAnim
 	struct SizedFont;
 	struct AnimationManagerData;
 	struct Path2DContext;
+	struct StrokeTessellation;
 
 	enum class CapType
 	{
@@ -96,6 +97,19 @@ namespace MathAnim
 
 		void setTransform(Path2DContext* path, const glm::mat4& transform);
 
+		// Strokes that get flattened and extruded once, then re-emitted every frame until their geometry
+		// changes. The key should identify the stroke's geometry and stroke width, the transform and color
+		// are applied when the stroke is drawn. Cached strokes may get evicted by the next call to cacheStroke.
+		const StrokeTessellation* getCachedStroke(uint64 key);
+		const StrokeTessellation* cacheStroke(uint64 key, const Path2DContext* path);
+		// Draws the first percentToDraw of the stroke's length with the current color. Anything less than
+		// the whole stroke gets drawn as an open path.
+		void drawStroke(const StrokeTessellation* stroke, float percentToDraw, const glm::mat4& transform, AnimObjId objId = NULL_ANIM_OBJECT);
+		float getStrokeLength(const StrokeTessellation* stroke);
+		// Where a stroke drawn up to percentToDraw of its length stops, before the transform is applied.
+		// outSegmentStart gets the index of the vertex that starts the segment the stroke stops in.
+		Vec2 getStrokeCutPoint(const StrokeTessellation* stroke, float percentToDraw, int* outSegmentStart = nullptr);
+
 		// ----------- 3D stuff ----------- 
 		
 		// 3D Lines
@@ -136,6 +150,11 @@ namespace MathAnim
 		int getDrawList3DNumTris();
 		int getDrawList3DLineNumTris();
 		int getDrawList3DBillboardNumTris();
+
+		// Actual GL draw calls issued this frame, after draw commands got batched together
+		int getNumGlDrawCalls();
+		// Vertex, index and indirect command bytes streamed to the GPU this frame
+		size_t getNumBytesUploaded();
 	}
 }
 
@@ -0,0 +1,43 @@
+#ifndef MATH_ANIM_SOFTWARE_RENDERER_H
+#define MATH_ANIM_SOFTWARE_RENDERER_H
+#include "core.h"
+
+namespace MathAnim
+{
+	struct AnimationManagerData;
+	struct Camera;
+	class GlobalThreadPool;
+
+	// CPU framebuffer that plutovg rasterizes into. Pixels are stored the
+	// same way plutovg stores them, premultiplied ARGB32 in native byte order.
+	struct SoftwareFramebuffer
+	{
+		uint8* pixels;
+		int width;
+		int height;
+		int stride;
+	};
+
+	// Alternative to the OpenGL Renderer that rasterizes the scene entirely on the
+	// CPU with plutovg. Only used for exporting videos, so it only draws what the
+	// final output needs (svg fills, outlines and images). No gizmos, outlines or
+	// editor overlays.
+	namespace SoftwareRenderer
+	{
+		void init();
+
+		void free();
+
+		SoftwareFramebuffer createFramebuffer(int width, int height);
+		void destroyFramebuffer(SoftwareFramebuffer& framebuffer);
+
+		// Rasterizes every visible object in the scene as seen through camera. If a thread pool
+		// is provided the framebuffer is split into horizontal tiles that are rasterized in parallel.
+		void renderToFramebuffer(SoftwareFramebuffer& framebuffer, const AnimationManagerData* am, const Camera& camera, GlobalThreadPool* threadPool = nullptr);
+
+		// Converts the framebuffer to planar YUV 4:2:0, the layout VideoEncoder::pushYuvFrame expects
+		void convertToYuv420(const SoftwareFramebuffer& framebuffer, uint8* yuvPixels, size_t yuvPixelsSize);
+	}
+}
+
+#endif
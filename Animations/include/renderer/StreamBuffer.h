@@ -0,0 +1,53 @@
+#ifndef MATH_ANIM_STREAM_BUFFER_H
+#define MATH_ANIM_STREAM_BUFFER_H
+#include "core.h"
+
+namespace MathAnim
+{
+	// GPU buffer that gets refilled from the CPU every time something is drawn. The buffer
+	// is split into a few regions that are used round robin, so the CPU can write the next
+	// batch while the GPU is still reading the previous one.
+	//
+	// On GL 4.4+ the buffer stays persistently mapped and each region is guarded by a fence.
+	// Older drivers fall back to orphaning the buffer with bufferData before every upload.
+	class StreamBuffer
+	{
+	public:
+		StreamBuffer()
+			: id(UINT32_MAX), mappedData(nullptr), fences(), regionSize(0), numRegions(0), currentRegion(0), isPersistent(false)
+		{
+		}
+
+		void create(size_t initialRegionSize, uint8 numRegions = 3);
+		void free();
+
+		// Copies data into the next free region and returns the byte offset the data starts at
+		// in the buffer. The buffer gets reallocated if the data doesn't fit, so anything that
+		// references getId() (like a VAO) needs to be rebound after every upload.
+		size_t upload(const void* data, size_t size);
+
+		// Call once every draw call that reads the last upload has been issued, so the
+		// region doesn't get overwritten before the GPU is done with it.
+		void fence();
+
+		inline uint32 getId() const { return id; }
+
+	public:
+		static constexpr uint8 maxNumRegions = 4;
+
+	private:
+		void allocate(size_t newRegionSize);
+		void waitForRegion(uint8 region);
+
+	private:
+		uint32 id;
+		uint8* mappedData;
+		GLsync fences[maxNumRegions];
+		size_t regionSize;
+		uint8 numRegions;
+		uint8 currentRegion;
+		bool isPersistent;
+	};
+}
+
+#endif
@@ -8,7 +8,9 @@ namespace MathAnim
 
 	namespace LuauLayer
 	{
-		void init(const std::filesystem::path& scriptDirectory, AnimationManagerData* am);
+		// Compiled bytecode is cached in `bytecodeCacheDirectory`, one file per script, so scripts that haven't
+		// changed since the last launch skip compilation. They still get analyzed every time.
+		void init(const std::filesystem::path& scriptDirectory, const std::filesystem::path& bytecodeCacheDirectory, AnimationManagerData* am);
 
 		void update();
 
@@ -21,8 +23,14 @@ namespace MathAnim
 
 		bool remove(const std::string& scriptName);
 
+		// When enabled, scripts are compiled with optimization level 2 and scripts that run more than
+		// once get compiled to native code. Only affects scripts compiled after the change.
+		void setNativeCodeGenEnabled(bool enabled);
+		bool isNativeCodeGenEnabled();
+		bool isNativeCodeGenSupported();
+
 		void free();
 	}
 }
 
-#endif 
\ No newline at end of file
+#endif
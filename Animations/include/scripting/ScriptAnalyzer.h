@@ -19,10 +19,17 @@ namespace MathAnim
 		bool analyze(const std::string& filename);
 		bool analyze(const std::string& sourceCode, const std::string& scriptName);
 
+		// Every module the last analyzed script required, directly or through another module
+		inline const std::vector<std::string>& getRequiredModules() const { return requiredModules; }
+
 		void free();
 
+	private:
+		void collectRequiredModules(const std::string& scriptName);
+
 	private:
 		const std::filesystem::path m_scriptDirectory;
+		std::vector<std::string> requiredModules;
 		Luau::FileResolver* fileResolver;
 		Luau::ConfigResolver* configResolver;
 		Luau::Frontend* frontend;
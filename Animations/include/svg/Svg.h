@@ -106,6 +106,8 @@ namespace MathAnim
 		std::string getPathAsString() const;
 		// NOTE: See binary path format in SvgParser.h for details on the format of this string
 		RawMemory getPathAsBinaryString() const;
+		// Same as getPathAsBinaryString() without the base64 encoding
+		RawMemory getPathAsBinary() const;
 		float calculateSvgScale(float targetWidth) const;
 		void render(float svgScale, const Texture& texture, const Vec2& textureOffset) const;
 		void renderAsync(float svgScale, const Texture& texture, const Vec2& textureOffset) const;
@@ -115,10 +117,37 @@ namespace MathAnim
 		void serialize(nlohmann::json& j) const;
 		static SvgObject* deserialize(const nlohmann::json& j, uint32 version);
 
+		// Used by the binary scene format, which stores the path as a raw binary blob next to the style
+		void serializeStyle(nlohmann::json& j) const;
+		static SvgObject* deserializeWithBinPath(const nlohmann::json& style, const uint8* binPath, size_t binPathSize);
+
 		[[deprecated("This is for upgrading legacy projects developed in beta")]]
 		static SvgObject* legacy_deserialize(RawMemory& memory, uint32 version);
 	};
 
+	// Two shapes split up so they have the same number of sub-paths and curves, with every
+	// curve stored as bezier3 control points. This only depends on the source and target
+	// shapes, so it can be built once and blended into an existing object every frame.
+	struct SvgMorph
+	{
+		// Per path: the first point of the path, then p1, p2, p3 of every curve in the path
+		Vec2* srcPoints;
+		Vec2* dstPoints;
+		int* pathNumCurves;
+		bool* srcIsHole;
+		bool* dstIsHole;
+		int numPaths;
+		int numCurves;
+		uint64 srcMd5Hash;
+		uint64 dstMd5Hash;
+		// md5 given to every object interpolated with this morph
+		uint8* md5;
+		size_t md5Length;
+
+		bool isMorphBetween(const SvgObject* src, const SvgObject* dst) const;
+		void free();
+	};
+
 	struct SvgGroup
 	{
 		char** uniqueObjectNames;
@@ -165,6 +194,23 @@ namespace MathAnim
 		void addCurveManually(SvgObject* object, const Curve& curve);
 
 		void copy(SvgObject* dest, const SvgObject* src);
+
+		// Heap allocated SvgObjects can be shared between several owners. Shared objects must be
+		// treated as immutable, anything that wants to modify one has to make its own copy first.
+		// An object that was never retained has a single owner, and release() just frees it.
+		SvgObject* retain(SvgObject* object);
+		void release(SvgObject* object);
+		bool isShared(const SvgObject* object);
+
+		// Finds the path an outline drawn up to t of the object's perimeter stops in, and how much of that
+		// path gets drawn. Every path before it is drawn completely. Returns -1 if nothing gets drawn and
+		// numPaths if every path is drawn completely.
+		int getOutlineCutPoint(const SvgObject* object, float t, float* outPercentOfPath);
+
+		SvgMorph createMorph(const SvgObject* src, const SvgObject* dst);
+		// Blends the morph into dest, reusing any memory dest already has
+		void interpolateInto(const SvgMorph& morph, float t, SvgObject* dest);
+		// Convenience for one-off interpolations, this creates and frees a morph every call
 		SvgObject* interpolate(const SvgObject* src, const SvgObject* dst, float t);
 	}
 }
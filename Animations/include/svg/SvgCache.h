@@ -3,6 +3,7 @@
 #include "core.h"
 #include "renderer/Framebuffer.h"
 #include "utils/LRUCache.hpp"
+#include "utils/AtlasAllocator.h"
 
 namespace MathAnim
 {
@@ -24,20 +25,26 @@ namespace MathAnim
 		Vec2 texCoordsMin;
 		Vec2 texCoordsMax;
 		Vec2 svgSize;
-		Vec2 allottedSize;
 		Vec2 textureOffset;
+		AtlasRegion region;
 		int colorAttachment;
 	};
 
+	struct SvgCacheStats
+	{
+		uint64 hits;
+		uint64 misses;
+		uint64 evictions;
+	};
+
 	class SvgCache
 	{
 	public:
 		SvgCache() :
 			cachedSvgs(),
 			framebuffer(),
-			cacheCurrentPos(Vec2{ 0, 0 }),
-			cacheCurrentColorAttachment(0),
-			cacheLineHeight(0.0f)
+			atlases(),
+			stats()
 		{
 		}
 
@@ -55,16 +62,15 @@ namespace MathAnim
 		void render(AnimationManagerData* am, SvgObject* svg, AnimObjId obj);
 
 		const Framebuffer& getFramebuffer();
+		const SvgCacheStats& getStats() const { return stats; }
+		AtlasStats getAtlasStats(int colorAttachment) const;
 
 	public:
 		static Vec2 cachePadding;
 
 	private:
-		Vec2 incrementCacheCurrentY();
-		Vec2 incrementCacheCurrentX(float distance);
-		//const Vec2& getCacheCurrentPos();
-		void checkLineHeight(float newLineHeight);
-		void growCache();
+		bool allocateRegion(int width, int height, AtlasRegion* outRegion, int* outColorAttachment);
+		bool evictOldest();
 
 		std::optional<_SvgCacheEntryInternal> getInternal(uint64 hash);
 		bool existsInternal(uint64 hash);
@@ -76,12 +82,9 @@ namespace MathAnim
 	private:
 		LRUCache<uint64, _SvgCacheEntryInternal> cachedSvgs;
 		Framebuffer framebuffer;
-
-	public:
-		Vec2 cacheCurrentPos;
-	private:
-		int cacheCurrentColorAttachment;
-		float cacheLineHeight;
+		// One allocator per color attachment of framebuffer
+		std::vector<AtlasAllocator> atlases;
+		SvgCacheStats stats;
 	};
 }
 
@@ -0,0 +1,59 @@
+#ifndef MATH_ANIM_ATLAS_ALLOCATOR_H
+#define MATH_ANIM_ATLAS_ALLOCATOR_H
+#include "core.h"
+
+namespace MathAnim
+{
+	struct AtlasRegion
+	{
+		int x;
+		int y;
+		int width;
+		int height;
+	};
+
+	struct AtlasStats
+	{
+		uint64 usedArea;
+		uint64 freeArea;
+		uint64 largestFreeArea;
+		uint32 numAllocations;
+		uint32 numFreeRegions;
+
+		// Fraction of the atlas that is allocated
+		float occupancy() const;
+		// 0 when all the free space is one big region, approaches 1 as it gets split into slivers
+		float fragmentation() const;
+	};
+
+	// Guillotine rectangle allocator. Free space is kept as a list of disjoint rectangles.
+	// Allocations are cut out of the free rectangle that fits them best, and released
+	// regions go back on the free list where they get merged with their neighbors so
+	// evicted space can be reused by allocations of a different size.
+	class AtlasAllocator
+	{
+	public:
+		void init(int width, int height);
+		void clear();
+
+		bool allocate(int width, int height, AtlasRegion* outRegion);
+		void release(const AtlasRegion& region);
+
+		AtlasStats getStats() const;
+		inline int getWidth() const { return width; }
+		inline int getHeight() const { return height; }
+
+	private:
+		// Adds region to the free list, merging it with any free neighbor that shares a full edge
+		void insertFreeRegion(AtlasRegion region);
+
+	private:
+		std::vector<AtlasRegion> freeRegions;
+		uint64 usedArea;
+		uint32 numAllocations;
+		int width;
+		int height;
+	};
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef MATH_ANIM_TEXT_DOCUMENT_H
+#define MATH_ANIM_TEXT_DOCUMENT_H
+#include "core.h"
+
+namespace MathAnim
+{
+	class TextDocument;
+
+	// Describes a single insertion or removal. Lines are 0-based and line counts are the number
+	// of newline characters that were added or removed.
+	struct TextEdit
+	{
+		size_t byteStart;
+		size_t numBytesRemoved;
+		size_t numBytesInserted;
+		size_t lineStart;
+		size_t numLinesRemoved;
+		size_t numLinesInserted;
+	};
+
+	// UTF-8 iterator over a TextDocument. Only holds a byte position, so it's fine to assign
+	// `bytePos` directly or keep it around while the document gets edited.
+	struct TextDocumentIter
+	{
+		TextDocument const* document;
+		size_t bytePos;
+
+		// Returns the codepoint starting at `bytePos`
+		uint32 operator*() const;
+		TextDocumentIter& operator++();
+		TextDocumentIter& operator--();
+	};
+
+	// Piece table text buffer. The original text is never modified and everything that gets
+	// inserted is appended to a second buffer, so an edit only touches the pieces around it
+	// instead of moving the rest of the document. The pieces live in a balanced tree where every
+	// node knows how many bytes and newlines its subtree holds, and every buffer keeps the offsets
+	// of its newlines, so edits and line lookups are O(log pieces) no matter where they happen.
+	class TextDocument
+	{
+	public:
+		void init(uint8 const* text, size_t numBytes);
+		void free();
+
+		TextEdit insert(size_t byteOffset, uint8 const* text, size_t numBytes);
+		TextEdit remove(size_t byteOffset, size_t numBytes);
+
+		uint8 getByte(size_t byteOffset) const;
+		// Decodes the codepoint at `byteOffset`. Returns 0 past the end of the document.
+		uint32 getCodepoint(size_t byteOffset, uint8* outNumBytes = nullptr) const;
+		std::string getText(size_t byteOffset, size_t numBytes) const;
+		void copyText(size_t byteOffset, size_t numBytes, uint8* outBuffer) const;
+
+		// Flattens the document into one contiguous buffer, for things like the regex based syntax
+		// highlighter that can't work on pieces. Edits don't touch the cached copy, they queue a patch
+		// that gets applied the next time somebody asks for the flattened text. The returned pointer
+		// is only valid until the next edit.
+		uint8 const* getFlattenedText() const;
+
+		// Lines are 0-based, a document always has at least one line
+		size_t getNumLines() const;
+		size_t getLineStart(size_t line) const;
+		size_t getLineFromByte(size_t byteOffset) const;
+
+		TextDocumentIter makeIter(size_t byteOffset = 0) const;
+
+		inline size_t getLength() const { return length; }
+		inline size_t getNumPieces() const { return root == NULL_NODE ? 0 : nodes[root].numPieces; }
+
+	private:
+		enum class PieceBuffer : uint8
+		{
+			Original,
+			Added
+		};
+
+		struct Piece
+		{
+			PieceBuffer buffer;
+			uint32 start;
+			uint32 length;
+			uint32 numNewlines;
+		};
+
+		// Pieces are kept in an implicit treap ordered by their position in the document
+		struct PieceNode
+		{
+			Piece piece;
+			uint32 left;
+			uint32 right;
+			uint32 priority;
+			// Totals for the whole subtree, this node included
+			uint32 numPieces;
+			size_t numBytes;
+			size_t numNewlines;
+		};
+
+		struct PieceLocation
+		{
+			uint32 node;
+			// Number of bytes and newlines in the document before the piece
+			size_t byteStart;
+			size_t newlineStart;
+		};
+
+		// Edit that still has to be applied to the cached flattened text. Inserted bytes are
+		// always at the end of the added buffer when the edit happens, so they're still there.
+		struct FlattenedTextPatch
+		{
+			size_t byteOffset;
+			size_t numBytesRemoved;
+			uint32 addedStart;
+			uint32 numBytesInserted;
+		};
+
+		static constexpr uint32 NULL_NODE = UINT32_MAX;
+
+		Piece makePiece(PieceBuffer buffer, uint32 start, uint32 numBytes) const;
+		// `byteOffset` must be inside the document
+		PieceLocation findPiece(size_t byteOffset) const;
+		uint32 countNewlines(PieceBuffer buffer, uint32 start, uint32 numBytes) const;
+		void copyTextFrom(uint32 node, size_t nodeByteStart, size_t byteOffset, size_t numBytes, uint8* outBuffer) const;
+
+		uint32 createNode(Piece const& piece);
+		void freeNodes(uint32 node);
+		void updateNode(uint32 node);
+		uint32 merge(uint32 left, uint32 right);
+		// Splits the tree so that the left half holds exactly `byteOffset` bytes, cutting the
+		// piece at `byteOffset` in two if it has to
+		void split(uint32 node, size_t byteOffset, uint32* outLeft, uint32* outRight);
+		// Grows the last piece of the tree by `piece` if `piece` directly follows it in the added buffer
+		bool growLastPiece(uint32 node, Piece const& piece);
+		void queueFlattenedTextPatch(FlattenedTextPatch const& patch);
+
+		inline size_t getSubtreeBytes(uint32 node) const { return node == NULL_NODE ? 0 : nodes[node].numBytes; }
+		inline size_t getSubtreeNewlines(uint32 node) const { return node == NULL_NODE ? 0 : nodes[node].numNewlines; }
+		inline uint32 getSubtreePieces(uint32 node) const { return node == NULL_NODE ? 0 : nodes[node].numPieces; }
+
+		inline std::vector<uint8> const& getBuffer(PieceBuffer buffer) const { return buffer == PieceBuffer::Original ? originalText : addedText; }
+		inline std::vector<uint32> const& getNewlines(PieceBuffer buffer) const { return buffer == PieceBuffer::Original ? originalNewlines : addedNewlines; }
+
+	private:
+		std::vector<uint8> originalText;
+		std::vector<uint8> addedText;
+		std::vector<uint32> originalNewlines;
+		std::vector<uint32> addedNewlines;
+
+		std::vector<PieceNode> nodes;
+		std::vector<uint32> freeNodeIndices;
+		uint32 root;
+		uint32 priorityState;
+		size_t length;
+		size_t numNewlines;
+
+		mutable std::vector<uint8> flattenedText;
+		mutable std::vector<FlattenedTextPatch> flattenedTextPatches;
+		mutable bool flattenedTextIsValid;
+	};
+}
+
+#endif
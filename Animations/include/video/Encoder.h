@@ -8,14 +8,6 @@ extern "C" {
 
 namespace MathAnim
 {
-	struct MemMappedFile;
-
-	struct VideoFrame
-	{
-		uint8* pixels;
-		size_t pixelsSize;
-	};
-
 	enum class VideoEncoderFlags : uint8
 	{
 		None = 0,
@@ -25,17 +17,33 @@ namespace MathAnim
 
 	typedef int32 Mbps;
 
+	// Constant rate factor used by the AV1 encoder. Lower is higher quality, valid range is [1, 63]
+	static constexpr int DEFAULT_VIDEO_CRF = 28;
+
 	class VideoEncoder
 	{
 	public:
-		static VideoEncoder* startEncodingFile(const char* outputFilename, int outputWidth, int outputHeight, int outputFramerate, size_t totalNumFramesInVideo, VideoEncoderFlags flags = VideoEncoderFlags::None);
+		static VideoEncoder* startEncodingFile(const char* outputFilename, int outputWidth, int outputHeight, int outputFramerate, size_t totalNumFramesInVideo, VideoEncoderFlags flags = VideoEncoderFlags::None, int crf = DEFAULT_VIDEO_CRF);
 		static void finalizeEncodingFile(VideoEncoder* encoder);
 		static void freeEncoder(VideoEncoder* encoder);
 
 	public:
 		VideoEncoder() = default;
 
-		void pushYuvFrame(uint8* pixels, size_t pixelsSize);
+		// Copies a planar YUV 4:2:0 frame into the encoder's frame ring. If every frame in the ring
+		// is still waiting to be encoded this blocks until the encoder frees one up.
+		void pushYuvFrame(const uint8* pixels, size_t pixelsSize);
+
+		// Zero-copy version of pushYuvFrame. Blocks until a frame in the ring is free and returns it,
+		// write getFrameSize() bytes of planar YUV 4:2:0 into it and then call submitYuvFrame.
+		uint8* acquireYuvFrame();
+		void submitYuvFrame();
+		size_t getFrameSize() const { return frameSize; }
+
+		bool allFramesSent() const { return sentAllFrames.load(); }
+		// Blocks until more than lastNumFramesSent frames have been handed to the AV1 encoder, or
+		// every frame has been sent. Returns the number of frames sent so far.
+		uint64 waitForFramesSent(uint64 lastNumFramesSent, std::chrono::milliseconds timeout);
 
 		void setPercentComplete(float newVal);
 		float getPercentComplete() const { return percentComplete.load(); }
@@ -60,8 +68,15 @@ namespace MathAnim
 		bool logProgress;
 		VideoEncoderFlags flags;
 		FILE* outputFile;
-		MemMappedFile* videoFrameCache;
-		size_t numPushedFrames;
+
+		// Frame ring. Fixed size, so memory use doesn't depend on how long the video is
+		uint8* frameRing;
+		size_t frameSize;
+		int ringReadIndex;
+		int ringWriteIndex;
+		int numQueuedFrames;
+		uint64 numFramesSent;
+		bool frameAcquired;
 
 		// AV1 Data
 		AV1Context* av1Context;
@@ -71,10 +86,12 @@ namespace MathAnim
 		std::thread ivfFileWriteThread;
 		std::thread thread;
 		std::thread finalizeThread;
-		std::queue<VideoFrame> queuedFrames;
+		std::condition_variable frameQueuedCv;
+		std::condition_variable frameFreedCv;
+		std::condition_variable frameSentCv;
 		std::atomic_bool isEncoding;
+		std::atomic_bool sentAllFrames;
 		std::atomic<float> percentComplete;
-		std::atomic<size_t> approxRamUsed;
 	};
 }
 
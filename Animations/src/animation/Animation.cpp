@@ -4,6 +4,7 @@
 #include "core/Input.h"
 #include "core/Profiling.h"
 #include "core/Serialization.hpp"
+#include "core/BinaryScene.h"
 #include "animation/AnimationManager.h"
 #include "svg/Svg.h"
 #include "svg/SvgCache.h"
@@ -21,6 +22,7 @@
 #include "editor/UndoSystem.h"
 
 #include <nlohmann/json.hpp>
+#include <stb/stb_image.h>
 
 namespace MathAnim
 {
@@ -30,6 +32,11 @@ namespace MathAnim
 
 	// ----------------------------- Internal Functions -----------------------------
 	static void onMoveToGizmo(AnimationManagerData* am, Animation* anim);
+	static void serializeAnimationTypeData(const Animation* animation, nlohmann::json& memory);
+	static void deserializeAnimationTypeData(Animation* res, const nlohmann::json& j, uint32 version);
+	static void serializeAnimObjectTypeData(const AnimObject* obj, nlohmann::json& memory);
+	static void deserializeAnimObjectTypeData(AnimObject* res, const nlohmann::json& j, uint32 version);
+	static void initDeserializedAnimObject(AnimObject* res);
 
 	// ----------------------------- Animation Functions -----------------------------
 	void Animation::applyAnimation(AnimationManagerData* am, float t) const
@@ -430,41 +437,7 @@ namespace MathAnim
 
 		SERIALIZE_ID_ARRAY(memory, this, animObjectIds);
 
-		switch (this->type)
-		{
-		case AnimTypeV1::Create:
-		case AnimTypeV1::UnCreate:
-		case AnimTypeV1::FadeIn:
-		case AnimTypeV1::FadeOut:
-			// NOP
-			break;
-		case AnimTypeV1::Shift:
-		case AnimTypeV1::RotateTo:
-			SERIALIZE_VEC(memory, this, as.modifyVec3.target);
-			break;
-		case AnimTypeV1::AnimateFillColor:
-		case AnimTypeV1::AnimateStrokeColor:
-			SERIALIZE_VEC(memory, this, as.modifyU8Vec4.target);
-			break;
-		case AnimTypeV1::AnimateStrokeWidth:
-			g_logger_warning("TODO: implement me");
-			break;
-		case AnimTypeV1::Transform:
-			SERIALIZE_OBJECT(memory, this, as.replacementTransform);
-			break;
-		case AnimTypeV1::MoveTo:
-			SERIALIZE_OBJECT(memory, this, as.moveTo);
-			break;
-		case AnimTypeV1::AnimateScale:
-			SERIALIZE_OBJECT(memory, this, as.animateScale);
-			break;
-		case AnimTypeV1::Circumscribe:
-			SERIALIZE_OBJECT(memory, this, as.circumscribe);
-			break;
-		case AnimTypeV1::Length:
-		case AnimTypeV1::None:
-			break;
-		}
+		serializeAnimationTypeData(this, memory);
 	}
 
 	void ReplacementTransformData::serialize(nlohmann::json& memory) const
@@ -791,42 +764,75 @@ namespace MathAnim
 
 		DESERIALIZE_ID_SET(&res, animObjectIds, j);
 
-		switch (res.type)
+		deserializeAnimationTypeData(&res, j, version);
+
+		return res;
+	}
+
+	void Animation::serializeBinary(BinarySceneWriter& writer) const
+	{
+		BinaryAnimationRecord record = {};
+		record.id = id;
+		record.animObjectIds = writer.addIds(animObjectIds.begin(), animObjectIds.end());
+		record.frameStart = frameStart;
+		record.duration = duration;
+		record.timelineTrack = timelineTrack;
+		record.type = (uint32)type;
+		record.lagRatio = lagRatio;
+		record.easeType = (uint8)easeType;
+		record.easeDirection = (uint8)easeDirection;
+		record.playbackType = (uint8)playbackType;
+
+		nlohmann::json typeData = nlohmann::json();
+		serializeAnimationTypeData(this, typeData);
+		record.typeData = writer.addCbor(typeData);
+
+		writer.addRecord(BinarySceneSection::Animations, record);
+	}
+
+	Animation Animation::deserializeBinary(const BinarySceneReader& reader, const BinaryAnimationRecord& record, uint32 version)
+	{
+		Animation res = {};
+		if (record.type >= (uint32)AnimTypeV1::Length ||
+			record.easeType >= (uint8)EaseType::Length ||
+			record.easeDirection >= (uint8)EaseDirection::Length ||
+			record.playbackType >= (uint8)PlaybackType::Length)
 		{
-		case AnimTypeV1::Create:
-		case AnimTypeV1::UnCreate:
-		case AnimTypeV1::FadeIn:
-		case AnimTypeV1::FadeOut:
-			// NOP
-			break;
-		case AnimTypeV1::RotateTo:
-		case AnimTypeV1::Shift:
-			DESERIALIZE_VEC3(&res, as.modifyVec3.target, j, (Vec3{ 0, 0, 0 }));
-			break;
-		case AnimTypeV1::AnimateFillColor:
-		case AnimTypeV1::AnimateStrokeColor:
-			DESERIALIZE_U8VEC4(&res, as.modifyU8Vec4.target, j, glm::u8vec4(227, 3, 252, 255));
-			break;
-		case AnimTypeV1::AnimateStrokeWidth:
-			g_logger_warning("TODO: implement me");
-			break;
-		case AnimTypeV1::Transform:
-			DESERIALIZE_OBJECT(&res, as.replacementTransform, ReplacementTransformData, version, j);
-			break;
-		case AnimTypeV1::MoveTo:
-			DESERIALIZE_OBJECT(&res, as.moveTo, MoveToData, version, j);
-			break;
-		case AnimTypeV1::AnimateScale:
-			DESERIALIZE_OBJECT(&res, as.animateScale, AnimateScaleData, version, j);
-			break;
-		case AnimTypeV1::Circumscribe:
-			DESERIALIZE_OBJECT(&res, as.circumscribe, Circumscribe, version, j);
-			break;
-		case AnimTypeV1::Length:
-		case AnimTypeV1::None:
-			break;
+			g_logger_error("Binary animation record '{}' is corrupted.", record.id);
+			res.id = NULL_ANIM;
+			return res;
+		}
+
+		nlohmann::json typeData = reader.decodeCbor(record.typeData);
+		if (typeData.is_discarded())
+		{
+			g_logger_error("Binary animation record '{}' has corrupted type data.", record.id);
+			res.id = NULL_ANIM;
+			return res;
+		}
+
+		res.type = (AnimTypeV1)record.type;
+		res.frameStart = record.frameStart;
+		res.duration = record.duration;
+		res.timelineTrack = record.timelineTrack;
+		res.lagRatio = record.lagRatio;
+		res.easeType = (EaseType)record.easeType;
+		res.easeDirection = (EaseDirection)record.easeDirection;
+		res.playbackType = (PlaybackType)record.playbackType;
+
+		res.id = record.id;
+		if (!isNull(res.id))
+		{
+			animationUidCounter = glm::max(animationUidCounter, res.id + 1);
 		}
 
+		if (const uint64* ids = reader.getIds(record.animObjectIds); ids != nullptr)
+		{
+			res.animObjectIds.insert(ids, ids + record.animObjectIds.count);
+		}
+
+		deserializeAnimationTypeData(&res, typeData, version);
+
 		return res;
 	}
 
@@ -1191,40 +1197,62 @@ namespace MathAnim
 
 	void ImageObject::update(AnimationManagerData* am, AnimObjId parentId)
 	{
-		if (isLoadingImage && TextureCache::isTextureLoaded(textureHandle))
+		if (!isLoadingImage)
+		{
+			return;
+		}
+
+		Vec2i imageSize;
+		if (Application::isUsingSoftwareRenderer())
+		{
+			// There's no texture to wait on, the software renderer decodes the image itself
+			int numChannels;
+			if (!stbi_info(imageFilepath, &imageSize.x, &imageSize.y, &numChannels))
+			{
+				g_logger_warning("Failed to read the size of image '{}'. Reason: {}", imageFilepath, stbi_failure_reason());
+				isLoadingImage = false;
+				return;
+			}
+		}
+		else if (TextureCache::isTextureLoaded(textureHandle))
 		{
 			const Texture& texture = TextureCache::getTexture(this->textureHandle);
+			imageSize = Vec2i{ texture.width, texture.height };
+		}
+		else
+		{
+			return;
+		}
 
-			size.x = size.x == 0.0f ? (float)texture.width / Application::getOutputSize().x * Application::getViewportSize().x : size.x;
-			size.y = size.y == 0.0f ? (float)texture.height / Application::getOutputSize().y * Application::getViewportSize().y : size.y;
+		size.x = size.x == 0.0f ? (float)imageSize.x / Application::getOutputSize().x * Application::getViewportSize().x : size.x;
+		size.y = size.y == 0.0f ? (float)imageSize.y / Application::getOutputSize().y * Application::getViewportSize().y : size.y;
 
-			// Generate child for the actual image
-			AnimObject imageChildObj = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::_ImageObject, parentId, true);
-			imageChildObj._positionStart = Vec3{ 0.0f, 0.0f, 0.0f };
-			imageChildObj.setName("Image");
+		// Generate child for the actual image
+		AnimObject imageChildObj = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::_ImageObject, parentId, true);
+		imageChildObj._positionStart = Vec3{ 0.0f, 0.0f, 0.0f };
+		imageChildObj.setName("Image");
 
-			// Generate child for the square/border that will be drawn in around the image
-			AnimObject squareChildObj = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::Square, parentId, true);
-			squareChildObj.as.square.sideLength = 1.0f;
-			squareChildObj._positionStart = Vec3{ 0.0f, 0.0f, 0.0f };
-			squareChildObj._scaleStart.x = (float)size.x;
-			squareChildObj._scaleStart.y = (float)size.y;
-			squareChildObj._fillColorStart.a = 0;
-			squareChildObj.fillColor.a = 0;
-			squareChildObj.setName("Square Border");
-			squareChildObj.as.square.reInit(&squareChildObj);
+		// Generate child for the square/border that will be drawn in around the image
+		AnimObject squareChildObj = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::Square, parentId, true);
+		squareChildObj.as.square.sideLength = 1.0f;
+		squareChildObj._positionStart = Vec3{ 0.0f, 0.0f, 0.0f };
+		squareChildObj._scaleStart.x = (float)size.x;
+		squareChildObj._scaleStart.y = (float)size.y;
+		squareChildObj._fillColorStart.a = 0;
+		squareChildObj.fillColor.a = 0;
+		squareChildObj.setName("Square Border");
+		squareChildObj.as.square.reInit(&squareChildObj);
 
-			AnimationManager::addAnimObject(am, squareChildObj);
-			// TODO: Ugly what do I do???
-			SceneHierarchyPanel::addNewAnimObject(squareChildObj);
+		AnimationManager::addAnimObject(am, squareChildObj);
+		// TODO: Ugly what do I do???
+		SceneHierarchyPanel::addNewAnimObject(squareChildObj);
 
-			AnimationManager::addAnimObject(am, imageChildObj);
-			// TODO: Ugly what do I do???
-			SceneHierarchyPanel::addNewAnimObject(imageChildObj);
+		AnimationManager::addAnimObject(am, imageChildObj);
+		// TODO: Ugly what do I do???
+		SceneHierarchyPanel::addNewAnimObject(imageChildObj);
 
-			AnimationManager::updateObjectState(am, parentId);
-			isLoadingImage = false;
-		}
+		AnimationManager::updateObjectState(am, parentId);
+		isLoadingImage = false;
 	}
 
 	void ImageObject::init()
@@ -1234,7 +1262,11 @@ namespace MathAnim
 			return;
 		}
 
-		this->textureHandle = TextureCache::lazyLoadTexture(imageFilepath, getLoadOptions());
+		// The software renderer loads images on its own, and there's no OpenGL context to upload them to
+		if (!Application::isUsingSoftwareRenderer())
+		{
+			this->textureHandle = TextureCache::lazyLoadTexture(imageFilepath, getLoadOptions());
+		}
 		this->isLoadingImage = true;
 	}
 
@@ -1323,7 +1355,7 @@ namespace MathAnim
 				res.imageFilepathLength = 0;
 			}
 
-			if (res.imageFilepath > 0)
+			if (res.imageFilepath > 0 && !Application::isUsingSoftwareRenderer())
 			{
 				res.textureHandle = TextureCache::lazyLoadTexture(res.imageFilepath, res.getLoadOptions());
 			}
@@ -1724,11 +1756,14 @@ namespace MathAnim
 			// Interpolate between this svg and other svg
 			if (this->svgObject && replacement->svgObject)
 			{
-				this->percentReplacementTransformed = t;
-				SvgObject* interpolated = Svg::interpolate(this->svgObject, replacement->svgObject, t);
-				this->svgObject->free();
-				g_memory_free(this->svgObject);
-				this->svgObject = interpolated;
+				// The curve correspondence is cached, so each frame just blends the control
+				// points into the memory this svg already has
+				const SvgMorph* morph = AnimationManager::getSvgMorph(am, this->id, replacement->id);
+				if (morph)
+				{
+					this->percentReplacementTransformed = t;
+					Svg::interpolateInto(*morph, t, this->getMutableSvgObject(false));
+				}
 			}
 
 			// Interpolate other properties
@@ -1763,12 +1798,78 @@ namespace MathAnim
 		}
 	}
 
-	void AnimObject::resetAllState()
+	void AnimObject::setSvgObjectStart(SvgObject* start)
+	{
+		freeSvgObjects();
+		_svgObjectStart = start;
+		svgObject = start;
+	}
+
+	SvgObject* AnimObject::getMutableSvgObject(bool keepContents)
+	{
+		if (svgObject == nullptr || svgObject == _svgObjectPrivate)
+		{
+			return svgObject;
+		}
+
+		if (_svgObjectPrivate == nullptr)
+		{
+			_svgObjectPrivate = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+			*_svgObjectPrivate = Svg::createDefault();
+		}
+
+		if (keepContents)
+		{
+			Svg::copy(_svgObjectPrivate, svgObject);
+		}
+		svgObject = _svgObjectPrivate;
+		return svgObject;
+	}
+
+	SvgObject* AnimObject::getMutableSvgObjectStart()
+	{
+		if (_svgObjectStart == nullptr || !Svg::isShared(_svgObjectStart))
+		{
+			return _svgObjectStart;
+		}
+
+		SvgObject* copy = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+		*copy = Svg::createDefault();
+		Svg::copy(copy, _svgObjectStart);
+		if (svgObject == _svgObjectStart)
+		{
+			svgObject = copy;
+		}
+		Svg::release(_svgObjectStart);
+		_svgObjectStart = copy;
+
+		return _svgObjectStart;
+	}
+
+	void AnimObject::resetSvgObject()
+	{
+		// Unmodified geometry is never copied, the private copy is kept around
+		// so animations that modify it again don't have to reallocate it
+		svgObject = _svgObjectStart;
+	}
+
+	void AnimObject::freeSvgObjects()
 	{
-		if (_svgObjectStart != nullptr && svgObject != nullptr)
+		if (_svgObjectPrivate)
 		{
-			Svg::copy(svgObject, _svgObjectStart);
+			_svgObjectPrivate->free();
+			g_memory_free(_svgObjectPrivate);
+			_svgObjectPrivate = nullptr;
 		}
+
+		Svg::release(_svgObjectStart);
+		_svgObjectStart = nullptr;
+		svgObject = nullptr;
+	}
+
+	void AnimObject::resetAllState()
+	{
+		resetSvgObject();
 		position = _positionStart;
 		globalPosition = _positionStart;
 		rotation = _rotationStart;
@@ -1885,19 +1986,7 @@ namespace MathAnim
 
 	void AnimObject::free()
 	{
-		if (this->svgObject)
-		{
-			this->svgObject->free();
-			g_memory_free(this->svgObject);
-			this->svgObject = nullptr;
-		}
-
-		if (this->_svgObjectStart)
-		{
-			this->_svgObjectStart->free();
-			g_memory_free(this->_svgObjectStart);
-			this->_svgObjectStart = nullptr;
-		}
+		this->freeSvgObjects();
 
 		if (this->name)
 		{
@@ -1971,52 +2060,7 @@ namespace MathAnim
 
 		SERIALIZE_NULLABLE_U8_CSTRING(memory, this, name, "Undefined");
 
-		switch (objectType)
-		{
-		case AnimObjectTypeV1::TextObject:
-			SERIALIZE_OBJECT(memory, this, as.textObject);
-			break;
-		case AnimObjectTypeV1::LaTexObject:
-			SERIALIZE_OBJECT(memory, this, as.laTexObject);
-			break;
-		case AnimObjectTypeV1::SvgObject:
-			g_logger_assert(this->_svgObjectStart != nullptr, "Somehow SVGObject has no object allocated.");
-			SERIALIZE_OBJECT_PTR(memory, this, _svgObjectStart);
-			break;
-		case AnimObjectTypeV1::Square:
-			SERIALIZE_OBJECT(memory, this, as.square);
-			break;
-		case AnimObjectTypeV1::Circle:
-			SERIALIZE_OBJECT(memory, this, as.circle);
-			break;
-		case AnimObjectTypeV1::Cube:
-			SERIALIZE_OBJECT(memory, this, as.cube);
-			break;
-		case AnimObjectTypeV1::Axis:
-			SERIALIZE_OBJECT(memory, this, as.axis);
-			break;
-		case AnimObjectTypeV1::SvgFileObject:
-			SERIALIZE_OBJECT(memory, this, as.svgFile);
-			break;
-		case AnimObjectTypeV1::Camera:
-			SERIALIZE_OBJECT(memory, this, as.camera);
-			break;
-		case AnimObjectTypeV1::ScriptObject:
-			SERIALIZE_OBJECT(memory, this, as.script);
-			break;
-		case AnimObjectTypeV1::Image:
-			SERIALIZE_OBJECT(memory, this, as.image);
-			break;
-		case AnimObjectTypeV1::CodeBlock:
-			SERIALIZE_OBJECT(memory, this, as.codeBlock);
-			break;
-		case AnimObjectTypeV1::Arrow:
-			SERIALIZE_OBJECT(memory, this, as.arrow);
-			break;
-		case AnimObjectTypeV1::Length:
-		case AnimObjectTypeV1::None:
-			break;
-		}
+		serializeAnimObjectTypeData(this, memory);
 	}
 
 	AnimObject AnimObject::deserialize(const nlohmann::json& j, uint32 version)
@@ -2062,80 +2106,129 @@ namespace MathAnim
 
 		DESERIALIZE_NULLABLE_U8_CSTRING(&res, name, j);
 
-		// Initialize other variables
-		res.position = res._positionStart;
-		res.rotation = res._rotationStart;
-		res.globalPosition = res.position;
-		res._globalPositionStart = res._positionStart;
-		res.scale = res._scaleStart;
-		res.strokeColor = res._strokeColorStart;
-		res.fillColor = res._fillColorStart;
-		res.strokeWidth = res._strokeWidthStart;
-		res.svgObject = nullptr;
-		res._svgObjectStart = nullptr;
+		initDeserializedAnimObject(&res);
+		deserializeAnimObjectTypeData(&res, j, version);
 
-		switch (res.objectType)
+		return res;
+	}
+
+	void AnimObject::serializeBinary(BinarySceneWriter& writer) const
+	{
+		BinaryAnimObjectRecord record = {};
+		record.id = id;
+		record.parentId = parentId;
+		record.generatedChildrenIds = writer.addIds(generatedChildrenIds.begin(), generatedChildrenIds.end());
+		record.referencedAnimations = writer.addIds(referencedAnimations.begin(), referencedAnimations.end());
+		record.position = _positionStart;
+		record.rotation = _rotationStart;
+		record.scale = _scaleStart;
+		record.fillColor = _fillColorStart;
+		record.strokeColor = _strokeColorStart;
+		record.strokeWidth = _strokeWidthStart;
+		record.svgScale = svgScale;
+		record.objectType = (uint32)objectType;
+		record.name = name != nullptr
+			? writer.addString((const char*)name, nameLength)
+			: writer.addString("Undefined", std::strlen("Undefined"));
+		record.flags = BinaryAnimObjectFlags_None;
+		if (drawDebugBoxes)
 		{
-		case AnimObjectTypeV1::TextObject:
-			DESERIALIZE_OBJECT(&res, as.textObject, TextObject, version, j);
-			break;
-		case AnimObjectTypeV1::LaTexObject:
-			DESERIALIZE_OBJECT(&res, as.laTexObject, LaTexObject, version, j);
-			break;
-		case AnimObjectTypeV1::Square:
-			DESERIALIZE_OBJECT(&res, as.square, Square, version, j);
-			res.as.square.init(&res);
-			break;
-		case AnimObjectTypeV1::SvgObject:
-			DESERIALIZE_OBJECT(&res, _svgObjectStart, SvgObject, version, j);
-			res.svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-			*res.svgObject = Svg::createDefault();
-			Svg::copy(res.svgObject, res._svgObjectStart);
-			break;
-		case AnimObjectTypeV1::Circle:
-			DESERIALIZE_OBJECT(&res, as.circle, Circle, version, j);
-			res.as.circle.init(&res);
-			break;
-		case AnimObjectTypeV1::Cube:
-			DESERIALIZE_OBJECT(&res, as.cube, Cube, version, j);
-			break;
-		case AnimObjectTypeV1::Axis:
-			DESERIALIZE_OBJECT(&res, as.axis, Axis, version, j);
-			res.as.axis.init(&res);
-			break;
-		case AnimObjectTypeV1::SvgFileObject:
-			DESERIALIZE_OBJECT(&res, as.svgFile, SvgFileObject, version, j);
-			break;
-		case AnimObjectTypeV1::Camera:
-			if (version == 2)
-			{
-				if (j.contains("as.camera") && !j["as.camera"].is_null())
-				{
-					res.as.camera = Camera::upgrade(CameraObject::deserialize(j["as.camera"], version));
-				}
-			}
-			else
-			{
-				DESERIALIZE_OBJECT(&res, as.camera, Camera, version, j);
-			}
-			break;
-		case AnimObjectTypeV1::ScriptObject:
-			DESERIALIZE_OBJECT(&res, as.script, ScriptObject, version, j);
-			break;
-		case AnimObjectTypeV1::Image:
-			DESERIALIZE_OBJECT(&res, as.image, ImageObject, version, j);
-			break;
-		case AnimObjectTypeV1::CodeBlock:
-			DESERIALIZE_OBJECT(&res, as.codeBlock, CodeBlock, version, j);
-			break;
-		case AnimObjectTypeV1::Arrow:
-			DESERIALIZE_OBJECT(&res, as.arrow, Arrow, version, j);
-			res.as.arrow.init(&res);
-			break;
-		case AnimObjectTypeV1::_ImageObject:
-		case AnimObjectTypeV1::Length:
-		case AnimObjectTypeV1::None:
-			break;
+			record.flags |= BinaryAnimObjectFlags_DrawDebugBoxes;
+		}
+		if (drawCurveDebugBoxes)
+		{
+			record.flags |= BinaryAnimObjectFlags_DrawCurveDebugBoxes;
+		}
+
+		nlohmann::json typeData = nlohmann::json();
+		if (objectType == AnimObjectTypeV1::SvgObject)
+		{
+			// Store the path as raw binary instead of the base64 string JSON needs
+			g_logger_assert(this->_svgObjectStart != nullptr, "Somehow SVGObject has no object allocated.");
+			_svgObjectStart->serializeStyle(typeData);
+			RawMemory binPath = _svgObjectStart->getPathAsBinary();
+			record.svgPath = writer.addBlob(binPath.data, binPath.size);
+			binPath.free();
+		}
+		else
+		{
+			serializeAnimObjectTypeData(this, typeData);
+		}
+		record.typeData = writer.addCbor(typeData);
+
+		writer.addRecord(BinarySceneSection::AnimObjects, record);
+	}
+
+	AnimObject AnimObject::deserializeBinary(const BinarySceneReader& reader, const BinaryAnimObjectRecord& record, uint32 version)
+	{
+		AnimObject res = {};
+		if (record.objectType >= (uint32)AnimObjectTypeV1::Length)
+		{
+			g_logger_error("Binary anim object record '{}' is corrupted.", record.id);
+			res.id = NULL_ANIM_OBJECT;
+			return res;
+		}
+
+		nlohmann::json typeData = reader.decodeCbor(record.typeData);
+		if (typeData.is_discarded())
+		{
+			g_logger_error("Binary anim object record '{}' has corrupted type data.", record.id);
+			res.id = NULL_ANIM_OBJECT;
+			return res;
+		}
+
+		res.isGenerated = false;
+		res.drawCurves = false;
+		res.drawControlPoints = false;
+		res.percentCreated = 0.0f;
+
+		res.objectType = (AnimObjectTypeV1)record.objectType;
+		res._positionStart = record.position;
+		res._rotationStart = record.rotation;
+		res._scaleStart = record.scale;
+		res._fillColorStart = record.fillColor;
+		res._strokeColorStart = record.strokeColor;
+		res._strokeWidthStart = record.strokeWidth;
+		res.svgScale = record.svgScale;
+		res.drawDebugBoxes = (record.flags & BinaryAnimObjectFlags_DrawDebugBoxes) != 0;
+		res.drawCurveDebugBoxes = (record.flags & BinaryAnimObjectFlags_DrawCurveDebugBoxes) != 0;
+
+		res.parentId = record.parentId;
+		res.id = record.id;
+		if (!isNull(res.id))
+		{
+			animObjectUidCounter = glm::max(animObjectUidCounter, res.id + 1);
+		}
+
+		if (const uint64* ids = reader.getIds(record.generatedChildrenIds); ids != nullptr)
+		{
+			res.generatedChildrenIds.assign(ids, ids + record.generatedChildrenIds.count);
+		}
+		if (const uint64* ids = reader.getIds(record.referencedAnimations); ids != nullptr)
+		{
+			res.referencedAnimations.insert(ids, ids + record.referencedAnimations.count);
+		}
+
+		size_t nameStrLength = 0;
+		const char* nameStr = reader.getString(record.name, &nameStrLength);
+		if (nameStr == nullptr)
+		{
+			nameStr = "Undefined";
+			nameStrLength = std::strlen(nameStr);
+		}
+		res.nameLength = (uint32)nameStrLength;
+		res.name = (uint8*)g_memory_allocate(sizeof(uint8) * (nameStrLength + 1));
+		g_memory_copyMem(res.name, sizeof(uint8) * (nameStrLength + 1), (void*)nameStr, sizeof(uint8) * (nameStrLength + 1));
+
+		initDeserializedAnimObject(&res);
+
+		if (res.objectType == AnimObjectTypeV1::SvgObject)
+		{
+			res.setSvgObjectStart(SvgObject::deserializeWithBinPath(typeData, reader.getBlob(record.svgPath), record.svgPath.size));
+		}
+		else
+		{
+			deserializeAnimObjectTypeData(&res, typeData, version);
 		}
 
 		return res;
@@ -2250,6 +2343,7 @@ namespace MathAnim
 			res.strokeWidth = res._strokeWidthStart;
 			res.svgObject = nullptr;
 			res._svgObjectStart = nullptr;
+			res._svgObjectPrivate = nullptr;
 
 			switch (res.objectType)
 			{
@@ -2264,10 +2358,7 @@ namespace MathAnim
 				res.as.square.init(&res);
 				break;
 			case AnimObjectTypeV1::SvgObject:
-				res._svgObjectStart = SvgObject::legacy_deserialize(memory, version);
-				res.svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-				*res.svgObject = Svg::createDefault();
-				Svg::copy(res.svgObject, res._svgObjectStart);
+				res.setSvgObjectStart(SvgObject::legacy_deserialize(memory, version));
 				break;
 			case AnimObjectTypeV1::Circle:
 				res.as.circle = Circle::legacy_deserialize(memory, version);
@@ -2358,6 +2449,7 @@ namespace MathAnim
 
 		res.svgObject = nullptr;
 		res._svgObjectStart = nullptr;
+		res._svgObjectPrivate = nullptr;
 
 		res.drawDebugBoxes = false;
 		res.drawCurveDebugBoxes = false;
@@ -2553,6 +2645,215 @@ namespace MathAnim
 	}
 
 	// ----------------------------- Internal Functions -----------------------------
+	static void serializeAnimationTypeData(const Animation* animation, nlohmann::json& memory)
+	{
+		switch (animation->type)
+		{
+		case AnimTypeV1::Create:
+		case AnimTypeV1::UnCreate:
+		case AnimTypeV1::FadeIn:
+		case AnimTypeV1::FadeOut:
+			// NOP
+			break;
+		case AnimTypeV1::Shift:
+		case AnimTypeV1::RotateTo:
+			SERIALIZE_VEC(memory, animation, as.modifyVec3.target);
+			break;
+		case AnimTypeV1::AnimateFillColor:
+		case AnimTypeV1::AnimateStrokeColor:
+			SERIALIZE_VEC(memory, animation, as.modifyU8Vec4.target);
+			break;
+		case AnimTypeV1::AnimateStrokeWidth:
+			g_logger_warning("TODO: implement me");
+			break;
+		case AnimTypeV1::Transform:
+			SERIALIZE_OBJECT(memory, animation, as.replacementTransform);
+			break;
+		case AnimTypeV1::MoveTo:
+			SERIALIZE_OBJECT(memory, animation, as.moveTo);
+			break;
+		case AnimTypeV1::AnimateScale:
+			SERIALIZE_OBJECT(memory, animation, as.animateScale);
+			break;
+		case AnimTypeV1::Circumscribe:
+			SERIALIZE_OBJECT(memory, animation, as.circumscribe);
+			break;
+		case AnimTypeV1::Length:
+		case AnimTypeV1::None:
+			break;
+		}
+	}
+
+	static void deserializeAnimationTypeData(Animation* res, const nlohmann::json& j, uint32 version)
+	{
+		switch (res->type)
+		{
+		case AnimTypeV1::Create:
+		case AnimTypeV1::UnCreate:
+		case AnimTypeV1::FadeIn:
+		case AnimTypeV1::FadeOut:
+			// NOP
+			break;
+		case AnimTypeV1::RotateTo:
+		case AnimTypeV1::Shift:
+			DESERIALIZE_VEC3(res, as.modifyVec3.target, j, (Vec3{ 0, 0, 0 }));
+			break;
+		case AnimTypeV1::AnimateFillColor:
+		case AnimTypeV1::AnimateStrokeColor:
+			DESERIALIZE_U8VEC4(res, as.modifyU8Vec4.target, j, glm::u8vec4(227, 3, 252, 255));
+			break;
+		case AnimTypeV1::AnimateStrokeWidth:
+			g_logger_warning("TODO: implement me");
+			break;
+		case AnimTypeV1::Transform:
+			DESERIALIZE_OBJECT(res, as.replacementTransform, ReplacementTransformData, version, j);
+			break;
+		case AnimTypeV1::MoveTo:
+			DESERIALIZE_OBJECT(res, as.moveTo, MoveToData, version, j);
+			break;
+		case AnimTypeV1::AnimateScale:
+			DESERIALIZE_OBJECT(res, as.animateScale, AnimateScaleData, version, j);
+			break;
+		case AnimTypeV1::Circumscribe:
+			DESERIALIZE_OBJECT(res, as.circumscribe, Circumscribe, version, j);
+			break;
+		case AnimTypeV1::Length:
+		case AnimTypeV1::None:
+			break;
+		}
+	}
+
+	static void serializeAnimObjectTypeData(const AnimObject* obj, nlohmann::json& memory)
+	{
+		switch (obj->objectType)
+		{
+		case AnimObjectTypeV1::TextObject:
+			SERIALIZE_OBJECT(memory, obj, as.textObject);
+			break;
+		case AnimObjectTypeV1::LaTexObject:
+			SERIALIZE_OBJECT(memory, obj, as.laTexObject);
+			break;
+		case AnimObjectTypeV1::SvgObject:
+			g_logger_assert(obj->_svgObjectStart != nullptr, "Somehow SVGObject has no object allocated.");
+			SERIALIZE_OBJECT_PTR(memory, obj, _svgObjectStart);
+			break;
+		case AnimObjectTypeV1::Square:
+			SERIALIZE_OBJECT(memory, obj, as.square);
+			break;
+		case AnimObjectTypeV1::Circle:
+			SERIALIZE_OBJECT(memory, obj, as.circle);
+			break;
+		case AnimObjectTypeV1::Cube:
+			SERIALIZE_OBJECT(memory, obj, as.cube);
+			break;
+		case AnimObjectTypeV1::Axis:
+			SERIALIZE_OBJECT(memory, obj, as.axis);
+			break;
+		case AnimObjectTypeV1::SvgFileObject:
+			SERIALIZE_OBJECT(memory, obj, as.svgFile);
+			break;
+		case AnimObjectTypeV1::Camera:
+			SERIALIZE_OBJECT(memory, obj, as.camera);
+			break;
+		case AnimObjectTypeV1::ScriptObject:
+			SERIALIZE_OBJECT(memory, obj, as.script);
+			break;
+		case AnimObjectTypeV1::Image:
+			SERIALIZE_OBJECT(memory, obj, as.image);
+			break;
+		case AnimObjectTypeV1::CodeBlock:
+			SERIALIZE_OBJECT(memory, obj, as.codeBlock);
+			break;
+		case AnimObjectTypeV1::Arrow:
+			SERIALIZE_OBJECT(memory, obj, as.arrow);
+			break;
+		case AnimObjectTypeV1::Length:
+		case AnimObjectTypeV1::None:
+			break;
+		}
+	}
+
+	static void deserializeAnimObjectTypeData(AnimObject* res, const nlohmann::json& j, uint32 version)
+	{
+		switch (res->objectType)
+		{
+		case AnimObjectTypeV1::TextObject:
+			DESERIALIZE_OBJECT(res, as.textObject, TextObject, version, j);
+			break;
+		case AnimObjectTypeV1::LaTexObject:
+			DESERIALIZE_OBJECT(res, as.laTexObject, LaTexObject, version, j);
+			break;
+		case AnimObjectTypeV1::Square:
+			DESERIALIZE_OBJECT(res, as.square, Square, version, j);
+			res->as.square.init(res);
+			break;
+		case AnimObjectTypeV1::SvgObject:
+			DESERIALIZE_OBJECT(res, _svgObjectStart, SvgObject, version, j);
+			res->svgObject = res->_svgObjectStart;
+			break;
+		case AnimObjectTypeV1::Circle:
+			DESERIALIZE_OBJECT(res, as.circle, Circle, version, j);
+			res->as.circle.init(res);
+			break;
+		case AnimObjectTypeV1::Cube:
+			DESERIALIZE_OBJECT(res, as.cube, Cube, version, j);
+			break;
+		case AnimObjectTypeV1::Axis:
+			DESERIALIZE_OBJECT(res, as.axis, Axis, version, j);
+			res->as.axis.init(res);
+			break;
+		case AnimObjectTypeV1::SvgFileObject:
+			DESERIALIZE_OBJECT(res, as.svgFile, SvgFileObject, version, j);
+			break;
+		case AnimObjectTypeV1::Camera:
+			if (version == 2)
+			{
+				if (j.contains("as.camera") && !j["as.camera"].is_null())
+				{
+					res->as.camera = Camera::upgrade(CameraObject::deserialize(j["as.camera"], version));
+				}
+			}
+			else
+			{
+				DESERIALIZE_OBJECT(res, as.camera, Camera, version, j);
+			}
+			break;
+		case AnimObjectTypeV1::ScriptObject:
+			DESERIALIZE_OBJECT(res, as.script, ScriptObject, version, j);
+			break;
+		case AnimObjectTypeV1::Image:
+			DESERIALIZE_OBJECT(res, as.image, ImageObject, version, j);
+			break;
+		case AnimObjectTypeV1::CodeBlock:
+			DESERIALIZE_OBJECT(res, as.codeBlock, CodeBlock, version, j);
+			break;
+		case AnimObjectTypeV1::Arrow:
+			DESERIALIZE_OBJECT(res, as.arrow, Arrow, version, j);
+			res->as.arrow.init(res);
+			break;
+		case AnimObjectTypeV1::_ImageObject:
+		case AnimObjectTypeV1::Length:
+		case AnimObjectTypeV1::None:
+			break;
+		}
+	}
+
+	static void initDeserializedAnimObject(AnimObject* res)
+	{
+		// Initialize other variables
+		res->position = res->_positionStart;
+		res->rotation = res->_rotationStart;
+		res->globalPosition = res->position;
+		res->_globalPositionStart = res->_positionStart;
+		res->scale = res->_scaleStart;
+		res->strokeColor = res->_strokeColorStart;
+		res->fillColor = res->_fillColorStart;
+		res->strokeWidth = res->_strokeWidthStart;
+		res->svgObject = nullptr;
+		res->_svgObjectStart = nullptr;
+		res->_svgObjectPrivate = nullptr;
+	}
+
 	static void onMoveToGizmo(AnimationManagerData*, Animation* anim)
 	{
 		// TODO: Render and handle 2D gizmo logic based on edit mode
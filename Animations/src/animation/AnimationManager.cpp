@@ -12,16 +12,57 @@
 #include "core/Application.h"
 #include "core/Profiling.h"
 #include "core/Serialization.hpp"
+#include "core/BinaryScene.h"
 
 #include <nlohmann/json.hpp>
 
 namespace MathAnim
 {
+	// Number of frames between each timeline checkpoint
+	static constexpr int CHECKPOINT_FRAME_INTERVAL = 60;
+
+	// Compact copy of every AnimObject property that an animation is allowed to modify.
+	// Everything else is either constant during playback or recalculated after the
+	// animations are applied (global transforms, bounding boxes, etc).
+	struct AnimObjectStateSnapshot
+	{
+		Vec3 position;
+		Vec3 rotation;
+		Vec3 scale;
+		float percentCreated;
+		float strokeWidth;
+		glm::u8vec4 strokeColor;
+		glm::u8vec4 fillColor;
+		AnimId circumscribeId;
+		AnimObjectStatus status;
+	};
+
+	struct AnimationCheckpoint
+	{
+		int frame;
+		// This checkpoint holds the state of the scene after fully applying
+		// animations [0, animationPrefix) in sorted order. Every animation in that
+		// range has finished by `frame`, so replaying from here only needs to
+		// apply the animations starting at `animationPrefix`.
+		size_t animationPrefix;
+		// Indexed the same as AnimationManagerData::objects
+		std::vector<AnimObjectStateSnapshot> objectStates;
+	};
+
+	struct CachedSvgMorph
+	{
+		AnimObjId replacementId;
+		SvgMorph morph;
+	};
+
 	struct AnimationManagerData
 	{
 		std::vector<AnimObject> objects;
 		// Maps from AnimObjectId -> Index in objects vector
 		std::unordered_map<AnimObjId, size_t> objectIdMap;
+		// Maps from parent AnimObjectId -> Direct children in the order they were added.
+		// Root objects are stored under NULL_ANIM_OBJECT.
+		std::unordered_map<AnimObjId, std::vector<AnimObjId>> childrenIdMap;
 
 		// Always sorted by startFrame and trackIndex
 		std::vector<Animation> animations;
@@ -42,6 +83,19 @@ namespace MathAnim
 		AnimObjId activeCamera;
 		int currentFrame;
 		bool shouldRenderBoundingBoxes;
+
+		// Sorted by frame. Checkpoints are only captured when the animation prefix
+		// grows, so consecutive checkpoints never hold identical state.
+		std::vector<AnimationCheckpoint> checkpoints;
+		// The last checkpoint frame (a multiple of CHECKPOINT_FRAME_INTERVAL) that has been
+		// evaluated. -1 if there are no valid checkpoints.
+		int checkpointsBuiltUntil;
+		// Objects whose svgObject was morphed by an in-progress ReplacementTransform. These
+		// need their svgObject restored before the scene is evaluated again.
+		std::unordered_set<AnimObjId> morphedObjects;
+		// Curve correspondences for ReplacementTransforms, keyed by the object being morphed.
+		// These only depend on the two shapes, so every frame of a transform reuses them.
+		std::unordered_map<AnimObjId, CachedSvgMorph> svgMorphs;
 	};
 
 	namespace AnimationManager
@@ -55,7 +109,18 @@ namespace MathAnim
 		static void removeQueuedAnimation(AnimationManagerData* am, AnimId animation);
 		static bool removeSingleAnimObject(AnimationManagerData* am, AnimObjId animObj);
 		static void applyDelta(AnimationManagerData* am, int deltaFrame);
+		static void updateObject(AnimationManagerData* am, AnimObject& obj);
 		static void applyAnimationsFrom(AnimationManagerData* am, int startIndex, int frame, bool calculateKeyframes = false);
+		static void clearCheckpoints(AnimationManagerData* am);
+		static void buildCheckpointsUntil(AnimationManagerData* am, int frame);
+		static void captureCheckpoint(AnimationManagerData* am, int frame, size_t animationPrefix);
+		static void restoreCheckpoint(AnimationManagerData* am, const AnimationCheckpoint& checkpoint);
+		static const AnimationCheckpoint& findCheckpoint(const AnimationManagerData* am, int frame);
+		static void markMorphed(AnimationManagerData* am, AnimObjId animObj);
+		static void freeSvgMorphsReferencing(AnimationManagerData* am, AnimObjId animObj);
+		static const std::vector<AnimObjId>& getChildIds(const AnimationManagerData* am, AnimObjId parent);
+		static void addToChildIndex(AnimationManagerData* am, AnimObjId parent, AnimObjId child);
+		static void removeFromChildIndex(AnimationManagerData* am, AnimObjId parent, AnimObjId child);
 
 		AnimationManagerData* create()
 		{
@@ -63,6 +128,7 @@ namespace MathAnim
 
 			res->activeCamera = NULL_ANIM_OBJECT;
 			res->currentFrame = 0;
+			res->checkpointsBuiltUntil = -1;
 
 			return res;
 		}
@@ -83,6 +149,11 @@ namespace MathAnim
 					am->animations[i].free();
 				}
 
+				for (auto& [id, cachedMorph] : am->svgMorphs)
+				{
+					cachedMorph.morph.free();
+				}
+
 				g_memory_delete(am);
 			}
 		}
@@ -91,10 +162,43 @@ namespace MathAnim
 		{
 			MP_PROFILE_EVENT("AnimationManager_EndFrame");
 
+			// Objects that were added and removed in the same frame (like the children of an object that
+			// got regenerated twice) never make it into the scene. Neither do queued children of anything
+			// that's removed. Removes are processed first, so they'd get added anyways otherwise.
+			std::unordered_set<AnimObjId> droppedObjects = {};
+			if (am->queuedRemoveObjects.size() > 0)
+			{
+				std::unordered_set<AnimObjId> removedObjects(am->queuedRemoveObjects.begin(), am->queuedRemoveObjects.end());
+				for (const auto& obj : am->queuedAddObjects)
+				{
+					if (removedObjects.find(obj.id) != removedObjects.end() || removedObjects.find(obj.parentId) != removedObjects.end())
+					{
+						removedObjects.insert(obj.id);
+						droppedObjects.insert(obj.id);
+					}
+				}
+
+				for (auto iter = am->queuedAddObjects.begin(); iter != am->queuedAddObjects.end();)
+				{
+					if (droppedObjects.find(iter->id) != droppedObjects.end())
+					{
+						iter->free();
+						iter = am->queuedAddObjects.erase(iter);
+					}
+					else
+					{
+						iter++;
+					}
+				}
+			}
+
 			// Remove all queued delete objects
 			for (auto animObjId : am->queuedRemoveObjects)
 			{
-				removeQueuedAnimObject(am, animObjId);
+				if (droppedObjects.find(animObjId) == droppedObjects.end())
+				{
+					removeQueuedAnimObject(am, animObjId);
+				}
 			}
 			// Clear queue
 			am->queuedRemoveObjects.clear();
@@ -136,31 +240,67 @@ namespace MathAnim
 			MP_PROFILE_EVENT("AnimationManager_ResetToFrame");
 			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
 
-			// Reset all object states
-			for (auto objectIter = am->objects.begin(); objectIter != am->objects.end(); objectIter++)
-			{
-				// Reset to original state and apply animations in order
-				objectIter->resetAllState();
-			}
+			int frame = (int)absoluteFrame;
+
+			// Start from the closest checkpoint before this frame instead of
+			// replaying the whole timeline
+			buildCheckpointsUntil(am, frame);
+			const AnimationCheckpoint& checkpoint = findCheckpoint(am, frame);
+			int animationPrefix = (int)checkpoint.animationPrefix;
+			restoreCheckpoint(am, checkpoint);
 
 			// Update all children global transforms and stuff
 			applyGlobalTransforms(am);
 
-			// Then apply each animation up to the current frame
-			if (absoluteFrame > 0)
+			// Then apply each remaining animation up to the current frame
+			if (frame > 0)
 			{
-				applyAnimationsFrom(am, 0, absoluteFrame);
+				applyAnimationsFrom(am, animationPrefix, frame);
 			}
 			applyGlobalTransforms(am);
 			calculateBBoxes(am);
 
-			am->currentFrame = absoluteFrame;
+			am->currentFrame = frame;
+		}
+
+		void invalidateCheckpoints(AnimationManagerData* am, int fromFrame)
+		{
+			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
+
+			if (fromFrame < 0)
+			{
+				clearCheckpoints(am);
+				return;
+			}
+
+			// Any checkpoint at or before fromFrame only contains animations that finished
+			// before fromFrame, so they can't be affected by this change
+			while (am->checkpoints.size() > 1 && am->checkpoints.back().frame > fromFrame)
+			{
+				am->checkpoints.pop_back();
+			}
+
+			int lastValidFrame = (fromFrame / CHECKPOINT_FRAME_INTERVAL) * CHECKPOINT_FRAME_INTERVAL;
+			am->checkpointsBuiltUntil = glm::min(am->checkpointsBuiltUntil, lastValidFrame);
+		}
+
+		void invalidateAnimation(AnimationManagerData* am, AnimId anim)
+		{
+			const Animation* animation = getAnimation(am, anim);
+			if (animation)
+			{
+				invalidateCheckpoints(am, animation->frameStart);
+			}
 		}
 
 		void calculateAnimationKeyFrames(AnimationManagerData* am)
 		{
 			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
 
+			// Keyframes change the starting values of animations, so nothing we've
+			// captured so far is valid anymore
+			clearCheckpoints(am);
+
 			// Reset all object states
 			for (auto objectIter = am->objects.begin(); objectIter != am->objects.end(); objectIter++)
 			{
@@ -225,6 +365,7 @@ namespace MathAnim
 			{
 				anim->animObjectIds.insert(animObjId);
 				obj->referencedAnimations.insert(animationId);
+				invalidateCheckpoints(am, anim->frameStart);
 			}
 		}
 
@@ -236,6 +377,7 @@ namespace MathAnim
 			{
 				anim->animObjectIds.erase(animObjId);
 				obj->referencedAnimations.erase(animationId);
+				invalidateCheckpoints(am, anim->frameStart);
 			}
 		}
 
@@ -276,6 +418,7 @@ namespace MathAnim
 			if (animation)
 			{
 				animation->timelineTrack = track;
+				invalidateCheckpoints(am, animation->frameStart);
 			}
 		}
 
@@ -289,6 +432,8 @@ namespace MathAnim
 				applyDelta(am, deltaFrame);
 			}
 
+			LaTexObject::reInitFinishedObjects(am);
+
 			// NOTE: Render any active/animating objects
 			{
 				MP_PROFILE_EVENT("AnimationManager_UpdateActiveObjects");
@@ -300,18 +445,7 @@ namespace MathAnim
 						objectIter->render(am);
 					}
 
-					// Update any updateable objects
-					switch (objectIter->objectType)
-					{
-					case AnimObjectTypeV1::Image: objectIter->as.image.update(am, objectIter->id); break;
-					case AnimObjectTypeV1::LaTexObject: objectIter->as.laTexObject.update(am, objectIter->id); break;
-					case AnimObjectTypeV1::Camera:
-						objectIter->as.camera.position = objectIter->globalPosition;
-						objectIter->as.camera.orientation = CMath::quatFromEulerAngles(objectIter->rotation);
-						break;
-					default:
-						break;
-					}
+					updateObject(am, *objectIter);
 				}
 			}
 
@@ -324,6 +458,24 @@ namespace MathAnim
 			}
 		}
 
+		void update(AnimationManagerData* am, int deltaFrame)
+		{
+			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
+			MP_PROFILE_EVENT("AnimationManager_Update");
+
+			if (deltaFrame != 0)
+			{
+				applyDelta(am, deltaFrame);
+			}
+
+			LaTexObject::reInitFinishedObjects(am);
+
+			for (auto objectIter = am->objects.begin(); objectIter != am->objects.end(); objectIter++)
+			{
+				updateObject(am, *objectIter);
+			}
+		}
+
 		int lastAnimatedFrame(const AnimationManagerData* am)
 		{
 			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
@@ -467,6 +619,36 @@ namespace MathAnim
 			return nullptr;
 		}
 
+		const SvgMorph* getSvgMorph(AnimationManagerData* am, AnimObjId animObj, AnimObjId replacement)
+		{
+			const AnimObject* obj = getObject(am, animObj);
+			const AnimObject* replacementObj = getObject(am, replacement);
+			if (!obj || !replacementObj || !obj->svgObject || !replacementObj->svgObject)
+			{
+				return nullptr;
+			}
+
+			auto iter = am->svgMorphs.find(animObj);
+			if (iter != am->svgMorphs.end())
+			{
+				if (iter->second.replacementId == replacement &&
+					iter->second.morph.isMorphBetween(obj->svgObject, replacementObj->svgObject))
+				{
+					return &iter->second.morph;
+				}
+
+				// One of the shapes changed, or this object is being replaced by something else now
+				iter->second.morph.free();
+				am->svgMorphs.erase(iter);
+			}
+
+			CachedSvgMorph cachedMorph = {};
+			cachedMorph.replacementId = replacement;
+			cachedMorph.morph = Svg::createMorph(obj->svgObject, replacementObj->svgObject);
+			auto newIter = am->svgMorphs.emplace(animObj, cachedMorph).first;
+			return &newIter->second.morph;
+		}
+
 		const std::vector<AnimObject>& getAnimObjects(const AnimationManagerData* am)
 		{
 			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
@@ -498,15 +680,9 @@ namespace MathAnim
 
 		std::vector<AnimObjId> getChildren(const AnimationManagerData* am, AnimObjId animObj)
 		{
-			std::vector<AnimObjId> res;
-			for (size_t i = 0; i < am->objects.size(); i++)
-			{
-				if (am->objects[i].parentId == animObj)
-				{
-					res.push_back(am->objects[i].id);
-				}
-			}
+			std::vector<AnimObjId> res = getChildIds(am, animObj);
 
+			// Queued objects aren't in the child index until the end of the frame
 			for (size_t i = 0; i < am->queuedAddObjects.size(); i++)
 			{
 				if (am->queuedAddObjects[i].parentId == animObj)
@@ -523,23 +699,41 @@ namespace MathAnim
 			const AnimObject* obj = getObject(am, objId);
 			if (obj)
 			{
-				bool passedMyself = false;
-				for (int i = 0; i < am->objects.size(); i++)
+				const std::vector<AnimObjId>& siblings = getChildIds(am, obj->parentId);
+				auto myself = std::find(siblings.begin(), siblings.end(), objId);
+				if (myself != siblings.end() && (myself + 1) != siblings.end())
 				{
-					if (am->objects[i].id == objId)
-					{
-						passedMyself = true;
-					}
-					else if (am->objects[i].parentId == obj->parentId && passedMyself)
-					{
-						return am->objects[i].id;
-					}
+					return *(myself + 1);
 				}
 			}
 
 			return objId;
 		}
 
+		void setParent(AnimationManagerData* am, AnimObjId animObj, AnimObjId newParent)
+		{
+			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
+
+			AnimObject* obj = getMutableObject(am, animObj);
+			if (!obj)
+			{
+				g_logger_warning("Cannot set parent of object that does not exist for AnimObjID: '{}'", animObj);
+				return;
+			}
+
+			if (obj->parentId == newParent)
+			{
+				return;
+			}
+
+			removeFromChildIndex(am, obj->parentId, animObj);
+			obj->parentId = newParent;
+			addToChildIndex(am, newParent, animObj);
+
+			// Parent animations apply to their children, so the whole timeline may be different now
+			clearCheckpoints(am);
+		}
+
 		void setRenderAllBoundingBoxes(AnimationManagerData* am, bool shouldRender)
 		{
 			am->shouldRenderBoundingBoxes = shouldRender;
@@ -627,10 +821,12 @@ namespace MathAnim
 				AnimObject animObject = AnimObject::deserialize(j["AnimationObjects"][i], versionMajor);
 				am->objectIdMap[animObject.id] = i;
 				am->objects.emplace_back(animObject);
+				addToChildIndex(am, animObject.parentId, animObject.id);
 			}
 
 			// Sort the animations afterwards since they could be inserted in random order
 			sortAnimations(am);
+			clearCheckpoints(am);
 
 			am->currentFrame = currentFrame;
 			// Calculate all key frame starting points and stuff
@@ -640,11 +836,99 @@ namespace MathAnim
 			resetToFrame(am, currentFrame);
 		}
 
+		void serializeBinary(const AnimationManagerData* am, BinarySceneWriter& writer)
+		{
+			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
+
+			BinaryAnimationManagerRecord record = {};
+			record.activeCamera = am->activeCamera;
+			writer.addRecord(BinarySceneSection::AnimationManager, record);
+
+			for (size_t i = 0; i < am->animations.size(); i++)
+			{
+				am->animations[i].serializeBinary(writer);
+			}
+
+			for (size_t i = 0; i < am->objects.size(); i++)
+			{
+				am->objects[i].serializeBinary(writer);
+			}
+		}
+
+		bool deserializeBinary(AnimationManagerData* am, const BinarySceneReader& reader, int currentFrame)
+		{
+			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
+
+			uint32 versionMajor = reader.getVersionMajor();
+			if (versionMajor < 2 || versionMajor > 3)
+			{
+				g_logger_error("AnimationManager tried to deserialize save file with unknown version '{}.{}'.", versionMajor, reader.getVersionMinor());
+			}
+
+			size_t numManagerRecords = 0;
+			const BinaryAnimationManagerRecord* managerRecord = reader.getRecords<BinaryAnimationManagerRecord>(BinarySceneSection::AnimationManager, &numManagerRecords);
+			am->activeCamera = numManagerRecords > 0 ? managerRecord->activeCamera : NULL_ANIM_OBJECT;
+
+			size_t numAnimations = 0;
+			const BinaryAnimationRecord* animationRecords = reader.getRecords<BinaryAnimationRecord>(BinarySceneSection::Animations, &numAnimations);
+			am->animations.reserve(am->animations.size() + numAnimations);
+			size_t numSkippedAnimations = 0;
+			for (size_t i = 0; i < numAnimations; i++)
+			{
+				Animation animation = Animation::deserializeBinary(reader, animationRecords[i], versionMajor);
+				if (isNull(animation.id))
+				{
+					numSkippedAnimations++;
+					continue;
+				}
+
+				am->animationIdMap[animation.id] = am->animations.size();
+				am->animations.emplace_back(animation);
+			}
+
+			size_t numObjects = 0;
+			const BinaryAnimObjectRecord* objectRecords = reader.getRecords<BinaryAnimObjectRecord>(BinarySceneSection::AnimObjects, &numObjects);
+			am->objects.reserve(am->objects.size() + numObjects);
+			size_t numSkippedObjects = 0;
+			for (size_t i = 0; i < numObjects; i++)
+			{
+				AnimObject animObject = AnimObject::deserializeBinary(reader, objectRecords[i], versionMajor);
+				if (isNull(animObject.id))
+				{
+					numSkippedObjects++;
+					continue;
+				}
+
+				am->objectIdMap[animObject.id] = am->objects.size();
+				am->objects.emplace_back(animObject);
+				addToChildIndex(am, animObject.parentId, animObject.id);
+			}
+
+			if (numSkippedAnimations > 0 || numSkippedObjects > 0)
+			{
+				g_logger_error("Skipped {} corrupted animations and {} corrupted objects while loading the scene.", numSkippedAnimations, numSkippedObjects);
+			}
+
+			// Sort the animations afterwards since they could be inserted in random order
+			sortAnimations(am);
+			clearCheckpoints(am);
+
+			am->currentFrame = currentFrame;
+			// Calculate all key frame starting points and stuff
+			calculateAnimationKeyFrames(am);
+			// Apply all  animations appropriately
+			Application::resetToFrame(currentFrame);
+			resetToFrame(am, currentFrame);
+
+			return numSkippedAnimations == 0 && numSkippedObjects == 0;
+		}
+
 		void sortAnimations(AnimationManagerData* am)
 		{
 			g_logger_assert(am != nullptr, "Null AnimationManagerData.");
 
 			std::sort(am->animations.begin(), am->animations.end(), compareAnimation);
+			clearCheckpoints(am);
 		}
 
 		void legacy_deserialize(AnimationManagerData* am, RawMemory& memory, int currentFrame)
@@ -702,6 +986,7 @@ namespace MathAnim
 						g_logger_assert(magicNumber == MAGIC_NUMBER, "Corrupted animation in file data. Bad magic number '{:#010x}'", magicNumber);
 
 						am->objectIdMap[animObject.id] = i;
+						addToChildIndex(am, animObject.parentId, animObject.id);
 					}
 				}
 
@@ -733,16 +1018,11 @@ namespace MathAnim
 		{
 			MP_PROFILE_EVENT("AnimationManager_ApplyGlobalTransforms");
 			// ----- Apply the parent->child transformations -----
-			// Find all root objects and update recursively
-			for (auto objIter = am->objects.begin(); objIter != am->objects.end(); objIter++)
+			// Update each root object and then its children recursively
+			// and in order from parent->child
+			for (AnimObjId rootId : getChildIds(am, NULL_ANIM_OBJECT))
 			{
-				// If the object has no parent, it's a root object.
-				// Update the transform then update children recursively
-				// and in order from parent->child
-				if (isNull(objIter->parentId))
-				{
-					applyGlobalTransformsTo(am, objIter->id);
-				}
+				applyGlobalTransformsTo(am, rootId);
 			}
 		}
 
@@ -775,12 +1055,9 @@ namespace MathAnim
 
 					// Then append all direct children to the queue so they are
 					// recursively updated
-					for (auto childIter = am->objects.begin(); childIter != am->objects.end(); childIter++)
+					for (AnimObjId childId : getChildIds(am, nextObj->id))
 					{
-						if (childIter->parentId == nextObj->id)
-						{
-							objects.push(childIter->id);
-						}
+						objects.push(childId);
 					}
 
 					for (auto childIter = am->queuedAddObjects.begin(); childIter != am->queuedAddObjects.end(); childIter++)
@@ -798,16 +1075,11 @@ namespace MathAnim
 		{
 			MP_PROFILE_EVENT("AnimationManager_CalculateBBoxes");
 			// ----- Calculate child bbox first then parent -----
-			// Find all root objects and update recursively
-			for (auto objIter = am->objects.begin(); objIter != am->objects.end(); objIter++)
+			// Update each root object and then its children recursively
+			// and in order from parent->child
+			for (AnimObjId rootId : getChildIds(am, NULL_ANIM_OBJECT))
 			{
-				// If the object has no parent, it's a root object.
-				// Update the transform then update children recursively
-				// and in order from parent->child
-				if (isNull(objIter->parentId))
-				{
-					calculateBBoxFor(am, objIter->id);
-				}
+				calculateBBoxFor(am, rootId);
 			}
 		}
 
@@ -857,13 +1129,14 @@ namespace MathAnim
 
 				// Then append all direct children to the queue so they are
 				// recursively updated
-				for (auto childIter = am->objects.begin(); childIter != am->objects.end(); childIter++)
+				for (AnimObjId childId : getChildIds(am, nextObj->id))
 				{
-					if (childIter->parentId == nextObj->id)
+					calculateBBoxFor(am, childId);
+					const AnimObject* child = getObject(am, childId);
+					if (child)
 					{
-						calculateBBoxFor(am, childIter->id);
-						finalBoundingBox.min = CMath::min(finalBoundingBox.min, childIter->bbox.min);
-						finalBoundingBox.max = CMath::max(finalBoundingBox.max, childIter->bbox.max);
+						finalBoundingBox.min = CMath::min(finalBoundingBox.min, child->bbox.min);
+						finalBoundingBox.max = CMath::max(finalBoundingBox.max, child->bbox.max);
 					}
 				}
 
@@ -880,6 +1153,9 @@ namespace MathAnim
 				return;
 			}
 
+			// The starting state of this object changed, so every checkpoint is stale
+			clearCheckpoints(am);
+
 			// It's easiest to just apply all updates from the
 			// root of the scene, so we'll find the root of this
 			// object, reset all the children then update from there
@@ -960,10 +1236,14 @@ namespace MathAnim
 		{
 			am->objects.push_back(obj);
 			am->objectIdMap[obj.id] = am->objects.size() - 1;
+			addToChildIndex(am, obj.parentId, obj.id);
+			clearCheckpoints(am);
 		}
 
 		static void addQueuedAnimation(AnimationManagerData* am, const Animation& animation)
 		{
+			invalidateCheckpoints(am, animation.frameStart);
+
 			for (auto iter = am->animations.begin(); iter != am->animations.end(); iter++)
 			{
 				// Insert it here. The list will always be sorted
@@ -1016,6 +1296,8 @@ namespace MathAnim
 				size_t animationIndex = iter->second;
 				if (animationIndex >= 0 && animationIndex < am->animations.size())
 				{
+					invalidateCheckpoints(am, am->animations[animationIndex].frameStart);
+
 					auto updateIter = am->animations.erase(am->animations.begin() + animationIndex);
 					am->animationIdMap.erase(anim);
 
@@ -1041,7 +1323,12 @@ namespace MathAnim
 			size_t animObjectIndex = iter->second;
 			if (animObjectIndex >= 0 && animObjectIndex < am->objects.size())
 			{
+				removeFromChildIndex(am, am->objects[animObjectIndex].parentId, animObj);
+				am->childrenIdMap.erase(animObj);
 				am->objects[animObjectIndex].free();
+				am->morphedObjects.erase(animObj);
+				freeSvgMorphsReferencing(am, animObj);
+				clearCheckpoints(am);
 
 				auto updateIter = am->objects.erase(am->objects.begin() + animObjectIndex);
 				am->objectIdMap.erase(animObj);
@@ -1172,6 +1459,21 @@ namespace MathAnim
 			// applyGlobalTransforms(am);
 		}
 
+		static void updateObject(AnimationManagerData* am, AnimObject& obj)
+		{
+			// Update any updateable objects
+			switch (obj.objectType)
+			{
+			case AnimObjectTypeV1::Image: obj.as.image.update(am, obj.id); break;
+			case AnimObjectTypeV1::Camera:
+				obj.as.camera.position = obj.globalPosition;
+				obj.as.camera.orientation = CMath::quatFromEulerAngles(obj.rotation);
+				break;
+			default:
+				break;
+			}
+		}
+
 		static void applyAnimationsFrom(AnimationManagerData* am, int startIndex, int currentFrame, bool calculateKeyframes)
 		{
 			MP_PROFILE_EVENT("AnimationManager_ApplyAnimationsFrom");
@@ -1180,17 +1482,238 @@ namespace MathAnim
 			for (auto animIter = am->animations.begin() + startIndex; animIter != am->animations.end(); animIter++)
 			{
 				float frameStart = (float)animIter->frameStart;
-				if (frameStart <= currentFrame)
+				if (frameStart > currentFrame)
+				{
+					// Animations are sorted by start frame, so nothing else can be applied
+					break;
+				}
+
+				// Then apply the animation
+				// NOTE: Finished animations are clamped to exactly 1 so that the result is the same
+				//       regardless of how far past the end of the animation we are. The checkpoints
+				//       depend on this.
+				float interpolatedT = glm::clamp(((float)currentFrame - frameStart) / (float)animIter->duration, 0.0f, 1.0f);
+				if (calculateKeyframes)
+				{
+					animIter->calculateKeyframes(am);
+				}
+
+				if (animIter->type == AnimTypeV1::Transform && interpolatedT < 1.0f)
+				{
+					markMorphed(am, animIter->as.replacementTransform.srcAnimObjectId);
+				}
+
+				animIter->applyAnimation(am, interpolatedT);
+			}
+		}
+
+		static void clearCheckpoints(AnimationManagerData* am)
+		{
+			am->checkpoints.clear();
+			am->checkpointsBuiltUntil = -1;
+		}
+
+		static void buildCheckpointsUntil(AnimationManagerData* am, int frame)
+		{
+			MP_PROFILE_EVENT("AnimationManager_BuildCheckpoints");
+
+			if (am->checkpoints.size() == 0)
+			{
+				// The base checkpoint is the scene before any animations are applied.
+				// This is the only place the full object state gets reset.
+				for (auto objectIter = am->objects.begin(); objectIter != am->objects.end(); objectIter++)
+				{
+					objectIter->resetAllState();
+				}
+				am->morphedObjects.clear();
+
+				captureCheckpoint(am, 0, 0);
+				am->checkpointsBuiltUntil = 0;
+			}
+
+			if (am->checkpointsBuiltUntil + CHECKPOINT_FRAME_INTERVAL > frame)
+			{
+				return;
+			}
+
+			// Roll forward from the last checkpoint, applying every animation that finishes
+			// before the next checkpoint frame
+			restoreCheckpoint(am, am->checkpoints.back());
+			size_t animationPrefix = am->checkpoints.back().animationPrefix;
+			for (int checkpointFrame = am->checkpointsBuiltUntil + CHECKPOINT_FRAME_INTERVAL; checkpointFrame <= frame; checkpointFrame += CHECKPOINT_FRAME_INTERVAL)
+			{
+				size_t newAnimationPrefix = animationPrefix;
+				while (newAnimationPrefix < am->animations.size())
+				{
+					const Animation& anim = am->animations[newAnimationPrefix];
+					if (anim.frameStart + anim.duration > checkpointFrame)
+					{
+						break;
+					}
+					newAnimationPrefix++;
+				}
+
+				if (newAnimationPrefix > animationPrefix)
 				{
-					// Then apply the animation
-					float interpolatedT = ((float)currentFrame - frameStart) / (float)animIter->duration;
-					if (calculateKeyframes)
+					for (size_t i = animationPrefix; i < newAnimationPrefix; i++)
 					{
-						animIter->calculateKeyframes(am);
+						am->animations[i].applyAnimation(am, 1.0f);
 					}
-					animIter->applyAnimation(am, interpolatedT);
+
+					captureCheckpoint(am, checkpointFrame, newAnimationPrefix);
+					animationPrefix = newAnimationPrefix;
+				}
+
+				am->checkpointsBuiltUntil = checkpointFrame;
+			}
+		}
+
+		static void captureCheckpoint(AnimationManagerData* am, int frame, size_t animationPrefix)
+		{
+			AnimationCheckpoint checkpoint = {};
+			checkpoint.frame = frame;
+			checkpoint.animationPrefix = animationPrefix;
+			checkpoint.objectStates.resize(am->objects.size());
+
+			for (size_t i = 0; i < am->objects.size(); i++)
+			{
+				const AnimObject& obj = am->objects[i];
+				AnimObjectStateSnapshot& state = checkpoint.objectStates[i];
+				state.position = obj.position;
+				state.rotation = obj.rotation;
+				state.scale = obj.scale;
+				state.percentCreated = obj.percentCreated;
+				state.strokeWidth = obj.strokeWidth;
+				state.strokeColor = obj.strokeColor;
+				state.fillColor = obj.fillColor;
+				state.circumscribeId = obj.circumscribeId;
+				state.status = obj.status;
+			}
+
+			am->checkpoints.emplace_back(std::move(checkpoint));
+		}
+
+		static void restoreCheckpoint(AnimationManagerData* am, const AnimationCheckpoint& checkpoint)
+		{
+			MP_PROFILE_EVENT("AnimationManager_RestoreCheckpoint");
+			g_logger_assert(checkpoint.objectStates.size() == am->objects.size(), "Checkpoint is out of date. Objects were added or removed without invalidating it.");
+
+			for (size_t i = 0; i < am->objects.size(); i++)
+			{
+				AnimObject& obj = am->objects[i];
+				const AnimObjectStateSnapshot& state = checkpoint.objectStates[i];
+				obj.position = state.position;
+				obj.globalPosition = state.position;
+				obj.rotation = state.rotation;
+				obj.scale = state.scale;
+				obj.percentCreated = state.percentCreated;
+				obj.strokeWidth = state.strokeWidth;
+				obj.strokeColor = state.strokeColor;
+				obj.fillColor = state.fillColor;
+				obj.circumscribeId = state.circumscribeId;
+				obj.status = state.status;
+			}
+
+			// Checkpoints never contain in-progress morphs, so undo any that were applied
+			for (auto morphedId : am->morphedObjects)
+			{
+				AnimObject* obj = getMutableObject(am, morphedId);
+				if (obj)
+				{
+					obj->resetSvgObject();
 				}
 			}
+			am->morphedObjects.clear();
+		}
+
+		static const AnimationCheckpoint& findCheckpoint(const AnimationManagerData* am, int frame)
+		{
+			g_logger_assert(am->checkpoints.size() > 0, "Cannot find a checkpoint before they have been built.");
+
+			// Find the last checkpoint at or before this frame
+			auto iter = std::upper_bound(
+				am->checkpoints.begin(),
+				am->checkpoints.end(),
+				frame,
+				[](int f, const AnimationCheckpoint& checkpoint) { return f < checkpoint.frame; }
+			);
+			if (iter == am->checkpoints.begin())
+			{
+				return am->checkpoints.front();
+			}
+
+			return *(iter - 1);
+		}
+
+		static void markMorphed(AnimationManagerData* am, AnimObjId animObj)
+		{
+			const AnimObject* obj = getObject(am, animObj);
+			if (!obj)
+			{
+				return;
+			}
+
+			// ReplacementTransforms recursively morph children as well
+			am->morphedObjects.insert(animObj);
+			for (auto childIter = obj->beginBreadthFirst(am); childIter != obj->end(); ++childIter)
+			{
+				am->morphedObjects.insert(*childIter);
+			}
+		}
+
+		static void freeSvgMorphsReferencing(AnimationManagerData* am, AnimObjId animObj)
+		{
+			for (auto iter = am->svgMorphs.begin(); iter != am->svgMorphs.end();)
+			{
+				if (iter->first == animObj || iter->second.replacementId == animObj)
+				{
+					iter->second.morph.free();
+					iter = am->svgMorphs.erase(iter);
+				}
+				else
+				{
+					iter++;
+				}
+			}
+		}
+
+		static const std::vector<AnimObjId>& getChildIds(const AnimationManagerData* am, AnimObjId parent)
+		{
+			static const std::vector<AnimObjId> noChildren = {};
+
+			auto iter = am->childrenIdMap.find(parent);
+			if (iter != am->childrenIdMap.end())
+			{
+				return iter->second;
+			}
+
+			return noChildren;
+		}
+
+		static void addToChildIndex(AnimationManagerData* am, AnimObjId parent, AnimObjId child)
+		{
+			am->childrenIdMap[parent].push_back(child);
+		}
+
+		static void removeFromChildIndex(AnimationManagerData* am, AnimObjId parent, AnimObjId child)
+		{
+			auto iter = am->childrenIdMap.find(parent);
+			if (iter == am->childrenIdMap.end())
+			{
+				return;
+			}
+
+			std::vector<AnimObjId>& children = iter->second;
+			auto childIter = std::find(children.begin(), children.end(), child);
+			if (childIter != children.end())
+			{
+				children.erase(childIter);
+			}
+
+			if (children.empty())
+			{
+				am->childrenIdMap.erase(iter);
+			}
 		}
 	}
-}
\ No newline at end of file
+}
@@ -14,10 +14,9 @@ namespace MathAnim
 	{
 		g_logger_assert(self->_svgObjectStart == nullptr && self->svgObject == nullptr, "Square object initialized twice.");
 
-		self->_svgObjectStart = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-		*self->_svgObjectStart = Svg::createDefault();
-		self->svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-		*self->svgObject = Svg::createDefault();
+		SvgObject* svg = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+		*svg = Svg::createDefault();
+		self->setSvgObjectStart(svg);
 
 		Svg::beginPath(self->_svgObjectStart, { -sideLength / 2.0f, -sideLength / 2.0f });
 		Svg::lineTo(self->_svgObjectStart, { -sideLength / 2.0f, sideLength / 2.0f });
@@ -33,13 +32,7 @@ namespace MathAnim
 	void Square::reInit(AnimObject* self)
 	{
 		// TODO: Do something better than this
-		self->svgObject->free();
-		g_memory_free(self->svgObject);
-		self->svgObject = nullptr;
-
-		self->_svgObjectStart->free();
-		g_memory_free(self->_svgObjectStart);
-		self->_svgObjectStart = nullptr;
+		self->freeSvgObjects();
 
 		self->as.square.init(self);
 	}
@@ -93,10 +86,9 @@ namespace MathAnim
 	{
 		g_logger_assert(self->_svgObjectStart == nullptr && self->svgObject == nullptr, "Circle object initialized twice.");
 
-		self->_svgObjectStart = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-		*self->_svgObjectStart = Svg::createDefault();
-		self->svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-		*self->svgObject = Svg::createDefault();
+		SvgObject* svg = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+		*svg = Svg::createDefault();
+		self->setSvgObjectStart(svg);
 
 		// See here for how to construct circle with beziers 
 		// https://stackoverflow.com/questions/1734745/how-to-create-circle-with-bzier-curves
@@ -129,13 +121,7 @@ namespace MathAnim
 
 	void Circle::reInit(AnimObject* self)
 	{
-		self->svgObject->free();
-		g_memory_free(self->svgObject);
-		self->svgObject = nullptr;
-
-		self->_svgObjectStart->free();
-		g_memory_free(self->_svgObjectStart);
-		self->_svgObjectStart = nullptr;
+		self->freeSvgObjects();
 
 		self->as.circle.init(self);
 	}
@@ -189,10 +175,9 @@ namespace MathAnim
 	{
 		g_logger_assert(self->_svgObjectStart == nullptr && self->svgObject == nullptr, "Arrow object initialized twice.");
 
-		self->_svgObjectStart = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-		*self->_svgObjectStart = Svg::createDefault();
-		self->svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-		*self->svgObject = Svg::createDefault();
+		SvgObject* svg = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+		*svg = Svg::createDefault();
+		self->setSvgObjectStart(svg);
 
 		const float halfLength = stemLength / 2.0f;
 		const float halfWidth = stemWidth / 2.0f;
@@ -216,13 +201,7 @@ namespace MathAnim
 
 	void Arrow::reInit(AnimObject* self)
 	{
-		self->svgObject->free();
-		g_memory_free(self->svgObject);
-		self->svgObject = nullptr;
-
-		self->_svgObjectStart->free();
-		g_memory_free(self->_svgObjectStart);
-		self->_svgObjectStart = nullptr;
+		self->freeSvgObjects();
 
 		self->as.arrow.init(self);
 	}
@@ -20,6 +20,10 @@ namespace MathAnim
 		// Generate children objects and place them accordingly
 		// Each child represents a group sub-object
 
+		// LaTeX output uses the same few glyphs over and over, so children with identical
+		// geometry share one copy of it
+		std::unordered_map<std::string, SvgObject*> sharedSvgs = {};
+
 		float zOffset = 0.0f;
 		for (int i = 0; i < svgGroup->numObjects; i++)
 		{
@@ -34,13 +38,32 @@ namespace MathAnim
 			// To avoid z-fighting, we'll offset the z-indices very slightly
 			zOffset += 0.0001f;
 			childObj.isGenerated = true;
-			// Copy the sub-object as the svg object here
-			childObj._svgObjectStart = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-			childObj.svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-			*(childObj._svgObjectStart) = Svg::createDefault();
-			*(childObj.svgObject) = Svg::createDefault();
-			Svg::copy(childObj._svgObjectStart, &obj);
-			Svg::copy(childObj.svgObject, &obj);
+			SvgObject* svg = nullptr;
+			std::string shareKey = "";
+			if (obj.md5 && obj.md5Length > 0)
+			{
+				// The style is copied along with the path, so it has to match too
+				shareKey = std::string((const char*)obj.md5, obj.md5Length) + (char)obj.fillType;
+				shareKey.append((const char*)&obj.fillColor, sizeof(Vec4));
+				auto iter = sharedSvgs.find(shareKey);
+				if (iter != sharedSvgs.end())
+				{
+					svg = Svg::retain(iter->second);
+				}
+			}
+
+			if (!svg)
+			{
+				// Copy the sub-object as the svg object here
+				svg = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+				*svg = Svg::createDefault();
+				Svg::copy(svg, &obj);
+				if (shareKey != "")
+				{
+					sharedSvgs[shareKey] = svg;
+				}
+			}
+			childObj.setSvgObjectStart(svg);
 			childObj._fillColorStart = glm::u8vec4(
 				(uint8)(obj.fillColor.r * 255.0f),
 				(uint8)(obj.fillColor.g * 255.0f),
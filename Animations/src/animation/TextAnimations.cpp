@@ -13,6 +13,8 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+
 namespace MathAnim
 {
 	// Number of spaces for tabs. Make this configurable
@@ -37,116 +39,68 @@ namespace MathAnim
 		return setTextHelper(ogText, ogTextLength, newText.c_str(), newText.length());
 	}
 
-	void TextObject::init(AnimationManagerData* am, AnimObjId parentId)
+	struct FinishedLaTex
 	{
-		if (font == nullptr)
-		{
-			return;
-		}
+		std::string latex;
+		bool succeeded;
+	};
 
-		std::string textStr = std::string(text);
+	// Filled in by LaTexLayer callbacks, which always run on the main thread
+	static std::vector<FinishedLaTex> finishedLaTex = {};
 
-		// First figure out the total size of the text so we can center it around the origin
-		Vec2 size = Vec2{ 0.0f, 0.0f };
-		for (int i = 0; i < textStr.length(); i++)
-		{
-			if (textStr[i] == '\n')
-			{
-				size.y += font->lineHeight;
-				continue;
-			}
-
-			uint8 codepoint = (uint8)textStr[i];
-			const GlyphOutline& glyphOutline = font->getGlyphInfo(codepoint);
-			if (!glyphOutline.svg)
-			{
-				continue;
-			}
-
-			float halfGlyphHeight = glyphOutline.glyphHeight / 2.0f;
-			float halfGlyphWidth = glyphOutline.glyphWidth / 2.0f;
-			Vec2 offset = Vec2{
-				glyphOutline.bearingX + halfGlyphWidth,
-				halfGlyphHeight - glyphOutline.descentY
-			};
+	// Where a glyph should end up, before it's matched up with a child object
+	struct GlyphLayout
+	{
+		uint32 textIndex;
+		uint32 codepoint;
+		Vec2 position;
+		glm::u8vec4 color;
+		SvgObject* svg;
+	};
 
-			// TODO: I may have to add kerning info here
-			size.x += glyphOutline.advanceX;
-		}
+	// ------------- Internal Functions -------------
+	static void layoutTextObject(const TextObject& textObject, std::vector<GlyphLayout>& outLayout);
+	static void layoutCodeBlock(const CodeBlock& codeBlock, std::vector<GlyphLayout>& outLayout);
+	static void syncGlyphChildren(AnimationManagerData* am, AnimObjId parentId, GlyphRun** glyphRun, const std::vector<GlyphLayout>& layout, bool useLayoutColor);
+	static void removeGeneratedChildren(AnimationManagerData* am, AnimObject* obj);
+	static void freeGlyphRun(GlyphRun** glyphRun);
+	static void onLaTexFinished(const std::string& latex, bool succeeded, void* userData);
 
-		// Generate children that represent each character of the text object `obj`
-		Vec2 halfSize = size / 2.0f;
-		Vec2 cursorPos = Vec2{ -halfSize.x, halfSize.y };
-		for (int i = 0; i < textStr.length(); i++)
+	const GlyphInstance* GlyphRun::getGlyph(uint32 textIndex) const
+	{
+		auto iter = std::lower_bound(glyphs.begin(), glyphs.end(), textIndex,
+			[](const GlyphInstance& glyph, uint32 index) { return glyph.textIndex < index; });
+		if (iter != glyphs.end() && iter->textIndex == textIndex)
 		{
-			if (textStr[i] == '\n')
-			{
-				cursorPos = Vec2{ -halfSize.x, cursorPos.y - font->lineHeight };
-				continue;
-			}
-
-			uint8 codepoint = (uint8)textStr[i];
-			const GlyphOutline& glyphOutline = font->getGlyphInfo(codepoint);
-			if (!glyphOutline.svg)
-			{
-				continue;
-			}
+			return &(*iter);
+		}
 
-			float halfGlyphHeight = glyphOutline.glyphHeight / 2.0f;
-			float halfGlyphWidth = glyphOutline.glyphWidth / 2.0f;
-			Vec2 offset = Vec2{
-				glyphOutline.bearingX + halfGlyphWidth,
-				halfGlyphHeight - glyphOutline.descentY
-			};
+		return nullptr;
+	}
 
-			if (textStr[i] != ' ' && textStr[i] != '\t')
-			{
-				// Add this character as a child
-				AnimObject childObj = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::SvgObject, parentId, true);
-
-				Vec2 finalOffset = offset + cursorPos;
-				childObj._positionStart = Vec3{ finalOffset.x, finalOffset.y, 0.0f };
-
-				// Copy the glyph as the svg object here
-				childObj._svgObjectStart = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-				childObj.svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-				*(childObj._svgObjectStart) = Svg::createDefault();
-				*(childObj.svgObject) = Svg::createDefault();
-				Svg::copy(childObj._svgObjectStart, glyphOutline.svg);
-				childObj.retargetSvgScale();
-
-				childObj.name = (uint8*)g_memory_realloc(childObj.name, sizeof(uint8) * 2);
-				childObj.nameLength = 1;
-				childObj.name[0] = codepoint;
-				childObj.name[1] = '\0';
-
-				AnimationManager::addAnimObject(am, childObj);
-				// TODO: Ugly what do I do???
-				SceneHierarchyPanel::addNewAnimObject(childObj);
-			}
+	AnimObjId GlyphRun::getGlyphChild(uint32 textIndex) const
+	{
+		const GlyphInstance* glyph = getGlyph(textIndex);
+		return glyph ? glyph->childId : NULL_ANIM_OBJECT;
+	}
 
-			// TODO: I may have to add kerning info here
-			cursorPos += Vec2{ glyphOutline.advanceX, 0.0f };
-		}
+	void TextObject::init(AnimationManagerData* am, AnimObjId parentId)
+	{
+		std::vector<GlyphLayout> layout = {};
+		layoutTextObject(*this, layout);
+		syncGlyphChildren(am, parentId, &glyphRun, layout, false);
 	}
 
 	void TextObject::reInit(AnimationManagerData* am, AnimObject* obj)
 	{
-		// First remove all generated children, which were generated as a result
-		// of this object (presumably)
-		// NOTE: This is direct descendants, no recursive children here
-		for (int i = 0; i < obj->generatedChildrenIds.size(); i++)
+		if (!glyphRun)
 		{
-			AnimObject* child = AnimationManager::getMutableObject(am, obj->generatedChildrenIds[i]);
-			if (child)
-			{
-				SceneHierarchyPanel::deleteAnimObject(*child);
-				AnimationManager::removeAnimObject(am, obj->generatedChildrenIds[i]);
-			}
+			// Nothing to match the children against (e.g. they were loaded from a project file),
+			// so remove all of them and start over
+			removeGeneratedChildren(am, obj);
 		}
-		obj->generatedChildrenIds.clear();
 
-		// Next init again which should regenerate the children
+		// Children of glyphs that are still there get reused, the rest are removed or added
 		init(am, obj->id);
 	}
 
@@ -169,6 +123,8 @@ namespace MathAnim
 
 	void TextObject::free()
 	{
+		freeGlyphRun(&this->glyphRun);
+
 		if (this->font)
 		{
 			Fonts::unloadFont(this->font);
@@ -255,6 +211,7 @@ namespace MathAnim
 			fontFilepath[fontFilepathLength] = '\0';
 
 			res.font = Fonts::loadFont((const char*)fontFilepath);
+			res.glyphRun = nullptr;
 			g_memory_free(fontFilepath);
 
 			return res;
@@ -271,6 +228,7 @@ namespace MathAnim
 		TextObject res;
 		// TODO: Come up with application default font
 		res.font = nullptr;
+		res.glyphRun = nullptr;
 		static const char defaultText[] = "Text Object";
 		res.text = (char*)g_memory_allocate(sizeof(defaultText) / sizeof(char));
 		g_memory_copyMem(res.text, sizeof(defaultText) / sizeof(char), (void*)defaultText, sizeof(defaultText) / sizeof(char));
@@ -279,22 +237,6 @@ namespace MathAnim
 		return res;
 	}
 
-	void LaTexObject::update(AnimationManagerData* am, AnimObjId parentId)
-	{
-		if (isParsingLaTex)
-		{
-			if (LaTexLayer::laTexIsReady(text, isEquation))
-			{
-				AnimObject* parent = AnimationManager::getMutableObject(am, parentId);
-				if (parent)
-				{
-					reInit(am, parent);
-				}
-				isParsingLaTex = false;
-			}
-		}
-	}
-
 	void LaTexObject::init(AnimationManagerData* am, AnimObjId parentId)
 	{
 		// TODO: Memory leak somewhere in here
@@ -353,8 +295,9 @@ namespace MathAnim
 	{
 		if (!isParsingLaTex)
 		{
-			LaTexLayer::laTexToSvg(text, isEquation);
+			// The callback may run right away if the svg already exists
 			isParsingLaTex = true;
+			LaTexLayer::laTexToSvg(text, isEquation, onLaTexFinished);
 		}
 	}
 
@@ -441,132 +384,59 @@ namespace MathAnim
 		return res;
 	}
 
-	void CodeBlock::init(AnimationManagerData* am, AnimObjId parentId)
+	void LaTexObject::reInitFinishedObjects(AnimationManagerData* am)
 	{
-		Font* font = Fonts::getDefaultMonoFont();
-		if (font == nullptr)
-		{
-			static bool loggedWarning = false;
-			if (!loggedWarning)
-			{
-				g_logger_warning("No Default Mono Font found. Cannot generate code block.");
-				loggedWarning = true;
-			}
-			return;
-		}
-
-		const SyntaxHighlighter* highlighter = Highlighters::getHighlighter(this->language);
-		if (!highlighter)
+		if (finishedLaTex.empty())
 		{
 			return;
 		}
 
-		const SyntaxTheme* syntaxTheme = Highlighters::getTheme(this->theme);
-		if (!syntaxTheme)
+		// Copies of an object (or several objects with the same text) all wait on the same expression
+		std::vector<FinishedLaTex> finished = {};
+		finished.swap(finishedLaTex);
+		for (const AnimObject& constObj : AnimationManager::getAnimObjects(am))
 		{
-			return;
-		}
-
-		// First parse the code block and get the code in segmented form with highlight information
-		CodeHighlights highlights = highlighter->parse(text, textLength, *syntaxTheme);
-
-		// Generate children that represent each character of the text object `obj`
-		Vec2 cursorPos = Vec2{ 0, 0 };
-		auto highlightIter = highlights.begin();
-		for (size_t textIndex = 0; textIndex < (size_t)textLength; textIndex++)
-		{
-			highlightIter = highlightIter.next(textIndex);
-			Vec4 textColor = highlightIter.getForegroundColor(*syntaxTheme);
-
-			if (text[textIndex] == '\n')
-			{
-				cursorPos = Vec2{ 0.0f, cursorPos.y - font->lineHeight };
-				continue;
-			}
-
-			uint8 codepoint = (uint8)text[textIndex];
-			bool isTab = codepoint == '\t';
-			if (codepoint == '\t')
-			{
-				codepoint = ' ';
-			}
-
-			const GlyphOutline& glyphOutline = font->getGlyphInfo(codepoint);
-			if (!glyphOutline.svg)
+			if (constObj.objectType != AnimObjectTypeV1::LaTexObject || !constObj.as.laTexObject.isParsingLaTex)
 			{
 				continue;
 			}
 
-			float halfGlyphHeight = glyphOutline.glyphHeight / 2.0f;
-			float halfGlyphWidth = glyphOutline.glyphWidth / 2.0f;
-			Vec2 offset = Vec2{
-				glyphOutline.bearingX + halfGlyphWidth,
-				halfGlyphHeight - glyphOutline.descentY
-			};
-
-			if (text[textIndex] != ' ' && text[textIndex] != '\t')
+			for (const FinishedLaTex& result : finished)
 			{
-				// Add this character as a child
-				AnimObject childObj = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::SvgObject, parentId, true);
-
-				Vec2 finalOffset = offset + cursorPos;
-				childObj._positionStart = Vec3{ finalOffset.x, finalOffset.y, 0.0f };
-
-				// Copy the glyph as the svg object here
-				childObj._svgObjectStart = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-				childObj.svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-				*(childObj._svgObjectStart) = Svg::createDefault();
-				*(childObj.svgObject) = Svg::createDefault();
-				Svg::copy(childObj._svgObjectStart, glyphOutline.svg);
-				childObj.retargetSvgScale();
-
-				childObj._fillColorStart = glm::u8vec4(
-					(uint8)(textColor.r * 255.0f),
-					(uint8)(textColor.g * 255.0f),
-					(uint8)(textColor.b * 255.0f),
-					(uint8)(textColor.a * 255.0f)
-				);
-				childObj.fillColor = childObj._fillColorStart;
-				childObj._strokeColorStart = childObj._fillColorStart;
-				childObj.strokeColor = childObj._fillColorStart;
-
-				childObj.name = (uint8*)g_memory_realloc(childObj.name, sizeof(uint8) * 2);
-				childObj.nameLength = 1;
-				childObj.name[0] = codepoint;
-				childObj.name[1] = '\0';
-
-				AnimationManager::addAnimObject(am, childObj);
-				// TODO: Ugly what do I do???
-				SceneHierarchyPanel::addNewAnimObject(childObj);
-			}
+				if (result.latex != constObj.as.laTexObject.text)
+				{
+					continue;
+				}
 
-			// TODO: I may have to add kerning info here
-			float advance = glyphOutline.advanceX;
-			if (isTab)
-			{
-				advance *= tabDepth;
+				AnimObject* obj = AnimationManager::getMutableObject(am, constObj.id);
+				// Failures were already logged, stop waiting so the text can be edited again
+				obj->as.laTexObject.isParsingLaTex = false;
+				if (result.succeeded)
+				{
+					obj->as.laTexObject.reInit(am, obj);
+				}
+				break;
 			}
-			cursorPos += Vec2{ advance, 0.0f };
 		}
 	}
 
+	void CodeBlock::init(AnimationManagerData* am, AnimObjId parentId)
+	{
+		std::vector<GlyphLayout> layout = {};
+		layoutCodeBlock(*this, layout);
+		syncGlyphChildren(am, parentId, &glyphRun, layout, true);
+	}
+
 	void CodeBlock::reInit(AnimationManagerData* am, AnimObject* obj)
 	{
-		// First remove all generated children, which were generated as a result
-		// of this object (presumably)
-		// NOTE: This is direct descendants, no recursive children here
-		for (int i = 0; i < obj->generatedChildrenIds.size(); i++)
+		if (!glyphRun)
 		{
-			AnimObject* child = AnimationManager::getMutableObject(am, obj->generatedChildrenIds[i]);
-			if (child)
-			{
-				SceneHierarchyPanel::deleteAnimObject(*child);
-				AnimationManager::removeAnimObject(am, obj->generatedChildrenIds[i]);
-			}
+			// Nothing to match the children against (e.g. they were loaded from a project file),
+			// so remove all of them and start over
+			removeGeneratedChildren(am, obj);
 		}
-		obj->generatedChildrenIds.clear();
 
-		// Next init again which should regenerate the children
+		// Children of glyphs that are still there get reused, the rest are removed or added
 		this->init(am, obj->id);
 	}
 
@@ -605,6 +475,7 @@ namespace MathAnim
 			res.text = (char*)g_memory_allocate(sizeof(char) * (res.textLength + 1));
 			memory.readDangerous((uint8*)res.text, sizeof(uint8) * res.textLength);
 			res.text[res.textLength] = '\0';
+			res.glyphRun = nullptr;
 
 			return res;
 		}
@@ -617,6 +488,8 @@ namespace MathAnim
 
 	void CodeBlock::free()
 	{
+		freeGlyphRun(&this->glyphRun);
+
 		if (this->text)
 		{
 			g_memory_free(this->text);
@@ -654,6 +527,7 @@ namespace MathAnim
 		CodeBlock res;
 		res.language = HighlighterLanguage::Cpp;
 		res.theme = HighlighterTheme::MonokaiNight;
+		res.glyphRun = nullptr;
 		static const char defaultText[] = R"DEFAULT_LANG(#include <stdio.h>
 
 int main()
@@ -668,4 +542,325 @@ int main()
 		res.text[res.textLength] = '\0';
 		return res;
 	}
-}
\ No newline at end of file
+
+	// ------------- Internal Functions -------------
+	static void layoutTextObject(const TextObject& textObject, std::vector<GlyphLayout>& outLayout)
+	{
+		const Font* font = textObject.font;
+		if (font == nullptr || textObject.text == nullptr)
+		{
+			return;
+		}
+
+		std::string textStr = std::string(textObject.text);
+
+		// First figure out the total size of the text so we can center it around the origin
+		Vec2 size = Vec2{ 0.0f, 0.0f };
+		for (int i = 0; i < textStr.length(); i++)
+		{
+			if (textStr[i] == '\n')
+			{
+				size.y += font->lineHeight;
+				continue;
+			}
+
+			uint8 codepoint = (uint8)textStr[i];
+			const GlyphOutline& glyphOutline = font->getGlyphInfo(codepoint);
+			if (!glyphOutline.svg)
+			{
+				continue;
+			}
+
+			float halfGlyphHeight = glyphOutline.glyphHeight / 2.0f;
+			float halfGlyphWidth = glyphOutline.glyphWidth / 2.0f;
+			Vec2 offset = Vec2{
+				glyphOutline.bearingX + halfGlyphWidth,
+				halfGlyphHeight - glyphOutline.descentY
+			};
+
+			// TODO: I may have to add kerning info here
+			size.x += glyphOutline.advanceX;
+		}
+
+		// Lay out every character of the text object `obj`
+		Vec2 halfSize = size / 2.0f;
+		Vec2 cursorPos = Vec2{ -halfSize.x, halfSize.y };
+		outLayout.reserve(textStr.length());
+		for (int i = 0; i < textStr.length(); i++)
+		{
+			if (textStr[i] == '\n')
+			{
+				cursorPos = Vec2{ -halfSize.x, cursorPos.y - font->lineHeight };
+				continue;
+			}
+
+			uint8 codepoint = (uint8)textStr[i];
+			const GlyphOutline& glyphOutline = font->getGlyphInfo(codepoint);
+			if (!glyphOutline.svg)
+			{
+				continue;
+			}
+
+			float halfGlyphHeight = glyphOutline.glyphHeight / 2.0f;
+			float halfGlyphWidth = glyphOutline.glyphWidth / 2.0f;
+			Vec2 offset = Vec2{
+				glyphOutline.bearingX + halfGlyphWidth,
+				halfGlyphHeight - glyphOutline.descentY
+			};
+
+			if (textStr[i] != ' ' && textStr[i] != '\t')
+			{
+				GlyphLayout glyph;
+				glyph.textIndex = (uint32)i;
+				glyph.codepoint = codepoint;
+				glyph.position = offset + cursorPos;
+				glyph.color = glm::u8vec4(255, 255, 255, 255);
+				glyph.svg = glyphOutline.svg;
+				outLayout.push_back(glyph);
+			}
+
+			// TODO: I may have to add kerning info here
+			cursorPos += Vec2{ glyphOutline.advanceX, 0.0f };
+		}
+	}
+
+	static void layoutCodeBlock(const CodeBlock& codeBlock, std::vector<GlyphLayout>& outLayout)
+	{
+		Font* font = Fonts::getDefaultMonoFont();
+		if (font == nullptr)
+		{
+			static bool loggedWarning = false;
+			if (!loggedWarning)
+			{
+				g_logger_warning("No Default Mono Font found. Cannot generate code block.");
+				loggedWarning = true;
+			}
+			return;
+		}
+
+		const SyntaxHighlighter* highlighter = Highlighters::getHighlighter(codeBlock.language);
+		if (!highlighter)
+		{
+			return;
+		}
+
+		const SyntaxTheme* syntaxTheme = Highlighters::getTheme(codeBlock.theme);
+		if (!syntaxTheme)
+		{
+			return;
+		}
+
+		// First parse the code block and get the code in segmented form with highlight information
+		CodeHighlights highlights = highlighter->parse(codeBlock.text, codeBlock.textLength, *syntaxTheme);
+
+		// Lay out every character of the code block
+		Vec2 cursorPos = Vec2{ 0, 0 };
+		auto highlightIter = highlights.begin();
+		outLayout.reserve((size_t)codeBlock.textLength);
+		for (size_t textIndex = 0; textIndex < (size_t)codeBlock.textLength; textIndex++)
+		{
+			highlightIter = highlightIter.next(textIndex);
+			Vec4 textColor = highlightIter.getForegroundColor(*syntaxTheme);
+
+			if (codeBlock.text[textIndex] == '\n')
+			{
+				cursorPos = Vec2{ 0.0f, cursorPos.y - font->lineHeight };
+				continue;
+			}
+
+			uint8 codepoint = (uint8)codeBlock.text[textIndex];
+			bool isTab = codepoint == '\t';
+			if (codepoint == '\t')
+			{
+				codepoint = ' ';
+			}
+
+			const GlyphOutline& glyphOutline = font->getGlyphInfo(codepoint);
+			if (!glyphOutline.svg)
+			{
+				continue;
+			}
+
+			float halfGlyphHeight = glyphOutline.glyphHeight / 2.0f;
+			float halfGlyphWidth = glyphOutline.glyphWidth / 2.0f;
+			Vec2 offset = Vec2{
+				glyphOutline.bearingX + halfGlyphWidth,
+				halfGlyphHeight - glyphOutline.descentY
+			};
+
+			if (codeBlock.text[textIndex] != ' ' && codeBlock.text[textIndex] != '\t')
+			{
+				GlyphLayout glyph;
+				glyph.textIndex = (uint32)textIndex;
+				glyph.codepoint = codepoint;
+				glyph.position = offset + cursorPos;
+				glyph.color = glm::u8vec4(
+					(uint8)(textColor.r * 255.0f),
+					(uint8)(textColor.g * 255.0f),
+					(uint8)(textColor.b * 255.0f),
+					(uint8)(textColor.a * 255.0f)
+				);
+				glyph.svg = glyphOutline.svg;
+				outLayout.push_back(glyph);
+			}
+
+			// TODO: I may have to add kerning info here
+			float advance = glyphOutline.advanceX;
+			if (isTab)
+			{
+				advance *= tabDepth;
+			}
+			cursorPos += Vec2{ advance, 0.0f };
+		}
+	}
+
+	static void syncGlyphChildren(AnimationManagerData* am, AnimObjId parentId, GlyphRun** glyphRun, const std::vector<GlyphLayout>& layout, bool useLayoutColor)
+	{
+		if (*glyphRun == nullptr)
+		{
+			*glyphRun = g_memory_new GlyphRun();
+		}
+
+		// Children from the last layout, in text order for each codepoint. Handing them out
+		// in order keeps the ids of the characters that didn't move stable.
+		std::unordered_map<uint32, std::vector<AnimObjId>> unusedChildren = {};
+		for (const GlyphInstance& glyph : (*glyphRun)->glyphs)
+		{
+			unusedChildren[glyph.codepoint].push_back(glyph.childId);
+		}
+		std::unordered_map<uint32, size_t> nextUnusedChild = {};
+
+		// The children get re-added in their new order below
+		AnimObject* parent = AnimationManager::getMutableObject(am, parentId);
+		if (parent)
+		{
+			std::unordered_set<AnimObjId> glyphChildren = {};
+			for (const GlyphInstance& glyph : (*glyphRun)->glyphs)
+			{
+				glyphChildren.insert(glyph.childId);
+			}
+
+			auto newEnd = std::remove_if(parent->generatedChildrenIds.begin(), parent->generatedChildrenIds.end(),
+				[&](AnimObjId id) { return glyphChildren.find(id) != glyphChildren.end(); });
+			parent->generatedChildrenIds.erase(newEnd, parent->generatedChildrenIds.end());
+		}
+
+		std::vector<GlyphInstance> newGlyphs = {};
+		newGlyphs.reserve(layout.size());
+		for (const GlyphLayout& glyphLayout : layout)
+		{
+			AnimObject* child = nullptr;
+			auto unusedIter = unusedChildren.find(glyphLayout.codepoint);
+			if (unusedIter != unusedChildren.end())
+			{
+				size_t& nextIndex = nextUnusedChild[glyphLayout.codepoint];
+				while (child == nullptr && nextIndex < unusedIter->second.size())
+				{
+					child = AnimationManager::getMutableObject(am, unusedIter->second[nextIndex]);
+					nextIndex++;
+				}
+			}
+
+			if (child)
+			{
+				// Same glyph, it just needs to be moved (and maybe recolored)
+				child->_positionStart = Vec3{ glyphLayout.position.x, glyphLayout.position.y, 0.0f };
+				if (child->_svgObjectStart != glyphLayout.svg)
+				{
+					// The font changed
+					child->setSvgObjectStart(Svg::retain(glyphLayout.svg));
+					child->retargetSvgScale();
+				}
+
+				if (useLayoutColor)
+				{
+					child->_fillColorStart = glyphLayout.color;
+					child->fillColor = child->_fillColorStart;
+					child->_strokeColorStart = child->_fillColorStart;
+					child->strokeColor = child->_fillColorStart;
+				}
+
+				parent = AnimationManager::getMutableObject(am, parentId);
+				if (parent)
+				{
+					parent->generatedChildrenIds.push_back(child->id);
+				}
+
+				newGlyphs.push_back({ child->id, glyphLayout.position, glyphLayout.textIndex, glyphLayout.codepoint });
+				continue;
+			}
+
+			// Add this character as a child
+			AnimObject childObj = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::SvgObject, parentId, true);
+			childObj._positionStart = Vec3{ glyphLayout.position.x, glyphLayout.position.y, 0.0f };
+
+			// Every use of a glyph shares the outline the font already has
+			childObj.setSvgObjectStart(Svg::retain(glyphLayout.svg));
+			childObj.retargetSvgScale();
+
+			if (useLayoutColor)
+			{
+				childObj._fillColorStart = glyphLayout.color;
+				childObj.fillColor = childObj._fillColorStart;
+				childObj._strokeColorStart = childObj._fillColorStart;
+				childObj.strokeColor = childObj._fillColorStart;
+			}
+
+			childObj.name = (uint8*)g_memory_realloc(childObj.name, sizeof(uint8) * 2);
+			childObj.nameLength = 1;
+			childObj.name[0] = (uint8)glyphLayout.codepoint;
+			childObj.name[1] = '\0';
+
+			AnimationManager::addAnimObject(am, childObj);
+			// TODO: Ugly what do I do???
+			SceneHierarchyPanel::addNewAnimObject(childObj);
+
+			newGlyphs.push_back({ childObj.id, glyphLayout.position, glyphLayout.textIndex, glyphLayout.codepoint });
+		}
+
+		// Anything left over belongs to characters that were removed
+		for (const auto& [codepoint, childIds] : unusedChildren)
+		{
+			for (size_t i = nextUnusedChild[codepoint]; i < childIds.size(); i++)
+			{
+				AnimObject* child = AnimationManager::getMutableObject(am, childIds[i]);
+				if (child)
+				{
+					SceneHierarchyPanel::deleteAnimObject(*child);
+					AnimationManager::removeAnimObject(am, childIds[i]);
+				}
+			}
+		}
+
+		(*glyphRun)->glyphs = std::move(newGlyphs);
+	}
+
+	static void removeGeneratedChildren(AnimationManagerData* am, AnimObject* obj)
+	{
+		// NOTE: This is direct descendants, no recursive children here
+		for (int i = 0; i < obj->generatedChildrenIds.size(); i++)
+		{
+			AnimObject* child = AnimationManager::getMutableObject(am, obj->generatedChildrenIds[i]);
+			if (child)
+			{
+				SceneHierarchyPanel::deleteAnimObject(*child);
+				AnimationManager::removeAnimObject(am, obj->generatedChildrenIds[i]);
+			}
+		}
+		obj->generatedChildrenIds.clear();
+	}
+
+	static void freeGlyphRun(GlyphRun** glyphRun)
+	{
+		if (*glyphRun)
+		{
+			g_memory_delete(*glyphRun);
+			*glyphRun = nullptr;
+		}
+	}
+
+	static void onLaTexFinished(const std::string& latex, bool succeeded, void*)
+	{
+		finishedLaTex.push_back({ latex, succeeded });
+	}
+}
@@ -6,6 +6,33 @@
 
 namespace MathAnim
 {
+	// Each buffer holds this much audio, seeking only has to refill numStreamBuffers of these
+	static constexpr uint32 streamBufferMs = 100;
+	static constexpr int numStreamBuffers = 4;
+	// How often the feeder looks for buffers that finished playing. Has to be well under
+	// streamBufferMs so the source never runs dry.
+	static constexpr auto feederInterval = std::chrono::milliseconds(20);
+
+	struct AudioStream
+	{
+		WavData wav;
+		uint32 format;
+		uint32 sourceId;
+		uint32 buffers[numStreamBuffers];
+		size_t chunkSize;
+		// Byte offset into the wav data of the next chunk to queue
+		size_t cursor;
+		// Only used for wavs OpenAL can't play as is
+		std::vector<int16> convertedChunk;
+
+		// Guards everything above once the feeder is running
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::thread feeder;
+		bool isPlaying;
+		bool shouldStop;
+	};
+
 	// TODO: Come up with an error handling macro or something for 
 	// OpenAL calls
 	namespace Audio
@@ -19,6 +46,11 @@ namespace MathAnim
 
 		// -------------- Internal Functions --------------
 		static void displayError(uint32 error);
+		static bool needsConversion(const WavData& wav);
+		static uint32 getStreamFormat(const WavData& wav);
+		static bool queueNextChunk(AudioStream* stream, uint32 bufferId);
+		static void unqueueAllBuffers(AudioStream* stream);
+		static void feedStream(AudioStream* stream);
 
 		void init()
 		{
@@ -207,12 +239,69 @@ namespace MathAnim
 			return res;
 		}
 
+		AudioSource openWavStream(const WavData& wav)
+		{
+			AudioSource res = defaultAudioSource();
+			uint32 format = getStreamFormat(wav);
+			if (wav.audioData == nullptr || format == AL_INVALID_ENUM)
+			{
+				g_logger_error("Unable to stream WAV file with format {} channels and {} bits/sample.", wav.audioChannelType, wav.bitsPerSample);
+				return res;
+			}
+
+			alGenSources(1, &res.sourceId);
+			if ((error = alGetError()) != AL_NO_ERROR)
+			{
+				displayError(error);
+				res.sourceId = UINT32_MAX;
+				return res;
+			}
+
+			// OpenAL errors stick around until they get checked, so one check covers all of these
+			alSourcef(res.sourceId, AL_PITCH, 1.0f);
+			alSourcef(res.sourceId, AL_GAIN, 1.0f);
+			alSource3f(res.sourceId, AL_POSITION, 0.0f, 0.0f, 0.0f);
+			alSource3f(res.sourceId, AL_VELOCITY, 0.0f, 0.0f, 0.0f);
+			alSourcei(res.sourceId, AL_LOOPING, AL_FALSE);
+			if ((error = alGetError()) != AL_NO_ERROR)
+			{
+				displayError(error);
+				alDeleteSources(1, &res.sourceId);
+				res.sourceId = UINT32_MAX;
+				return res;
+			}
+
+			AudioStream* stream = g_memory_new AudioStream();
+			alGenBuffers(numStreamBuffers, stream->buffers);
+			if ((error = alGetError()) != AL_NO_ERROR)
+			{
+				displayError(error);
+				g_memory_delete(stream);
+				alDeleteSources(1, &res.sourceId);
+				res.sourceId = UINT32_MAX;
+				return res;
+			}
+
+			stream->wav = wav;
+			stream->format = format;
+			stream->sourceId = res.sourceId;
+			uint32 framesPerChunk = glm::max(wav.sampleRate * streamBufferMs / 1000, (uint32)1);
+			stream->chunkSize = (size_t)framesPerChunk * wav.blockAlignment;
+			stream->cursor = 0;
+			stream->isPlaying = false;
+			stream->shouldStop = false;
+			stream->feeder = std::thread(feedStream, stream);
+
+			res.stream = stream;
+			return res;
+		}
+
 		AudioSource defaultAudioSource()
 		{
 			AudioSource res;
 			res.bufferId = UINT32_MAX;
 			res.sourceId = UINT32_MAX;
-			res.isPlaying = false;
+			res.stream = nullptr;
 			return res;
 		}
 
@@ -224,19 +313,66 @@ namespace MathAnim
 		void play(AudioSource& source, float offsetInSeconds)
 		{
 			g_logger_assert(source.sourceId != UINT32_MAX, "Tried to play null audio source.");
+			if (source.stream)
+			{
+				AudioStream* stream = source.stream;
+				std::lock_guard<std::mutex> lock(stream->mtx);
+				unqueueAllBuffers(stream);
+
+				// Every frame is the same size, so seeking is just picking a new spot to read from
+				uint64 frame = (uint64)(glm::max((double)offsetInSeconds, 0.0) * (double)stream->wav.sampleRate);
+				stream->cursor = (size_t)glm::min(frame * stream->wav.blockAlignment, (uint64)stream->wav.dataSize);
+				for (uint32 buffer : stream->buffers)
+				{
+					if (!queueNextChunk(stream, buffer))
+					{
+						break;
+					}
+				}
+
+				alSourcePlay(stream->sourceId);
+				stream->isPlaying = true;
+				return;
+			}
+
 			if (offsetInSeconds != 0.0f)
 			{
 				alSourcef(source.sourceId, AL_SEC_OFFSET, offsetInSeconds);
 			}
 			alSourcePlay(source.sourceId);
-			source.isPlaying = true;
 		}
 
 		void stop(AudioSource& source)
 		{
 			g_logger_assert(source.sourceId != UINT32_MAX, "Tried to stop null audio source.");
-			alSourceStop(source.sourceId);
-			source.isPlaying = false;
+			if (source.stream)
+			{
+				std::lock_guard<std::mutex> lock(source.stream->mtx);
+				unqueueAllBuffers(source.stream);
+				source.stream->isPlaying = false;
+			}
+			else
+			{
+				alSourceStop(source.sourceId);
+			}
+		}
+
+		bool isPlaying(const AudioSource& source)
+		{
+			if (source.stream)
+			{
+				std::lock_guard<std::mutex> lock(source.stream->mtx);
+				return source.stream->isPlaying;
+			}
+
+			if (source.sourceId == UINT32_MAX)
+			{
+				return false;
+			}
+
+			ALint state = AL_STOPPED;
+			alGetSourcei(source.sourceId, AL_SOURCE_STATE, &state);
+			return state == AL_PLAYING;
 		}
 
 		void free()
@@ -262,6 +398,27 @@ namespace MathAnim
 
 		void free(AudioSource& source)
 		{
+			if (source.stream)
+			{
+				AudioStream* stream = source.stream;
+				{
+					std::lock_guard<std::mutex> lock(stream->mtx);
+					stream->shouldStop = true;
+				}
+				stream->cv.notify_one();
+				stream->feeder.join();
+
+				unqueueAllBuffers(stream);
+				alDeleteBuffers(numStreamBuffers, stream->buffers);
+				if ((error = alGetError()) != AL_NO_ERROR)
+				{
+					displayError(error);
+				}
+
+				g_memory_delete(stream);
+				source.stream = nullptr;
+			}
+
 			if (source.sourceId != UINT32_MAX)
 			{
 				alDeleteSources(1, &source.sourceId);
@@ -281,8 +438,6 @@ namespace MathAnim
 				}
 				source.bufferId = UINT32_MAX;
 			}
-
-			source.isPlaying = false;
 		}
 
 		// -------------- Internal Functions --------------
@@ -312,5 +467,128 @@ namespace MathAnim
 				}
 			}
 		}
+
+		static bool needsConversion(const WavData& wav)
+		{
+			uint16 numChannels = wav.audioChannelType == AudioChannelType::Dual ? 2 : 1;
+			bool isTightlyPacked = wav.blockAlignment == numChannels * WavLoader::getBytesPerSample(wav.sampleFormat);
+			return !isTightlyPacked || (wav.sampleFormat != WavSampleFormat::UInt8 && wav.sampleFormat != WavSampleFormat::Int16);
+		}
+
+		static uint32 getStreamFormat(const WavData& wav)
+		{
+			if (wav.sampleFormat == WavSampleFormat::None || wav.sampleFormat == WavSampleFormat::Length)
+			{
+				return AL_INVALID_ENUM;
+			}
+
+			// Anything that isn't 8 or 16 bit PCM gets converted to 16 bit as it's streamed
+			bool is8Bit = wav.sampleFormat == WavSampleFormat::UInt8 && !needsConversion(wav);
+			switch (wav.audioChannelType)
+			{
+			case AudioChannelType::Mono:
+				return is8Bit ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+			case AudioChannelType::Dual:
+				return is8Bit ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
+			case AudioChannelType::Length:
+			case AudioChannelType::None:
+				break;
+			}
+
+			return AL_INVALID_ENUM;
+		}
+
+		static bool queueNextChunk(AudioStream* stream, uint32 bufferId)
+		{
+			WavData const& wav = stream->wav;
+			size_t numBytes = glm::min(stream->chunkSize, (size_t)wav.dataSize - stream->cursor);
+			if (numBytes == 0)
+			{
+				return false;
+			}
+
+			uint8 const* chunk = wav.audioData + stream->cursor;
+			stream->cursor += numBytes;
+
+			void const* data = chunk;
+			size_t dataSize = numBytes;
+			if (needsConversion(wav))
+			{
+				uint16 numChannels = wav.audioChannelType == AudioChannelType::Dual ? 2 : 1;
+				uint16 bytesPerSample = WavLoader::getBytesPerSample(wav.sampleFormat);
+				size_t numFrames = numBytes / wav.blockAlignment;
+				stream->convertedChunk.resize(numFrames * numChannels);
+				for (size_t frame = 0; frame < numFrames; frame++)
+				{
+					for (uint16 channel = 0; channel < numChannels; channel++)
+					{
+						stream->convertedChunk[frame * numChannels + channel] = WavLoader::readSample(
+							chunk + frame * wav.blockAlignment + channel * bytesPerSample,
+							wav.sampleFormat
+						);
+					}
+				}
+
+				data = stream->convertedChunk.data();
+				dataSize = stream->convertedChunk.size() * sizeof(int16);
+			}
+
+			alBufferData(bufferId, stream->format, data, (ALsizei)dataSize, (ALsizei)wav.sampleRate);
+			alSourceQueueBuffers(stream->sourceId, 1, &bufferId);
+			ALenum queueError = alGetError();
+			if (queueError != AL_NO_ERROR)
+			{
+				displayError(queueError);
+				return false;
+			}
+
+			return true;
+		}
+
+		static void unqueueAllBuffers(AudioStream* stream)
+		{
+			// Stopping marks every queued buffer as processed, and a stopped source
+			// can drop its whole queue at once
+			alSourceStop(stream->sourceId);
+			alSourcei(stream->sourceId, AL_BUFFER, 0);
+		}
+
+		static void feedStream(AudioStream* stream)
+		{
+			std::unique_lock<std::mutex> lock(stream->mtx);
+			while (!stream->shouldStop)
+			{
+				stream->cv.wait_for(lock, feederInterval);
+				if (stream->shouldStop || !stream->isPlaying)
+				{
+					continue;
+				}
+
+				// Refill whatever finished playing with the next chunks of the file
+				ALint numProcessed = 0;
+				alGetSourcei(stream->sourceId, AL_BUFFERS_PROCESSED, &numProcessed);
+				for (ALint i = 0; i < numProcessed; i++)
+				{
+					ALuint buffer = 0;
+					alSourceUnqueueBuffers(stream->sourceId, 1, &buffer);
+					queueNextChunk(stream, buffer);
+				}
+
+				ALint numQueued = 0;
+				ALint state = AL_STOPPED;
+				alGetSourcei(stream->sourceId, AL_BUFFERS_QUEUED, &numQueued);
+				alGetSourcei(stream->sourceId, AL_SOURCE_STATE, &state);
+				if (numQueued == 0)
+				{
+					// Played the whole file
+					stream->isPlaying = false;
+				}
+				else if (state != AL_PLAYING)
+				{
+					// The feeder fell behind and the source ran dry, pick back up where it left off
+					alSourcePlay(stream->sourceId);
+				}
+			}
+		}
 	}
 }
\ No newline at end of file
@@ -1,95 +1,203 @@
 #include "audio/WavLoader.h"
+#include "platform/Platform.h"
 
 namespace MathAnim
 {
-	struct WavDataHeader
-	{
-		uint32 size;
-		uint16 wavTypeFormat;
-		uint16 audioChannelType;
-		uint32 sampleRate;
-		uint32 bytesPerSec;
-		uint16 blockAlignment;
-		uint16 bitsPerSample;
-		uint8 magicData[4];
-		uint32 dataSize;
-	};
-
-	struct WavFileHeader
-	{
-		uint8 magicRiff[4];
-		uint32 size;
-		uint8 magicWave[4];
-		uint8 magicFmt[4];
-		WavDataHeader dataHeader;
-	};
+	static constexpr uint16 WAVE_FORMAT_PCM = 0x0001;
+	static constexpr uint16 WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+	static constexpr uint16 WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+	// RIFF header plus the id and size of every chunk
+	static constexpr size_t riffHeaderSize = 12;
+	static constexpr size_t chunkHeaderSize = 8;
+	// Extensible formats store the real format tag at the start of the subformat GUID
+	static constexpr size_t extensibleSubFormatOffset = 24;
 
 	namespace WavLoader
 	{
+		// ---- Internal Functions ----
+		static inline uint16 readU16(uint8 const* data);
+		static inline uint32 readU32(uint8 const* data);
+		static inline bool chunkIdEquals(uint8 const* chunkId, const char* expected);
+		static WavSampleFormat getSampleFormat(uint16 formatTag, uint16 bitsPerSample);
+
 		WavData loadWavFile(const char* filename)
 		{
-			FILE* fp = fopen(filename, "rb");
-			if (!fp)
+			MemMappedFile* file = Platform::openMemMappedFile(filename);
+			if (!file)
+			{
+				return {};
+			}
+
+			WavData res = {};
+			if (!parse(file->data, file->dataSize, res))
 			{
+				g_logger_error("Failed to load wav file '{}'.", filename);
+				Platform::freeMemMappedFile(file);
 				return {};
 			}
 
-			WavFileHeader header;
-			fread((void*)&header, sizeof(WavFileHeader), 1, fp);
-			g_logger_assert(
-				header.magicRiff[0] == 'R' &&
-				header.magicRiff[1] == 'I' &&
-				header.magicRiff[2] == 'F' &&
-				header.magicRiff[3] == 'F', "Invalid header. Did not get 'RIFF' magic number. Instead got '{}'", header.magicRiff);
-			g_logger_assert(
-				header.magicWave[0] == 'W' &&
-				header.magicWave[1] == 'A' &&
-				header.magicWave[2] == 'V' &&
-				header.magicWave[3] == 'E', "Invalid header. Did not get 'WAVE' magic number. Instead got '{}'", header.magicWave);
-			g_logger_assert(
-				header.magicFmt[0] == 'f' &&
-				header.magicFmt[1] == 'm' &&
-				header.magicFmt[2] == 't' &&
-				header.magicFmt[3] == ' ', "Invalid header. Did not get 'fmt ' magic number. Instead got '{}'", header.magicFmt);
-			g_logger_assert(
-				header.dataHeader.magicData[0] == 'd' &&
-				header.dataHeader.magicData[1] == 'a' &&
-				header.dataHeader.magicData[2] == 't' &&
-				header.dataHeader.magicData[3] == 'a', "Invalid header. Did not get 'data' magic number. Instead got '{}'", header.dataHeader.magicData);
-
-
-			WavData res;
-			res.audioChannelType = header.dataHeader.audioChannelType == 2
+			res.file = file;
+			return res;
+		}
+
+		bool parse(uint8 const* fileData, size_t fileSize, WavData& outWav)
+		{
+			outWav = {};
+
+			if (fileSize < riffHeaderSize || !chunkIdEquals(fileData, "RIFF") || !chunkIdEquals(fileData + 8, "WAVE"))
+			{
+				g_logger_error("Invalid wav header. Did not find the 'RIFF' and 'WAVE' magic numbers.");
+				return false;
+			}
+
+			bool foundFormat = false;
+			uint16 formatTag = 0;
+			uint16 numChannels = 0;
+			size_t cursor = riffHeaderSize;
+			while (cursor + chunkHeaderSize <= fileSize)
+			{
+				uint8 const* chunkId = fileData + cursor;
+				size_t chunkSize = readU32(fileData + cursor + 4);
+				uint8 const* chunk = fileData + cursor + chunkHeaderSize;
+				size_t bytesLeft = fileSize - cursor - chunkHeaderSize;
+
+				if (chunkIdEquals(chunkId, "fmt "))
+				{
+					if (chunkSize < 16 || chunkSize > bytesLeft)
+					{
+						g_logger_error("Invalid wav file. The 'fmt ' chunk is '{}' bytes.", chunkSize);
+						return false;
+					}
+
+					formatTag = readU16(chunk);
+					numChannels = readU16(chunk + 2);
+					outWav.sampleRate = readU32(chunk + 4);
+					outWav.bytesPerSec = readU32(chunk + 8);
+					outWav.blockAlignment = readU16(chunk + 12);
+					outWav.bitsPerSample = readU16(chunk + 14);
+
+					if (formatTag == WAVE_FORMAT_EXTENSIBLE)
+					{
+						if (chunkSize < extensibleSubFormatOffset + 16)
+						{
+							g_logger_error("Invalid wav file. The extensible 'fmt ' chunk is missing its subformat.");
+							return false;
+						}
+
+						formatTag = readU16(chunk + extensibleSubFormatOffset);
+					}
+
+					foundFormat = true;
+				}
+				else if (chunkIdEquals(chunkId, "data"))
+				{
+					if (!foundFormat)
+					{
+						g_logger_error("Invalid wav file. Found the 'data' chunk before the 'fmt ' chunk.");
+						return false;
+					}
+
+					// Files that got cut off, or were written by something streaming, often have a
+					// data size that runs past the end of the file. Play whatever is actually there.
+					size_t dataSize = glm::min(chunkSize, bytesLeft);
+					outWav.audioData = chunk;
+					outWav.dataSize = (uint32)glm::min(dataSize, (size_t)UINT32_MAX);
+					break;
+				}
+
+				// Chunks are padded to an even number of bytes
+				cursor += chunkHeaderSize + chunkSize + (chunkSize & 1);
+			}
+
+			if (outWav.audioData == nullptr)
+			{
+				g_logger_error("Invalid wav file. Did not find a 'data' chunk.");
+				outWav = {};
+				return false;
+			}
+
+			outWav.audioChannelType = numChannels == 2
 				? AudioChannelType::Dual
-				: header.dataHeader.audioChannelType == 1
+				: numChannels == 1
 				? AudioChannelType::Mono
 				: AudioChannelType::None;
-			res.bitsPerSample = header.dataHeader.bitsPerSample;
-			res.blockAlignment = header.dataHeader.blockAlignment;
-			res.bytesPerSec = header.dataHeader.bytesPerSec;
-			res.dataSize = header.dataHeader.dataSize;
-			res.sampleRate = header.dataHeader.sampleRate;
+			if (outWav.audioChannelType == AudioChannelType::None)
+			{
+				g_logger_error("Unsupported wav file with '{}' channels. Only mono and stereo audio is supported.", numChannels);
+				outWav = {};
+				return false;
+			}
 
-			uint8* audioData = (uint8*)g_memory_allocate(sizeof(uint8) * header.dataHeader.dataSize);
-			size_t amtRead = fread(audioData, sizeof(uint8) * header.dataHeader.dataSize, 1, fp);
-			g_logger_assert(amtRead == 1, "Failed to read all the audio data.");
-			fclose(fp);
-			res.audioData = audioData;
+			outWav.sampleFormat = getSampleFormat(formatTag, outWav.bitsPerSample);
+			if (outWav.sampleFormat == WavSampleFormat::None)
+			{
+				g_logger_error("Unsupported wav format '{}' with '{}' bits per sample.", formatTag, outWav.bitsPerSample);
+				outWav = {};
+				return false;
+			}
+
+			uint16 frameSize = (uint16)(numChannels * (outWav.bitsPerSample / 8));
+			if (outWav.blockAlignment < frameSize || outWav.sampleRate == 0)
+			{
+				g_logger_error("Invalid wav file. Block alignment is '{}' bytes for '{}' byte frames at '{}'Hz.", outWav.blockAlignment, frameSize, outWav.sampleRate);
+				outWav = {};
+				return false;
+			}
 
-			g_logger_assert(res.audioChannelType != AudioChannelType::None, "Unknown audio channel format '{}'. Should be 1 or 2 for mono or dual audio channels.", header.dataHeader.audioChannelType);
+			// Don't leave a partial frame at the end of a truncated file
+			outWav.dataSize -= outWav.dataSize % outWav.blockAlignment;
 
-			return res;
+			return true;
 		}
 
 		void free(WavData& wav)
 		{
-			if (wav.audioData)
+			if (wav.file)
 			{
-				g_memory_free(wav.audioData);
-				wav.audioData = nullptr;
+				Platform::freeMemMappedFile(wav.file);
 			}
 			g_memory_zeroMem(&wav, sizeof(WavData));
 		}
+
+		// ---- Internal Functions ----
+		static inline uint16 readU16(uint8 const* data)
+		{
+			uint16 res;
+			g_memory_copyMem(&res, sizeof(uint16), (void*)data, sizeof(uint16));
+			return res;
+		}
+
+		static inline uint32 readU32(uint8 const* data)
+		{
+			uint32 res;
+			g_memory_copyMem(&res, sizeof(uint32), (void*)data, sizeof(uint32));
+			return res;
+		}
+
+		static inline bool chunkIdEquals(uint8 const* chunkId, const char* expected)
+		{
+			return std::memcmp(chunkId, expected, 4) == 0;
+		}
+
+		static WavSampleFormat getSampleFormat(uint16 formatTag, uint16 bitsPerSample)
+		{
+			if (formatTag == WAVE_FORMAT_PCM)
+			{
+				switch (bitsPerSample)
+				{
+				case 8: return WavSampleFormat::UInt8;
+				case 16: return WavSampleFormat::Int16;
+				case 24: return WavSampleFormat::Int24;
+				}
+			}
+			else if (formatTag == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 32)
+			{
+				return WavSampleFormat::Float32;
+			}
+
+			return WavSampleFormat::None;
+		}
 	}
 }
 
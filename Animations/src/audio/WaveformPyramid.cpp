@@ -0,0 +1,140 @@
+#include "audio/WaveformPyramid.h"
+#include "audio/WavLoader.h"
+#include "core/Profiling.h"
+
+namespace MathAnim
+{
+	namespace Waveform
+	{
+		// ---- Internal Functions ----
+		static WaveformLevel buildFromSamples(uint8 const* pcm, uint64 numSamples, WavSampleFormat sampleFormat, uint16 blockAlignment, uint16 numChannels);
+		static WaveformLevel buildFromLevel(WaveformLevel const& finer);
+
+		WaveformPyramid build(uint8 const* pcm, size_t numBytes, WavSampleFormat sampleFormat, uint16 blockAlignment, uint16 numChannels, uint32 sampleRate)
+		{
+			MP_PROFILE_EVENT("Waveform_Build");
+
+			WaveformPyramid res = {};
+			res.sampleRate = sampleRate;
+			res.numSamples = 0;
+
+			uint16 bytesPerSample = WavLoader::getBytesPerSample(sampleFormat);
+			if (pcm == nullptr || bytesPerSample == 0 || numChannels == 0 || blockAlignment < bytesPerSample * numChannels)
+			{
+				return res;
+			}
+
+			res.numSamples = numBytes / blockAlignment;
+			res.levels.reserve(numLevels);
+			res.levels.emplace_back(buildFromSamples(pcm, res.numSamples, sampleFormat, blockAlignment, numChannels));
+			for (int i = 1; i < numLevels; i++)
+			{
+				res.levels.emplace_back(buildFromLevel(res.levels.back()));
+			}
+
+			return res;
+		}
+
+		WaveformPyramid build(WavData const& wav)
+		{
+			uint16 numChannels = wav.audioChannelType == AudioChannelType::Dual ? 2 : 1;
+			return build(wav.audioData, wav.dataSize, wav.sampleFormat, wav.blockAlignment, numChannels, wav.sampleRate);
+		}
+
+		WaveformLevel const* chooseLevel(WaveformPyramid const& pyramid, double samplesPerPixel)
+		{
+			if (pyramid.levels.size() == 0)
+			{
+				return nullptr;
+			}
+
+			for (auto level = pyramid.levels.rbegin(); level != pyramid.levels.rend(); level++)
+			{
+				if ((double)level->samplesPerBucket <= samplesPerPixel)
+				{
+					return &(*level);
+				}
+			}
+
+			// Zoomed in past the finest level, pixels just end up sharing buckets
+			return &pyramid.levels[0];
+		}
+
+		WaveformBucket getRange(WaveformLevel const& level, uint64 firstSample, uint64 lastSample)
+		{
+			uint64 firstBucket = firstSample / level.samplesPerBucket;
+			uint64 lastBucket = (lastSample + level.samplesPerBucket - 1) / level.samplesPerBucket;
+			lastBucket = glm::min(glm::max(lastBucket, firstBucket + 1), (uint64)level.buckets.size());
+			if (firstBucket >= lastBucket)
+			{
+				return { 0, 0 };
+			}
+
+			WaveformBucket res = level.buckets[firstBucket];
+			for (uint64 i = firstBucket + 1; i < lastBucket; i++)
+			{
+				res.min = glm::min(res.min, level.buckets[i].min);
+				res.max = glm::max(res.max, level.buckets[i].max);
+			}
+
+			return res;
+		}
+
+		// ---- Internal Functions ----
+		static WaveformLevel buildFromSamples(uint8 const* pcm, uint64 numSamples, WavSampleFormat sampleFormat, uint16 blockAlignment, uint16 numChannels)
+		{
+			uint16 bytesPerSample = WavLoader::getBytesPerSample(sampleFormat);
+
+			WaveformLevel res = {};
+			res.samplesPerBucket = finestSamplesPerBucket;
+			res.buckets.resize((size_t)((numSamples + finestSamplesPerBucket - 1) / finestSamplesPerBucket));
+
+			uint8 const* frame = pcm;
+			for (size_t bucketIndex = 0; bucketIndex < res.buckets.size(); bucketIndex++)
+			{
+				uint64 bucketEnd = glm::min((uint64)(bucketIndex + 1) * finestSamplesPerBucket, numSamples);
+				uint64 bucketSize = bucketEnd - (uint64)bucketIndex * finestSamplesPerBucket;
+
+				int16 minSample = INT16_MAX;
+				int16 maxSample = INT16_MIN;
+				for (uint64 i = 0; i < bucketSize; i++, frame += blockAlignment)
+				{
+					for (uint16 channel = 0; channel < numChannels; channel++)
+					{
+						int16 sample = WavLoader::readSample(frame + channel * bytesPerSample, sampleFormat);
+						minSample = glm::min(minSample, sample);
+						maxSample = glm::max(maxSample, sample);
+					}
+				}
+
+				res.buckets[bucketIndex] = { minSample, maxSample };
+			}
+
+			return res;
+		}
+
+		static WaveformLevel buildFromLevel(WaveformLevel const& finer)
+		{
+			WaveformLevel res = {};
+			res.samplesPerBucket = finer.samplesPerBucket * branchFactor;
+			res.buckets.resize((finer.buckets.size() + branchFactor - 1) / branchFactor);
+
+			for (size_t bucketIndex = 0; bucketIndex < res.buckets.size(); bucketIndex++)
+			{
+				size_t first = bucketIndex * branchFactor;
+				size_t last = glm::min(first + branchFactor, finer.buckets.size());
+
+				WaveformBucket bucket = finer.buckets[first];
+				for (size_t i = first + 1; i < last; i++)
+				{
+					bucket.min = glm::min(bucket.min, finer.buckets[i].min);
+					bucket.max = glm::max(bucket.max, finer.buckets[i].max);
+				}
+
+				res.buckets[bucketIndex] = bucket;
+			}
+
+			return res;
+		}
+	}
+}
@@ -15,6 +15,8 @@
 #include "renderer/Fonts.h"
 #include "renderer/Colors.h"
 #include "renderer/GLApi.h"
+#include "renderer/PixelBufferDownloader.h"
+#include "renderer/SoftwareRenderer.h"
 #include "animation/TextAnimations.h"
 #include "animation/Animation.h"
 #include "animation/AnimationManager.h"
@@ -39,6 +41,7 @@
 #include "multithreading/GlobalThreadPool.h"
 #include "video/Encoder.h"
 #include "utils/TableOfContents.h"
+#include "core/BinaryScene.h"
 #include "scripting/LuauLayer.h"
 #include "platform/Platform.h"
 
@@ -77,6 +80,7 @@ namespace MathAnim
 		static bool saveCurrentSceneOnReload = true;
 		static int sceneToChangeTo = -1;
 		static SvgCache* svgCache = nullptr;
+		static bool usingSoftwareRenderer = false;
 		static float deltaTime = 0.0f;
 
 		static const char* winTitle = "Math Animations";
@@ -84,10 +88,19 @@ namespace MathAnim
 		// ------- Internal Functions -------
 		static nlohmann::json serializeCameras();
 		static void deserializeCameras(const nlohmann::json& cameraData, uint32 version);
+		static nlohmann::json serializeSceneJson();
+		static void loadSceneJson(const std::string& filepath);
+		static void loadSceneBinary(const std::string& filepath);
 		static std::string sceneToFilename(const std::string& stringName, const char* ext);
 		static void reloadCurrentSceneInternal();
 		static void initializeSceneSystems();
 		static void freeSceneSystems();
+		static void initOniguruma();
+		static void initProjectDirectories(const char* projectFile);
+		static void waitForSceneToSettle(bool useSoftwareRenderer);
+		static void renderSceneToMainFramebuffer(int frame);
+		static void renderSceneToSoftwareFramebuffer(int frame, SoftwareFramebuffer& framebuffer);
+		static int exportSceneHeadless(const HeadlessRenderSettings& settings);
 
 		[[deprecated("This is for upgrading legacy projects created in beta")]]
 		static void legacy_loadScene(const std::string& sceneName);
@@ -115,11 +128,7 @@ namespace MathAnim
 			// Initialize OpenGL functions
 			GlVersion glVersion = GladLayer::init();
 
-			// Initialize Oniguruma
-			OnigEncoding use_encs[1];
-			use_encs[0] = ONIG_ENCODING_ASCII;
-			onig_initialize(use_encs, sizeof(use_encs) / sizeof(use_encs[0]));
-			onig_set_warn_func([](const char* s) { g_logger_warning("Onig Warning: {}", s); });
+			initOniguruma();
 
 			Fonts::init();
 			Renderer::init();
@@ -136,17 +145,13 @@ namespace MathAnim
 			mainFramebuffer = Renderer::prepareFramebuffer(outputWidth, outputHeight);
 			editorFramebuffer = Renderer::prepareFramebuffer(outputWidth, outputHeight);
 
-			currentProjectRoot = std::filesystem::path(projectFile).parent_path();
-			currentProjectTmpDir = currentProjectRoot / "tmp";
-			Platform::createDirIfNotExists(currentProjectTmpDir.string().c_str());
-			currentProjectSceneDir = currentProjectRoot / "scenes";
-			Platform::createDirIfNotExists(currentProjectSceneDir.string().c_str());
+			initProjectDirectories(projectFile);
 
 			initializeSceneSystems();
 			loadProject(currentProjectRoot);
 
 			EditorGui::init(am, currentProjectRoot, outputWidth, outputHeight);
-			LuauLayer::init(currentProjectRoot / "scripts", am);
+			LuauLayer::init(currentProjectRoot / "scripts", currentProjectRoot / "cache" / "scripts", am);
 
 			svgCache = new SvgCache();
 			svgCache->init();
@@ -225,6 +230,7 @@ namespace MathAnim
 				EditorCameraController::update(deltaTime, editorCamera);
 				LaTexLayer::update();
 				LuauLayer::update();
+				UndoSystem::iterate(undoSystem);
 
 				// Update camera matrices
 				// NOTE: The editor camera matrices are updated in EditorCameraController::update
@@ -239,6 +245,8 @@ namespace MathAnim
 						Renderer::pushCamera2D(&AnimationManager::getActiveCamera(am));
 						Renderer::pushCamera3D(&AnimationManager::getActiveCamera(am));
 						AnimationManager::render(am, deltaFrame);
+						// The scene is already at the new frame, don't apply the delta twice
+						deltaFrame = 0;
 						Renderer::popCamera3D();
 						Renderer::popCamera2D();
 
@@ -320,6 +328,7 @@ namespace MathAnim
 				AnimationManager::endFrame(am);
 				EditorCameraController::endFrame(editorCamera);
 				Renderer::endFrame();
+				Fonts::endFrame();
 
 				// Miscellaneous
 				globalThreadPool->processFinishedTasks();
@@ -432,6 +441,115 @@ namespace MathAnim
 			Platform::free();
 		}
 
+		int renderHeadless(const char* projectFile, const HeadlessRenderSettings& settings)
+		{
+			if (!Platform::fileExists(projectFile))
+			{
+				g_logger_error("Cannot render project '{}', the file does not exist.", projectFile);
+				return 1;
+			}
+
+			outputWidth = settings.outputWidth;
+			outputHeight = settings.outputHeight;
+			usingSoftwareRenderer = settings.useSoftwareRenderer;
+
+			// This mirrors Application::init, minus the editor, ImGui and audio
+			editorCamera = EditorCameraController::init(Camera::createDefault());
+			globalThreadPool = new GlobalThreadPool(std::thread::hardware_concurrency());
+
+			// The OpenGL renderer still needs a context to render into, but the window is never shown.
+			// The software renderer has to run on machines without a GPU or display, so it skips all of it.
+			if (!usingSoftwareRenderer)
+			{
+				GladLayer::initGlfw();
+				window = new Window(outputWidth, outputHeight, winTitle, WindowFlags::Hidden);
+				window->setVSync(false);
+				GladLayer::init();
+			}
+
+			initOniguruma();
+			Fonts::init();
+			if (!usingSoftwareRenderer)
+			{
+				Renderer::init();
+			}
+			Svg::init();
+			SvgParser::init();
+			Highlighters::init();
+			LaTexLayer::init();
+			SoftwareRenderer::init();
+
+			if (!usingSoftwareRenderer)
+			{
+				mainFramebuffer = Renderer::prepareFramebuffer(outputWidth, outputHeight);
+			}
+
+			initProjectDirectories(projectFile);
+			initializeSceneSystems();
+			loadProject(currentProjectRoot);
+
+			if (!usingSoftwareRenderer)
+			{
+				svgCache = new SvgCache();
+				svgCache->init();
+				svgCache->clearAll();
+
+				GL::enable(GL_BLEND);
+				GL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			}
+
+			auto begin = std::chrono::high_resolution_clock::now();
+			int exitCode = exportSceneHeadless(settings);
+			auto end = std::chrono::high_resolution_clock::now();
+			if (exitCode == 0 && !settings.benchmarkOnly)
+			{
+				g_logger_info("Rendered '{}' in {}ms", settings.outputFile, std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+			}
+
+			// NOTE: Unlike Application::free, we never save the project here. Batch renders should
+			//       leave the project files untouched.
+			if (svgCache)
+			{
+				svgCache->free();
+				delete svgCache;
+				svgCache = nullptr;
+			}
+
+			std::filesystem::remove_all(currentProjectTmpDir);
+
+			if (!usingSoftwareRenderer)
+			{
+				mainFramebuffer.destroy();
+			}
+			EditorCameraController::free(editorCamera);
+
+			onig_end();
+			Highlighters::free();
+			LaTexLayer::free();
+			SoftwareRenderer::free();
+			// Loading a scene hands its timeline to the editor, so free it here since the editor never ran
+			EditorGui::setTimelineData(Timeline::initInstance());
+			freeSceneSystems();
+			Fonts::unloadAllFonts();
+			if (!usingSoftwareRenderer)
+			{
+				Renderer::free();
+				Window::cleanup();
+			}
+
+			globalThreadPool->free();
+			delete globalThreadPool;
+
+			if (!usingSoftwareRenderer)
+			{
+				GladLayer::deinit();
+			}
+			Platform::free();
+			usingSoftwareRenderer = false;
+
+			return exitCode;
+		}
+
 		void saveProject()
 		{
 			nlohmann::json projectJson = {};
@@ -452,31 +570,34 @@ namespace MathAnim
 
 		void saveCurrentScene()
 		{
-			// Write data to json files
-			nlohmann::json sceneJson = nlohmann::json();
+			MP_PROFILE_EVENT("Application_SaveCurrentScene");
 
-			// This data should always be present regardless of file version
-			// Container data layout
-			sceneJson["Version"]["Major"] = SERIALIZER_VERSION_MAJOR;
-			sceneJson["Version"]["Minor"] = SERIALIZER_VERSION_MINOR;
-			sceneJson["Version"]["Full"] = std::to_string(SERIALIZER_VERSION_MAJOR) + "." + std::to_string(SERIALIZER_VERSION_MINOR);
+			BinarySceneWriter writer = {};
+			AnimationManager::serializeBinary(am, writer);
 
-			AnimationManager::serialize(am, sceneJson["AnimationManager"]);
-			Timeline::serialize(EditorGui::getTimelineData(), sceneJson["TimelineData"]);
-			sceneJson["EditorCameras"] = serializeCameras();
-			SceneHierarchyPanel::serialize(sceneJson["SceneHierarchy"]);
+			nlohmann::json editorState = nlohmann::json();
+			Timeline::serialize(EditorGui::getTimelineData(), editorState["TimelineData"]);
+			editorState["EditorCameras"] = serializeCameras();
+			SceneHierarchyPanel::serialize(editorState["SceneHierarchy"]);
+			writer.setEditorState(editorState);
+
+			std::filesystem::path filepath = currentProjectSceneDir / sceneToFilename(sceneData.sceneNames[sceneData.currentScene], ".mscene");
+			writer.writeToFile(filepath, SERIALIZER_VERSION_MAJOR, SERIALIZER_VERSION_MINOR);
+		}
 
+		void exportCurrentSceneAsJson()
+		{
 			try
 			{
-				// TODO: bson should be faster, but it does increase size a bit. Consider switching to
-				// bson files and adding options to export projects as formatted JSON for debugging
 				std::string jsonFilepath = (currentProjectSceneDir / sceneToFilename(sceneData.sceneNames[sceneData.currentScene], ".json")).string();
 				std::ofstream jsonFile(jsonFilepath);
-				jsonFile << sceneJson << std::endl;
+				// Indented so exported scenes diff nicely
+				jsonFile << serializeSceneJson().dump(2) << std::endl;
+				g_logger_info("Exported scene to '{}'.", jsonFilepath);
 			}
 			catch (const std::exception& ex)
 			{
-				g_logger_error("Failed to save current scene with error: '{}'", ex.what());
+				g_logger_error("Failed to export current scene with error: '{}'", ex.what());
 			}
 		}
 
@@ -563,10 +684,26 @@ namespace MathAnim
 
 		void loadScene(const std::string& sceneName)
 		{
-			std::string filepath = (currentProjectSceneDir / sceneToFilename(sceneName, ".json")).string();
+			std::filesystem::path binaryFilepath = currentProjectSceneDir / sceneToFilename(sceneName, ".mscene");
+			std::filesystem::path jsonFilepath = currentProjectSceneDir / sceneToFilename(sceneName, ".json");
+			bool binaryExists = Platform::fileExists(binaryFilepath.string().c_str());
+			bool jsonExists = Platform::fileExists(jsonFilepath.string().c_str());
+
+			// JSON scenes that are newer than the binary one were exported and then edited
+			// by hand (or merged), so import those instead
+			std::error_code err;
+			if (binaryExists && (!jsonExists ||
+				std::filesystem::last_write_time(binaryFilepath, err) >= std::filesystem::last_write_time(jsonFilepath, err)))
+			{
+				g_logger_log("Loading scene: {}", binaryFilepath.string());
+				loadSceneBinary(binaryFilepath.string());
+				return;
+			}
+
+			std::string filepath = jsonFilepath.string();
 			g_logger_log("Loading scene: {}", filepath);
 
-			if (!Platform::fileExists(filepath.c_str()))
+			if (!jsonExists)
 			{
 				// Check if a legacy project exists and try to load that, if loading fails
 				// then load an empty project
@@ -590,6 +727,11 @@ namespace MathAnim
 				return;
 			}
 
+			loadSceneJson(filepath);
+		}
+
+		static void loadSceneJson(const std::string& filepath)
+		{
 			try
 			{
 				std::ifstream inputFile(filepath);
@@ -636,6 +778,55 @@ namespace MathAnim
 			}
 		}
 
+		static void loadSceneBinary(const std::string& filepath)
+		{
+			MP_PROFILE_EVENT("Application_LoadSceneBinary");
+
+			BinarySceneReader reader = {};
+			if (!reader.open(filepath.c_str()))
+			{
+				g_logger_error("Failed to open scene '{}'.", filepath);
+				resetToFrame(0);
+				return;
+			}
+
+			try
+			{
+				nlohmann::json editorState = reader.getEditorState();
+
+				int loadedProjectCurrentFrame = 0;
+				if (editorState.contains("TimelineData") && !editorState["TimelineData"].is_null())
+				{
+					TimelineData timeline = Timeline::deserialize(editorState["TimelineData"]);
+					EditorGui::setTimelineData(timeline);
+					loadedProjectCurrentFrame = timeline.currentFrame;
+				}
+
+				if (!AnimationManager::deserializeBinary(am, reader, loadedProjectCurrentFrame))
+				{
+					g_logger_error("Scene '{}' is partially corrupted, some objects or animations could not be loaded.", filepath);
+				}
+				// Flush any pending objects to be created for real
+				AnimationManager::endFrame(am);
+
+				if (editorState.contains("EditorCameras"))
+				{
+					deserializeCameras(editorState["EditorCameras"], reader.getVersionMajor());
+				}
+
+				if (editorState.contains("SceneHierarchy") && !editorState["SceneHierarchy"].is_null())
+				{
+					SceneHierarchyPanel::deserialize(editorState["SceneHierarchy"]);
+				}
+			}
+			catch (const std::exception& ex)
+			{
+				g_logger_error("Failed to load scene '{}' with error: '{}'", filepath, ex.what());
+			}
+
+			reader.close();
+		}
+
 		static void legacy_loadScene(const std::string& sceneName)
 		{
 			std::string filepath = (currentProjectRoot / sceneToFilename(sceneName, ".bin")).string();
@@ -710,8 +901,10 @@ namespace MathAnim
 				}
 			}
 
-			std::string filepath = (currentProjectSceneDir / sceneToFilename(sceneName, ".json")).string();
+			std::string filepath = (currentProjectSceneDir / sceneToFilename(sceneName, ".mscene")).string();
 			remove(filepath.c_str());
+			std::string jsonFilepath = (currentProjectSceneDir / sceneToFilename(sceneName, ".json")).string();
+			remove(jsonFilepath.c_str());
 		}
 
 		void changeSceneTo(const std::string& sceneName, bool saveCurrentScene)
@@ -816,6 +1009,11 @@ namespace MathAnim
 			return svgCache;
 		}
 
+		bool isUsingSoftwareRenderer()
+		{
+			return usingSoftwareRenderer;
+		}
+
 		UndoSystemData* getUndoSystem()
 		{
 			return undoSystem;
@@ -826,6 +1024,24 @@ namespace MathAnim
 			return globalThreadPool;
 		}
 
+		static nlohmann::json serializeSceneJson()
+		{
+			nlohmann::json sceneJson = nlohmann::json();
+
+			// This data should always be present regardless of file version
+			// Container data layout
+			sceneJson["Version"]["Major"] = SERIALIZER_VERSION_MAJOR;
+			sceneJson["Version"]["Minor"] = SERIALIZER_VERSION_MINOR;
+			sceneJson["Version"]["Full"] = std::to_string(SERIALIZER_VERSION_MAJOR) + "." + std::to_string(SERIALIZER_VERSION_MINOR);
+
+			AnimationManager::serialize(am, sceneJson["AnimationManager"]);
+			Timeline::serialize(EditorGui::getTimelineData(), sceneJson["TimelineData"]);
+			sceneJson["EditorCameras"] = serializeCameras();
+			SceneHierarchyPanel::serialize(sceneJson["SceneHierarchy"]);
+
+			return sceneJson;
+		}
+
 		static nlohmann::json serializeCameras()
 		{
 			nlohmann::json cameraData = nlohmann::json();
@@ -919,5 +1135,281 @@ namespace MathAnim
 			undoSystem = UndoSystem::init(am, MAX_UNDO_HISTORY);
 			EditorSettings::init();
 		}
+
+		static void initOniguruma()
+		{
+			OnigEncoding use_encs[1];
+			use_encs[0] = ONIG_ENCODING_ASCII;
+			onig_initialize(use_encs, sizeof(use_encs) / sizeof(use_encs[0]));
+			onig_set_warn_func([](const char* s) { g_logger_warning("Onig Warning: {}", s); });
+		}
+
+		static void initProjectDirectories(const char* projectFile)
+		{
+			currentProjectRoot = std::filesystem::path(projectFile).parent_path();
+			currentProjectTmpDir = currentProjectRoot / "tmp";
+			Platform::createDirIfNotExists(currentProjectTmpDir.string().c_str());
+			currentProjectSceneDir = currentProjectRoot / "scenes";
+			Platform::createDirIfNotExists(currentProjectSceneDir.string().c_str());
+		}
+
+		static void waitForSceneToSettle(bool useSoftwareRenderer)
+		{
+			// Objects like LaTeX regenerate their children once their svgs finish
+			// compiling. In the editor that just shows up a few frames late, but
+			// every exported frame has to be complete so wait for them here.
+			bool hasPendingTasks = true;
+			while (hasPendingTasks)
+			{
+				hasPendingTasks = LaTexLayer::hasPendingTasks();
+
+				LaTexLayer::update();
+				globalThreadPool->processFinishedTasks();
+				if (useSoftwareRenderer)
+				{
+					AnimationManager::update(am, 0);
+					AnimationManager::endFrame(am);
+				}
+				else
+				{
+					AnimationManager::render(am, 0);
+					Renderer::clearDrawCalls();
+					AnimationManager::endFrame(am);
+					Renderer::endFrame();
+				}
+
+				if (hasPendingTasks)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				}
+			}
+		}
+
+		static void renderSceneToMainFramebuffer(int frame)
+		{
+			MP_PROFILE_EVENT("Headless_RenderToMainFramebuffer");
+
+			resetToFrame(frame);
+			AnimationManager::resetToFrame(am, (uint32)frame);
+			AnimationManager::calculateCameraMatrices(am);
+
+			Renderer::pushCamera2D(&AnimationManager::getActiveCamera(am));
+			Renderer::pushCamera3D(&AnimationManager::getActiveCamera(am));
+			AnimationManager::render(am, 0);
+			Renderer::popCamera3D();
+			Renderer::popCamera2D();
+
+			Renderer::bindAndUpdateViewportForFramebuffer(mainFramebuffer);
+			Renderer::renderToFramebuffer(mainFramebuffer, am, "Headless_Main_Framebuffer_Pass");
+			Renderer::clearDrawCalls();
+		}
+
+		static void renderSceneToSoftwareFramebuffer(int frame, SoftwareFramebuffer& framebuffer)
+		{
+			MP_PROFILE_EVENT("Headless_RenderToSoftwareFramebuffer");
+
+			resetToFrame(frame);
+			AnimationManager::resetToFrame(am, (uint32)frame);
+			AnimationManager::calculateCameraMatrices(am);
+
+			// NOTE: There's no OpenGL renderer to queue draw calls into, this only updates cameras,
+			//       images and LaTeX objects
+			AnimationManager::update(am, 0);
+
+			SoftwareRenderer::renderToFramebuffer(framebuffer, am, AnimationManager::getActiveCamera(am), globalThreadPool);
+		}
+
+		static int exportSceneHeadless(const HeadlessRenderSettings& settings)
+		{
+			if (!AnimationManager::hasActiveCamera(am))
+			{
+				g_logger_error("Scene '{}' has no active camera, there is nothing to render.", sceneData.sceneNames[sceneData.currentScene]);
+				return 1;
+			}
+
+			int firstFrame = glm::max(settings.firstFrame, 0);
+			int lastFrame = settings.lastFrame < 0
+				? AnimationManager::lastAnimatedFrame(am)
+				: settings.lastFrame;
+			if (lastFrame < firstFrame)
+			{
+				g_logger_error("Invalid frame range [{}, {}].", firstFrame, lastFrame);
+				return 1;
+			}
+
+			// The timeline always runs at 60 frames per second, the output framerate
+			// only changes how often we sample it
+			double timelineFramesPerOutputFrame = 60.0 / (double)settings.framerate;
+			int numOutputFrames = (int)((double)(lastFrame - firstFrame) / timelineFramesPerOutputFrame) + 1;
+
+			// Benchmarks only measure how fast frames are rendered, nothing gets encoded
+			VideoEncoder* encoder = nullptr;
+			if (!settings.benchmarkOnly)
+			{
+				encoder = VideoEncoder::startEncodingFile(
+					settings.outputFile.c_str(),
+					outputWidth,
+					outputHeight,
+					settings.framerate,
+					numOutputFrames,
+					VideoEncoderFlags::LogProgress,
+					settings.crf
+				);
+				if (!encoder)
+				{
+					g_logger_error("Failed to start encoding '{}'.", settings.outputFile);
+					return 2;
+				}
+			}
+
+			EditorSettings::setFidelity(PreviewSvgFidelity::Ultra);
+			AnimationManager::retargetSvgScales(am);
+			waitForSceneToSettle(settings.useSoftwareRenderer);
+
+			// GPU resources
+			Framebuffer yFramebuffer = {};
+			Framebuffer uvFramebuffer = {};
+			PixelBufferDownload pboDownloader = PixelBufferDownload();
+
+			// CPU resources. When encoding, frames are converted straight into the encoder's frame ring
+			SoftwareFramebuffer softwareFramebuffer = {};
+			size_t yuvPixelsSize = (size_t)(outputWidth * outputHeight) + 2 * (size_t)((outputWidth / 2) * (outputHeight / 2));
+			uint8* yuvPixels = nullptr;
+
+			if (settings.useSoftwareRenderer)
+			{
+				softwareFramebuffer = SoftwareRenderer::createFramebuffer(outputWidth, outputHeight);
+				if (!encoder)
+				{
+					yuvPixels = (uint8*)g_memory_allocate(yuvPixelsSize);
+				}
+			}
+			else
+			{
+				Texture yTextureSpec = TextureBuilder()
+					.setWidth(outputWidth)
+					.setHeight(outputHeight)
+					.setFormat(ByteFormat::R8_UI)
+					.setMagFilter(FilterMode::Linear)
+					.setMinFilter(FilterMode::Linear)
+					.build();
+				yFramebuffer = FramebufferBuilder(outputWidth, outputHeight)
+					.addColorAttachment(yTextureSpec)
+					.generate();
+				Texture uvTextureSpec = yTextureSpec;
+				uvTextureSpec.width /= 2;
+				uvTextureSpec.height /= 2;
+				uvFramebuffer = FramebufferBuilder(outputWidth / 2, outputHeight / 2)
+					.addColorAttachment(uvTextureSpec)
+					.addColorAttachment(uvTextureSpec)
+					.generate();
+
+				pboDownloader.create(outputWidth, outputHeight);
+			}
+
+			float minFrameMs = FLT_MAX;
+			float maxFrameMs = 0.0f;
+			float totalFrameMs = 0.0f;
+			for (int outputFrame = 0; outputFrame < numOutputFrames; outputFrame++)
+			{
+				MP_PROFILE_FRAME("HeadlessRenderLoop");
+
+				auto frameBegin = std::chrono::high_resolution_clock::now();
+				int frame = firstFrame + (int)((double)outputFrame * timelineFramesPerOutputFrame);
+				if (settings.useSoftwareRenderer)
+				{
+					renderSceneToSoftwareFramebuffer(frame, softwareFramebuffer);
+					if (encoder)
+					{
+						SoftwareRenderer::convertToYuv420(softwareFramebuffer, encoder->acquireYuvFrame(), encoder->getFrameSize());
+						encoder->submitYuvFrame();
+					}
+					else
+					{
+						SoftwareRenderer::convertToYuv420(softwareFramebuffer, yuvPixels, yuvPixelsSize);
+					}
+				}
+				else
+				{
+					renderSceneToMainFramebuffer(frame);
+
+					GL::pushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "RGB_To_YUV_Pass");
+					Renderer::renderTextureToYuvFramebuffer(mainFramebuffer.getColorAttachment(0), yFramebuffer, uvFramebuffer);
+					GL::popDebugGroup();
+
+					// The downloads are asynchronous, so the pixels we get back are from a few frames ago
+					pboDownloader.queueDownloadFrom(yFramebuffer, uvFramebuffer);
+					if (pboDownloader.pixelsAreReady)
+					{
+						const Pixels& gpuYuvPixels = pboDownloader.getPixels();
+						if (encoder)
+						{
+							encoder->pushYuvFrame(gpuYuvPixels.yColorBuffer, gpuYuvPixels.dataSize);
+						}
+					}
+				}
+				auto frameEnd = std::chrono::high_resolution_clock::now();
+
+				float frameMs = std::chrono::duration<float, std::milli>(frameEnd - frameBegin).count();
+				minFrameMs = glm::min(minFrameMs, frameMs);
+				maxFrameMs = glm::max(maxFrameMs, frameMs);
+				totalFrameMs += frameMs;
+
+				AnimationManager::endFrame(am);
+				if (!settings.useSoftwareRenderer)
+				{
+					Renderer::endFrame();
+				}
+				globalThreadPool->processFinishedTasks();
+			}
+
+			if (settings.useSoftwareRenderer)
+			{
+				if (yuvPixels)
+				{
+					g_memory_free(yuvPixels);
+				}
+				SoftwareRenderer::destroyFramebuffer(softwareFramebuffer);
+			}
+			else
+			{
+				// Flush any frames that are still being downloaded
+				while (pboDownloader.numItemsInQueue > 0)
+				{
+					const Pixels& gpuYuvPixels = pboDownloader.getPixels();
+					if (encoder)
+					{
+						encoder->pushYuvFrame(gpuYuvPixels.yColorBuffer, gpuYuvPixels.dataSize);
+					}
+				}
+
+				pboDownloader.free();
+				yFramebuffer.destroy();
+				uvFramebuffer.destroy();
+			}
+
+			float avgFrameMs = totalFrameMs / (float)numOutputFrames;
+			g_logger_info("{} renderer: {} frames at {}x{}. Avg {}ms, min {}ms, max {}ms per frame ({} frames per second).",
+				settings.useSoftwareRenderer ? "Software" : "OpenGL",
+				numOutputFrames,
+				outputWidth,
+				outputHeight,
+				avgFrameMs,
+				minFrameMs,
+				maxFrameMs,
+				avgFrameMs > 0.0f ? 1000.0f / avgFrameMs : 0.0f
+			);
+
+			if (encoder)
+			{
+				// Block until the file is completely written. VideoEncoder::freeEncoder would finish
+				// in the background, but there's nothing else to keep alive while we wait.
+				VideoEncoder::finalizeEncodingFile(encoder);
+				encoder->destroy();
+				g_memory_delete(encoder);
+			}
+
+			return 0;
+		}
 	}
 }
\ No newline at end of file
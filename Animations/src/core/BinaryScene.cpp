@@ -0,0 +1,355 @@
+#include "core/BinaryScene.h"
+#include "core/Profiling.h"
+#include "platform/Platform.h"
+
+#include <nlohmann/json.hpp>
+
+namespace MathAnim
+{
+	static constexpr size_t sectionAlignment = 8;
+
+	// ------------------ Writer ------------------
+	uint32 BinarySceneWriter::addString(const char* str, size_t length)
+	{
+		std::string key = std::string(str, length);
+		auto iter = stringIndices.find(key);
+		if (iter != stringIndices.end())
+		{
+			return iter->second;
+		}
+
+		uint32 index = getNumElements(BinarySceneSection::StringTable);
+		stringIndices[key] = index;
+		stringOffsets.push_back((uint32)sections[(size_t)BinarySceneSection::StringTable].size());
+
+		constexpr char nullTerminator = '\0';
+		append(BinarySceneSection::StringTable, str, length, 1);
+		append(BinarySceneSection::StringTable, &nullTerminator, sizeof(char), 0);
+		return index;
+	}
+
+	BinaryBlobRef BinarySceneWriter::addBlob(const uint8* data, size_t size)
+	{
+		BinaryBlobRef res = { sections[(size_t)BinarySceneSection::Blobs].size(), size };
+		append(BinarySceneSection::Blobs, data, size, 0);
+		return res;
+	}
+
+	BinaryBlobRef BinarySceneWriter::addCbor(const nlohmann::json& j)
+	{
+		if (j.is_null())
+		{
+			return BinaryBlobRef{ 0, 0 };
+		}
+
+		std::vector<uint8> cbor = nlohmann::json::to_cbor(j);
+		return addBlob(cbor.data(), cbor.size());
+	}
+
+	void BinarySceneWriter::setEditorState(const nlohmann::json& j)
+	{
+		std::vector<uint8>& section = sections[(size_t)BinarySceneSection::EditorState];
+		section = nlohmann::json::to_cbor(j);
+		numElements[(size_t)BinarySceneSection::EditorState] = 1;
+	}
+
+	bool BinarySceneWriter::writeToFile(const std::filesystem::path& filepath, uint32 serializerVersionMajor, uint32 serializerVersionMinor)
+	{
+		MP_PROFILE_EVENT("BinarySceneWriter_WriteToFile");
+
+		std::vector<uint8> fileData = {};
+		writeToMemory(fileData, serializerVersionMajor, serializerVersionMinor);
+
+		// Write to a temporary file first so a failed save never clobbers the last good one
+		std::filesystem::path tmpFilepath = filepath;
+		tmpFilepath += ".tmp";
+		FILE* fp = fopen(tmpFilepath.string().c_str(), "wb");
+		if (!fp)
+		{
+			g_logger_error("Failed to open '{}' for writing: '{}'", tmpFilepath.string(), strerror(errno));
+			return false;
+		}
+
+		bool succeeded = fwrite(fileData.data(), fileData.size(), 1, fp) == 1;
+		succeeded = fclose(fp) == 0 && succeeded;
+
+		if (!succeeded)
+		{
+			g_logger_error("Failed to write binary scene '{}'.", filepath.string());
+			std::filesystem::remove(tmpFilepath);
+			return false;
+		}
+
+		std::error_code err;
+		std::filesystem::rename(tmpFilepath, filepath, err);
+		if (err)
+		{
+			g_logger_error("Failed to replace binary scene '{}': '{}'", filepath.string(), err.message());
+			return false;
+		}
+
+		return true;
+	}
+
+	void BinarySceneWriter::writeToMemory(std::vector<uint8>& outData, uint32 serializerVersionMajor, uint32 serializerVersionMinor)
+	{
+		MP_PROFILE_EVENT("BinarySceneWriter_WriteToMemory");
+
+		// The string table is prefixed with its offsets, plus one extra so the length of the
+		// last string can be calculated the same way as the rest
+		std::vector<uint8> stringTable = {};
+		{
+			const std::vector<uint8>& strings = sections[(size_t)BinarySceneSection::StringTable];
+			size_t offsetsSize = sizeof(uint32) * (stringOffsets.size() + 1);
+			stringTable.resize(offsetsSize + strings.size());
+			for (size_t i = 0; i < stringOffsets.size(); i++)
+			{
+				uint32 offset = (uint32)offsetsSize + stringOffsets[i];
+				g_memory_copyMem(stringTable.data() + sizeof(uint32) * i, sizeof(uint32), &offset, sizeof(uint32));
+			}
+			uint32 endOffset = (uint32)stringTable.size();
+			g_memory_copyMem(stringTable.data() + sizeof(uint32) * stringOffsets.size(), sizeof(uint32), &endOffset, sizeof(uint32));
+			if (strings.size() > 0)
+			{
+				g_memory_copyMem(stringTable.data() + offsetsSize, strings.size(), (void*)strings.data(), strings.size());
+			}
+		}
+
+		BinarySceneHeader header = {};
+		header.magicNumber = BINARY_SCENE_MAGIC_NUMBER;
+		header.formatVersion = BINARY_SCENE_FORMAT_VERSION;
+		header.serializerVersionMajor = serializerVersionMajor;
+		header.serializerVersionMinor = serializerVersionMinor;
+		header.numSections = (uint32)BinarySceneSection::Length;
+
+		BinarySceneSectionEntry entries[(size_t)BinarySceneSection::Length] = {};
+		uint64 cursor = sizeof(BinarySceneHeader) + sizeof(entries);
+		for (uint32 i = 0; i < (uint32)BinarySceneSection::Length; i++)
+		{
+			cursor = (cursor + sectionAlignment - 1) & ~(uint64)(sectionAlignment - 1);
+
+			const std::vector<uint8>& section = i == (uint32)BinarySceneSection::StringTable
+				? stringTable
+				: sections[i];
+			entries[i].type = i;
+			entries[i].numElements = numElements[i];
+			entries[i].offset = cursor;
+			entries[i].size = section.size();
+			cursor += section.size();
+		}
+
+		// Padding between sections stays zeroed
+		outData.assign((size_t)cursor, 0);
+		g_memory_copyMem(outData.data(), sizeof(BinarySceneHeader), &header, sizeof(BinarySceneHeader));
+		g_memory_copyMem(outData.data() + sizeof(BinarySceneHeader), sizeof(entries), entries, sizeof(entries));
+		for (uint32 i = 0; i < (uint32)BinarySceneSection::Length; i++)
+		{
+			const std::vector<uint8>& section = i == (uint32)BinarySceneSection::StringTable
+				? stringTable
+				: sections[i];
+			if (section.size() > 0)
+			{
+				g_memory_copyMem(outData.data() + entries[i].offset, section.size(), (void*)section.data(), section.size());
+			}
+		}
+	}
+
+	void BinarySceneWriter::append(BinarySceneSection section, const void* data, size_t size, uint32 numNewElements)
+	{
+		std::vector<uint8>& buffer = sections[(size_t)section];
+		const uint8* bytes = (const uint8*)data;
+		buffer.insert(buffer.end(), bytes, bytes + size);
+		numElements[(size_t)section] += numNewElements;
+	}
+
+	// ------------------ Reader ------------------
+	bool BinarySceneReader::open(const char* filepath)
+	{
+		MP_PROFILE_EVENT("BinarySceneReader_Open");
+		g_logger_assert(file == nullptr && data == nullptr, "Tried to open a BinarySceneReader twice.");
+
+		file = Platform::openMemMappedFile(filepath);
+		if (!file)
+		{
+			return false;
+		}
+
+		data = file->data;
+		dataSize = file->dataSize;
+		return validate(filepath);
+	}
+
+	bool BinarySceneReader::openMemory(const uint8* inData, size_t inDataSize)
+	{
+		g_logger_assert(file == nullptr && data == nullptr, "Tried to open a BinarySceneReader twice.");
+		g_logger_assert(((uintptr_t)inData % sectionAlignment) == 0, "Binary scene data needs to be {} byte aligned.", sectionAlignment);
+
+		data = inData;
+		dataSize = inDataSize;
+		return validate("<memory>");
+	}
+
+	void BinarySceneReader::close()
+	{
+		if (file)
+		{
+			Platform::freeMemMappedFile(file);
+		}
+
+		file = nullptr;
+		data = nullptr;
+		dataSize = 0;
+		sectionEntries = nullptr;
+		header = {};
+	}
+
+	const uint64* BinarySceneReader::getIds(const BinaryIdRange& range) const
+	{
+		size_t numIds = 0;
+		const uint64* ids = getRecords<uint64>(BinarySceneSection::Ids, &numIds);
+		if (!ids || (uint64)range.first + range.count > numIds)
+		{
+			return nullptr;
+		}
+
+		return ids + range.first;
+	}
+
+	const char* BinarySceneReader::getString(uint32 index, size_t* outLength) const
+	{
+		const BinarySceneSectionEntry* entry = findSection(BinarySceneSection::StringTable);
+		if (!entry || index >= entry->numElements || sizeof(uint32) * ((uint64)index + 2) > entry->size)
+		{
+			return nullptr;
+		}
+
+		const uint8* table = getData() + entry->offset;
+		uint32 offsets[2];
+		g_memory_copyMem(offsets, sizeof(offsets), (void*)(table + sizeof(uint32) * index), sizeof(offsets));
+		if (offsets[0] >= offsets[1] || offsets[1] > entry->size || table[offsets[1] - 1] != '\0')
+		{
+			return nullptr;
+		}
+
+		if (outLength)
+		{
+			*outLength = offsets[1] - offsets[0] - 1;
+		}
+		return (const char*)(table + offsets[0]);
+	}
+
+	const uint8* BinarySceneReader::getBlob(const BinaryBlobRef& blob) const
+	{
+		const BinarySceneSectionEntry* entry = findSection(BinarySceneSection::Blobs);
+		if (!entry || blob.size == 0 || blob.offset > entry->size || blob.size > entry->size - blob.offset)
+		{
+			return nullptr;
+		}
+
+		return getData() + entry->offset + blob.offset;
+	}
+
+	nlohmann::json BinarySceneReader::decodeCbor(const BinaryBlobRef& blob) const
+	{
+		const uint8* blobBytes = getBlob(blob);
+		if (!blobBytes)
+		{
+			return nlohmann::json();
+		}
+
+		return nlohmann::json::from_cbor(blobBytes, blobBytes + blob.size, true, false);
+	}
+
+	nlohmann::json BinarySceneReader::getEditorState() const
+	{
+		const BinarySceneSectionEntry* entry = findSection(BinarySceneSection::EditorState);
+		if (!entry || entry->size == 0)
+		{
+			return nlohmann::json();
+		}
+
+		const uint8* sectionBytes = getData() + entry->offset;
+		nlohmann::json res = nlohmann::json::from_cbor(sectionBytes, sectionBytes + entry->size, true, false);
+		if (res.is_discarded())
+		{
+			g_logger_error("Binary scene editor state is corrupted, using the default editor state.");
+			return nlohmann::json();
+		}
+
+		return res;
+	}
+
+	// ------------------ Internal functions ------------------
+	bool BinarySceneReader::validate(const char* sourceName)
+	{
+		if (dataSize < sizeof(BinarySceneHeader))
+		{
+			g_logger_error("Binary scene '{}' is too small to be valid.", sourceName);
+			close();
+			return false;
+		}
+
+		g_memory_copyMem(&header, sizeof(BinarySceneHeader), (void*)data, sizeof(BinarySceneHeader));
+		if (header.magicNumber != BINARY_SCENE_MAGIC_NUMBER)
+		{
+			g_logger_error("'{}' is not a binary scene file.", sourceName);
+			close();
+			return false;
+		}
+
+		if (header.formatVersion != BINARY_SCENE_FORMAT_VERSION)
+		{
+			g_logger_error("Binary scene '{}' has unknown format version '{}'.", sourceName, header.formatVersion);
+			close();
+			return false;
+		}
+
+		uint64 sectionTableEnd = sizeof(BinarySceneHeader) + (uint64)header.numSections * sizeof(BinarySceneSectionEntry);
+		if (sectionTableEnd > dataSize)
+		{
+			g_logger_error("Binary scene '{}' has a corrupted section table.", sourceName);
+			close();
+			return false;
+		}
+
+		sectionEntries = (const BinarySceneSectionEntry*)(data + sizeof(BinarySceneHeader));
+		for (uint32 i = 0; i < header.numSections; i++)
+		{
+			const BinarySceneSectionEntry& entry = sectionEntries[i];
+			if (entry.offset % sectionAlignment != 0 ||
+				entry.offset < sectionTableEnd ||
+				entry.offset > dataSize ||
+				entry.size > dataSize - entry.offset)
+			{
+				g_logger_error("Binary scene '{}' has a corrupted section '{}'.", sourceName, entry.type);
+				close();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const BinarySceneSectionEntry* BinarySceneReader::findSection(BinarySceneSection section) const
+	{
+		if (!sectionEntries)
+		{
+			return nullptr;
+		}
+
+		for (uint32 i = 0; i < header.numSections; i++)
+		{
+			if (sectionEntries[i].type == (uint32)section)
+			{
+				return &sectionEntries[i];
+			}
+		}
+
+		return nullptr;
+	}
+
+	const uint8* BinarySceneReader::getData() const
+	{
+		return data;
+	}
+}
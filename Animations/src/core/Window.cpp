@@ -22,7 +22,7 @@ namespace MathAnim
 		// for us automatically
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 1);
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
-		glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+		glfwWindowHint(GLFW_VISIBLE, (flags & WindowFlags::Hidden) ? GLFW_FALSE : GLFW_TRUE);
 		glfwWindowHint(GLFW_SAMPLES, 4);
 
 		if (flags & WindowFlags::OpenMaximized)
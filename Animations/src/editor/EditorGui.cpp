@@ -14,13 +14,16 @@
 #include "editor/imgui/ImGuiExtended.h"
 #include "editor/Clipboard.h"
 #include "editor/Gizmos.h"
+#include "editor/ObjectPicker.h"
 #include "editor/EditorSettings.h"
 #include "editor/EditorLayout.h"
 #include "editor/UndoSystem.h"
 #include "animation/AnimationManager.h"
 #include "core/Application.h"
 #include "core/Input.h"
+#include "physics/Physics.h"
 #include "renderer/Colors.h"
+#include "renderer/Camera.h"
 #include "renderer/Texture.h"
 #include "renderer/Framebuffer.h"
 #include "core/Profiling.h"
@@ -44,6 +47,7 @@ namespace MathAnim
 		static void getLargestSizeForViewport(ImVec2* imageSize, ImVec2* offset);
 		static void checkHotKeys(AnimationManagerData* am);
 		static void checkForMousePicking(const AnimationManagerData* am, const Framebuffer& mainFramebuffer);
+		static Ray getMouseRay();
 
 		static void showActiveObjectSelctionCtxMenu(AnimationManagerData* am);
 
@@ -91,6 +95,7 @@ namespace MathAnim
 				.generateFromFile();
 
 			clipboard = Clipboard::create();
+			ObjectPicker::init();
 		}
 
 		void update(const Framebuffer& mainFramebuffer, const Framebuffer& editorFramebuffer, AnimationManagerData* am, float deltaTime)
@@ -222,6 +227,7 @@ namespace MathAnim
 			timelineLoaded = false;
 
 			Clipboard::free(clipboard);
+			ObjectPicker::free();
 		}
 
 		const TimelineData& getTimelineData()
@@ -562,30 +568,44 @@ namespace MathAnim
 
 		static void checkForMousePicking(const AnimationManagerData* am, const Framebuffer& mainFramebuffer)
 		{
+			// Picks come back a frame or two after they were queued, so the GPU never gets stalled
+			AnimObjId pickedObj;
+			while (ObjectPicker::pollResult(&pickedObj))
+			{
+				InspectorPanel::setActiveAnimObject(am, pickedObj);
+			}
+
 			if (mouseHoveringViewport && !GizmoManager::anyGizmoActive())
 			{
+				const Texture& pickingTexture = mainFramebuffer.getColorAttachment(3);
+				// Get the mouse pos in normalized coords
+				Vec2 normalizedMousePos = mouseToNormalizedViewport();
+				Vec2 mousePixelPos = Vec2{
+					normalizedMousePos.x * (float)pickingTexture.width,
+					normalizedMousePos.y * (float)pickingTexture.height
+				};
+
 				if (Input::mouseClicked(MouseButton::Left))
 				{
-					const Texture& pickingTexture = mainFramebuffer.getColorAttachment(3);
-					// Get the mouse pos in normalized coords
-					Vec2 normalizedMousePos = mouseToNormalizedViewport();
-					Vec2 mousePixelPos = Vec2{
-						normalizedMousePos.x * (float)pickingTexture.width,
-						normalizedMousePos.y * (float)pickingTexture.height
-					};
-					AnimObjId objId = mainFramebuffer.readPixelUint64(3, (int)mousePixelPos.x, (int)mousePixelPos.y);
-					if (objId != NULL_ANIM_OBJECT)
-					{
-						InspectorPanel::setActiveAnimObject(am, objId);
-					}
-					else
+					if (!ObjectPicker::queuePick(mainFramebuffer, 3, (int)mousePixelPos.x, (int)mousePixelPos.y))
 					{
-						InspectorPanel::setActiveAnimObject(am, NULL_ANIM_OBJECT);
+						// Every pixel buffer is still in flight, pick on the CPU instead of waiting for the GPU
+						ObjectPicker::rebuildBvh(am);
+						InspectorPanel::setActiveAnimObject(am, ObjectPicker::pickCpu(getMouseRay()));
 					}
 				}
 			}
 		}
 
+		static Ray getMouseRay()
+		{
+			Vec2 normalizedMousePos = mouseToNormalizedViewport();
+			const Camera* camera = Application::getEditorCamera();
+			Vec3 origin = camera->reverseProject(normalizedMousePos, camera->nearFarRange.min);
+			Vec3 end = camera->reverseProject(normalizedMousePos, camera->nearFarRange.max);
+			return Physics::createRay(origin, end);
+		}
+
 		static void getLargestSizeForViewport(ImVec2* imageSize, ImVec2* offset)
 		{
 			float targetAspectRatio = Application::getOutputTargetAspectRatio();
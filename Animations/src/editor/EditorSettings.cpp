@@ -1,6 +1,7 @@
 #include "editor/EditorSettings.h"
 #include "renderer/GLApi.h"
 #include "animation/AnimationManager.h"
+#include "scripting/LuauLayer.h"
 
 namespace MathAnim
 {
@@ -75,6 +76,15 @@ namespace MathAnim
 					ImGui::EndCombo();
 				}
 
+				if (LuauLayer::isNativeCodeGenSupported())
+				{
+					bool nativeScripts = LuauLayer::isNativeCodeGenEnabled();
+					if (ImGui::Checkbox(": Native Script Compilation", &nativeScripts))
+					{
+						LuauLayer::setNativeCodeGenEnabled(nativeScripts);
+					}
+				}
+
 				ImGui::End();
 			}
 		}
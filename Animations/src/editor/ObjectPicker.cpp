@@ -0,0 +1,226 @@
+#include "editor/ObjectPicker.h"
+#include "animation/Animation.h"
+#include "animation/AnimationManager.h"
+#include "physics/Physics.h"
+#include "physics/Bvh.h"
+#include "renderer/Framebuffer.h"
+#include "renderer/Texture.h"
+#include "renderer/GLApi.h"
+#include "svg/Svg.h"
+
+namespace MathAnim
+{
+	struct PickBuffer
+	{
+		uint32 pboId;
+		GLsync fence;
+		bool flushed;
+	};
+
+	namespace ObjectPicker
+	{
+		// ------------- Internal data -------------
+		// Enough to keep a pick in flight every frame while the GPU is a frame or two behind
+		static constexpr int numPickBuffers = 3;
+		static PickBuffer pickBuffers[numPickBuffers];
+		static int readIndex = 0;
+		static int numPicksInFlight = 0;
+
+		static Bvh bvh;
+		static std::vector<OBB> pickableBoxes;
+		static std::vector<AnimObjId> pickableObjects;
+		static std::vector<uint32> bvhHits;
+
+		void init()
+		{
+			readIndex = 0;
+			numPicksInFlight = 0;
+
+			uint32 pboIds[numPickBuffers];
+			GL::genBuffers(numPickBuffers, pboIds);
+			for (int i = 0; i < numPickBuffers; i++)
+			{
+				pickBuffers[i] = {};
+				pickBuffers[i].pboId = pboIds[i];
+				pickBuffers[i].fence = nullptr;
+
+				GL::bindBuffer(GL_PIXEL_PACK_BUFFER, pboIds[i]);
+				GL::bufferData(GL_PIXEL_PACK_BUFFER, sizeof(uint64), nullptr, GL_STREAM_READ);
+			}
+
+			// Unbind so nothing else accidentally reads pixels into these
+			GL::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+
+		void free()
+		{
+			for (int i = 0; i < numPickBuffers; i++)
+			{
+				if (pickBuffers[i].fence)
+				{
+					GL::deleteSync(pickBuffers[i].fence);
+				}
+				GL::deleteBuffers(1, &pickBuffers[i].pboId);
+				pickBuffers[i] = {};
+			}
+
+			readIndex = 0;
+			numPicksInFlight = 0;
+
+			bvh.clear();
+			pickableBoxes.clear();
+			pickableObjects.clear();
+			bvhHits.clear();
+		}
+
+		bool queuePick(const Framebuffer& framebuffer, int colorAttachment, int x, int y)
+		{
+			if (numPicksInFlight >= numPickBuffers)
+			{
+				return false;
+			}
+
+			const Texture& texture = framebuffer.getColorAttachment(colorAttachment);
+			g_logger_assert(TextureUtil::byteFormatIsUint64(texture), "Cannot pick objects from a non-uint64 texture.");
+			if (x < 0 || y < 0 || x >= texture.width || y >= texture.height)
+			{
+				return false;
+			}
+
+			PickBuffer& pickBuffer = pickBuffers[(readIndex + numPicksInFlight) % numPickBuffers];
+			pickBuffer.flushed = false;
+
+			// NOTE: With a pixel pack buffer bound, readPixels queues a copy into the buffer and returns right away
+			framebuffer.bind();
+			GL::readBuffer(GL_COLOR_ATTACHMENT0 + colorAttachment);
+			GL::bindBuffer(GL_PIXEL_PACK_BUFFER, pickBuffer.pboId);
+			GL::readPixels(
+				x, y,
+				1, 1,
+				TextureUtil::toGlExternalFormat(texture.format),
+				TextureUtil::toGlDataType(texture.format),
+				0 // Offset into the pbo
+			);
+			pickBuffer.fence = GL::fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			GL::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			framebuffer.unbind();
+
+			numPicksInFlight++;
+			return true;
+		}
+
+		bool pollResult(AnimObjId* outObjId)
+		{
+			if (numPicksInFlight <= 0)
+			{
+				return false;
+			}
+
+			PickBuffer& pickBuffer = pickBuffers[readIndex];
+
+			// Zero timeout, this only checks whether the copy finished. Flush the first time so
+			// the fence is guaranteed to signal eventually.
+			GLbitfield waitFlags = pickBuffer.flushed ? 0 : GL_SYNC_FLUSH_COMMANDS_BIT;
+			pickBuffer.flushed = true;
+			GLenum waitResult = GL::clientWaitSync(pickBuffer.fence, waitFlags, 0);
+			if (waitResult == GL_TIMEOUT_EXPIRED)
+			{
+				return false;
+			}
+
+			AnimObjId objId = NULL_ANIM_OBJECT;
+			if (waitResult == GL_WAIT_FAILED)
+			{
+				g_logger_error("Failed to wait for object picking fence.");
+			}
+			else
+			{
+				GL::bindBuffer(GL_PIXEL_PACK_BUFFER, pickBuffer.pboId);
+				const uint64* pixel = (const uint64*)GL::mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(uint64), GL_MAP_READ_BIT);
+				if (pixel)
+				{
+					objId = *pixel;
+					GL::unmapBuffer(GL_PIXEL_PACK_BUFFER);
+				}
+				else
+				{
+					g_logger_error("Failed to map object picking pixel buffer.");
+				}
+				GL::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			}
+
+			GL::deleteSync(pickBuffer.fence);
+			pickBuffer.fence = nullptr;
+			readIndex = (readIndex + 1) % numPickBuffers;
+			numPicksInFlight--;
+
+			*outObjId = objId;
+			return true;
+		}
+
+		int getNumPicksInFlight()
+		{
+			return numPicksInFlight;
+		}
+
+		void rebuildBvh(const AnimationManagerData* am)
+		{
+			pickableBoxes.clear();
+			pickableObjects.clear();
+
+			std::vector<AABB> boxes = {};
+			for (const AnimObject& obj : AnimationManager::getAnimObjects(am))
+			{
+				// Same objects that end up in the object id attachment
+				if (obj.status == AnimObjectStatus::Inactive || obj.svgObject == nullptr)
+				{
+					continue;
+				}
+
+				OBB obb = {};
+				obb.bbox.min = obj.svgObject->size / -2.0f;
+				obb.bbox.max = obj.svgObject->size / 2.0f;
+				obb.transformation = obj.globalTransform;
+
+				pickableBoxes.push_back(obb);
+				pickableObjects.push_back(obj.id);
+				boxes.push_back(Physics::createAABB(obb));
+			}
+
+			bvh.build(boxes);
+		}
+
+		AnimObjId pickCpu(const Ray& ray)
+		{
+			bvhHits.clear();
+			bvh.raycast(ray, bvhHits);
+
+			// The BVH only tested the axis aligned bounds, check the actual boxes here
+			AnimObjId closestObject = NULL_ANIM_OBJECT;
+			uint32 closestIndex = 0;
+			float closestDistance = FLT_MAX;
+			for (uint32 index : bvhHits)
+			{
+				RaycastResult res = Physics::rayIntersectsOBB(ray, pickableBoxes[index]);
+				if (!res.hit())
+				{
+					continue;
+				}
+
+				float distance = res.hitEntry() ? res.hitEntryDistance : 0.0f;
+				// Objects later in the list get drawn on top of earlier ones at the same depth
+				bool isCloser = distance < closestDistance
+					|| (distance == closestDistance && index > closestIndex);
+				if (isCloser)
+				{
+					closestObject = pickableObjects[index];
+					closestIndex = index;
+					closestDistance = distance;
+				}
+			}
+
+			return closestObject;
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #include "editor/TextEditUndo.h"
 #include "editor/UndoSystem.h"
 #include "editor/panels/CodeEditorPanel.h"
+#include "utils/TextDocument.h"
 
 namespace MathAnim
 {
@@ -14,11 +15,11 @@ namespace MathAnim
 	class InsertTextCommand : public Command
 	{
 	public:
-		InsertTextCommand(uint8 const* inTextToInsert, size_t textToInsertSize, size_t insertOffset, size_t numberCharactersInserted)
-			: textToInsertSize(textToInsertSize), insertOffset(insertOffset), numberCharactersInserted(numberCharactersInserted)
+		InsertTextCommand(TextDocument const& document, size_t insertOffset, size_t textToInsertSize)
+			: textToInsertSize(textToInsertSize), insertOffset(insertOffset)
 		{
 			this->textToInsert = (uint8*)g_memory_allocate(textToInsertSize);
-			g_memory_copyMem(this->textToInsert, textToInsertSize, (void*)inTextToInsert, textToInsertSize);
+			document.copyText(insertOffset, textToInsertSize, this->textToInsert);
 		}
 
 		virtual void execute(void* ctx) override;
@@ -42,17 +43,16 @@ namespace MathAnim
 		uint8* textToInsert;
 		size_t textToInsertSize;
 		size_t insertOffset;
-		size_t numberCharactersInserted;
 	};
 
 	class BackspaceTextCommand : public Command
 	{
 	public:
-		BackspaceTextCommand(uint8 const* inTextToDelete, size_t textToBeDeletedSize, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected)
-			: textToBeDeletedSize(textToBeDeletedSize), selectionStart(selectionStart), selectionEnd(selectionEnd), cursorPosition(cursorPosition), shouldSetTextSelected(shouldSetTextSelected)
+		BackspaceTextCommand(TextDocument const& document, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected)
+			: textToBeDeletedSize(selectionEnd - selectionStart), selectionStart(selectionStart), selectionEnd(selectionEnd), cursorPosition(cursorPosition), shouldSetTextSelected(shouldSetTextSelected)
 		{
 			this->textToBeDeleted = (uint8*)g_memory_allocate(textToBeDeletedSize);
-			g_memory_copyMem(this->textToBeDeleted, textToBeDeletedSize, (void*)inTextToDelete, textToBeDeletedSize);
+			document.copyText(selectionStart, textToBeDeletedSize, this->textToBeDeleted);
 		}
 
 		virtual void execute(void* ctx) override;
@@ -85,11 +85,11 @@ namespace MathAnim
 	class DeleteTextCommand : public Command
 	{
 	public:
-		DeleteTextCommand(uint8 const* inTextToDelete, size_t textToBeDeletedSize, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected)
-			: textToBeDeletedSize(textToBeDeletedSize), selectionStart(selectionStart), selectionEnd(selectionEnd), cursorPosition(cursorPosition), shouldSetTextSelected(shouldSetTextSelected)
+		DeleteTextCommand(TextDocument const& document, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected)
+			: textToBeDeletedSize(selectionEnd - selectionStart), selectionStart(selectionStart), selectionEnd(selectionEnd), cursorPosition(cursorPosition), shouldSetTextSelected(shouldSetTextSelected)
 		{
 			this->textToBeDeleted = (uint8*)g_memory_allocate(textToBeDeletedSize);
-			g_memory_copyMem(this->textToBeDeleted, textToBeDeletedSize, (void*)inTextToDelete, textToBeDeletedSize);
+			document.copyText(selectionStart, textToBeDeletedSize, this->textToBeDeleted);
 		}
 
 		virtual void execute(void* ctx) override;
@@ -153,31 +153,31 @@ namespace MathAnim
 			UndoSystem::redo(us->genericSystem);
 		}
 
-		void insertTextAction(TextEditorUndoSystem* us, uint8 const* text, size_t textSize, size_t textOffset, size_t numberCharactersInserted)
+		void insertTextAction(TextEditorUndoSystem* us, TextDocument const& document, size_t insertOffset, size_t numBytesInserted)
 		{
-			auto* newCommand = g_memory_new InsertTextCommand(text, textSize, textOffset, numberCharactersInserted);
+			auto* newCommand = g_memory_new InsertTextCommand(document, insertOffset, numBytesInserted);
 			pushCommand(us->genericSystem, newCommand);
-			us->totalMemoryAllocated += textSize;
+			us->totalMemoryAllocated += numBytesInserted;
 		}
 
-		void deleteTextAction(TextEditorUndoSystem* us, uint8 const* textToBeDeleted, size_t textToBeDeletedLength, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected)
+		void deleteTextAction(TextEditorUndoSystem* us, TextDocument const& document, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected)
 		{
 			// TODO: Merge delete commands somehow
 			//       If two consecutive backspaces happen at the same position, they should be merged
 			//       However, if the backspace is at a different position, they should remain distinct
-			auto* newCommand = g_memory_new DeleteTextCommand(textToBeDeleted, textToBeDeletedLength, selectionStart, selectionEnd, cursorPosition, shouldSetTextSelected);
+			auto* newCommand = g_memory_new DeleteTextCommand(document, selectionStart, selectionEnd, cursorPosition, shouldSetTextSelected);
 			pushCommand(us->genericSystem, newCommand);
-			us->totalMemoryAllocated += textToBeDeletedLength;
+			us->totalMemoryAllocated += selectionEnd - selectionStart;
 		}
 
-		void backspaceTextAction(TextEditorUndoSystem* us, uint8 const* textToBeDeleted, size_t textToBeDeletedLength, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected)
+		void backspaceTextAction(TextEditorUndoSystem* us, TextDocument const& document, size_t selectionStart, size_t selectionEnd, size_t cursorPosition, bool shouldSetTextSelected)
 		{
 			// TODO: Merge backspace commands somehow
 			//       If two consecutive backspaces happen at the same position, they should be merged
 			//       However, if the backspace is at a different position, they should remain distinct
-			auto* newCommand = g_memory_new BackspaceTextCommand(textToBeDeleted, textToBeDeletedLength, selectionStart, selectionEnd, cursorPosition, shouldSetTextSelected);
+			auto* newCommand = g_memory_new BackspaceTextCommand(document, selectionStart, selectionEnd, cursorPosition, shouldSetTextSelected);
 			pushCommand(us->genericSystem, newCommand);
-			us->totalMemoryAllocated += textToBeDeletedLength;
+			us->totalMemoryAllocated += selectionEnd - selectionStart;
 		}
 
 		void imguiStats(TextEditorUndoSystem const* undoSystem)
@@ -236,7 +236,7 @@ namespace MathAnim
 	{
 		auto* us = (TextEditorUndoSystem*)ctx;
 
-		CodeEditorPanel::removeTextWithBackspace(*us->codeEditor, (int32)this->insertOffset, (int32)this->numberCharactersInserted);
+		CodeEditorPanel::removeTextWithBackspace(*us->codeEditor, (int32)this->insertOffset, (int32)this->textToInsertSize);
 	}
 
 	void BackspaceTextCommand::execute(void* ctx)
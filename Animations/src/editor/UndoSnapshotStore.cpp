@@ -0,0 +1,374 @@
+#include "editor/UndoSnapshotStore.h"
+#include "multithreading/GlobalThreadPool.h"
+#include "core/Profiling.h"
+#include "platform/Platform.h"
+
+#include <stb/stb_image.h>
+#include <map>
+
+// stb_image_write exports its zlib compressor, it just doesn't declare it in the header
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int dataLength, int* outLength, int quality);
+
+namespace MathAnim
+{
+	// Same level stb uses for PNGs, snapshots are mostly CBOR and SVG paths which compress well at this level
+	static constexpr int compressionQuality = 8;
+
+	// Shared with the compression task so the store can go away while it's still running
+	struct PendingCompression
+	{
+		std::vector<uint8> uncompressed;
+		std::vector<uint8> compressed;
+	};
+
+	struct UndoSnapshot
+	{
+		size_t uncompressedSize;
+		// Either the compressed bytes or the raw bytes if compressing didn't make them smaller.
+		// Empty while the snapshot is still compressing or once it's been spilled to disk.
+		std::vector<uint8> data;
+		bool isCompressed;
+
+		std::shared_ptr<PendingCompression> pending;
+		TaskHandle<void> compressTask;
+
+		std::filesystem::path spillFile;
+		size_t spilledSize;
+	};
+
+	struct UndoSnapshotStore
+	{
+		GlobalThreadPool* threadPool;
+		size_t memoryBudget;
+		std::filesystem::path spillDir;
+		uint32 storeIndex;
+
+		// Ordered by id, so the front is always the oldest snapshot
+		std::map<UndoSnapshotId, UndoSnapshot> snapshots;
+		UndoSnapshotId nextId;
+
+		size_t uncompressedBytes;
+		size_t memoryBytes;
+		size_t diskBytes;
+	};
+
+	static uint32 nextStoreIndex = 0;
+
+	namespace UndoSnapshots
+	{
+		// ---- Internal Functions ----
+		static std::vector<uint8> compress(std::vector<uint8> const& data);
+		static void finishCompression(UndoSnapshotStore* store, UndoSnapshot& snapshot);
+		static bool spill(UndoSnapshotStore* store, UndoSnapshotId id, UndoSnapshot& snapshot);
+		static bool readSpillFile(UndoSnapshot const& snapshot, std::vector<uint8>& outData);
+
+		UndoSnapshotStore* init(GlobalThreadPool* threadPool, size_t memoryBudget, std::filesystem::path const& spillDir)
+		{
+			UndoSnapshotStore* res = g_memory_new UndoSnapshotStore();
+			res->threadPool = threadPool;
+			res->memoryBudget = memoryBudget;
+			res->spillDir = spillDir;
+			res->storeIndex = nextStoreIndex++;
+			res->snapshots = {};
+			// 0 is NULL_UNDO_SNAPSHOT
+			res->nextId = 1;
+			res->uncompressedBytes = 0;
+			res->memoryBytes = 0;
+			res->diskBytes = 0;
+
+			return res;
+		}
+
+		void free(UndoSnapshotStore* store)
+		{
+			for (auto& [id, snapshot] : store->snapshots)
+			{
+				// A task that's already running only touches its PendingCompression, so it's fine to leave it
+				snapshot.compressTask.cancel();
+				if (!snapshot.spillFile.empty())
+				{
+					std::error_code err;
+					std::filesystem::remove(snapshot.spillFile, err);
+				}
+			}
+
+			g_memory_delete(store);
+		}
+
+		UndoSnapshotId add(UndoSnapshotStore* store, std::vector<uint8>&& data)
+		{
+			MP_PROFILE_EVENT("UndoSnapshots_Add");
+
+			UndoSnapshotId id = store->nextId++;
+			UndoSnapshot& snapshot = store->snapshots[id];
+			snapshot.uncompressedSize = data.size();
+			snapshot.isCompressed = false;
+			snapshot.spilledSize = 0;
+			snapshot.pending = std::make_shared<PendingCompression>();
+			snapshot.pending->uncompressed = std::move(data);
+
+			store->uncompressedBytes += snapshot.uncompressedSize;
+			store->memoryBytes += snapshot.uncompressedSize;
+
+			if (store->threadPool)
+			{
+				std::shared_ptr<PendingCompression> pending = snapshot.pending;
+				snapshot.compressTask = store->threadPool->submit(
+					[pending]() { pending->compressed = compress(pending->uncompressed); },
+					"CompressUndoSnapshot",
+					Priority::Low
+				);
+			}
+			else
+			{
+				snapshot.pending->compressed = compress(snapshot.pending->uncompressed);
+				finishCompression(store, snapshot);
+			}
+
+			update(store);
+
+			return id;
+		}
+
+		bool load(UndoSnapshotStore* store, UndoSnapshotId id, std::vector<uint8>& outData)
+		{
+			MP_PROFILE_EVENT("UndoSnapshots_Load");
+
+			auto iter = store->snapshots.find(id);
+			if (iter == store->snapshots.end())
+			{
+				return false;
+			}
+
+			UndoSnapshot& snapshot = iter->second;
+			if (snapshot.pending)
+			{
+				if (!snapshot.compressTask.isFinished())
+				{
+					// Don't wait on the compression, the raw bytes are still here
+					outData = snapshot.pending->uncompressed;
+					return true;
+				}
+
+				finishCompression(store, snapshot);
+			}
+
+			std::vector<uint8> spilledData = {};
+			std::vector<uint8> const* storedData = &snapshot.data;
+			if (!snapshot.spillFile.empty())
+			{
+				if (!readSpillFile(snapshot, spilledData))
+				{
+					return false;
+				}
+				storedData = &spilledData;
+			}
+
+			if (!snapshot.isCompressed)
+			{
+				outData = *storedData;
+				return true;
+			}
+
+			outData.resize(snapshot.uncompressedSize);
+			int numBytesDecoded = stbi_zlib_decode_buffer(
+				(char*)outData.data(),
+				(int)outData.size(),
+				(const char*)storedData->data(),
+				(int)storedData->size()
+			);
+			if (numBytesDecoded != (int)snapshot.uncompressedSize)
+			{
+				g_logger_error("Failed to decompress undo snapshot '{}'. Expected '{}' bytes, got '{}'.", id, snapshot.uncompressedSize, numBytesDecoded);
+				outData.clear();
+				return false;
+			}
+
+			return true;
+		}
+
+		void release(UndoSnapshotStore* store, UndoSnapshotId id)
+		{
+			auto iter = store->snapshots.find(id);
+			if (iter == store->snapshots.end())
+			{
+				return;
+			}
+
+			UndoSnapshot& snapshot = iter->second;
+			if (snapshot.pending)
+			{
+				snapshot.compressTask.cancel();
+				store->memoryBytes -= snapshot.uncompressedSize;
+			}
+			else
+			{
+				store->memoryBytes -= snapshot.data.size();
+			}
+
+			if (!snapshot.spillFile.empty())
+			{
+				std::error_code err;
+				std::filesystem::remove(snapshot.spillFile, err);
+				store->diskBytes -= snapshot.spilledSize;
+			}
+
+			store->uncompressedBytes -= snapshot.uncompressedSize;
+			store->snapshots.erase(iter);
+		}
+
+		void update(UndoSnapshotStore* store)
+		{
+			for (auto& [id, snapshot] : store->snapshots)
+			{
+				if (snapshot.pending && snapshot.compressTask.isFinished())
+				{
+					finishCompression(store, snapshot);
+				}
+			}
+
+			// Oldest first, these are the least likely to get undone
+			for (auto iter = store->snapshots.begin(); iter != store->snapshots.end() && store->memoryBytes > store->memoryBudget; iter++)
+			{
+				if (!iter->second.pending && iter->second.spillFile.empty())
+				{
+					spill(store, iter->first, iter->second);
+				}
+			}
+		}
+
+		size_t getTotalBytes(UndoSnapshotStore const* store)
+		{
+			return store->memoryBytes + store->diskBytes;
+		}
+
+		UndoSnapshotStats getStats(UndoSnapshotStore const* store)
+		{
+			UndoSnapshotStats res = {};
+			res.numSnapshots = store->snapshots.size();
+			res.uncompressedBytes = store->uncompressedBytes;
+			res.memoryBytes = store->memoryBytes;
+			res.diskBytes = store->diskBytes;
+			for (auto const& [id, snapshot] : store->snapshots)
+			{
+				if (snapshot.pending)
+				{
+					res.numPendingCompressions++;
+				}
+
+				if (!snapshot.spillFile.empty())
+				{
+					res.numSpilledSnapshots++;
+				}
+			}
+
+			return res;
+		}
+
+		// ---- Internal Functions ----
+		static std::vector<uint8> compress(std::vector<uint8> const& data)
+		{
+			MP_PROFILE_EVENT("UndoSnapshots_Compress");
+
+			if (data.size() == 0 || data.size() > (size_t)INT32_MAX)
+			{
+				return {};
+			}
+
+			int compressedSize = 0;
+			uint8* compressed = stbi_zlib_compress((unsigned char*)data.data(), (int)data.size(), &compressedSize, compressionQuality);
+			if (!compressed)
+			{
+				return {};
+			}
+
+			// Keep the raw bytes if compressing didn't actually save anything
+			std::vector<uint8> res = {};
+			if ((size_t)compressedSize < data.size())
+			{
+				res.assign(compressed, compressed + compressedSize);
+			}
+
+			// stb allocates with the C allocator
+			::free(compressed);
+
+			return res;
+		}
+
+		static void finishCompression(UndoSnapshotStore* store, UndoSnapshot& snapshot)
+		{
+			// A cancelled task leaves compressed empty which just keeps the raw bytes
+			if (snapshot.pending->compressed.size() > 0)
+			{
+				snapshot.data = std::move(snapshot.pending->compressed);
+				snapshot.isCompressed = true;
+			}
+			else
+			{
+				snapshot.data = std::move(snapshot.pending->uncompressed);
+				snapshot.isCompressed = false;
+			}
+
+			store->memoryBytes -= snapshot.uncompressedSize;
+			store->memoryBytes += snapshot.data.size();
+
+			snapshot.pending = nullptr;
+			snapshot.compressTask = {};
+		}
+
+		static bool spill(UndoSnapshotStore* store, UndoSnapshotId id, UndoSnapshot& snapshot)
+		{
+			MP_PROFILE_EVENT("UndoSnapshots_Spill");
+
+			Platform::createDirIfNotExists(store->spillDir.string().c_str());
+			std::filesystem::path spillFile = store->spillDir / ("undo_" + std::to_string(store->storeIndex) + "_" + std::to_string(id) + ".bin");
+
+			FILE* fp = fopen(spillFile.string().c_str(), "wb");
+			if (!fp)
+			{
+				g_logger_warning("Failed to spill undo snapshot to '{}': '{}'. Keeping it in memory.", spillFile.string(), strerror(errno));
+				return false;
+			}
+
+			bool succeeded = snapshot.data.size() == 0 || fwrite(snapshot.data.data(), snapshot.data.size(), 1, fp) == 1;
+			succeeded = fclose(fp) == 0 && succeeded;
+			if (!succeeded)
+			{
+				g_logger_warning("Failed to spill undo snapshot to '{}'. Keeping it in memory.", spillFile.string());
+				std::error_code err;
+				std::filesystem::remove(spillFile, err);
+				return false;
+			}
+
+			snapshot.spillFile = spillFile;
+			snapshot.spilledSize = snapshot.data.size();
+			store->memoryBytes -= snapshot.data.size();
+			store->diskBytes += snapshot.spilledSize;
+			snapshot.data = {};
+
+			return true;
+		}
+
+		static bool readSpillFile(UndoSnapshot const& snapshot, std::vector<uint8>& outData)
+		{
+			FILE* fp = fopen(snapshot.spillFile.string().c_str(), "rb");
+			if (!fp)
+			{
+				g_logger_error("Failed to open spilled undo snapshot '{}': '{}'", snapshot.spillFile.string(), strerror(errno));
+				return false;
+			}
+
+			outData.resize(snapshot.spilledSize);
+			bool succeeded = outData.size() == 0 || fread(outData.data(), outData.size(), 1, fp) == 1;
+			fclose(fp);
+
+			if (!succeeded)
+			{
+				g_logger_error("Spilled undo snapshot '{}' is truncated.", snapshot.spillFile.string());
+				return false;
+			}
+
+			return true;
+		}
+	}
+}
@@ -1,4 +1,5 @@
 #include "editor/UndoSystem.h"
+#include "editor/UndoSnapshotStore.h"
 #include "editor/Clipboard.h"
 #include "editor/panels/ErrorPopups.h"
 #include "editor/panels/InspectorPanel.h"
@@ -8,6 +9,9 @@
 #include "animation/Animation.h"
 #include "renderer/Fonts.h"
 #include "platform/Platform.h"
+#include "core/Application.h"
+#include "core/BinaryScene.h"
+#include "core/Profiling.h"
 
 namespace MathAnim
 {
@@ -67,8 +71,27 @@ namespace MathAnim
 		// The offset for undo history beginning.
 		uint32 undoCursorHead;
 		uint32 maxHistorySize;
+		// Created the first time a command needs to snapshot something
+		UndoSnapshotStore* snapshots;
+		size_t memoryBudget;
+		size_t historyBudget;
 	};
 
+	// -------------------------------------
+	// Internal Functions
+	// -------------------------------------
+	static UndoSnapshotStore* getSnapshotStore(UndoSystemData* us);
+	// Drops the oldest commands until the snapshots fit in the history budget again
+	static void trimHistoryToBudget(UndoSystemData* us);
+	// Serializes objects with the binary scene format so deleted subtrees cost a compressed
+	// blob instead of a live deep copy. Parents need to come before their children.
+	static UndoSnapshotId snapshotObjects(UndoSnapshotStore* snapshots, std::vector<AnimObject const*> const& objects);
+	// The caller owns the returned objects
+	static std::vector<AnimObject> restoreObjects(UndoSnapshotStore* snapshots, UndoSnapshotId snapshot);
+	static UndoSnapshotId snapshotAnimation(UndoSnapshotStore* snapshots, Animation const& animation);
+	// Returns an animation with a NULL_ANIM id if the snapshot couldn't be restored
+	static Animation restoreAnimation(UndoSnapshotStore* snapshots, UndoSnapshotId snapshot);
+
 	// -------------------------------------
 	// Command Forward Decls
 	// -------------------------------------
@@ -107,8 +130,8 @@ namespace MathAnim
 	class AddObjectToSceneCommand : public Command
 	{
 	public:
-		AddObjectToSceneCommand(AnimObjectTypeV1 type)
-			: type(type), objCreated(NULL_ANIM_OBJECT)
+		AddObjectToSceneCommand(UndoSnapshotStore* snapshots, AnimObjectTypeV1 type)
+			: snapshots(snapshots), type(type), objCreated(NULL_ANIM_OBJECT), snapshot(NULL_UNDO_SNAPSHOT)
 		{
 		}
 
@@ -117,23 +140,21 @@ namespace MathAnim
 
 		virtual ~AddObjectToSceneCommand() override
 		{
-			if (!isNull(objCreated))
-			{
-				animObj.free();
-			}
+			UndoSnapshots::release(snapshots, snapshot);
 		}
 
 	private:
+		UndoSnapshotStore* snapshots;
 		AnimObjectTypeV1 type;
 		AnimObjId objCreated;
-		AnimObject animObj;
+		UndoSnapshotId snapshot;
 	};
 
 	class RemoveObjectFromSceneCommand : public Command
 	{
 	public:
-		RemoveObjectFromSceneCommand(AnimObjId objToDelete)
-			: objToDelete(objToDelete), parentAndChildren({})
+		RemoveObjectFromSceneCommand(UndoSnapshotStore* snapshots, AnimObjId objToDelete)
+			: snapshots(snapshots), objToDelete(objToDelete), snapshot(NULL_UNDO_SNAPSHOT)
 		{
 		}
 
@@ -142,15 +163,14 @@ namespace MathAnim
 
 		virtual ~RemoveObjectFromSceneCommand() override
 		{
-			for (auto& obj : parentAndChildren)
-			{
-				obj.free();
-			}
+			UndoSnapshots::release(snapshots, snapshot);
 		}
 
 	private:
+		UndoSnapshotStore* snapshots;
 		AnimObjId objToDelete;
-		std::vector<AnimObject> parentAndChildren;
+		// The object and all of its children
+		UndoSnapshotId snapshot;
 		std::unordered_map<AnimObjId, std::vector<AnimId>> correlatedAnimations;
 	};
 
@@ -177,8 +197,9 @@ namespace MathAnim
 	class AddAnimationToTimelineCommand : public Command
 	{
 	public:
-		AddAnimationToTimelineCommand(AnimTypeV1 type, int frameStart, int frameDuration, int trackIndex)
-			: type(type), frameStart(frameStart), frameDuration(frameDuration), animCreated(NULL_ANIM), trackIndex(trackIndex)
+		AddAnimationToTimelineCommand(UndoSnapshotStore* snapshots, AnimTypeV1 type, int frameStart, int frameDuration, int trackIndex)
+			: snapshots(snapshots), type(type), frameStart(frameStart), frameDuration(frameDuration), trackIndex(trackIndex), animCreated(NULL_ANIM),
+			snapshot(NULL_UNDO_SNAPSHOT)
 		{
 		}
 
@@ -187,26 +208,24 @@ namespace MathAnim
 
 		virtual ~AddAnimationToTimelineCommand() override
 		{
-			if (!isNull(animCreated))
-			{
-				anim.free();
-			}
+			UndoSnapshots::release(snapshots, snapshot);
 		}
 
 	private:
+		UndoSnapshotStore* snapshots;
 		AnimTypeV1 type;
 		int frameStart;
 		int frameDuration;
 		int trackIndex;
 		AnimObjId animCreated;
-		Animation anim;
+		UndoSnapshotId snapshot;
 	};
 
 	class RemoveAnimationFromTimelineCommand : public Command
 	{
 	public:
-		RemoveAnimationFromTimelineCommand(AnimId animToDelete)
-			: animToDelete(animToDelete), needToCreateCopy(true)
+		RemoveAnimationFromTimelineCommand(UndoSnapshotStore* snapshots, AnimId animToDelete)
+			: snapshots(snapshots), animToDelete(animToDelete), snapshot(NULL_UNDO_SNAPSHOT)
 		{
 		}
 
@@ -215,13 +234,13 @@ namespace MathAnim
 
 		virtual ~RemoveAnimationFromTimelineCommand() override
 		{
-			anim.free();
+			UndoSnapshots::release(snapshots, snapshot);
 		}
 
 	private:
+		UndoSnapshotStore* snapshots;
 		AnimId animToDelete;
-		Animation anim;
-		bool needToCreateCopy;
+		UndoSnapshotId snapshot;
 	};
 
 	class ModifyBoolCommand : public Command
@@ -440,7 +459,7 @@ namespace MathAnim
 
 	namespace UndoSystem
 	{
-		UndoSystemData* init(void* userContext, int maxHistory)
+		UndoSystemData* init(void* userContext, int maxHistory, size_t memoryBudget, size_t historyBudget)
 		{
 			g_logger_assert(maxHistory > 1, "Cannot have a history of size '{}'. Must be greater than 1.", maxHistory);
 
@@ -452,6 +471,9 @@ namespace MathAnim
 			data->history = (Command**)g_memory_allocate(sizeof(Command*) * maxHistory);
 			data->undoCursorHead = 0;
 			data->undoCursorTail = 0;
+			data->snapshots = nullptr;
+			data->memoryBudget = memoryBudget;
+			data->historyBudget = historyBudget;
 
 			return data;
 		}
@@ -468,6 +490,12 @@ namespace MathAnim
 				g_memory_delete(us->history[i]);
 			}
 
+			// Commands release their snapshots when they're deleted, so this has to go last
+			if (us->snapshots)
+			{
+				UndoSnapshots::free(us->snapshots);
+			}
+
 			g_memory_free(us->history);
 			g_memory_zeroMem(us, sizeof(UndoSystemData));
 			g_memory_free(us);
@@ -477,6 +505,7 @@ namespace MathAnim
 		{
 			uint32 offsetToPlaceNewCommand = pushCommand(us, command);
 			us->history[offsetToPlaceNewCommand]->execute(us->userCtx);
+			trimHistoryToBudget(us);
 		}
 
 		uint32 pushCommand(UndoSystemData* us, Command* command)
@@ -516,6 +545,14 @@ namespace MathAnim
 			return offsetToPlaceNewCommand;
 		}
 
+		void iterate(UndoSystemData* us)
+		{
+			if (us->snapshots)
+			{
+				UndoSnapshots::update(us->snapshots);
+			}
+		}
+
 		void undo(UndoSystemData* us)
 		{
 			// No commands to undo
@@ -548,6 +585,25 @@ namespace MathAnim
 			us->undoCursorTail = (us->undoCursorTail + 1) % us->maxHistorySize;
 		}
 
+		void imguiStats(UndoSystemData const* us)
+		{
+			constexpr float bytesPerMb = 1024.0f * 1024.0f;
+
+			ImGui::Text("Commands: %u/%u", us->numCommands, us->maxHistorySize - 1);
+			if (!us->snapshots)
+			{
+				ImGui::Text("Snapshots: 0");
+				return;
+			}
+
+			UndoSnapshotStats stats = UndoSnapshots::getStats(us->snapshots);
+			ImGui::Text("Snapshots: %zu (%zu compressing, %zu on disk)", stats.numSnapshots, stats.numPendingCompressions, stats.numSpilledSnapshots);
+			ImGui::Text("Uncompressed: %.2fMB", (float)stats.uncompressedBytes / bytesPerMb);
+			ImGui::Text("In Memory: %.2fMB / %.2fMB", (float)stats.memoryBytes / bytesPerMb, (float)us->memoryBudget / bytesPerMb);
+			ImGui::Text("On Disk: %.2fMB", (float)stats.diskBytes / bytesPerMb);
+			ImGui::Text("Total: %.2fMB / %.2fMB", (float)(stats.memoryBytes + stats.diskBytes) / bytesPerMb, (float)us->historyBudget / bytesPerMb);
+		}
+
 		void setBoolProp(UndoSystemData* us, ObjOrAnimId id, bool oldBool, bool newBool, BoolPropType propType)
 		{
 			auto* newCommand = g_memory_new ModifyBoolCommand(id, oldBool, newBool, propType);
@@ -735,13 +791,13 @@ namespace MathAnim
 			assertEnumInRange<AnimObjectTypeV1>(animObjType);
 			g_logger_assert((AnimObjectTypeV1)animObjType != AnimObjectTypeV1::None, "Cannot create AnimObject of type 'None'");
 
-			auto* newCommand = g_memory_new AddObjectToSceneCommand((AnimObjectTypeV1)animObjType);
+			auto* newCommand = g_memory_new AddObjectToSceneCommand(getSnapshotStore(us), (AnimObjectTypeV1)animObjType);
 			pushAndExecuteCommand(us, newCommand);
 		}
 
 		void removeObjFromScene(UndoSystemData* us, AnimObjId objId)
 		{
-			auto* newCommand = g_memory_new RemoveObjectFromSceneCommand(objId);
+			auto* newCommand = g_memory_new RemoveObjectFromSceneCommand(getSnapshotStore(us), objId);
 			pushAndExecuteCommand(us, newCommand);
 		}
 
@@ -764,13 +820,13 @@ namespace MathAnim
 			assertEnumInRange<AnimTypeV1>(animType);
 			g_logger_assert((AnimTypeV1)animType != AnimTypeV1::None, "Cannot create Animation of type 'None'");
 
-			auto* newCommand = g_memory_new AddAnimationToTimelineCommand((AnimTypeV1)animType, frameStart, frameDuration, trackIndex);
+			auto* newCommand = g_memory_new AddAnimationToTimelineCommand(getSnapshotStore(us), (AnimTypeV1)animType, frameStart, frameDuration, trackIndex);
 			pushAndExecuteCommand(us, newCommand);
 		}
 
 		void removeAnimationFromTimeline(UndoSystemData* us, AnimId animId)
 		{
-			auto* newCommand = g_memory_new RemoveAnimationFromTimelineCommand(animId);
+			auto* newCommand = g_memory_new RemoveAnimationFromTimelineCommand(getSnapshotStore(us), animId);
 			pushAndExecuteCommand(us, newCommand);
 		}
 	}
@@ -806,19 +862,29 @@ namespace MathAnim
 	{
 		AnimationManagerData* const am = (AnimationManagerData* const)userContext;
 
+		AnimObject animObj;
 		if (this->objCreated == NULL_ANIM_OBJECT)
 		{
-			this->animObj = AnimObject::createDefault(am, type);
+			animObj = AnimObject::createDefault(am, type);
 			this->objCreated = animObj.id;
+			this->snapshot = snapshotObjects(snapshots, { &animObj });
+		}
+		else
+		{
+			std::vector<AnimObject> restored = restoreObjects(snapshots, this->snapshot);
+			if (restored.size() == 0)
+			{
+				return;
+			}
+			animObj = restored[0];
 		}
 
-		AnimObject deepCopy = this->animObj.createDeepCopy(true);
-		AnimationManager::addAnimObject(am, deepCopy);
-		SceneHierarchyPanel::addNewAnimObject(deepCopy);
+		AnimationManager::addAnimObject(am, animObj);
+		SceneHierarchyPanel::addNewAnimObject(animObj);
 
 		if (type == AnimObjectTypeV1::Camera)
 		{
-			AnimationManager::setActiveCamera(am, deepCopy.id);
+			AnimationManager::setActiveCamera(am, animObj.id);
 		}
 	}
 
@@ -845,19 +911,32 @@ namespace MathAnim
 			return;
 		}
 
-		if (this->parentAndChildren.size() == 0)
+		if (this->snapshot == NULL_UNDO_SNAPSHOT)
 		{
-			constexpr bool keepOriginalIds = true;
-			parentAndChildren = objToDeletePtr->createDeepCopyWithChildren(am, *objToDeletePtr, keepOriginalIds);
+			// Breadth first so parents always get restored before their children
+			std::vector<AnimObject const*> parentAndChildren = { objToDeletePtr };
+			for (auto it = objToDeletePtr->beginBreadthFirst(am); it != objToDeletePtr->end(); ++it)
+			{
+				const AnimObject* child = AnimationManager::getObject(am, *it);
+				if (child)
+				{
+					parentAndChildren.push_back(child);
+				}
+				else
+				{
+					g_logger_error("Tried to snapshot undefined AnimObject '{}' while deleting object '{}'", *it, objToDeletePtr->name);
+				}
+			}
+			this->snapshot = snapshotObjects(snapshots, parentAndChildren);
 
 			// NOTE: Find any correlated animations that we need to reassign this anim object to if this action is
 			// undone.
-			for (const auto& obj : parentAndChildren)
+			for (const auto* obj : parentAndChildren)
 			{
-				std::vector<AnimId> anims = AnimationManager::getAssociatedAnimations(am, obj.id);
+				std::vector<AnimId> anims = AnimationManager::getAssociatedAnimations(am, obj->id);
 				if (anims.size() > 0)
 				{
-					this->correlatedAnimations[obj.id] = anims;
+					this->correlatedAnimations[obj->id] = anims;
 				}
 			}
 		}
@@ -871,23 +950,23 @@ namespace MathAnim
 	{
 		AnimationManagerData* const am = (AnimationManagerData* const)userContext;
 
+		std::vector<AnimObject> parentAndChildren = restoreObjects(snapshots, this->snapshot);
 		for (const auto& obj : parentAndChildren)
 		{
-			AnimObject copy = obj.createDeepCopy(true);
-			AnimationManager::addAnimObject(am, copy);
-			SceneHierarchyPanel::addNewAnimObject(copy);
+			AnimationManager::addAnimObject(am, obj);
+			SceneHierarchyPanel::addNewAnimObject(obj);
 
 			if (obj.objectType == AnimObjectTypeV1::Camera)
 			{
 				AnimationManager::setActiveCamera(am, obj.id);
 			}
 
-			if (auto iter = this->correlatedAnimations.find(copy.id);
+			if (auto iter = this->correlatedAnimations.find(obj.id);
 				iter != this->correlatedAnimations.end())
 			{
 				for (AnimId anim : iter->second)
 				{
-					AnimationManager::addObjectToAnim(am, copy.id, anim);
+					AnimationManager::addObjectToAnim(am, obj.id, anim);
 				}
 			}
 		}
@@ -925,17 +1004,26 @@ namespace MathAnim
 	{
 		AnimationManagerData* const am = (AnimationManagerData* const)userContext;
 
+		Animation anim;
 		if (this->animCreated == NULL_ANIM)
 		{
-			this->anim = Animation::createDefault(type, frameStart, frameDuration);
-			this->anim.timelineTrack = this->trackIndex;
+			anim = Animation::createDefault(type, frameStart, frameDuration);
+			anim.timelineTrack = this->trackIndex;
 			this->animCreated = anim.id;
+			this->snapshot = snapshotAnimation(snapshots, anim);
+		}
+		else
+		{
+			anim = restoreAnimation(snapshots, this->snapshot);
+			if (isNull(anim))
+			{
+				return;
+			}
 		}
 
-		Animation deepCopy = this->anim.createDeepCopy(true);
-		AnimationManager::addAnimation(am, deepCopy);
-		InspectorPanel::setActiveAnimation(deepCopy.id);
-		Timeline::addAnimation(deepCopy);
+		AnimationManager::addAnimation(am, anim);
+		InspectorPanel::setActiveAnimation(anim.id);
+		Timeline::addAnimation(anim);
 	}
 
 	void AddAnimationToTimelineCommand::undo(void* userContext)
@@ -958,10 +1046,9 @@ namespace MathAnim
 			return;
 		}
 
-		if (needToCreateCopy)
+		if (this->snapshot == NULL_UNDO_SNAPSHOT)
 		{
-			this->anim = animToDeletePtr->createDeepCopy(true);
-			needToCreateCopy = false;
+			this->snapshot = snapshotAnimation(snapshots, *animToDeletePtr);
 		}
 
 		Timeline::removeAnimation(am, this->animToDelete);
@@ -971,10 +1058,15 @@ namespace MathAnim
 	{
 		AnimationManagerData* const am = (AnimationManagerData* const)userContext;
 
-		Animation deepCopy = this->anim.createDeepCopy(true);
-		AnimationManager::addAnimation(am, deepCopy);
-		InspectorPanel::setActiveAnimation(deepCopy.id);
-		Timeline::addAnimation(deepCopy);
+		Animation anim = restoreAnimation(snapshots, this->snapshot);
+		if (isNull(anim))
+		{
+			return;
+		}
+
+		AnimationManager::addAnimation(am, anim);
+		InspectorPanel::setActiveAnimation(anim.id);
+		Timeline::addAnimation(anim);
 	}
 
 	void ModifyBoolCommand::execute(void* userContext)
@@ -1051,6 +1143,7 @@ namespace MathAnim
 			case U8Vec4PropType::StrokeColor:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1090,6 +1183,7 @@ namespace MathAnim
 			case U8Vec4PropType::StrokeColor:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1127,6 +1221,7 @@ namespace MathAnim
 			case EnumPropType::ImageSampleMode:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 
 		AnimObject* obj = AnimationManager::getMutableObject(am, this->id);
@@ -1205,6 +1300,7 @@ namespace MathAnim
 			case EnumPropType::ImageSampleMode:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 
 		AnimObject* obj = AnimationManager::getMutableObject(am, this->id);
@@ -1399,6 +1495,7 @@ namespace MathAnim
 			case FloatPropType::AxisLabelStrokeWidth:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1551,6 +1648,7 @@ namespace MathAnim
 			case FloatPropType::AxisLabelStrokeWidth:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1568,6 +1666,7 @@ namespace MathAnim
 				anim->as.animateScale.target = this->newVec;
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1585,6 +1684,7 @@ namespace MathAnim
 				anim->as.animateScale.target = this->oldVec;
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1704,6 +1804,7 @@ namespace MathAnim
 			case Vec3PropType::AxisAxesLength:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1757,6 +1858,7 @@ namespace MathAnim
 			case Vec3PropType::AxisAxesLength:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1793,6 +1895,7 @@ namespace MathAnim
 			case Vec4PropType::CameraBackgroundColor:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -1829,6 +1932,7 @@ namespace MathAnim
 			case Vec4PropType::CameraBackgroundColor:
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -2061,6 +2165,7 @@ namespace MathAnim
 				anim->as.circumscribe.obj = newTarget;
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -2094,6 +2199,7 @@ namespace MathAnim
 				anim->as.circumscribe.obj = oldTarget;
 				break;
 			}
+			AnimationManager::invalidateAnimation(am, anim->id);
 		}
 	}
 
@@ -2157,4 +2263,115 @@ namespace MathAnim
 			AnimationManager::updateObjectState(am, this->objId);
 		}
 	}
+
+	// -------------------------------------
+	// Internal Functions
+	// -------------------------------------
+	static UndoSnapshotStore* getSnapshotStore(UndoSystemData* us)
+	{
+		if (!us->snapshots)
+		{
+			us->snapshots = UndoSnapshots::init(Application::threadPool(), us->memoryBudget, Application::getTmpDir() / "undo");
+		}
+
+		return us->snapshots;
+	}
+
+	static void trimHistoryToBudget(UndoSystemData* us)
+	{
+		if (!us->snapshots)
+		{
+			return;
+		}
+
+		// This only ever runs right after a push, so there's nothing to redo and the head is always
+		// the oldest command. Never drop the command that was just pushed though.
+		while (us->numCommands > 1 && UndoSnapshots::getTotalBytes(us->snapshots) > us->historyBudget)
+		{
+			us->history[us->undoCursorHead]->free(us->userCtx);
+			g_memory_delete(us->history[us->undoCursorHead]);
+
+			us->undoCursorHead = (us->undoCursorHead + 1) % us->maxHistorySize;
+			us->numCommands--;
+		}
+	}
+
+	static UndoSnapshotId snapshotObjects(UndoSnapshotStore* snapshots, std::vector<AnimObject const*> const& objects)
+	{
+		MP_PROFILE_EVENT("UndoSystem_SnapshotObjects");
+
+		BinarySceneWriter writer;
+		for (const AnimObject* obj : objects)
+		{
+			obj->serializeBinary(writer);
+		}
+
+		std::vector<uint8> data = {};
+		writer.writeToMemory(data, SERIALIZER_VERSION_MAJOR, SERIALIZER_VERSION_MINOR);
+		return UndoSnapshots::add(snapshots, std::move(data));
+	}
+
+	static std::vector<AnimObject> restoreObjects(UndoSnapshotStore* snapshots, UndoSnapshotId snapshot)
+	{
+		MP_PROFILE_EVENT("UndoSystem_RestoreObjects");
+
+		std::vector<uint8> data = {};
+		BinarySceneReader reader;
+		if (!UndoSnapshots::load(snapshots, snapshot, data) || !reader.openMemory(data.data(), data.size()))
+		{
+			g_logger_error("Failed to restore undo snapshot '{}'.", snapshot);
+			return {};
+		}
+
+		size_t numRecords = 0;
+		const BinaryAnimObjectRecord* records = reader.getRecords<BinaryAnimObjectRecord>(BinarySceneSection::AnimObjects, &numRecords);
+
+		std::vector<AnimObject> res = {};
+		res.reserve(numRecords);
+		for (size_t i = 0; i < numRecords; i++)
+		{
+			AnimObject obj = AnimObject::deserializeBinary(reader, records[i], reader.getVersionMajor());
+			if (!isNull(obj))
+			{
+				res.emplace_back(obj);
+			}
+		}
+
+		reader.close();
+		return res;
+	}
+
+	static UndoSnapshotId snapshotAnimation(UndoSnapshotStore* snapshots, Animation const& animation)
+	{
+		BinarySceneWriter writer;
+		animation.serializeBinary(writer);
+
+		std::vector<uint8> data = {};
+		writer.writeToMemory(data, SERIALIZER_VERSION_MAJOR, SERIALIZER_VERSION_MINOR);
+		return UndoSnapshots::add(snapshots, std::move(data));
+	}
+
+	static Animation restoreAnimation(UndoSnapshotStore* snapshots, UndoSnapshotId snapshot)
+	{
+		Animation res = {};
+		res.id = NULL_ANIM;
+
+		std::vector<uint8> data = {};
+		BinarySceneReader reader;
+		if (!UndoSnapshots::load(snapshots, snapshot, data) || !reader.openMemory(data.data(), data.size()))
+		{
+			g_logger_error("Failed to restore undo snapshot '{}'.", snapshot);
+			return res;
+		}
+
+		size_t numRecords = 0;
+		const BinaryAnimationRecord* records = reader.getRecords<BinaryAnimationRecord>(BinarySceneSection::Animations, &numRecords);
+		if (numRecords > 0)
+		{
+			res = Animation::deserializeBinary(reader, records[0], reader.getVersionMajor());
+		}
+
+		reader.close();
+		return res;
+	}
 }
@@ -208,28 +208,30 @@ namespace MathAnim
 			}
 		}
 
+		// NOTE: The watcher hands us paths relative to the scripts root, and scripts in
+		//       subdirectories are named by that relative path
 		static void onScriptChanged(const std::filesystem::path& scriptPath)
 		{
-			LuauLayer::compile(scriptPath.filename().string());
-			LuauLayer::execute(scriptPath.filename().string());
+			std::string scriptName = scriptPath.generic_string();
+			LuauLayer::compile(scriptName);
+			LuauLayer::execute(scriptName);
 		}
 
 		static void onScriptDeleted(const std::filesystem::path& scriptPath)
 		{
-			LuauLayer::remove(scriptPath.filename().string());
-			CodeEditorPanelManager::closeFile(scriptPath.string());
+			LuauLayer::remove(scriptPath.generic_string());
+			CodeEditorPanelManager::closeFile((scriptsRoot / scriptPath).string());
 		}
 
 		static void onScriptCreated(const std::filesystem::path& scriptPath)
 		{
-			auto fullScriptPath = scriptsRoot / scriptPath;
-			LuauLayer::remove(fullScriptPath.filename().string());
-			CodeEditorPanelManager::openFile(fullScriptPath.string());
+			LuauLayer::remove(scriptPath.generic_string());
+			CodeEditorPanelManager::openFile((scriptsRoot / scriptPath).string());
 		}
 
 		static void onScriptRenamed(const std::filesystem::path& scriptPath)
 		{
-			LuauLayer::remove(scriptPath.filename().string());
+			LuauLayer::remove(scriptPath.generic_string());
 		}
 
 		static void scriptRenamedCallback(const char* oldFilename, const char* newFilename)
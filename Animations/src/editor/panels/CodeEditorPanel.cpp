@@ -135,8 +135,6 @@ namespace MathAnim
 			fclose(fp);
 
 			// Preprocess file into usable buffer
-			res->visibleCharacterBuffer = nullptr;
-			res->visibleCharacterBufferSize = 0;
 			res->lineNumberStart = 1;
 			res->lineNumberByteStart = 0;
 			res->undoTypingStart = -1;
@@ -144,16 +142,22 @@ namespace MathAnim
 			res->hzCharacterOffset = 0;
 			res->maxLineLength = 0;
 
-			preprocessText((uint8*)memory.data, fileSize, &res->visibleCharacterBuffer, &res->visibleCharacterBufferSize, &res->totalNumberLines, &res->maxLineLength);
+			uint8* visibleText = nullptr;
+			size_t visibleTextNumBytes = 0;
+			preprocessText((uint8*)memory.data, fileSize, &visibleText, &visibleTextNumBytes, &res->totalNumberLines, &res->maxLineLength);
+			res->document.init(visibleText, visibleTextNumBytes);
+			g_memory_free(visibleText);
+
 			// +1 for the extra line for EOF
 			res->totalNumberLines++;
-			res->cursor = CppUtils::String::makeIter(res->visibleCharacterBuffer, res->visibleCharacterBufferSize);
+			res->cursor = res->document.makeIter();
 
 			// Parse the syntax
 			res->syntaxHighlightTree = CodeEditorPanelManager::getHighlighter().parse(
-				(const char*)res->visibleCharacterBuffer,
-				res->visibleCharacterBufferSize,
-				CodeEditorPanelManager::getTheme()
+				(const char*)res->document.getFlattenedText(),
+				res->document.getLength(),
+				CodeEditorPanelManager::getTheme(),
+				Application::threadPool()
 			);
 
 			res->undoSystem = UndoSystem::createTextEditorUndoSystem(res, MAX_UNDO_HISTORY);
@@ -167,7 +171,7 @@ namespace MathAnim
 		{
 			uint8* utf8String = nullptr;
 			size_t utf8StringNumBytes = 0;
-			postprocessText(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, &utf8String, &utf8StringNumBytes);
+			postprocessText((uint8*)panel.document.getFlattenedText(), panel.document.getLength(), &utf8String, &utf8StringNumBytes);
 
 			// Dump UTF-8 to file
 			FILE* fp = fopen(panel.filepath.string().c_str(), "wb");
@@ -181,7 +185,7 @@ namespace MathAnim
 		void free(CodeEditorPanelData* panel)
 		{
 			UndoSystem::free(panel->undoSystem);
-			g_memory_free((void*)panel->visibleCharacterBuffer);
+			panel->document.free();
 			g_memory_delete(panel);
 		}
 
@@ -189,9 +193,10 @@ namespace MathAnim
 		{
 			// Parse the syntax
 			panel.syntaxHighlightTree = CodeEditorPanelManager::getHighlighter().parse(
-				(const char*)panel.visibleCharacterBuffer,
-				panel.visibleCharacterBufferSize,
-				CodeEditorPanelManager::getTheme()
+				(const char*)panel.document.getFlattenedText(),
+				panel.document.getLength(),
+				CodeEditorPanelManager::getTheme(),
+				Application::threadPool()
 			);
 
 		}
@@ -229,19 +234,11 @@ namespace MathAnim
 					const uint8* utf8String = Application::getWindow().getClipboardString();
 					size_t utf8StringNumBytes = strlen((const char*)utf8String);
 
-					// Figure out how many characters exist in this string
-					uint8* outStr = nullptr;
-					size_t numCharacters;
-					preprocessText((uint8*)utf8String, utf8StringNumBytes, &outStr, &numCharacters);
-
-					// Free the new memory since we don't actually need the string
-					g_memory_free(outStr);
-
-					// Perform the paste and add an undo action
-					int32 insertPosition = (int32)panel.cursor.bytePos;
+					// Perform the paste and add an undo action for the preprocessed text that ended up in the document
+					size_t insertPosition = panel.cursor.bytePos;
 					addUtf8StringToBuffer(panel, (uint8*)utf8String, utf8StringNumBytes, panel.cursor.bytePos);
 
-					UndoSystem::insertTextAction(panel.undoSystem, utf8String, utf8StringNumBytes, insertPosition, numCharacters);
+					UndoSystem::insertTextAction(panel.undoSystem, panel.document, insertPosition, panel.cursor.bytePos - insertPosition);
 				}
 				else if (Input::keyRepeatedOrDown(GLFW_KEY_C, KeyMods::Ctrl))
 				{
@@ -249,14 +246,19 @@ namespace MathAnim
 					if (panel.lastByteInSelection != panel.firstByteInSelection)
 					{
 						g_logger_assert(panel.lastByteInSelection > panel.firstByteInSelection, "This shouldn't happen.");
-						g_logger_assert(panel.lastByteInSelection <= panel.visibleCharacterBufferSize, "This shouldn't happen either.");
+						g_logger_assert(panel.lastByteInSelection <= panel.document.getLength(), "This shouldn't happen either.");
+
+						std::string selectedText = panel.document.getText(
+							panel.firstByteInSelection,
+							panel.lastByteInSelection - panel.firstByteInSelection
+						);
 
 						uint8* utf8String = nullptr;
 						size_t utf8StringSize = 0;
 
 						postprocessText(
-							panel.visibleCharacterBuffer + panel.firstByteInSelection,
-							(panel.lastByteInSelection - panel.firstByteInSelection),
+							(uint8*)selectedText.data(),
+							selectedText.size(),
 							&utf8String,
 							&utf8StringSize
 						);
@@ -276,8 +278,8 @@ namespace MathAnim
 				if (Input::keyRepeatedOrDown(GLFW_KEY_A, KeyMods::Ctrl))
 				{
 					panel.firstByteInSelection = 0;
-					panel.lastByteInSelection = (int32)panel.visibleCharacterBufferSize;
-					panel.cursor.bytePos = (int32)panel.visibleCharacterBufferSize;
+					panel.lastByteInSelection = (int32)panel.document.getLength();
+					panel.cursor.bytePos = (int32)panel.document.getLength();
 					panel.mouseByteDragStart = 0;
 				}
 
@@ -559,17 +561,15 @@ namespace MathAnim
 
 			// Render the text
 			auto highlightIter = panel.syntaxHighlightTree.begin(panel.lineNumberByteStart);
-			for (auto cursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, panel.lineNumberByteStart);
-				cursor.bytePos < panel.visibleCharacterBufferSize;
+			for (auto cursor = panel.document.makeIter(panel.lineNumberByteStart);
+				cursor.bytePos < panel.document.getLength();
 				++cursor)
 			{
 				// Figure out what color this character should be
 				highlightIter = highlightIter.next(cursor.bytePos);
 				ImColor highlightedColor = highlightIter.getForegroundColor(syntaxTheme);
 
-				auto maybeCurrentCodepoint = *cursor;
-				g_logger_assert(maybeCurrentCodepoint.hasValue(), "We shouldn't have any invalid UTF8 in our edit buffer.");
-				uint32 currentCodepoint = maybeCurrentCodepoint.value();
+				uint32 currentCodepoint = *cursor;
 				ImVec2 letterBoundsStart = currentLetterDrawPos;
 
 				// Before drawing the letter, draw the highlighted background if applicable
@@ -603,7 +603,7 @@ namespace MathAnim
 					ImVec2 textCursorDrawPosition = letterBoundsStart;
 					renderTextCursor(panel, textCursorDrawPosition, codeFont);
 				}
-				else if (cursor.bytePos == panel.visibleCharacterBufferSize - 1 && panel.cursor.bytePos == panel.visibleCharacterBufferSize)
+				else if (cursor.bytePos == panel.document.getLength() - 1 && panel.cursor.bytePos == panel.document.getLength())
 				{
 					ImVec2 textCursorDrawPosition = letterBoundsStart + ImVec2(letterBoundsSize.x, 0.0f);
 					if (currentCodepoint == '\n')
@@ -673,9 +673,9 @@ namespace MathAnim
 						closestByteToMouseCursor = (int32)cursor.bytePos;
 					}
 					// If we clicked past the last character in the file, the closest byte is the end of the file
-					else if (cursor.bytePos == panel.visibleCharacterBufferSize - 1 && io.MousePos.x >= letterBoundsStart.x + letterBoundsSize.x)
+					else if (cursor.bytePos == panel.document.getLength() - 1 && io.MousePos.x >= letterBoundsStart.x + letterBoundsSize.x)
 					{
-						closestByteToMouseCursor = (int32)panel.visibleCharacterBufferSize;
+						closestByteToMouseCursor = (int32)panel.document.getLength();
 					}
 					// If we clicked before any letters in the start of the line, the closest byte
 					// is the first byte in this line
@@ -685,9 +685,9 @@ namespace MathAnim
 					}
 				}
 				// If the mouse clicked past the last visible character, then the closest byte is the end of the file
-				else if (cursor.bytePos == panel.visibleCharacterBufferSize - 1 && io.MousePos.y >= letterBoundsStart.y + letterBoundsSize.y)
+				else if (cursor.bytePos == panel.document.getLength() - 1 && io.MousePos.y >= letterBoundsStart.y + letterBoundsSize.y)
 				{
-					closestByteToMouseCursor = (int32)panel.visibleCharacterBufferSize;
+					closestByteToMouseCursor = (int32)panel.document.getLength();
 				}
 
 				// Don't increment the letter draw pos for newlines
@@ -757,7 +757,7 @@ namespace MathAnim
 			}
 
 			// We'll render the text cursor at the start of the file if the file is empty
-			if (panel.visibleCharacterBufferSize == 0)
+			if (panel.document.getLength() == 0)
 			{
 				renderTextCursor(panel, currentLetterDrawPos, codeFont);
 			}
@@ -804,8 +804,8 @@ namespace MathAnim
 
 					ImGui::TableNextColumn(); ImGui::Text("Character");
 					ImGui::TableNextColumn();
-					char character = panel.visibleCharacterBufferSize > 0 && panel.cursor.bytePos < panel.visibleCharacterBufferSize
-						? (char)panel.visibleCharacterBuffer[panel.cursor.bytePos]
+					char character = panel.cursor.bytePos < panel.document.getLength()
+						? (char)panel.document.getByte(panel.cursor.bytePos)
 						: '\0';
 					if (character != '\r' && character != '\n' && character != '\t' && character != '\0')
 					{
@@ -866,52 +866,29 @@ namespace MathAnim
 
 		void addUtf8StringToBuffer(CodeEditorPanelData& panel, uint8* utf8String, size_t stringNumBytes, size_t insertPosition)
 		{
-			g_logger_assert(insertPosition <= panel.visibleCharacterBufferSize, "Cannot insert string past end of buffer.");
+			g_logger_assert(insertPosition <= panel.document.getLength(), "Cannot insert string past end of buffer.");
 
 			// Translate UTF8 string to local byte mapping
 			uint8* byteMappedString = nullptr;
 			size_t byteMappedStringLength = 0;
-			uint32 numberLinesInString = 0;
-
-			preprocessText(utf8String, stringNumBytes, &byteMappedString, &byteMappedStringLength, &numberLinesInString);
-
-			size_t newCharBufferSize = sizeof(uint8) * (panel.visibleCharacterBufferSize + byteMappedStringLength);
-			panel.visibleCharacterBuffer = (uint8*)g_memory_realloc(panel.visibleCharacterBuffer, newCharBufferSize);
-
-			// Move the right half of the string over
-			size_t placeToMoveRightHalfToOffset = byteMappedStringLength + insertPosition;
-			memmove(
-				panel.visibleCharacterBuffer + placeToMoveRightHalfToOffset,
-				panel.visibleCharacterBuffer + insertPosition,
-				panel.visibleCharacterBufferSize - insertPosition
-			);
 
-			// Copy the mapped text into the middle portion
-			g_memory_copyMem(
-				panel.visibleCharacterBuffer + insertPosition,
-				newCharBufferSize - insertPosition,
-				byteMappedString,
-				byteMappedStringLength * sizeof(uint8)
-			);
+			preprocessText(utf8String, stringNumBytes, &byteMappedString, &byteMappedStringLength);
 
-			panel.visibleCharacterBufferSize = newCharBufferSize;
+			TextEdit edit = panel.document.insert(insertPosition, byteMappedString, byteMappedStringLength);
+			g_memory_free(byteMappedString);
 
-			panel.cursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, insertPosition + byteMappedStringLength);
+			panel.cursor = panel.document.makeIter(insertPosition + byteMappedStringLength);
 			panel.mouseByteDragStart = (int32)panel.cursor.bytePos;
 			panel.firstByteInSelection = (int32)panel.cursor.bytePos;
 			panel.lastByteInSelection = (int32)panel.cursor.bytePos;
 
-			panel.totalNumberLines += numberLinesInString;
-
-			g_memory_free(byteMappedString);
+			panel.totalNumberLines = (uint32)panel.document.getNumLines();
 
 			size_t numberLinesToUpdate = panel.numberLinesCanFitOnScreen;
 			Vec2i linesUpdated = CodeEditorPanelManager::getHighlighter().insertText(
 				panel.syntaxHighlightTree,
-				(const char*)panel.visibleCharacterBuffer,
-				panel.visibleCharacterBufferSize,
-				insertPosition,
-				insertPosition + stringNumBytes,
+				panel.document,
+				edit,
 				numberLinesToUpdate
 			);
 
@@ -934,7 +911,7 @@ namespace MathAnim
 
 		bool removeTextWithBackspace(CodeEditorPanelData& panel, int32 textToRemoveStart, int32 textToRemoveLength)
 		{
-			if (textToRemoveStart < 0 || textToRemoveStart + textToRemoveLength > panel.visibleCharacterBufferSize)
+			if (textToRemoveStart < 0 || textToRemoveStart + textToRemoveLength > panel.document.getLength())
 			{
 				return false;
 			}
@@ -946,7 +923,7 @@ namespace MathAnim
 
 			removeText(panel, textToRemoveStart, textToRemoveLength);
 
-			panel.cursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, textToRemoveStart);
+			panel.cursor = panel.document.makeIter(textToRemoveStart);
 			panel.mouseByteDragStart = (int32)panel.cursor.bytePos;
 			panel.firstByteInSelection = (int32)panel.cursor.bytePos;
 			panel.lastByteInSelection = (int32)panel.cursor.bytePos;
@@ -959,7 +936,7 @@ namespace MathAnim
 
 		bool removeTextWithDelete(CodeEditorPanelData& panel, int32 textToRemoveStart, int32 textToRemoveLength)
 		{
-			if (textToRemoveStart < 0 || textToRemoveStart + textToRemoveLength > panel.visibleCharacterBufferSize)
+			if (textToRemoveStart < 0 || textToRemoveStart + textToRemoveLength > panel.document.getLength())
 			{
 				return false;
 			}
@@ -971,7 +948,7 @@ namespace MathAnim
 
 			removeText(panel, textToRemoveStart, textToRemoveLength);
 
-			panel.cursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, textToRemoveStart);
+			panel.cursor = panel.document.makeIter(textToRemoveStart);
 			panel.mouseByteDragStart = (int32)panel.cursor.bytePos;
 			panel.firstByteInSelection = (int32)panel.cursor.bytePos;
 			panel.lastByteInSelection = (int32)panel.cursor.bytePos;
@@ -1195,7 +1172,7 @@ namespace MathAnim
 
 			int32 numBytesInUndo = ((int32)panel.cursor.bytePos - panel.undoTypingStart);
 			if (panel.undoTypingStart > panel.cursor.bytePos || numBytesInUndo < 0 ||
-				panel.undoTypingStart + numBytesInUndo > panel.visibleCharacterBufferSize)
+				panel.undoTypingStart + numBytesInUndo > panel.document.getLength())
 			{
 				g_logger_warning("Invalid undo typing cursor encountered.");
 				panel.undoTypingStart = -1;
@@ -1205,8 +1182,7 @@ namespace MathAnim
 			// We typed some stuff, and we want to add it as one big undo operation
 			UndoSystem::insertTextAction(
 				panel.undoSystem,
-				panel.visibleCharacterBuffer + panel.undoTypingStart,
-				numBytesInUndo,
+				panel.document,
 				panel.undoTypingStart,
 				numBytesInUndo);
 
@@ -1217,7 +1193,7 @@ namespace MathAnim
 		{
 			// Figure out what text we're about to delete
 			int32 numBytesToDelete = panel.lastByteInSelection - panel.firstByteInSelection;
-			if (numBytesToDelete < 0 || panel.firstByteInSelection + numBytesToDelete > panel.visibleCharacterBufferSize)
+			if (numBytesToDelete < 0 || panel.firstByteInSelection + numBytesToDelete > panel.document.getLength())
 			{
 				g_logger_error("This shouldn't happen. We are trying to add a backspace operation that deletes an invalid amount of text.");
 				return;
@@ -1225,8 +1201,7 @@ namespace MathAnim
 
 			UndoSystem::backspaceTextAction(
 				panel.undoSystem,
-				panel.visibleCharacterBuffer + panel.firstByteInSelection,
-				numBytesToDelete,
+				panel.document,
 				panel.firstByteInSelection,
 				panel.firstByteInSelection + numBytesToDelete,
 				panel.cursor.bytePos,
@@ -1238,7 +1213,7 @@ namespace MathAnim
 		{
 			// Figure out what text we're about to delete
 			int32 numBytesToDelete = panel.lastByteInSelection - panel.firstByteInSelection;
-			if (numBytesToDelete < 0 || panel.firstByteInSelection + numBytesToDelete > panel.visibleCharacterBufferSize)
+			if (numBytesToDelete < 0 || panel.firstByteInSelection + numBytesToDelete > panel.document.getLength())
 			{
 				g_logger_error("This shouldn't happen. We are trying to add a backspace operation that deletes an invalid amount of text.");
 				return;
@@ -1246,8 +1221,7 @@ namespace MathAnim
 
 			UndoSystem::deleteTextAction(
 				panel.undoSystem,
-				panel.visibleCharacterBuffer + panel.firstByteInSelection,
-				numBytesToDelete,
+				panel.document,
 				panel.firstByteInSelection,
 				panel.firstByteInSelection + numBytesToDelete,
 				panel.cursor.bytePos,
@@ -1404,7 +1378,6 @@ namespace MathAnim
 		static ImVec2 addCharToDrawList(ImDrawList* drawList, SizedFont const* const sizedFont, uint32 charToAdd, ImVec2 const& drawPos, ImColor const& color)
 		{
 			Font const* const font = sizedFont->unsizedFont;
-			uint32 texId = sizedFont->texture.graphicsId;
 			ImVec2 cursorPos = ImVec2(drawPos.x, drawPos.y + (font->lineHeight * sizedFont->fontSizePixels));
 
 			if (charToAdd == (uint32)'\n' || charToAdd == (uint32)'\r')
@@ -1414,6 +1387,7 @@ namespace MathAnim
 
 			const GlyphOutline& glyphOutline = font->getGlyphInfo(charToAdd);
 			const GlyphTexture& glyphTexture = sizedFont->getGlyphTexture(charToAdd);
+			uint32 texId = sizedFont->getAtlasTexture(glyphTexture).graphicsId;
 			if (!glyphOutline.svg)
 			{
 				return ImVec2(0.0f, (font->lineHeight * sizedFont->fontSizePixels));
@@ -1483,7 +1457,7 @@ namespace MathAnim
 
 		static bool removeSelectedTextWithDelete(CodeEditorPanelData& panel)
 		{
-			if (panel.cursor.bytePos == panel.visibleCharacterBufferSize && panel.firstByteInSelection == panel.lastByteInSelection)
+			if (panel.cursor.bytePos == panel.document.getLength() && panel.firstByteInSelection == panel.lastByteInSelection)
 			{
 				// Cannot delete if the cursor is at the end of the file and no text is selected
 				return false;
@@ -1514,31 +1488,10 @@ namespace MathAnim
 				return false;
 			}
 
-			// Count the number of lines in the text we're about to remove
-			uint32 numberLinesInString = 0;
-			for (int32 i = textToRemoveOffset; i < textToRemoveOffset + textToRemoveNumBytes; i++)
-			{
-				if (panel.visibleCharacterBuffer[i] == '\n')
-				{
-					numberLinesInString += 1;
-				}
-			}
-
-			size_t bytesToMoveOffset = textToRemoveOffset + textToRemoveNumBytes;
-			if (bytesToMoveOffset != panel.visibleCharacterBufferSize)
-			{
-				memmove(
-					(void*)(panel.visibleCharacterBuffer + textToRemoveOffset),
-					(void*)(panel.visibleCharacterBuffer + bytesToMoveOffset),
-					panel.visibleCharacterBufferSize - bytesToMoveOffset
-				);
-			}
-
-			panel.visibleCharacterBufferSize -= textToRemoveNumBytes;
-			panel.visibleCharacterBuffer = (uint8*)g_memory_realloc((void*)panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize);
+			TextEdit edit = panel.document.remove(textToRemoveOffset, textToRemoveNumBytes);
 
 			// Update total number of lines
-			panel.totalNumberLines -= numberLinesInString;
+			panel.totalNumberLines = (uint32)panel.document.getNumLines();
 
 			// If removing the text changed the scroll height, shift the scroll up to fit on the screen
 			if (panel.lineNumberStart + panel.numberLinesCanFitOnScreen > panel.totalNumberLines + numberBufferLines)
@@ -1554,10 +1507,8 @@ namespace MathAnim
 			size_t numberLinesToUpdate = panel.numberLinesCanFitOnScreen;
 			Vec2i linesUpdated = CodeEditorPanelManager::getHighlighter().removeText(
 				panel.syntaxHighlightTree,
-				(const char*)panel.visibleCharacterBuffer,
-				panel.visibleCharacterBufferSize,
-				textToRemoveOffset,
-				numberLinesInString,
+				panel.document,
+				edit,
 				numberLinesToUpdate
 			);
 
@@ -1590,7 +1541,7 @@ namespace MathAnim
 				// TODO: Add operator - to this iterator
 				auto newCursorPos = panel.cursor;
 				--newCursorPos;
-				return glm::clamp((int32)newCursorPos.bytePos, 0, (int32)panel.visibleCharacterBufferSize);
+				return glm::clamp((int32)newCursorPos.bytePos, 0, (int32)panel.document.getLength());
 			}
 
 			case KeyMoveDirection::Right:
@@ -1598,7 +1549,7 @@ namespace MathAnim
 				// TODO: Add operator + to this iterator
 				auto newCursorPos = panel.cursor;
 				++newCursorPos;
-				return glm::clamp((int32)newCursorPos.bytePos, 0, (int32)panel.visibleCharacterBufferSize);
+				return glm::clamp((int32)newCursorPos.bytePos, 0, (int32)panel.document.getLength());
 			}
 
 			case KeyMoveDirection::Up:
@@ -1615,7 +1566,7 @@ namespace MathAnim
 
 				int32 newPos = beginningOfLineAbove;
 				int32 numCharsCounted = 1;
-				for (auto tmpCursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, beginningOfLineAbove);
+				for (auto tmpCursor = panel.document.makeIter(beginningOfLineAbove);
 					tmpCursor.bytePos < beginningOfCurrentLine;
 					++tmpCursor)
 				{
@@ -1632,7 +1583,7 @@ namespace MathAnim
 					numCharsCounted++;
 				}
 
-				return glm::clamp(newPos, 0, (int32)panel.visibleCharacterBufferSize);
+				return glm::clamp(newPos, 0, (int32)panel.document.getLength());
 			}
 
 			case KeyMoveDirection::Down:
@@ -1642,18 +1593,18 @@ namespace MathAnim
 				int32 beginningOfLineBelow = endOfCurrentLine + 1;
 
 				// Only set the cursor to a new position if there is another line below the current line
-				if (beginningOfLineBelow > panel.visibleCharacterBufferSize)
+				if (beginningOfLineBelow > panel.document.getLength())
 				{
 					return (int32)panel.cursor.bytePos;
 				}
 
 				int32 numCharsCounted = 1;
 				int32 newPos = beginningOfLineBelow;
-				for (auto tmpCursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, beginningOfLineBelow);
-					tmpCursor.bytePos <= panel.visibleCharacterBufferSize;
+				for (auto tmpCursor = panel.document.makeIter(beginningOfLineBelow);
+					tmpCursor.bytePos <= panel.document.getLength();
 					++tmpCursor)
 				{
-					if (tmpCursor.bytePos == panel.visibleCharacterBufferSize || (*tmpCursor).value() == '\n')
+					if (tmpCursor.bytePos == panel.document.getLength() || *tmpCursor == '\n')
 					{
 						newPos = (int32)tmpCursor.bytePos;
 						break;
@@ -1667,18 +1618,18 @@ namespace MathAnim
 					numCharsCounted++;
 				}
 
-				return glm::clamp(newPos, 0, (int32)panel.visibleCharacterBufferSize);
+				return glm::clamp(newPos, 0, (int32)panel.document.getLength());
 			}
 
 			case KeyMoveDirection::LeftUntilBeginning:
 			{
 				int32 beginningOfCurrentLine = getBeginningOfLineFrom(panel, (int32)panel.cursor.bytePos);
 
-				for (auto tmpCursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, beginningOfCurrentLine);
-					tmpCursor.bytePos < panel.visibleCharacterBufferSize;
+				for (auto tmpCursor = panel.document.makeIter(beginningOfCurrentLine);
+					tmpCursor.bytePos < panel.document.getLength();
 					++tmpCursor)
 				{
-					uint32 c = (*tmpCursor).value();
+					uint32 c = *tmpCursor;
 					if (c == ' ' || c == '\t')
 					{
 						continue;
@@ -1704,7 +1655,7 @@ namespace MathAnim
 				int32 endOfCurrentLine = getEndOfLineFrom(panel, (int32)panel.cursor.bytePos);
 
 				// If we're at the end of the file, move all the way to the end
-				if (endOfCurrentLine == panel.visibleCharacterBufferSize - 1)
+				if (endOfCurrentLine == panel.document.getLength() - 1)
 				{
 					endOfCurrentLine++;
 				}
@@ -1717,27 +1668,30 @@ namespace MathAnim
 
 			case KeyMoveDirection::LeftUntilBoundary:
 			{
-				int32 startPos = glm::clamp((int32)panel.cursor.bytePos - 1, 0, (int32)panel.visibleCharacterBufferSize);
+				if (panel.cursor.bytePos == 0)
+				{
+					return 0;
+				}
 
-				uint8 c = panel.visibleCharacterBuffer[startPos];
+				uint8 c = panel.document.getByte(panel.cursor.bytePos - 1);
 				bool startedOnSkippableWhitespace = c == ' ' || c == '\t';
 				bool skippedAllWhitespace = false;
 				bool hitBoundaryCharacterButSkipped = false;
 
 				for (int32 i = (int32)panel.cursor.bytePos - 1; i >= 0; i--)
 				{
-					c = panel.visibleCharacterBuffer[i];
+					c = panel.document.getByte(i);
 
 					// Handle newlines
 					if (c == '\n' && i != panel.cursor.bytePos - 1)
 					{
-						return glm::clamp(i + 1, 0, (int32)panel.visibleCharacterBufferSize);
+						return glm::clamp(i + 1, 0, (int32)panel.document.getLength());
 					}
 
 					// Handle boundary characters
 					if (isBoundaryCharacter(c) && i != panel.cursor.bytePos - 1)
 					{
-						uint32 nextC = i + 1 < panel.visibleCharacterBufferSize ? panel.visibleCharacterBuffer[i + 1] : '\0';
+						uint32 nextC = i + 1 < panel.document.getLength() ? panel.document.getByte(i + 1) : '\0';
 						if (isBoundaryCharacter(nextC) || nextC == ' ' || nextC == '\t' || hitBoundaryCharacterButSkipped)
 						{
 							hitBoundaryCharacterButSkipped = true;
@@ -1745,12 +1699,12 @@ namespace MathAnim
 						}
 						else
 						{
-							return glm::clamp(i + 1, 0, (int32)panel.visibleCharacterBufferSize);
+							return glm::clamp(i + 1, 0, (int32)panel.document.getLength());
 						}
 					}
 					else if (!isBoundaryCharacter(c) && hitBoundaryCharacterButSkipped)
 					{
-						return glm::clamp(i + 1, 0, (int32)panel.visibleCharacterBufferSize);
+						return glm::clamp(i + 1, 0, (int32)panel.document.getLength());
 					}
 
 					// Handle skippable whitespace
@@ -1761,11 +1715,11 @@ namespace MathAnim
 					}
 					else if (startedOnSkippableWhitespace && skippedAllWhitespace && (c == ' ' || c == '\t'))
 					{
-						return glm::clamp(i + 1, 0, (int32)panel.visibleCharacterBufferSize);
+						return glm::clamp(i + 1, 0, (int32)panel.document.getLength());
 					}
 					else if (!startedOnSkippableWhitespace && (c == ' ' || c == '\t'))
 					{
-						return glm::clamp(i + 1, 0, (int32)panel.visibleCharacterBufferSize);
+						return glm::clamp(i + 1, 0, (int32)panel.document.getLength());
 					}
 				}
 
@@ -1774,14 +1728,19 @@ namespace MathAnim
 
 			case KeyMoveDirection::RightUntilBoundary:
 			{
-				uint8 c = panel.visibleCharacterBuffer[panel.cursor.bytePos];
+				if (panel.cursor.bytePos >= panel.document.getLength())
+				{
+					return (int32)panel.document.getLength();
+				}
+
+				uint8 c = panel.document.getByte(panel.cursor.bytePos);
 				bool startedOnSkippableWhitespace = c == ' ' || c == '\t';
 				bool skippedAllWhitespace = false;
 				bool hitBoundaryCharacterButSkipped = false;
 
-				for (int32 i = (int32)panel.cursor.bytePos; i < panel.visibleCharacterBufferSize; i++)
+				for (int32 i = (int32)panel.cursor.bytePos; i < panel.document.getLength(); i++)
 				{
-					c = panel.visibleCharacterBuffer[i];
+					c = panel.document.getByte(i);
 
 					// Handle newlines
 					if (c == '\n' && i != panel.cursor.bytePos)
@@ -1792,7 +1751,7 @@ namespace MathAnim
 					// Handle boundary characters
 					if (isBoundaryCharacter(c) && i != panel.cursor.bytePos)
 					{
-						uint32 prevC = i - 1 >= 0 ? panel.visibleCharacterBuffer[i - 1] : '\0';
+						uint32 prevC = i - 1 >= 0 ? panel.document.getByte(i - 1) : '\0';
 						if (isBoundaryCharacter(prevC) || prevC == ' ' || prevC == '\t' || hitBoundaryCharacterButSkipped)
 						{
 							hitBoundaryCharacterButSkipped = true;
@@ -1824,7 +1783,7 @@ namespace MathAnim
 					}
 				}
 
-				return (int32)panel.visibleCharacterBufferSize;
+				return (int32)panel.document.getLength();
 			}
 
 			}
@@ -1911,48 +1870,17 @@ namespace MathAnim
 				return 0;
 			}
 
-			auto tmpCursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, index);
-			if (tmpCursor.bytePos == panel.visibleCharacterBufferSize || (*tmpCursor).value() == (uint32)'\n')
-			{
-				--tmpCursor;
-			}
-
-			while (tmpCursor.bytePos != 0)
-			{
-				if ((*tmpCursor).value() == '\n')
-				{
-					++tmpCursor;
-					return (int32)tmpCursor.bytePos;
-				}
-				--tmpCursor;
-			}
-
-			return (int32)tmpCursor.bytePos;
+			return (int32)panel.document.getLineStart(panel.document.getLineFromByte(index));
 		}
 
 		static int32 getNumCharsFromBeginningOfLine(CodeEditorPanelData const& panel, int32 index)
 		{
-			if (index <= 0)
+			// This is 1-based, so the first character in a line is 1 character from the beginning of the line
+			int32 numChars = 1;
+			for (auto tmpCursor = panel.document.makeIter(getBeginningOfLineFrom(panel, index));
+				tmpCursor.bytePos < (size_t)glm::max(index, 0) && tmpCursor.bytePos < panel.document.getLength();
+				++tmpCursor)
 			{
-				return 0;
-			}
-
-			int32 numChars = 0;
-			auto tmpCursor = CppUtils::String::makeIterFromBytePos(panel.visibleCharacterBuffer, panel.visibleCharacterBufferSize, index);
-			if (tmpCursor.bytePos == panel.visibleCharacterBufferSize || (*tmpCursor).value() == (uint32)'\n')
-			{
-				--tmpCursor;
-				numChars++;
-			}
-
-			while (tmpCursor.bytePos != 0)
-			{
-				if ((*tmpCursor).value() == '\n')
-				{
-					return numChars;
-				}
-
-				--tmpCursor;
 				numChars++;
 			}
 
@@ -1961,17 +1889,14 @@ namespace MathAnim
 
 		static int32 getEndOfLineFrom(CodeEditorPanelData const& panel, int32 index)
 		{
-			int32 cursor = index;
-			while (cursor < panel.visibleCharacterBufferSize)
+			size_t line = panel.document.getLineFromByte(glm::max(index, 0));
+			if (line + 1 < panel.document.getNumLines())
 			{
-				if (panel.visibleCharacterBuffer[cursor] == '\n')
-				{
-					return cursor;
-				}
-				cursor++;
+				// The last byte in the line is the newline right before the next line starts
+				return (int32)panel.document.getLineStart(line + 1) - 1;
 			}
 
-			return cursor - 1;
+			return (int32)panel.document.getLength() - 1;
 		}
 
 		static void setCursorDistanceFromLineStart(CodeEditorPanelData& panel)
@@ -1982,40 +1907,17 @@ namespace MathAnim
 
 		static uint32 getLineNumberByteStartFrom(CodeEditorPanelData const& panel, uint32 lineNumber)
 		{
-			uint32 currentLine = 1;
-			for (uint32 i = 0; i < (uint32)panel.visibleCharacterBufferSize; i++)
+			if (lineNumber <= 1)
 			{
-				if (currentLine >= lineNumber)
-				{
-					return i;
-				}
-
-				if (panel.visibleCharacterBuffer[i] == '\n')
-				{
-					currentLine++;
-				}
+				return 0;
 			}
 
-			return (uint32)panel.visibleCharacterBufferSize;
+			return (uint32)panel.document.getLineStart(lineNumber - 1);
 		}
 
 		static uint32 getLineNumberFromPosition(CodeEditorPanelData const& panel, uint32 bytePos)
 		{
-			uint32 currentLine = 1;
-			for (uint32 i = 0; i < (uint32)panel.visibleCharacterBufferSize; i++)
-			{
-				if (i >= bytePos)
-				{
-					return currentLine;
-				}
-
-				if (panel.visibleCharacterBuffer[i] == '\n')
-				{
-					currentLine++;
-				}
-			}
-
-			return panel.totalNumberLines;
+			return (uint32)panel.document.getLineFromByte(bytePos) + 1;
 		}
 
 		static float calculateLeftGutterWidth(CodeEditorPanelData const& panel)
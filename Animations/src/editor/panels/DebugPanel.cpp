@@ -1,5 +1,6 @@
 #include "editor/panels/DebugPanel.h"
 #include "editor/panels/CodeEditorPanelManager.h"
+#include "editor/UndoSystem.h"
 #include "core.h"
 #include "core/Application.h"
 #include "svg/Svg.h"
@@ -7,6 +8,7 @@
 #include "renderer/Colors.h"
 #include "renderer/Texture.h"
 #include "renderer/Renderer.h"
+#include "renderer/Fonts.h"
 #include "animation/AnimationManager.h"
 
 namespace MathAnim
@@ -30,15 +32,35 @@ namespace MathAnim
 			ImGuiIO& io = ImGui::GetIO();
 
 			// Display SVG cache
+			SvgCache* svgCache = Application::getSvgCache();
+			{
+				const SvgCacheStats& cacheStats = svgCache->getStats();
+				uint64 numLookups = cacheStats.hits + cacheStats.misses;
+				float hitRate = numLookups > 0 ? (float)cacheStats.hits / (float)numLookups : 0.0f;
+				ImGui::Text("SVG Cache Hit Rate: %.2f%% (%llu hits, %llu misses, %llu evictions)",
+					hitRate * 100.0f,
+					(unsigned long long)cacheStats.hits,
+					(unsigned long long)cacheStats.misses,
+					(unsigned long long)cacheStats.evictions
+				);
+			}
+
 			if (ImGui::BeginTabBar("SVG Cache"))
 			{
-				SvgCache* svgCache = Application::getSvgCache();
 				const Framebuffer& framebuffer = svgCache->getFramebuffer();
 				for (size_t i = 0; i < framebuffer.colorAttachments.size(); i++)
 				{
 					std::string tabName = "CacheEntry_" + std::to_string(i);
 					if (ImGui::BeginTabItem(tabName.c_str()))
 					{
+						AtlasStats atlasStats = svgCache->getAtlasStats((int)i);
+						ImGui::Text("Occupancy: %.2f%%  Fragmentation: %.2f%%  Entries: %u  Free Regions: %u",
+							atlasStats.occupancy() * 100.0f,
+							atlasStats.fragmentation() * 100.0f,
+							atlasStats.numAllocations,
+							atlasStats.numFreeRegions
+						);
+
 						ImTextureID texId = (ImTextureID)(uint64)framebuffer.colorAttachments[i].graphicsId;
 						ImVec2 pos = ImGui::GetCursorScreenPos();
 						ImVec4 tintCol = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);   // No tint
@@ -110,13 +132,17 @@ namespace MathAnim
 				previousFrameTimesIndex = (previousFrameTimesIndex + 1) % previousFrameTimesLength;
 			}
 
+			ImGui::Text("GL Draw Calls: %d", Renderer::getNumGlDrawCalls());
+			ImGui::Text("Bytes Uploaded: %2.3fKB", (float)Renderer::getNumBytesUploaded() / 1024.0f);
+			ImGui::Text("Glyphs Rasterized: %d (%llu total)", Fonts::getNumGlyphsRasterizedLastFrame(), (unsigned long long)Fonts::getTotalNumGlyphsRasterized());
+
 			// Draw call breakdown
-			if (ImGui::TreeNodeEx("###DrawCallBreakdown_Tab", ImGuiTreeNodeFlags_FramePadding, "Num Draw Calls: %d", Renderer::getTotalNumDrawCalls()))
+			if (ImGui::TreeNodeEx("###DrawCallBreakdown_Tab", ImGuiTreeNodeFlags_FramePadding, "Num Draw Commands: %d", Renderer::getTotalNumDrawCalls()))
 			{
 				if (ImGui::BeginTable("##DrawCallBreakdown", 2, ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_Borders))
 				{
 					ImGui::TableSetupColumn("Draw List Type");
-					ImGui::TableSetupColumn("# of Draw Calls");
+					ImGui::TableSetupColumn("# of Draw Commands");
 					ImGui::TableHeadersRow();
 
 					ImGui::TableNextColumn();
@@ -199,6 +225,12 @@ namespace MathAnim
 				AnimationManager::setRenderAllBoundingBoxes(am, drawAllBoundingBoxes);
 			}
 
+			if (ImGui::TreeNodeEx("###UndoHistory_Tab", ImGuiTreeNodeFlags_FramePadding, "Undo History"))
+			{
+				UndoSystem::imguiStats(Application::getUndoSystem());
+				ImGui::TreePop();
+			}
+
 			{
 				CodeEditorPanelManager::imguiStats();
 			}
@@ -94,7 +94,11 @@ namespace MathAnim
 				ImGui::Indent(indentationDepth);
 				if (!isNull(activeAnimationId))
 				{
-					handleAnimationInspector(am, activeAnimationId);
+					bool anyAnimationPropertyChanged = handleAnimationInspector(am, activeAnimationId);
+					if (anyAnimationPropertyChanged)
+					{
+						AnimationManager::invalidateAnimation(am, activeAnimationId);
+					}
 				}
 				ImGui::Unindent(indentationDepth);
 			}
@@ -2046,17 +2050,14 @@ namespace MathAnim
 						}
 					}
 
-					// Copy the svgObjectStart to all the svgObjects to any generated children
+					// Point all the generated children back at their start svg
 					// to make sure that they render properly
 					for (auto childId : obj->generatedChildrenIds)
 					{
 						AnimObject* child = AnimationManager::getMutableObject(am, childId);
 						if (child)
 						{
-							if (child->_svgObjectStart)
-							{
-								Svg::copy(child->svgObject, child->_svgObjectStart);
-							}
+							child->resetSvgObject();
 						}
 					}
 				}
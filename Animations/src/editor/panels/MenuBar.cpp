@@ -48,6 +48,11 @@ namespace MathAnim
 						g_logger_warning("TODO: Implement open project menu bar item");
 					}
 
+					if (ImGui::MenuItem("Export Scene as JSON"))
+					{
+						Application::exportCurrentSceneAsJson();
+					}
+
 					ImGui::Separator();
 
 					if (ImGui::MenuItem("Save Editor Layout"))
@@ -697,7 +697,7 @@ namespace MathAnim
 
 			if (childAnimObj && parentAnimObj)
 			{
-				childAnimObj->parentId = parent.animObjectId;
+				AnimationManager::setParent(am, childAnimObj->id, parent.animObjectId);
 				// TODO: This should automatically get updated since objects store local and absolute transformations
 				// but double check that it works alright
 				// 
@@ -744,7 +744,7 @@ namespace MathAnim
 					// 	Transform::createTransform();
 
 					updateLevel(treeToMove.index, placeToMoveTo.level);
-					treeToMoveObj->parentId = placeToMoveToObj->parentId;
+					AnimationManager::setParent(am, treeToMoveObj->id, placeToMoveToObj->parentId);
 					// TODO: Should be fine, see TODO above
 					// treeToMoveObj.localPosition = treeToMoveTransform.position - newParentTransform.position;
 				}
@@ -1,6 +1,7 @@
 #include "editor/timeline/ImGuiTimeline.h"
 #include "editor/imgui/ImGuiLayer.h"
 #include "renderer/Colors.h"
+#include "audio/WaveformPyramid.h"
 
 #include "imgui.h"
 #include "utils/FontAwesome.h"
@@ -111,10 +112,6 @@ namespace MathAnim
 	static ImVec2 canvasSize;
 	static ImVec2 legendSize;
 
-	static ImVec2* audioCache = nullptr;
-	static int lengthAudioCache = 0;
-	static int maxLengthAudioCache = 0;
-
 	static ImGuiID activeSegmentID = UINT32_MAX;
 
 	// ----------- Internal Functions -----------
@@ -128,7 +125,6 @@ namespace MathAnim
 	static void snapToCursor(int* currentFrame, int* firstFrame, int* segmentFrameStart, int* segmentFrameDuration, float* offsetX, float* width, float amountOfTimeVisibleInTimeline, SegmentChangeType changeType);
 	static void snapToPreviousSegment(int* firstFrame, float* offsetX, int* segmentFrameStart, int* segmentFrameDuration, int lastSegmentFrameStart, int lastSegmentFrameDuration, SegmentChangeType changeType, float amountOfTimeVisibleInTimeline);
 	static void snapToNextSegment(int* firstFrame, float* offsetX, float* width, int* segmentFrameStart, int* segmentFrameDuration, int nextSegmentFrameStart, int nextSegmentFrameDuration, SegmentChangeType changeType, float amountOfTimeVisibleInTimeline);
-	static void checkAudioCacheResize(int numElementsToAdd);
 
 	static inline float calculateSegmentOffset(int segmentFrameStart, int firstFrame, float amountOfTimeVisibleInTimeline)
 	{
@@ -570,172 +566,52 @@ namespace MathAnim
 			// 60 FPS
 			float amountOfSecondsVisibleInTimeline = amountOfTimeVisibleInTimeline / 60.0f;
 			float currentSecond = (float)(*firstFrame) / 60.0f;
-			// The divide by blockAlignment * blockAlignment makes sure we're properly byte aligned
-			uint32 firstSampleByte = (uint32)(((float)audioData->bytesPerSec * currentSecond) / (float)audioData->blockAlignment) * (uint32)(audioData->blockAlignment);
-			uint32 bytesPerSample = audioData->bitsPerSample / 8;
-			uint32 numBytesVisible = (uint32)((float)audioData->bytesPerSec * amountOfSecondsVisibleInTimeline);
-			uint32 end = glm::min(firstSampleByte + numBytesVisible, audioData->dataSize);
-			g_logger_assert(bytesPerSample == 1 || bytesPerSample == 2, "Need 1 or 2 bytes per sample for audio data. Instead got '{}' bytes per sample", bytesPerSample);
-
-			constexpr float distanceBetweenLineSegments = 1.0f;
-			// TODO: Make this configurable
-			constexpr float amplitudeAdjustment = 1.3f;
-			float amtTimeVisibleInLineSegment = amountOfSecondsVisibleInTimeline * (distanceBetweenLineSegments / (timelineRulerEnd.x - timelineRulerBegin.x));
-			uint32 numBytesVisibleInLineSegment = (uint32)((float)amtTimeVisibleInLineSegment * (float)audioData->bytesPerSec);
-
-			ImVec2 lastMaxSegmentPos = ImVec2(0.0f, (float)trackHeight / 2.0f);
-			ImVec2 lastMinSegmentPos = lastMaxSegmentPos;
+			float audioTrackWidth = timelineRulerEnd.x - timelineRulerBegin.x;
+			ImVec2 audioTrackPos = (canvasPos + canvasSize) - ImVec2(audioTrackWidth, (float)trackHeight);
 
 			// Draw background for the audio track preview
 			drawList->AddRectFilled(
-				canvasPos + canvasSize - ImVec2(timelineRulerEnd.x - timelineRulerBegin.x, (float)trackHeight),
+				audioTrackPos,
 				canvasPos + canvasSize,
 				canvasColor
 			);
 
-			// TODO: Spreading out the processing of audio data is pretty complex
-			// maybe I should come up with some sort of multithreading promise system?
-			// That way I could process in the background and when the promise is ready
-			// switch to the new cache
-			static int cachedFirstFrame = -1;
-			static float cachedZoomLevel = -1.0f;
-			static float cachedAmtTimeVisibleInTimeline = -1.0f;
-			static bool isProcessingAudioWaveform = false;
-			static ImVec2 lastMaxSegmentPosPrevFrame;
-			static ImVec2 lastMinSegmentPosPrevFrame;
-			static uint32 byteFromLastFrame;
-			bool firstLine = !isProcessingAudioWaveform;
-
-			if (cachedFirstFrame != *firstFrame || cachedZoomLevel != *zoom || cachedAmtTimeVisibleInTimeline != amountOfTimeVisibleInTimeline)
+			// The waveform gets built in the background when the audio is loaded, until
+			// then there's just nothing to draw
+			if (audioData->waveform != nullptr && audioTrackWidth > 0.0f)
 			{
-				isProcessingAudioWaveform = true;
-				cachedFirstFrame = *firstFrame;
-				cachedAmtTimeVisibleInTimeline = amountOfTimeVisibleInTimeline;
-				cachedZoomLevel = *zoom;
-				lengthAudioCache = 0;
-				byteFromLastFrame = firstSampleByte;
-			}
-			else if (isProcessingAudioWaveform)
-			{
-				lastMaxSegmentPos = lastMaxSegmentPosPrevFrame;
-				lastMinSegmentPos = lastMinSegmentPosPrevFrame;
-			}
-
-			if (isProcessingAudioWaveform)
-			{
-				bool processedAllData = true;
-
-				// When we cache the data, if there's a lot of audio to process
-				// spread the processing over a few frames to minimize lag
-				constexpr int maxBytesToProcessInOneFrame = 500'000;
-				int numBytesProcessed = 0;
-
-				// Average the sound samples over the preview period and cache the results
-				for (uint32 byte = byteFromLastFrame; byte < end; byte += audioData->blockAlignment)
+				// TODO: Make this configurable
+				constexpr float amplitudeAdjustment = 1.3f;
+				const WaveformPyramid& waveform = *audioData->waveform;
+				double samplesPerPixel = (double)amountOfSecondsVisibleInTimeline * (double)audioData->sampleRate / (double)audioTrackWidth;
+				double firstVisibleSample = (double)currentSecond * (double)audioData->sampleRate;
+				float waveformHeight = (float)trackHeight / 1.2f;
+
+				// Each pixel only looks at the handful of buckets under it, so this is the same
+				// amount of work no matter how long the track is or how far out it's zoomed
+				const WaveformLevel* level = Waveform::chooseLevel(waveform, samplesPerPixel);
+				int numPixels = (int)audioTrackWidth;
+				for (int pixel = 0; level != nullptr && pixel < numPixels; pixel++)
 				{
-					uint32 endByte = glm::min(byte + numBytesVisibleInLineSegment, audioData->dataSize);
-					float maxSample = 0.0f;
-					float minSample = 0.0f;
-					for (; byte < endByte; byte += audioData->blockAlignment)
+					double pixelStart = firstVisibleSample + (double)pixel * samplesPerPixel;
+					if (pixelStart >= (double)waveform.numSamples)
 					{
-						int16 sample = bytesPerSample == 1
-							? (int16)(audioData->data[byte])
-							: *(int16*)(&audioData->data[byte]);
-						float normalizedSample = (float)(sample) / (float)(INT16_MAX);
-						maxSample = glm::max(maxSample, normalizedSample);
-						minSample = glm::min(normalizedSample, minSample);
-
-						numBytesProcessed += audioData->blockAlignment;
+						break;
 					}
 
-					maxSample = glm::clamp(amplitudeAdjustment * maxSample, 0.0f, 1.0f);
-					minSample = glm::clamp(amplitudeAdjustment * minSample, -1.0f, 0.0f);
+					WaveformBucket bucket = Waveform::getRange(*level, (uint64)pixelStart, (uint64)(pixelStart + samplesPerPixel));
+					float maxSample = glm::clamp(amplitudeAdjustment * (float)bucket.max / (float)INT16_MAX, 0.0f, 1.0f);
+					float minSample = glm::clamp(amplitudeAdjustment * (float)bucket.min / (float)INT16_MAX, -1.0f, 0.0f);
 
 					maxSample = 1.0f - ((maxSample + 1.0f) / 2.0f);
 					minSample = 1.0f - ((minSample + 1.0f) / 2.0f);
 
-					// Draw the line segment
-					ImVec2 nextMaxPos = ImVec2(lastMaxSegmentPos.x + distanceBetweenLineSegments, maxSample * (trackHeight / 1.2f));
-					ImVec2 nextMinPos = ImVec2(lastMinSegmentPos.x + distanceBetweenLineSegments, minSample * (trackHeight / 1.2f));
-					if (firstLine)
-					{
-						lastMaxSegmentPos.y = nextMaxPos.y;
-						lastMinSegmentPos.y = nextMinPos.y;
-						firstLine = false;
-					}
-
-					// Get all the points necessary to fill the shape
-					float baselineY = ((trackHeight / 1.2f) / 2.0f);
-					// Draw max waveform point triangles
-					{
-						ImVec2 p1 = lastMaxSegmentPos;
-						ImVec2 p2 = nextMaxPos;
-						if (p1.y < baselineY && p2.y < baselineY && !glm::epsilonEqual(p1.y, baselineY, 1.0f) && !glm::epsilonEqual(p2.y, baselineY, 1.0f))
-						{
-							ImVec2 p0 = ImVec2(lastMaxSegmentPos.x, baselineY);
-							ImVec2 p3 = ImVec2(nextMaxPos.x, baselineY);
-
-							checkAudioCacheResize(6);
-							audioCache[lengthAudioCache + 0] = p0;
-							audioCache[lengthAudioCache + 1] = p1;
-							audioCache[lengthAudioCache + 2] = p2;
-
-							audioCache[lengthAudioCache + 3] = p0;
-							audioCache[lengthAudioCache + 4] = p2;
-							audioCache[lengthAudioCache + 5] = p3;
-							lengthAudioCache += 6;
-						}
-					}
-					// Draw min waveform point triangles
-					{
-						ImVec2 p1 = lastMinSegmentPos;
-						ImVec2 p2 = nextMinPos;
-						if (p1.y > baselineY && p2.y > baselineY && !glm::epsilonEqual(p1.y, baselineY, 1.0f) && !glm::epsilonEqual(p2.y, baselineY, 1.0f))
-						{
-							ImVec2 p0 = ImVec2(lastMinSegmentPos.x, baselineY);
-							ImVec2 p3 = ImVec2(nextMinPos.x, baselineY);
-
-							checkAudioCacheResize(6);
-							audioCache[lengthAudioCache + 0] = p2;
-							audioCache[lengthAudioCache + 1] = p1;
-							audioCache[lengthAudioCache + 2] = p0;
-
-							audioCache[lengthAudioCache + 3] = p3;
-							audioCache[lengthAudioCache + 4] = p2;
-							audioCache[lengthAudioCache + 5] = p0;
-							lengthAudioCache += 6;
-						}
-					}
-
-					// Keep track of the last points
-					lastMaxSegmentPos = nextMaxPos;
-					lastMinSegmentPos = nextMinPos;
-
-					if (numBytesProcessed >= maxBytesToProcessInOneFrame)
-					{
-						lastMaxSegmentPosPrevFrame = lastMaxSegmentPos;
-						lastMinSegmentPosPrevFrame = lastMinSegmentPos;
-						processedAllData = false;
-						byteFromLastFrame = byte + audioData->blockAlignment;
-						break;
-					}
+					drawList->AddRectFilled(
+						audioTrackPos + ImVec2((float)pixel, maxSample * waveformHeight),
+						audioTrackPos + ImVec2((float)pixel + 1.0f, minSample * waveformHeight),
+						audioWaveformColor
+					);
 				}
-
-				isProcessingAudioWaveform = !processedAllData;
-			}
-
-			// Draw the cache 
-			// TODO: I'm not sure if it looks cool or weird drawing the half-cached audio data
-			// Should we display a loading screen here instead while it's loading the cache?
-			ImVec2 audioTrackPos = (canvasPos + canvasSize) - ImVec2(timelineRulerEnd.x - timelineRulerBegin.x, trackHeight);
-			for (int audioi = 0; audioi < lengthAudioCache - 3; audioi++)
-			{
-				drawList->AddTriangleFilled(
-					audioTrackPos + audioCache[audioi],
-					audioTrackPos + audioCache[audioi + 1],
-					audioTrackPos + audioCache[audioi + 2],
-					audioWaveformColor
-				);
 			}
 		}
 		// ---------------------- End Draw Preview Audio Waveform ------------------------------
@@ -1059,14 +935,6 @@ namespace MathAnim
 
 	void ImGuiTimeline_free()
 	{
-		if (audioCache != nullptr)
-		{
-			g_memory_free(audioCache);
-			audioCache = nullptr;
-		}
-
-		maxLengthAudioCache = 0;
-		lengthAudioCache = 0;
 	}
 
 	static bool handleResizeElement(float* currentValue, DragState* state, const ImVec2& valueBounds, const ImVec2& mouseBounds, const ImVec2& hoverRectStart, const ImVec2& hoverRectEnd, ResizeFlags flags)
@@ -1437,27 +1305,4 @@ namespace MathAnim
 			}
 		}
 	}
-
-	static void checkAudioCacheResize(int numElementsToAdd)
-	{
-		if (numElementsToAdd + lengthAudioCache >= maxLengthAudioCache)
-		{
-			if (maxLengthAudioCache == 0)
-			{
-				maxLengthAudioCache = numElementsToAdd;
-			}
-
-			maxLengthAudioCache *= 2;
-			if (audioCache != nullptr)
-			{
-				audioCache = (ImVec2*)g_memory_realloc(audioCache, sizeof(ImVec2) * maxLengthAudioCache);
-			}
-			else
-			{
-				audioCache = (ImVec2*)g_memory_allocate(sizeof(ImVec2) * maxLengthAudioCache);
-			}
-
-			g_logger_assert(audioCache != nullptr, "Ran out of RAM.");
-		}
-	}
 }
\ No newline at end of file
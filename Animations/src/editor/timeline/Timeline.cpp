@@ -8,6 +8,8 @@
 #include "animation/AnimationManager.h"
 #include "audio/Audio.h"
 #include "audio/WavLoader.h"
+#include "audio/WaveformPyramid.h"
+#include "multithreading/GlobalThreadPool.h"
 
 #include <imgui.h>
 #define IMGUI_DEFINE_MATH_OPERATORS
@@ -25,9 +27,12 @@ namespace MathAnim
 		static AudioSource audioSource;
 		static WavData audioData;
 		static ImGuiTimeline_AudioData imguiAudioData;
+		static WaveformPyramid waveform;
+		static TaskHandle<WaveformPyramid> waveformTask;
 
 		// ------- Internal Functions --------
 		static void loadAudioSource(const char* filepath);
+		static void freeAudioSource();
 
 		static ImGuiTimeline_Track createDefaultTrack(char* trackName = nullptr);
 		static void freeTrack(ImGuiTimeline_Track& track, AnimationManagerData* am);
@@ -79,24 +84,37 @@ namespace MathAnim
 				{
 					flags |= ImGuiTimelineFlags_FollowTimelineCursor;
 
-					if (!Audio::isNull(audioSource) && !audioSource.isPlaying)
+					if (!Audio::isNull(audioSource) && !Audio::isPlaying(audioSource))
 					{
 						float offset = 0.0f;
 						if (timelineData.currentFrame > 0)
 						{
 							offset = timelineData.currentFrame / 60.0f;
 						}
-						Audio::play(audioSource, offset);
+
+						// Once the audio has played to the end, leave it stopped instead of restarting it every frame
+						float durationInSeconds = (float)(audioData.dataSize / audioData.blockAlignment) / (float)audioData.sampleRate;
+						if (offset < durationInSeconds)
+						{
+							Audio::play(audioSource, offset);
+						}
 					}
 				}
 				else
 				{
-					if (!Audio::isNull(audioSource) && audioSource.isPlaying)
+					if (!Audio::isNull(audioSource) && Audio::isPlaying(audioSource))
 					{
 						Audio::stop(audioSource);
 					}
 				}
 
+				if (waveformTask.isReady())
+				{
+					waveform = waveformTask.get();
+					waveformTask = {};
+					imguiAudioData.waveform = &waveform;
+				}
+
 				ImGuiTimeline_AudioData* imguiAudioDataPtr = Audio::isNull(audioSource)
 					? nullptr
 					: &imguiAudioData;
@@ -112,6 +130,11 @@ namespace MathAnim
 
 				if (res.flags & ImGuiTimelineResultFlags_CurrentFrameChanged)
 				{
+					// Seeking the stream only refills a few small buffers, so the audio can follow the cursor
+					if (!Audio::isNull(audioSource) && Audio::isPlaying(audioSource) && timelineData.currentFrame != Application::getFrameIndex())
+					{
+						Audio::play(audioSource, timelineData.currentFrame / 60.0f);
+					}
 					Application::setFrameIndex(timelineData.currentFrame);
 				}
 
@@ -143,8 +166,7 @@ namespace MathAnim
 
 				if (res.flags & ImGuiTimelineResultFlags_DeleteAudioSource)
 				{
-					Audio::free(audioSource);
-					WavLoader::free(audioData);
+					freeAudioSource();
 					timelineData.audioSourceFile = (uint8*)g_memory_realloc(timelineData.audioSourceFile, sizeof(uint8));
 					timelineData.audioSourceFile[0] = '\0';
 					timelineData.audioSourceFileLength = 0;
@@ -341,8 +363,7 @@ namespace MathAnim
 				g_memory_free(tracks);
 			}
 
-			Audio::free(audioSource);
-			WavLoader::free(audioData);
+			freeAudioSource();
 			ImGuiTimeline_free();
 		}
 
@@ -407,22 +428,26 @@ namespace MathAnim
 		// ------- Internal Functions --------
 		static void loadAudioSource(const char* filepath)
 		{
-			Audio::free(audioSource);
-			WavLoader::free(audioData);
+			freeAudioSource();
 			audioData = WavLoader::loadWavFile(filepath);
-			audioSource = Audio::loadWavFile(audioData);
+			audioSource = Audio::openWavStream(audioData);
 
 			// TODO: Popup an error if loading fails to let the user know
 			if (!Audio::isNull(audioSource))
 			{
 				// Copy data to imgui struct if success
-				imguiAudioData.bitsPerSample = audioData.bitsPerSample;
-				imguiAudioData.blockAlignment = audioData.blockAlignment;
-				imguiAudioData.bytesPerSec = audioData.bytesPerSec;
-				imguiAudioData.data = audioData.audioData;
-				imguiAudioData.dataSize = audioData.dataSize;
-				imguiAudioData.numAudioChannels = audioData.audioChannelType == AudioChannelType::Dual ? 2 : 1;
 				imguiAudioData.sampleRate = audioData.sampleRate;
+				imguiAudioData.waveform = nullptr;
+
+				// Long tracks take a moment to summarize, so the timeline draws without a
+				// waveform until this finishes. The samples stay alive until freeAudioSource
+				// waits on this task.
+				WavData wav = audioData;
+				waveformTask = Application::threadPool()->submit(
+					[wav]() { return Waveform::build(wav); },
+					"BuildAudioWaveform",
+					Priority::Low
+				);
 			}
 			else
 			{
@@ -430,6 +455,19 @@ namespace MathAnim
 			}
 		}
 
+		static void freeAudioSource()
+		{
+			// The waveform task reads straight from the wav samples
+			waveformTask.cancel();
+			waveformTask.wait();
+			waveformTask = {};
+			waveform = {};
+			imguiAudioData.waveform = nullptr;
+
+			Audio::free(audioSource);
+			WavLoader::free(audioData);
+		}
+
 		static ImGuiTimeline_Track createDefaultTrack(char* inTrackName)
 		{
 			ImGuiTimeline_Track defaultTrack;
@@ -4,9 +4,19 @@
 #include "multithreading/GlobalThreadPool.h"
 #include "core/Profiling.h"
 
-static const char preamble[] = \
-R"raw(\documentclass[preview]{standalone}
+static const char documentClass[] = "\\documentclass[preview]{standalone}\n";
+static constexpr size_t documentClassLength = sizeof(documentClass) - 1;
+
+// Batches put every expression in its own mathanimpage environment, which standalone
+// crops to a separate page. dvisvgm then writes each page to its own svg.
+static const char batchDocumentClass[] = \
+R"raw(\documentclass[preview, multi=mathanimpage]{standalone}
+\newenvironment{mathanimpage}{}{}
+)raw";
+static constexpr size_t batchDocumentClassLength = sizeof(batchDocumentClass) - 1;
 
+static const char preamble[] = \
+R"raw(
 \usepackage[english]{babel}
 \usepackage[utf8]{inputenc}
 \usepackage[T1]{fontenc}
@@ -33,6 +43,12 @@ R"raw(\documentclass[preview]{standalone}
 )raw";
 static constexpr size_t preambleLength = sizeof(preamble) - 1;
 
+static const char beginPage[] = "\n\\begin{mathanimpage}";
+static constexpr size_t beginPageLength = sizeof(beginPage) - 1;
+
+static const char endPage[] = "\n\\end{mathanimpage}\n";
+static constexpr size_t endPageLength = sizeof(endPage) - 1;
+
 static const char beginAlign[] = "\n\\begin{align*}";
 static constexpr size_t beginAlignLength = sizeof(beginAlign) - 1;
 
@@ -46,13 +62,45 @@ namespace MathAnim
 {
 	namespace LaTexLayer
 	{
-		struct LaTexTask
+		enum class LaTexStatus : uint8
 		{
-			char* laTex;
+			Queued,
+			Ready,
+			Failed
+		};
+
+		struct LaTexSource
+		{
+			std::string latex;
+			std::string md5;
 			bool isMathTex;
+			// Set when this expression was part of a batch that failed, so
+			// it gets compiled on its own to find out if it's the culprit
+			bool compileAlone;
+		};
+
+		struct LaTexCallbackData
+		{
+			LaTexCallback callback;
+			void* userData;
+		};
+
+		struct LaTexJob
+		{
+			uint64 id;
+			// Jobs from before the last free() get skipped
+			uint64 generation;
+			std::vector<LaTexSource> sources;
+			std::vector<bool> succeeded;
+			bool batchFailed;
 		};
 
 		// ----------- Internal variables ----------- 
+		// Most expressions compile in well under a second, so batching a few dozen of them
+		// together saves a lot of latex startup time without making any one job too slow
+		static constexpr int MAX_BATCH_SIZE = 32;
+		static constexpr int MAX_CONCURRENT_JOBS = 8;
+
 		static bool latexIsInstalled;
 		static char latexInstallLocation[MATH_ANIMATIONS_MAX_PATH];
 		static char latexProgram[MATH_ANIMATIONS_MAX_PATH];
@@ -68,14 +116,31 @@ namespace MathAnim
 		static const char* dvisvgmExeName = "miktex-dvisvgm";
 #endif
 
-		static std::mutex latexQueueMutex;
+		// Guards everything below
+		static std::mutex latexMutex;
 		static std::unordered_map<std::string, std::string> latexCachedMd5;
-		static std::queue<LaTexTask*> queuedLatex;
-		static LaTexTask* latexInProgress;
+		// Keyed by md5, this is the in-memory index of every expression we know about
+		static std::unordered_map<std::string, LaTexStatus> latexStatus;
+		static std::unordered_map<std::string, std::vector<LaTexCallbackData>> latexCallbacks;
+		static std::deque<LaTexSource> queuedLatex;
+		static int numJobsInFlight;
+		static int maxConcurrentJobs;
+		static uint64 nextJobId;
+		// Jobs whose task hasn't returned yet. Unlike numJobsInFlight this doesn't wait for the
+		// finished callback, which only runs once the main thread gets around to it.
+		static int numJobsRunning;
+		static std::condition_variable jobsFinishedCv;
+		static uint64 jobGeneration;
 
 		// ----------- Internal functions ----------- 
-		static bool generateSvgFile(const std::string& filename, const std::string& latex, bool isMathTex);
-		static void generateSvgTask(void* data, size_t dataSize);
+		static std::string getLaTexMd5Unlocked(const std::string& latex);
+		static bool isValidMathTex(const std::string& latex);
+		static void writeLaTexBody(FILE* fp, const LaTexSource& source);
+		static bool compileSingle(const std::filesystem::path& jobDir, const LaTexSource& source);
+		static bool compileBatch(const std::filesystem::path& jobDir, const std::vector<LaTexSource>& sources);
+		static void compileJob(LaTexJob* job);
+		static void compileJobTask(void* data, size_t dataSize);
+		static void compileJobFinished(void* data, size_t dataSize);
 
 		void init()
 		{
@@ -143,28 +208,66 @@ namespace MathAnim
 			}
 
 			Platform::createDirIfNotExists("latex");
+			std::filesystem::remove_all("latex/tmp");
+
+			// Each job blocks a thread pool thread while latex runs, so leave some for everything else
+			maxConcurrentJobs = glm::clamp((int)std::thread::hardware_concurrency() / 2, 1, MAX_CONCURRENT_JOBS);
+			numJobsInFlight = 0;
+			nextJobId = 0;
 		}
 
-		void laTexToSvg(const char* latexRaw, bool isMathTex)
+		void laTexToSvg(const char* latexRaw, bool isMathTex, LaTexCallback callback, void* userData)
 		{
 			if (!latexIsInstalled)
 			{
 				g_logger_error("Cannot parse LaTeX. No LaTeX program found on the system.");
+				if (callback)
+				{
+					callback(std::string(latexRaw), false, userData);
+				}
 				return;
 			}
 
 			std::string latex = std::string(latexRaw);
-			if (!laTexIsReady(latex))
+			if (laTexIsReady(latex))
 			{
-				LaTexTask* taskData = (LaTexTask*)g_memory_allocate(sizeof(LaTexTask));
-				taskData->laTex = (char*)g_memory_allocate(sizeof(char) * latex.length() + 1);
-				g_memory_copyMem(taskData->laTex, sizeof(char) * latex.length() + 1, (void*)latex.c_str(), sizeof(char) * latex.length());
-				taskData->laTex[latex.length()] = '\0';
-				taskData->isMathTex = isMathTex;
+				if (callback)
+				{
+					callback(latex, true, userData);
+				}
+				return;
+			}
 
-				std::lock_guard<std::mutex> lock(latexQueueMutex);
-				queuedLatex.push(taskData);
+			if (isMathTex && !isValidMathTex(latex))
+			{
+				{
+					std::lock_guard<std::mutex> lock(latexMutex);
+					latexStatus[getLaTexMd5Unlocked(latex)] = LaTexStatus::Failed;
+				}
+
+				if (callback)
+				{
+					callback(latex, false, userData);
+				}
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(latexMutex);
+			std::string md5 = getLaTexMd5Unlocked(latex);
+			if (callback)
+			{
+				latexCallbacks[md5].push_back({ callback, userData });
+			}
+
+			// If the same expression is already queued, it'll notify every callback when it's done
+			auto statusIter = latexStatus.find(md5);
+			if (statusIter != latexStatus.end() && statusIter->second == LaTexStatus::Queued)
+			{
+				return;
 			}
+
+			latexStatus[md5] = LaTexStatus::Queued;
+			queuedLatex.push_back({ latex, md5, isMathTex, false });
 		}
 
 		bool laTexIsReady(const char* latexRaw, bool)
@@ -181,11 +284,24 @@ namespace MathAnim
 				return false;
 			}
 
-			// Md5 the latex to get a re-generatable filename
-			std::string filename = Platform::md5FromString(latex);
-			std::string svgFullpath = "latex/" + filename + ".svg";
+			std::lock_guard<std::mutex> lock(latexMutex);
+			std::string md5 = getLaTexMd5Unlocked(latex);
+			auto iter = latexStatus.find(md5);
+			if (iter != latexStatus.end())
+			{
+				return iter->second == LaTexStatus::Ready;
+			}
+
+			// Only hit the filesystem the first time we see an expression, it may have been
+			// compiled in a previous session
+			std::string svgFullpath = "latex/" + md5 + ".svg";
+			if (Platform::fileExists(svgFullpath.c_str()))
+			{
+				latexStatus[md5] = LaTexStatus::Ready;
+				return true;
+			}
 
-			return Platform::fileExists(svgFullpath.c_str());
+			return false;
 		}
 
 		std::string getLaTexMd5(const char* latexRaw)
@@ -196,126 +312,144 @@ namespace MathAnim
 
 		std::string getLaTexMd5(const std::string& latex)
 		{
-			auto iter = latexCachedMd5.find(latex);
-			if (iter != latexCachedMd5.end())
-			{
-				return iter->second;
-			}
-
-			std::string md5 = Platform::md5FromString(latex);
-			latexCachedMd5[latex] = md5;
-			return md5;
+			std::lock_guard<std::mutex> lock(latexMutex);
+			return getLaTexMd5Unlocked(latex);
 		}
 
 		void update()
 		{
 			MP_PROFILE_EVENT("LaTexLayer_Update");
 
-			std::lock_guard<std::mutex> lock(latexQueueMutex);
-
-			// This loop ensures that only one LaTex file gets processed at a time so
-			// that our application doesn't spawn a bunch of process asynchronously and
-			// make everything super slow
+			std::lock_guard<std::mutex> lock(latexMutex);
 
-			// First check if the last task that was being processed
-			// has finished and free memory if it has
-			if (queuedLatex.size() > 0)
+			// Split whatever is queued evenly between the free job slots. Each job is one latex
+			// process, so a big project gets compiled by a handful of batches in parallel instead
+			// of hundreds of processes one after another.
+			while (queuedLatex.size() > 0 && numJobsInFlight < maxConcurrentJobs)
 			{
-				if (queuedLatex.front() != nullptr && queuedLatex.front()  == latexInProgress)
+				int freeJobSlots = maxConcurrentJobs - numJobsInFlight;
+				size_t batchSize = (queuedLatex.size() + freeJobSlots - 1) / freeJobSlots;
+				batchSize = glm::clamp(batchSize, (size_t)1, (size_t)MAX_BATCH_SIZE);
+
+				LaTexJob* job = g_memory_new LaTexJob();
+				job->id = nextJobId++;
+				job->generation = jobGeneration;
+				job->batchFailed = false;
+				while (queuedLatex.size() > 0 && job->sources.size() < batchSize)
 				{
-					// If the current item hasn't finished
-					// processing, then wait until it's done
-					// before processing more queued items
-					if (!laTexIsReady(latexInProgress->laTex))
+					const LaTexSource& next = queuedLatex.front();
+					// Expressions that have to compile alone never share a job
+					if (job->sources.size() > 0 && next.compileAlone)
 					{
-						return;
+						break;
 					}
 
-					// Free the task and pop it from our queue
-					g_logger_info("Finished processing LaTex: '{}'", latexInProgress->laTex);
-					g_memory_free(queuedLatex.front()->laTex);
-					g_memory_free(queuedLatex.front());
-					queuedLatex.pop();
+					job->sources.push_back(next);
+					queuedLatex.pop_front();
 
-					latexInProgress = nullptr;
-				}
-
-				// If there's any elements that need to be processed
-				// process the next element
-				if (queuedLatex.size() > 0)
-				{
-					LaTexTask* taskData = queuedLatex.front();
-					// Launch this as a task on a new thread so that it doesn't block the main thread
-					Application::threadPool()->queueTask(
-						generateSvgTask,
-						"Generate LaTeX Svg File",
-						taskData,
-						sizeof(LaTexTask)
-					);
-
-					latexInProgress = taskData;
+					if (job->sources.back().compileAlone)
+					{
+						break;
+					}
 				}
+				job->succeeded = std::vector<bool>(job->sources.size(), false);
+
+				numJobsInFlight++;
+				numJobsRunning++;
+				Application::threadPool()->queueTask(
+					compileJobTask,
+					"Generate LaTeX Svg Files",
+					job,
+					sizeof(LaTexJob),
+					Priority::None,
+					compileJobFinished,
+					// Each job runs an external latex process, which can take a few seconds
+					true
+				);
 			}
 		}
 
+		bool hasPendingTasks()
+		{
+			std::lock_guard<std::mutex> lock(latexMutex);
+			return queuedLatex.size() > 0 || numJobsInFlight > 0;
+		}
+
 		void free()
 		{
-			std::lock_guard<std::mutex> lock(latexQueueMutex);
-			while (queuedLatex.size() > 0)
-			{
-				g_memory_free(queuedLatex.front()->laTex);
-				g_memory_free(queuedLatex.front());
-				queuedLatex.pop();
-			}
+			std::unique_lock<std::mutex> lock(latexMutex);
+			queuedLatex.clear();
+			latexCallbacks.clear();
+
+			// Jobs that haven't started yet skip compiling, wait for the ones that are already running
+			// latex so nothing writes to the latex directory after this returns
+			jobGeneration++;
+			jobsFinishedCv.wait(lock, []() { return numJobsRunning == 0; });
+
+			// Their finished callbacks still run later, but all they do now is free the job
+			numJobsInFlight = 0;
 		}
 
 		// ----------- Internal functions ----------- 
-		static void generateSvgTask(void* data, size_t dataSize)
+		static std::string getLaTexMd5Unlocked(const std::string& latex)
 		{
-			g_logger_assert(dataSize == sizeof(LaTexTask), "Invalid latex task.");
-			LaTexTask* task = (LaTexTask*)data;
-
-			std::string filename = getLaTexMd5(task->laTex);
-			if (!generateSvgFile(filename, task->laTex, task->isMathTex))
+			auto iter = latexCachedMd5.find(latex);
+			if (iter != latexCachedMd5.end())
 			{
-				std::lock_guard<std::mutex> lock(latexQueueMutex);
-				g_memory_free(queuedLatex.front()->laTex);
-				g_memory_free(queuedLatex.front());
-				queuedLatex.pop();
+				return iter->second;
 			}
+
+			std::string md5 = Platform::md5FromString(latex);
+			latexCachedMd5[latex] = md5;
+			return md5;
 		}
 
-		static bool generateSvgFile(const std::string& filename, const std::string& latex, bool isMathTex)
+		static bool isValidMathTex(const std::string& latex)
 		{
-			if (isMathTex)
+			// Make sure there are no new lines
+			for (size_t i = 0; i < latex.length(); i++)
 			{
-				// Make sure there are no new lines
-				for (int i = 0; i < latex.length(); i++)
+				if (latex[i] == '\n')
 				{
-					if (latex[i] == '\n')
+					if (i == 0)
 					{
-						if (i == 0)
-						{
-							// If the newline is at the beginning return a custom error message
-							g_logger_error("No new lines allowed in MathTex. Newline was found at the beginning of your math equation:\n\t'{}'", latex);
-						}
-						else
-						{
-							std::string errorMessage = "No new lines allowed in MathTex. New line found:\n\t'";
-							errorMessage += latex.substr(0, i) + std::string(" '\n\t");
-							errorMessage += std::string(i + 1, ' ');
-							errorMessage += std::string("^--- Here");
-							g_logger_error("{}", errorMessage);
-						}
-
-						return false;
+						// If the newline is at the beginning return a custom error message
+						g_logger_error("No new lines allowed in MathTex. Newline was found at the beginning of your math equation:\n\t'{}'", latex);
+					}
+					else
+					{
+						std::string errorMessage = "No new lines allowed in MathTex. New line found:\n\t'";
+						errorMessage += latex.substr(0, i) + std::string(" '\n\t");
+						errorMessage += std::string(i + 1, ' ');
+						errorMessage += std::string("^--- Here");
+						g_logger_error("{}", errorMessage);
 					}
+
+					return false;
 				}
 			}
 
+			return true;
+		}
+
+		static void writeLaTexBody(FILE* fp, const LaTexSource& source)
+		{
+			if (source.isMathTex)
+			{
+				fwrite(beginAlign, beginAlignLength, 1, fp);
+			}
+			fwrite(source.latex.c_str(), source.latex.length(), 1, fp);
+			if (source.isMathTex)
+			{
+				fwrite(endAlign, endAlignLength, 1, fp);
+			}
+		}
+
+		static bool compileSingle(const std::filesystem::path& jobDir, const LaTexSource& source)
+		{
 			// First write the latex to a file to be processed
-			std::string latexFilename = filename + ".tex";
-			std::string latexFullpath = "latex/" + latexFilename;
+			std::string latexFilename = source.md5 + ".tex";
+			std::string latexFullpath = (jobDir / latexFilename).string();
 			{
 				FILE* fp = fopen(latexFullpath.c_str(), "wb");
 				if (!fp)
@@ -324,51 +458,224 @@ namespace MathAnim
 					return false;
 				}
 
+				fwrite(documentClass, documentClassLength, 1, fp);
 				fwrite(preamble, preambleLength, 1, fp);
-				if (isMathTex)
-				{
-					fwrite(beginAlign, beginAlignLength, 1, fp);
-				}
-				fwrite(latex.c_str(), latex.length(), 1, fp);
-				if (isMathTex)
-				{
-					fwrite(endAlign, endAlignLength, 1, fp);
-				}
+				writeLaTexBody(fp, source);
 				fwrite(postamble, postambleLength, 1, fp);
 				fclose(fp);
 			}
 
 			// Next process the files using the latex program and dvisgm on the system
-			std::string workingDirectory = "./latex/";
+			std::string workingDirectory = jobDir.string() + "/";
 			std::string cmdArgs = latexFilename + " -halt-on-error";
-			std::string logFilename = filename + ".tex.log.txt";
+			std::string logFilename = source.md5 + ".tex.log.txt";
 			Platform::executeProgram(latexProgram, cmdArgs.c_str(), workingDirectory.c_str(), logFilename.c_str());
 
-			std::string dviFilename = filename + ".dvi";
-			std::string dviFullpath = "latex/" + dviFilename;
-			if (Platform::fileExists(dviFullpath.c_str()))
+			std::string dviFilename = source.md5 + ".dvi";
+			if (!Platform::fileExists((jobDir / dviFilename).string().c_str()))
 			{
-				std::string dviLogFilename = filename + ".dvi.log.txt";
-				std::string cmdArgs2 = dviFilename + " -n";
-				Platform::executeProgram(dvisvgmProgram, cmdArgs2.c_str(), workingDirectory.c_str(), dviLogFilename.c_str());
+				// Keep the log around so the user can figure out what went wrong
+				std::error_code error;
+				std::filesystem::rename(jobDir / logFilename, std::filesystem::path("latex") / logFilename, error);
+				g_logger_error("There was an error processing the latex file. See 'latex/{}' for details.", logFilename);
+				return false;
+			}
+
+			std::string dviLogFilename = source.md5 + ".dvi.log.txt";
+			std::string cmdArgs2 = dviFilename + " -n";
+			Platform::executeProgram(dvisvgmProgram, cmdArgs2.c_str(), workingDirectory.c_str(), dviLogFilename.c_str());
 
-				// Sleep for 1 second before deleting files to make sure they are not locked
-				std::this_thread::sleep_for(std::chrono::seconds(1));
-				// If everything succeeded, clear out all the unnecessary files
-				Platform::deleteFile(dviFullpath.c_str());
-				Platform::deleteFile(latexFullpath.c_str());
-				Platform::deleteFile(("latex/" + dviLogFilename).c_str());
-				Platform::deleteFile(("latex/" + logFilename).c_str());
-				Platform::deleteFile(("latex/" + filename + ".aux").c_str());
-				Platform::deleteFile(("latex/" + filename + ".log").c_str());
+			std::error_code error;
+			std::filesystem::rename(jobDir / (source.md5 + ".svg"), std::filesystem::path("latex") / (source.md5 + ".svg"), error);
+			if (error)
+			{
+				g_logger_error("dvisvgm failed to generate an svg for LaTeX:\n\t'{}'", source.latex);
+				return false;
 			}
-			else
+
+			return true;
+		}
+
+		static bool compileBatch(const std::filesystem::path& jobDir, const std::vector<LaTexSource>& sources)
+		{
+			const char* batchName = "batch";
+			std::string latexFullpath = (jobDir / "batch.tex").string();
+			{
+				FILE* fp = fopen(latexFullpath.c_str(), "wb");
+				if (!fp)
+				{
+					g_logger_error("Failed to create file: '{}'", latexFullpath);
+					return false;
+				}
+
+				fwrite(batchDocumentClass, batchDocumentClassLength, 1, fp);
+				fwrite(preamble, preambleLength, 1, fp);
+				for (const LaTexSource& source : sources)
+				{
+					fwrite(beginPage, beginPageLength, 1, fp);
+					writeLaTexBody(fp, source);
+					fwrite(endPage, endPageLength, 1, fp);
+				}
+				fwrite(postamble, postambleLength, 1, fp);
+				fclose(fp);
+			}
+
+			std::string workingDirectory = jobDir.string() + "/";
+			std::string cmdArgs = std::string(batchName) + ".tex -halt-on-error";
+			Platform::executeProgram(latexProgram, cmdArgs.c_str(), workingDirectory.c_str(), "batch.tex.log.txt");
+			if (!Platform::fileExists((jobDir / "batch.dvi").string().c_str()))
 			{
-				g_logger_error("There was an error processing the latex file.");
 				return false;
 			}
 
+			// One svg per page, named batch-0001.svg, batch-0002.svg, ...
+			std::string cmdArgs2 = std::string(batchName) + ".dvi -n -p 1- -o " + batchName + "-%4p.svg";
+			Platform::executeProgram(dvisvgmProgram, cmdArgs2.c_str(), workingDirectory.c_str(), "batch.dvi.log.txt");
+
+			// Make sure every expression ended up on exactly one page before trusting the page order
+			char pageFilename[32];
+			for (size_t i = 0; i <= sources.size(); i++)
+			{
+				snprintf(pageFilename, sizeof(pageFilename), "%s-%04d.svg", batchName, (int)(i + 1));
+				bool pageExists = Platform::fileExists((jobDir / pageFilename).string().c_str());
+				bool shouldExist = i < sources.size();
+				if (pageExists != shouldExist)
+				{
+					return false;
+				}
+			}
+
+			for (size_t i = 0; i < sources.size(); i++)
+			{
+				snprintf(pageFilename, sizeof(pageFilename), "%s-%04d.svg", batchName, (int)(i + 1));
+				std::error_code error;
+				std::filesystem::rename(jobDir / pageFilename, std::filesystem::path("latex") / (sources[i].md5 + ".svg"), error);
+				if (error)
+				{
+					return false;
+				}
+			}
+
 			return true;
 		}
+
+		static void compileJob(LaTexJob* job)
+		{
+			// Every job gets its own directory so parallel latex runs never step on each other's files
+			std::filesystem::path jobDir = std::filesystem::path("latex") / "tmp" / ("job" + std::to_string(job->id));
+			std::error_code error;
+			std::filesystem::create_directories(jobDir, error);
+			if (error)
+			{
+				g_logger_error("Failed to create LaTeX job directory '{}': {}", jobDir.string(), error.message());
+				job->batchFailed = job->sources.size() > 1;
+				return;
+			}
+
+			if (job->sources.size() == 1)
+			{
+				job->succeeded[0] = compileSingle(jobDir, job->sources[0]);
+			}
+			else if (compileBatch(jobDir, job->sources))
+			{
+				job->succeeded = std::vector<bool>(job->sources.size(), true);
+			}
+			else
+			{
+				job->batchFailed = true;
+			}
+
+			std::filesystem::remove_all(jobDir, error);
+			if (error)
+			{
+				g_logger_warning("Failed to clean up LaTeX job directory '{}': {}", jobDir.string(), error.message());
+			}
+		}
+
+		static void compileJobTask(void* data, size_t dataSize)
+		{
+			g_logger_assert(dataSize == sizeof(LaTexJob), "Invalid latex job.");
+			LaTexJob* job = (LaTexJob*)data;
+
+			bool isCancelled = false;
+			{
+				std::lock_guard<std::mutex> lock(latexMutex);
+				isCancelled = job->generation != jobGeneration;
+			}
+
+			if (!isCancelled)
+			{
+				compileJob(job);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(latexMutex);
+				numJobsRunning--;
+			}
+			jobsFinishedCv.notify_all();
+		}
+
+		static void compileJobFinished(void* data, size_t dataSize)
+		{
+			g_logger_assert(dataSize == sizeof(LaTexJob), "Invalid latex job.");
+			LaTexJob* job = (LaTexJob*)data;
+
+			struct PendingCallback
+			{
+				std::string latex;
+				bool succeeded;
+				LaTexCallbackData data;
+			};
+			std::vector<PendingCallback> callbacks;
+
+			{
+				std::lock_guard<std::mutex> lock(latexMutex);
+				if (job->generation != jobGeneration)
+				{
+					// Started before the last free(), nobody is waiting on it anymore
+					g_memory_delete(job);
+					return;
+				}
+
+				numJobsInFlight--;
+
+				if (job->batchFailed)
+				{
+					// One bad expression fails the whole batch, so retry each of them on their own
+					g_logger_info("LaTeX batch of {} expressions failed, compiling them separately.", job->sources.size());
+					for (auto iter = job->sources.rbegin(); iter != job->sources.rend(); iter++)
+					{
+						iter->compileAlone = true;
+						queuedLatex.push_front(*iter);
+					}
+				}
+				else
+				{
+					for (size_t i = 0; i < job->sources.size(); i++)
+					{
+						const LaTexSource& source = job->sources[i];
+						latexStatus[source.md5] = job->succeeded[i] ? LaTexStatus::Ready : LaTexStatus::Failed;
+
+						auto callbackIter = latexCallbacks.find(source.md5);
+						if (callbackIter != latexCallbacks.end())
+						{
+							for (const LaTexCallbackData& callbackData : callbackIter->second)
+							{
+								callbacks.push_back({ source.latex, job->succeeded[i], callbackData });
+							}
+							latexCallbacks.erase(callbackIter);
+						}
+					}
+				}
+			}
+
+			// Callbacks are free to queue more LaTeX, so call them without holding the lock
+			for (const PendingCallback& pending : callbacks)
+			{
+				pending.data.callback(pending.latex, pending.succeeded, pending.data.userData);
+			}
+
+			g_memory_delete(job);
+		}
 	}
 }
@@ -5,11 +5,34 @@
 
 using namespace MathAnim;
 
+static void printUsage();
+static bool parseInt(const char* str, int* out);
+static bool parseFrameRange(const char* str, int* firstFrame, int* lastFrame);
+static bool parseHeadlessArgs(int argc, char* argv[], std::string* projectFile, HeadlessRenderSettings* settings);
+
 int main(int argc, char* argv[])
 {
 	g_logger_init();
 	g_memory_init_padding(true, 5);
 
+	if (argc >= 2 && std::strcmp(argv[1], "--render") == 0)
+	{
+		std::string projectFile = "";
+		HeadlessRenderSettings settings = {};
+		int exitCode = 1;
+		if (parseHeadlessArgs(argc, argv, &projectFile, &settings))
+		{
+			exitCode = Application::renderHeadless(projectFile.c_str(), settings);
+		}
+		else
+		{
+			printUsage();
+		}
+
+		g_memory_dumpMemoryLeaks();
+		return exitCode;
+	}
+
 	std::string projectFile = "";
 	if (argc < 2)
 	{
@@ -21,16 +44,149 @@ int main(int argc, char* argv[])
 	{
 		projectFile = argv[1];
 	}
-	
+
 	if (projectFile != "")
 	{
 		Application::init(projectFile.c_str());
 		Application::run();
 		Application::free();
 	}
-	
+
 	g_memory_dumpMemoryLeaks();
 	return 0;
 }
 
-#endif
\ No newline at end of file
+static void printUsage()
+{
+	CppUtils::IO::printf(
+		"Usage:\n"
+		"  MathAnimations [projectFile]\n"
+		"  MathAnimations --render <projectFile> --out <videoFile> [options]\n"
+		"  MathAnimations --render <projectFile> --benchmark [options]\n"
+		"\n"
+		"Render options:\n"
+		"  --frames <first>:<last>  Inclusive range of timeline frames to render (default: whole scene)\n"
+		"  --width <pixels>         Output width (default: 3840)\n"
+		"  --height <pixels>        Output height (default: 2160)\n"
+		"  --fps <framerate>        Output framerate (default: 60)\n"
+		"  --crf <1-63>             Encoder constant rate factor, lower is higher quality (default: {})\n"
+		"  --cpu                    Rasterize frames on the CPU instead of with OpenGL\n"
+		"  --benchmark              Only measure per frame render times, no video is written\n",
+		DEFAULT_VIDEO_CRF
+	);
+}
+
+static bool parseInt(const char* str, int* out)
+{
+	char* end = nullptr;
+	long value = std::strtol(str, &end, 10);
+	if (end == str || *end != '\0' || value < INT32_MIN || value > INT32_MAX)
+	{
+		return false;
+	}
+
+	*out = (int)value;
+	return true;
+}
+
+static bool parseFrameRange(const char* str, int* firstFrame, int* lastFrame)
+{
+	const char* separator = std::strchr(str, ':');
+	if (!separator)
+	{
+		return false;
+	}
+
+	std::string first = std::string(str, separator - str);
+	std::string last = std::string(separator + 1);
+	return parseInt(first.c_str(), firstFrame) && parseInt(last.c_str(), lastFrame);
+}
+
+static bool parseHeadlessArgs(int argc, char* argv[], std::string* projectFile, HeadlessRenderSettings* settings)
+{
+	// argv[1] is --render
+	if (argc < 3)
+	{
+		g_logger_error("Missing project file for --render.");
+		return false;
+	}
+	*projectFile = argv[2];
+
+	for (int i = 3; i < argc; i++)
+	{
+		const char* arg = argv[i];
+
+		// Flags without values
+		if (std::strcmp(arg, "--cpu") == 0)
+		{
+			settings->useSoftwareRenderer = true;
+			continue;
+		}
+		else if (std::strcmp(arg, "--benchmark") == 0)
+		{
+			settings->benchmarkOnly = true;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			g_logger_error("Missing value for argument '{}'.", arg);
+			return false;
+		}
+		const char* value = argv[++i];
+
+		bool isValid = true;
+		if (std::strcmp(arg, "--out") == 0)
+		{
+			settings->outputFile = value;
+		}
+		else if (std::strcmp(arg, "--frames") == 0)
+		{
+			isValid = parseFrameRange(value, &settings->firstFrame, &settings->lastFrame);
+		}
+		else if (std::strcmp(arg, "--width") == 0)
+		{
+			isValid = parseInt(value, &settings->outputWidth) && settings->outputWidth > 0;
+		}
+		else if (std::strcmp(arg, "--height") == 0)
+		{
+			isValid = parseInt(value, &settings->outputHeight) && settings->outputHeight > 0;
+		}
+		else if (std::strcmp(arg, "--fps") == 0)
+		{
+			isValid = parseInt(value, &settings->framerate) && settings->framerate > 0;
+		}
+		else if (std::strcmp(arg, "--crf") == 0)
+		{
+			isValid = parseInt(value, &settings->crf) && settings->crf >= 1 && settings->crf <= 63;
+		}
+		else
+		{
+			g_logger_error("Unknown argument '{}'.", arg);
+			return false;
+		}
+
+		if (!isValid)
+		{
+			g_logger_error("Invalid value '{}' for argument '{}'.", value, arg);
+			return false;
+		}
+	}
+
+	if (settings->outputFile == "" && !settings->benchmarkOnly)
+	{
+		g_logger_error("Missing --out <videoFile> for --render.");
+		return false;
+	}
+
+	// The encoder works in 4:2:0 so the output size has to be even
+	if ((settings->outputWidth % 2) != 0 || (settings->outputHeight % 2) != 0)
+	{
+		g_logger_error("Output size must be even, got {}x{}.", settings->outputWidth, settings->outputHeight);
+		return false;
+	}
+
+	return true;
+}
+
+#endif
@@ -3,30 +3,85 @@
 
 namespace MathAnim
 {
-	bool CompareThreadTask::operator()(const ThreadTask& a, const ThreadTask& b) const
+	// Lets schedule() push tasks created on a worker thread onto that worker's own queue
+	static thread_local GlobalThreadPool* currentPool = nullptr;
+	static thread_local int32 currentWorkerIndex = -1;
+	// Priority of the task this thread is running right now, if any
+	static thread_local Priority currentTaskPriority = Priority::None;
+
+	// ------------------ Task State ------------------
+	bool TaskState::tryStart()
 	{
-		if (a.priority == b.priority)
+		TaskStatus expected = TaskStatus::Pending;
+		return status.compare_exchange_strong(expected, TaskStatus::Running);
+	}
+
+	bool TaskState::tryCancel()
+	{
+		TaskStatus expected = TaskStatus::Pending;
+		if (status.compare_exchange_strong(expected, TaskStatus::Cancelled))
 		{
-			return a.counter > b.counter;
+			finish(TaskStatus::Cancelled);
+			return true;
 		}
 
-		return (uint8)a.priority > (uint8)b.priority;
+		return false;
 	}
 
+	void TaskState::finish(TaskStatus finalStatus)
+	{
+		std::vector<std::function<void()>> continuationsToRun;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			status = finalStatus;
+			continuationsToRun.swap(continuations);
+		}
+		cv.notify_all();
+
+		for (std::function<void()>& continuation : continuationsToRun)
+		{
+			continuation();
+		}
+	}
+
+	void TaskState::onFinished(std::function<void()> continuation)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			if (!isFinished())
+			{
+				continuations.emplace_back(std::move(continuation));
+				return;
+			}
+		}
+
+		continuation();
+	}
+
+	bool TaskState::isFinished() const
+	{
+		TaskStatus currentStatus = status.load();
+		return currentStatus == TaskStatus::Completed || currentStatus == TaskStatus::Cancelled;
+	}
+
+	// ------------------ Global Thread Pool ------------------
 	GlobalThreadPool::GlobalThreadPool(uint32 numThreads)
-		: cv(), queueMtx(), generalMtx(), doWork(true), numThreads(numThreads)
+		: doWork(true), numThreads(glm::max(numThreads, 1u))
 	{
-		tasks = new std::priority_queue<ThreadTask, std::vector<ThreadTask>, CompareThreadTask>();
+		workerQueues = new WorkerQueue[this->numThreads];
 		cv = new std::condition_variable();
 		generalMtx = new std::mutex();
-		queueMtx = new std::mutex();
 		finishedQueueMtx = new std::mutex();
-		workerThreads = new std::thread[numThreads];
+		nextQueue = 0;
+		numQueuedTasks = 0;
+		// Group 0 is reserved for tasks from queueTask, nobody can wait on those
+		nextGroup = 1;
+		workerThreads = new std::thread[this->numThreads];
 #ifdef _DEBUG
 		forceSynchronous = false;
 #endif
 
-		for (uint32 i = 0; i < numThreads; i++)
+		for (uint32 i = 0; i < this->numThreads; i++)
 		{
 			workerThreads[i] = std::thread(&GlobalThreadPool::processLoop, this, i);
 		}
@@ -36,12 +91,14 @@ namespace MathAnim
 	GlobalThreadPool::GlobalThreadPool(bool forceSynchronous)
 	{
 		this->forceSynchronous = forceSynchronous;
-		tasks = nullptr;
+		workerQueues = nullptr;
 		cv = nullptr;
 		generalMtx = nullptr;
-		queueMtx = nullptr;
 		finishedQueueMtx = nullptr;
 		workerThreads = nullptr;
+		nextQueue = 0;
+		numQueuedTasks = 0;
+		nextGroup = 1;
 		doWork = false;
 		numThreads = 0;
 	}
@@ -69,22 +126,45 @@ namespace MathAnim
 
 		processFinishedTasks();
 
+		// Anything still queued will never run, cancel it so nobody waits on it forever
+		for (uint32 i = 0; i < numThreads; i++)
+		{
+			for (std::deque<PoolTask>& tasks : workerQueues[i].tasks)
+			{
+				for (PoolTask& task : tasks)
+				{
+					if (task.state)
+					{
+						task.state->tryCancel();
+					}
+				}
+			}
+		}
+
 		delete[] workerThreads;
-		delete tasks;
+		delete[] workerQueues;
+		delete cv;
 		delete generalMtx;
-		delete queueMtx;
 		delete finishedQueueMtx;
 	}
 
-	void GlobalThreadPool::processFinishedTasks() 
+	void GlobalThreadPool::processFinishedTasks()
 	{
 		MP_PROFILE_EVENT("GlobalThreadPool_ProcessFinishedTasks");
-		std::lock_guard<std::mutex> lock(*this->finishedQueueMtx);
-		while (!this->finishedTasks.empty())
+
+		// Callbacks run without the lock held, they're allowed to wait on other tasks
+		// and those may finish (and push here) on this thread
+		std::queue<PoolTask> tasksToProcess;
 		{
-			ThreadTask& task = finishedTasks.front();
+			std::lock_guard<std::mutex> lock(*this->finishedQueueMtx);
+			tasksToProcess.swap(this->finishedTasks);
+		}
+
+		while (!tasksToProcess.empty())
+		{
+			PoolTask& task = tasksToProcess.front();
 			task.callback(task.data, task.dataSize);
-			finishedTasks.pop();
+			tasksToProcess.pop();
 		}
 	}
 
@@ -97,47 +177,29 @@ namespace MathAnim
 		std::string threadName = "GlobalThread_" + std::to_string(threadIndex);
 		MP_PROFILE_THREAD(threadName.c_str());
 
-		bool shouldContinue = true;
-		while (shouldContinue)
-		{
-			if (tasks->empty())
-			{
-				// Wait until we need to do some work
-				std::unique_lock<std::mutex> lock(*generalMtx);
-				cv->wait(lock, [&] { return (!doWork || !tasks->empty()); });
-				shouldContinue = doWork && !tasks->empty();
-			}
+		currentPool = this;
+		currentWorkerIndex = (int32)threadIndex;
 
-			ThreadTask task{};
+		while (true)
+		{
+			PoolTask task;
+			if (popTask((int32)threadIndex, &task))
 			{
-				std::lock_guard<std::mutex> queueLock(*queueMtx);
-				if (tasks->size() > 0)
-				{
-					task = tasks->top();
-					tasks->pop();
-				}
-				else
-				{
-					task.fn = nullptr;
-				}
+				runTask(task);
+				continue;
 			}
 
-			if (task.fn)
+			// Wait until we need to do some work
+			std::unique_lock<std::mutex> lock(*generalMtx);
+			cv->wait(lock, [&] { return !doWork || numQueuedTasks.load() > 0; });
+			if (!doWork)
 			{
-				{
-					MP_PROFILE_DYNAMIC_EVENT(task.taskName);
-					task.fn(task.data, task.dataSize);
-				}
-				if (task.callback)
-				{
-					std::lock_guard<std::mutex> lock(*this->finishedQueueMtx);
-					this->finishedTasks.push(task);
-				}
+				break;
 			}
 		}
 	}
 
-	void GlobalThreadPool::queueTask(TaskFunction function, const char* taskName, void* data, size_t dataSize, Priority priority, ThreadCallback callback)
+	void GlobalThreadPool::queueTask(TaskFunction function, const char* taskName, void* data, size_t dataSize, Priority priority, ThreadCallback callback, bool isBlocking)
 	{
 #ifdef _DEBUG
 		if (forceSynchronous)
@@ -155,20 +217,22 @@ namespace MathAnim
 		}
 #endif
 
-		static uint64 counter = 0;
-		ThreadTask task;
-		task.fn = function;
-		task.data = data;
-		task.dataSize = dataSize;
+		PoolTask task = {};
+		task.fn = [function, data, dataSize]()
+		{
+			if (function)
+			{
+				function(data, dataSize);
+			}
+		};
+		task.taskName = taskName;
 		task.priority = priority;
+		task.group = 0;
+		task.isBlocking = isBlocking;
 		task.callback = callback;
-		task.taskName = taskName;
-		{
-			std::lock_guard<std::mutex> lockGuard(*queueMtx);
-			task.counter = counter++;
-			tasks->push(task);
-			cv->notify_one();
-		}
+		task.data = data;
+		task.dataSize = dataSize;
+		schedule(std::move(task));
 	}
 
 	void GlobalThreadPool::beginWork(bool notifyAll)
@@ -189,4 +253,178 @@ namespace MathAnim
 			cv->notify_one();
 		}
 	}
+
+	void GlobalThreadPool::waitFor(TaskState& state)
+	{
+		int32 workerIndex = currentPool == this ? currentWorkerIndex : -1;
+		bool isWorker = workerIndex >= 0;
+
+		// Anyone may run the queued tasks of the group they're waiting on, that's work they'd
+		// be waiting for anyways. Workers may also run anything at least as urgent as the task
+		// they're in the middle of, which keeps tasks that wait on other tasks from deadlocking
+		// when every worker is busy waiting. Other threads (like the UI thread) must never
+		// pick up unrelated work since that could stall them for far longer than the wait.
+		WaitFilter filter = {};
+		filter.group = state.group;
+		filter.helpWithOtherGroups = isWorker;
+		filter.minPriority = currentTaskPriority;
+
+		while (!state.isFinished())
+		{
+			PoolTask task;
+			if (popTask(workerIndex, &task, &filter))
+			{
+				runTask(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(state.mtx);
+			if (isWorker)
+			{
+				// Workers check back periodically, new tasks they can help with may show up
+				state.cv.wait_for(lock, std::chrono::milliseconds(1), [&] { return state.isFinished(); });
+			}
+			else
+			{
+				state.cv.wait(lock, [&] { return state.isFinished(); });
+			}
+		}
+	}
+
+	// ------------------ Internal functions ------------------
+	void GlobalThreadPool::schedule(PoolTask&& task)
+	{
+#ifdef _DEBUG
+		if (forceSynchronous)
+		{
+			runTask(task);
+			return;
+		}
+#endif
+
+		uint32 queueIndex = currentPool == this && currentWorkerIndex >= 0
+			? (uint32)currentWorkerIndex
+			: nextQueue.fetch_add(1) % numThreads;
+		uint8 priorityIndex = glm::min((uint8)task.priority, (uint8)Priority::None);
+
+		{
+			std::lock_guard<std::mutex> lock(workerQueues[queueIndex].mtx);
+			workerQueues[queueIndex].tasks[priorityIndex].emplace_back(std::move(task));
+		}
+
+		numQueuedTasks++;
+		{
+			// Makes sure a worker that's about to go to sleep sees the new task
+			std::lock_guard<std::mutex> lock(*generalMtx);
+		}
+		cv->notify_one();
+	}
+
+	bool GlobalThreadPool::WaitFilter::accepts(const PoolTask& task) const
+	{
+		if (task.group != 0 && task.group == group)
+		{
+			return true;
+		}
+
+		return helpWithOtherGroups && !task.isBlocking && (uint8)task.priority <= (uint8)minPriority;
+	}
+
+	bool GlobalThreadPool::popTask(int32 workerIndex, PoolTask* outTask, const WaitFilter* filter)
+	{
+		// Takes the task closest to the back (or front) of the queue that passes the filter
+		auto takeTask = [&](std::deque<PoolTask>& tasks, bool fromBack)
+		{
+			if (tasks.empty())
+			{
+				return false;
+			}
+
+			if (!filter)
+			{
+				*outTask = fromBack ? std::move(tasks.back()) : std::move(tasks.front());
+				fromBack ? tasks.pop_back() : tasks.pop_front();
+				numQueuedTasks--;
+				return true;
+			}
+
+			for (size_t i = 0; i < tasks.size(); i++)
+			{
+				size_t index = fromBack ? tasks.size() - 1 - i : i;
+				if (filter->accepts(tasks[index]))
+				{
+					*outTask = std::move(tasks[index]);
+					tasks.erase(tasks.begin() + index);
+					numQueuedTasks--;
+					return true;
+				}
+			}
+
+			return false;
+		};
+
+		// Higher priority tasks always win, even if they have to be stolen from another worker
+		for (uint8 priority = 0; priority < (uint8)Priority::Length; priority++)
+		{
+			if (workerIndex >= 0)
+			{
+				WorkerQueue& ownQueue = workerQueues[workerIndex];
+				std::lock_guard<std::mutex> lock(ownQueue.mtx);
+				if (takeTask(ownQueue.tasks[priority], true))
+				{
+					return true;
+				}
+			}
+
+			uint32 startIndex = workerIndex >= 0 ? (uint32)workerIndex + 1 : 0;
+			for (uint32 i = 0; i < numThreads; i++)
+			{
+				uint32 victimIndex = (startIndex + i) % numThreads;
+				if ((int32)victimIndex == workerIndex)
+				{
+					continue;
+				}
+
+				WorkerQueue& victimQueue = workerQueues[victimIndex];
+				std::lock_guard<std::mutex> lock(victimQueue.mtx);
+				if (takeTask(victimQueue.tasks[priority], false))
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void GlobalThreadPool::runTask(PoolTask& task)
+	{
+		// Cancelled before it got a chance to run
+		if (task.state && !task.state->tryStart())
+		{
+			return;
+		}
+
+		{
+			MP_PROFILE_DYNAMIC_EVENT(task.taskName);
+			Priority outerTaskPriority = currentTaskPriority;
+			currentTaskPriority = task.priority;
+			task.fn();
+			currentTaskPriority = outerTaskPriority;
+		}
+
+		if (task.callback)
+		{
+#ifdef _DEBUG
+			if (forceSynchronous)
+			{
+				task.callback(task.data, task.dataSize);
+				return;
+			}
+#endif
+
+			std::lock_guard<std::mutex> lock(*this->finishedQueueMtx);
+			this->finishedTasks.push(std::move(task));
+		}
+	}
 }
@@ -1,30 +1,43 @@
 #include "parsers/Grammar.h"
 #include "platform/Platform.h"
 #include "math/CMath.h"
+#include "multithreading/GlobalThreadPool.h"
+#include "core/Profiling.h"
 
 #include <nlohmann/json.hpp>
+#include <cctype>
 
 namespace MathAnim
 {
 	using namespace nlohmann;
 
+	// Chunks smaller than this aren't worth handing to another thread
+	static constexpr size_t minLinesPerParseChunk = 512;
+	// How many lines past a chunk's ideal start we look for a line that's safe to resume parsing from
+	static constexpr size_t maxResumeLineSearch = 64;
+
 	// ----------- Internal Functions -----------
+	static size_t updateLines(Grammar const& grammar, SourceGrammarTree& tree, std::string_view code, SyntaxTheme const& theme, size_t lineIndex, size_t maxNumLinesToUpdate, OnigRegion* region);
+	static void resetLineInfo(GrammarLineInfo& lineInfo, GrammarLineInfo const* prevLineInfo);
+	static void parseLine(Grammar const& grammar, GrammarLineInfo* lineInfo, std::string_view code, SyntaxTheme const& theme, OnigRegion* region);
+	static size_t findResumeLine(SourceGrammarTree const& tree, std::string_view code, size_t targetLine);
+	static bool ancestorsMatch(std::vector<ScopedName> const& a, std::vector<ScopedName> const& b);
 	static Grammar* importGrammarFromJson(const json& j);
 	static SyntaxPattern* const parsePattern(const json& json, Grammar* self);
 	static PatternArray parsePatternsArray(const json& json, Grammar* self);
 	static OnigRegex onigFromString(const std::string& str, bool multiLine);
-	static ScopedName getScopeWithCaptures(const std::string& str, const ScopedName& originalScope, const OnigRegion* region);
-	static void getFirstMatchInRegset(const std::string& str, size_t anchor, size_t startOffset, size_t endOffset, const PatternArray& pattern, int* patternMatched);
+	static ScopedName getScopeWithCaptures(std::string_view str, const ScopedName& originalScope, const OnigRegion* region);
+	static void getFirstMatchInRegset(std::string_view str, size_t anchor, size_t startOffset, size_t endOffset, const PatternArray& pattern, int* patternMatched);
 
 	static size_t pushMatchesToLineWithParent(GrammarLineInfo& line, GrammarMatchV2 const& parent, std::vector<GrammarMatchV2> const& subMatches, SyntaxTheme const& theme, size_t currentByte);
 	static size_t pushMatchesToLine(GrammarLineInfo& line, std::vector<GrammarMatchV2> const& subMatches, SyntaxTheme const& theme, size_t currentByte);
-	static std::optional<GrammarMatchV2> getFirstMatchV2(const std::string& str, size_t anchor, size_t startOffset, size_t endOffset, OnigRegex reg, OnigRegion* region, const std::optional<ScopedName>& scope);
-	static std::vector<GrammarMatchV2> getCapturesV2(GrammarLineInfo& line, const std::string& str, SyntaxTheme const& theme, const PatternRepository& repo, OnigRegion* region, std::optional<CaptureList> captures, Grammar const* self);
+	static std::optional<GrammarMatchV2> getFirstMatchV2(std::string_view str, size_t anchor, size_t startOffset, size_t endOffset, OnigRegex reg, OnigRegion* region, const std::optional<ScopedName>& scope);
+	static std::vector<GrammarMatchV2> getCapturesV2(GrammarLineInfo& line, std::string_view str, SyntaxTheme const& theme, const PatternRepository& repo, OnigRegion* region, std::optional<CaptureList> captures, Grammar const* self);
 
 	static void freePattern(SyntaxPattern* const pattern);
 
 	// --- Construct Regset Helpers ---
-	static void addPatternToRegset(OnigRegSet* regset, PatternArray& ogPatternArray, const SyntaxPattern& pattern, const Grammar* self, uint64 patternArrayIndex);
+	static void addPatternToRegset(PatternArray& ogPatternArray, SyntaxPattern& pattern, const Grammar* self, uint64 patternArrayIndex);
 	static void constructRegexesFromPattern(SyntaxPattern& pattern, Grammar* self);
 	static void constructRegsetFromPatterns(PatternArray& patternArray, Grammar* self);
 
@@ -120,7 +133,7 @@ namespace MathAnim
 		}
 	}
 
-	MatchSpan SimpleSyntaxPattern::tryParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const
+	MatchSpan SimpleSyntaxPattern::tryParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const
 	{
 		std::optional<GrammarMatchV2> match = getFirstMatchV2(code, anchor, start, end, this->regMatch, region, this->scope);
 
@@ -129,7 +142,7 @@ namespace MathAnim
 		{
 			// Push an empty token to fill in the gap before we push a new scope to the ancestor stack
 			SourceSyntaxToken token = {};
-			token.debugAncestorStack = line.ancestors;
+			token.ancestorStackId = ScopeStacks::intern(line.ancestors);
 			token.relativeStart = (uint32)(currentByte - line.byteStart);
 			token.style = theme.match(line.ancestors);
 
@@ -196,7 +209,7 @@ namespace MathAnim
 		}
 	}
 
-	MatchSpan ComplexSyntaxPattern::tryParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t endOffset, const PatternRepository& repo, OnigRegion* region, Grammar const* self, GrammarPatternGid gid) const
+	MatchSpan ComplexSyntaxPattern::tryParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t endOffset, const PatternRepository& repo, OnigRegion* region, Grammar const* self, GrammarPatternGid gid) const
 	{
 		// If the begin/end pair doesn't have a match, then this rule isn't a success
 		std::optional<GrammarMatchV2> beginBlockMatch = getFirstMatchV2(code, anchor, start, endOffset, this->begin, region, std::nullopt);
@@ -223,7 +236,7 @@ namespace MathAnim
 			// Fill in the gap if needed before we push our scope to the stack
 			SourceSyntaxToken token = {};
 			token.relativeStart = (uint32)(start - line.byteStart);
-			token.debugAncestorStack = line.ancestors;
+			token.ancestorStackId = ScopeStacks::intern(line.ancestors);
 			token.style = theme.match(line.ancestors);
 
 			line.tokens.emplace_back(token);
@@ -254,7 +267,7 @@ namespace MathAnim
 
 				std::string beginRegex = regexPatternToTest.substr(0, replaceBeginOffset);
 				std::string endRegex = regexPatternToTest.substr(replaceEndOffset);
-				std::string replacement = code.substr(replacementStringBegin, (replacementStringEnd - replacementStringBegin));
+				std::string replacement = std::string(code.substr(replacementStringBegin, (replacementStringEnd - replacementStringBegin)));
 				regexPatternToTest = beginRegex + replacement + endRegex;
 
 				offsetToAdd += (replacementStringEnd - replacementStringBegin) - (replaceEndOffset - replaceBeginOffset);
@@ -275,7 +288,7 @@ namespace MathAnim
 		return resumeParse(line, code, theme, resumeInfo.currentByte, resumeInfo.dynamicEndPatternStr, beginBlockMatch->end, beginBlockMatch->end, code.length(), repo, region, self);
 	}
 
-	MatchSpan ComplexSyntaxPattern::resumeParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t currentByte, std::string const& dynamicEndPattern, size_t anchor, size_t start, size_t /*endOffset*/, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const
+	MatchSpan ComplexSyntaxPattern::resumeParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t currentByte, std::string const& dynamicEndPattern, size_t anchor, size_t start, size_t /*endOffset*/, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const
 	{
 		OnigRegex endPattern = this->end.simpleRegex;
 		if (this->end.isDynamic)
@@ -310,7 +323,7 @@ namespace MathAnim
 		{
 			SourceSyntaxToken emptyToken = {};
 			emptyToken.relativeStart = (uint32)(currentByte - line.byteStart);
-			emptyToken.debugAncestorStack = line.ancestors;
+			emptyToken.ancestorStackId = ScopeStacks::intern(line.ancestors);
 			emptyToken.style = theme.match(line.ancestors);
 
 			line.tokens.emplace_back(emptyToken);
@@ -484,7 +497,7 @@ namespace MathAnim
 			{
 				SourceSyntaxToken emptyToken = {};
 				emptyToken.relativeStart = (uint32)(currentByte - line.byteStart);
-				emptyToken.debugAncestorStack = line.ancestors;
+				emptyToken.ancestorStackId = ScopeStacks::intern(line.ancestors);
 				emptyToken.style = theme.match(line.ancestors);
 
 				line.tokens.emplace_back(emptyToken);
@@ -530,7 +543,7 @@ namespace MathAnim
 		end.simpleRegex = nullptr;
 	}
 
-	MatchSpan PatternArray::tryParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const
+	MatchSpan PatternArray::tryParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const
 	{
 		int onigPatternMatched = -1;
 		getFirstMatchInRegset(code, anchor, start, end, *this, &onigPatternMatched);
@@ -584,7 +597,7 @@ namespace MathAnim
 		return { start, start };
 	}
 
-	MatchSpan PatternArray::tryParseAll(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const
+	MatchSpan PatternArray::tryParseAll(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t end, const PatternRepository& repo, OnigRegion* region, Grammar const* self) const
 	{
 		size_t cursor = start;
 
@@ -633,7 +646,7 @@ namespace MathAnim
 		}
 	}
 
-	MatchSpan SyntaxPattern::tryParse(GrammarLineInfo& line, std::string const& code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t endOffset, const PatternRepository& repo, OnigRegion* region) const
+	MatchSpan SyntaxPattern::tryParse(GrammarLineInfo& line, std::string_view code, SyntaxTheme const& theme, size_t anchor, size_t start, size_t endOffset, const PatternRepository& repo, OnigRegion* region) const
 	{
 		switch (type)
 		{
@@ -734,6 +747,15 @@ namespace MathAnim
 		return sourceInfo.end();
 	}
 
+	SourceSyntaxToken_Debug SourceSyntaxToken::getDebugToken() const
+	{
+		SourceSyntaxToken_Debug res = {};
+		res.relativeStart = relativeStart;
+		res.style = style;
+		res.debugAncestorStack = ScopeStacks::get(ancestorStackId);
+		return res;
+	}
+
 	std::vector<ScopedName> SourceGrammarTree::getAllAncestorScopesAtChar(size_t cursorPos) const
 	{
 		for (auto const& line : this->sourceInfo)
@@ -755,7 +777,7 @@ namespace MathAnim
 					}
 				}
 
-				return line.tokens[tokenIndex].debugAncestorStack;
+				return ScopeStacks::get(line.tokens[tokenIndex].ancestorStackId);
 			}
 		}
 
@@ -821,7 +843,7 @@ namespace MathAnim
 		{
 			for (size_t tokenIndex = 0; tokenIndex < line.tokens.size(); tokenIndex++)
 			{
-				auto const& token = line.tokens[tokenIndex];
+				SourceSyntaxToken_Debug token = line.tokens[tokenIndex].getDebugToken();
 				bool lastTokenClosed = false;
 
 				// Diff this stack with the current one we're using
@@ -1047,226 +1069,147 @@ namespace MathAnim
 
 	size_t Grammar::updateFromByte(SourceGrammarTree& tree, SyntaxTheme const& theme, uint32_t byteOffset, uint32_t maxNumLinesToUpdate) const
 	{
-		size_t numLinesUpdated = 1;
-		size_t currentLineInfoIndex = tree.sourceInfo.size();
-		while (numLinesUpdated <= maxNumLinesToUpdate)
+		// TODO: Optimization technique, replace this with a binary search
+		size_t lineIndex = tree.sourceInfo.size();
+		for (size_t i = 0; i < tree.sourceInfo.size(); i++)
 		{
-			std::vector<GrammarResumeParseInfo> oldPatternStack = {};
+			auto& info = tree.sourceInfo[i];
+			if (byteOffset >= info.byteStart && byteOffset < info.byteStart + info.numBytes)
+			{
+				lineIndex = i;
+			}
+		}
 
-			// TODO: Optimization technique, replace this with a binary search
-			GrammarLineInfo* lineInfo = nullptr;
+		// If the offset was greater than the source code length, then we've hit the end of the file
+		if (lineIndex == tree.sourceInfo.size())
+		{
+			return 1;
+		}
 
-			// First find the line that we're updating
-			{
-				if (currentLineInfoIndex == tree.sourceInfo.size())
-				{
-					for (size_t i = 0; i < tree.sourceInfo.size(); i++)
-					{
-						auto& info = tree.sourceInfo[i];
-						if (byteOffset >= info.byteStart && byteOffset < info.byteStart + info.numBytes)
-						{
-							currentLineInfoIndex = i;
-						}
-					}
-				}
+		// The match state lives in a region owned by this call, that way the grammar can be shared between threads.
+		// The code is only viewed, copying it here would make every keystroke cost as much as the whole file.
+		std::string_view code = tree.codeBlock
+			? std::string_view(tree.codeBlock, tree.codeLength)
+			: std::string_view();
+		OnigRegion* region = onig_region_new();
+		size_t numLinesUpdated = updateLines(*this, tree, code, theme, lineIndex, maxNumLinesToUpdate, region);
+		onig_region_free(region, 1);
 
-				if (currentLineInfoIndex < tree.sourceInfo.size())
-				{
-					lineInfo = &tree.sourceInfo[currentLineInfoIndex];
-				}
-				else
-				{
-					return numLinesUpdated;
-				}
+		return numLinesUpdated;
+	}
 
-				GrammarLineInfo* prevLineInfo = nullptr;
-				if (currentLineInfoIndex > 0 && currentLineInfoIndex <= tree.sourceInfo.size())
-				{
-					prevLineInfo = &tree.sourceInfo[currentLineInfoIndex - 1];
-				}
+	SourceGrammarTree Grammar::parseCodeBlock(const char* code, size_t codeLength, SyntaxTheme const& theme) const
+	{
+		SourceGrammarTree res = initCodeBlock(code, codeLength);
 
-				// Keep track of the old pattern stack so we know if we need to continue parsing the next line
-				oldPatternStack = lineInfo->patternStack;
+		// Create the region once for the whole block instead of once per line
+		std::string_view codeStr = code
+			? std::string_view(code, codeLength)
+			: std::string_view();
+		OnigRegion* region = onig_region_new();
 
-				// Reset this line's info to all the previous lines stuff since it will carry forward from there
-				if (prevLineInfo)
-				{
-					lineInfo->ancestors = prevLineInfo->ancestors;
-					lineInfo->patternStack = prevLineInfo->patternStack;
-					lineInfo->tokens = {};
-				}
-				else
-				{
-					lineInfo->ancestors = {};
-					lineInfo->patternStack = {};
-					lineInfo->tokens = {};
-				}
-			}
+		size_t currentLine = 1;
+		while (currentLine <= res.sourceInfo.size())
+		{
+			currentLine += updateLines(*this, res, codeStr, theme, currentLine - 1, DEFAULT_MAX_LINES_TO_UPDATE, region);
+		}
+
+		onig_region_free(region, 1);
 
-			// If the offset was greater than the source code length, then we've hit the end of the file
-			if (lineInfo == nullptr)
+		return res;
+	}
+
+	SourceGrammarTree Grammar::parseCodeBlockParallel(const char* code, size_t codeLength, SyntaxTheme const& theme, GlobalThreadPool& threadPool) const
+	{
+		MP_PROFILE_EVENT("Grammar_ParseCodeBlockParallel");
+
+		size_t numLines = 0;
+		for (size_t i = 0; code && i < codeLength; i++)
+		{
+			if (code[i] == '\n')
 			{
-				return numLinesUpdated;
+				numLines++;
 			}
+		}
+
+		size_t numChunks = glm::min((size_t)threadPool.getNumThreads(), numLines / minLinesPerParseChunk);
+		if (!code || numChunks <= 1)
+		{
+			return parseCodeBlock(code, codeLength, theme);
+		}
 
-			lineInfo->needsToBeUpdated = false;
+		SourceGrammarTree res = initCodeBlock(code, codeLength);
+		numLines = res.sourceInfo.size();
+		std::string_view codeStr = std::string_view(code, codeLength);
 
-			// If the code block string is nullptr, then we'll return early
-			if (!tree.codeBlock)
+		// Split the lines into roughly even chunks, moving each seam forward to a line that most likely
+		// starts with an empty pattern stack
+		std::vector<size_t> chunkStarts = { 0 };
+		for (size_t chunk = 1; chunk < numChunks; chunk++)
+		{
+			size_t resumeLine = findResumeLine(res, codeStr, chunk * numLines / numChunks);
+			if (resumeLine > chunkStarts[chunkStarts.size() - 1] && resumeLine < numLines)
 			{
-				return numLinesUpdated;
+				chunkStarts.push_back(resumeLine);
 			}
+		}
+		chunkStarts.push_back(numLines);
 
-			size_t start = lineInfo->byteStart;
-			while (start < lineInfo->byteStart + lineInfo->numBytes)
+		// Speculatively parse every chunk as if it started at the top of the file
+		threadPool.parallelFor(0, chunkStarts.size() - 1, 1, [&](size_t chunkBegin, size_t chunkEnd)
 			{
-				// First figure find out which pattern we were last parsing with. If we find a pattern on the line's pattern stack
-				// then we'll resume parsing this line using that pattern.
-				// Otherwise, we'll resume parsing this line with the base Grammar.
-				SyntaxPattern const* pattern = nullptr;
-				if (lineInfo->patternStack.size() > 0)
+				OnigRegion* region = onig_region_new();
+				for (size_t chunk = chunkBegin; chunk < chunkEnd; chunk++)
 				{
-					size_t lastPatternGid = lineInfo->patternStack.size() - 1;
-					if (auto patternIter = this->globalPatternIndex.find(lineInfo->patternStack[lastPatternGid].gid);
-						patternIter != this->globalPatternIndex.end())
+					for (size_t line = chunkStarts[chunk]; line < chunkStarts[chunk + 1]; line++)
 					{
-						pattern = patternIter->second;
-					}
-					else
-					{
-						g_logger_error("Somehow ended up with a pattern gid '{}' which was invalid.", lineInfo->patternStack[lastPatternGid].gid);
+						GrammarLineInfo* lineInfo = &res.sourceInfo[line];
+						resetLineInfo(*lineInfo, line > chunkStarts[chunk] ? &res.sourceInfo[line - 1] : nullptr);
+						parseLine(*this, lineInfo, codeStr, theme, region);
 					}
 				}
+				onig_region_free(region, 1);
+			}, "Grammar_ParseChunk");
 
-				// Next, resume parsing. If we find more matches and we're not at the end of the line yet, then
-				// continue parsing starting from the end of the final match. Otherwise, we'll stop parsing.
-
-				// TODO: Way too many parameters, compact into a helper struct
-				if (pattern)
-				{
-					g_logger_assert(pattern->type == PatternType::Complex, "Cannot resume parsing except from complex patterns.");
-					g_logger_assert(pattern->complexPattern.has_value(), "Invalid complex pattern encountered.");
-
-					auto const& resumeInfo = lineInfo->patternStack[lineInfo->patternStack.size() - 1];
-
-					auto span = pattern->complexPattern->resumeParse(
-						*lineInfo,
-						std::string(tree.codeBlock, tree.codeBlock + tree.codeLength),
-						theme,
-						start,
-						resumeInfo.dynamicEndPatternStr,
-						resumeInfo.anchor,
-						start,
-						lineInfo->byteStart + lineInfo->numBytes,
-						this->repository,
-						region,
-						this
-					);
-
-					size_t newCursorPos = span.matchEnd;
-					if (span.matchEnd == span.matchStart || newCursorPos >= lineInfo->byteStart + lineInfo->numBytes)
-					{
-						// TODO: This duplicates a block slightly below, see if they should be combined
-
-						// Found all the matches for this line, we can stop parsing now
-						// If no matches were found, just add an empty token so we have comprehensive coverage with all tokens
-						if (lineInfo->tokens.size() == 0)
-						{
-							SourceSyntaxToken emptyToken = {};
-							emptyToken.relativeStart = 0;
-							emptyToken.style = theme.match(lineInfo->ancestors);
-							lineInfo->tokens.emplace_back(emptyToken);
-							newCursorPos = lineInfo->byteStart + lineInfo->numBytes;
-						}
-
-						// Likewise, if we didn't find a match and we still haven't reached the end of the line,
-						// then push an empty token with the current ancestors
-						if (newCursorPos < lineInfo->byteStart + lineInfo->numBytes)
-						{
-							SourceSyntaxToken emptyToken = {};
-							emptyToken.relativeStart = (uint32)(newCursorPos - lineInfo->byteStart);
-							emptyToken.style = theme.match(lineInfo->ancestors);
-							lineInfo->tokens.emplace_back(emptyToken);
-						}
-						break;
-					}
-
-					start = newCursorPos;
-				}
-				else
-				{
-					auto span = this->patterns.tryParse(
-						*lineInfo,
-						std::string(tree.codeBlock, tree.codeBlock + tree.codeLength),
-						theme,
-						lineInfo->byteStart,
-						start,
-						lineInfo->byteStart + lineInfo->numBytes,
-						this->repository,
-						region,
-						this
-					);
-
-					size_t newCursorPos = span.matchEnd;
-					if (span.matchEnd == span.matchStart || newCursorPos >= lineInfo->byteStart + lineInfo->numBytes)
-					{
-						// Found all the matches for this line, we can stop parsing now
-						// If no matches were found, just add an empty token so we have comprehensive coverage with all tokens
-						if (lineInfo->tokens.size() == 0)
-						{
-							SourceSyntaxToken emptyToken = {};
-							emptyToken.relativeStart = 0;
-							emptyToken.style = theme.match(lineInfo->ancestors);
-							lineInfo->tokens.emplace_back(emptyToken);
-							newCursorPos = lineInfo->byteStart + lineInfo->numBytes;
-						}
-
-						// Likewise, if we didn't find a match and we still haven't reached the end of the line,
-						// then push an empty token with the current ancestors
-						if (newCursorPos < lineInfo->byteStart + lineInfo->numBytes)
-						{
-							SourceSyntaxToken emptyToken = {};
-							emptyToken.relativeStart = (uint32)(newCursorPos - lineInfo->byteStart);
-							emptyToken.style = theme.match(lineInfo->ancestors);
-							lineInfo->tokens.emplace_back(emptyToken);
-						}
-						break;
-					}
-
-					start = newCursorPos;
-				}
+		// Then verify the seams in order. If the line before a seam didn't end with the empty state the chunk
+		// assumed, re-parse from the seam until the state agrees with what the chunk came up with.
+		OnigRegion* region = onig_region_new();
+		size_t verifiedUntil = 0;
+		for (size_t chunk = 1; chunk < chunkStarts.size() - 1; chunk++)
+		{
+			size_t seam = chunkStarts[chunk];
+			if (seam < verifiedUntil)
+			{
+				// An earlier re-parse already ran past this seam
+				continue;
 			}
 
-			// If the pattern stack for this line didn't change, then we don't need to parse any more lines
-			if (lineInfo->patternStack == oldPatternStack)
+			GrammarLineInfo const& lineBeforeSeam = res.sourceInfo[seam - 1];
+			if (lineBeforeSeam.patternStack.size() == 0 && lineBeforeSeam.ancestors.size() == 0)
 			{
-				return numLinesUpdated;
+				continue;
 			}
 
-			byteOffset = lineInfo->byteStart + lineInfo->numBytes;
-			numLinesUpdated++;
-			currentLineInfoIndex++;
-		}
-
-		// If we get to here, mark the next line as needing an update just in case.
-		// That way the caller can pick up parsing again if needed when they scroll or something
-		if (currentLineInfoIndex < tree.sourceInfo.size())
-		{
-			tree.sourceInfo[currentLineInfoIndex].needsToBeUpdated = true;
-		}
+			size_t line = seam;
+			while (line < numLines)
+			{
+				GrammarLineInfo* lineInfo = &res.sourceInfo[line];
+				std::vector<GrammarResumeParseInfo> speculativePatternStack = lineInfo->patternStack;
+				std::vector<ScopedName> speculativeAncestors = lineInfo->ancestors;
 
-		return numLinesUpdated - 1;
-	}
+				resetLineInfo(*lineInfo, &res.sourceInfo[line - 1]);
+				parseLine(*this, lineInfo, codeStr, theme, region);
+				line++;
 
-	SourceGrammarTree Grammar::parseCodeBlock(const char* code, size_t codeLength, SyntaxTheme const& theme) const
-	{
-		SourceGrammarTree res = initCodeBlock(code, codeLength);
+				if (lineInfo->patternStack == speculativePatternStack && ancestorsMatch(lineInfo->ancestors, speculativeAncestors))
+				{
+					break;
+				}
+			}
 
-		size_t currentLine = 1;
-		while (currentLine <= res.sourceInfo.size())
-		{
-			currentLine += updateFromByte(res, theme, res.sourceInfo[currentLine - 1].byteStart);
+			verifiedUntil = line;
 		}
+		onig_region_free(region, 1);
 
 		return res;
 	}
@@ -1305,23 +1248,256 @@ namespace MathAnim
 			}
 			grammar->repository.patterns = {};
 
-			if (grammar->region)
+			g_memory_delete(grammar);
+		}
+	}
+
+	// ----------- Internal Functions -----------
+	static size_t updateLines(Grammar const& grammar, SourceGrammarTree& tree, std::string_view code, SyntaxTheme const& theme, size_t lineIndex, size_t maxNumLinesToUpdate, OnigRegion* region)
+	{
+		size_t numLinesUpdated = 1;
+		size_t currentLineInfoIndex = lineIndex;
+		while (numLinesUpdated <= maxNumLinesToUpdate)
+		{
+			if (currentLineInfoIndex >= tree.sourceInfo.size())
 			{
-				onig_region_free(grammar->region, 1);
+				return numLinesUpdated;
 			}
-			grammar->region = nullptr;
 
-			g_memory_delete(grammar);
+			GrammarLineInfo* lineInfo = &tree.sourceInfo[currentLineInfoIndex];
+			GrammarLineInfo const* prevLineInfo = currentLineInfoIndex > 0
+				? &tree.sourceInfo[currentLineInfoIndex - 1]
+				: nullptr;
+
+			// Keep track of the old pattern stack so we know if we need to continue parsing the next line
+			std::vector<GrammarResumeParseInfo> oldPatternStack = lineInfo->patternStack;
+
+			// Reset this line's info to all the previous lines stuff since it will carry forward from there
+			resetLineInfo(*lineInfo, prevLineInfo);
+
+			// If the code block string is nullptr, then we'll return early
+			if (!tree.codeBlock)
+			{
+				return numLinesUpdated;
+			}
+
+			parseLine(grammar, lineInfo, code, theme, region);
+
+			// If the pattern stack for this line didn't change, then we don't need to parse any more lines
+			if (lineInfo->patternStack == oldPatternStack)
+			{
+				return numLinesUpdated;
+			}
+
+			numLinesUpdated++;
+			currentLineInfoIndex++;
+		}
+
+		// If we get to here, mark the next line as needing an update just in case.
+		// That way the caller can pick up parsing again if needed when they scroll or something
+		if (currentLineInfoIndex < tree.sourceInfo.size())
+		{
+			tree.sourceInfo[currentLineInfoIndex].needsToBeUpdated = true;
 		}
+
+		return numLinesUpdated - 1;
+	}
+
+	static void resetLineInfo(GrammarLineInfo& lineInfo, GrammarLineInfo const* prevLineInfo)
+	{
+		if (prevLineInfo)
+		{
+			lineInfo.ancestors = prevLineInfo->ancestors;
+			lineInfo.patternStack = prevLineInfo->patternStack;
+		}
+		else
+		{
+			lineInfo.ancestors = {};
+			lineInfo.patternStack = {};
+		}
+		lineInfo.tokens = {};
+		lineInfo.needsToBeUpdated = false;
+	}
+
+	static void parseLine(Grammar const& grammar, GrammarLineInfo* lineInfo, std::string_view code, SyntaxTheme const& theme, OnigRegion* region)
+	{
+		size_t start = lineInfo->byteStart;
+		while (start < lineInfo->byteStart + lineInfo->numBytes)
+		{
+			// First figure find out which pattern we were last parsing with. If we find a pattern on the line's pattern stack
+			// then we'll resume parsing this line using that pattern.
+			// Otherwise, we'll resume parsing this line with the base Grammar.
+			SyntaxPattern const* pattern = nullptr;
+			if (lineInfo->patternStack.size() > 0)
+			{
+				size_t lastPatternGid = lineInfo->patternStack.size() - 1;
+				if (auto patternIter = grammar.globalPatternIndex.find(lineInfo->patternStack[lastPatternGid].gid);
+					patternIter != grammar.globalPatternIndex.end())
+				{
+					pattern = patternIter->second;
+				}
+				else
+				{
+					g_logger_error("Somehow ended up with a pattern gid '{}' which was invalid.", lineInfo->patternStack[lastPatternGid].gid);
+				}
+			}
+
+			// Next, resume parsing. If we find more matches and we're not at the end of the line yet, then
+			// continue parsing starting from the end of the final match. Otherwise, we'll stop parsing.
+
+			// TODO: Way too many parameters, compact into a helper struct
+			if (pattern)
+			{
+				g_logger_assert(pattern->type == PatternType::Complex, "Cannot resume parsing except from complex patterns.");
+				g_logger_assert(pattern->complexPattern.has_value(), "Invalid complex pattern encountered.");
+
+				auto const& resumeInfo = lineInfo->patternStack[lineInfo->patternStack.size() - 1];
+
+				auto span = pattern->complexPattern->resumeParse(
+					*lineInfo,
+					code,
+					theme,
+					start,
+					resumeInfo.dynamicEndPatternStr,
+					resumeInfo.anchor,
+					start,
+					lineInfo->byteStart + lineInfo->numBytes,
+					grammar.repository,
+					region,
+					&grammar
+				);
+
+				size_t newCursorPos = span.matchEnd;
+				if (span.matchEnd == span.matchStart || newCursorPos >= lineInfo->byteStart + lineInfo->numBytes)
+				{
+					// TODO: This duplicates a block slightly below, see if they should be combined
+
+					// Found all the matches for this line, we can stop parsing now
+					// If no matches were found, just add an empty token so we have comprehensive coverage with all tokens
+					if (lineInfo->tokens.size() == 0)
+					{
+						SourceSyntaxToken emptyToken = {};
+						emptyToken.relativeStart = 0;
+						emptyToken.style = theme.match(lineInfo->ancestors);
+						lineInfo->tokens.emplace_back(emptyToken);
+						newCursorPos = lineInfo->byteStart + lineInfo->numBytes;
+					}
+
+					// Likewise, if we didn't find a match and we still haven't reached the end of the line,
+					// then push an empty token with the current ancestors
+					if (newCursorPos < lineInfo->byteStart + lineInfo->numBytes)
+					{
+						SourceSyntaxToken emptyToken = {};
+						emptyToken.relativeStart = (uint32)(newCursorPos - lineInfo->byteStart);
+						emptyToken.style = theme.match(lineInfo->ancestors);
+						lineInfo->tokens.emplace_back(emptyToken);
+					}
+					break;
+				}
+
+				start = newCursorPos;
+			}
+			else
+			{
+				auto span = grammar.patterns.tryParse(
+					*lineInfo,
+					code,
+					theme,
+					lineInfo->byteStart,
+					start,
+					lineInfo->byteStart + lineInfo->numBytes,
+					grammar.repository,
+					region,
+					&grammar
+				);
+
+				size_t newCursorPos = span.matchEnd;
+				if (span.matchEnd == span.matchStart || newCursorPos >= lineInfo->byteStart + lineInfo->numBytes)
+				{
+					// Found all the matches for this line, we can stop parsing now
+					// If no matches were found, just add an empty token so we have comprehensive coverage with all tokens
+					if (lineInfo->tokens.size() == 0)
+					{
+						SourceSyntaxToken emptyToken = {};
+						emptyToken.relativeStart = 0;
+						emptyToken.style = theme.match(lineInfo->ancestors);
+						lineInfo->tokens.emplace_back(emptyToken);
+						newCursorPos = lineInfo->byteStart + lineInfo->numBytes;
+					}
+
+					// Likewise, if we didn't find a match and we still haven't reached the end of the line,
+					// then push an empty token with the current ancestors
+					if (newCursorPos < lineInfo->byteStart + lineInfo->numBytes)
+					{
+						SourceSyntaxToken emptyToken = {};
+						emptyToken.relativeStart = (uint32)(newCursorPos - lineInfo->byteStart);
+						emptyToken.style = theme.match(lineInfo->ancestors);
+						lineInfo->tokens.emplace_back(emptyToken);
+					}
+					break;
+				}
+
+				start = newCursorPos;
+			}
+		}
+	}
+
+	static size_t findResumeLine(SourceGrammarTree const& tree, std::string_view code, size_t targetLine)
+	{
+		// A line at column 0 right after a blank line is almost always a new top-level statement (a function,
+		// a class, an #include...) which doesn't continue a multiline pattern. If the guess is wrong the seam
+		// check catches it, so this only needs to be right most of the time.
+		size_t lastLineToCheck = glm::min(targetLine + maxResumeLineSearch, tree.sourceInfo.size());
+		for (size_t line = glm::max(targetLine, (size_t)1); line < lastLineToCheck; line++)
+		{
+			GrammarLineInfo const& prevLineInfo = tree.sourceInfo[line - 1];
+			GrammarLineInfo const& lineInfo = tree.sourceInfo[line];
+			if (lineInfo.numBytes == 0 || std::isspace((unsigned char)code[lineInfo.byteStart]))
+			{
+				continue;
+			}
+
+			bool prevLineIsBlank = true;
+			for (size_t i = prevLineInfo.byteStart; i < prevLineInfo.byteStart + prevLineInfo.numBytes; i++)
+			{
+				if (!std::isspace((unsigned char)code[i]))
+				{
+					prevLineIsBlank = false;
+					break;
+				}
+			}
+
+			if (prevLineIsBlank)
+			{
+				return line;
+			}
+		}
+
+		return targetLine;
+	}
+
+	static bool ancestorsMatch(std::vector<ScopedName> const& a, std::vector<ScopedName> const& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (!a[i].strictEquals(b[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
 	}
 
-	// ----------- Internal Functions -----------
 	static Grammar* importGrammarFromJson(const json& j)
 	{
 		Grammar* res = g_memory_new Grammar();
 
-		res->region = onig_region_new();
-
 		if (j.contains("name"))
 		{
 			res->name = j["name"];
@@ -1593,11 +1769,11 @@ namespace MathAnim
 
 	// --- Construct Regset Helpers ---
 
-	static void addPatternToRegset(OnigRegSet* regset, PatternArray& ogPatternArray, SyntaxPattern& pattern, const Grammar* self, uint64 patternArrayIndex)
+	static void addPatternToRegset(PatternArray& ogPatternArray, SyntaxPattern& pattern, const Grammar* self, uint64 patternArrayIndex)
 	{
-		int addRegToSetErr = ONIG_NORMAL;
+		OnigRegex regex = nullptr;
 		bool addedRegex = true;
-		size_t onigIndex = (size_t)onig_regset_number_of_regex(regset);
+		size_t onigIndex = ogPatternArray.regexes.size();
 
 		pattern.patternArrayIndex = patternArrayIndex;
 
@@ -1606,14 +1782,16 @@ namespace MathAnim
 		case PatternType::Simple:
 			if (pattern.simplePattern.has_value())
 			{
-				addRegToSetErr = onig_regset_add(regset, pattern.simplePattern->regMatch);
+				regex = pattern.simplePattern->regMatch;
 			}
+			addedRegex = regex != nullptr;
 			break;
 		case PatternType::Complex:
 			if (pattern.complexPattern.has_value())
 			{
-				addRegToSetErr = onig_regset_add(regset, pattern.complexPattern->begin);
+				regex = pattern.complexPattern->begin;
 			}
+			addedRegex = regex != nullptr;
 			break;
 		case PatternType::Include:
 			if (pattern.patternInclude.has_value())
@@ -1622,7 +1800,7 @@ namespace MathAnim
 				auto iter = self->repository.patterns.find(includeName);
 				if (iter != self->repository.patterns.end())
 				{
-					addPatternToRegset(regset, ogPatternArray, *iter->second, self, patternArrayIndex);
+					addPatternToRegset(ogPatternArray, *iter->second, self, patternArrayIndex);
 				}
 				else if (includeName == "$self")
 				{
@@ -1639,7 +1817,7 @@ namespace MathAnim
 			{
 				for (const auto& subPattern : pattern.patternArray->patterns)
 				{
-					addPatternToRegset(regset, ogPatternArray, *subPattern, self, patternArrayIndex);
+					addPatternToRegset(ogPatternArray, *subPattern, self, patternArrayIndex);
 				}
 
 				addedRegex = false;
@@ -1649,13 +1827,12 @@ namespace MathAnim
 			break;
 		}
 
-		if (addRegToSetErr != ONIG_NORMAL)
+		if (regex)
 		{
-			char s[ONIG_MAX_ERROR_MESSAGE_LEN];
-			onig_error_code_to_str((UChar*)s, addRegToSetErr);
-			g_logger_error("Oniguruma Regset::Add Error: '{}'", &s[0]);
+			ogPatternArray.regexes.push_back(regex);
 		}
-		else if (addedRegex)
+
+		if (addedRegex)
 		{
 			ogPatternArray.onigIndexMap[onigIndex] = pattern.gid;
 		}
@@ -1722,23 +1899,15 @@ namespace MathAnim
 
 	static void constructRegsetFromPatterns(PatternArray& patternArray, Grammar* self)
 	{
-		// Create regset that contains all patterns/include_patterns in this array
-		int parseRes = onig_regset_new(&patternArray.regset, 0, NULL);
-		if (parseRes != ONIG_NORMAL)
-		{
-			char s[ONIG_MAX_ERROR_MESSAGE_LEN];
-			onig_error_code_to_str((UChar*)s, parseRes);
-			g_logger_error("Oniguruma Regset::Create Error: '{}'", &s[0]);
-			return;
-		}
-
+		// Collect the regexes of all patterns/include_patterns in this array
+		patternArray.regexes = {};
 		patternArray.firstSelfPatternArrayIndex = UINT64_MAX;
 
 		// Add each pattern to the regset
 		uint64 patternArrayIndex = 0;
 		for (const auto& pattern : patternArray.patterns)
 		{
-			addPatternToRegset(patternArray.regset, patternArray, *pattern, self, patternArrayIndex);
+			addPatternToRegset(patternArray, *pattern, self, patternArrayIndex);
 			patternArrayIndex++;
 
 			// Also construct any regexes recursively
@@ -1787,12 +1956,12 @@ namespace MathAnim
 		return reg;
 	}
 
-	static int getFirstValidMatchInRange(const std::string& str, size_t anchor, size_t startOffset, size_t endOffset, OnigRegex reg, OnigRegion* region)
+	static int getFirstValidMatchInRange(std::string_view str, size_t anchor, size_t startOffset, size_t endOffset, OnigRegex reg, OnigRegion* region)
 	{
 		g_logger_assert(startOffset <= str.size(), "Invalid startOffset: startOffset > str.size(): '{}' > '{}'", startOffset, str.size());
 		g_logger_assert(endOffset <= str.size(), "Invalid endOffset: endOffset > str.size(): '{}' > '{}'", endOffset, str.size());
 
-		const char* targetStr = str.c_str();
+		const char* targetStr = str.data();
 		const char* targetStrEnd = targetStr + str.length();
 
 		const char* searchEnd = targetStr + endOffset;
@@ -1860,7 +2029,7 @@ namespace MathAnim
 		return searchRes;
 	}
 
-	static ScopedName getScopeWithCaptures(const std::string& str, const ScopedName& originalScope, const OnigRegion* region)
+	static ScopedName getScopeWithCaptures(std::string_view str, const ScopedName& originalScope, const OnigRegion* region)
 	{
 		ScopedName res = originalScope;
 
@@ -1890,7 +2059,7 @@ namespace MathAnim
 		return res;
 	}
 
-	static void getFirstMatchInRegset(const std::string& str, size_t anchor, size_t startOffset, size_t endOffset, const PatternArray& pattern, int* patternMatched)
+	static void getFirstMatchInRegset(std::string_view str, size_t anchor, size_t startOffset, size_t endOffset, const PatternArray& pattern, int* patternMatched)
 	{
 		if (endOffset < startOffset)
 		{
@@ -1907,7 +2076,7 @@ namespace MathAnim
 			return;
 		}
 
-		const char* targetStr = str.c_str();
+		const char* targetStr = str.data();
 		const char* targetStrEnd = targetStr + str.length();
 
 		const char* searchStart = targetStr + startOffset;
@@ -1915,31 +2084,48 @@ namespace MathAnim
 
 		bool startIsAnchorPos = anchor == startOffset;
 
-		int strMatchPos;
-		int searchRes = onig_regset_search(
-			pattern.regset,
-			(uint8*)targetStr,
-			(uint8*)targetStrEnd,
-			(uint8*)searchStart,
-			(uint8*)searchEnd,
-			ONIG_REGSET_POSITION_LEAD,
-			startIsAnchorPos
-			? ONIG_OPTION_NONE
-			: ONIG_OPTION_NOT_BEGIN_POSITION,
-			&strMatchPos
-		);
+		// NOTE: This searches the regexes one at a time instead of using an OnigRegSet. Regsets keep the match
+		//       regions inside the set, so they can't be searched from more than one thread at a time.
+		//
+		//       Same as ONIG_REGSET_POSITION_LEAD, the regex that matches earliest wins and ties go to the
+		//       regex that comes first. Every search only has to look up to the best match found so far.
+		*patternMatched = -1;
+		const char* bestMatch = searchEnd;
+		for (size_t i = 0; i < pattern.regexes.size(); i++)
+		{
+			int searchRes = onig_search(
+				pattern.regexes[i],
+				(uint8*)targetStr,
+				(uint8*)targetStrEnd,
+				(uint8*)searchStart,
+				(uint8*)bestMatch,
+				nullptr,
+				startIsAnchorPos
+				? ONIG_OPTION_NONE
+				: ONIG_OPTION_NOT_BEGIN_POSITION
+			);
 
-		if (searchRes != ONIG_MISMATCH && searchRes < 0)
-		{
-			// Error
-			char s[ONIG_MAX_ERROR_MESSAGE_LEN];
-			onig_error_code_to_str((UChar*)s, searchRes);
-			g_logger_error("Oniguruma Error: '{}'", &s[0]);
-			*patternMatched = -1;
-		}
-		else
-		{
-			*patternMatched = searchRes;
+			if (searchRes >= 0)
+			{
+				if (*patternMatched == -1 || targetStr + searchRes < bestMatch)
+				{
+					*patternMatched = (int)i;
+					bestMatch = targetStr + searchRes;
+				}
+
+				if (bestMatch == searchStart)
+				{
+					// Nothing can match earlier than this
+					break;
+				}
+			}
+			else if (searchRes != ONIG_MISMATCH)
+			{
+				// Error
+				char s[ONIG_MAX_ERROR_MESSAGE_LEN];
+				onig_error_code_to_str((UChar*)s, searchRes);
+				g_logger_error("Oniguruma Error: '{}'", &s[0]);
+			}
 		}
 	}
 
@@ -1955,8 +2141,7 @@ namespace MathAnim
 				token.relativeStart = (uint32)(currentByte - line.byteStart);
 				token.style = theme.match(line.ancestors);
 
-				// TODO: OPTIMIZE: Profile how expensive this is and consider moving to debug only
-				token.debugAncestorStack = line.ancestors;
+				token.ancestorStackId = ScopeStacks::intern(line.ancestors);
 
 				line.tokens.emplace_back(token);
 			}
@@ -1977,7 +2162,7 @@ namespace MathAnim
 		{
 			// Push a token to fill in the gap
 			SourceSyntaxToken token = {};
-			token.debugAncestorStack = line.ancestors;
+			token.ancestorStackId = ScopeStacks::intern(line.ancestors);
 			token.relativeStart = (uint32)(currentByte - line.byteStart);
 			token.style = theme.match(line.ancestors);
 
@@ -2018,8 +2203,7 @@ namespace MathAnim
 				token.relativeStart = (uint32)(currentByte - line.byteStart);
 				token.style = theme.match(line.ancestors);
 
-				// TODO: OPTIMIZE: Profile how expensive this is and consider moving to debug only
-				token.debugAncestorStack = line.ancestors;
+				token.ancestorStackId = ScopeStacks::intern(line.ancestors);
 
 				line.tokens.emplace_back(token);
 
@@ -2038,8 +2222,7 @@ namespace MathAnim
 				token.relativeStart = (uint32)(currentByte - line.byteStart);
 				token.style = theme.match(line.ancestors);
 
-				// TODO: OPTIMIZE: Profile how expensive this is and consider moving to debug only
-				token.debugAncestorStack = line.ancestors;
+				token.ancestorStackId = ScopeStacks::intern(line.ancestors);
 
 				line.tokens.emplace_back(token);
 
@@ -2073,8 +2256,7 @@ namespace MathAnim
 			token.relativeStart = (uint32)(currentByte - line.byteStart);
 			token.style = theme.match(line.ancestors);
 
-			// TODO: OPTIMIZE: Profile how expensive this is and consider moving to debug only
-			token.debugAncestorStack = line.ancestors;
+			token.ancestorStackId = ScopeStacks::intern(line.ancestors);
 
 			line.tokens.emplace_back(token);
 
@@ -2088,7 +2270,7 @@ namespace MathAnim
 		return maxEndPosition;
 	}
 
-	static std::optional<GrammarMatchV2> getFirstMatchV2(const std::string& str, size_t anchor, size_t startOffset, size_t endOffset, OnigRegex reg, OnigRegion* region, const std::optional<ScopedName>& scope)
+	static std::optional<GrammarMatchV2> getFirstMatchV2(std::string_view str, size_t anchor, size_t startOffset, size_t endOffset, OnigRegex reg, OnigRegion* region, const std::optional<ScopedName>& scope)
 	{
 		std::optional<GrammarMatchV2> res = std::nullopt;
 
@@ -2122,13 +2304,13 @@ namespace MathAnim
 			char s[ONIG_MAX_ERROR_MESSAGE_LEN];
 			onig_error_code_to_str((UChar*)s, searchRes);
 			g_logger_error("Oniguruma Error: '{}'", s);
-			onig_region_free(region, 1 /* 1:free self, 0:free contents only */);
+			onig_region_clear(region);
 		}
 
 		return res;
 	}
 
-	static std::vector<GrammarMatchV2> getCapturesV2(GrammarLineInfo& line, const std::string& str, SyntaxTheme const& theme, const PatternRepository& repo, OnigRegion* region, std::optional<CaptureList> captures, Grammar const* self)
+	static std::vector<GrammarMatchV2> getCapturesV2(GrammarLineInfo& line, std::string_view str, SyntaxTheme const& theme, const PatternRepository& repo, OnigRegion* region, std::optional<CaptureList> captures, Grammar const* self)
 	{
 		std::vector<GrammarMatchV2> res = {};
 
@@ -2170,15 +2352,16 @@ namespace MathAnim
 
 								// The ancestor stack should only ever be one deeper than our current stack. If it's deeper than that, 
 								// then I have no clue what's going on here.
-								g_logger_assert(currentToken.debugAncestorStack.size() <= line.ancestors.size() + 1, "Capture group can only use pattern arrays that recurse no more than once.");
-								g_logger_assert(currentToken.debugAncestorStack.size() > 0, "Must have at least one valid scope for a capture.");
+								size_t ancestorStackDepth = ScopeStacks::getDepth(currentToken.ancestorStackId);
+								g_logger_assert(ancestorStackDepth <= line.ancestors.size() + 1, "Capture group can only use pattern arrays that recurse no more than once.");
+								g_logger_assert(ancestorStackDepth > 0, "Must have at least one valid scope for a capture.");
 
 								GrammarMatchV2 dummyMatch = {};
 								dummyMatch.start = currentToken.relativeStart + line.byteStart;
 								dummyMatch.end = i < lineShallowCopy.tokens.size() - 1
 									? lineShallowCopy.tokens[i + 1].relativeStart + line.byteStart
 									: captureEnd;
-								dummyMatch.scope = currentToken.debugAncestorStack[currentToken.debugAncestorStack.size() - 1];
+								dummyMatch.scope = ScopeStacks::getTop(currentToken.ancestorStackId);
 								res.emplace_back(dummyMatch);
 							}
 						}
@@ -0,0 +1,193 @@
+#include "parsers/ScopeStack.h"
+
+#include <shared_mutex>
+
+namespace MathAnim
+{
+	namespace ScopeStacks
+	{
+		struct ScopeStackNode
+		{
+			ScopeStackId parent;
+			uint32 depth;
+			ScopedName scope;
+		};
+
+		// The node for id N is stored at index N - 1, the empty stack doesn't have a node
+		static std::vector<ScopeStackNode> nodes = {};
+		// Hash of (parent id, scope) -> every node with that hash
+		static std::unordered_multimap<uint64, ScopeStackId> children = {};
+		static std::shared_mutex nodesMtx;
+
+		// ------------- Internal Functions -------------
+		static uint64 hashChild(ScopeStackId parent, ScopedName const& scope);
+		static bool scopesEqual(ScopedName const& a, ScopedName const& b);
+		static ScopeStackId findChild(ScopeStackId parent, ScopedName const& scope, uint64 hash);
+
+		ScopeStackId intern(std::vector<ScopedName> const& stack)
+		{
+			ScopeStackId res = EMPTY_SCOPE_STACK;
+			size_t depth = 0;
+
+			// Almost every stack has been seen before, so get as far as we can with the shared lock
+			{
+				std::shared_lock<std::shared_mutex> lock(nodesMtx);
+				for (; depth < stack.size(); depth++)
+				{
+					ScopeStackId child = findChild(res, stack[depth], hashChild(res, stack[depth]));
+					if (child == EMPTY_SCOPE_STACK)
+					{
+						break;
+					}
+
+					res = child;
+				}
+			}
+
+			if (depth == stack.size())
+			{
+				return res;
+			}
+
+			std::unique_lock<std::shared_mutex> lock(nodesMtx);
+			for (; depth < stack.size(); depth++)
+			{
+				// Check again, another thread could've added this node in between the locks
+				uint64 hash = hashChild(res, stack[depth]);
+				ScopeStackId child = findChild(res, stack[depth], hash);
+				if (child == EMPTY_SCOPE_STACK)
+				{
+					ScopeStackNode node = {};
+					node.parent = res;
+					node.depth = (uint32)(depth + 1);
+					node.scope = stack[depth];
+					nodes.emplace_back(node);
+
+					child = (ScopeStackId)nodes.size();
+					children.emplace(hash, child);
+				}
+
+				res = child;
+			}
+
+			return res;
+		}
+
+		std::vector<ScopedName> get(ScopeStackId id)
+		{
+			std::shared_lock<std::shared_mutex> lock(nodesMtx);
+			if (id == EMPTY_SCOPE_STACK || id > nodes.size())
+			{
+				return {};
+			}
+
+			std::vector<ScopedName> res = {};
+			res.resize(nodes[id - 1].depth);
+			while (id != EMPTY_SCOPE_STACK)
+			{
+				ScopeStackNode const& node = nodes[id - 1];
+				res[node.depth - 1] = node.scope;
+				id = node.parent;
+			}
+
+			return res;
+		}
+
+		size_t getDepth(ScopeStackId id)
+		{
+			std::shared_lock<std::shared_mutex> lock(nodesMtx);
+			if (id == EMPTY_SCOPE_STACK || id > nodes.size())
+			{
+				return 0;
+			}
+
+			return nodes[id - 1].depth;
+		}
+
+		ScopedName getTop(ScopeStackId id)
+		{
+			std::shared_lock<std::shared_mutex> lock(nodesMtx);
+			g_logger_assert(id != EMPTY_SCOPE_STACK && id <= nodes.size(), "Invalid scope stack id '{}'.", id);
+			return nodes[id - 1].scope;
+		}
+
+		size_t getNumInternedScopes()
+		{
+			std::shared_lock<std::shared_mutex> lock(nodesMtx);
+			return nodes.size();
+		}
+
+		void free()
+		{
+			std::unique_lock<std::shared_mutex> lock(nodesMtx);
+			nodes = {};
+			children = {};
+		}
+
+		// ------------- Internal Functions -------------
+		static uint64 hashChild(ScopeStackId parent, ScopedName const& scope)
+		{
+			uint64 res = std::hash<uint32>{}(parent);
+			for (auto const& dotSeparatedScope : scope.dotSeparatedScopes)
+			{
+				uint64 scopeHash = dotSeparatedScope.name.has_value()
+					? std::hash<std::string>{}(*dotSeparatedScope.name)
+					: dotSeparatedScope.capture.has_value()
+					? std::hash<std::string>{}(dotSeparatedScope.capture->capture) + (uint64)dotSeparatedScope.capture->captureIndex
+					: 0;
+				res ^= scopeHash + 0x9e3779b97f4a7c15ULL + (res << 6) + (res >> 2);
+			}
+
+			return res;
+		}
+
+		static bool scopesEqual(ScopedName const& a, ScopedName const& b)
+		{
+			if (a.dotSeparatedScopes.size() != b.dotSeparatedScopes.size())
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < a.dotSeparatedScopes.size(); i++)
+			{
+				Scope const& scopeA = a.dotSeparatedScopes[i];
+				Scope const& scopeB = b.dotSeparatedScopes[i];
+				if (scopeA.name != scopeB.name || scopeA.capture.has_value() != scopeB.capture.has_value())
+				{
+					return false;
+				}
+
+				if (scopeA.capture.has_value())
+				{
+					ScopeCapture const& captureA = *scopeA.capture;
+					ScopeCapture const& captureB = *scopeB.capture;
+					if (captureA.capture != captureB.capture ||
+						captureA.captureIndex != captureB.captureIndex ||
+						captureA.captureRegex != captureB.captureRegex ||
+						captureA.captureReplaceStart != captureB.captureReplaceStart ||
+						captureA.captureReplaceEnd != captureB.captureReplaceEnd)
+					{
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		static ScopeStackId findChild(ScopeStackId parent, ScopedName const& scope, uint64 hash)
+		{
+			auto [begin, end] = children.equal_range(hash);
+			for (auto iter = begin; iter != end; iter++)
+			{
+				ScopeStackNode const& node = nodes[iter->second - 1];
+				if (node.parent == parent && scopesEqual(node.scope, scope))
+				{
+					return iter->second;
+				}
+			}
+
+			return EMPTY_SCOPE_STACK;
+		}
+	}
+}
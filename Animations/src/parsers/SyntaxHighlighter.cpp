@@ -2,8 +2,10 @@
 #include "parsers/Grammar.h"
 #include "parsers/Common.h"
 #include "parsers/SyntaxTheme.h"
+#include "parsers/ScopeStack.h"
 #include "platform/Platform.h"
 #include "math/CMath.h"
+#include "utils/TextDocument.h"
 
 namespace MathAnim
 {
@@ -161,7 +163,7 @@ namespace MathAnim
 		return res;
 	}
 
-	CodeHighlights SyntaxHighlighter::parse(const char* code, size_t codeLength, const SyntaxTheme& theme) const
+	CodeHighlights SyntaxHighlighter::parse(const char* code, size_t codeLength, const SyntaxTheme& theme, GlobalThreadPool* threadPool) const
 	{
 		if (!this->grammar)
 		{
@@ -169,7 +171,9 @@ namespace MathAnim
 		}
 
 		CodeHighlights res = {};
-		res.tree = grammar->parseCodeBlock(code, codeLength, theme);
+		res.tree = threadPool
+			? grammar->parseCodeBlockParallel(code, codeLength, theme, *threadPool)
+			: grammar->parseCodeBlock(code, codeLength, theme);
 		res.theme = &theme;
 
 		return res;
@@ -437,14 +441,43 @@ namespace MathAnim
 		return checkForUpdatesFrom(highlights, lineIndexStartedRemovingFrom + 1, maxLinesToUpdate);
 	}
 
-	std::string SyntaxHighlighter::getStringifiedParseTreeFor(const std::string& code, SyntaxTheme const& theme) const
+	Vec2i SyntaxHighlighter::insertText(CodeHighlights& highlights, TextDocument const& document, TextEdit const& edit, size_t maxLinesToUpdate) const
+	{
+		// The grammar runs regexes over one contiguous block of text. It only views the flattened
+		// text, so the cost here is the memmove that patched it and the shift of the line starts below
+		// the edit, not a copy of the document.
+		return insertText(
+			highlights,
+			(const char*)document.getFlattenedText(),
+			document.getLength(),
+			edit.byteStart,
+			edit.byteStart + edit.numBytesInserted,
+			maxLinesToUpdate
+		);
+	}
+
+	Vec2i SyntaxHighlighter::removeText(CodeHighlights& highlights, TextDocument const& document, TextEdit const& edit, size_t maxLinesToUpdate) const
+	{
+		return removeText(
+			highlights,
+			(const char*)document.getFlattenedText(),
+			document.getLength(),
+			edit.byteStart,
+			edit.numLinesRemoved,
+			maxLinesToUpdate
+		);
+	}
+
+	std::string SyntaxHighlighter::getStringifiedParseTreeFor(const std::string& code, SyntaxTheme const& theme, GlobalThreadPool* threadPool) const
 	{
 		if (!this->grammar)
 		{
 			return {};
 		}
 
-		SourceGrammarTree grammarTree = grammar->parseCodeBlock(code.c_str(), code.length(), theme);
+		SourceGrammarTree grammarTree = threadPool
+			? grammar->parseCodeBlockParallel(code.c_str(), code.length(), theme, *threadPool)
+			: grammar->parseCodeBlock(code.c_str(), code.length(), theme);
 		return grammarTree.getStringifiedTree(*grammar);
 	}
 
@@ -555,6 +588,9 @@ namespace MathAnim
 				SyntaxTheme::free(v);
 			}
 			themes.clear();
+
+			// Token ancestor ids are only meaningful while the grammars that produced them are loaded
+			ScopeStacks::free();
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "physics/Bvh.h"
+#include "math/CMath.h"
+
+#include <algorithm>
+
+namespace MathAnim
+{
+	void Bvh::build(const std::vector<AABB>& boxes)
+	{
+		clear();
+		if (boxes.size() == 0)
+		{
+			return;
+		}
+
+		indices.resize(boxes.size());
+		for (uint32 i = 0; i < (uint32)boxes.size(); i++)
+		{
+			indices[i] = i;
+		}
+
+		// A binary tree with at least one box per leaf never has more than 2n - 1 nodes
+		nodes.reserve(boxes.size() * 2);
+		buildNode(boxes, 0, (uint32)boxes.size());
+	}
+
+	void Bvh::clear()
+	{
+		nodes.clear();
+		indices.clear();
+	}
+
+	void Bvh::raycast(const Ray& ray, std::vector<uint32>& outHits) const
+	{
+		if (nodes.size() == 0)
+		{
+			return;
+		}
+
+		uint32 stack[64];
+		int stackPtr = 0;
+		stack[stackPtr++] = 0;
+		while (stackPtr > 0)
+		{
+			uint32 nodeIndex = stack[--stackPtr];
+			const Node& node = nodes[nodeIndex];
+			if (!Physics::rayIntersectsAABB(ray, node.bounds).hit())
+			{
+				continue;
+			}
+
+			if (node.numIndices > 0)
+			{
+				for (uint32 i = node.firstIndex; i < node.firstIndex + node.numIndices; i++)
+				{
+					outHits.push_back(indices[i]);
+				}
+				continue;
+			}
+
+			stack[stackPtr++] = node.rightChild;
+			stack[stackPtr++] = nodeIndex + 1;
+		}
+	}
+
+	// ------------------ Internal functions ------------------
+	uint32 Bvh::buildNode(const std::vector<AABB>& boxes, uint32 firstIndex, uint32 numIndices)
+	{
+		uint32 nodeIndex = (uint32)nodes.size();
+		nodes.emplace_back(Node{});
+
+		AABB bounds = boxes[indices[firstIndex]];
+		AABB centroidBounds = { (bounds.min + bounds.max) / 2.0f, (bounds.min + bounds.max) / 2.0f };
+		for (uint32 i = firstIndex + 1; i < firstIndex + numIndices; i++)
+		{
+			const AABB& box = boxes[indices[i]];
+			bounds.min = CMath::min(bounds.min, box.min);
+			bounds.max = CMath::max(bounds.max, box.max);
+
+			Vec3 centroid = (box.min + box.max) / 2.0f;
+			centroidBounds.min = CMath::min(centroidBounds.min, centroid);
+			centroidBounds.max = CMath::max(centroidBounds.max, centroid);
+		}
+
+		if (numIndices <= maxBoxesPerLeaf)
+		{
+			nodes[nodeIndex] = Node{ bounds, firstIndex, numIndices, 0 };
+			return nodeIndex;
+		}
+
+		// Split in half along the axis the box centers are spread out the most on
+		Vec3 extents = centroidBounds.max - centroidBounds.min;
+		int axis = 0;
+		if (extents.y > extents.values[axis])
+		{
+			axis = 1;
+		}
+		if (extents.z > extents.values[axis])
+		{
+			axis = 2;
+		}
+
+		uint32 numLeft = numIndices / 2;
+		std::nth_element(
+			indices.begin() + firstIndex,
+			indices.begin() + firstIndex + numLeft,
+			indices.begin() + firstIndex + numIndices,
+			[&boxes, axis](uint32 a, uint32 b)
+			{
+				return boxes[a].min.values[axis] + boxes[a].max.values[axis] < boxes[b].min.values[axis] + boxes[b].max.values[axis];
+			}
+		);
+
+		// NOTE: Don't hold a reference to the node across these calls, they may reallocate the node list
+		buildNode(boxes, firstIndex, numLeft);
+		uint32 rightChild = buildNode(boxes, firstIndex + numLeft, numIndices - numLeft);
+		nodes[nodeIndex] = Node{ bounds, 0, 0, rightChild };
+
+		return nodeIndex;
+	}
+}
@@ -31,6 +31,28 @@ namespace MathAnim
 			return res;
 		}
 
+		AABB createAABB(const OBB& obb)
+		{
+			AABB res = {};
+			res.min = Vec3{ FLT_MAX, FLT_MAX, FLT_MAX };
+			res.max = Vec3{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+			for (int i = 0; i < 4; i++)
+			{
+				glm::vec4 corner = glm::vec4(
+					(i & 1) ? obb.bbox.max.x : obb.bbox.min.x,
+					(i & 2) ? obb.bbox.max.y : obb.bbox.min.y,
+					0.0f,
+					1.0f
+				);
+				Vec3 worldCorner = CMath::vector3From4(CMath::convert(obb.transformation * corner));
+				res.min = CMath::min(res.min, worldCorner);
+				res.max = CMath::max(res.max, worldCorner);
+			}
+
+			return res;
+		}
+
 		RaycastResult rayIntersectsAABB(const Ray& ray, const AABB& aabb)
 		{
 			RaycastResult res = {};
@@ -108,6 +130,43 @@ namespace MathAnim
 			return res;
 		}
 
+		RaycastResult rayIntersectsOBB(const Ray& rayGlobal, const OBB& obb)
+		{
+			// Transform the global ray into the box's local space, where it's just an AABB
+			glm::mat4 inverseTransform = glm::inverse(obb.transformation);
+			glm::vec4 rayLocalStart = inverseTransform * glm::vec4(CMath::convert(rayGlobal.origin), 1.0f);
+			glm::vec4 rayLocalEnd = inverseTransform * glm::vec4(CMath::convert(rayGlobal.origin + rayGlobal.direction * rayGlobal.length), 1.0f);
+			Ray ray = createRay(
+				CMath::vector3From4(CMath::convert(rayLocalStart)),
+				CMath::vector3From4(CMath::convert(rayLocalEnd))
+			);
+
+			AABB localBox = {};
+			localBox.min = Vec3{ obb.bbox.min.x, obb.bbox.min.y, 0.0f };
+			localBox.max = Vec3{ obb.bbox.max.x, obb.bbox.max.y, 0.0f };
+			RaycastResult localRes = rayIntersectsAABB(ray, localBox);
+
+			RaycastResult res = {};
+			res.hitFlags = RaycastHit::None;
+			res.hitEntryDistance = FLT_MAX;
+			res.hitExitDistance = FLT_MAX;
+
+			// Distances get measured again in global space since the transform may scale them
+			if (localRes.hitEntry())
+			{
+				Vec3 entry = CMath::vector3From4(CMath::convert(obb.transformation * glm::vec4(CMath::convert(localRes.entry), 1.0f)));
+				addTMinToRaycastResult(res, rayGlobal, CMath::length(entry - rayGlobal.origin));
+			}
+
+			if (localRes.hitExit())
+			{
+				Vec3 exit = CMath::vector3From4(CMath::convert(obb.transformation * glm::vec4(CMath::convert(localRes.exit), 1.0f)));
+				addTMaxToRaycastResult(res, rayGlobal, CMath::length(exit - rayGlobal.origin));
+			}
+
+			return res;
+		}
+
 		RaycastResult rayIntersectsSphere(const Ray& ray, const Sphere& sphere)
 		{
 			RaycastResult res = {};
@@ -0,0 +1,204 @@
+#include "platform/FileSystemWatcher.h"
+
+#include <algorithm>
+
+namespace MathAnim
+{
+	// A file that keeps getting written to still gets reported every so often
+	static constexpr uint32 maxDebounceWindows = 10;
+
+	// ---- Internal Functions ----
+	static FileSystemEvent coalesceEvents(FileSystemEvent prev, FileSystemEvent next);
+	static bool isInsideDirectory(const std::filesystem::path& file, const std::filesystem::path& dir);
+
+	void FileSystemWatcher::poll()
+	{
+		std::vector<std::pair<std::filesystem::path, FileSystemEvent>> readyEvents = {};
+		{
+			std::lock_guard<std::mutex> queueLock(queueMtx);
+			readyEvents = coalescer.takeReadyEvents(std::chrono::steady_clock::now(), std::chrono::milliseconds(debounceWindowMs));
+		}
+
+		// Callbacks run without the lock so the watcher thread never waits on them
+		for (auto const& [file, event] : readyEvents)
+		{
+			switch (event)
+			{
+			case FileSystemEvent::Created:
+				if (onCreated) onCreated(file);
+				break;
+			case FileSystemEvent::Changed:
+				if (onChanged) onChanged(file);
+				break;
+			case FileSystemEvent::Renamed:
+				if (onRenamed) onRenamed(file);
+				break;
+			case FileSystemEvent::Deleted:
+				if (onDeleted) onDeleted(file);
+				break;
+			case FileSystemEvent::None:
+				break;
+			}
+		}
+	}
+
+	void FileSystemWatcher::queueEvent(RawFileSystemEvent event, const std::filesystem::path& file, uint32 cookie)
+	{
+		std::lock_guard<std::mutex> queueLock(queueMtx);
+		coalescer.addEvent(event, file, cookie, std::chrono::steady_clock::now());
+	}
+
+	void FileSystemWatcher::addExistingFile(const std::filesystem::path& file)
+	{
+		std::lock_guard<std::mutex> queueLock(queueMtx);
+		coalescer.addExistingFile(file);
+	}
+
+	// ---- File System Event Coalescer ----
+	void FileSystemEventCoalescer::addEvent(RawFileSystemEvent event, const std::filesystem::path& file, uint32 cookie, std::chrono::steady_clock::time_point now)
+	{
+		switch (event)
+		{
+		case RawFileSystemEvent::Created:
+			knownFiles.insert(file);
+			queueEvent(FileSystemEvent::Created, file, now);
+			break;
+		case RawFileSystemEvent::Modified:
+			knownFiles.insert(file);
+			queueEvent(FileSystemEvent::Changed, file, now);
+			break;
+		case RawFileSystemEvent::Deleted:
+			knownFiles.erase(file);
+			queueEvent(FileSystemEvent::Deleted, file, now);
+			break;
+		case RawFileSystemEvent::MovedFrom:
+			knownFiles.erase(file);
+			if (cookie != 0)
+			{
+				movedFrom[cookie] = file;
+			}
+			queueEvent(FileSystemEvent::Deleted, file, now);
+			break;
+		case RawFileSystemEvent::MovedTo:
+		{
+			auto source = movedFrom.find(cookie);
+			bool hasSource = cookie != 0 && source != movedFrom.end();
+			if (hasSource)
+			{
+				movedFrom.erase(source);
+			}
+
+			// Replacing a file we already know about only changes its contents. Otherwise it's
+			// a real rename if the file came from inside the tree, or a new file if it didn't.
+			FileSystemEvent result = FileSystemEvent::Created;
+			if (knownFiles.find(file) != knownFiles.end())
+			{
+				result = FileSystemEvent::Changed;
+			}
+			else if (hasSource)
+			{
+				result = FileSystemEvent::Renamed;
+			}
+
+			knownFiles.insert(file);
+			queueEvent(result, file, now);
+			break;
+		}
+		}
+	}
+
+	void FileSystemEventCoalescer::addExistingFile(const std::filesystem::path& file)
+	{
+		knownFiles.insert(file);
+	}
+
+	void FileSystemEventCoalescer::removeDirectory(const std::filesystem::path& dir)
+	{
+		for (auto iter = knownFiles.begin(); iter != knownFiles.end();)
+		{
+			if (isInsideDirectory(*iter, dir))
+			{
+				iter = knownFiles.erase(iter);
+			}
+			else
+			{
+				iter++;
+			}
+		}
+	}
+
+	std::vector<std::pair<std::filesystem::path, FileSystemEvent>> FileSystemEventCoalescer::takeReadyEvents(
+		std::chrono::steady_clock::time_point now,
+		std::chrono::milliseconds debounceWindow)
+	{
+		std::vector<std::pair<std::filesystem::path, FileSystemEvent>> readyEvents = {};
+		for (auto iter = pendingEvents.begin(); iter != pendingEvents.end();)
+		{
+			PendingEvent const& pending = iter->second;
+			if (now - pending.lastEventTime < debounceWindow &&
+				now - pending.firstEventTime < debounceWindow * maxDebounceWindows)
+			{
+				iter++;
+				continue;
+			}
+
+			if (pending.event != FileSystemEvent::None)
+			{
+				readyEvents.emplace_back(iter->first, pending.event);
+			}
+			iter = pendingEvents.erase(iter);
+		}
+
+		// Renames whose other half never showed up won't get paired anymore
+		if (pendingEvents.empty())
+		{
+			movedFrom.clear();
+		}
+
+		return readyEvents;
+	}
+
+	void FileSystemEventCoalescer::queueEvent(FileSystemEvent event, const std::filesystem::path& file, std::chrono::steady_clock::time_point now)
+	{
+		auto [iter, inserted] = pendingEvents.try_emplace(file, PendingEvent{ event, now, now });
+		if (!inserted)
+		{
+			iter->second.event = coalesceEvents(iter->second.event, event);
+			iter->second.lastEventTime = now;
+		}
+	}
+
+	// ---- Internal Functions ----
+	static FileSystemEvent coalesceEvents(FileSystemEvent prev, FileSystemEvent next)
+	{
+		switch (prev)
+		{
+		case FileSystemEvent::None:
+			// The file didn't exist when the burst started
+			if (next == FileSystemEvent::Deleted) return FileSystemEvent::None;
+			if (next == FileSystemEvent::Changed) return FileSystemEvent::Created;
+			return next;
+		case FileSystemEvent::Created:
+			// Temp files that get written and then renamed away never show up at all
+			if (next == FileSystemEvent::Deleted) return FileSystemEvent::None;
+			return FileSystemEvent::Created;
+		case FileSystemEvent::Renamed:
+			if (next == FileSystemEvent::Deleted) return FileSystemEvent::Deleted;
+			return FileSystemEvent::Renamed;
+		case FileSystemEvent::Changed:
+			if (next == FileSystemEvent::Deleted) return FileSystemEvent::Deleted;
+			return FileSystemEvent::Changed;
+		case FileSystemEvent::Deleted:
+			// Deleted and written again, or replaced by a rename, is how most editors save
+			if (next == FileSystemEvent::Deleted) return FileSystemEvent::Deleted;
+			return FileSystemEvent::Changed;
+		}
+
+		return next;
+	}
+
+	static bool isInsideDirectory(const std::filesystem::path& file, const std::filesystem::path& dir)
+	{
+		return std::mismatch(dir.begin(), dir.end(), file.begin(), file.end()).first == dir.end();
+	}
+}
@@ -3,10 +3,10 @@
 #include "platform/Platform.h"
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/inotify.h>
-
-static int inotify_descriptor;
-static int watch_descriptor;
+#include <algorithm>
 
 namespace MathAnim
 {
@@ -15,11 +15,6 @@ namespace MathAnim
   }
 
   void FileSystemWatcher::start()
-  {
-    fileWatcherThread = std::thread(&FileSystemWatcher::startThread, this);
-  }
-
-  void FileSystemWatcher::startThread()
   {
     if (path.empty())
     {
@@ -29,47 +24,177 @@ namespace MathAnim
 
     Platform::createDirIfNotExists(path.string().c_str());
 
-    inotify_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
-    if (inotify_descriptor == -1)
+    // Created here instead of on the watcher thread so stop() can always wake it up
+    inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyDescriptor == -1)
     {
       g_logger_error("Failed to create FileSystemWatcher for '{}': {}", path, strerror(errno));
       return;
     }
 
-    watch_descriptor = inotify_add_watch(inotify_descriptor, path.string().c_str(), IN_MODIFY | IN_DELETE | IN_ATTRIB | IN_MOVED_TO | IN_ACCESS | IN_CREATE);
-    if (watch_descriptor == -1)
+    if (pipe2(stopPipe, O_CLOEXEC) == -1)
     {
-      close(inotify_descriptor);
-      inotify_descriptor = -1;
       g_logger_error("Failed to create FileSystemWatcher for '{}': {}", path, strerror(errno));
+      close(inotifyDescriptor);
+      inotifyDescriptor = -1;
       return;
     }
+
+    // Directory events are always needed to keep the recursive watches up to date.
+    // Access events only get watched if they're asked for, otherwise every read
+    // of a watched file would look like a change.
+    watchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB;
+    if (notifyFilters & NotifyFilters::LastAccess)
+    {
+      watchMask |= IN_ACCESS;
+    }
+
+    enableRaisingEvents = true;
+    fileWatcherThread = std::thread(&FileSystemWatcher::startThread, this);
+  }
+
+  void FileSystemWatcher::startThread()
+  {
+    addWatch("", false);
+
+    while (enableRaisingEvents)
+    {
+      pollfd fds[2] = {};
+      fds[0].fd = inotifyDescriptor;
+      fds[0].events = POLLIN;
+      fds[1].fd = stopPipe[0];
+      fds[1].events = POLLIN;
+
+      // Block until something happens, there's nothing to do in between
+      if (::poll(fds, 2, -1) == -1)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+
+        g_logger_error("Failed to poll from FileSystemWatcher for '{}': {}", path, strerror(errno));
+        break;
+      }
+
+      if (fds[1].revents != 0)
+      {
+        break;
+      }
+
+      if (fds[0].revents & POLLIN)
+      {
+        readEvents();
+      }
+    }
   }
 
   void FileSystemWatcher::stop()
   {
-    if (enableRaisingEvents)
+    enableRaisingEvents = false;
+    if (fileWatcherThread.joinable())
     {
-      enableRaisingEvents = false;
-      inotify_rm_watch(inotify_descriptor, watch_descriptor);
-      close(watch_descriptor);
-      close(inotify_descriptor);
+      constexpr uint8 wakeUp = 1;
+      if (write(stopPipe[1], &wakeUp, sizeof(wakeUp)) == -1)
+      {
+        g_logger_error("Failed to stop FileSystemWatcher for '{}': {}", path, strerror(errno));
+      }
       fileWatcherThread.join();
     }
+
+    // Closing the inotify descriptor removes all of its watches
+    if (inotifyDescriptor != -1)
+    {
+      close(inotifyDescriptor);
+      inotifyDescriptor = -1;
+    }
+
+    for (int& descriptor : stopPipe)
+    {
+      if (descriptor != -1)
+      {
+        close(descriptor);
+        descriptor = -1;
+      }
+    }
+
+    watchedDirectories.clear();
   }
 
-  void FileSystemWatcher::poll()
+  void FileSystemWatcher::addWatch(const std::filesystem::path& relativeDir, bool reportContents)
   {
-    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
-    struct inotify_event const *event;
-    ssize_t len;
+    std::filesystem::path fullDir = path / relativeDir;
+    int watchDescriptor = inotify_add_watch(inotifyDescriptor, fullDir.string().c_str(), watchMask | IN_ONLYDIR | IN_DONT_FOLLOW);
+    if (watchDescriptor == -1)
+    {
+      if (errno == ENOSPC)
+      {
+        g_logger_warning("Ran out of inotify watches while watching '{}'. Raise fs.inotify.max_user_watches to watch the whole tree.", fullDir);
+      }
+      else if (errno != ENOENT)
+      {
+        g_logger_warning("Failed to watch directory '{}': {}", fullDir, strerror(errno));
+      }
+      return;
+    }
+
+    watchedDirectories[watchDescriptor] = relativeDir;
+
+    // Anything created in this directory before the watch was added won't get an event,
+    // so walk it after the watch is in place. Symlinked directories get skipped to avoid cycles.
+    std::error_code err;
+    for (auto const& entry : std::filesystem::directory_iterator(fullDir, err))
+    {
+      std::filesystem::path relativePath = relativeDir / entry.path().filename();
+      if (entry.is_directory(err) && !entry.is_symlink(err))
+      {
+        if (includeSubdirectories)
+        {
+          addWatch(relativePath, reportContents);
+        }
+      }
+      else if (entry.is_regular_file(err))
+      {
+        if (reportContents)
+        {
+          queueEvent(RawFileSystemEvent::Created, relativePath);
+        }
+        else
+        {
+          addExistingFile(relativePath);
+        }
+      }
+    }
+  }
+
+  void FileSystemWatcher::removeWatches(const std::filesystem::path& relativeDir)
+  {
+    for (auto iter = watchedDirectories.begin(); iter != watchedDirectories.end();)
+    {
+      std::filesystem::path const& watchedDir = iter->second;
+      bool isInsideDir = std::mismatch(relativeDir.begin(), relativeDir.end(), watchedDir.begin(), watchedDir.end()).first == relativeDir.end();
+      if (isInsideDir)
+      {
+        inotify_rm_watch(inotifyDescriptor, iter->first);
+        iter = watchedDirectories.erase(iter);
+      }
+      else
+      {
+        iter++;
+      }
+    }
+  }
+
+  void FileSystemWatcher::readEvents()
+  {
+    alignas(inotify_event) char buf[16 * 1024];
 
-    while (inotify_descriptor != -1 && watch_descriptor != -1)
+    while (true)
     {
-      len = read(inotify_descriptor, buf, sizeof(buf));
+      ssize_t len = read(inotifyDescriptor, buf, sizeof(buf));
       if (len == -1 && errno != EAGAIN)
       {
-        g_logger_error("Failed to poll from FileSystemWatcher for '{}': {}", path, strerror(errno));
+        g_logger_error("Failed to read events from FileSystemWatcher for '{}': {}", path, strerror(errno));
         return;
       }
 
@@ -79,33 +204,72 @@ namespace MathAnim
         return;
       }
 
-      for (char *ptr = buf; ptr < buf + len; ptr += sizeof(struct inotify_event) + event->len)
+      inotify_event const* event = nullptr;
+      for (char* ptr = buf; ptr < buf + len; ptr += sizeof(inotify_event) + event->len)
       {
-        event = (struct inotify_event const *)ptr;
+        event = (inotify_event const*)ptr;
 
-        if (event->mask & (IN_ISDIR | IN_IGNORED))
+        if (event->mask & IN_Q_OVERFLOW)
         {
+          g_logger_warning("FileSystemWatcher for '{}' overflowed its event queue, some changes were missed.", path);
           continue;
         }
 
-        if (onChanged && event->mask & (IN_MODIFY | IN_ACCESS | IN_ATTRIB))
+        auto watchedDir = watchedDirectories.find(event->wd);
+        if (watchedDir == watchedDirectories.end())
         {
-          onChanged(std::filesystem::path(event->name));
+          continue;
         }
 
-        if (onRenamed && event->mask & IN_MOVED_TO)
+        if (event->mask & IN_IGNORED)
         {
-          onRenamed(std::filesystem::path(event->name));
+          // The directory was deleted or its watch got removed
+          watchedDirectories.erase(watchedDir);
+          continue;
         }
 
-        if (onDeleted && event->mask & IN_DELETE)
+        if (event->len == 0)
         {
-          onDeleted(std::filesystem::path(event->name));
+          // Events for the watched directory itself
+          continue;
         }
 
-        if (onCreated && event->mask & IN_CREATE)
+        std::filesystem::path relativePath = watchedDir->second / event->name;
+        if (event->mask & IN_ISDIR)
+        {
+          if (includeSubdirectories && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+          {
+            addWatch(relativePath, true);
+          }
+          else if (includeSubdirectories && (event->mask & IN_MOVED_FROM))
+          {
+            removeWatches(relativePath);
+            std::lock_guard<std::mutex> queueLock(queueMtx);
+            coalescer.removeDirectory(relativePath);
+          }
+
+          continue;
+        }
+
+        if (event->mask & IN_CREATE)
+        {
+          queueEvent(RawFileSystemEvent::Created, relativePath);
+        }
+        else if (event->mask & IN_MOVED_TO)
+        {
+          queueEvent(RawFileSystemEvent::MovedTo, relativePath, event->cookie);
+        }
+        else if (event->mask & IN_MOVED_FROM)
+        {
+          queueEvent(RawFileSystemEvent::MovedFrom, relativePath, event->cookie);
+        }
+        else if (event->mask & IN_DELETE)
+        {
+          queueEvent(RawFileSystemEvent::Deleted, relativePath);
+        }
+        else if (event->mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_ACCESS))
         {
-          onCreated(std::filesystem::path(event->name));
+          queueEvent(RawFileSystemEvent::Modified, relativePath);
         }
       }
     }
@@ -90,6 +90,31 @@ namespace MathAnim
 			return;
 		}
 
+		// Rename-over saves can only be told apart from real renames if we know what's already there
+		std::error_code err;
+		auto addIfFile = [&](const std::filesystem::directory_entry& entry)
+		{
+			if (entry.is_regular_file(err))
+			{
+				addExistingFile(std::filesystem::relative(entry.path(), path, err));
+			}
+		};
+		if (includeSubdirectories)
+		{
+			for (auto const& entry : std::filesystem::recursive_directory_iterator(path, err))
+			{
+				addIfFile(entry);
+			}
+		}
+		else
+		{
+			for (auto const& entry : std::filesystem::directory_iterator(path, err))
+			{
+				addIfFile(entry);
+			}
+		}
+
+		uint32 renameCookie = 0;
 		bool result = true;
 		HANDLE hEvents[2];
 		hEvents[0] = pollingOverlap.hEvent;
@@ -117,7 +142,6 @@ namespace MathAnim
 				break;
 			}
 
-			std::lock_guard<std::mutex> queueLock(queueMtx);
 			do
 			{
 				pNotify = (FILE_NOTIFY_INFORMATION*)((char*)buffer + offset);
@@ -127,19 +151,21 @@ namespace MathAnim
 				switch (pNotify->Action)
 				{
 				case FILE_ACTION_ADDED:
-					createdQueue.insert(filename);
+					queueEvent(RawFileSystemEvent::Created, filename);
 					break;
 				case FILE_ACTION_REMOVED:
-					deletedQueue.insert(filename);
-					break;
-				case FILE_ACTION_MODIFIED:
-					changedQueue.insert(filename);
+					queueEvent(RawFileSystemEvent::Deleted, filename);
 					break;
 				case FILE_ACTION_RENAMED_OLD_NAME:
-					// Log::Info("The file was renamed and this is the old name: [%s]", filename);
+					// The new name always follows right after the old one, so a counter pairs them up
+					renameCookie++;
+					queueEvent(RawFileSystemEvent::MovedFrom, filename, renameCookie);
+					break;
+				case FILE_ACTION_MODIFIED:
+					queueEvent(RawFileSystemEvent::Modified, filename);
 					break;
 				case FILE_ACTION_RENAMED_NEW_NAME:
-					renamedQueue.insert(filename);
+					queueEvent(RawFileSystemEvent::MovedTo, filename, renameCookie);
 					break;
 				default:
 					g_logger_error("Default error. Unknown file action '{}' for FileSystemWatcher '{}'", pNotify->Action, path);
@@ -162,66 +188,6 @@ namespace MathAnim
 			fileWatcherThread.join();
 		}
 	}
-
-	void FileSystemWatcher::poll()
-	{
-		// Filesystem watcher is kind of stupid,
-		// so I have to buffer the polling to make sure
-		// it doesn't double-notify 
-		constexpr int pollBufferReset = 10;
-		static int pollBuffer = 0;
-		if (pollBuffer < pollBufferReset)
-		{
-			pollBuffer++;
-		}
-		pollBuffer = 0;
-
-		std::lock_guard<std::mutex> queueLock(queueMtx);
-
-		for (const std::filesystem::path& file : changedQueue)
-		{
-			bool containsFile = prevChangedQueue.find(file) != prevChangedQueue.end();
-			if (onChanged && !containsFile)
-			{
-				onChanged(file);
-			}
-		}
-		prevChangedQueue = changedQueue;
-		changedQueue.clear();
-
-		for (const std::filesystem::path& file : renamedQueue)
-		{
-			bool containsFile = prevRenamedQueue.find(file) != prevRenamedQueue.end();
-			if (onRenamed && !containsFile)
-			{
-				onRenamed(file);
-			}
-		}
-		prevRenamedQueue = renamedQueue;
-		renamedQueue.clear();
-
-		for (const std::filesystem::path& file : deletedQueue)
-		{
-			bool containsFile = prevDeletedQueue.find(file) != prevDeletedQueue.end();
-			if (onDeleted && !containsFile)
-			{
-				onDeleted(file);
-			}
-		}
-		prevDeletedQueue = deletedQueue;
-		deletedQueue.clear();
-
-		for (const std::filesystem::path& file : createdQueue)
-		{
-			bool containsFile = prevCreatedQueue.find(file) != prevCreatedQueue.end();
-			if (onCreated && !containsFile)
-			{
-				onCreated(file);
-			}
-		}
-		prevCreatedQueue = createdQueue;
-		createdQueue.clear();
-	}
 }
 
 #endif
@@ -7,6 +7,8 @@
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <pwd.h>
 
@@ -86,6 +88,11 @@ out:
 
 namespace MathAnim
 {
+  struct MemMapUserData
+  {
+    int fileDescriptor;
+  };
+
   namespace Platform
   {
     static std::vector<std::string> availableFonts = {
@@ -215,6 +222,67 @@ namespace MathAnim
       return homeDirectory + "/.mathanimation";
     }
 
+    MemMappedFile* openMemMappedFile(const char* filepath)
+    {
+      int fd = open(filepath, O_RDONLY);
+      if (fd == -1)
+      {
+        g_logger_error("Failed to open file '{}' for memmapping: '{}'", filepath, strerror(errno));
+        return nullptr;
+      }
+
+      struct stat fileStat;
+      if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+      {
+        // Empty files can't be mapped
+        close(fd);
+        return nullptr;
+      }
+
+      size_t fileSize = (size_t)fileStat.st_size;
+      void* baseAddress = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (baseAddress == MAP_FAILED)
+      {
+        g_logger_error("Failed to memmap file '{}': '{}'", filepath, strerror(errno));
+        close(fd);
+        return nullptr;
+      }
+
+      // Files we map are read front to back
+      madvise(baseAddress, fileSize, MADV_SEQUENTIAL);
+
+      MemMapUserData* userData = (MemMapUserData*)g_memory_allocate(sizeof(MemMapUserData));
+      userData->fileDescriptor = fd;
+
+      MemMappedFile* res = (MemMappedFile*)g_memory_allocate(sizeof(MemMappedFile));
+      new(res)MemMappedFile{ (uint8*)baseAddress, fileSize, userData };
+      return res;
+    }
+
+    void freeMemMappedFile(MemMappedFile* file)
+    {
+      if (!file)
+      {
+        return;
+      }
+
+      if (file->data)
+      {
+        if (munmap(file->data, file->dataSize) != 0)
+        {
+          g_logger_error("Failed to unmap memmapped file: '{}'", strerror(errno));
+        }
+      }
+
+      if (file->userData)
+      {
+        close(file->userData->fileDescriptor);
+        g_memory_free(file->userData);
+      }
+
+      g_memory_free(file);
+    }
+
     void createDirIfNotExists(const char* dirName)
     {
       mkdir_p(dirName, 0755);
@@ -488,6 +488,78 @@ namespace MathAnim
 			return res;
 		}
 
+		MemMappedFile* openMemMappedFile(const char* filepath)
+		{
+			MemMappedFile* res = (MemMappedFile*)g_memory_allocate(sizeof(MemMappedFile));
+			g_memory_zeroMem(res, sizeof(MemMappedFile));
+			res->userData = (MemMapUserData*)g_memory_allocate(sizeof(MemMapUserData));
+			res->userData->fileHandle = INVALID_HANDLE_VALUE;
+			res->userData->fileMappingHandle = INVALID_HANDLE_VALUE;
+
+			res->userData->fileHandle = CreateFileA(
+				filepath,
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				NULL,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+				NULL
+			);
+
+			if (res->userData->fileHandle == INVALID_HANDLE_VALUE)
+			{
+				g_logger_error("Failed to open file '{}' for memmapping. Last error: {}", filepath, GetLastError());
+				freeMemMappedFile(res);
+				return nullptr;
+			}
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(res->userData->fileHandle, &fileSize) || fileSize.QuadPart == 0)
+			{
+				// Empty files can't be mapped
+				freeMemMappedFile(res);
+				return nullptr;
+			}
+
+			res->userData->fileMappingHandle = CreateFileMappingA(
+				res->userData->fileHandle,
+				NULL,
+				PAGE_READONLY,
+				0,
+				0,
+				NULL
+			);
+			if (res->userData->fileMappingHandle == NULL)
+			{
+				res->userData->fileMappingHandle = INVALID_HANDLE_VALUE;
+				g_logger_error("Failed to memmap file '{}'. Last error: '{}'", filepath, GetLastError());
+				freeMemMappedFile(res);
+				return nullptr;
+			}
+
+			uint8* baseAddress = (uint8*)MapViewOfFile(
+				res->userData->fileMappingHandle,
+				FILE_MAP_READ,
+				0,
+				0,
+				0
+			);
+			if (baseAddress == NULL)
+			{
+				g_logger_error("Failed to create a mapped view of file '{}'. Last Error: '{}'", filepath, GetLastError());
+				freeMemMappedFile(res);
+				return nullptr;
+			}
+
+			res->dataSize = (size_t)fileSize.QuadPart;
+
+#pragma warning( push )
+#pragma warning( disable : 4213 )
+			(uint8*)res->data = baseAddress;
+#pragma warning( pop )
+			return res;
+		}
+
 		void freeMemMappedFile(MemMappedFile* file)
 		{
 			if (!file)
@@ -1,6 +1,8 @@
 #include "renderer/Fonts.h"
 #include "renderer/Renderer.h"
+#include "renderer/GLApi.h"
 #include "core/Application.h"
+#include "core/Profiling.h"
 #include "svg/Svg.h"
 #include "math/CMath.h"
 
@@ -159,12 +161,9 @@ namespace MathAnim
 
 	void GlyphOutline::free()
 	{
-		if (svg)
-		{
-			svg->free();
-			g_memory_free(svg);
-			svg = nullptr;
-		}
+		// Text objects may still be sharing this outline
+		Svg::release(svg);
+		svg = nullptr;
 
 		advanceX = 0.0f;
 		bearingX = 0.0f;
@@ -192,11 +191,27 @@ namespace MathAnim
 		return nullTexture;
 	}
 
+	const Texture& SizedFont::getAtlasTexture(const GlyphTexture& glyphTexture) const
+	{
+		if (glyphTexture.atlasPage < this->atlasPages.size())
+		{
+			return this->atlasPages[glyphTexture.atlasPage].texture;
+		}
+
+		static Texture nullTexture = {};
+		return nullTexture;
+	}
+
 	namespace Fonts
 	{
 		static bool initialized = false;
 		static const int hzPadding = 2;
 		static const int vtPadding = 2;
+		static constexpr int atlasPageWidth = 2048;
+		static constexpr int atlasPageHeight = 2048;
+		static int numGlyphsRasterizedThisFrame = 0;
+		static int numGlyphsRasterizedLastFrame = 0;
+		static uint64 totalNumGlyphsRasterized = 0;
 		static FT_Library library;
 		static Font* defaultMonoFont = nullptr;
 		static std::unordered_map<std::string, SharedFont> loadedFonts;
@@ -209,6 +224,9 @@ namespace MathAnim
 		static std::string getSizedFontKey(const char* filepath, int fontSizePixels);
 		static std::string getUnsizedFontKey(const char* filepath);
 		static void generateTextureForChars(std::string const& sizedFontKey, const char* filepath, SizedFont& res, std::unordered_set<uint32> const& charset, int fontSizePixels, bool singleChannelTexture);
+		static void addGlyphsToAtlas(SizedFont& res, std::unordered_set<uint32> const& charset);
+		static FontAtlasPage& addAtlasPage(SizedFont& res);
+		static void destroyAtlasPages(SizedFont& res);
 
 		void init()
 		{
@@ -290,7 +308,8 @@ namespace MathAnim
 
 					if (needsNewChars)
 					{
-						// Regenerate the texture and add all chars currently available to the new font
+						// Load the outlines for the new chars along with all the chars currently available,
+						// this also keeps the reference counts equal
 						std::unordered_set<uint32> setToGenerate = charset;
 						// Always include the missing glyph
 						setToGenerate.insert(MISSING_GLYPH_CODEPOINT);
@@ -298,11 +317,11 @@ namespace MathAnim
 						{
 							setToGenerate.insert(key);
 						}
-
-						generateTextureForChars(sizedFontKey, filepath, iter->second.font, setToGenerate, fontSizePixels, singleChannelTexture);
-
-						// Also load the unsized font so that reference counts remain equal
 						loadFont(filepath, setToGenerate);
+
+						// Only the glyphs that aren't in the atlas yet get rasterized, everything
+						// already uploaded stays where it is
+						addGlyphsToAtlas(iter->second.font, setToGenerate);
 					}
 					else
 					{
@@ -360,7 +379,7 @@ namespace MathAnim
 			if (iter->second.referenceCount <= 0)
 			{
 				// Really unload the font now
-				font->texture.destroy();
+				destroyAtlasPages(*font);
 				loadedSizedFonts.erase(iter);
 			}
 		}
@@ -516,7 +535,7 @@ namespace MathAnim
 			for (auto iter = loadedSizedFonts.begin(); iter != loadedSizedFonts.end();)
 			{
 				SizedFont& font = iter->second.font;
-				font.texture.destroy();
+				destroyAtlasPages(font);
 				iter->second.referenceCount = 0;
 				iter = loadedSizedFonts.erase(iter);
 			}
@@ -537,6 +556,22 @@ namespace MathAnim
 			return defaultMonoFont;
 	}
 
+		void endFrame()
+		{
+			numGlyphsRasterizedLastFrame = numGlyphsRasterizedThisFrame;
+			numGlyphsRasterizedThisFrame = 0;
+		}
+
+		int getNumGlyphsRasterizedLastFrame()
+		{
+			return numGlyphsRasterizedLastFrame;
+		}
+
+		uint64 getTotalNumGlyphsRasterized()
+		{
+			return totalNumGlyphsRasterized;
+		}
+
 		static void generateDefaultCharset(Font& font, std::unordered_set<uint32> const& charset)
 		{
 			for (uint32 i : charset)
@@ -813,64 +848,44 @@ namespace MathAnim
 		{
 			g_logger_info("Generating texture for sized font '{}'.", sizedFontKey);
 
-			if (!res.texture.isNull())
-			{
-				res.texture.destroy();
-				res.texture = {};
-				res.glyphTextureCoords = {};
-			}
+			destroyAtlasPages(res);
+			res.glyphTextureCoords = {};
+			res.unsizedFont = loadFont(filepath, charset);
+			res.fontSizePixels = fontSizePixels;
+			res.singleChannelTexture = singleChannelTexture;
 
-			if (!res.unsizedFont)
-			{
-				res.unsizedFont = loadFont(filepath, charset);
-			}
-			else
+			addAtlasPage(res);
+			addGlyphsToAtlas(res, charset);
+		}
+
+		static void addGlyphsToAtlas(SizedFont& res, std::unordered_set<uint32> const& charset)
+		{
+			MP_PROFILE_EVENT("Fonts_AddGlyphsToAtlas");
+
+			if (!res.unsizedFont || !res.unsizedFont->fontFace)
 			{
-				res.unsizedFont = loadFont(filepath, charset);
-				// Unload the font to make sure the reference count remains accurate
-				unloadFont(res.unsizedFont);
+				return;
 			}
 
-			res.fontSizePixels = fontSizePixels;
-
 			{
-				FT_Error error = FT_Set_Pixel_Sizes(res.unsizedFont->fontFace, fontSizePixels, fontSizePixels);
+				// The face is shared with every other size of this font, so the size has to be set every time
+				FT_Error error = FT_Set_Pixel_Sizes(res.unsizedFont->fontFace, res.fontSizePixels, res.fontSizePixels);
 				if (error)
 				{
-					g_logger_error("Freetype failed to set the pixel size for font '{}'.", filepath);
-					unloadFont(res.unsizedFont);
+					g_logger_error("Freetype failed to set the pixel size for font '{}'.", res.unsizedFont->fontFilepath);
 					return;
 				}
 			}
 
-			ByteFormat byteFormat = singleChannelTexture
-				? ByteFormat::R8_UI
-				: ByteFormat::RGBA8_UI;
+			size_t singleColorSize = sizeof(uint8) * (res.singleChannelTexture ? 1 : 4);
+			std::vector<uint8> glyphMemory = {};
 
-			constexpr uint32 textureWidth = 2048;
-			constexpr uint32 textureHeight = 2048;
-			res.texture = TextureBuilder()
-				.setFormat(byteFormat)
-				.setWidth(textureWidth)
-				.setHeight(textureHeight)
-				.setMagFilter(FilterMode::Linear)
-				.setMinFilter(FilterMode::Linear)
-				.setWrapS(WrapMode::None)
-				.setWrapT(WrapMode::None)
-				.generateEmpty();
+			// Glyph rows are tightly packed
+			GL::pixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-			// Generate the texture and upload it to the GPU
-			size_t singleColorSize = sizeof(uint8) * (singleChannelTexture ? 1 : 4);
-			size_t textureMemorySize = singleColorSize * textureWidth * textureHeight;
-			uint8* textureMemory = (uint8*)g_memory_allocate(textureMemorySize);
-			g_memory_zeroMem(textureMemory, textureMemorySize);
-
-			uint32 cursorX = 0;
-			uint32 cursorY = 0;
-			uint32 lineHeight = 0;
 			for (uint32 codepoint : charset)
 			{
-				if (codepoint == '\n')
+				if (codepoint == '\n' || res.glyphTextureCoords.find(codepoint) != res.glyphTextureCoords.end())
 				{
 					continue;
 				}
@@ -886,34 +901,52 @@ namespace MathAnim
 				if (error)
 				{
 					g_logger_error("Freetype could not load glyph for character code '{}'.", codepoint);
+					continue;
 				}
 
+				numGlyphsRasterizedThisFrame++;
+				totalNumGlyphsRasterized++;
+
 				FT_Bitmap& bitmap = res.unsizedFont->fontFace->glyph->bitmap;
-				if (cursorX + bitmap.width >= textureWidth)
+				GlyphTexture& glyphTexture = res.glyphTextureCoords[codepoint];
+				glyphTexture.atlasPage = 0;
+				glyphTexture.uvMin = Vec2{ 0, 0 };
+				glyphTexture.uvMax = Vec2{ 0, 0 };
+
+				// Whitespace doesn't need any room in the atlas
+				if (bitmap.width == 0 || bitmap.rows == 0)
 				{
-					cursorY += lineHeight;
-					lineHeight = 0;
-					cursorX = 0;
+					continue;
 				}
-				lineHeight = glm::max(bitmap.rows, lineHeight);
 
-				if (cursorY + bitmap.rows >= textureHeight)
+				// Pad the glyphs so linear filtering doesn't bleed neighbors into each other
+				AtlasRegion region;
+				int paddedWidth = (int)bitmap.width + hzPadding;
+				int paddedHeight = (int)bitmap.rows + vtPadding;
+				if (paddedWidth > atlasPageWidth || paddedHeight > atlasPageHeight)
 				{
-					g_logger_error("Ran out of texture room for font '{}'", filepath);
+					g_logger_error("Glyph '{}' is too big to fit in the texture atlas for font '{}'.", codepoint, res.unsizedFont->fontFilepath);
 					continue;
 				}
 
-				// Copy every row into our bitmap
+				uint32 pageIndex = (uint32)res.atlasPages.size() - 1;
+				if (res.atlasPages.size() == 0 || !res.atlasPages[pageIndex].allocator.allocate(paddedWidth, paddedHeight, &region))
+				{
+					// Older pages are left alone, spill over into a fresh page
+					addAtlasPage(res).allocator.allocate(paddedWidth, paddedHeight, &region);
+					pageIndex = (uint32)res.atlasPages.size() - 1;
+				}
+
+				// Copy every row into a tightly packed buffer
+				glyphMemory.resize(singleColorSize * bitmap.width * bitmap.rows);
 				for (uint32 y = 0; y < bitmap.rows; y++)
 				{
-					size_t sizedTextureWidth = textureWidth * singleColorSize;
-					uint8* dst = textureMemory + (cursorX * singleColorSize) + ((cursorY + y) * sizedTextureWidth);
-					uint8* src = bitmap.buffer + (y * bitmap.width);
+					uint8* dst = glyphMemory.data() + (y * bitmap.width * singleColorSize);
+					uint8* src = bitmap.buffer + ((int)y * bitmap.pitch);
 
-					if (singleChannelTexture)
+					if (res.singleChannelTexture)
 					{
-						size_t textureMemorySizeLeft = textureMemorySize - (dst - textureMemory);
-						g_memory_copyMem(dst, textureMemorySizeLeft, src, sizeof(uint8) * bitmap.width);
+						g_memory_copyMem(dst, glyphMemory.size() - (dst - glyphMemory.data()), src, sizeof(uint8) * bitmap.width);
 					}
 					else
 					{
@@ -928,25 +961,66 @@ namespace MathAnim
 					}
 				}
 
+				// Only upload the new glyph, the rest of the atlas is already on the GPU
+				const Texture& texture = res.atlasPages[pageIndex].texture;
+				texture.uploadSubImage(region.x, region.y, bitmap.width, bitmap.rows, glyphMemory.data(), glyphMemory.size());
+
 				// Add normalized glyph position
-				res.glyphTextureCoords[codepoint].lruCacheId = 0;
-				res.glyphTextureCoords[codepoint].uvMin = Vec2{
-					(float)cursorX / (float)textureWidth,
-					(float)cursorY / (float)textureHeight
+				glyphTexture.atlasPage = pageIndex;
+				glyphTexture.uvMin = Vec2{
+					(float)region.x / (float)atlasPageWidth,
+					(float)region.y / (float)atlasPageHeight
 				};
-				res.glyphTextureCoords[codepoint].uvMax = Vec2{
-					(float)cursorX / (float)textureWidth + (float)bitmap.width / (float)textureWidth,
-					(float)cursorY / (float)textureHeight + (float)bitmap.rows / (float)textureHeight
+				glyphTexture.uvMax = Vec2{
+					(float)(region.x + bitmap.width) / (float)atlasPageWidth,
+					(float)(region.y + bitmap.rows) / (float)atlasPageHeight
 				};
+			}
+		}
 
-				// Increment our write cursor
-				cursorX += bitmap.width;
+		static FontAtlasPage& addAtlasPage(SizedFont& res)
+		{
+			if (res.atlasPages.size() > 0)
+			{
+				g_logger_info("Font atlas for '{}' at size {} is full. Adding page {}.", res.unsizedFont->fontFilepath, res.fontSizePixels, res.atlasPages.size());
 			}
 
-			// Upload texture memory to the GPU
-			res.texture.uploadSubImage(0, 0, textureWidth, textureHeight, textureMemory, sizeof(uint8) * textureWidth * textureHeight * singleColorSize);
+			ByteFormat byteFormat = res.singleChannelTexture
+				? ByteFormat::R8_UI
+				: ByteFormat::RGBA8_UI;
+
+			FontAtlasPage& page = res.atlasPages.emplace_back();
+			page.texture = TextureBuilder()
+				.setFormat(byteFormat)
+				.setWidth(atlasPageWidth)
+				.setHeight(atlasPageHeight)
+				.setMagFilter(FilterMode::Linear)
+				.setMinFilter(FilterMode::Linear)
+				.setWrapS(WrapMode::None)
+				.setWrapT(WrapMode::None)
+				.generateEmpty();
+			page.allocator.init(atlasPageWidth, atlasPageHeight);
 
+			// Glyphs only ever get uploaded into their own regions, so clear the
+			// whole page once up front to keep the padding between them empty
+			size_t singleColorSize = sizeof(uint8) * (res.singleChannelTexture ? 1 : 4);
+			size_t textureMemorySize = singleColorSize * atlasPageWidth * atlasPageHeight;
+			uint8* textureMemory = (uint8*)g_memory_allocate(textureMemorySize);
+			g_memory_zeroMem(textureMemory, textureMemorySize);
+			page.texture.uploadSubImage(0, 0, atlasPageWidth, atlasPageHeight, textureMemory, textureMemorySize);
 			g_memory_free(textureMemory);
+
+			return page;
+		}
+
+		static void destroyAtlasPages(SizedFont& res)
+		{
+			for (FontAtlasPage& page : res.atlasPages)
+			{
+				page.texture.destroy();
+				page.allocator.clear();
+			}
+			res.atlasPages.clear();
 		}
 
 		static void loadFontInternal(Font& res, const char* filepath, std::unordered_set<uint32> const& charset)
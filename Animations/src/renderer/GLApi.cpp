@@ -85,6 +85,16 @@ namespace MathAnim
 			return maxTextureImageUnits;
 		}
 
+		bool supportsPersistentMapping()
+		{
+			return gl44Support;
+		}
+
+		bool supportsMultiDrawIndirect()
+		{
+			return gl43Support;
+		}
+
 		// ----------------------- Blending -----------------------
 		void blendFunc(GLenum sfactor, GLenum dfactor)
 		{
@@ -258,11 +268,38 @@ namespace MathAnim
 			return glMapBuffer(target, access);
 		}
 
+		void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+		{
+			return glMapBufferRange(target, offset, length, access);
+		}
+
 		GLboolean unmapBuffer(GLenum target)
 		{
 			return glUnmapBuffer(target);
 		}
 
+		void bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+		{
+			g_logger_assert(gl44Support, "glBufferStorage requires OpenGL 4.4.");
+			glBufferStorage(target, size, data, flags);
+		}
+
+		// ----------------------- Sync objects -----------------------
+		GLsync fenceSync(GLenum condition, GLbitfield flags)
+		{
+			return glFenceSync(condition, flags);
+		}
+
+		GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+		{
+			return glClientWaitSync(sync, flags, timeout);
+		}
+
+		void deleteSync(GLsync sync)
+		{
+			glDeleteSync(sync);
+		}
+
 		// ----------------------- Stencil/Scissor stuff -----------------------
 		void scissor(GLint x, GLint y, GLsizei width, GLsizei height)
 		{
@@ -300,6 +337,17 @@ namespace MathAnim
 			glDrawElementsBaseVertex(mode, count, type, indices, basevertex);
 		}
 
+		void multiDrawElementsBaseVertex(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawcount, const GLint* basevertex)
+		{
+			glMultiDrawElementsBaseVertex(mode, count, type, indices, drawcount, basevertex);
+		}
+
+		void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+		{
+			g_logger_assert(gl43Support, "glMultiDrawElementsIndirect requires OpenGL 4.3.");
+			glMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+		}
+
 		// ----------------------- Textures -----------------------
 		void readPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
 		{
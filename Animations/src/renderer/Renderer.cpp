@@ -9,6 +9,7 @@
 #include "renderer/Colors.h"
 #include "renderer/Fonts.h"
 #include "renderer/GLApi.h"
+#include "renderer/StreamBuffer.h"
 #include "animation/Animation.h"
 #include "animation/AnimationManager.h"
 #include "core/Application.h"
@@ -18,6 +19,9 @@
 #include "editor/EditorSettings.h"
 #include "svg/Svg.h"
 #include "math/CMath.h"
+#include "utils/LRUCache.hpp"
+
+#include <algorithm>
 
 #ifdef _RELEASE
 #include "shaders/default.glsl.hpp"
@@ -31,7 +35,7 @@ namespace MathAnim
 		const Camera* camera;
 		uint32 textureId;
 		uint32 vertexOffset;
-		uint16 indexOffset;
+		uint32 indexOffset;
 		uint32 numVerts;
 		uint32 numElements;
 	};
@@ -62,6 +66,47 @@ namespace MathAnim
 		uint32 textureId;
 	};
 
+	// Matches the layout glMultiDrawElementsIndirect expects
+	struct DrawElementsIndirectCommand
+	{
+		uint32 count;
+		uint32 instanceCount;
+		uint32 firstIndex;
+		int32 baseVertex;
+		uint32 baseInstance;
+	};
+
+	// A run of indexed draws that share a camera and texture, submitted with a single multi draw call
+	struct DrawBatch
+	{
+		const Camera* camera;
+		uint32 textureId;
+		uint32 firstDraw;
+		uint32 numDraws;
+	};
+
+	struct MultiDrawList
+	{
+		std::vector<DrawElementsIndirectCommand> draws;
+		std::vector<DrawBatch> batches;
+		StreamBuffer indirectBuffer;
+
+		// Scratch space for drivers without glMultiDrawElementsIndirect
+		std::vector<GLsizei> counts;
+		std::vector<const void*> indexOffsets;
+		std::vector<GLint> baseVertices;
+
+		void init();
+
+		// firstIndex is relative to the start of the uploaded index data, indices are relative to baseVertex
+		void addDraw(const Camera* camera, uint32 textureId, uint32 elementCount, uint32 firstIndex, uint32 baseVertex);
+
+		// Issues every queued draw. The shader, VAO and index buffer have to be bound already.
+		void submit(const Shader& shader, size_t indexBufferOffset);
+		void clear();
+		void free();
+	};
+
 	struct Vertex2D
 	{
 		Vec2 position;
@@ -78,8 +123,9 @@ namespace MathAnim
 		std::vector<uint32> textureIdStack;
 
 		uint32 vao;
-		uint32 vbo;
-		uint32 ebo;
+		StreamBuffer vbo;
+		StreamBuffer ebo;
+		MultiDrawList multiDraw;
 
 		void init();
 
@@ -91,7 +137,8 @@ namespace MathAnim
 		void addMultiColoredTri(const Vec2& p0, const Vec4& c0, const Vec2& p1, const Vec4& c1, const Vec2& p2, const Vec4& c2, AnimObjId objId);
 
 		void setupGraphicsBuffers();
-		void render(const Shader& shader) const;
+		void bindVertexAttributes(size_t vertexBufferOffset);
+		void render(const Shader& shader);
 		void reset();
 		void free();
 	};
@@ -104,6 +151,8 @@ namespace MathAnim
 
 		Vec2 frontP1, frontP2;
 		Vec2 backP1, backP2;
+		// Bevels store their corners in frontP1 (center), frontP2 and backP2
+		bool isBevel;
 	};
 
 	struct Path2DContext
@@ -114,6 +163,15 @@ namespace MathAnim
 		float approximateLength;
 	};
 
+	struct StrokeTessellation
+	{
+		// Extruded as a closed path, partially drawn strokes patch up their end caps when they get drawn
+		std::vector<Path_Vertex2DLine> data;
+		// Length of the flattened path up to each vertex
+		std::vector<float> arcLengths;
+		int numSegments;
+	};
+
 	struct Vertex3DLine
 	{
 		Vec3 p0;
@@ -129,7 +187,7 @@ namespace MathAnim
 		std::vector<Vertex3DLine> vertices;
 
 		uint32 vao;
-		uint32 vbo;
+		StreamBuffer vbo;
 
 		void init();
 
@@ -137,7 +195,8 @@ namespace MathAnim
 		void addLine(const Vec3& p0, const Vec3& p1, uint32 packedColor, float thickness, AnimObjId objId);
 
 		void setupGraphicsBuffers();
-		void render(const Shader& shader) const;
+		void bindVertexAttributes(size_t vertexBufferOffset);
+		void render(const Shader& shader);
 		void reset();
 		void free();
 	};
@@ -157,7 +216,7 @@ namespace MathAnim
 		std::vector<Vertex3DBillboard> vertices;
 
 		uint32 vao;
-		uint32 vbo;
+		StreamBuffer vbo;
 
 		void init();
 
@@ -166,7 +225,8 @@ namespace MathAnim
 		void addBillboard(uint32 graphicsId, const Vec3& p0, const Vec3& p1, float height, const Vec2& uvMin, const Vec2& uvMax, uint32 packedColor, AnimObjId objId);
 
 		void setupGraphicsBuffers();
-		void render(const Shader& shader) const;
+		void bindVertexAttributes(size_t vertexBufferOffset);
+		void render(const Shader& shader);
 		void reset();
 		void free();
 	};
@@ -188,8 +248,9 @@ namespace MathAnim
 		std::vector<uint32> textureIdStack;
 
 		uint32 vao;
-		uint32 ebo;
-		uint32 vbo;
+		StreamBuffer vbo;
+		StreamBuffer ebo;
+		MultiDrawList multiDraw;
 
 		void init();
 
@@ -200,7 +261,9 @@ namespace MathAnim
 		void addMultiColoredTri(const Vec3& p0, const Vec4& c0, const Vec3& p1, const Vec4& c1, const Vec3& p2, const Vec4& c2, AnimObjId objId);
 
 		void setupGraphicsBuffers();
-		void render(const Shader& opaqueShader, const Shader& transparentShader, const Shader& compositeShader, const Framebuffer& framebuffer) const;
+		void bindVertexAttributes(size_t vertexBufferOffset);
+		void queueDraws(bool isTransparent);
+		void render(const Shader& opaqueShader, const Shader& transparentShader, const Shader& compositeShader, const Framebuffer& framebuffer);
 		void reset();
 		void free();
 	};
@@ -225,6 +288,14 @@ namespace MathAnim
 		static int list3DLineNumTris = 0;
 		static int list3DBillboardNumTris = 0;
 
+		static int numGlDrawCalls = 0;
+		static size_t numBytesUploaded = 0;
+
+		// Starting size of each region of the per frame stream buffers, they grow as needed
+		static constexpr size_t initialVertexBufferSize = 1024 * 1024;
+		static constexpr size_t initialIndexBufferSize = 256 * 1024;
+		static constexpr size_t initialIndirectBufferSize = sizeof(DrawElementsIndirectCommand) * 512;
+
 		static Shader shader2D;
 		static Shader shaderFont2D;
 		static Shader screenShader;
@@ -269,6 +340,11 @@ namespace MathAnim
 		static Texture defaultWhiteTexture;
 		static int debugMsgId = 0;
 
+		// Tessellated strokes, the oldest ones get evicted once they hold too many vertices
+		static constexpr size_t maxCachedStrokeVertices = 1 << 19;
+		static LRUCache<uint64, StrokeTessellation*> cachedStrokes;
+		static size_t numCachedStrokeVertices = 0;
+
 		// Default screen rectangle
 		static float defaultScreenQuad[] = {
 			-1.0f, -1.0f,   0.0f, 0.0f, // Bottom-left
@@ -288,6 +364,11 @@ namespace MathAnim
 		static void generateMiter3D(const Vec3& previousPoint, const Vec3& currentPoint, const Vec3& nextPoint, float strokeWidth, Vec2* outNormal, float* outStrokeWidth);
 		static void lineToInternal(Path2DContext* path, const Vec2& point, bool addToRawCurve);
 		static void lineToInternal(Path2DContext* path, const Path_Vertex2DLine& vert, bool addToRawCurve);
+		static int extrudePath(std::vector<Path_Vertex2DLine>& data, bool closePath);
+		static void capStrokeEnd(Path_Vertex2DLine& vertex, const Vec2& direction);
+		static void drawBevel(const Path_Vertex2DLine& vertex, const Vec4& color, const glm::mat4& transform, AnimObjId objId);
+		static void drawStrokeSegment(const Path_Vertex2DLine& vertex, const Vec4& color, const Path_Vertex2DLine& nextVertex, const Vec4& nextColor, const glm::mat4& transform, AnimObjId objId);
+		static void freeCachedStrokes();
 		static const Camera* getCurrentCamera2D();
 		static const Camera* getCurrentCamera3D();
 		static uint32 packColor(const Vec4& color);
@@ -362,6 +443,7 @@ namespace MathAnim
 			drawList3DLine.free();
 			drawList3D.free();
 			drawList3DBillboard.free();
+			freeCachedStrokes();
 
 			TextureCache::free();
 		}
@@ -378,6 +460,9 @@ namespace MathAnim
 			list3DLineNumTris = 0;
 			list3DBillboardNumTris = 0;
 
+			numGlDrawCalls = 0;
+			numBytesUploaded = 0;
+
 			g_logger_assert(lineEndingStackPtr == 0, "Missing popLineEnding({}) call.", lineEndingStackPtr);
 			g_logger_assert(colorStackPtr == 0, "Missing popColor({}) call.", colorStackPtr);
 			g_logger_assert(strokeWidthStackPtr == 0, "Missing popStrokeWidth({}) call.", strokeWidthStackPtr);
@@ -979,7 +1064,7 @@ namespace MathAnim
 				float bearingY = glyphOutline.bearingY * (float)font->fontSizePixels;
 
 				drawList2D.addTexturedQuad(
-					font->texture,
+					font->getAtlasTexture(glyphTexture),
 					cursorPos + Vec2{ bearingX, -bearingY },
 					cursorPos + Vec2{ bearingX + charWidth, descentY },
 					glyphTexture.uvMin,
@@ -1061,124 +1146,13 @@ namespace MathAnim
 				return false;
 			}
 
-			// NOTE: Do two loops:
-			//
-			//       The first loop extrudes all the vertices
-			//       and forms the tesselated path. It also creates 
-			//       any bevels/miters/rounded corners and adds
-			//       them immediately and just saves the connection
-			//       points for the second loop.
-			//
-			//       The second loop
-			//       connects the verts into quads to form the stroke
-
-			// TODO: Clean this up. Path's should never have a duplicate start/end point in the first
-			//       place if it's a closed path, that should be implicit. Instead we should normalize paths
-			//       and make sure that if a path gets closed the endpoint != the start point.
-			//       Here's a Github issue to track this:
-			//         https://github.com/ambrosiogabe/MathAnimation/issues/104
-			//       ID for code search: %BW7n4C2kfxQtpij6tHL
-			bool firstPointIsSameAsLastPoint = path->data.size() > 0
-				? path->data[0].position == path->data[path->data.size() - 1].position
-				: true;
-
-			int endPoint = firstPointIsSameAsLastPoint
-				? (int)path->data.size() - 1
-				: (int)path->data.size();
-			for (int vertIndex = 0; vertIndex < (int)path->data.size(); vertIndex++)
+			int numSegments = extrudePath(path->data, closePath);
+			for (const Path_Vertex2DLine& vertex : path->data)
 			{
-				Path_Vertex2DLine& vertex = path->data[vertIndex];
-				Vec2 currentPos = vertex.position;
-				Vec2 nextPos = vertIndex + 1 < endPoint
-					? path->data[vertIndex + 1].position
-					: closePath
-					? path->data[(vertIndex + 1) % endPoint].position
-					: path->data[endPoint - 1].position;
-				Vec2 previousPos = vertIndex > 0
-					? path->data[vertIndex - 1].position
-					: closePath
-					? path->data[endPoint - 1].position
-					: path->data[0].position;
-				const Vec4& currentColor = vertex.color;
-
-				Vec2 dirA = CMath::normalize(currentPos - previousPos);
-				Vec2 dirB = CMath::normalize(nextPos - currentPos);
-				if (CMath::compare(dirA, -1.0f * dirB))
+				if (vertex.isBevel)
 				{
-					// Vectors are pointing away from each other. This means finding a bisection vector would be 
-					// inconclusive since it could point either way. So we'll just wiggle the vector a bit to
-					// make the math not degrade to inf's and nan's
-					dirA.x += 0.0000001f;
+					drawBevel(vertex, vertex.color, path->transform, objId);
 				}
-				Vec2 bisectionPerp = CMath::normalize(dirA + dirB);
-				Vec2 secondLinePerp = Vec2{ -dirB.y, dirB.x };
-				// This is the miter
-				Vec2 bisection = Vec2{ -bisectionPerp.y, bisectionPerp.x };
-				Vec2 extrusionNormal = bisection;
-				float bisectionDotProduct = CMath::dot(bisection, secondLinePerp);
-				float miterThickness = vertex.thickness / bisectionDotProduct;
-				if (CMath::compare(bisectionDotProduct, 0.0f, 0.01f))
-				{
-					// Clamp the miter if the joining curves are almost parallell
-					miterThickness = vertex.thickness;
-				}
-
-				constexpr float strokeMiterLimit = 2.0f;
-				bool shouldConvertToBevel = CMath::abs(miterThickness / vertex.thickness) > strokeMiterLimit;
-				if (shouldConvertToBevel)
-				{
-					float firstBevelWidth = vertex.thickness / CMath::dot(bisection, dirA) * 0.5f;
-					float secondBevelWidth = vertex.thickness / CMath::dot(bisection, dirB) * 0.5f;
-					Vec2 firstPoint = currentPos + (bisectionPerp * firstBevelWidth);
-					Vec2 secondPoint = currentPos + (bisectionPerp * secondBevelWidth);
-
-					float centerBevelWidth = vertex.thickness / CMath::dot(bisectionPerp, CMath::normalize(currentPos - previousPos));
-					centerBevelWidth = glm::min(centerBevelWidth, vertex.thickness);
-					Vec2 centerPoint = currentPos + (bisection * centerBevelWidth);
-					Renderer::drawMultiColoredTri(firstPoint, currentColor, secondPoint, currentColor, centerPoint, currentColor, objId);
-
-					// Save the "front" and "back" for the connection loop
-					vertex.frontP1 = centerPoint;
-					vertex.frontP2 = secondPoint;
-
-					vertex.backP1 = centerPoint;
-					vertex.backP2 = firstPoint;
-
-					// -----------
-					continue; // NOTE: The continue here. This is basically like an exit early thing
-					// -----------
-				}
-
-				// If we're drawing the beginning/end of the path, just
-				// do a straight cap on the line segment
-				if (vertIndex == 0 && !closePath)
-				{
-					Vec2 normal = CMath::normalize(nextPos - currentPos);
-					extrusionNormal = Vec2{ -normal.y, normal.x };
-					miterThickness = vertex.thickness;
-				}
-				else if (vertIndex == endPoint - 1 && !closePath)
-				{
-					Vec2 normal = CMath::normalize(currentPos - previousPos);
-					extrusionNormal = Vec2{ -normal.y, normal.x };
-					miterThickness = vertex.thickness;
-				}
-
-				// If we're doing a bevel or something, that uses special vertices
-				// to join segments. Otherwise we can just use the extrusion normal
-				// and miterThickness to join the segments
-				vertex.frontP1 = vertex.position + extrusionNormal * miterThickness * 0.5f;
-				vertex.frontP2 = vertex.position - extrusionNormal * miterThickness * 0.5f;
-
-				vertex.backP1 = vertex.position + extrusionNormal * miterThickness * 0.5f;
-				vertex.backP2 = vertex.position - extrusionNormal * miterThickness * 0.5f;
-			}
-
-			// NOTE: This is some weird shenanigans in order to get the path
-			//       to close correctly and join the last vertex to the first vertex
-			if (!closePath)
-			{
-				endPoint--;
 			}
 
 			// TODO: Stroke width scales with the object and it probably shouldn't
@@ -1193,23 +1167,11 @@ namespace MathAnim
 			//	Vec3{translation.x, translation.y, translation.z}
 			//);
 
-			for (int vertIndex = 0; vertIndex < endPoint; vertIndex++)
+			for (int vertIndex = 0; vertIndex < numSegments; vertIndex++)
 			{
 				const Path_Vertex2DLine& vertex = path->data[vertIndex % path->data.size()];
-				const Vec4& color = vertex.color;
 				const Path_Vertex2DLine& nextVertex = path->data[(vertIndex + 1) % path->data.size()];
-				const Vec4& nextColor = nextVertex.color;
-
-				drawMultiColoredTri3D(
-					transformVertVec3(vertex.frontP1, path->transform), color,
-					transformVertVec3(vertex.frontP2, path->transform), color,
-					transformVertVec3(nextVertex.backP1, path->transform), nextColor,
-					objId);
-				drawMultiColoredTri3D(
-					transformVertVec3(vertex.frontP2, path->transform), color,
-					transformVertVec3(nextVertex.backP2, path->transform), nextColor,
-					transformVertVec3(nextVertex.backP1, path->transform), nextColor,
-					objId);
+				drawStrokeSegment(vertex, vertex.color, nextVertex, nextVertex.color, path->transform, objId);
 			}
 
 			return true;
@@ -1467,6 +1429,141 @@ namespace MathAnim
 			path->transform = transform;
 		}
 
+		const StrokeTessellation* getCachedStroke(uint64 key)
+		{
+			std::optional<StrokeTessellation*> stroke = cachedStrokes.get(key);
+			return stroke.has_value() ? stroke.value() : nullptr;
+		}
+
+		const StrokeTessellation* cacheStroke(uint64 key, const Path2DContext* path)
+		{
+			g_logger_assert(path != nullptr, "Null path.");
+
+			const StrokeTessellation* existing = getCachedStroke(key);
+			if (existing != nullptr)
+			{
+				return existing;
+			}
+
+			if (path->data.size() <= 1)
+			{
+				return nullptr;
+			}
+
+			StrokeTessellation* res = g_memory_new StrokeTessellation();
+			res->data = path->data;
+			res->numSegments = extrudePath(res->data, true);
+
+			res->arcLengths.resize(res->data.size());
+			res->arcLengths[0] = 0.0f;
+			for (size_t i = 1; i < res->data.size(); i++)
+			{
+				res->arcLengths[i] = res->arcLengths[i - 1] + CMath::length(res->data[i].position - res->data[i - 1].position);
+			}
+
+			// Make room before inserting, so a stroke that's bigger than the whole budget still gets cached
+			numCachedStrokeVertices += res->data.size();
+			while (numCachedStrokeVertices > maxCachedStrokeVertices && cachedStrokes.size() > 0)
+			{
+				LRUCacheEntry<uint64, StrokeTessellation*>* oldest = cachedStrokes.getOldest();
+				StrokeTessellation* evicted = oldest->data;
+				numCachedStrokeVertices -= evicted->data.size();
+				cachedStrokes.evict(oldest->key);
+				g_memory_delete(evicted);
+			}
+
+			cachedStrokes.insert(key, res);
+			return res;
+		}
+
+		void drawStroke(const StrokeTessellation* stroke, float percentToDraw, const glm::mat4& transform, AnimObjId objId)
+		{
+			if (stroke == nullptr || percentToDraw <= 0.0f)
+			{
+				return;
+			}
+
+			const Vec4 color = getColor();
+			const std::vector<Path_Vertex2DLine>& data = stroke->data;
+
+			if (percentToDraw >= 1.0f)
+			{
+				for (const Path_Vertex2DLine& vertex : data)
+				{
+					if (vertex.isBevel)
+					{
+						drawBevel(vertex, color, transform, objId);
+					}
+				}
+
+				for (int vertIndex = 0; vertIndex < stroke->numSegments; vertIndex++)
+				{
+					const Path_Vertex2DLine& vertex = data[vertIndex % data.size()];
+					const Path_Vertex2DLine& nextVertex = data[(vertIndex + 1) % data.size()];
+					drawStrokeSegment(vertex, color, nextVertex, color, transform, objId);
+				}
+
+				return;
+			}
+
+			// Find the segment the stroke stops in, every vertex before it is re-emitted as is
+			int segmentStart = 0;
+			Vec2 cutPoint = getStrokeCutPoint(stroke, percentToDraw, &segmentStart);
+			Vec2 segmentDirection = data[segmentStart + 1].position - data[segmentStart].position;
+
+			// Partially drawn strokes are open paths, so they get flat caps on both
+			// ends instead of the joins they have as a closed path
+			Path_Vertex2DLine start = data[0];
+			capStrokeEnd(start, data[1].position - data[0].position);
+
+			Path_Vertex2DLine end = data[segmentStart + 1];
+			end.position = cutPoint;
+			capStrokeEnd(end, segmentDirection);
+
+			for (int vertIndex = 1; vertIndex <= segmentStart; vertIndex++)
+			{
+				if (data[vertIndex].isBevel)
+				{
+					drawBevel(data[vertIndex], color, transform, objId);
+				}
+			}
+
+			for (int vertIndex = 0; vertIndex < segmentStart; vertIndex++)
+			{
+				const Path_Vertex2DLine& vertex = vertIndex == 0 ? start : data[vertIndex];
+				drawStrokeSegment(vertex, color, data[vertIndex + 1], color, transform, objId);
+			}
+			drawStrokeSegment(segmentStart == 0 ? start : data[segmentStart], color, end, color, transform, objId);
+		}
+
+		float getStrokeLength(const StrokeTessellation* stroke)
+		{
+			g_logger_assert(stroke != nullptr, "Null stroke.");
+			return stroke->arcLengths[stroke->arcLengths.size() - 1];
+		}
+
+		Vec2 getStrokeCutPoint(const StrokeTessellation* stroke, float percentToDraw, int* outSegmentStart)
+		{
+			g_logger_assert(stroke != nullptr, "Null stroke.");
+
+			const std::vector<Path_Vertex2DLine>& data = stroke->data;
+			const std::vector<float>& arcLengths = stroke->arcLengths;
+			float lengthToDraw = glm::clamp(percentToDraw, 0.0f, 1.0f) * getStrokeLength(stroke);
+			int segmentStart = (int)(std::upper_bound(arcLengths.begin(), arcLengths.end(), lengthToDraw) - arcLengths.begin()) - 1;
+			segmentStart = glm::clamp(segmentStart, 0, (int)data.size() - 2);
+
+			float segmentLength = arcLengths[segmentStart + 1] - arcLengths[segmentStart];
+			float segmentT = segmentLength > 0.0f
+				? glm::clamp((lengthToDraw - arcLengths[segmentStart]) / segmentLength, 0.0f, 1.0f)
+				: 1.0f;
+
+			if (outSegmentStart)
+			{
+				*outSegmentStart = segmentStart;
+			}
+			return data[segmentStart].position + (data[segmentStart + 1].position - data[segmentStart].position) * segmentT;
+		}
+
 		// ----------- 3D stuff ----------- 
 
 		// 3D Lines
@@ -1898,6 +1995,16 @@ namespace MathAnim
 			return list3DBillboardNumTris;
 		}
 
+		int getNumGlDrawCalls()
+		{
+			return numGlDrawCalls;
+		}
+
+		size_t getNumBytesUploaded()
+		{
+			return numBytesUploaded;
+		}
+
 		// ---------------------- Begin Internal Functions ----------------------
 		static void setupDefaultWhiteTexture()
 		{
@@ -1997,6 +2104,173 @@ namespace MathAnim
 			}
 		}
 
+		static int extrudePath(std::vector<Path_Vertex2DLine>& data, bool closePath)
+		{
+			// NOTE: This extrudes all the vertices and forms the tesselated
+			//       path. It also creates any bevels/miters/rounded corners
+			//       and saves their corners along with the connection points.
+			//
+			//       Drawing the stroke afterwards just connects the verts
+			//       into quads and fills in the bevels.
+
+			// TODO: Clean this up. Path's should never have a duplicate start/end point in the first
+			//       place if it's a closed path, that should be implicit. Instead we should normalize paths
+			//       and make sure that if a path gets closed the endpoint != the start point.
+			//       Here's a Github issue to track this:
+			//         https://github.com/ambrosiogabe/MathAnimation/issues/104
+			//       ID for code search: %BW7n4C2kfxQtpij6tHL
+			bool firstPointIsSameAsLastPoint = data.size() > 0
+				? data[0].position == data[data.size() - 1].position
+				: true;
+
+			int endPoint = firstPointIsSameAsLastPoint
+				? (int)data.size() - 1
+				: (int)data.size();
+			for (int vertIndex = 0; vertIndex < (int)data.size(); vertIndex++)
+			{
+				Path_Vertex2DLine& vertex = data[vertIndex];
+				Vec2 currentPos = vertex.position;
+				Vec2 nextPos = vertIndex + 1 < endPoint
+					? data[vertIndex + 1].position
+					: closePath
+					? data[(vertIndex + 1) % endPoint].position
+					: data[endPoint - 1].position;
+				Vec2 previousPos = vertIndex > 0
+					? data[vertIndex - 1].position
+					: closePath
+					? data[endPoint - 1].position
+					: data[0].position;
+
+				Vec2 dirA = CMath::normalize(currentPos - previousPos);
+				Vec2 dirB = CMath::normalize(nextPos - currentPos);
+				if (CMath::compare(dirA, -1.0f * dirB))
+				{
+					// Vectors are pointing away from each other. This means finding a bisection vector would be 
+					// inconclusive since it could point either way. So we'll just wiggle the vector a bit to
+					// make the math not degrade to inf's and nan's
+					dirA.x += 0.0000001f;
+				}
+				Vec2 bisectionPerp = CMath::normalize(dirA + dirB);
+				Vec2 secondLinePerp = Vec2{ -dirB.y, dirB.x };
+				// This is the miter
+				Vec2 bisection = Vec2{ -bisectionPerp.y, bisectionPerp.x };
+				Vec2 extrusionNormal = bisection;
+				float bisectionDotProduct = CMath::dot(bisection, secondLinePerp);
+				float miterThickness = vertex.thickness / bisectionDotProduct;
+				if (CMath::compare(bisectionDotProduct, 0.0f, 0.01f))
+				{
+					// Clamp the miter if the joining curves are almost parallell
+					miterThickness = vertex.thickness;
+				}
+
+				constexpr float strokeMiterLimit = 2.0f;
+				bool shouldConvertToBevel = CMath::abs(miterThickness / vertex.thickness) > strokeMiterLimit;
+				if (shouldConvertToBevel)
+				{
+					float firstBevelWidth = vertex.thickness / CMath::dot(bisection, dirA) * 0.5f;
+					float secondBevelWidth = vertex.thickness / CMath::dot(bisection, dirB) * 0.5f;
+					Vec2 firstPoint = currentPos + (bisectionPerp * firstBevelWidth);
+					Vec2 secondPoint = currentPos + (bisectionPerp * secondBevelWidth);
+
+					float centerBevelWidth = vertex.thickness / CMath::dot(bisectionPerp, CMath::normalize(currentPos - previousPos));
+					centerBevelWidth = glm::min(centerBevelWidth, vertex.thickness);
+					Vec2 centerPoint = currentPos + (bisection * centerBevelWidth);
+					vertex.isBevel = true;
+
+					// Save the "front" and "back" for the connection loop
+					vertex.frontP1 = centerPoint;
+					vertex.frontP2 = secondPoint;
+
+					vertex.backP1 = centerPoint;
+					vertex.backP2 = firstPoint;
+
+					// -----------
+					continue; // NOTE: The continue here. This is basically like an exit early thing
+					// -----------
+				}
+
+				// If we're drawing the beginning/end of the path, just
+				// do a straight cap on the line segment
+				if (vertIndex == 0 && !closePath)
+				{
+					Vec2 normal = CMath::normalize(nextPos - currentPos);
+					extrusionNormal = Vec2{ -normal.y, normal.x };
+					miterThickness = vertex.thickness;
+				}
+				else if (vertIndex == endPoint - 1 && !closePath)
+				{
+					Vec2 normal = CMath::normalize(currentPos - previousPos);
+					extrusionNormal = Vec2{ -normal.y, normal.x };
+					miterThickness = vertex.thickness;
+				}
+
+				// If we're doing a bevel or something, that uses special vertices
+				// to join segments. Otherwise we can just use the extrusion normal
+				// and miterThickness to join the segments
+				vertex.isBevel = false;
+				vertex.frontP1 = vertex.position + extrusionNormal * miterThickness * 0.5f;
+				vertex.frontP2 = vertex.position - extrusionNormal * miterThickness * 0.5f;
+
+				vertex.backP1 = vertex.position + extrusionNormal * miterThickness * 0.5f;
+				vertex.backP2 = vertex.position - extrusionNormal * miterThickness * 0.5f;
+			}
+
+			// NOTE: This is some weird shenanigans in order to get the path
+			//       to close correctly and join the last vertex to the first vertex
+			if (!closePath)
+			{
+				endPoint--;
+			}
+
+			return endPoint;
+		}
+
+		static void capStrokeEnd(Path_Vertex2DLine& vertex, const Vec2& direction)
+		{
+			Vec2 normal = CMath::normalize(direction);
+			Vec2 extrusionNormal = Vec2{ -normal.y, normal.x };
+
+			vertex.isBevel = false;
+			vertex.frontP1 = vertex.position + extrusionNormal * vertex.thickness * 0.5f;
+			vertex.frontP2 = vertex.position - extrusionNormal * vertex.thickness * 0.5f;
+
+			vertex.backP1 = vertex.frontP1;
+			vertex.backP2 = vertex.frontP2;
+		}
+
+		static void drawBevel(const Path_Vertex2DLine& vertex, const Vec4& color, const glm::mat4& transform, AnimObjId objId)
+		{
+			drawMultiColoredTri3D(
+				transformVertVec3(vertex.backP2, transform), color,
+				transformVertVec3(vertex.frontP2, transform), color,
+				transformVertVec3(vertex.frontP1, transform), color,
+				objId);
+		}
+
+		static void drawStrokeSegment(const Path_Vertex2DLine& vertex, const Vec4& color, const Path_Vertex2DLine& nextVertex, const Vec4& nextColor, const glm::mat4& transform, AnimObjId objId)
+		{
+			drawMultiColoredTri3D(
+				transformVertVec3(vertex.frontP1, transform), color,
+				transformVertVec3(vertex.frontP2, transform), color,
+				transformVertVec3(nextVertex.backP1, transform), nextColor,
+				objId);
+			drawMultiColoredTri3D(
+				transformVertVec3(vertex.frontP2, transform), color,
+				transformVertVec3(nextVertex.backP2, transform), nextColor,
+				transformVertVec3(nextVertex.backP1, transform), nextColor,
+				objId);
+		}
+
+		static void freeCachedStrokes()
+		{
+			for (LRUCacheEntry<uint64, StrokeTessellation*>* entry = cachedStrokes.getOldest(); entry != nullptr; entry = entry->next)
+			{
+				g_memory_delete(entry->data);
+			}
+			cachedStrokes.clear();
+			numCachedStrokeVertices = 0;
+		}
+
 		static const Camera* getCurrentCamera2D()
 		{
 			g_logger_assert(camera2DStackPtr > 0, "Camera2D stack is empty. No current camera.");
@@ -2020,12 +2294,157 @@ namespace MathAnim
 		// ---------------------- End Internal Functions ----------------------
 	}
 
+	// ---------------------- Begin MultiDrawList Functions ----------------------
+	void MultiDrawList::init()
+	{
+		draws = {};
+		batches = {};
+		counts = {};
+		indexOffsets = {};
+		baseVertices = {};
+
+		if (GL::supportsMultiDrawIndirect())
+		{
+			indirectBuffer.create(Renderer::initialIndirectBufferSize);
+		}
+	}
+
+	void MultiDrawList::addDraw(const Camera* camera, uint32 textureId, uint32 elementCount, uint32 firstIndex, uint32 baseVertex)
+	{
+		if (batches.size() == 0 ||
+			batches[batches.size() - 1].camera != camera ||
+			batches[batches.size() - 1].textureId != textureId)
+		{
+			DrawBatch newBatch;
+			newBatch.camera = camera;
+			newBatch.textureId = textureId;
+			newBatch.firstDraw = (uint32)draws.size();
+			newBatch.numDraws = 0;
+			batches.emplace_back(newBatch);
+		}
+
+		DrawElementsIndirectCommand draw;
+		draw.count = elementCount;
+		draw.instanceCount = 1;
+		draw.firstIndex = firstIndex;
+		draw.baseVertex = (int32)baseVertex;
+		draw.baseInstance = 0;
+		draws.emplace_back(draw);
+
+		batches[batches.size() - 1].numDraws++;
+	}
+
+	void MultiDrawList::submit(const Shader& shader, size_t indexBufferOffset)
+	{
+		if (draws.size() == 0)
+		{
+			return;
+		}
+
+		bool useIndirect = GL::supportsMultiDrawIndirect();
+		size_t indirectBufferOffset = 0;
+		if (useIndirect)
+		{
+			// Indirect draws count firstIndex from the start of the index buffer, not from our upload
+			uint32 firstIndexOffset = (uint32)(indexBufferOffset / sizeof(uint16));
+			for (DrawElementsIndirectCommand& draw : draws)
+			{
+				draw.firstIndex += firstIndexOffset;
+			}
+
+			size_t indirectDataSize = sizeof(DrawElementsIndirectCommand) * draws.size();
+			indirectBufferOffset = indirectBuffer.upload(draws.data(), indirectDataSize);
+			Renderer::numBytesUploaded += indirectDataSize;
+			GL::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer.getId());
+		}
+
+		shader.uploadInt("uTexture", 0);
+
+		// Only upload the camera matrices when they actually change
+		const Camera* boundCamera = nullptr;
+		for (const DrawBatch& batch : batches)
+		{
+			if (batch.camera != boundCamera)
+			{
+				shader.uploadMat4("uProjection", batch.camera->projectionMatrix);
+				shader.uploadMat4("uView", batch.camera->viewMatrix);
+				boundCamera = batch.camera;
+			}
+
+			if (batch.textureId != UINT32_MAX)
+			{
+				GL::bindTexSlot(GL_TEXTURE_2D, batch.textureId, 0);
+			}
+			else
+			{
+				GL::bindTexSlot(GL_TEXTURE_2D, Renderer::defaultWhiteTexture.graphicsId, 0);
+			}
+
+			if (useIndirect)
+			{
+				GL::multiDrawElementsIndirect(
+					GL_TRIANGLES,
+					GL_UNSIGNED_SHORT,
+					(const void*)(indirectBufferOffset + sizeof(DrawElementsIndirectCommand) * batch.firstDraw),
+					(GLsizei)batch.numDraws,
+					0
+				);
+			}
+			else
+			{
+				counts.clear();
+				indexOffsets.clear();
+				baseVertices.clear();
+				for (uint32 i = batch.firstDraw; i < batch.firstDraw + batch.numDraws; i++)
+				{
+					counts.push_back((GLsizei)draws[i].count);
+					indexOffsets.push_back((const void*)(indexBufferOffset + sizeof(uint16) * draws[i].firstIndex));
+					baseVertices.push_back((GLint)draws[i].baseVertex);
+				}
+
+				GL::multiDrawElementsBaseVertex(
+					GL_TRIANGLES,
+					counts.data(),
+					GL_UNSIGNED_SHORT,
+					indexOffsets.data(),
+					(GLsizei)batch.numDraws,
+					baseVertices.data()
+				);
+			}
+
+			Renderer::numGlDrawCalls++;
+		}
+
+		if (useIndirect)
+		{
+			GL::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			indirectBuffer.fence();
+		}
+
+		clear();
+	}
+
+	void MultiDrawList::clear()
+	{
+		draws.clear();
+		batches.clear();
+	}
+
+	void MultiDrawList::free()
+	{
+		indirectBuffer.free();
+		draws.clear();
+		batches.clear();
+		counts.clear();
+		indexOffsets.clear();
+		baseVertices.clear();
+	}
+	// ---------------------- End MultiDrawList Functions ----------------------
+
 	// ---------------------- Begin DrawList2D Functions ----------------------
 	void DrawList2D::init()
 	{
 		vao = UINT32_MAX;
-		ebo = UINT32_MAX;
-		vbo = UINT32_MAX;
 
 		vertices = {};
 		indices = {};
@@ -2043,7 +2462,7 @@ namespace MathAnim
 		{
 			DrawCmd newCommand;
 			newCommand.camera = currentCamera;
-			newCommand.indexOffset = (uint16)indices.size();
+			newCommand.indexOffset = (uint32)indices.size();
 			newCommand.vertexOffset = (uint32)vertices.size();
 			newCommand.textureId = textureId;
 			newCommand.numElements = 0;
@@ -2184,35 +2603,30 @@ namespace MathAnim
 
 	void DrawList2D::setupGraphicsBuffers()
 	{
-		// Create the batched vao
 		GL::createVertexArray(&vao);
-		GL::bindVertexArray(vao);
-
-		GL::genBuffers(1, &vbo);
-
-		// Allocate space for the batched vao
-		GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-		GL::bufferData(GL_ARRAY_BUFFER, sizeof(Vertex2D), NULL, GL_DYNAMIC_DRAW);
+		vbo.create(Renderer::initialVertexBufferSize);
+		ebo.create(Renderer::initialIndexBufferSize);
+		multiDraw.init();
+	}
 
-		GL::genBuffers(1, &ebo);
-		GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16), NULL, GL_DYNAMIC_DRAW);
+	void DrawList2D::bindVertexAttributes(size_t vertexBufferOffset)
+	{
+		GL::bindBuffer(GL_ARRAY_BUFFER, vbo.getId());
 
-		// Set up the batched vao attributes
-		GL::vertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (void*)(offsetof(Vertex2D, position)));
+		GL::vertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (void*)(vertexBufferOffset + offsetof(Vertex2D, position)));
 		GL::enableVertexAttribArray(0);
 
-		GL::vertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (void*)(offsetof(Vertex2D, color)));
+		GL::vertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (void*)(vertexBufferOffset + offsetof(Vertex2D, color)));
 		GL::enableVertexAttribArray(1);
 
-		GL::vertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (void*)(offsetof(Vertex2D, textureCoords)));
+		GL::vertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (void*)(vertexBufferOffset + offsetof(Vertex2D, textureCoords)));
 		GL::enableVertexAttribArray(2);
 
-		GL::vertexAttribIPointer(3, 2, GL_UNSIGNED_INT, sizeof(Vertex2D), (void*)(offsetof(Vertex2D, objId)));
+		GL::vertexAttribIPointer(3, 2, GL_UNSIGNED_INT, sizeof(Vertex2D), (void*)(vertexBufferOffset + offsetof(Vertex2D, objId)));
 		GL::enableVertexAttribArray(3);
 	}
 
-	void DrawList2D::render(const Shader& shader) const
+	void DrawList2D::render(const Shader& shader)
 	{
 		if (vertices.size() == 0)
 		{
@@ -2226,50 +2640,25 @@ namespace MathAnim
 		shader.bind();
 		shader.uploadInt("uWireframeOn", EditorSettings::getSettings().viewMode == ViewMode::WireMesh);
 
-		for (int i = 0; i < drawCommands.size(); i++)
-		{
-			shader.uploadMat4("uProjection", drawCommands[i].camera->projectionMatrix);
-			shader.uploadMat4("uView", drawCommands[i].camera->viewMatrix);
-
-			if (drawCommands[i].textureId != UINT32_MAX)
-			{
-				// Bind the texture
-				GL::bindTexSlot(GL_TEXTURE_2D, drawCommands[i].textureId, 0);
-				shader.uploadInt("uTexture", 0);
-			}
-			else
-			{
-				GL::bindTexSlot(GL_TEXTURE_2D, Renderer::defaultWhiteTexture.graphicsId, 0);
-				shader.uploadInt("uTexture", 0);
-			}
-
-			GL::bindVertexArray(vao);
-			GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-			GL::bufferData(
-				GL_ARRAY_BUFFER,
-				sizeof(Vertex2D) * drawCommands[i].numVerts,
-				vertices.data() + drawCommands[i].vertexOffset,
-				GL_DYNAMIC_DRAW
-			);
+		// Upload the whole frame at once, every command just points into it
+		size_t vertexDataSize = sizeof(Vertex2D) * vertices.size();
+		size_t indexDataSize = sizeof(uint16) * indices.size();
+		size_t vertexBufferOffset = vbo.upload(vertices.data(), vertexDataSize);
+		size_t indexBufferOffset = ebo.upload(indices.data(), indexDataSize);
+		Renderer::numBytesUploaded += vertexDataSize + indexDataSize;
 
-			// Buffer the elements
-			GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-			GL::bufferData(
-				GL_ELEMENT_ARRAY_BUFFER,
-				sizeof(uint16) * drawCommands[i].numElements,
-				indices.data() + drawCommands[i].indexOffset,
-				GL_DYNAMIC_DRAW
-			);
+		GL::bindVertexArray(vao);
+		bindVertexAttributes(vertexBufferOffset);
+		GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo.getId());
 
-			// TODO: Swap this with glMultiDraw...
-			// Make the draw call
-			GL::drawElements(
-				GL_TRIANGLES,
-				drawCommands[i].numElements,
-				GL_UNSIGNED_SHORT,
-				NULL
-			);
+		for (const DrawCmd& cmd : drawCommands)
+		{
+			multiDraw.addDraw(cmd.camera, cmd.textureId, cmd.numElements, cmd.indexOffset, cmd.vertexOffset);
 		}
+		multiDraw.submit(shader, indexBufferOffset);
+
+		vbo.fence();
+		ebo.fence();
 
 		GL::popDebugGroup();
 	}
@@ -2285,23 +2674,15 @@ namespace MathAnim
 
 	void DrawList2D::free()
 	{
-		if (vbo != UINT32_MAX)
-		{
-			GL::deleteBuffers(1, &vbo);
-		}
-
-		if (ebo != UINT32_MAX)
-		{
-			GL::deleteBuffers(1, &ebo);
-		}
+		vbo.free();
+		ebo.free();
+		multiDraw.free();
 
 		if (vao != UINT32_MAX)
 		{
 			GL::deleteVertexArrays(1, &vao);
 		}
 
-		vbo = UINT32_MAX;
-		ebo = UINT32_MAX;
 		vao = UINT32_MAX;
 	}
 	// ---------------------- End DrawList2D Functions ----------------------
@@ -2310,7 +2691,6 @@ namespace MathAnim
 	void DrawList3DLine::init()
 	{
 		vao = UINT32_MAX;
-		vbo = UINT32_MAX;
 
 		vertices = {};
 		setupGraphicsBuffers();
@@ -2392,34 +2772,31 @@ namespace MathAnim
 
 	void DrawList3DLine::setupGraphicsBuffers()
 	{
-		// Create the batched vao
 		GL::createVertexArray(&vao);
-		GL::bindVertexArray(vao);
-
-		GL::genBuffers(1, &vbo);
+		vbo.create(Renderer::initialVertexBufferSize);
+	}
 
-		// Allocate space for the batched vao
-		GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-		GL::bufferData(GL_ARRAY_BUFFER, sizeof(Vertex3DLine), NULL, GL_DYNAMIC_DRAW);
+	void DrawList3DLine::bindVertexAttributes(size_t vertexBufferOffset)
+	{
+		GL::bindBuffer(GL_ARRAY_BUFFER, vbo.getId());
 
-		// Set up the batched vao attributes
-		GL::vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DLine), (void*)(offsetof(Vertex3DLine, p0)));
+		GL::vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DLine), (void*)(vertexBufferOffset + offsetof(Vertex3DLine, p0)));
 		GL::enableVertexAttribArray(0);
 
-		GL::vertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex3DLine), (void*)(offsetof(Vertex3DLine, thickness)));
+		GL::vertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex3DLine), (void*)(vertexBufferOffset + offsetof(Vertex3DLine, thickness)));
 		GL::enableVertexAttribArray(1);
 
-		GL::vertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DLine), (void*)(offsetof(Vertex3DLine, p1)));
+		GL::vertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DLine), (void*)(vertexBufferOffset + offsetof(Vertex3DLine, p1)));
 		GL::enableVertexAttribArray(2);
 
-		GL::vertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(Vertex3DLine), (void*)(offsetof(Vertex3DLine, color)));
+		GL::vertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(Vertex3DLine), (void*)(vertexBufferOffset + offsetof(Vertex3DLine, color)));
 		GL::enableVertexAttribArray(3);
 
-		GL::vertexAttribIPointer(4, 2, GL_UNSIGNED_INT, sizeof(Vertex3DLine), (void*)(offsetof(Vertex3DLine, objId)));
+		GL::vertexAttribIPointer(4, 2, GL_UNSIGNED_INT, sizeof(Vertex3DLine), (void*)(vertexBufferOffset + offsetof(Vertex3DLine, objId)));
 		GL::enableVertexAttribArray(4);
 	}
 
-	void DrawList3DLine::render(const Shader& shader) const
+	void DrawList3DLine::render(const Shader& shader)
 	{
 		if (vertices.size() == 0)
 		{
@@ -2431,26 +2808,32 @@ namespace MathAnim
 		GL::disable(GL_DEPTH_TEST);
 		GL::disable(GL_CULL_FACE);
 
+		size_t vertexDataSize = sizeof(Vertex3DLine) * vertices.size();
+		size_t vertexBufferOffset = vbo.upload(vertices.data(), vertexDataSize);
+		Renderer::numBytesUploaded += vertexDataSize;
+
 		GL::bindVertexArray(vao);
+		bindVertexAttributes(vertexBufferOffset);
 
 		shader.bind();
 
+		const Camera* boundCamera = nullptr;
 		for (size_t i = 0; i < drawCommands.size(); i++)
 		{
-			GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-			GL::bufferData(
-				GL_ARRAY_BUFFER,
-				sizeof(Vertex3DLine) * drawCommands[i].vertCount,
-				vertices.data() + drawCommands[i].vertexOffset,
-				GL_DYNAMIC_DRAW);
-
-			shader.uploadFloat("uAspectRatio", drawCommands[i].camera->aspectRatio);
-			shader.uploadMat4("uProjection", drawCommands[i].camera->projectionMatrix);
-			shader.uploadMat4("uView", drawCommands[i].camera->viewMatrix);
+			if (drawCommands[i].camera != boundCamera)
+			{
+				shader.uploadFloat("uAspectRatio", drawCommands[i].camera->aspectRatio);
+				shader.uploadMat4("uProjection", drawCommands[i].camera->projectionMatrix);
+				shader.uploadMat4("uView", drawCommands[i].camera->viewMatrix);
+				boundCamera = drawCommands[i].camera;
+			}
 
-			GL::drawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+			GL::drawArrays(GL_TRIANGLES, (GLint)drawCommands[i].vertexOffset, (GLsizei)drawCommands[i].vertCount);
+			Renderer::numGlDrawCalls++;
 		}
 
+		vbo.fence();
+
 		GL::popDebugGroup();
 	}
 
@@ -2462,17 +2845,13 @@ namespace MathAnim
 
 	void DrawList3DLine::free()
 	{
-		if (vbo != UINT32_MAX)
-		{
-			GL::deleteBuffers(1, &vbo);
-		}
+		vbo.free();
 
 		if (vao != UINT32_MAX)
 		{
 			GL::deleteVertexArrays(1, &vao);
 		}
 
-		vbo = UINT32_MAX;
 		vao = UINT32_MAX;
 	}
 	// ---------------------- End DrawList3DLine Functions ----------------------
@@ -2481,7 +2860,6 @@ namespace MathAnim
 	void DrawList3DBillboard::init()
 	{
 		vao = UINT32_MAX;
-		vbo = UINT32_MAX;
 
 		vertices = {};
 		setupGraphicsBuffers();
@@ -2623,34 +3001,31 @@ namespace MathAnim
 
 	void DrawList3DBillboard::setupGraphicsBuffers()
 	{
-		// Create the batched vao
 		GL::createVertexArray(&vao);
-		GL::bindVertexArray(vao);
-
-		GL::genBuffers(1, &vbo);
+		vbo.create(Renderer::initialVertexBufferSize);
+	}
 
-		// Allocate space for the batched vao
-		GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-		GL::bufferData(GL_ARRAY_BUFFER, sizeof(Vertex3DLine), NULL, GL_DYNAMIC_DRAW);
+	void DrawList3DBillboard::bindVertexAttributes(size_t vertexBufferOffset)
+	{
+		GL::bindBuffer(GL_ARRAY_BUFFER, vbo.getId());
 
-		// Set up the batched vao attributes
-		GL::vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DBillboard), (void*)(offsetof(Vertex3DBillboard, position)));
+		GL::vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DBillboard), (void*)(vertexBufferOffset + offsetof(Vertex3DBillboard, position)));
 		GL::enableVertexAttribArray(0);
 
-		GL::vertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(Vertex3DBillboard), (void*)(offsetof(Vertex3DBillboard, color)));
+		GL::vertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(Vertex3DBillboard), (void*)(vertexBufferOffset + offsetof(Vertex3DBillboard, color)));
 		GL::enableVertexAttribArray(1);
 
-		GL::vertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex3DBillboard), (void*)(offsetof(Vertex3DBillboard, halfSize)));
+		GL::vertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex3DBillboard), (void*)(vertexBufferOffset + offsetof(Vertex3DBillboard, halfSize)));
 		GL::enableVertexAttribArray(2);
 
-		GL::vertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex3DBillboard), (void*)(offsetof(Vertex3DBillboard, textureCoords)));
+		GL::vertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex3DBillboard), (void*)(vertexBufferOffset + offsetof(Vertex3DBillboard, textureCoords)));
 		GL::enableVertexAttribArray(3);
 
-		GL::vertexAttribIPointer(4, 2, GL_UNSIGNED_INT, sizeof(Vertex3DBillboard), (void*)(offsetof(Vertex3DBillboard, objId)));
+		GL::vertexAttribIPointer(4, 2, GL_UNSIGNED_INT, sizeof(Vertex3DBillboard), (void*)(vertexBufferOffset + offsetof(Vertex3DBillboard, objId)));
 		GL::enableVertexAttribArray(4);
 	}
 
-	void DrawList3DBillboard::render(const Shader& shader) const
+	void DrawList3DBillboard::render(const Shader& shader)
 	{
 		if (vertices.size() == 0)
 		{
@@ -2662,38 +3037,43 @@ namespace MathAnim
 		GL::enable(GL_DEPTH_TEST);
 		GL::disable(GL_CULL_FACE);
 
+		size_t vertexDataSize = sizeof(Vertex3DBillboard) * vertices.size();
+		size_t vertexBufferOffset = vbo.upload(vertices.data(), vertexDataSize);
+		Renderer::numBytesUploaded += vertexDataSize;
+
 		GL::bindVertexArray(vao);
+		bindVertexAttributes(vertexBufferOffset);
 
 		shader.bind();
+		shader.uploadInt("uTexture", 0);
 
+		const Camera* boundCamera = nullptr;
 		for (size_t i = 0; i < drawCommands.size(); i++)
 		{
-			GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-			GL::bufferData(
-				GL_ARRAY_BUFFER,
-				sizeof(Vertex3DBillboard) * drawCommands[i].vertCount,
-				vertices.data() + drawCommands[i].vertexOffset,
-				GL_DYNAMIC_DRAW);
-
 			if (drawCommands[i].textureId != UINT32_MAX)
 			{
 				// Bind the texture
 				GL::bindTexSlot(GL_TEXTURE_2D, drawCommands[i].textureId, 0);
-				shader.uploadInt("uTexture", 0);
 			}
 			else
 			{
 				GL::bindTexSlot(GL_TEXTURE_2D, Renderer::defaultWhiteTexture.graphicsId, 0);
-				shader.uploadInt("uTexture", 0);
 			}
 
-			shader.uploadFloat("uAspectRatio", drawCommands[i].camera->aspectRatio);
-			shader.uploadMat4("uProjection", drawCommands[i].camera->projectionMatrix);
-			shader.uploadMat4("uView", drawCommands[i].camera->viewMatrix);
+			if (drawCommands[i].camera != boundCamera)
+			{
+				shader.uploadFloat("uAspectRatio", drawCommands[i].camera->aspectRatio);
+				shader.uploadMat4("uProjection", drawCommands[i].camera->projectionMatrix);
+				shader.uploadMat4("uView", drawCommands[i].camera->viewMatrix);
+				boundCamera = drawCommands[i].camera;
+			}
 
-			GL::drawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+			GL::drawArrays(GL_TRIANGLES, (GLint)drawCommands[i].vertexOffset, (GLsizei)drawCommands[i].vertCount);
+			Renderer::numGlDrawCalls++;
 		}
 
+		vbo.fence();
+
 		GL::disable(GL_DEPTH_TEST);
 
 		GL::popDebugGroup();
@@ -2707,17 +3087,13 @@ namespace MathAnim
 
 	void DrawList3DBillboard::free()
 	{
-		if (vbo != UINT32_MAX)
-		{
-			GL::deleteBuffers(1, &vbo);
-		}
+		vbo.free();
 
 		if (vao != UINT32_MAX)
 		{
 			GL::deleteVertexArrays(1, &vao);
 		}
 
-		vbo = UINT32_MAX;
 		vao = UINT32_MAX;
 	}
 	// ---------------------- End DrawList3DBillboard Functions ----------------------
@@ -2726,8 +3102,6 @@ namespace MathAnim
 	void DrawList3D::init()
 	{
 		vao = UINT32_MAX;
-		ebo = UINT32_MAX;
-		vbo = UINT32_MAX;
 
 		vertices = {};
 		indices = {};
@@ -2917,43 +3291,52 @@ namespace MathAnim
 
 	void DrawList3D::setupGraphicsBuffers()
 	{
-		// Create the batched vao
 		GL::createVertexArray(&vao);
-		GL::bindVertexArray(vao);
-
-		// Allocate space for the batched vbo
-		GL::genBuffers(1, &vbo);
-		GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-		GL::bufferData(GL_ARRAY_BUFFER, sizeof(Vertex3D), NULL, GL_DYNAMIC_DRAW);
+		vbo.create(Renderer::initialVertexBufferSize);
+		ebo.create(Renderer::initialIndexBufferSize);
+		multiDraw.init();
+	}
 
-		GL::genBuffers(1, &ebo);
-		GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16), NULL, GL_DYNAMIC_DRAW);
+	void DrawList3D::bindVertexAttributes(size_t vertexBufferOffset)
+	{
+		GL::bindBuffer(GL_ARRAY_BUFFER, vbo.getId());
 
-		// Set up the batched vao attributes
-		GL::vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void*)(offsetof(Vertex3D, position)));
+		GL::vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void*)(vertexBufferOffset + offsetof(Vertex3D, position)));
 		GL::enableVertexAttribArray(0);
 
 		// TODO: Change me to a packed color in 1 uint32
-		GL::vertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void*)(offsetof(Vertex3D, color)));
+		GL::vertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void*)(vertexBufferOffset + offsetof(Vertex3D, color)));
 		GL::enableVertexAttribArray(1);
 
-		GL::vertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void*)(offsetof(Vertex3D, textureCoords)));
+		GL::vertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void*)(vertexBufferOffset + offsetof(Vertex3D, textureCoords)));
 		GL::enableVertexAttribArray(2);
 
-		GL::vertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void*)(offsetof(Vertex3D, normal)));
+		GL::vertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (void*)(vertexBufferOffset + offsetof(Vertex3D, normal)));
 		GL::enableVertexAttribArray(3);
 
-		GL::vertexAttribIPointer(4, 2, GL_UNSIGNED_INT, sizeof(Vertex3D), (void*)(offsetof(Vertex3D, objId)));
+		GL::vertexAttribIPointer(4, 2, GL_UNSIGNED_INT, sizeof(Vertex3D), (void*)(vertexBufferOffset + offsetof(Vertex3D, objId)));
 		GL::enableVertexAttribArray(4);
 	}
 
+	void DrawList3D::queueDraws(bool isTransparent)
+	{
+		// Commands from the other pass get skipped, so neighbors with the same camera and
+		// texture end up in the same batch even if they were split up by the other pass
+		for (const DrawCmd3D& cmd : drawCommands)
+		{
+			if (cmd.isTransparent == isTransparent)
+			{
+				multiDraw.addDraw(cmd.camera, cmd.textureId, cmd.elementCount, cmd.indexOffset, cmd.vertexOffset);
+			}
+		}
+	}
+
 	void DrawList3D::render(
 		const Shader& opaqueShader,
 		const Shader& transparentShader,
 		const Shader& compositeShader,
 		const Framebuffer& framebuffer
-	) const
+	)
 	{
 		if (vertices.size() == 0)
 		{
@@ -2963,6 +3346,17 @@ namespace MathAnim
 		GL::pushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, Renderer::debugMsgId++, -1, "3D_OIT_Pass");
 		framebuffer.bind();
 
+		// Both passes read from the same upload
+		size_t vertexDataSize = sizeof(Vertex3D) * vertices.size();
+		size_t indexDataSize = sizeof(uint16) * indices.size();
+		size_t vertexBufferOffset = vbo.upload(vertices.data(), vertexDataSize);
+		size_t indexBufferOffset = ebo.upload(indices.data(), indexDataSize);
+		Renderer::numBytesUploaded += vertexDataSize + indexDataSize;
+
+		GL::bindVertexArray(vao);
+		bindVertexAttributes(vertexBufferOffset);
+		GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo.getId());
+
 		Vec4 sunColor = "#ffffffff"_hex;
 
 		// Set up the opaque draw buffers
@@ -2978,54 +3372,8 @@ namespace MathAnim
 		//opaqueShader.uploadVec3("sunDirection", glm::vec3(0.3f, -0.2f, -0.8f));
 		//opaqueShader.uploadVec3("sunColor", glm::vec3(sunColor.r, sunColor.g, sunColor.b));
 
-		for (int i = 0; i < drawCommands.size(); i++)
-		{
-			if (drawCommands[i].isTransparent)
-			{
-				continue;
-			}
-
-			opaqueShader.uploadMat4("uProjection", drawCommands[i].camera->projectionMatrix);
-			opaqueShader.uploadMat4("uView", drawCommands[i].camera->viewMatrix);
-
-			if (drawCommands[i].textureId != UINT32_MAX)
-			{
-				// Bind the texture
-				GL::bindTexSlot(GL_TEXTURE_2D, drawCommands[i].textureId, 0);
-				opaqueShader.uploadInt("uTexture", 0);
-			}
-			else
-			{
-				GL::bindTexSlot(GL_TEXTURE_2D, Renderer::defaultWhiteTexture.graphicsId, 0);
-				opaqueShader.uploadInt("uTexture", 0);
-			}
-
-			GL::bindVertexArray(vao);
-			GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-			GL::bufferData(
-				GL_ARRAY_BUFFER,
-				sizeof(Vertex3D) * drawCommands[i].vertCount,
-				vertices.data() + drawCommands[i].vertexOffset,
-				GL_DYNAMIC_DRAW
-			);
-
-			GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-			GL::bufferData(
-				GL_ELEMENT_ARRAY_BUFFER,
-				sizeof(uint16) * drawCommands[i].elementCount,
-				indices.data() + drawCommands[i].indexOffset,
-				GL_DYNAMIC_DRAW
-			);
-
-			// TODO: Swap this with glMultiDraw...
-			// Make the draw call
-			GL::drawElements(
-				GL_TRIANGLES,
-				drawCommands[i].elementCount,
-				GL_UNSIGNED_SHORT,
-				nullptr
-			);
-		}
+		queueDraws(false);
+		multiDraw.submit(opaqueShader, indexBufferOffset);
 
 		// Set up the transparent draw buffers
 		drawBuffers[0] = GL_NONE;
@@ -3058,54 +3406,11 @@ namespace MathAnim
 		//transparentShader.uploadVec3("sunDirection", glm::vec3(0.3f, -0.2f, -0.8f));
 		//transparentShader.uploadVec3("sunColor", glm::vec3(sunColor.r, sunColor.g, sunColor.b));
 
-		for (int i = 0; i < drawCommands.size(); i++)
-		{
-			if (!drawCommands[i].isTransparent)
-			{
-				continue;
-			}
+		queueDraws(true);
+		multiDraw.submit(transparentShader, indexBufferOffset);
 
-			transparentShader.uploadMat4("uProjection", drawCommands[i].camera->projectionMatrix);
-			transparentShader.uploadMat4("uView", drawCommands[i].camera->viewMatrix);
-
-			if (drawCommands[i].textureId != UINT32_MAX)
-			{
-				// Bind the texture
-				GL::bindTexSlot(GL_TEXTURE_2D, drawCommands[i].textureId, 0);
-				transparentShader.uploadInt("uTexture", 0);
-			}
-			else
-			{
-				GL::bindTexSlot(GL_TEXTURE_2D, Renderer::defaultWhiteTexture.graphicsId, 0);
-				transparentShader.uploadInt("uTexture", 0);
-			}
-
-			GL::bindVertexArray(vao);
-			GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
-			GL::bufferData(
-				GL_ARRAY_BUFFER,
-				sizeof(Vertex3D) * drawCommands[i].vertCount,
-				vertices.data() + drawCommands[i].vertexOffset,
-				GL_DYNAMIC_DRAW
-			);
-
-			GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-			GL::bufferData(
-				GL_ELEMENT_ARRAY_BUFFER,
-				sizeof(uint16) * drawCommands[i].elementCount,
-				indices.data() + drawCommands[i].indexOffset,
-				GL_DYNAMIC_DRAW
-			);
-
-			// TODO: Swap this with glMultiDraw...
-			// Make the draw call
-			GL::drawElements(
-				GL_TRIANGLES,
-				drawCommands[i].elementCount,
-				GL_UNSIGNED_SHORT,
-				nullptr
-			);
-		}
+		vbo.fence();
+		ebo.fence();
 
 		// Set up the composite draw buffers
 		drawBuffers[0] = GL_COLOR_ATTACHMENT0;
@@ -3134,6 +3439,7 @@ namespace MathAnim
 
 		GL::bindVertexArray(Renderer::screenVao);
 		GL::drawArrays(GL_TRIANGLES, 0, 6);
+		Renderer::numGlDrawCalls++;
 
 		// Reset GL state
 		// Enable writing to the depth buffer again
@@ -3153,23 +3459,15 @@ namespace MathAnim
 
 	void DrawList3D::free()
 	{
-		if (vbo != UINT32_MAX)
-		{
-			GL::deleteBuffers(1, &vbo);
-		}
-
-		if (ebo != UINT32_MAX)
-		{
-			GL::deleteBuffers(1, &ebo);
-		}
+		vbo.free();
+		ebo.free();
+		multiDraw.free();
 
 		if (vao != UINT32_MAX)
 		{
 			GL::deleteVertexArrays(1, &vao);
 		}
 
-		vbo = UINT32_MAX;
-		ebo = UINT32_MAX;
 		vao = UINT32_MAX;
 
 		vertices.clear();
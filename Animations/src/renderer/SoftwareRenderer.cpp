@@ -0,0 +1,741 @@
+#include "renderer/SoftwareRenderer.h"
+#include "renderer/Camera.h"
+#include "animation/Animation.h"
+#include "animation/AnimationManager.h"
+#include "multithreading/GlobalThreadPool.h"
+#include "svg/Svg.h"
+#include "math/CMath.h"
+#include "core/Profiling.h"
+
+#include <plutovg.h>
+#include <stb/stb_image.h>
+
+namespace MathAnim
+{
+	enum class SoftwareDrawType : uint8
+	{
+		Fill,
+		Stroke,
+		Image
+	};
+
+	enum class SoftwarePathVerb : uint8
+	{
+		MoveTo,
+		LineTo,
+		QuadTo,
+		CubicTo
+	};
+
+	struct SoftwareDrawCommand
+	{
+		SoftwareDrawType type;
+		// Range of this command's path inside SoftwareFrame::verbs and SoftwareFrame::points
+		size_t verbStart;
+		size_t numVerbs;
+		size_t pointStart;
+		Vec4 color;
+		float strokeWidth;
+		FillType fillType;
+		plutovg_surface_t* image;
+		plutovg_matrix_t imageMatrix;
+		// Vertical pixel bounds, used to skip commands that don't touch a tile
+		float minY;
+		float maxY;
+		float depth;
+	};
+
+	// Everything that gets drawn in a frame, already projected into framebuffer pixels.
+	// It's built on the main thread and then only read by the tile workers.
+	struct SoftwareFrame
+	{
+		std::vector<SoftwareDrawCommand> commands;
+		std::vector<SoftwarePathVerb> verbs;
+		std::vector<Vec2> points;
+	};
+
+	struct SoftwareTileData
+	{
+		SoftwareFramebuffer* framebuffer;
+		const SoftwareFrame* frame;
+		uint32 clearColor;
+		int yStart;
+		int yEnd;
+	};
+
+	namespace SoftwareRenderer
+	{
+		// Split the framebuffer into more tiles than there are threads so that a few
+		// expensive tiles don't leave the rest of the threads idle
+		static constexpr int TILES_PER_THREAD = 2;
+		static constexpr int MIN_TILE_HEIGHT = 32;
+		// Same default that Svg::renderOutline2D uses
+		static constexpr float DEFAULT_STROKE_WIDTH = 0.02f;
+		// Points behind (or on) the camera plane can't be projected
+		static constexpr float MIN_CLIP_W = 0.0001f;
+
+		static SoftwareFrame frame;
+		static std::vector<SoftwareTileData> tiles;
+		static std::unordered_map<std::string, plutovg_surface_t*> imageCache;
+
+		// ----------- Internal functions -----------
+		static bool projectPoint(const glm::mat4& mvp, const Vec2& framebufferSize, const Vec3& point, Vec2* out, float* outDepth = nullptr);
+		static Vec2 svgToLocal(const SvgObject* svg, const Vec2& svgPoint);
+		static void beginCommand(SoftwareDrawCommand& command, SoftwareDrawType type);
+		static bool pushVerb(SoftwareDrawCommand& command, const glm::mat4& mvp, const Vec2& framebufferSize, const SvgObject* svg, SoftwarePathVerb verb, const Vec2* svgPoints, int numPoints);
+		static bool pushCurve(SoftwareDrawCommand& command, const glm::mat4& mvp, const Vec2& framebufferSize, const SvgObject* svg, const Curve& curve);
+		static void endCommand(SoftwareDrawCommand& command, bool isValid);
+		static void collectSvgObject(const AnimObject& obj, const glm::mat4& viewProjection, const Camera& camera, const Vec2& framebufferSize);
+		static void collectImageObject(const AnimationManagerData* am, const AnimObject& obj, const glm::mat4& viewProjection, const Vec2& framebufferSize);
+		static plutovg_surface_t* getOrLoadImage(const char* filepath);
+		static uint32 packPremultipliedArgb(const Vec4& color);
+		static void replayCommand(plutovg_t* pluto, const SoftwareFrame& drawList, const SoftwareDrawCommand& command, float yOffset);
+		static void renderTile(const SoftwareTileData& tile);
+
+		void init()
+		{
+			frame.commands.clear();
+			frame.verbs.clear();
+			frame.points.clear();
+			tiles.clear();
+		}
+
+		void free()
+		{
+			for (auto& [filepath, surface] : imageCache)
+			{
+				// Images that failed to load are cached as nullptr
+				if (surface)
+				{
+					plutovg_surface_destroy(surface);
+				}
+			}
+			imageCache.clear();
+
+			frame.commands = {};
+			frame.verbs = {};
+			frame.points = {};
+			tiles = {};
+		}
+
+		SoftwareFramebuffer createFramebuffer(int width, int height)
+		{
+			g_logger_assert(width > 0 && height > 0, "Invalid software framebuffer size {}x{}.", width, height);
+
+			SoftwareFramebuffer res;
+			res.width = width;
+			res.height = height;
+			res.stride = width * (int)sizeof(uint32);
+			size_t pixelsSize = (size_t)res.stride * (size_t)height;
+			res.pixels = (uint8*)g_memory_allocate(pixelsSize);
+			g_memory_zeroMem(res.pixels, pixelsSize);
+			return res;
+		}
+
+		void destroyFramebuffer(SoftwareFramebuffer& framebuffer)
+		{
+			if (framebuffer.pixels)
+			{
+				g_memory_free(framebuffer.pixels);
+			}
+
+			framebuffer.pixels = nullptr;
+			framebuffer.width = 0;
+			framebuffer.height = 0;
+			framebuffer.stride = 0;
+		}
+
+		void renderToFramebuffer(SoftwareFramebuffer& framebuffer, const AnimationManagerData* am, const Camera& camera, GlobalThreadPool* threadPool)
+		{
+			MP_PROFILE_EVENT("SoftwareRenderer_RenderToFramebuffer");
+			g_logger_assert(framebuffer.pixels != nullptr, "Tried to render to a software framebuffer that was never created.");
+
+			frame.commands.clear();
+			frame.verbs.clear();
+			frame.points.clear();
+
+			Vec2 framebufferSize = Vec2{ (float)framebuffer.width, (float)framebuffer.height };
+			glm::mat4 viewProjection = camera.projectionMatrix * camera.viewMatrix;
+
+			{
+				MP_PROFILE_EVENT("SoftwareRenderer_CollectDrawCommands");
+
+				const std::vector<AnimObject>& objects = AnimationManager::getAnimObjects(am);
+				for (const AnimObject& obj : objects)
+				{
+					if (obj.status == AnimObjectStatus::Inactive)
+					{
+						continue;
+					}
+
+					switch (obj.objectType)
+					{
+					case AnimObjectTypeV1::Square:
+					case AnimObjectTypeV1::Circle:
+					case AnimObjectTypeV1::SvgObject:
+					case AnimObjectTypeV1::Arrow:
+						collectSvgObject(obj, viewProjection, camera, framebufferSize);
+						break;
+					case AnimObjectTypeV1::_ImageObject:
+						collectImageObject(am, obj, viewProjection, framebufferSize);
+						break;
+					default:
+						// Every other object is either a container for the objects above or
+						// something that's only visible in the editor
+						break;
+					}
+				}
+
+				// Painter's algorithm, draw the furthest objects first. The sort is stable so objects
+				// at the same depth keep the order they were added to the scene in.
+				std::stable_sort(frame.commands.begin(), frame.commands.end(),
+					[](const SoftwareDrawCommand& a, const SoftwareDrawCommand& b)
+					{
+						return a.depth > b.depth;
+					}
+				);
+			}
+
+			int numThreads = threadPool ? (int)threadPool->getNumThreads() + 1 : 1;
+			int numTiles = numThreads * TILES_PER_THREAD;
+			int tileHeight = glm::max((framebuffer.height + numTiles - 1) / numTiles, MIN_TILE_HEIGHT);
+			numTiles = (framebuffer.height + tileHeight - 1) / tileHeight;
+
+			uint32 clearColor = packPremultipliedArgb(camera.fillColor);
+			tiles.resize(numTiles);
+			for (int i = 0; i < numTiles; i++)
+			{
+				tiles[i].framebuffer = &framebuffer;
+				tiles[i].frame = &frame;
+				tiles[i].clearColor = clearColor;
+				tiles[i].yStart = i * tileHeight;
+				tiles[i].yEnd = glm::min((i + 1) * tileHeight, framebuffer.height);
+			}
+
+			if (!threadPool || numTiles == 1)
+			{
+				for (int i = 0; i < numTiles; i++)
+				{
+					renderTile(tiles[i]);
+				}
+				return;
+			}
+
+			MP_PROFILE_EVENT("SoftwareRenderer_RenderTiles");
+			threadPool->parallelFor(0, (size_t)numTiles, 1, [](size_t tileBegin, size_t tileEnd)
+			{
+				for (size_t i = tileBegin; i < tileEnd; i++)
+				{
+					renderTile(tiles[i]);
+				}
+			}, "SoftwareRendererTile");
+		}
+
+		void convertToYuv420(const SoftwareFramebuffer& framebuffer, uint8* yuvPixels, size_t yuvPixelsSize)
+		{
+			MP_PROFILE_EVENT("SoftwareRenderer_ConvertToYuv420");
+
+			int width = framebuffer.width;
+			int height = framebuffer.height;
+			size_t yChannelSize = (size_t)width * (size_t)height;
+			size_t uChannelSize = (size_t)(width / 2) * (size_t)(height / 2);
+			g_logger_assert(yuvPixelsSize == yChannelSize + uChannelSize * 2, "Invalid YUV buffer size for a {}x{} framebuffer.", width, height);
+
+			uint8* yChannel = yuvPixels;
+			uint8* uChannel = yuvPixels + yChannelSize;
+			uint8* vChannel = yuvPixels + yChannelSize + uChannelSize;
+
+			// NOTE: These are the same BT.601 coefficients as the rgbToYuv shaders. The GPU export reads
+			//       its framebuffers back bottom row first, so the rows are flipped here to hand the
+			//       encoder the exact same layout.
+			for (int y = 0; y < height; y += 2)
+			{
+				Vec4 blockColor = Vec4{ 0, 0, 0, 0 };
+				for (int x = 0; x < width; x++)
+				{
+					for (int row = 0; row < 2 && y + row < height; row++)
+					{
+						int srcY = y + row;
+						const uint32* src = (const uint32*)(framebuffer.pixels + (size_t)srcY * framebuffer.stride);
+						uint32 pixel = src[x];
+
+						float a = (float)((pixel >> 24) & 0xFF);
+						float r = (float)((pixel >> 16) & 0xFF);
+						float g = (float)((pixel >> 8) & 0xFF);
+						float b = (float)(pixel & 0xFF);
+						if (a > 0.0f && a < 255.0f)
+						{
+							// Un-premultiply
+							r = r * 255.0f / a;
+							g = g * 255.0f / a;
+							b = b * 255.0f / a;
+						}
+						r /= 255.0f;
+						g /= 255.0f;
+						b /= 255.0f;
+
+						float luma = (65.481f * r) + (128.553f * g) + (24.966f * b) + 16.0f;
+						yChannel[(size_t)(height - 1 - srcY) * width + x] = (uint8)glm::clamp(luma, 0.0f, 255.0f);
+
+						blockColor.r += r;
+						blockColor.g += g;
+						blockColor.b += b;
+						blockColor.a += 1.0f;
+					}
+
+					if ((x & 1) == 1 || x == width - 1)
+					{
+						float r = blockColor.r / blockColor.a;
+						float g = blockColor.g / blockColor.a;
+						float b = blockColor.b / blockColor.a;
+						float u = (-37.797f * r) - (74.203f * g) + (112.0f * b) + 128.0f;
+						float v = (112.0f * r) - (93.786f * g) - (18.214f * b) + 128.0f;
+
+						int uvX = x / 2;
+						int uvY = (height / 2) - 1 - (y / 2);
+						if (uvX < width / 2 && uvY >= 0)
+						{
+							size_t uvIndex = (size_t)uvY * (size_t)(width / 2) + (size_t)uvX;
+							uChannel[uvIndex] = (uint8)glm::clamp(u, 0.0f, 255.0f);
+							vChannel[uvIndex] = (uint8)glm::clamp(v, 0.0f, 255.0f);
+						}
+
+						blockColor = Vec4{ 0, 0, 0, 0 };
+					}
+				}
+			}
+		}
+
+		// ----------- Internal functions -----------
+		static bool projectPoint(const glm::mat4& mvp, const Vec2& framebufferSize, const Vec3& point, Vec2* out, float* outDepth)
+		{
+			glm::vec4 clip = mvp * glm::vec4(point.x, point.y, point.z, 1.0f);
+			if (clip.w <= MIN_CLIP_W)
+			{
+				return false;
+			}
+
+			float ndcX = clip.x / clip.w;
+			float ndcY = clip.y / clip.w;
+			out->x = (ndcX * 0.5f + 0.5f) * framebufferSize.x;
+			// Pixel rows go top to bottom
+			out->y = (0.5f - ndcY * 0.5f) * framebufferSize.y;
+			if (outDepth)
+			{
+				*outDepth = clip.z / clip.w;
+			}
+
+			return true;
+		}
+
+		static Vec2 svgToLocal(const SvgObject* svg, const Vec2& svgPoint)
+		{
+			// Same mapping Svg::renderOutline2D uses, svgs are centered around their object's origin
+			Vec2 inXRange = Vec2{ svg->bbox.min.x, svg->bbox.max.x };
+			Vec2 inYRange = Vec2{ svg->bbox.min.y, svg->bbox.max.y };
+			Vec2 outXRange = Vec2{ -svg->size.x / 2.0f, svg->size.x / 2.0f };
+			Vec2 outYRange = Vec2{ svg->size.y / 2.0f, -svg->size.y / 2.0f };
+
+			return Vec2{
+				CMath::mapRange(inXRange, outXRange, svgPoint.x),
+				CMath::mapRange(inYRange, outYRange, svgPoint.y)
+			};
+		}
+
+		static void beginCommand(SoftwareDrawCommand& command, SoftwareDrawType type)
+		{
+			command = {};
+			command.type = type;
+			command.verbStart = frame.verbs.size();
+			command.pointStart = frame.points.size();
+			command.minY = FLT_MAX;
+			command.maxY = -FLT_MAX;
+		}
+
+		static bool pushVerb(SoftwareDrawCommand& command, const glm::mat4& mvp, const Vec2& framebufferSize, const SvgObject* svg, SoftwarePathVerb verb, const Vec2* svgPoints, int numPoints)
+		{
+			for (int i = 0; i < numPoints; i++)
+			{
+				Vec2 local = svgToLocal(svg, svgPoints[i]);
+				Vec2 pixel;
+				if (!projectPoint(mvp, framebufferSize, Vec3{ local.x, local.y, 0.0f }, &pixel))
+				{
+					return false;
+				}
+
+				frame.points.push_back(pixel);
+				command.minY = glm::min(command.minY, pixel.y);
+				command.maxY = glm::max(command.maxY, pixel.y);
+			}
+
+			frame.verbs.push_back(verb);
+			return true;
+		}
+
+		static bool pushCurve(SoftwareDrawCommand& command, const glm::mat4& mvp, const Vec2& framebufferSize, const SvgObject* svg, const Curve& curve)
+		{
+			switch (curve.type)
+			{
+			case CurveType::Bezier3:
+			{
+				Vec2 points[] = { curve.as.bezier3.p1, curve.as.bezier3.p2, curve.as.bezier3.p3 };
+				return pushVerb(command, mvp, framebufferSize, svg, SoftwarePathVerb::CubicTo, points, 3);
+			}
+			case CurveType::Bezier2:
+			{
+				Vec2 points[] = { curve.as.bezier2.p1, curve.as.bezier2.p2 };
+				return pushVerb(command, mvp, framebufferSize, svg, SoftwarePathVerb::QuadTo, points, 2);
+			}
+			case CurveType::Line:
+				return pushVerb(command, mvp, framebufferSize, svg, SoftwarePathVerb::LineTo, &curve.as.line.p1, 1);
+			case CurveType::None:
+				break;
+			}
+
+			return true;
+		}
+
+		static void endCommand(SoftwareDrawCommand& command, bool isValid)
+		{
+			command.numVerbs = frame.verbs.size() - command.verbStart;
+			if (!isValid || command.numVerbs == 0)
+			{
+				// Part of the path couldn't be projected, throw away the whole command
+				frame.verbs.resize(command.verbStart);
+				frame.points.resize(command.pointStart);
+				return;
+			}
+
+			frame.commands.push_back(command);
+		}
+
+		static void collectSvgObject(const AnimObject& obj, const glm::mat4& viewProjection, const Camera& camera, const Vec2& framebufferSize)
+		{
+			const SvgObject* svg = obj.svgObject;
+			if (svg == nullptr || svg->numPaths <= 0)
+			{
+				return;
+			}
+
+			glm::mat4 mvp = viewProjection * obj.globalTransform;
+			Vec2 origin;
+			float depth;
+			if (!projectPoint(mvp, framebufferSize, Vec3{ 0.0f, 0.0f, 0.0f }, &origin, &depth))
+			{
+				return;
+			}
+
+			// Fill, mirrors what the svg cache rasterizes for this object
+			if (obj.fillColor.a > 0)
+			{
+				SoftwareDrawCommand command;
+				beginCommand(command, SoftwareDrawType::Fill);
+				command.color = Vec4{
+					(float)obj.fillColor.r / 255.0f,
+					(float)obj.fillColor.g / 255.0f,
+					(float)obj.fillColor.b / 255.0f,
+					(float)obj.fillColor.a / 255.0f
+				};
+				command.fillType = svg->fillType;
+				command.depth = depth;
+
+				bool isValid = true;
+				for (int pathi = 0; pathi < svg->numPaths && isValid; pathi++)
+				{
+					const Path& path = svg->paths[pathi];
+					if (path.numCurves <= 0)
+					{
+						continue;
+					}
+
+					isValid = pushVerb(command, mvp, framebufferSize, svg, SoftwarePathVerb::MoveTo, &path.curves[0].p0, 1);
+					for (int curvei = 0; curvei < path.numCurves && isValid; curvei++)
+					{
+						isValid = pushCurve(command, mvp, framebufferSize, svg, path.curves[curvei]);
+					}
+				}
+
+				endCommand(command, isValid);
+			}
+
+			// Outline, mirrors Svg::renderOutline2D
+			if ((obj.strokeWidth > 0.0f || obj.percentCreated < 1.0f) && obj.strokeColor.a > 0)
+			{
+				float worldStrokeWidth = glm::epsilonEqual(obj.strokeWidth, 0.0f, 0.01f)
+					? DEFAULT_STROKE_WIDTH
+					: obj.strokeWidth;
+				Vec2 strokeEnd;
+				if (!projectPoint(viewProjection, framebufferSize, obj.globalPosition + camera.right * worldStrokeWidth, &strokeEnd))
+				{
+					return;
+				}
+				Vec2 strokeStart;
+				if (!projectPoint(viewProjection, framebufferSize, obj.globalPosition, &strokeStart))
+				{
+					return;
+				}
+
+				float lengthToDraw = obj.percentCreated * svg->approximatePerimeter;
+				if (lengthToDraw <= 0.0f)
+				{
+					return;
+				}
+
+				SoftwareDrawCommand command;
+				beginCommand(command, SoftwareDrawType::Stroke);
+				command.color = Vec4{
+					(float)obj.strokeColor.r / 255.0f,
+					(float)obj.strokeColor.g / 255.0f,
+					(float)obj.strokeColor.b / 255.0f,
+					(float)obj.strokeColor.a / 255.0f
+				};
+				command.strokeWidth = CMath::length(strokeEnd - strokeStart);
+				command.depth = depth;
+
+				bool isValid = true;
+				float lengthDrawn = 0.0f;
+				for (int pathi = 0; pathi < svg->numPaths && isValid && lengthDrawn < lengthToDraw; pathi++)
+				{
+					const Path& path = svg->paths[pathi];
+					if (path.numCurves <= 0)
+					{
+						continue;
+					}
+
+					isValid = pushVerb(command, mvp, framebufferSize, svg, SoftwarePathVerb::MoveTo, &path.curves[0].p0, 1);
+					for (int curvei = 0; curvei < path.numCurves && isValid; curvei++)
+					{
+						float lengthLeft = lengthToDraw - lengthDrawn;
+						if (lengthLeft <= 0.0f)
+						{
+							break;
+						}
+
+						const Curve& curve = path.curves[curvei];
+						float curveLength = curve.calculateApproximatePerimeter();
+						lengthDrawn += curveLength;
+						if (curveLength > 0.0f && lengthLeft < curveLength)
+						{
+							isValid = pushCurve(command, mvp, framebufferSize, svg, curve.split(0.0f, lengthLeft / curveLength));
+						}
+						else
+						{
+							isValid = pushCurve(command, mvp, framebufferSize, svg, curve);
+						}
+					}
+				}
+
+				// Strokes bleed past the path by half their width
+				command.minY -= command.strokeWidth;
+				command.maxY += command.strokeWidth;
+				endCommand(command, isValid);
+			}
+		}
+
+		static void collectImageObject(const AnimationManagerData* am, const AnimObject& obj, const glm::mat4& viewProjection, const Vec2& framebufferSize)
+		{
+			const AnimObject* parent = AnimationManager::getObject(am, obj.parentId);
+			if (!parent || parent->as.image.imageFilepath == nullptr || obj.fillColor.a == 0)
+			{
+				return;
+			}
+
+			plutovg_surface_t* image = getOrLoadImage(parent->as.image.imageFilepath);
+			if (!image)
+			{
+				return;
+			}
+
+			glm::mat4 mvp = viewProjection * obj.globalTransform;
+			Vec2 halfSize = Vec2{ parent->as.image.size.x / 2.0f, parent->as.image.size.y / 2.0f };
+			Vec2 topLeft, topRight, bottomLeft, bottomRight, center;
+			float depth;
+			if (!projectPoint(mvp, framebufferSize, Vec3{ -halfSize.x, halfSize.y, 0.0f }, &topLeft) ||
+				!projectPoint(mvp, framebufferSize, Vec3{ halfSize.x, halfSize.y, 0.0f }, &topRight) ||
+				!projectPoint(mvp, framebufferSize, Vec3{ -halfSize.x, -halfSize.y, 0.0f }, &bottomLeft) ||
+				!projectPoint(mvp, framebufferSize, Vec3{ halfSize.x, -halfSize.y, 0.0f }, &bottomRight) ||
+				!projectPoint(mvp, framebufferSize, Vec3{ 0.0f, 0.0f, 0.0f }, &center, &depth))
+			{
+				return;
+			}
+
+			SoftwareDrawCommand command;
+			beginCommand(command, SoftwareDrawType::Image);
+			command.image = image;
+			// NOTE: plutovg can't tint textures, so only the alpha of the image's color is respected
+			command.color = Vec4{ 1.0f, 1.0f, 1.0f, (float)obj.fillColor.a / 255.0f };
+			command.depth = depth;
+			command.minY = glm::min(glm::min(topLeft.y, topRight.y), glm::min(bottomLeft.y, bottomRight.y));
+			command.maxY = glm::max(glm::max(topLeft.y, topRight.y), glm::max(bottomLeft.y, bottomRight.y));
+
+			// Affine map from image pixels to framebuffer pixels. This is exact for orthographic
+			// cameras and an approximation for images viewed at an angle in perspective.
+			float imageWidth = (float)plutovg_surface_get_width(image);
+			float imageHeight = (float)plutovg_surface_get_height(image);
+			plutovg_matrix_init(
+				&command.imageMatrix,
+				(topRight.x - topLeft.x) / imageWidth,
+				(topRight.y - topLeft.y) / imageWidth,
+				(bottomLeft.x - topLeft.x) / imageHeight,
+				(bottomLeft.y - topLeft.y) / imageHeight,
+				topLeft.x,
+				topLeft.y
+			);
+
+			frame.commands.push_back(command);
+		}
+
+		static plutovg_surface_t* getOrLoadImage(const char* filepath)
+		{
+			auto iter = imageCache.find(filepath);
+			if (iter != imageCache.end())
+			{
+				return iter->second;
+			}
+
+			int width, height, channels;
+			uint8* pixels = stbi_load(filepath, &width, &height, &channels, 4);
+			if (!pixels)
+			{
+				g_logger_warning("Software renderer failed to load image '{}'. Reason: {}", filepath, stbi_failure_reason());
+				// Cache the failure so we only warn once
+				imageCache[filepath] = nullptr;
+				return nullptr;
+			}
+
+			plutovg_surface_t* surface = plutovg_surface_create(width, height);
+			uint8* surfacePixels = plutovg_surface_get_data(surface);
+			int surfaceStride = plutovg_surface_get_stride(surface);
+			for (int y = 0; y < height; y++)
+			{
+				uint32* dst = (uint32*)(surfacePixels + (size_t)y * surfaceStride);
+				for (int x = 0; x < width; x++)
+				{
+					const uint8* src = pixels + ((size_t)y * width + x) * 4;
+					uint32 a = src[3];
+					uint32 r = (src[0] * a) / 255;
+					uint32 g = (src[1] * a) / 255;
+					uint32 b = (src[2] * a) / 255;
+					dst[x] = (a << 24) | (r << 16) | (g << 8) | b;
+				}
+			}
+			stbi_image_free(pixels);
+
+			imageCache[filepath] = surface;
+			return surface;
+		}
+
+		static uint32 packPremultipliedArgb(const Vec4& color)
+		{
+			float a = glm::clamp(color.a, 0.0f, 1.0f);
+			uint32 a8 = (uint32)(a * 255.0f);
+			uint32 r8 = (uint32)(glm::clamp(color.r, 0.0f, 1.0f) * a * 255.0f);
+			uint32 g8 = (uint32)(glm::clamp(color.g, 0.0f, 1.0f) * a * 255.0f);
+			uint32 b8 = (uint32)(glm::clamp(color.b, 0.0f, 1.0f) * a * 255.0f);
+			return (a8 << 24) | (r8 << 16) | (g8 << 8) | b8;
+		}
+
+		static void replayCommand(plutovg_t* pluto, const SoftwareFrame& drawList, const SoftwareDrawCommand& command, float yOffset)
+		{
+			if (command.type == SoftwareDrawType::Image)
+			{
+				plutovg_matrix_t matrix = command.imageMatrix;
+				matrix.m12 -= yOffset;
+
+				plutovg_save(pluto);
+				plutovg_set_matrix(pluto, &matrix);
+				plutovg_set_source_surface(pluto, command.image, 0.0, 0.0);
+				plutovg_set_opacity(pluto, command.color.a);
+				plutovg_rect(pluto, 0.0, 0.0, plutovg_surface_get_width(command.image), plutovg_surface_get_height(command.image));
+				plutovg_fill(pluto);
+				plutovg_restore(pluto);
+				return;
+			}
+
+			plutovg_new_path(pluto);
+			const Vec2* points = drawList.points.data() + command.pointStart;
+			for (size_t i = command.verbStart; i < command.verbStart + command.numVerbs; i++)
+			{
+				switch (drawList.verbs[i])
+				{
+				case SoftwarePathVerb::MoveTo:
+					plutovg_move_to(pluto, points[0].x, points[0].y - yOffset);
+					points += 1;
+					break;
+				case SoftwarePathVerb::LineTo:
+					plutovg_line_to(pluto, points[0].x, points[0].y - yOffset);
+					points += 1;
+					break;
+				case SoftwarePathVerb::QuadTo:
+					plutovg_quad_to(pluto,
+						points[0].x, points[0].y - yOffset,
+						points[1].x, points[1].y - yOffset
+					);
+					points += 2;
+					break;
+				case SoftwarePathVerb::CubicTo:
+					plutovg_cubic_to(pluto,
+						points[0].x, points[0].y - yOffset,
+						points[1].x, points[1].y - yOffset,
+						points[2].x, points[2].y - yOffset
+					);
+					points += 3;
+					break;
+				}
+			}
+
+			plutovg_set_rgba(pluto, command.color.r, command.color.g, command.color.b, command.color.a);
+			if (command.type == SoftwareDrawType::Fill)
+			{
+				plutovg_close_path(pluto);
+				plutovg_set_fill_rule(pluto, command.fillType == FillType::EvenOddFillType
+					? plutovg_fill_rule_even_odd
+					: plutovg_fill_rule_non_zero
+				);
+				plutovg_fill(pluto);
+			}
+			else
+			{
+				plutovg_set_line_width(pluto, command.strokeWidth);
+				plutovg_stroke(pluto);
+			}
+		}
+
+		static void renderTile(const SoftwareTileData& tile)
+		{
+			MP_PROFILE_EVENT("SoftwareRenderer_RenderTile");
+			SoftwareFramebuffer* framebuffer = tile.framebuffer;
+			int tileHeight = tile.yEnd - tile.yStart;
+
+			for (int y = tile.yStart; y < tile.yEnd; y++)
+			{
+				uint32* row = (uint32*)(framebuffer->pixels + (size_t)y * framebuffer->stride);
+				std::fill(row, row + framebuffer->width, tile.clearColor);
+			}
+
+			// Each tile wraps its own rows of the framebuffer, so tiles never touch the same pixels
+			plutovg_surface_t* surface = plutovg_surface_create_for_data(
+				framebuffer->pixels + (size_t)tile.yStart * framebuffer->stride,
+				framebuffer->width,
+				tileHeight,
+				framebuffer->stride
+			);
+			plutovg_t* pluto = plutovg_create(surface);
+
+			float yStart = (float)tile.yStart;
+			float yEnd = (float)tile.yEnd;
+			for (const SoftwareDrawCommand& command : tile.frame->commands)
+			{
+				if (command.maxY < yStart || command.minY > yEnd)
+				{
+					continue;
+				}
+
+				replayCommand(pluto, *tile.frame, command, yStart);
+			}
+
+			plutovg_destroy(pluto);
+			plutovg_surface_destroy(surface);
+		}
+	}
+}
@@ -0,0 +1,156 @@
+#include "renderer/StreamBuffer.h"
+#include "renderer/GLApi.h"
+#include "core/Profiling.h"
+
+namespace MathAnim
+{
+	// Buffers only get touched through this binding point. Binding them to GL_ELEMENT_ARRAY_BUFFER
+	// here would overwrite the index buffer of whatever VAO happens to be bound.
+	static constexpr GLenum streamBufferTarget = GL_COPY_WRITE_BUFFER;
+
+	void StreamBuffer::create(size_t initialRegionSize, uint8 numRegions)
+	{
+		g_logger_assert(id == UINT32_MAX, "Tried to create StreamBuffer twice.");
+		g_logger_assert(numRegions > 0 && numRegions <= maxNumRegions, "StreamBuffer supports between 1 and {} regions, got {}.", maxNumRegions, numRegions);
+
+		this->numRegions = numRegions;
+		this->currentRegion = 0;
+		this->isPersistent = GL::supportsPersistentMapping();
+		for (uint8 i = 0; i < maxNumRegions; i++)
+		{
+			fences[i] = nullptr;
+		}
+
+		allocate(glm::max(initialRegionSize, (size_t)1));
+	}
+
+	void StreamBuffer::free()
+	{
+		for (uint8 i = 0; i < numRegions; i++)
+		{
+			if (fences[i])
+			{
+				GL::deleteSync(fences[i]);
+				fences[i] = nullptr;
+			}
+		}
+
+		if (id != UINT32_MAX)
+		{
+			if (mappedData)
+			{
+				GL::bindBuffer(streamBufferTarget, id);
+				GL::unmapBuffer(streamBufferTarget);
+			}
+
+			GL::deleteBuffers(1, &id);
+		}
+
+		id = UINT32_MAX;
+		mappedData = nullptr;
+		regionSize = 0;
+	}
+
+	size_t StreamBuffer::upload(const void* data, size_t size)
+	{
+		MP_PROFILE_EVENT("StreamBuffer_Upload");
+
+		if (size > regionSize)
+		{
+			// Wait for the GPU to finish with every region before throwing the old buffer away
+			for (uint8 i = 0; i < numRegions; i++)
+			{
+				waitForRegion(i);
+			}
+
+			allocate(glm::max(size, regionSize * 2));
+			currentRegion = 0;
+		}
+
+		size_t offset = (size_t)currentRegion * regionSize;
+		if (isPersistent)
+		{
+			waitForRegion(currentRegion);
+			g_memory_copyMem(mappedData + offset, size, (void*)data, size);
+		}
+		else
+		{
+			// Orphan the old storage so the driver doesn't stall on draws still reading it
+			offset = 0;
+			GL::bindBuffer(streamBufferTarget, id);
+			GL::bufferData(streamBufferTarget, regionSize, nullptr, GL_STREAM_DRAW);
+			GL::bufferSubData(streamBufferTarget, 0, size, data);
+		}
+
+		return offset;
+	}
+
+	void StreamBuffer::fence()
+	{
+		if (isPersistent)
+		{
+			if (fences[currentRegion])
+			{
+				GL::deleteSync(fences[currentRegion]);
+			}
+			fences[currentRegion] = GL::fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		currentRegion = (currentRegion + 1) % numRegions;
+	}
+
+	// ------------------ Internal functions ------------------
+	void StreamBuffer::allocate(size_t newRegionSize)
+	{
+		uint8 regions = numRegions;
+		free();
+		numRegions = regions;
+		regionSize = newRegionSize;
+
+		GL::genBuffers(1, &id);
+		GL::bindBuffer(streamBufferTarget, id);
+		if (isPersistent)
+		{
+			constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			GL::bufferStorage(streamBufferTarget, regionSize * numRegions, nullptr, flags);
+			mappedData = (uint8*)GL::mapBufferRange(streamBufferTarget, 0, regionSize * numRegions, flags);
+			g_logger_assert(mappedData != nullptr, "Failed to persistently map stream buffer of size {}.", regionSize * numRegions);
+		}
+		else
+		{
+			GL::bufferData(streamBufferTarget, regionSize, nullptr, GL_STREAM_DRAW);
+		}
+		GL::bindBuffer(streamBufferTarget, 0);
+	}
+
+	void StreamBuffer::waitForRegion(uint8 region)
+	{
+		if (!fences[region])
+		{
+			return;
+		}
+
+		// Flush on the first wait so the fence is guaranteed to signal eventually
+		GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while (true)
+		{
+			constexpr GLuint64 oneSecondInNs = 1'000'000'000;
+			GLenum result = GL::clientWaitSync(fences[region], waitFlags, oneSecondInNs);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+			{
+				break;
+			}
+
+			if (result == GL_WAIT_FAILED)
+			{
+				g_logger_error("Failed to wait for stream buffer fence.");
+				break;
+			}
+
+			waitFlags = 0;
+		}
+
+		GL::deleteSync(fences[region]);
+		fences[region] = nullptr;
+	}
+}
@@ -121,10 +121,9 @@ extern "C"
 		lua_pop(L, 1);
 
 		AnimObject newObject = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::SvgObject, id, true);
-		newObject._svgObjectStart = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-		newObject.svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-		(*newObject._svgObjectStart) = Svg::createDefault();
-		(*newObject.svgObject) = Svg::createDefault();
+		SvgObject* svg = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+		(*svg) = Svg::createDefault();
+		newObject.setSvgObjectStart(svg);
 		ScriptApi::pushAnimObject(L, newObject);
 
 		// Add the animation object to the scene
@@ -288,10 +287,9 @@ extern "C"
 			AnimObject* obj = AnimationManager::getMutableObject(am, objId);
 			if (obj)
 			{
-				obj->_svgObjectStart = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-				(*obj->_svgObjectStart) = Svg::createDefault();
-				obj->svgObject = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-				(*obj->svgObject) = Svg::createDefault();
+				SvgObject* svg = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+				(*svg) = Svg::createDefault();
+				obj->setSvgObjectStart(svg);
 			}
 			else
 			{
@@ -302,6 +300,19 @@ extern "C"
 			lua_pushlightuserdata(L, (void*)svgPtr);
 			lua_setfield(L, 1, "ptr");
 		}
+		else if (Svg::isShared(svgPtr))
+		{
+			// Other objects are using this svg too, so draw into a copy that belongs to this object
+			lua_getfield(L, 1, "objId");
+			AnimObjId objId = toU64(L, -1);
+			AnimObject* obj = AnimationManager::getMutableObject(am, objId);
+			if (obj && obj->_svgObjectStart == svgPtr)
+			{
+				svgPtr = obj->getMutableSvgObjectStart();
+				lua_pushlightuserdata(L, (void*)svgPtr);
+				lua_setfield(L, 1, "ptr");
+			}
+		}
 
 		// Second argument is vec2
 		Vec2 startPos = toVec2(L, 2);
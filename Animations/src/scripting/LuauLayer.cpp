@@ -2,10 +2,12 @@
 #include "scripting/LuauLayer.h"
 #include "scripting/GlobalApi.h"
 #include "scripting/ScriptAnalyzer.h"
+#include "scripting/MathAnimGlobals.h"
 #include "platform/Platform.h"
 #include "animation/Animation.h"
 #include "animation/AnimationManager.h"
 #include "editor/panels/ConsoleLog.h"
+#include "core/Profiling.h"
 
 #pragma warning( push )
 #pragma warning( disable : 4100 )
@@ -14,8 +16,11 @@
 #include <lua.h>
 #include <lualib.h>
 #include <luacode.h>
+#include <luacodegen.h>
 #pragma warning ( pop )
 
+#include <functional>
+
 namespace MathAnim
 {
 	struct Bytecode
@@ -23,6 +28,27 @@ namespace MathAnim
 		std::string scriptFilepath;
 		char* bytes;
 		size_t size;
+		uint32 numExecutions;
+		// Registry ref to the natively compiled main function, LUA_NOREF until the script gets hot
+		int nativeFunctionRef;
+	};
+
+	// Written at the start of every file in the bytecode cache
+	struct BytecodeCacheHeader
+	{
+		uint32 magic;
+		uint32 version;
+		uint64 sourceHash;
+		uint64 numDependencies;
+		uint64 bytecodeSize;
+	};
+
+	// Written after the header for every module the script required, followed by the bytecode.
+	// The module's name (nameLength bytes) comes right after this
+	struct BytecodeCacheDependency
+	{
+		uint64 sourceHash;
+		uint64 nameLength;
 	};
 
 	struct ParsedError
@@ -37,21 +63,62 @@ namespace MathAnim
 		// ---------- Internal Functions ----------
 		static void* luaAllocWrapper(void* ud, void* ptr, size_t osize, size_t nsize);
 		static ParsedError parseError(const char* luaRuntimeErrorMessage);
+		static bool compileScript(const std::string& scriptName, const std::string& scriptFilepath, const char* source, size_t sourceLength, const std::function<bool()>& analyze);
+		static bool tryLoadBytecode(const std::string& scriptName, const char* bytes, size_t size);
+		static void storeBytecode(const std::string& scriptName, const std::string& scriptFilepath, char* bytes, size_t size);
+		static void releaseBytecode(Bytecode& bytecode);
+		static int pushScriptFunction(const std::string& scriptName, Bytecode& bytecode);
+		static int getOptimizationLevel();
+		static uint64 hashBytes(uint64 hash, const char* bytes, size_t size);
+		static uint64 hashScriptSource(const char* source, size_t sourceLength, int optimizationLevel);
+		static bool hashModuleSource(const std::string& moduleName, uint64* outHash);
+		static std::filesystem::path getBytecodeCachePath(const std::string& scriptName);
+		static char* readCachedBytecode(const std::string& scriptName, uint64 sourceHash, size_t* outSize);
+		static void writeCachedBytecode(const std::string& scriptName, uint64 sourceHash, const std::vector<std::string>& dependencies, const char* bytes, size_t size);
+		static void deleteStaleCacheFiles();
 
 		// ---------- Internal Variables ----------
+		// Bump whenever the compile options or the cache file layout change
+		static constexpr uint32 bytecodeCacheVersion = 3;
+		static constexpr uint32 bytecodeCacheMagic = 0x4342414D; // "MABC"
+		static constexpr int debugLevel = 1;
+		// Scripts that only run once (like the ones run when a project is opened) aren't worth the time it
+		// takes to generate native code for them
+		static constexpr uint32 hotScriptExecutionCount = 2;
+
 		ScriptAnalyzer* analyzer = nullptr;
 		lua_State* luaState = nullptr;
 		std::unordered_map<std::string, Bytecode> cachedBytecode;
 		std::filesystem::path scriptDirectory = "";
+		std::filesystem::path bytecodeCacheDirectory = "";
+		// Analysis results depend on the builtin definitions too, and those change with the app
+		uint64 builtinDefinitionsHash = 0;
 		const Bytecode* currentExecutingScript = nullptr;
+		bool nativeCodeGenEnabled = false;
+		bool nativeCodeGenCreated = false;
 
-		void init(const std::filesystem::path& inScriptDirectory, AnimationManagerData* am)
+		void init(const std::filesystem::path& inScriptDirectory, const std::filesystem::path& inBytecodeCacheDirectory, AnimationManagerData* am)
 		{
 			Platform::createDirIfNotExists(inScriptDirectory.string().c_str());
 
+			std::error_code error;
+			std::filesystem::create_directories(inBytecodeCacheDirectory, error);
+			if (error)
+			{
+				g_logger_warning("Could not create script bytecode cache directory '{}': {}", inBytecodeCacheDirectory.string(), error.message());
+			}
+
 			luaState = lua_newstate(luaAllocWrapper, NULL);
 			ScriptApi::registerGlobalFunctions(luaState, am);
 			scriptDirectory = inScriptDirectory;
+			bytecodeCacheDirectory = inBytecodeCacheDirectory;
+			deleteStaleCacheFiles();
+
+			constexpr uint64 fnvOffsetBasis = 0xcbf29ce484222325ULL;
+			std::string_view definitions = MathAnimGlobals::getBuiltinDefinitionSource();
+			std::string_view apiTypes = MathAnimGlobals::getMathAnimApiTypes();
+			builtinDefinitionsHash = hashBytes(fnvOffsetBasis, definitions.data(), definitions.size());
+			builtinDefinitionsHash = hashBytes(builtinDefinitionsHash, apiTypes.data(), apiTypes.size());
 
 			analyzer = g_memory_new ScriptAnalyzer(inScriptDirectory);
 		}
@@ -63,18 +130,6 @@ namespace MathAnim
 
 		bool compile(const std::string& filename)
 		{
-			if (!analyzer->analyze(filename))
-			{
-				// If the bytecode exists, free the bytes since the most recent code is broken
-				auto iter = cachedBytecode.find(filename);
-				if (iter != cachedBytecode.end())
-				{
-					::free(iter->second.bytes);
-					cachedBytecode.erase(iter);
-				}
-				return false;
-			}
-
 			std::string scriptPath = (scriptDirectory / filename).make_preferred().lexically_normal().string();
 			FILE* fp = fopen(scriptPath.c_str(), "rb");
 			if (!fp)
@@ -93,81 +148,34 @@ namespace MathAnim
 			memory.data[fileSize] = '\0';
 			fclose(fp);
 
-			lua_CompileOptions compileOptions = {};
-			compileOptions.optimizationLevel = 1;
-			compileOptions.debugLevel = 1;
-			size_t bytecodeSize = 0;
-			char* bytecode = luau_compile((const char*)memory.data, memory.size, &compileOptions, &bytecodeSize);
-			int result = luau_load(luaState, filename.c_str(), bytecode, bytecodeSize, 0);
-
-			memory.free();
-
-			// Pop the bytecode off the stack
-			lua_pop(luaState, 1);
-
-			if (result != 0)
-			{
-				::free(bytecode);
-				return false;
-			}
-
-			{
-				// If the bytecode exists, free the bytes since it's about to be
-				// replaced
-				auto iter = cachedBytecode.find(filename);
-				if (iter != cachedBytecode.end())
+			bool res = compileScript(filename, scriptPath, (const char*)memory.data, fileSize, [&]()
 				{
-					::free(iter->second.bytes);
-				}
-			}
+					if (analyzer->analyze(filename))
+					{
+						return true;
+					}
 
-			Bytecode res;
-			res.bytes = bytecode;
-			res.size = bytecodeSize;
-			res.scriptFilepath = scriptPath;
-			cachedBytecode[filename] = res;
+					// If the bytecode exists, free the bytes since the most recent code is broken
+					auto iter = cachedBytecode.find(filename);
+					if (iter != cachedBytecode.end())
+					{
+						releaseBytecode(iter->second);
+						cachedBytecode.erase(iter);
+					}
+					return false;
+				});
 
-			return true;
+			memory.free();
+
+			return res;
 		}
 
 		bool compile(const std::string& sourceCode, const std::string& scriptName)
 		{
-			if (!analyzer->analyze(sourceCode, scriptName))
-			{
-				return false;
-			}
-
-			lua_CompileOptions compileOptions = {};
-			compileOptions.optimizationLevel = 1;
-			compileOptions.debugLevel = 1;
-			size_t bytecodeSize = 0;
-			char* bytecode = luau_compile(sourceCode.c_str(), sourceCode.length(), &compileOptions, &bytecodeSize);
-			int result = luau_load(luaState, scriptName.c_str(), bytecode, bytecodeSize, 0);
-
-			// Pop the bytecode off the stack
-			lua_pop(luaState, 1);
-
-			if (result != 0)
-			{
-				::free(bytecode);
-				return false;
-			}
-
-			// If the bytecode exists, free the bytes since it's about to be
-			// replaced
-			auto iter = cachedBytecode.find(scriptName);
-			if (iter != cachedBytecode.end())
-			{
-				::free(iter->second.bytes);
-			}
-
-			Bytecode res;
-			res.bytes = bytecode;
-			res.size = bytecodeSize;
-			res.scriptFilepath = scriptName;
-			cachedBytecode[scriptName] = res;
-
-			return true;
+			return compileScript(scriptName, scriptName, sourceCode.c_str(), sourceCode.length(), [&]()
+				{
+					return analyzer->analyze(sourceCode, scriptName);
+				});
 		}
 
 		const std::string& getCurrentExecutingScriptFilepath()
@@ -190,9 +198,9 @@ namespace MathAnim
 				return false;
 			}
 
-			const Bytecode& bytecode = iter->second;
+			Bytecode& bytecode = iter->second;
 			currentExecutingScript = &bytecode;
-			int result = luau_load(luaState, filename.c_str(), bytecode.bytes, bytecode.size, 0);
+			int result = pushScriptFunction(filename, bytecode);
 
 			if (result == 0)
 			{
@@ -230,9 +238,9 @@ namespace MathAnim
 				return false;
 			}
 
-			const Bytecode& bytecode = iter->second;
+			Bytecode& bytecode = iter->second;
 			currentExecutingScript = &bytecode;
-			int result = luau_load(luaState, filename.c_str(), bytecode.bytes, bytecode.size, 0);
+			int result = pushScriptFunction(filename, bytecode);
 
 			if (result == 0)
 			{
@@ -279,6 +287,11 @@ namespace MathAnim
 
 		bool remove(const std::string& filename)
 		{
+			// The cache file would never be read again. It may exist even if the script's latest version
+			// didn't compile, and may not exist at all, so any errors here are fine.
+			std::error_code error;
+			std::filesystem::remove(getBytecodeCachePath(filename), error);
+
 			auto iter = cachedBytecode.find(filename);
 			if (iter == cachedBytecode.end())
 			{
@@ -286,10 +299,46 @@ namespace MathAnim
 				return false;
 			}
 
+			releaseBytecode(iter->second);
 			cachedBytecode.erase(iter);
 			return true;
 		}
 
+		void setNativeCodeGenEnabled(bool enabled)
+		{
+			if (enabled && !isNativeCodeGenSupported())
+			{
+				g_logger_warning("Native script compilation is not supported on this platform.");
+				return;
+			}
+
+			if (!enabled)
+			{
+				// Drop the native functions so the next runs go back through the interpreter
+				for (auto& [scriptName, bytecode] : cachedBytecode)
+				{
+					if (bytecode.nativeFunctionRef != LUA_NOREF)
+					{
+						lua_unref(luaState, bytecode.nativeFunctionRef);
+						bytecode.nativeFunctionRef = LUA_NOREF;
+					}
+					bytecode.numExecutions = 0;
+				}
+			}
+
+			nativeCodeGenEnabled = enabled;
+		}
+
+		bool isNativeCodeGenEnabled()
+		{
+			return nativeCodeGenEnabled;
+		}
+
+		bool isNativeCodeGenSupported()
+		{
+			return luau_codegen_supported() != 0;
+		}
+
 		void free()
 		{
 			if (analyzer)
@@ -312,9 +361,329 @@ namespace MathAnim
 
 			analyzer = nullptr;
 			luaState = nullptr;
+			nativeCodeGenEnabled = false;
+			nativeCodeGenCreated = false;
 		}
 
 		// ---------- Internal Functions ----------
+		static bool compileScript(const std::string& scriptName, const std::string& scriptFilepath, const char* source, size_t sourceLength, const std::function<bool()>& analyze)
+		{
+			MP_PROFILE_EVENT("LuauLayer_CompileScript");
+
+			// A cache file is only written after the script passed analysis, and it's only read back if
+			// the script and every module it required are unchanged. So a hit skips the analysis too.
+			uint64 sourceHash = hashScriptSource(source, sourceLength, getOptimizationLevel());
+			size_t bytecodeSize = 0;
+			char* bytecode = readCachedBytecode(scriptName, sourceHash, &bytecodeSize);
+			if (bytecode)
+			{
+				if (tryLoadBytecode(scriptName, bytecode, bytecodeSize))
+				{
+					storeBytecode(scriptName, scriptFilepath, bytecode, bytecodeSize);
+					return true;
+				}
+
+				// Most likely written by a different version of Luau, compile it from scratch instead
+				// and let that overwrite the cache file
+				::free(bytecode);
+			}
+
+			if (!analyze())
+			{
+				return false;
+			}
+
+			lua_CompileOptions compileOptions = {};
+			compileOptions.optimizationLevel = getOptimizationLevel();
+			compileOptions.debugLevel = debugLevel;
+			bytecode = luau_compile(source, sourceLength, &compileOptions, &bytecodeSize);
+			if (!tryLoadBytecode(scriptName, bytecode, bytecodeSize))
+			{
+				::free(bytecode);
+				return false;
+			}
+
+			writeCachedBytecode(scriptName, sourceHash, analyzer->getRequiredModules(), bytecode, bytecodeSize);
+			storeBytecode(scriptName, scriptFilepath, bytecode, bytecodeSize);
+
+			return true;
+		}
+
+		static bool tryLoadBytecode(const std::string& scriptName, const char* bytes, size_t size)
+		{
+			int result = luau_load(luaState, scriptName.c_str(), bytes, size, 0);
+
+			// Pop the function (or the error message) off the stack
+			lua_pop(luaState, 1);
+
+			return result == 0;
+		}
+
+		static void storeBytecode(const std::string& scriptName, const std::string& scriptFilepath, char* bytes, size_t size)
+		{
+			// If the bytecode exists, free the bytes since it's about to be
+			// replaced
+			auto iter = cachedBytecode.find(scriptName);
+			if (iter != cachedBytecode.end())
+			{
+				releaseBytecode(iter->second);
+			}
+
+			Bytecode res;
+			res.bytes = bytes;
+			res.size = size;
+			res.scriptFilepath = scriptFilepath;
+			res.numExecutions = 0;
+			res.nativeFunctionRef = LUA_NOREF;
+			cachedBytecode[scriptName] = res;
+		}
+
+		static void releaseBytecode(Bytecode& bytecode)
+		{
+			if (bytecode.nativeFunctionRef != LUA_NOREF)
+			{
+				lua_unref(luaState, bytecode.nativeFunctionRef);
+				bytecode.nativeFunctionRef = LUA_NOREF;
+			}
+
+			::free(bytecode.bytes);
+			bytecode.bytes = nullptr;
+			bytecode.size = 0;
+		}
+
+		static int pushScriptFunction(const std::string& scriptName, Bytecode& bytecode)
+		{
+			bytecode.numExecutions++;
+			if (bytecode.nativeFunctionRef != LUA_NOREF)
+			{
+				lua_getref(luaState, bytecode.nativeFunctionRef);
+				return 0;
+			}
+
+			int result = luau_load(luaState, scriptName.c_str(), bytecode.bytes, bytecode.size, 0);
+			if (result == 0 && nativeCodeGenEnabled && bytecode.numExecutions >= hotScriptExecutionCount)
+			{
+				MP_PROFILE_EVENT("LuauLayer_NativeCompile");
+
+				if (!nativeCodeGenCreated)
+				{
+					luau_codegen_create(luaState);
+					nativeCodeGenCreated = true;
+				}
+
+				// Native code belongs to the function prototypes that were just loaded, so keep this
+				// closure around and reuse it instead of loading the bytecode again on every run
+				luau_codegen_compile(luaState, -1);
+				bytecode.nativeFunctionRef = lua_ref(luaState, -1);
+			}
+
+			return result;
+		}
+
+		static int getOptimizationLevel()
+		{
+			// Level 2 inlines and unrolls more aggressively, which mostly pays off in native code
+			return nativeCodeGenEnabled ? 2 : 1;
+		}
+
+		static uint64 hashBytes(uint64 hash, const char* bytes, size_t size)
+		{
+			// FNV-1a, this needs to be stable across runs and platforms since it names the cache files
+			constexpr uint64 fnvPrime = 0x100000001b3ULL;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= (uint8)bytes[i];
+				hash *= fnvPrime;
+			}
+
+			return hash;
+		}
+
+		static uint64 hashScriptSource(const char* source, size_t sourceLength, int optimizationLevel)
+		{
+			constexpr uint64 fnvOffsetBasis = 0xcbf29ce484222325ULL;
+			uint64 res = hashBytes(fnvOffsetBasis, source, sourceLength);
+
+			// The same source compiled with different options produces different bytecode
+			const uint32 options[] = { bytecodeCacheVersion, (uint32)optimizationLevel, (uint32)debugLevel };
+			res = hashBytes(res, (const char*)options, sizeof(options));
+			return hashBytes(res, (const char*)&builtinDefinitionsHash, sizeof(builtinDefinitionsHash));
+		}
+
+		static bool hashModuleSource(const std::string& moduleName, uint64* outHash)
+		{
+			constexpr uint64 fnvOffsetBasis = 0xcbf29ce484222325ULL;
+			if (moduleName == "math-anim" || moduleName == "math-anim.luau")
+			{
+				std::string_view source = MathAnimGlobals::getMathAnimModule();
+				*outHash = hashBytes(fnvOffsetBasis, source.data(), source.size());
+				return true;
+			}
+
+			std::string modulePath = (scriptDirectory / moduleName).string();
+			FILE* fp = fopen(modulePath.c_str(), "rb");
+			if (!fp)
+			{
+				return false;
+			}
+
+			fseek(fp, 0, SEEK_END);
+			size_t fileSize = ftell(fp);
+			fseek(fp, 0, SEEK_SET);
+
+			RawMemory memory;
+			memory.init(fileSize + 1);
+			bool success = fileSize == 0 || fread(memory.data, fileSize, 1, fp) == 1;
+			fclose(fp);
+
+			if (success)
+			{
+				*outHash = hashBytes(fnvOffsetBasis, (const char*)memory.data, fileSize);
+			}
+			memory.free();
+
+			return success;
+		}
+
+		static std::filesystem::path getBytecodeCachePath(const std::string& scriptName)
+		{
+			// One file per script that gets overwritten whenever the script changes, so edits
+			// don't leave old bytecode behind
+			constexpr uint64 fnvOffsetBasis = 0xcbf29ce484222325ULL;
+			uint64 nameHash = hashBytes(fnvOffsetBasis, scriptName.c_str(), scriptName.length());
+
+			char filename[32];
+			snprintf(filename, sizeof(filename), "%016llx.luauc", (unsigned long long)nameHash);
+			return bytecodeCacheDirectory / filename;
+		}
+
+		static char* readCachedBytecode(const std::string& scriptName, uint64 sourceHash, size_t* outSize)
+		{
+			std::string cachePath = getBytecodeCachePath(scriptName).string();
+			FILE* fp = fopen(cachePath.c_str(), "rb");
+			if (!fp)
+			{
+				return nullptr;
+			}
+
+			BytecodeCacheHeader header = {};
+			if (fread(&header, sizeof(BytecodeCacheHeader), 1, fp) != 1 ||
+				header.magic != bytecodeCacheMagic ||
+				header.version != bytecodeCacheVersion ||
+				header.sourceHash != sourceHash ||
+				header.bytecodeSize == 0)
+			{
+				fclose(fp);
+				return nullptr;
+			}
+
+			// A required module that changed (or went missing) can break the script even though its own
+			// source didn't change
+			std::string moduleName;
+			for (uint64 i = 0; i < header.numDependencies; i++)
+			{
+				BytecodeCacheDependency dependency = {};
+				if (fread(&dependency, sizeof(BytecodeCacheDependency), 1, fp) != 1 || dependency.nameLength == 0)
+				{
+					fclose(fp);
+					return nullptr;
+				}
+
+				moduleName.resize((size_t)dependency.nameLength);
+				uint64 currentHash = 0;
+				if (fread(moduleName.data(), (size_t)dependency.nameLength, 1, fp) != 1 ||
+					!hashModuleSource(moduleName, &currentHash) ||
+					currentHash != dependency.sourceHash)
+				{
+					fclose(fp);
+					return nullptr;
+				}
+			}
+
+			// Luau frees bytecode with ::free, so this has to come from malloc as well
+			char* bytes = (char*)::malloc((size_t)header.bytecodeSize);
+			if (fread(bytes, (size_t)header.bytecodeSize, 1, fp) != 1)
+			{
+				::free(bytes);
+				fclose(fp);
+				return nullptr;
+			}
+			fclose(fp);
+
+			*outSize = (size_t)header.bytecodeSize;
+			return bytes;
+		}
+
+		static void writeCachedBytecode(const std::string& scriptName, uint64 sourceHash, const std::vector<std::string>& dependencies, const char* bytes, size_t size)
+		{
+			std::string cachePath = getBytecodeCachePath(scriptName).string();
+			FILE* fp = fopen(cachePath.c_str(), "wb");
+			if (!fp)
+			{
+				g_logger_warning("Could not write script bytecode cache file '{}'.", cachePath);
+				return;
+			}
+
+			BytecodeCacheHeader header = {};
+			header.magic = bytecodeCacheMagic;
+			header.version = bytecodeCacheVersion;
+			header.sourceHash = sourceHash;
+			header.numDependencies = dependencies.size();
+			header.bytecodeSize = size;
+			bool success = fwrite(&header, sizeof(BytecodeCacheHeader), 1, fp) == 1;
+
+			for (size_t i = 0; success && i < dependencies.size(); i++)
+			{
+				BytecodeCacheDependency dependency = {};
+				dependency.nameLength = dependencies[i].length();
+				// The analysis just read this module, so it only fails if the file was deleted since then.
+				// Skipping the cache is fine then, the next compile will write it again
+				success = hashModuleSource(dependencies[i], &dependency.sourceHash) &&
+					fwrite(&dependency, sizeof(BytecodeCacheDependency), 1, fp) == 1 &&
+					fwrite(dependencies[i].c_str(), dependencies[i].length(), 1, fp) == 1;
+			}
+
+			success = success && fwrite(bytes, size, 1, fp) == 1;
+			fclose(fp);
+
+			if (!success)
+			{
+				// Don't leave a truncated file around, the header check would reject it but it'd never get replaced
+				Platform::deleteFile(cachePath.c_str());
+			}
+		}
+
+		static void deleteStaleCacheFiles()
+		{
+			// Files written by an older cache version will never be read again
+			std::error_code error;
+			for (const auto& entry : std::filesystem::directory_iterator(bytecodeCacheDirectory, error))
+			{
+				if (!entry.is_regular_file() || entry.path().extension() != ".luauc")
+				{
+					continue;
+				}
+
+				std::string cachePath = entry.path().string();
+				FILE* fp = fopen(cachePath.c_str(), "rb");
+				if (!fp)
+				{
+					continue;
+				}
+
+				BytecodeCacheHeader header = {};
+				bool isStale = fread(&header, sizeof(BytecodeCacheHeader), 1, fp) != 1 ||
+					header.magic != bytecodeCacheMagic ||
+					header.version != bytecodeCacheVersion;
+				fclose(fp);
+
+				if (isStale)
+				{
+					Platform::deleteFile(cachePath.c_str());
+				}
+			}
+		}
+
 		static void* luaAllocWrapper(void* ud, void* ptr, size_t osize, size_t nsize)
 		{
 			(void)ud;  (void)osize;  /* not used */
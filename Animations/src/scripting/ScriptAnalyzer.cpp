@@ -144,6 +144,7 @@ namespace MathAnim
 			reportError(frontend, scriptFilepath.c_str(), ReportFormat::Default, error);
 		}
 
+		collectRequiredModules(filename);
 		frontend->clear();
 		return cr.errors.size() == 0;
 	}
@@ -179,6 +180,7 @@ namespace MathAnim
 			reportError(frontend, scriptName.c_str(), ReportFormat::Default, error);
 		}
 
+		collectRequiredModules(scriptName);
 		frontend->clear();
 		return cr.errors.size() == 0;
 	}
@@ -193,6 +195,20 @@ namespace MathAnim
 		configResolver = nullptr;
 		frontend = nullptr;
 	}
+
+	void ScriptAnalyzer::collectRequiredModules(const std::string& scriptName)
+	{
+		// The frontend gets cleared after every analysis, so its source nodes are exactly the
+		// modules this script pulled in
+		requiredModules.clear();
+		for (const auto& [moduleName, sourceNode] : frontend->sourceNodes)
+		{
+			if (moduleName != scriptName)
+			{
+				requiredModules.push_back(moduleName);
+			}
+		}
+	}
 }
 
 // ------------------------------- File Resolver -------------------------------
@@ -27,9 +27,16 @@ namespace MathAnim
 	{
 		// ----------------- Private Variables -----------------
 		constexpr int initialMaxCapacity = 5;
+		// Reference counts of shared objects. Anything that isn't in here has exactly one owner.
+		static std::unordered_map<const SvgObject*, uint32> sharedRefCounts = {};
+		static std::mutex sharedRefCountsMtx;
 
 		// ----------------- Internal functions -----------------
 		static void checkResize(Path& path);
+		static void resizePaths(SvgObject* object, int numPaths);
+		static void getBezier3ControlPoints(const Curve& curve, Vec2* outP1P2P3);
+		static uint64 hashMd5(const SvgObject* object);
+		static std::string getMd5String(const SvgObject* object);
 
 		SvgObject createDefault()
 		{
@@ -531,33 +538,7 @@ namespace MathAnim
 
 		void copy(SvgObject* dest, const SvgObject* src)
 		{
-			if (dest->numPaths != src->numPaths)
-			{
-				// Free any extra paths the destination has
-				// If the destination has less, this loop doesn't run
-				for (int contouri = src->numPaths; contouri < dest->numPaths; contouri++)
-				{
-					g_memory_free(dest->paths[contouri].curves);
-					dest->paths[contouri].curves = nullptr;
-					dest->paths[contouri].numCurves = 0;
-					dest->paths[contouri].maxCapacity = 0;
-				}
-
-				// Then reallocate memory. If dest had less, this will acquire enough new memory
-				// If dest had more, this will get rid of the extra memory
-				dest->paths = (Path*)g_memory_realloc(dest->paths, sizeof(Path) * src->numPaths);
-
-				// Go through and initialize the curves for any new curves that were added
-				for (int contouri = dest->numPaths; contouri < src->numPaths; contouri++)
-				{
-					dest->paths[contouri].curves = (Curve*)g_memory_allocate(sizeof(Curve) * initialMaxCapacity);
-					dest->paths[contouri].maxCapacity = initialMaxCapacity;
-					dest->paths[contouri].numCurves = 0;
-				}
-
-				// Then set the number of paths equal
-				dest->numPaths = src->numPaths;
-			}
+			resizePaths(dest, src->numPaths);
 
 			g_logger_assert(dest->numPaths == src->numPaths, "How did this happen?");
 
@@ -603,7 +584,96 @@ namespace MathAnim
 			}
 		}
 
-		SvgObject* interpolate(const SvgObject* src, const SvgObject* dst, float t)
+		SvgObject* retain(SvgObject* object)
+		{
+			g_logger_assert(object != nullptr, "Cannot retain a null SvgObject.");
+
+			std::lock_guard<std::mutex> lock(sharedRefCountsMtx);
+			auto iter = sharedRefCounts.find(object);
+			if (iter == sharedRefCounts.end())
+			{
+				sharedRefCounts[object] = 2;
+			}
+			else
+			{
+				iter->second++;
+			}
+
+			return object;
+		}
+
+		void release(SvgObject* object)
+		{
+			if (!object)
+			{
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(sharedRefCountsMtx);
+				auto iter = sharedRefCounts.find(object);
+				if (iter != sharedRefCounts.end())
+				{
+					iter->second--;
+					if (iter->second <= 1)
+					{
+						sharedRefCounts.erase(iter);
+					}
+					return;
+				}
+			}
+
+			// This was the last owner
+			object->free();
+			g_memory_free(object);
+		}
+
+		bool isShared(const SvgObject* object)
+		{
+			std::lock_guard<std::mutex> lock(sharedRefCountsMtx);
+			return sharedRefCounts.find(object) != sharedRefCounts.end();
+		}
+
+		int getOutlineCutPoint(const SvgObject* object, float t, float* outPercentOfPath)
+		{
+			float lengthToDraw = t * object->approximatePerimeter;
+			if (lengthToDraw <= 0.0f || object->numPaths <= 0)
+			{
+				*outPercentOfPath = 0.0f;
+				return -1;
+			}
+
+			*outPercentOfPath = 1.0f;
+			if (t >= 1.0f)
+			{
+				return object->numPaths;
+			}
+
+			float lengthDrawn = 0.0f;
+			for (int pathi = 0; pathi < object->numPaths; pathi++)
+			{
+				const Path& path = object->paths[pathi];
+				if (path.numCurves <= 0)
+				{
+					continue;
+				}
+
+				float lengthLeft = lengthToDraw - lengthDrawn;
+				float pathLength = path.calculateApproximatePerimeter();
+				lengthDrawn += pathLength;
+				if (lengthDrawn >= lengthToDraw)
+				{
+					*outPercentOfPath = pathLength > 0.0f
+						? lengthLeft / pathLength
+						: 1.0f;
+					return pathi;
+				}
+			}
+
+			return object->numPaths;
+		}
+
+		SvgMorph createMorph(const SvgObject* src, const SvgObject* dst)
 		{
 			// Count the total number of curves in all paths
 			int srcNumCurves = 0;
@@ -997,8 +1067,14 @@ namespace MathAnim
 
 			g_logger_assert(modifiedDstObject->numPaths == modifiedSrcObject->numPaths, "Somehow the interpolated objects didn't end up with the same number of sub-paths.");
 
-			SvgObject* res = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
-			*res = Svg::createDefault();
+			// Store both sides as bezier3 control points. The layout for each path is the
+			// first point of the path followed by p1, p2, p3 of every curve in the path.
+			SvgMorph res = {};
+			res.numPaths = modifiedSrcObject->numPaths;
+			res.pathNumCurves = (int*)g_memory_allocate(sizeof(int) * res.numPaths);
+			res.srcIsHole = (bool*)g_memory_allocate(sizeof(bool) * res.numPaths);
+			res.dstIsHole = (bool*)g_memory_allocate(sizeof(bool) * res.numPaths);
+			res.numCurves = 0;
 			for (int pathi = 0; pathi < modifiedSrcObject->numPaths; pathi++)
 			{
 				const Path* path0 = modifiedSrcObject->paths + pathi;
@@ -1006,108 +1082,47 @@ namespace MathAnim
 
 				g_logger_assert(path0->numCurves == path1->numCurves, "Somehow the interpolated objects didn't end up with the same number of curves in a sub-path.");
 
-				// Move to the start, which is the interpolation between both of the
-				// first vertices
-				const Vec2& p0a = path0->curves[0].p0;
-				const Vec2& p0b = path1->curves[0].p0;
-				Vec2 interpP0 = {
-					(p0b.x - p0a.x) * t + p0a.x,
-					(p0b.y - p0a.y) * t + p0a.y
-				};
-
-				Svg::beginPath(res, interpP0, true);
-
-				for (int curvei = 0; curvei < path0->numCurves; curvei++)
-				{
-					// Interpolate between the two curves, treat both curves
-					// as bezier3 curves no matter what to make it easier
-					Vec2 p1a, p2a, p3a;
-					Vec2 p1b, p2b, p3b;
+				res.pathNumCurves[pathi] = path0->numCurves;
+				res.srcIsHole[pathi] = path0->isHole;
+				res.dstIsHole[pathi] = path1->isHole;
+				res.numCurves += path0->numCurves;
+			}
 
-					const Curve& srcCurve = path0->curves[curvei];
-					const Curve& dstCurve = path1->curves[curvei];
+			size_t numPoints = (size_t)res.numPaths + (size_t)res.numCurves * 3;
+			res.srcPoints = (Vec2*)g_memory_allocate(sizeof(Vec2) * numPoints);
+			res.dstPoints = (Vec2*)g_memory_allocate(sizeof(Vec2) * numPoints);
 
-					// First get the control points depending on the type of the curve
-					switch (srcCurve.type)
-					{
-					case CurveType::Bezier3:
-						p1a = srcCurve.as.bezier3.p1;
-						p2a = srcCurve.as.bezier3.p2;
-						p3a = srcCurve.as.bezier3.p3;
-						break;
-					case CurveType::Bezier2:
-					{
-						Vec2 p0 = srcCurve.p0;
-						Vec2 p1 = srcCurve.as.bezier2.p1;
-						Vec2 p2 = srcCurve.as.bezier2.p2;
-
-						// Degree elevated quadratic bezier curve
-						p1a = ((1.0f / 3.0f) * p0) + ((2.0f / 3.0f) * p1);
-						p2a = ((2.0f / 3.0f) * p1) + ((1.0f / 3.0f) * p2);
-						p3a = p2;
-					}
-					break;
-					case CurveType::Line:
-					{
-						Vec2 tmpP1a = (srcCurve.as.line.p1 - srcCurve.p0) * (1.0f / 3.0f) + srcCurve.p0;
-						Vec2 tmpP2a = (srcCurve.as.line.p1 - srcCurve.p0) * (2.0f / 3.0f) + srcCurve.p0;
-						p1a = tmpP1a;
-						p2a = tmpP2a;
-						p3a = srcCurve.as.line.p1;
-					}
-					break;
-					case CurveType::None:
-						break;
-					}
-
-					switch (dstCurve.type)
-					{
-					case CurveType::Bezier3:
-						p1b = dstCurve.as.bezier3.p1;
-						p2b = dstCurve.as.bezier3.p2;
-						p3b = dstCurve.as.bezier3.p3;
-						break;
-					case CurveType::Bezier2:
-					{
-						Vec2 p0 = dstCurve.p0;
-						Vec2 p1 = dstCurve.as.bezier2.p1;
-						Vec2 p2 = dstCurve.as.bezier2.p2;
-
-						// Degree elevated quadratic bezier curve
-						p1b = ((1.0f / 3.0f) * p0) + ((2.0f / 3.0f) * p1);
-						p2b = ((2.0f / 3.0f) * p1) + ((1.0f / 3.0f) * p2);
-						p3b = p2;
-					}
-					break;
-					case CurveType::Line:
-					{
-						Vec2 tmpP1b = (dstCurve.as.line.p1 - dstCurve.p0) * (1.0f / 3.0f) + dstCurve.p0;
-						Vec2 tmpP2b = (dstCurve.as.line.p1 - dstCurve.p0) * (2.0f / 3.0f) + dstCurve.p0;
-						p1b = tmpP1b;
-						p2b = tmpP2b;
-						p3b = dstCurve.as.line.p1;
-					}
-					break;
-					case CurveType::None:
-						break;
-					}
+			size_t pointi = 0;
+			for (int pathi = 0; pathi < modifiedSrcObject->numPaths; pathi++)
+			{
+				const Path* path0 = modifiedSrcObject->paths + pathi;
+				const Path* path1 = modifiedDstObject->paths + pathi;
 
-					// Then interpolate between the control points
-					Vec2 interpP1 = (p1b - p1a) * t + p1a;
-					Vec2 interpP2 = (p2b - p2a) * t + p2a;
-					Vec2 interpP3 = (p3b - p3a) * t + p3a;
+				res.srcPoints[pointi] = path0->curves[0].p0;
+				res.dstPoints[pointi] = path1->curves[0].p0;
+				pointi++;
 
-					// Then draw
-					Svg::bezier3To(res, interpP1, interpP2, interpP3);
+				for (int curvei = 0; curvei < path0->numCurves; curvei++)
+				{
+					// Treat both curves as bezier3 curves no matter what, that
+					// way every frame is just a blend between control points
+					getBezier3ControlPoints(path0->curves[curvei], res.srcPoints + pointi);
+					getBezier3ControlPoints(path1->curves[curvei], res.dstPoints + pointi);
+					pointi += 3;
 				}
-
-				bool isHole = t < 0.5
-					? path0->isHole
-					: path1->isHole;
-				Svg::closePath(res, true, isHole);
 			}
+			g_logger_assert(pointi == numPoints, "How did this happen?");
 
-			res->finalize();
+			res.srcMd5Hash = hashMd5(src);
+			res.dstMd5Hash = hashMd5(dst);
+
+			// Every blended frame shares the same md5. SvgCache also hashes the percent
+			// transformed, so cached frames of the morph don't collide with each other.
+			std::string md5Str = Platform::md5FromString(getMd5String(src) + getMd5String(dst));
+			res.md5Length = md5Str.length();
+			res.md5 = (uint8*)g_memory_allocate(sizeof(uint8) * (res.md5Length + 1));
+			g_memory_copyMem(res.md5, sizeof(uint8) * (res.md5Length + 1), (void*)md5Str.c_str(), sizeof(uint8) * res.md5Length);
+			res.md5[res.md5Length] = '\0';
 
 			// Free temporary memory
 			modifiedSrcObject->free();
@@ -1120,6 +1135,85 @@ namespace MathAnim
 			return res;
 		}
 
+		void interpolateInto(const SvgMorph& morph, float t, SvgObject* dest)
+		{
+			resizePaths(dest, morph.numPaths);
+
+			const Vec2* srcPoint = morph.srcPoints;
+			const Vec2* dstPoint = morph.dstPoints;
+			for (int pathi = 0; pathi < morph.numPaths; pathi++)
+			{
+				Path& path = dest->paths[pathi];
+
+				// One extra curve for the line that closes the path
+				path.numCurves = morph.pathNumCurves[pathi] + 1;
+				if (path.numCurves > path.maxCapacity)
+				{
+					path.maxCapacity = path.numCurves;
+					path.curves = (Curve*)g_memory_realloc(path.curves, sizeof(Curve) * path.maxCapacity);
+					g_logger_assert(path.curves != nullptr, "Ran out of RAM.");
+				}
+
+				// Move to the start, which is the interpolation between both of the
+				// first vertices
+				Vec2 firstPoint = (*dstPoint - *srcPoint) * t + *srcPoint;
+				srcPoint++;
+				dstPoint++;
+
+				Vec2 cursor = firstPoint;
+				for (int curvei = 0; curvei < morph.pathNumCurves[pathi]; curvei++)
+				{
+					Curve& curve = path.curves[curvei];
+					curve.type = CurveType::Bezier3;
+					curve.p0 = cursor;
+					curve.as.bezier3.p1 = (dstPoint[0] - srcPoint[0]) * t + srcPoint[0];
+					curve.as.bezier3.p2 = (dstPoint[1] - srcPoint[1]) * t + srcPoint[1];
+					curve.as.bezier3.p3 = (dstPoint[2] - srcPoint[2]) * t + srcPoint[2];
+					cursor = curve.as.bezier3.p3;
+
+					srcPoint += 3;
+					dstPoint += 3;
+				}
+
+				Curve& closingLine = path.curves[path.numCurves - 1];
+				closingLine.type = CurveType::Line;
+				closingLine.p0 = cursor;
+				closingLine.as.line.p1 = firstPoint;
+
+				path.isHole = t < 0.5f
+					? morph.srcIsHole[pathi]
+					: morph.dstIsHole[pathi];
+				dest->_cursor = firstPoint;
+			}
+
+			// Interpolated objects have always used the default style
+			dest->fillColor = Vec4{ 1, 1, 1, 1 };
+			dest->fillType = FillType::NonZeroFillType;
+
+			dest->calculateApproximatePerimeter();
+			dest->calculateSize();
+
+			if (dest->md5 == nullptr || dest->md5Length != morph.md5Length)
+			{
+				dest->md5 = (uint8*)g_memory_realloc(dest->md5, sizeof(uint8) * (morph.md5Length + 1));
+				g_logger_assert(dest->md5 != nullptr, "Ran out of RAM.");
+			}
+			g_memory_copyMem(dest->md5, sizeof(uint8) * (morph.md5Length + 1), (void*)morph.md5, sizeof(uint8) * (morph.md5Length + 1));
+			dest->md5Length = morph.md5Length;
+		}
+
+		SvgObject* interpolate(const SvgObject* src, const SvgObject* dst, float t)
+		{
+			SvgMorph morph = createMorph(src, dst);
+
+			SvgObject* res = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+			*res = Svg::createDefault();
+			interpolateInto(morph, t, res);
+
+			morph.free();
+			return res;
+		}
+
 		// ----------------- Internal functions -----------------
 		static void checkResize(Path& path)
 		{
@@ -1130,6 +1224,95 @@ namespace MathAnim
 				g_logger_assert(path.curves != nullptr, "Ran out of RAM.");
 			}
 		}
+
+		static void resizePaths(SvgObject* object, int numPaths)
+		{
+			if (object->numPaths != numPaths)
+			{
+				// Free any extra paths the object has
+				// If the object has less, this loop doesn't run
+				for (int contouri = numPaths; contouri < object->numPaths; contouri++)
+				{
+					g_memory_free(object->paths[contouri].curves);
+					object->paths[contouri].curves = nullptr;
+					object->paths[contouri].numCurves = 0;
+					object->paths[contouri].maxCapacity = 0;
+				}
+
+				// Then reallocate memory. If the object had less, this will acquire enough new memory
+				// If the object had more, this will get rid of the extra memory
+				object->paths = (Path*)g_memory_realloc(object->paths, sizeof(Path) * numPaths);
+
+				// Go through and initialize the curves for any new curves that were added
+				for (int contouri = object->numPaths; contouri < numPaths; contouri++)
+				{
+					object->paths[contouri].curves = (Curve*)g_memory_allocate(sizeof(Curve) * initialMaxCapacity);
+					object->paths[contouri].maxCapacity = initialMaxCapacity;
+					object->paths[contouri].numCurves = 0;
+					object->paths[contouri].isHole = false;
+				}
+
+				// Then set the number of paths equal
+				object->numPaths = numPaths;
+			}
+		}
+
+		static void getBezier3ControlPoints(const Curve& curve, Vec2* outP1P2P3)
+		{
+			switch (curve.type)
+			{
+			case CurveType::Bezier3:
+				outP1P2P3[0] = curve.as.bezier3.p1;
+				outP1P2P3[1] = curve.as.bezier3.p2;
+				outP1P2P3[2] = curve.as.bezier3.p3;
+				break;
+			case CurveType::Bezier2:
+			{
+				Vec2 p0 = curve.p0;
+				Vec2 p1 = curve.as.bezier2.p1;
+				Vec2 p2 = curve.as.bezier2.p2;
+
+				// Degree elevated quadratic bezier curve
+				outP1P2P3[0] = ((1.0f / 3.0f) * p0) + ((2.0f / 3.0f) * p1);
+				outP1P2P3[1] = ((2.0f / 3.0f) * p1) + ((1.0f / 3.0f) * p2);
+				outP1P2P3[2] = p2;
+			}
+			break;
+			case CurveType::Line:
+				outP1P2P3[0] = (curve.as.line.p1 - curve.p0) * (1.0f / 3.0f) + curve.p0;
+				outP1P2P3[1] = (curve.as.line.p1 - curve.p0) * (2.0f / 3.0f) + curve.p0;
+				outP1P2P3[2] = curve.as.line.p1;
+				break;
+			case CurveType::None:
+				outP1P2P3[0] = curve.p0;
+				outP1P2P3[1] = curve.p0;
+				outP1P2P3[2] = curve.p0;
+				break;
+			}
+		}
+
+		static uint64 hashMd5(const SvgObject* object)
+		{
+			if (!object->md5 || object->md5Length == 0)
+			{
+				return 0;
+			}
+
+			return std::hash<std::string_view>{}(std::string_view((const char*)object->md5, object->md5Length));
+		}
+
+		static std::string getMd5String(const SvgObject* object)
+		{
+			if (object->md5 && object->md5Length > 0)
+			{
+				return std::string((const char*)object->md5, object->md5Length);
+			}
+
+			RawMemory b64String = object->getPathAsBinaryString();
+			std::string res = Platform::md5FromString((const char*)b64String.data, b64String.size - 1);
+			b64String.free();
+			return res;
+		}
 	}
 
 	struct RenderAsyncData
@@ -1148,6 +1331,7 @@ namespace MathAnim
 	static void uploadRasterizedPixelsCallback(void* renderAsyncData, size_t dataSize);
 	static void fillWithPluto(plutovg_t* pluto, float scale, const SvgObject* obj);
 	static void renderOutline2D(float t, const AnimObject* parent, const SvgObject* obj);
+	static uint64 hashStroke(const Path& path, const Vec2& inXRange, const Vec2& inYRange, const Vec2& outXRange, const Vec2& outYRange, float strokeWidth);
 	static void writeBuffer(uint8** buffer, size_t* capacity, size_t* numElements, const char* string, size_t stringLength = 0);
 	static void writeBufferBin(uint8** buffer, size_t* capacity, size_t* numElements, const uint8* data, size_t numBytes);
 	static void growBufferIfNeeded(uint8** buffer, size_t* capacity, size_t numElements, size_t numElementsToAdd);
@@ -1585,6 +1769,15 @@ namespace MathAnim
 	}
 
 	RawMemory SvgObject::getPathAsBinaryString() const
+	{
+		RawMemory binPath = getPathAsBinary();
+		RawMemory pathAsRawMemoryString = Base64::encode(binPath.data, binPath.size);
+		binPath.free();
+
+		return pathAsRawMemoryString;
+	}
+
+	RawMemory SvgObject::getPathAsBinary() const
 	{
 		size_t numElements = 0;
 		// Have initial capacity set to 10KB to reduce realloc calls
@@ -1659,10 +1852,11 @@ namespace MathAnim
 			}
 		}
 
-		RawMemory pathAsRawMemoryString = Base64::encode(buffer, numElements);
-		g_memory_free(buffer);
-
-		return pathAsRawMemoryString;
+		RawMemory res = {};
+		res.data = buffer;
+		res.size = numElements;
+		res.offset = 0;
+		return res;
 	}
 
 	float SvgObject::calculateSvgScale(float targetWidth) const
@@ -1760,6 +1954,52 @@ namespace MathAnim
 		approximatePerimeter = 0.0f;
 	}
 
+	bool SvgMorph::isMorphBetween(const SvgObject* src, const SvgObject* dst) const
+	{
+		// Objects without an md5 can't be identified, so they never match a cached morph
+		uint64 srcHash = Svg::hashMd5(src);
+		uint64 dstHash = Svg::hashMd5(dst);
+		return srcHash != 0 && dstHash != 0 && srcHash == srcMd5Hash && dstHash == dstMd5Hash;
+	}
+
+	void SvgMorph::free()
+	{
+		if (srcPoints)
+		{
+			g_memory_free(srcPoints);
+		}
+		if (dstPoints)
+		{
+			g_memory_free(dstPoints);
+		}
+		if (pathNumCurves)
+		{
+			g_memory_free(pathNumCurves);
+		}
+		if (srcIsHole)
+		{
+			g_memory_free(srcIsHole);
+		}
+		if (dstIsHole)
+		{
+			g_memory_free(dstIsHole);
+		}
+		if (md5)
+		{
+			g_memory_free(md5);
+		}
+
+		srcPoints = nullptr;
+		dstPoints = nullptr;
+		pathNumCurves = nullptr;
+		srcIsHole = nullptr;
+		dstIsHole = nullptr;
+		md5 = nullptr;
+		md5Length = 0;
+		numPaths = 0;
+		numCurves = 0;
+	}
+
 	void SvgObject::serialize(nlohmann::json& memory) const
 	{
 		SERIALIZE_VEC(memory, this, fillColor);
@@ -1772,6 +2012,31 @@ namespace MathAnim
 		binStringMemory.free();
 	}
 
+	void SvgObject::serializeStyle(nlohmann::json& memory) const
+	{
+		SERIALIZE_VEC(memory, this, fillColor);
+		SERIALIZE_ENUM(memory, this, fillType, _fillTypeNames);
+	}
+
+	SvgObject* SvgObject::deserializeWithBinPath(const nlohmann::json& style, const uint8* binPath, size_t binPathSize)
+	{
+		SvgObject* res = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+		if (!binPath || binPathSize == 0)
+		{
+			g_logger_warning("Path was empty while deserializing svg path.");
+			*res = Svg::createDefault();
+		}
+		else if (!SvgParser::parseBinSvgPath(binPath, binPathSize, res))
+		{
+			g_logger_error("Error deserializing SVG. Bad binary path data.");
+			*res = Svg::createDefault();
+		}
+
+		DESERIALIZE_ENUM(res, fillType, _fillTypeNames, FillType, style);
+		DESERIALIZE_VEC4(res, fillColor, style, "#e303fc"_hex);
+		return res;
+	}
+
 	SvgObject* SvgObject::deserialize(const nlohmann::json& j, uint32 version)
 	{
 		switch (version)
@@ -2205,244 +2470,143 @@ namespace MathAnim
 		MP_PROFILE_EVENT("Svg_RenderOutline2D");
 		constexpr float defaultStrokeWidth = 0.02f;
 
-		// Start the fade in after 80% of the svg object is drawn
-		float lengthToDraw = t * (float)obj->approximatePerimeter;
-
 		Vec2 inXRange = Vec2{ obj->bbox.min.x, obj->bbox.max.x };
 		Vec2 inYRange = Vec2{ obj->bbox.min.y, obj->bbox.max.y };
 		Vec2 outXRange = Vec2{ -obj->size.x / 2.0f, obj->size.x / 2.0f };
 		Vec2 outYRange = Vec2{ obj->size.y / 2.0f, -obj->size.y / 2.0f };
 
-		if (lengthToDraw > 0 && obj->numPaths > 0)
-		{
-			MP_PROFILE_EVENT("Svg_RenderOutline2D_GeneratePath2D");
-			float lengthDrawn = 0.0f;
+		float strokeWidth = glm::epsilonEqual(parent->strokeWidth, 0.0f, 0.01f)
+			? defaultStrokeWidth
+			: parent->strokeWidth;
 
-			for (int pathi = 0; pathi < obj->numPaths; pathi++)
+		float percentOfLastPath = 0.0f;
+		int lastPath = Svg::getOutlineCutPoint(obj, t, &percentOfLastPath);
+		if (lastPath >= 0)
+		{
+			for (int pathi = 0; pathi <= lastPath && pathi < obj->numPaths; pathi++)
 			{
-				Path2DContext* context = nullptr;
-				if (obj->paths[pathi].numCurves > 0)
+				const Path& path = obj->paths[pathi];
+				if (path.numCurves <= 0)
 				{
-					Renderer::pushColor(parent->strokeColor);
-					if (glm::epsilonEqual(parent->strokeWidth, 0.0f, 0.01f))
-					{
-						Renderer::pushStrokeWidth(defaultStrokeWidth);
-					}
-					else
-					{
-						Renderer::pushStrokeWidth(parent->strokeWidth);
-					}
-
-					{
-						Vec2 p0 = obj->paths[pathi].curves[0].p0;
+					continue;
+				}
 
-						p0.x = CMath::mapRange(inXRange, outXRange, p0.x);
-						p0.y = CMath::mapRange(inYRange, outYRange, p0.y);
+				// Anything that changes the tessellated vertices has to be part of the key, the
+				// transform and stroke color get applied when the stroke is drawn
+				uint64 strokeKey = hashStroke(path, inXRange, inYRange, outXRange, outYRange, strokeWidth);
+				const StrokeTessellation* stroke = Renderer::getCachedStroke(strokeKey);
+				if (!stroke)
+				{
+					MP_PROFILE_EVENT("Svg_RenderOutline2D_TessellateStroke");
+					Renderer::pushStrokeWidth(strokeWidth);
 
-						context = Renderer::beginPath(Vec2{ p0.x, p0.y }, parent->globalTransform);
-					}
-					g_logger_assert(context != nullptr, "We have bigger problems.");
+					Vec2 p0 = path.curves[0].p0;
+					p0.x = CMath::mapRange(inXRange, outXRange, p0.x);
+					p0.y = CMath::mapRange(inYRange, outYRange, p0.y);
+					Path2DContext* context = Renderer::beginPath(p0);
 
-					for (int curvei = 0; curvei < obj->paths[pathi].numCurves; curvei++)
+					for (int curvei = 0; curvei < path.numCurves; curvei++)
 					{
-						float lengthLeft = lengthToDraw - lengthDrawn;
-						if (lengthLeft < 0.0f)
+						const Curve& curve = path.curves[curvei];
+						if (curve.type == CurveType::None)
 						{
-							break;
+							continue;
 						}
 
-						const Curve& curve = obj->paths[pathi].curves[curvei];
-						Vec2 p0 = curve.p0;
-
-						switch (curve.type)
+						if (curve.type == CurveType::Line)
 						{
-						case CurveType::Bezier3:
-						{
-							Vec2 p1 = curve.as.bezier3.p1;
-							Vec2 p2 = curve.as.bezier3.p2;
-							Vec2 p3 = curve.as.bezier3.p3;
-
-							float chordLength = CMath::length(p3 - p0);
-							float controlNetLength = CMath::length(p1 - p0) + CMath::length(p2 - p1) + CMath::length(p3 - p2);
-							float approxLength = (chordLength + controlNetLength) / 2.0f;
-							lengthDrawn += approxLength;
-
-							if (lengthLeft < approxLength)
-							{
-								// Interpolate the curve
-								float percentOfCurveToDraw = lengthLeft / approxLength;
-
-								// Taken from https://stackoverflow.com/questions/878862/drawing-part-of-a-b%C3%A9zier-curve-by-reusing-a-basic-b%C3%A9zier-curve-function
-								float t0 = 0.0f;
-								float t1 = percentOfCurveToDraw;
-								float u0 = 1.0f;
-								float u1 = (1.0f - t1);
-
-								Vec2 q0 = ((u0 * u0 * u0) * p0) +
-									((t0 * u0 * u0 + u0 * t0 * u0 + u0 * u0 * t0) * p1) +
-									((t0 * t0 * u0 + u0 * t0 * t0 + t0 * u0 * t0) * p2) +
-									((t0 * t0 * t0) * p3);
-								Vec2 q1 = ((u0 * u0 * u1) * p0) +
-									((t0 * u0 * u1 + u0 * t0 * u1 + u0 * u0 * t1) * p1) +
-									((t0 * t0 * u1 + u0 * t0 * t1 + t0 * u0 * t1) * p2) +
-									((t0 * t0 * t1) * p3);
-								Vec2 q2 = ((u0 * u1 * u1) * p0) +
-									((t0 * u1 * u1 + u0 * t1 * u1 + u0 * u1 * t1) * p1) +
-									((t0 * t1 * u1 + u0 * t1 * t1 + t0 * u1 * t1) * p2) +
-									((t0 * t1 * t1) * p3);
-								Vec2 q3 = ((u1 * u1 * u1) * p0) +
-									((t1 * u1 * u1 + u1 * t1 * u1 + u1 * u1 * t1) * p1) +
-									((t1 * t1 * u1 + u1 * t1 * t1 + t1 * u1 * t1) * p2) +
-									((t1 * t1 * t1) * p3);
-
-								p1 = q1;
-								p2 = q2;
-								p3 = q3;
-							}
-
+							Vec2 p1 = curve.as.line.p1;
 							p1.x = CMath::mapRange(inXRange, outXRange, p1.x);
 							p1.y = CMath::mapRange(inYRange, outYRange, p1.y);
-
-							p2.x = CMath::mapRange(inXRange, outXRange, p2.x);
-							p2.y = CMath::mapRange(inYRange, outYRange, p2.y);
-
-							p3.x = CMath::mapRange(inXRange, outXRange, p3.x);
-							p3.y = CMath::mapRange(inYRange, outYRange, p3.y);
-
-							Renderer::cubicTo(
-								context,
-								p1,
-								p2,
-								p3
-							);
+							Renderer::lineTo(context, p1);
+							continue;
 						}
-						break;
-						case CurveType::Bezier2:
-						{
-							Vec2 p1 = curve.as.bezier2.p1;
-							Vec2 p2 = curve.as.bezier2.p1;
-							Vec2 p3 = curve.as.bezier2.p2;
-
-							// Degree elevated quadratic bezier curve
-							Vec2 pr0 = p0;
-							Vec2 pr1 = (1.0f / 3.0f) * p0 + (2.0f / 3.0f) * p1;
-							Vec2 pr2 = (2.0f / 3.0f) * p1 + (1.0f / 3.0f) * p2;
-							Vec2 pr3 = p3;
-
-							float chordLength = CMath::length(pr3 - pr0);
-							float controlNetLength = CMath::length(pr1 - pr0) + CMath::length(pr2 - pr1) + CMath::length(pr3 - pr2);
-							float approxLength = (chordLength + controlNetLength) / 2.0f;
-							lengthDrawn += approxLength;
 
-							if (lengthLeft < approxLength)
-							{
-								// Interpolate the curve
-								float percentOfCurveToDraw = lengthLeft / approxLength;
-
-								p1 = (pr1 - pr0) * percentOfCurveToDraw + pr0;
-								p2 = (pr2 - pr1) * percentOfCurveToDraw + pr1;
-								p3 = (pr3 - pr2) * percentOfCurveToDraw + pr2;
-
-								// Taken from https://stackoverflow.com/questions/878862/drawing-part-of-a-bézier-curve-by-reusing-a-basic-bézier-curve-function
-								float t0 = 0.0f;
-								float t1 = percentOfCurveToDraw;
-								float u0 = 1.0f;
-								float u1 = (1.0f - t1);
-
-								Vec2 q0 = ((u0 * u0 * u0) * p0) +
-									((t0 * u0 * u0 + u0 * t0 * u0 + u0 * u0 * t0) * p1) +
-									((t0 * t0 * u0 + u0 * t0 * t0 + t0 * u0 * t0) * p2) +
-									((t0 * t0 * t0) * p3);
-								Vec2 q1 = ((u0 * u0 * u1) * p0) +
-									((t0 * u0 * u1 + u0 * t0 * u1 + u0 * u0 * t1) * p1) +
-									((t0 * t0 * u1 + u0 * t0 * t1 + t0 * u0 * t1) * p2) +
-									((t0 * t0 * t1) * p3);
-								Vec2 q2 = ((u0 * u1 * u1) * p0) +
-									((t0 * u1 * u1 + u0 * t1 * u1 + u0 * u1 * t1) * p1) +
-									((t0 * t1 * u1 + u0 * t1 * t1 + t0 * u1 * t1) * p2) +
-									((t0 * t1 * t1) * p3);
-								Vec2 q3 = ((u1 * u1 * u1) * p0) +
-									((t1 * u1 * u1 + u1 * t1 * u1 + u1 * u1 * t1) * p1) +
-									((t1 * t1 * u1 + u1 * t1 * t1 + t1 * u1 * t1) * p2) +
-									((t1 * t1 * t1) * p3);
-
-								pr1 = q1;
-								pr2 = q2;
-								pr3 = q3;
-							}
-
-							pr1.x = CMath::mapRange(inXRange, outXRange, pr1.x);
-							pr1.y = CMath::mapRange(inYRange, outYRange, pr1.y);
-
-							pr2.x = CMath::mapRange(inXRange, outXRange, pr2.x);
-							pr2.y = CMath::mapRange(inYRange, outYRange, pr2.y);
-
-							pr3.x = CMath::mapRange(inXRange, outXRange, pr3.x);
-							pr3.y = CMath::mapRange(inYRange, outYRange, pr3.y);
-
-							Renderer::cubicTo(
-								context,
-								pr1,
-								pr2,
-								pr3
-							);
-						}
-						break;
-						case CurveType::Line:
+						// Quadratic curves get degree elevated
+						Vec2 controlPoints[3];
+						Svg::getBezier3ControlPoints(curve, controlPoints);
+						for (int i = 0; i < 3; i++)
 						{
-							Vec2 p1 = curve.as.line.p1;
-							float curveLength = CMath::length(p1 - p0);
-							lengthDrawn += curveLength;
-
-							if (lengthLeft < curveLength)
-							{
-								float percentOfCurveToDraw = lengthLeft / curveLength;
-								p1 = ((p1 - p0) * percentOfCurveToDraw) + p0;
-							}
-
-							p1.x = CMath::mapRange(inXRange, outXRange, p1.x);
-							p1.y = CMath::mapRange(inYRange, outYRange, p1.y);
-
-							Renderer::lineTo(
-								context,
-								p1
-							);
-						}
-						break;
-						case CurveType::None:
-							break;
+							controlPoints[i].x = CMath::mapRange(inXRange, outXRange, controlPoints[i].x);
+							controlPoints[i].y = CMath::mapRange(inYRange, outYRange, controlPoints[i].y);
 						}
+						Renderer::cubicTo(context, controlPoints[0], controlPoints[1], controlPoints[2]);
 					}
 
+					stroke = Renderer::cacheStroke(strokeKey, context);
+					Renderer::free(context);
 					Renderer::popStrokeWidth();
-					Renderer::popColor();
 				}
 
-				if (lengthDrawn >= lengthToDraw && t < 1.0f)
+				if (!stroke)
 				{
-					MP_PROFILE_EVENT("Svg_RenderOutline2D_EndPath");
-					if (!Renderer::endPath(context, false, parent->id))
-					{
 #ifdef _DEBUG
-						g_logger_warning("Failed to end path for object: {}<{}>", parent->id, parent->name);
+					g_logger_warning("Failed to tessellate path for object: {}<{}>", parent->id, parent->name);
 #endif
+					continue;
 				}
-					Renderer::free(context);
-					break;
+
+				// The path the outline stops in gets drawn partially, as an open path
+				float percentToDraw = pathi == lastPath
+					? percentOfLastPath
+					: 1.0f;
+
+				MP_PROFILE_EVENT("Svg_RenderOutline2D_DrawStroke");
+				Renderer::pushColor(parent->strokeColor);
+				Renderer::drawStroke(stroke, percentToDraw, parent->globalTransform, parent->id);
+				Renderer::popColor();
 			}
-				else
-				{
-					MP_PROFILE_EVENT("Svg_RenderOutline2D_EndPath");
-					if (!Renderer::endPath(context, true, parent->id))
-					{
-#ifdef _DEBUG
-						g_logger_warning("Failed to end path for object: {}<{}>", parent->id, parent->name);
-#endif
-				}
-					Renderer::free(context);
 		}
 	}
-}
+
+	static uint64 hashStroke(const Path& path, const Vec2& inXRange, const Vec2& inYRange, const Vec2& outXRange, const Vec2& outYRange, float strokeWidth)
+	{
+		constexpr uint64 FNVOffsetBasis = 0xcbf29ce484222325ULL;
+		constexpr uint64 FNVPrime = 0x00000100000001B3ULL;
+
+		uint64 hash = FNVOffsetBasis;
+		auto hashBytes = [&hash](const void* data, size_t numBytes)
+		{
+			const uint8* bytes = (const uint8*)data;
+			for (size_t i = 0; i < numBytes; i++)
+			{
+				hash = hash * FNVPrime;
+				hash = hash ^ bytes[i];
+			}
+		};
+
+		hashBytes(inXRange.values, sizeof(Vec2));
+		hashBytes(inYRange.values, sizeof(Vec2));
+		hashBytes(outXRange.values, sizeof(Vec2));
+		hashBytes(outYRange.values, sizeof(Vec2));
+		hashBytes(&strokeWidth, sizeof(float));
+
+		for (int curvei = 0; curvei < path.numCurves; curvei++)
+		{
+			// Only hash the points each curve type actually uses, the rest of the union can be garbage
+			const Curve& curve = path.curves[curvei];
+			hashBytes(&curve.type, sizeof(CurveType));
+			hashBytes(curve.p0.values, sizeof(Vec2));
+			switch (curve.type)
+			{
+			case CurveType::Bezier3:
+				hashBytes(curve.as.bezier3.p1.values, sizeof(Vec2));
+				hashBytes(curve.as.bezier3.p2.values, sizeof(Vec2));
+				hashBytes(curve.as.bezier3.p3.values, sizeof(Vec2));
+				break;
+			case CurveType::Bezier2:
+				hashBytes(curve.as.bezier2.p1.values, sizeof(Vec2));
+				hashBytes(curve.as.bezier2.p2.values, sizeof(Vec2));
+				break;
+			case CurveType::Line:
+				hashBytes(curve.as.line.p1.values, sizeof(Vec2));
+				break;
+			case CurveType::None:
+				break;
+			}
+		}
+
+		return hash;
 	}
 
 	static void growBufferIfNeeded(uint8** buffer, size_t* capacity, size_t numElements, size_t numElementsToAdd)
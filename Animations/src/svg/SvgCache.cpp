@@ -23,6 +23,7 @@ namespace MathAnim
 	{
 		framebuffer.destroy();
 		cachedSvgs.clear();
+		atlases.clear();
 	}
 
 	bool SvgCache::exists(AnimationManagerData* am, AnimObjId obj)
@@ -68,6 +69,7 @@ namespace MathAnim
 			auto entry = getInternal(hash(animObj->svgObject->md5, animObj->svgObject->md5Length, animObj->svgScale, animObj->percentReplacementTransformed));
 			if (entry.has_value())
 			{
+				stats.hits++;
 				return SvgCacheEntry{
 					entry->texCoordsMin,
 					entry->texCoordsMax,
@@ -76,6 +78,7 @@ namespace MathAnim
 			}
 		}
 
+		stats.misses++;
 		put(animObj, svg);
 		return get(am, obj);
 	}
@@ -88,11 +91,6 @@ namespace MathAnim
 		// Only add the SVG if it hasn't already been added
 		if (!existsInternal(hashValue))
 		{
-			// Setup the texture coords and everything 
-			Vec2 svgTextureOffset = cacheCurrentPos;
-			int colorAttachmentToRenderTo = this->cacheCurrentColorAttachment;
-
-			// Check if the SVG cache needs to regenerate
 			float svgTotalWidth = (svg->size.x * parent->svgScale);
 			float svgTotalHeight = (svg->size.y * parent->svgScale);
 			if (svgTotalWidth <= 0.0f || svgTotalHeight <= 0.0f)
@@ -100,89 +98,48 @@ namespace MathAnim
 				return;
 			}
 
-			bool incrementX = true;
-			Vec2 allottedSize = Vec2{ svgTotalWidth, svgTotalHeight };
+			int regionWidth = (int)glm::ceil(svgTotalWidth + cachePadding.x);
+			int regionHeight = (int)glm::ceil(svgTotalHeight + cachePadding.y);
+			if (regionWidth > framebuffer.width || regionHeight > framebuffer.height)
 			{
-				int newRightX = (int)(svgTextureOffset.x + svgTotalWidth + cachePadding.x);
-				if (newRightX >= framebuffer.width)
-				{
-					// Move to the newline
-					svgTextureOffset = incrementCacheCurrentY();
-				}
+				g_logger_warning("SVG of size {}x{} is bigger than the SVG cache. The SVG will be truncated.", regionWidth, regionHeight);
+				regionWidth = glm::min(regionWidth, framebuffer.width);
+				regionHeight = glm::min(regionHeight, framebuffer.height);
+			}
 
-				float newBottomY = svgTextureOffset.y + svgTotalHeight + cachePadding.y;
-				if (newBottomY >= framebuffer.height)
+			// Evict the least recently used SVGs until there's room for this one. Evicted
+			// regions get merged back into the free space of their attachment, so this
+			// usually only has to throw away a few entries instead of a whole texture.
+			AtlasRegion region = {};
+			int colorAttachmentToRenderTo = 0;
+			while (!allocateRegion(regionWidth, regionHeight, &region, &colorAttachmentToRenderTo))
+			{
+				if (!evictOldest())
 				{
-					// Evict the first potential result from the LRU cache that
-					// can contain the size of this SVG
-
-					// Only evict up to the oldest evictionThreshold% entries. If nothing is big enough in the oldest 
-					// evictionThreshold% entries then grow the cache instead of evicting a newer entry
-					constexpr float evictionThreshold = 0.1f;
-					LRUCacheEntry<uint64, _SvgCacheEntryInternal>* oldest = this->cachedSvgs.getOldest();
-					const size_t maxNumEntriesToTry = (size_t)(evictionThreshold * (float)this->cachedSvgs.size());
-					size_t counter = 0;
-					while (oldest != nullptr && counter < maxNumEntriesToTry)
-					{
-						if (oldest->data.allottedSize.x >= svgTotalWidth && oldest->data.allottedSize.y >= svgTotalHeight)
-						{
-							// We found an entry that will fit this 
-							// in the future we could evict this entry, 
-							// repack the texture and then insert the new svg
-							// but in practice this will probably be too slow
-
-							// So for now I'll just "evict" then re-insert the new entry
-
-							allottedSize = oldest->data.allottedSize;
-							svgTextureOffset = oldest->data.textureOffset;
-							colorAttachmentToRenderTo = oldest->data.colorAttachment;
-
-							if (!this->cachedSvgs.evict(oldest->key))
-							{
-								g_logger_error("SVG cache eviction failed: '{:#010x}'", oldest->key);
-								oldest = nullptr;
-							}
-
-							// The svg will get reinserted below
-							break;
-						}
-
-						// Try to find an entry that will fit this new SVG
-						oldest = oldest->next;
-						counter++;
-					}
-
-					if (oldest == nullptr || counter >= maxNumEntriesToTry)
-					{
-						// Didn't find room so just clear an entire texture and let
-						// everything get recached
-						growCache();
-						svgTextureOffset = cacheCurrentPos;
-						colorAttachmentToRenderTo = this->cacheCurrentColorAttachment;
-					}
-					else
-					{
-						const Texture& textureToRenderTo = framebuffer.getColorAttachment(colorAttachmentToRenderTo);
-						GL::enable(GL_SCISSOR_TEST);
-						GL::scissor(
-							(GLint)svgTextureOffset.x,
-							(GLint)(textureToRenderTo.height - svgTextureOffset.y - allottedSize.y),
-							(GLsizei)allottedSize.x,
-							(GLsizei)allottedSize.y
-						);
-						framebuffer.bind();
-						framebuffer.clearColorAttachmentRgba(colorAttachmentToRenderTo, Vec4{ 0.0f, 0, 0, 0.0f });
-						framebuffer.clearDepthStencil();
-						incrementX = false;
-						GL::disable(GL_SCISSOR_TEST);
-					}
+					g_logger_error("SVG cache failed to find room for an SVG of size {}x{}.", regionWidth, regionHeight);
+					return;
 				}
 			}
 
+			// Clear whatever was rendered to this region before
+			const Texture& textureToRenderTo = framebuffer.getColorAttachment(colorAttachmentToRenderTo);
+			GL::enable(GL_SCISSOR_TEST);
+			GL::scissor(
+				(GLint)region.x,
+				(GLint)textureToRenderTo.height - region.y - region.height,
+				(GLsizei)region.width,
+				(GLsizei)region.height
+			);
+			framebuffer.bind();
+			framebuffer.clearColorAttachmentRgba(colorAttachmentToRenderTo, Vec4{ 0.0f, 0, 0, 0.0f });
+			framebuffer.clearDepthStencil();
+			GL::disable(GL_SCISSOR_TEST);
+
 			// Calculate UVs and stuff for LRU cache
+			Vec2 svgTextureOffset = Vec2{ (float)region.x, (float)region.y };
 			Vec2 cacheUvMin = Vec2{
 				svgTextureOffset.x / framebuffer.width,
-				1.0f - (svgTextureOffset.y / framebuffer.width) - (svgTotalHeight / framebuffer.height)
+				1.0f - (svgTextureOffset.y / framebuffer.height) - (svgTotalHeight / framebuffer.height)
 			};
 			Vec2 cacheUvMax = cacheUvMin +
 				Vec2{
@@ -190,19 +147,13 @@ namespace MathAnim
 					svgTotalHeight / framebuffer.height
 			};
 
-			if (incrementX)
-			{
-				incrementCacheCurrentX(svgTotalWidth + cachePadding.x);
-				checkLineHeight(svgTotalHeight);
-			}
-
 			// Store the results here
 			_SvgCacheEntryInternal res = {};
 			res.colorAttachment = colorAttachmentToRenderTo;
 			res.texCoordsMin = cacheUvMin;
 			res.texCoordsMax = cacheUvMax;
 			res.svgSize = Vec2{ svgTotalWidth, svgTotalHeight };
-			res.allottedSize = allottedSize;
+			res.region = region;
 			res.textureOffset = svgTextureOffset;
 			this->cachedSvgs.insert(hashValue, res);
 
@@ -259,13 +210,20 @@ namespace MathAnim
 		return framebuffer;
 	}
 
+	AtlasStats SvgCache::getAtlasStats(int colorAttachment) const
+	{
+		g_logger_assert(colorAttachment >= 0 && colorAttachment < (int)atlases.size(), "Invalid SVG cache color attachment {}.", colorAttachment);
+		return atlases[colorAttachment].getStats();
+	}
+
 	void SvgCache::clearAll()
 	{
-		cacheCurrentPos.x = 0;
-		cacheCurrentPos.y = 0;
-		cacheCurrentColorAttachment = 0;
-		cacheLineHeight = 0;
 		cachedSvgs.clear();
+		for (AtlasAllocator& atlas : atlases)
+		{
+			atlas.clear();
+		}
+		stats = {};
 
 		GL::pushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "SVG_Cache_Reset");
 
@@ -281,56 +239,42 @@ namespace MathAnim
 	}
 
 	// --------------------- Private ---------------------
-	Vec2 SvgCache::incrementCacheCurrentY()
+	bool SvgCache::allocateRegion(int width, int height, AtlasRegion* outRegion, int* outColorAttachment)
 	{
-		cacheCurrentPos.y += cacheLineHeight + cachePadding.y;
-		cacheLineHeight = 0;
-		cacheCurrentPos.x = 0;
-		return cacheCurrentPos;
-	}
+		// Fill the attachments in order so the later ones only get used once the
+		// cache actually needs the room
+		for (int i = 0; i < (int)atlases.size(); i++)
+		{
+			if (atlases[i].allocate(width, height, outRegion))
+			{
+				*outColorAttachment = i;
+				return true;
+			}
+		}
 
-	Vec2 SvgCache::incrementCacheCurrentX(float distance)
-	{
-		cacheCurrentPos.x += distance;
-		return cacheCurrentPos;
+		return false;
 	}
 
-	void SvgCache::checkLineHeight(float newLineHeight)
+	bool SvgCache::evictOldest()
 	{
-		cacheLineHeight = glm::max(cacheLineHeight, newLineHeight);
-	}
+		LRUCacheEntry<uint64, _SvgCacheEntryInternal>* oldest = this->cachedSvgs.getOldest();
+		if (oldest == nullptr)
+		{
+			return false;
+		}
 
-	void SvgCache::growCache()
-	{
-		// TODO: This should just add a new color attachment
-		cacheCurrentColorAttachment = (cacheCurrentColorAttachment + 1) % framebuffer.colorAttachments.size();
+		// Copy these out first, evicting frees the entry
+		uint64 key = oldest->key;
+		_SvgCacheEntryInternal data = oldest->data;
+		if (!this->cachedSvgs.evict(key))
 		{
-			// Delete all cached svg entries that are attached to cacheCurrentColorAttachment
-			LRUCacheEntry<uint64, _SvgCacheEntryInternal>* oldest = this->cachedSvgs.getOldest();
-			while (oldest != nullptr)
-			{
-				if (oldest->data.colorAttachment == cacheCurrentColorAttachment)
-				{
-					LRUCacheEntry<uint64, _SvgCacheEntryInternal>* next = oldest->next;
-					if (!cachedSvgs.evict(oldest->key))
-					{
-						g_logger_error("Failed to evict cache entry {}", oldest->key);
-					}
-					oldest = next;
-				}
-				else
-				{
-					oldest = oldest->next;
-				}
-			}
+			g_logger_error("SVG cache eviction failed: '{}'", key);
+			return false;
 		}
 
-		// Clear the color attachment
-		framebuffer.bind();
-		GL::viewport(0, 0, framebuffer.width, framebuffer.height);
-		this->framebuffer.clearColorAttachmentRgba(cacheCurrentColorAttachment, Vec4{ 0, 0, 0, 0 });
-		framebuffer.clearDepthStencil();
-		this->cacheCurrentPos = Vec2{ 0, 0 };
+		atlases[data.colorAttachment].release(data.region);
+		stats.evictions++;
+		return true;
 	}
 
 	std::optional<_SvgCacheEntryInternal> SvgCache::getInternal(uint64 hash)
@@ -366,8 +310,8 @@ namespace MathAnim
 			.setWidth(width)
 			.setHeight(height)
 			.build();
-		// Add four cached textures and increment through them
-		// for more space when "growing" the svg cache
+		// Add four cached textures, each one gets its own atlas allocator
+		// and they get filled in order as the svg cache grows
 		framebuffer = FramebufferBuilder(width, height)
 			.addColorAttachment(cacheTexture)
 			.addColorAttachment(cacheTexture)
@@ -376,6 +320,12 @@ namespace MathAnim
 			.includeDepthStencil()
 			.generate();
 		cachedSvgs = {};
+
+		atlases.resize(framebuffer.colorAttachments.size());
+		for (AtlasAllocator& atlas : atlases)
+		{
+			atlas.init(width, height);
+		}
 	}
 
 	uint64 SvgCache::hash(const uint8* svgMd5, size_t svgMd5Length, float svgScale, float replacementTransform)
@@ -386,7 +336,8 @@ namespace MathAnim
 		hash = CMath::combineHash<int>(roundedSvgScale, hash);
 		int roundedTransform = (int)(replacementTransform * 100.0f);
 		hash = CMath::combineHash<int>(roundedTransform, hash);
-		uint64 md5Hash = std::hash<std::string>{}(std::string((const char*)svgMd5, svgMd5Length));
+		// Every glyph child looks itself up here each frame, so don't allocate a string for it
+		uint64 md5Hash = std::hash<std::string_view>{}(std::string_view((const char*)svgMd5, svgMd5Length));
 		hash = CMath::combineHash<uint64>(md5Hash, hash);
 		return hash;
 	}
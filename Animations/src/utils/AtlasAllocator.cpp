@@ -0,0 +1,183 @@
+#include "utils/AtlasAllocator.h"
+
+namespace MathAnim
+{
+	float AtlasStats::occupancy() const
+	{
+		uint64 totalArea = usedArea + freeArea;
+		return totalArea > 0 ? (float)((double)usedArea / (double)totalArea) : 0.0f;
+	}
+
+	float AtlasStats::fragmentation() const
+	{
+		return freeArea > 0 ? 1.0f - (float)((double)largestFreeArea / (double)freeArea) : 0.0f;
+	}
+
+	void AtlasAllocator::init(int width, int height)
+	{
+		this->width = width;
+		this->height = height;
+		clear();
+	}
+
+	void AtlasAllocator::clear()
+	{
+		freeRegions.clear();
+		freeRegions.push_back(AtlasRegion{ 0, 0, width, height });
+		usedArea = 0;
+		numAllocations = 0;
+	}
+
+	bool AtlasAllocator::allocate(int width, int height, AtlasRegion* outRegion)
+	{
+		if (width <= 0 || height <= 0)
+		{
+			return false;
+		}
+
+		// Best short side fit, use the free region that leaves the thinnest leftover strip
+		size_t bestIndex = freeRegions.size();
+		int bestShortSide = INT32_MAX;
+		int bestLongSide = INT32_MAX;
+		for (size_t i = 0; i < freeRegions.size(); i++)
+		{
+			const AtlasRegion& freeRegion = freeRegions[i];
+			if (freeRegion.width < width || freeRegion.height < height)
+			{
+				continue;
+			}
+
+			int leftoverX = freeRegion.width - width;
+			int leftoverY = freeRegion.height - height;
+			int shortSide = glm::min(leftoverX, leftoverY);
+			int longSide = glm::max(leftoverX, leftoverY);
+			if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+			{
+				bestIndex = i;
+				bestShortSide = shortSide;
+				bestLongSide = longSide;
+			}
+		}
+
+		if (bestIndex == freeRegions.size())
+		{
+			return false;
+		}
+
+		AtlasRegion freeRegion = freeRegions[bestIndex];
+		freeRegions[bestIndex] = freeRegions.back();
+		freeRegions.pop_back();
+
+		// Split the leftover L-shape along the shorter leftover axis so the bigger
+		// of the two new free regions stays as large as possible
+		int leftoverX = freeRegion.width - width;
+		int leftoverY = freeRegion.height - height;
+		AtlasRegion right;
+		AtlasRegion bottom;
+		if (leftoverX < leftoverY)
+		{
+			right = AtlasRegion{ freeRegion.x + width, freeRegion.y, leftoverX, height };
+			bottom = AtlasRegion{ freeRegion.x, freeRegion.y + height, freeRegion.width, leftoverY };
+		}
+		else
+		{
+			right = AtlasRegion{ freeRegion.x + width, freeRegion.y, leftoverX, freeRegion.height };
+			bottom = AtlasRegion{ freeRegion.x, freeRegion.y + height, width, leftoverY };
+		}
+
+		if (right.width > 0 && right.height > 0)
+		{
+			freeRegions.push_back(right);
+		}
+
+		if (bottom.width > 0 && bottom.height > 0)
+		{
+			freeRegions.push_back(bottom);
+		}
+
+		*outRegion = AtlasRegion{ freeRegion.x, freeRegion.y, width, height };
+		usedArea += (uint64)width * (uint64)height;
+		numAllocations++;
+		return true;
+	}
+
+	void AtlasAllocator::release(const AtlasRegion& region)
+	{
+		g_logger_assert(numAllocations > 0, "Released an atlas region that was never allocated.");
+		usedArea -= (uint64)region.width * (uint64)region.height;
+		numAllocations--;
+
+		if (numAllocations == 0)
+		{
+			// Skip the merging, the whole atlas is free again
+			clear();
+			return;
+		}
+
+		insertFreeRegion(region);
+	}
+
+	AtlasStats AtlasAllocator::getStats() const
+	{
+		AtlasStats stats = {};
+		stats.usedArea = usedArea;
+		stats.numAllocations = numAllocations;
+		stats.numFreeRegions = (uint32)freeRegions.size();
+		for (const AtlasRegion& freeRegion : freeRegions)
+		{
+			uint64 area = (uint64)freeRegion.width * (uint64)freeRegion.height;
+			stats.freeArea += area;
+			stats.largestFreeArea = glm::max(stats.largestFreeArea, area);
+		}
+
+		return stats;
+	}
+
+	// --------------------- Private ---------------------
+	void AtlasAllocator::insertFreeRegion(AtlasRegion region)
+	{
+		bool merged = true;
+		while (merged)
+		{
+			merged = false;
+			for (size_t i = 0; i < freeRegions.size(); i++)
+			{
+				const AtlasRegion& other = freeRegions[i];
+				bool sameColumn = other.x == region.x && other.width == region.width;
+				bool sameRow = other.y == region.y && other.height == region.height;
+				if (sameColumn && other.y + other.height == region.y)
+				{
+					region.y = other.y;
+					region.height += other.height;
+					merged = true;
+				}
+				else if (sameColumn && region.y + region.height == other.y)
+				{
+					region.height += other.height;
+					merged = true;
+				}
+				else if (sameRow && other.x + other.width == region.x)
+				{
+					region.x = other.x;
+					region.width += other.width;
+					merged = true;
+				}
+				else if (sameRow && region.x + region.width == other.x)
+				{
+					region.width += other.width;
+					merged = true;
+				}
+
+				if (merged)
+				{
+					// The merged region might line up with something else now, so start over
+					freeRegions[i] = freeRegions.back();
+					freeRegions.pop_back();
+					break;
+				}
+			}
+		}
+
+		freeRegions.push_back(region);
+	}
+}
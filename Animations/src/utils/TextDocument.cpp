@@ -0,0 +1,592 @@
+#include "utils/TextDocument.h"
+
+namespace MathAnim
+{
+	// Past this many queued patches it's cheaper to flatten the whole document again
+	static constexpr size_t maxFlattenedTextPatches = 64;
+
+	uint32 TextDocumentIter::operator*() const
+	{
+		return document->getCodepoint(bytePos);
+	}
+
+	TextDocumentIter& TextDocumentIter::operator++()
+	{
+		if (bytePos < document->getLength())
+		{
+			uint8 numBytes = 1;
+			document->getCodepoint(bytePos, &numBytes);
+			bytePos = glm::min(bytePos + glm::max(numBytes, (uint8)1), document->getLength());
+		}
+
+		return *this;
+	}
+
+	TextDocumentIter& TextDocumentIter::operator--()
+	{
+		if (bytePos > 0)
+		{
+			bytePos--;
+
+			// Step back over any continuation bytes to the beginning of the codepoint
+			for (int i = 0; i < 3 && bytePos > 0 && (document->getByte(bytePos) & 0xC0) == 0x80; i++)
+			{
+				bytePos--;
+			}
+		}
+
+		return *this;
+	}
+
+	void TextDocument::init(uint8 const* text, size_t numBytes)
+	{
+		g_logger_assert(numBytes <= UINT32_MAX, "Text documents can't be larger than 4GB.");
+
+		originalText.assign(text, text + numBytes);
+		originalNewlines.clear();
+		for (size_t i = 0; i < numBytes; i++)
+		{
+			if (text[i] == '\n')
+			{
+				originalNewlines.push_back((uint32)i);
+			}
+		}
+
+		addedText.clear();
+		addedNewlines.clear();
+
+		nodes.clear();
+		freeNodeIndices.clear();
+		root = NULL_NODE;
+		priorityState = 0x9E3779B9;
+		if (numBytes > 0)
+		{
+			root = createNode(makePiece(PieceBuffer::Original, 0, (uint32)numBytes));
+		}
+		length = getSubtreeBytes(root);
+		numNewlines = getSubtreeNewlines(root);
+
+		flattenedTextPatches.clear();
+		flattenedTextIsValid = false;
+	}
+
+	void TextDocument::free()
+	{
+		originalText = {};
+		addedText = {};
+		originalNewlines = {};
+		addedNewlines = {};
+		nodes = {};
+		freeNodeIndices = {};
+		root = NULL_NODE;
+		flattenedText = {};
+		flattenedTextPatches = {};
+		length = 0;
+		numNewlines = 0;
+		flattenedTextIsValid = false;
+	}
+
+	TextEdit TextDocument::insert(size_t byteOffset, uint8 const* text, size_t numBytes)
+	{
+		g_logger_assert(byteOffset <= length, "Cannot insert text past the end of the document.");
+
+		TextEdit res = {};
+		res.byteStart = byteOffset;
+		res.lineStart = getLineFromByte(byteOffset);
+		if (numBytes == 0)
+		{
+			return res;
+		}
+
+		uint32 addedStart = (uint32)addedText.size();
+		addedText.insert(addedText.end(), text, text + numBytes);
+		for (size_t i = 0; i < numBytes; i++)
+		{
+			if (text[i] == '\n')
+			{
+				addedNewlines.push_back(addedStart + (uint32)i);
+			}
+		}
+
+		if (flattenedTextIsValid)
+		{
+			FlattenedTextPatch patch = {};
+			patch.byteOffset = byteOffset;
+			patch.addedStart = addedStart;
+			patch.numBytesInserted = (uint32)numBytes;
+			queueFlattenedTextPatch(patch);
+		}
+
+		Piece newPiece = makePiece(PieceBuffer::Added, addedStart, (uint32)numBytes);
+		res.numBytesInserted = numBytes;
+		res.numLinesInserted = newPiece.numNewlines;
+
+		uint32 left, right;
+		split(root, byteOffset, &left, &right);
+		// Typing appends to the end of the added buffer right after the previous keystroke, so
+		// consecutive keystrokes just grow the piece in front of the cursor
+		if (!growLastPiece(left, newPiece))
+		{
+			left = merge(left, createNode(newPiece));
+		}
+		root = merge(left, right);
+
+		length += numBytes;
+		numNewlines += newPiece.numNewlines;
+
+		return res;
+	}
+
+	TextEdit TextDocument::remove(size_t byteOffset, size_t numBytes)
+	{
+		g_logger_assert(byteOffset + numBytes <= length, "Cannot remove text past the end of the document.");
+
+		TextEdit res = {};
+		res.byteStart = byteOffset;
+		res.lineStart = getLineFromByte(byteOffset);
+		if (numBytes == 0)
+		{
+			return res;
+		}
+
+		res.numBytesRemoved = numBytes;
+		res.numLinesRemoved = getLineFromByte(byteOffset + numBytes) - res.lineStart;
+
+		if (flattenedTextIsValid)
+		{
+			FlattenedTextPatch patch = {};
+			patch.byteOffset = byteOffset;
+			patch.numBytesRemoved = numBytes;
+			queueFlattenedTextPatch(patch);
+		}
+
+		uint32 left, middle, right;
+		split(root, byteOffset, &left, &middle);
+		split(middle, numBytes, &middle, &right);
+		freeNodes(middle);
+		root = merge(left, right);
+
+		length -= numBytes;
+		numNewlines -= res.numLinesRemoved;
+
+		return res;
+	}
+
+	uint8 TextDocument::getByte(size_t byteOffset) const
+	{
+		g_logger_assert(byteOffset < length, "Cannot read past the end of the document.");
+
+		PieceLocation location = findPiece(byteOffset);
+		Piece const& piece = nodes[location.node].piece;
+		return getBuffer(piece.buffer)[piece.start + (byteOffset - location.byteStart)];
+	}
+
+	uint32 TextDocument::getCodepoint(size_t byteOffset, uint8* outNumBytes) const
+	{
+		if (byteOffset >= length)
+		{
+			if (outNumBytes)
+			{
+				*outNumBytes = 0;
+			}
+			return 0;
+		}
+
+		uint8 leadByte = getByte(byteOffset);
+		uint8 numBytes = 1;
+		uint32 res = leadByte;
+		if ((leadByte & 0xE0) == 0xC0)
+		{
+			numBytes = 2;
+			res = leadByte & 0x1F;
+		}
+		else if ((leadByte & 0xF0) == 0xE0)
+		{
+			numBytes = 3;
+			res = leadByte & 0x0F;
+		}
+		else if ((leadByte & 0xF8) == 0xF0)
+		{
+			numBytes = 4;
+			res = leadByte & 0x07;
+		}
+
+		numBytes = (uint8)glm::min((size_t)numBytes, length - byteOffset);
+		for (uint8 i = 1; i < numBytes; i++)
+		{
+			res = (res << 6) | (getByte(byteOffset + i) & 0x3F);
+		}
+
+		if (outNumBytes)
+		{
+			*outNumBytes = numBytes;
+		}
+
+		return res;
+	}
+
+	std::string TextDocument::getText(size_t byteOffset, size_t numBytes) const
+	{
+		std::string res = std::string(numBytes, '\0');
+		copyText(byteOffset, numBytes, (uint8*)res.data());
+		return res;
+	}
+
+	void TextDocument::copyText(size_t byteOffset, size_t numBytes, uint8* outBuffer) const
+	{
+		g_logger_assert(byteOffset + numBytes <= length, "Cannot copy text past the end of the document.");
+
+		copyTextFrom(root, 0, byteOffset, numBytes, outBuffer);
+	}
+
+	uint8 const* TextDocument::getFlattenedText() const
+	{
+		if (!flattenedTextIsValid)
+		{
+			// Keep a null terminator at the end for anything that treats this as a C string
+			flattenedText.resize(length + 1);
+			copyText(0, length, flattenedText.data());
+			flattenedText[length] = '\0';
+			flattenedTextPatches.clear();
+			flattenedTextIsValid = true;
+		}
+
+		// Edits never go past the end of the document, so the null terminator stays at the end
+		for (FlattenedTextPatch const& patch : flattenedTextPatches)
+		{
+			auto patchStart = flattenedText.begin() + patch.byteOffset;
+			flattenedText.erase(patchStart, patchStart + patch.numBytesRemoved);
+
+			auto insertedText = addedText.begin() + patch.addedStart;
+			flattenedText.insert(flattenedText.begin() + patch.byteOffset, insertedText, insertedText + patch.numBytesInserted);
+		}
+		flattenedTextPatches.clear();
+
+		return flattenedText.data();
+	}
+
+	size_t TextDocument::getNumLines() const
+	{
+		return numNewlines + 1;
+	}
+
+	size_t TextDocument::getLineStart(size_t line) const
+	{
+		if (line == 0)
+		{
+			return 0;
+		}
+
+		if (line > numNewlines)
+		{
+			return length;
+		}
+
+		// Line N starts right after the Nth newline, walk down to the piece that has it
+		size_t newlineIndex = line - 1;
+		size_t byteStart = 0;
+		uint32 node = root;
+		while (true)
+		{
+			PieceNode const& pieceNode = nodes[node];
+			size_t leftNewlines = getSubtreeNewlines(pieceNode.left);
+			if (newlineIndex < leftNewlines)
+			{
+				node = pieceNode.left;
+				continue;
+			}
+
+			newlineIndex -= leftNewlines;
+			byteStart += getSubtreeBytes(pieceNode.left);
+			if (newlineIndex < pieceNode.piece.numNewlines)
+			{
+				break;
+			}
+
+			newlineIndex -= pieceNode.piece.numNewlines;
+			byteStart += pieceNode.piece.length;
+			node = pieceNode.right;
+		}
+
+		Piece const& piece = nodes[node].piece;
+		std::vector<uint32> const& newlines = getNewlines(piece.buffer);
+		size_t firstNewlineInPiece = (size_t)(std::lower_bound(newlines.begin(), newlines.end(), piece.start) - newlines.begin());
+		uint32 newlineOffset = newlines[firstNewlineInPiece + newlineIndex];
+
+		return byteStart + (newlineOffset - piece.start) + 1;
+	}
+
+	size_t TextDocument::getLineFromByte(size_t byteOffset) const
+	{
+		if (byteOffset >= length)
+		{
+			return numNewlines;
+		}
+
+		PieceLocation location = findPiece(byteOffset);
+		Piece const& piece = nodes[location.node].piece;
+		return location.newlineStart + countNewlines(piece.buffer, piece.start, (uint32)(byteOffset - location.byteStart));
+	}
+
+	TextDocumentIter TextDocument::makeIter(size_t byteOffset) const
+	{
+		TextDocumentIter res;
+		res.document = this;
+		res.bytePos = glm::min(byteOffset, length);
+		return res;
+	}
+
+	TextDocument::Piece TextDocument::makePiece(PieceBuffer buffer, uint32 start, uint32 numBytes) const
+	{
+		Piece res;
+		res.buffer = buffer;
+		res.start = start;
+		res.length = numBytes;
+		res.numNewlines = countNewlines(buffer, start, numBytes);
+		return res;
+	}
+
+	TextDocument::PieceLocation TextDocument::findPiece(size_t byteOffset) const
+	{
+		g_logger_assert(byteOffset < length, "Cannot find a piece past the end of the document.");
+
+		PieceLocation res = {};
+		uint32 node = root;
+		size_t offset = byteOffset;
+		while (true)
+		{
+			PieceNode const& pieceNode = nodes[node];
+			size_t leftBytes = getSubtreeBytes(pieceNode.left);
+			if (offset < leftBytes)
+			{
+				node = pieceNode.left;
+				continue;
+			}
+
+			offset -= leftBytes;
+			res.byteStart += leftBytes;
+			res.newlineStart += getSubtreeNewlines(pieceNode.left);
+			if (offset < pieceNode.piece.length)
+			{
+				res.node = node;
+				return res;
+			}
+
+			offset -= pieceNode.piece.length;
+			res.byteStart += pieceNode.piece.length;
+			res.newlineStart += pieceNode.piece.numNewlines;
+			node = pieceNode.right;
+		}
+	}
+
+	uint32 TextDocument::countNewlines(PieceBuffer buffer, uint32 start, uint32 numBytes) const
+	{
+		std::vector<uint32> const& newlines = getNewlines(buffer);
+		auto first = std::lower_bound(newlines.begin(), newlines.end(), start);
+		auto last = std::lower_bound(first, newlines.end(), start + numBytes);
+		return (uint32)(last - first);
+	}
+
+	void TextDocument::copyTextFrom(uint32 node, size_t nodeByteStart, size_t byteOffset, size_t numBytes, uint8* outBuffer) const
+	{
+		if (node == NULL_NODE)
+		{
+			return;
+		}
+
+		// Skip subtrees that don't overlap the range at all
+		PieceNode const& pieceNode = nodes[node];
+		size_t rangeEnd = byteOffset + numBytes;
+		if (nodeByteStart + pieceNode.numBytes <= byteOffset || nodeByteStart >= rangeEnd)
+		{
+			return;
+		}
+
+		copyTextFrom(pieceNode.left, nodeByteStart, byteOffset, numBytes, outBuffer);
+
+		Piece const& piece = pieceNode.piece;
+		size_t pieceStart = nodeByteStart + getSubtreeBytes(pieceNode.left);
+		size_t copyStart = glm::max(pieceStart, byteOffset);
+		size_t copyEnd = glm::min(pieceStart + piece.length, rangeEnd);
+		if (copyStart < copyEnd)
+		{
+			g_memory_copyMem(
+				outBuffer + (copyStart - byteOffset),
+				rangeEnd - copyStart,
+				(void*)(getBuffer(piece.buffer).data() + piece.start + (copyStart - pieceStart)),
+				copyEnd - copyStart
+			);
+		}
+
+		copyTextFrom(pieceNode.right, pieceStart + piece.length, byteOffset, numBytes, outBuffer);
+	}
+
+	uint32 TextDocument::createNode(Piece const& piece)
+	{
+		// Xorshift, the priorities only have to be random enough to keep the tree balanced
+		priorityState ^= priorityState << 13;
+		priorityState ^= priorityState >> 17;
+		priorityState ^= priorityState << 5;
+
+		PieceNode res;
+		res.piece = piece;
+		res.left = NULL_NODE;
+		res.right = NULL_NODE;
+		res.priority = priorityState;
+		res.numPieces = 1;
+		res.numBytes = piece.length;
+		res.numNewlines = piece.numNewlines;
+
+		if (!freeNodeIndices.empty())
+		{
+			uint32 node = freeNodeIndices.back();
+			freeNodeIndices.pop_back();
+			nodes[node] = res;
+			return node;
+		}
+
+		g_logger_assert(nodes.size() < NULL_NODE, "Text document has too many pieces.");
+		nodes.push_back(res);
+		return (uint32)(nodes.size() - 1);
+	}
+
+	void TextDocument::freeNodes(uint32 node)
+	{
+		if (node == NULL_NODE)
+		{
+			return;
+		}
+
+		freeNodes(nodes[node].left);
+		freeNodes(nodes[node].right);
+		freeNodeIndices.push_back(node);
+	}
+
+	void TextDocument::updateNode(uint32 node)
+	{
+		PieceNode& pieceNode = nodes[node];
+		pieceNode.numPieces = getSubtreePieces(pieceNode.left) + 1 + getSubtreePieces(pieceNode.right);
+		pieceNode.numBytes = getSubtreeBytes(pieceNode.left) + pieceNode.piece.length + getSubtreeBytes(pieceNode.right);
+		pieceNode.numNewlines = getSubtreeNewlines(pieceNode.left) + pieceNode.piece.numNewlines + getSubtreeNewlines(pieceNode.right);
+	}
+
+	uint32 TextDocument::merge(uint32 left, uint32 right)
+	{
+		if (left == NULL_NODE)
+		{
+			return right;
+		}
+
+		if (right == NULL_NODE)
+		{
+			return left;
+		}
+
+		if (nodes[left].priority > nodes[right].priority)
+		{
+			uint32 newRight = merge(nodes[left].right, right);
+			nodes[left].right = newRight;
+			updateNode(left);
+			return left;
+		}
+
+		uint32 newLeft = merge(left, nodes[right].left);
+		nodes[right].left = newLeft;
+		updateNode(right);
+		return right;
+	}
+
+	void TextDocument::split(uint32 node, size_t byteOffset, uint32* outLeft, uint32* outRight)
+	{
+		if (node == NULL_NODE)
+		{
+			*outLeft = NULL_NODE;
+			*outRight = NULL_NODE;
+			return;
+		}
+
+		// NOTE: Splitting a piece creates a node, so don't hold on to references into nodes across calls
+		size_t leftBytes = getSubtreeBytes(nodes[node].left);
+		uint32 pieceLength = nodes[node].piece.length;
+		if (byteOffset <= leftBytes)
+		{
+			uint32 newLeft;
+			split(nodes[node].left, byteOffset, outLeft, &newLeft);
+			nodes[node].left = newLeft;
+			updateNode(node);
+			*outRight = node;
+			return;
+		}
+
+		if (byteOffset >= leftBytes + pieceLength)
+		{
+			uint32 newRight;
+			split(nodes[node].right, byteOffset - leftBytes - pieceLength, &newRight, outRight);
+			nodes[node].right = newRight;
+			updateNode(node);
+			*outLeft = node;
+			return;
+		}
+
+		// The split lands inside this node's piece. This node keeps the front half and
+		// the back half becomes a new node in the right tree.
+		uint32 offsetInPiece = (uint32)(byteOffset - leftBytes);
+		Piece piece = nodes[node].piece;
+		Piece front = makePiece(piece.buffer, piece.start, offsetInPiece);
+		Piece back = piece;
+		back.start += offsetInPiece;
+		back.length -= offsetInPiece;
+		back.numNewlines -= front.numNewlines;
+
+		uint32 backNode = createNode(back);
+		uint32 right = nodes[node].right;
+		nodes[node].piece = front;
+		nodes[node].right = NULL_NODE;
+		updateNode(node);
+
+		*outLeft = node;
+		*outRight = merge(backNode, right);
+	}
+
+	bool TextDocument::growLastPiece(uint32 node, Piece const& piece)
+	{
+		if (node == NULL_NODE)
+		{
+			return false;
+		}
+
+		if (nodes[node].right != NULL_NODE)
+		{
+			if (!growLastPiece(nodes[node].right, piece))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			Piece& lastPiece = nodes[node].piece;
+			if (lastPiece.buffer != piece.buffer || lastPiece.start + lastPiece.length != piece.start)
+			{
+				return false;
+			}
+
+			lastPiece.length += piece.length;
+			lastPiece.numNewlines += piece.numNewlines;
+		}
+
+		updateNode(node);
+		return true;
+	}
+
+	void TextDocument::queueFlattenedTextPatch(FlattenedTextPatch const& patch)
+	{
+		if (flattenedTextPatches.size() >= maxFlattenedTextPatches)
+		{
+			flattenedTextPatches.clear();
+			flattenedTextIsValid = false;
+			return;
+		}
+
+		flattenedTextPatches.push_back(patch);
+	}
+}
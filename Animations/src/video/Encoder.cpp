@@ -1,7 +1,6 @@
 #include "video/Encoder.h"
 #include "multithreading/GlobalThreadPool.h"
 #include "core/Application.h"
-#include "platform/Platform.h"
 
 extern "C"
 {
@@ -30,23 +29,22 @@ static void writeIvfFrameHeader(AV1Context* const context, const size_t frame_si
 
 // sends a single picture, tries to avoid the stack since the library already uses so much
 static void sendFrame(
-	const EbSvtIOFormat* pic,
+	EbSvtIOFormat* pic,
+	EbBufferHeaderType* sendBuffer,
 	const AV1Context* const c,
 	const size_t index,
-	const uint8* yChannel,
-	size_t yChannelSize,
-	const uint8* uChannel,
-	size_t uChannelSize,
-	const uint8* vChannel,
-	size_t vChannelSize);
+	uint8* yuvPixels);
 
 // receives the whole ivf to fout in it's own thread so we don't have to try to track alt refs
 static void* ivfEncodeThread(void* p);
-static EbSvtIOFormat* allocateIoFormat(const size_t width, const size_t height);
-static void freeIoFormat(EbSvtIOFormat* const pic);
+static void initIoFormat(EbSvtIOFormat* pic, const size_t width, const size_t height);
 
 namespace MathAnim
 {
+	// Number of frames that can be waiting to be encoded at once. Once the ring is full
+	// pushing another frame blocks until the encoder catches up.
+	static constexpr int NUM_RING_FRAMES = 4;
+
 	// ------------------------ Internal Functions ------------------------
 	static void waitForVideoEncodingToFinish(void* data, size_t dataSize);
 
@@ -57,7 +55,8 @@ namespace MathAnim
 		int outputHeight,
 		int outputFramerate,
 		size_t totalNumFramesInVideo,
-		VideoEncoderFlags flags)
+		VideoEncoderFlags flags,
+		int crf)
 	{
 		VideoEncoder* output = g_memory_new VideoEncoder();
 
@@ -67,7 +66,9 @@ namespace MathAnim
 		output->frameCounter = 0;
 		output->logProgress = ((uint8)flags & (uint8)VideoEncoderFlags::LogProgress);
 		output->isEncoding = true;
-		output->numPushedFrames = 0;
+		output->sentAllFrames = false;
+		output->percentComplete = 0.0f;
+		output->totalFrames = 0;
 
 		size_t outputFilenameLength = std::strlen(outputFilename);
 		output->filename = (uint8*)g_memory_allocate(sizeof(uint8) * (outputFilenameLength + 1));
@@ -109,7 +110,7 @@ namespace MathAnim
 			svt_av1_enc_parse_parameter(enc_params, "irefresh-type", "kf");
 			svt_av1_enc_parse_parameter(enc_params, "preset", "12");
 			svt_av1_enc_parse_parameter(enc_params, "rc", "crf");
-			svt_av1_enc_parse_parameter(enc_params, "crf", "28");
+			svt_av1_enc_parse_parameter(enc_params, "crf", std::to_string(crf).c_str());
 			svt_av1_enc_parse_parameter(enc_params, "lp", "2");
 
 			// send the parameters to the encoder, and then initialize the encoder
@@ -125,20 +126,18 @@ namespace MathAnim
 			free(enc_params);
 		}
 
-		// Create a memmapped file for video frame cache
+		// Allocate the frame ring, the frames are reused for the whole video
 		size_t yChannelSize = outputWidth * outputHeight;
 		size_t uChannelSize = outputWidth / 2 * outputHeight / 2;
 		size_t vChannelSize = uChannelSize;
-		size_t frameSize = yChannelSize + uChannelSize + vChannelSize;
-		size_t cacheSize = frameSize * totalNumFramesInVideo;
-		std::string directory = Application::getTmpDir().string();
-		output->videoFrameCache = Platform::createTmpMemMappedFile(directory, cacheSize);
-		if (!output->videoFrameCache)
-		{
-			// TODO: Error handling
-			g_logger_error("Failed to create memmapped file for video frame cache. Aborting export.");
-			return nullptr;
-		}
+		output->frameSize = yChannelSize + uChannelSize + vChannelSize;
+		output->frameRing = (uint8*)g_memory_allocate(output->frameSize * NUM_RING_FRAMES);
+		g_logger_assert(output->frameRing != nullptr, "Ran out of RAM.");
+		output->ringReadIndex = 0;
+		output->ringWriteIndex = 0;
+		output->numQueuedFrames = 0;
+		output->numFramesSent = 0;
+		output->frameAcquired = false;
 
 		AV1Context* p = (AV1Context*)g_memory_allocate(sizeof(AV1Context));
 		p->svtHandle = svt_handle;
@@ -179,7 +178,17 @@ namespace MathAnim
 				// This is kind of gross, we launch another thread using the thread pool to wait for it to finish
 				// so the main window can finish closing then we finish encoding the video in the background
 				// and clean up memory after everything finishes.
-				Application::threadPool()->queueTask(waitForVideoEncodingToFinish, "WaitForVideoEncoderToFinish", (void*)encoder, sizeof(VideoEncoder));
+				// NOTE: This can run for as long as the rest of the encode, so it's marked as blocking to
+				//       keep threads that are waiting on other tasks from picking it up.
+				Application::threadPool()->queueTask(
+					waitForVideoEncodingToFinish,
+					"WaitForVideoEncoderToFinish",
+					(void*)encoder,
+					sizeof(VideoEncoder),
+					Priority::None,
+					nullptr,
+					true
+				);
 			}
 			else
 			{
@@ -198,6 +207,13 @@ namespace MathAnim
 		}
 	}
 
+	uint64 VideoEncoder::waitForFramesSent(uint64 lastNumFramesSent, std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(encodeMtx);
+		frameSentCv.wait_for(lock, timeout, [&] { return numFramesSent > lastNumFramesSent || sentAllFrames.load(); });
+		return numFramesSent;
+	}
+
 	void VideoEncoder::destroy()
 	{
 		if (this->finalizeThread.joinable())
@@ -221,7 +237,10 @@ namespace MathAnim
 			g_memory_free(av1Context);
 		}
 
-		Platform::freeMemMappedFile(videoFrameCache);
+		if (frameRing)
+		{
+			g_memory_free(frameRing);
+		}
 
 		av1Context = nullptr;
 		filename = nullptr;
@@ -231,36 +250,48 @@ namespace MathAnim
 		height = 0;
 		framerate = 0;
 		logProgress = false;
-		videoFrameCache = nullptr;
-		numPushedFrames = 0;
+		frameRing = nullptr;
+		frameSize = 0;
+		ringReadIndex = 0;
+		ringWriteIndex = 0;
+		numQueuedFrames = 0;
+		numFramesSent = 0;
 	}
 
-	void VideoEncoder::pushYuvFrame(uint8* pixels, size_t pixelsSize)
+	void VideoEncoder::pushYuvFrame(const uint8* pixels, size_t pixelsSize)
+	{
+		g_logger_assert(pixelsSize == frameSize, "Invalid pixel buffer for video encoding. Width and height do not match pixelsLength.");
+
+		uint8* frame = acquireYuvFrame();
+		g_memory_copyMem(frame, frameSize, (void*)pixels, pixelsSize);
+		submitYuvFrame();
+	}
+
+	uint8* VideoEncoder::acquireYuvFrame()
+	{
+		std::unique_lock<std::mutex> lock(encodeMtx);
+		g_logger_assert(isEncoding.load(), "Tried to push a video frame after the encoder was finalized.");
+		g_logger_assert(!frameAcquired, "Tried to acquire a video frame before submitting the previous one.");
+
+		// Backpressure, don't let the renderer get more than a few frames ahead of the encoder
+		frameFreedCv.wait(lock, [&] { return numQueuedFrames < NUM_RING_FRAMES; });
+
+		frameAcquired = true;
+		return frameRing + (size_t)ringWriteIndex * frameSize;
+	}
+
+	void VideoEncoder::submitYuvFrame()
 	{
-		size_t yChannelSize = width * height * sizeof(uint8);
-		size_t uChannelSize = width / 2 * height / 2 * sizeof(uint8);
-		size_t vChannelSize = uChannelSize;
-		size_t framePixelsSize = yChannelSize + uChannelSize + vChannelSize;
-		g_logger_assert(pixelsSize == framePixelsSize, "Invalid pixel buffer for video encoding. Width and height do not match pixelsLength.");
-
-		// Get offset into memmapped file for video frame
-		size_t pixelOffset = this->numPushedFrames * framePixelsSize;
-		this->numPushedFrames++;
-
-		g_logger_assert(pixelOffset < this->videoFrameCache->dataSize, "Invalid pixel offset for video frame. Tried to push more frames than allocated for this video export.");
-		
-		VideoFrame frame;
-		frame.pixels = this->videoFrameCache->data + pixelOffset;
-		size_t framePixelsSizeLeft = this->videoFrameCache->dataSize - (frame.pixels - this->videoFrameCache->data);
-		g_memory_copyMem(frame.pixels, framePixelsSizeLeft, pixels, pixelsSize);
-		frame.pixelsSize = pixelsSize;
-
-		// Push frame onto queue
 		{
 			std::lock_guard<std::mutex> lock(encodeMtx);
-			queuedFrames.push(frame);
+			g_logger_assert(frameAcquired, "Tried to submit a video frame that was never acquired.");
+
+			frameAcquired = false;
+			ringWriteIndex = (ringWriteIndex + 1) % NUM_RING_FRAMES;
+			numQueuedFrames++;
 			totalFrames++;
 		}
+		frameQueuedCv.notify_one();
 	}
 
 	// ---------------- Internal functions ----------------
@@ -279,25 +310,13 @@ namespace MathAnim
 
 	void VideoEncoder::threadSafeFinalize()
 	{
-		// Stop the encoding loop
+		// Wait for queued frames to finish encoding, then stop the encoding loop
 		{
-			// Wait for queued frames to finish encoding
-			while (true)
-			{
-				std::lock_guard<std::mutex> lock(encodeMtx);
-				if (queuedFrames.size() == 0)
-				{
-					g_logger_info("Lock has been freed.");
-					break;
-				}
-			}
-
-			bool expected = isEncoding.load();
-			while (!isEncoding.compare_exchange_strong(expected, false))
-			{
-				expected = isEncoding.load();
-			}
+			std::unique_lock<std::mutex> lock(encodeMtx);
+			frameFreedCv.wait(lock, [&] { return numQueuedFrames == 0; });
+			isEncoding = false;
 		}
+		frameQueuedCv.notify_all();
 
 		if (thread.joinable())
 		{
@@ -308,6 +327,11 @@ namespace MathAnim
 		EbBufferHeaderType eofFlags = { 0 };
 		eofFlags.flags = EB_BUFFERFLAG_EOS;
 		svt_av1_enc_send_picture(av1Context->svtHandle, &eofFlags);
+		{
+			std::lock_guard<std::mutex> lock(encodeMtx);
+			sentAllFrames = true;
+		}
+		frameSentCv.notify_all();
 
 		// wait for all of the frames to finish writing out
 		//pthread_join(receive_threads, NULL);
@@ -331,63 +355,46 @@ namespace MathAnim
 
 	void VideoEncoder::encodeThreadLoop()
 	{
-		EbSvtIOFormat* pic = allocateIoFormat(width, height);
+		EbSvtIOFormat pic;
+		initIoFormat(&pic, width, height);
+		EbBufferHeaderType sendBuffer;
 		size_t frameIndex = 0;
 
-		while (isEncoding.load())
+		while (true)
 		{
-			VideoFrame nextFrame = {};
-			nextFrame.pixels = nullptr;
+			uint8* framePixels = nullptr;
 			{
-				std::lock_guard<std::mutex> lock(encodeMtx);
-				if (queuedFrames.size() == 0)
+				std::unique_lock<std::mutex> lock(encodeMtx);
+				frameQueuedCv.wait(lock, [&] { return numQueuedFrames > 0 || !isEncoding.load(); });
+				if (numQueuedFrames == 0)
 				{
-					continue;
+					// Finalized and every frame has been sent
+					break;
 				}
 
-				nextFrame = queuedFrames.front();
-				queuedFrames.pop();
-			}
-
-			if (!nextFrame.pixels)
-			{
-				g_logger_warning("Queued video frame had nullptr. Skipping that frame.");
-				continue;
+				// NOTE: The frame stays counted as queued while it's being sent, so
+				//       acquireYuvFrame can't hand it out again until we're done with it
+				framePixels = frameRing + (size_t)ringReadIndex * frameSize;
 			}
 
-			// send the individual frames to the encoder
-			size_t yChannelSize = width * height * sizeof(uint8);
-			size_t uChannelSize = width / 2 * height / 2 * sizeof(uint8);
-			size_t vChannelSize = width / 2 * height / 2 * sizeof(uint8);
-			sendFrame(
-				pic,
-				av1Context,
-				frameIndex,
-				nextFrame.pixels,
-				yChannelSize,
-				nextFrame.pixels + yChannelSize,
-				uChannelSize,
-				nextFrame.pixels + yChannelSize + uChannelSize,
-				vChannelSize
-			);
+			sendFrame(&pic, &sendBuffer, av1Context, frameIndex, framePixels);
 			frameIndex++;
 
-			// NOTE: No need to free the pixels since they're mapped to a file
-			// and will be freed automatically when the file is deleted
-
-			if (logProgress && ((frameCounter % framerate) == 0))
 			{
-				g_logger_info("{} second(s) encoded.", (frameCounter / 60));
+				std::lock_guard<std::mutex> lock(encodeMtx);
+				ringReadIndex = (ringReadIndex + 1) % NUM_RING_FRAMES;
+				numQueuedFrames--;
+				numFramesSent++;
 			}
+			frameFreedCv.notify_all();
+			frameSentCv.notify_all();
 
-			size_t usedRamExpected = approxRamUsed.load();
-			while (!approxRamUsed.compare_exchange_strong(usedRamExpected, usedRamExpected - nextFrame.pixelsSize))
+			if (logProgress && ((frameIndex % framerate) == 0))
 			{
-				usedRamExpected = approxRamUsed.load();
+				g_logger_info("{} second(s) encoded.", (frameIndex / framerate));
 			}
 		}
 
-		freeIoFormat(pic);
 		g_logger_info("Video Encoding loop finished.");
 	}
 }
@@ -439,35 +446,29 @@ static void writeIvfFrameHeader(AV1Context* const context, const size_t frame_si
 }
 
 static void sendFrame(
-	const EbSvtIOFormat* pic,
+	EbSvtIOFormat* pic,
+	EbBufferHeaderType* sendBuffer,
 	const AV1Context* const c,
 	const size_t index,
-	const uint8* yChannel,
-	size_t yChannelSize,
-	const uint8* uChannel,
-	size_t uChannelSize,
-	const uint8* vChannel,
-	size_t vChannelSize)
+	uint8* yuvPixels)
 {
-	// This memory is managed by av1, so we don't use g_memory_allocate here
-	EbBufferHeaderType* const sendBuffer = (EbBufferHeaderType*)g_memory_allocate(sizeof(EbBufferHeaderType));
 	g_memory_zeroMem(sendBuffer, sizeof(EbBufferHeaderType));
 	sendBuffer->size = sizeof(EbBufferHeaderType);
 	sendBuffer->p_buffer = (uint8*)pic;
 	sendBuffer->pic_type = EB_AV1_INVALID_PICTURE;
 	sendBuffer->pts = index;
 
-	// Copy the yuv channels to av1's frame buffer
-	const uint8_t* y = pic->luma;
-	const uint8_t* u = pic->cb;
-	const uint8_t* v = pic->cr;
-	g_memory_copyMem((void*)y, yChannelSize, (void*)yChannel, yChannelSize);
-	g_memory_copyMem((void*)u, uChannelSize, (void*)uChannel, uChannelSize);
-	g_memory_copyMem((void*)v, vChannelSize, (void*)vChannel, vChannelSize);
+	// Point the picture straight at the frame in the ring instead of copying it. svt copies
+	// the input into its own picture buffers before svt_av1_enc_send_picture returns, so the
+	// ring frame can be reused as soon as this function is done.
+	size_t yChannelSize = c->width * c->height;
+	size_t uChannelSize = (c->width / 2) * (c->height / 2);
+	pic->luma = yuvPixels;
+	pic->cb = yuvPixels + yChannelSize;
+	pic->cr = yuvPixels + yChannelSize + uChannelSize;
 
 	// send the frame to the encoder
 	svt_av1_enc_send_picture(c->svtHandle, sendBuffer);
-	g_memory_free(sendBuffer);
 }
 
 static void* ivfEncodeThread(void* p)
@@ -484,13 +485,19 @@ static void* ivfEncodeThread(void* p)
 	// setup some variables for handling non-visible frames, based on aom's code
 	size_t frame_size = 0;
 	off_t  ivf_header_position = 0;
+	uint64 numFramesSeen = 0;
 	do
 	{
 		// retrieve the next ivf packet
-		switch (svt_av1_enc_get_packet(svt_handle, &receive_buffer, 0))
+		// Once every picture has been sent svt blocks until the next packet is ready. Before
+		// that it returns immediately, so sleep until another picture goes in. The timeout only
+		// matters if svt finishes packets while the encode loop is stuck sending a picture.
+		switch (svt_av1_enc_get_packet(svt_handle, &receive_buffer, ctx->videoEncoder->allFramesSent() ? 1 : 0))
 		{
 		case EB_ErrorMax: fprintf(stderr, "Error: EB_ErrorMax\n");// pthread_exit(NULL);
-		case EB_NoErrorEmptyQueue: continue;
+		case EB_NoErrorEmptyQueue:
+			numFramesSeen = ctx->videoEncoder->waitForFramesSent(numFramesSeen, std::chrono::milliseconds(50));
+			continue;
 		default: break;
 		}
 		const uint32_t flags = receive_buffer->flags;
@@ -532,11 +539,9 @@ static void* ivfEncodeThread(void* p)
 	return NULL;
 }
 
-static EbSvtIOFormat* allocateIoFormat(const size_t width, const size_t height)
+static void initIoFormat(EbSvtIOFormat* pic, const size_t width, const size_t height)
 {
-	EbSvtIOFormat* pic = (EbSvtIOFormat*)g_memory_allocate(sizeof(EbSvtIOFormat));
-	g_logger_assert(pic != nullptr, "Ran out of RAM.");
-
+	// The planes are set per frame in sendFrame, they point into the encoder's frame ring
 	g_memory_zeroMem(pic, sizeof(EbSvtIOFormat));
 	pic->y_stride = (uint32)width;
 	pic->cr_stride = (uint32)(width / 2);
@@ -545,19 +550,4 @@ static EbSvtIOFormat* allocateIoFormat(const size_t width, const size_t height)
 	pic->height = (uint32)height;
 	pic->color_fmt = EB_YUV420;
 	pic->bit_depth = EB_EIGHT_BIT;
-	pic->luma = (uint8*)g_memory_allocate(height * pic->y_stride * sizeof(uint8));
-	g_memory_zeroMem(pic->luma, height * pic->y_stride * sizeof(uint8));
-	pic->cb = (uint8*)g_memory_allocate(height * pic->cb_stride * sizeof(uint8));
-	g_memory_zeroMem(pic->cb, height * pic->cb_stride * sizeof(uint8));
-	pic->cr = (uint8*)g_memory_allocate(height * pic->cr_stride * sizeof(uint8));
-	g_memory_zeroMem(pic->cr, height * pic->cr_stride * sizeof(uint8));
-	return pic;
 }
-
-static void freeIoFormat(EbSvtIOFormat* const pic)
-{
-	g_memory_free(pic->luma);
-	g_memory_free(pic->cb);
-	g_memory_free(pic->cr);
-	g_memory_free(pic);
-}
\ No newline at end of file
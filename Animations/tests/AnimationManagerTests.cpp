@@ -1,12 +1,24 @@
 #ifdef _MATH_ANIM_TESTS
 #include "AnimationManagerTests.h"
 
+#include "core.h"
+#include "animation/Animation.h"
+#include "animation/AnimationManager.h"
+#include "math/CMath.h"
+
 using namespace CppUtils;
 
 namespace MathAnim
 {
 	namespace AnimationManagerTests
 	{
+		// -------------------- Constants --------------------
+		static const Vec3 MOVE_TO_TARGET = Vec3{ 4.0f, 2.0f, 0.0f };
+		static const Vec2 SCALE_TARGET = Vec2{ 2.0f, 3.0f };
+
+		// -------------------- Private functions --------------------
+		static AnimationManagerData* createScene(AnimObjId* cubeId, AnimId* moveToId, AnimId* scaleId);
+
 		// -------------------- Tests --------------------
 		DEFINE_TEST(dummyOne)
 		{
@@ -18,14 +30,202 @@ namespace MathAnim
 			END_TEST;
 		}
 
+		DEFINE_TEST(scrubbingBackwardsMatchesForwardEvaluation)
+		{
+			AnimObjId cubeId;
+			AnimId moveToId, scaleId;
+			AnimationManagerData* am = createScene(&cubeId, &moveToId, &scaleId);
+
+			AnimationManager::resetToFrame(am, 90);
+			const AnimObject* cube = AnimationManager::getObject(am, cubeId);
+			ASSERT_NOT_NULL(cube);
+			Vec3 positionAtFrame90 = cube->position;
+			Vec3 scaleAtFrame90 = cube->scale;
+
+			// Jump far ahead so checkpoints get built, then come back
+			AnimationManager::resetToFrame(am, 1'000);
+			AnimationManager::resetToFrame(am, 90);
+			cube = AnimationManager::getObject(am, cubeId);
+
+			ASSERT_TRUE(cube->position == positionAtFrame90);
+			ASSERT_TRUE(cube->scale == scaleAtFrame90);
+
+			AnimationManager::free(am);
+			END_TEST;
+		}
+
+		DEFINE_TEST(finishedAnimationsAreRestoredFromCheckpoints)
+		{
+			AnimObjId cubeId;
+			AnimId moveToId, scaleId;
+			AnimationManagerData* am = createScene(&cubeId, &moveToId, &scaleId);
+
+			AnimationManager::resetToFrame(am, 1'000);
+			const AnimObject* cube = AnimationManager::getObject(am, cubeId);
+			ASSERT_NOT_NULL(cube);
+			ASSERT_TRUE(CMath::compare(cube->position, MOVE_TO_TARGET, 0.0001f));
+			ASSERT_TRUE(CMath::compare(CMath::vector2From3(cube->scale), SCALE_TARGET, 0.0001f));
+
+			// Evaluating the same frame twice should give the exact same result
+			Vec3 position = cube->position;
+			AnimationManager::resetToFrame(am, 1'000);
+			cube = AnimationManager::getObject(am, cubeId);
+			ASSERT_TRUE(cube->position == position);
+
+			AnimationManager::free(am);
+			END_TEST;
+		}
+
+		DEFINE_TEST(editingAnimationInvalidatesLaterCheckpoints)
+		{
+			AnimObjId cubeId;
+			AnimId moveToId, scaleId;
+			AnimationManagerData* am = createScene(&cubeId, &moveToId, &scaleId);
+
+			AnimationManager::resetToFrame(am, 1'000);
+
+			// Push the scale animation past the frame we're going to evaluate
+			AnimationManager::setAnimationTime(am, scaleId, 1'200, 60);
+			AnimationManager::endFrame(am);
+
+			AnimationManager::resetToFrame(am, 1'000);
+			const AnimObject* cube = AnimationManager::getObject(am, cubeId);
+			ASSERT_NOT_NULL(cube);
+			ASSERT_TRUE(CMath::compare(cube->position, MOVE_TO_TARGET, 0.0001f));
+			ASSERT_TRUE(cube->scale == cube->_scaleStart);
+
+			// Modifying an animation in place should also be picked up
+			Animation* moveTo = AnimationManager::getMutableAnimation(am, moveToId);
+			ASSERT_NOT_NULL(moveTo);
+			moveTo->as.moveTo.target = Vec3{ -1.0f, -1.0f, 0.0f };
+			AnimationManager::invalidateAnimation(am, moveToId);
+
+			AnimationManager::resetToFrame(am, 1'000);
+			cube = AnimationManager::getObject(am, cubeId);
+			ASSERT_TRUE(CMath::compare(cube->position, Vec3{ -1.0f, -1.0f, 0.0f }, 0.0001f));
+
+			AnimationManager::free(am);
+			END_TEST;
+		}
+
+		DEFINE_TEST(childIndexFollowsHierarchyChanges)
+		{
+			AnimationManagerData* am = AnimationManager::create();
+
+			AnimObject parent = AnimObject::createDefault(am, AnimObjectTypeV1::Square);
+			AnimObject otherParent = AnimObject::createDefault(am, AnimObjectTypeV1::Square);
+			AnimationManager::addAnimObject(am, parent);
+			AnimationManager::addAnimObject(am, otherParent);
+			AnimationManager::endFrame(am);
+
+			AnimObjId childIds[3];
+			for (int i = 0; i < 3; i++)
+			{
+				AnimObject child = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::Square, parent.id);
+				childIds[i] = child.id;
+				AnimationManager::addAnimObject(am, child);
+			}
+
+			// Queued children should already be visible
+			ASSERT_EQUAL(AnimationManager::getChildren(am, parent.id).size(), 3);
+			AnimationManager::endFrame(am);
+
+			std::vector<AnimObjId> children = AnimationManager::getChildren(am, parent.id);
+			ASSERT_EQUAL(children.size(), 3);
+			for (int i = 0; i < 3; i++)
+			{
+				ASSERT_EQUAL(children[i], childIds[i]);
+			}
+			ASSERT_EQUAL(AnimationManager::getNextSibling(am, childIds[0]), childIds[1]);
+			ASSERT_EQUAL(AnimationManager::getNextSibling(am, childIds[2]), childIds[2]);
+
+			// Reparenting moves the child to the end of its new parent's children
+			AnimationManager::setParent(am, childIds[1], otherParent.id);
+			ASSERT_EQUAL(AnimationManager::getNextSibling(am, childIds[0]), childIds[2]);
+			children = AnimationManager::getChildren(am, otherParent.id);
+			ASSERT_EQUAL(children.size(), 1);
+			ASSERT_EQUAL(children[0], childIds[1]);
+
+			// Removing a parent removes its whole subtree from the index
+			AnimationManager::removeAnimObject(am, parent.id);
+			AnimationManager::endFrame(am);
+			ASSERT_NULL(AnimationManager::getObject(am, childIds[0]));
+			ASSERT_EQUAL(AnimationManager::getChildren(am, parent.id).size(), 0);
+			ASSERT_EQUAL(AnimationManager::getChildren(am, NULL_ANIM_OBJECT).size(), 1);
+
+			AnimationManager::free(am);
+			END_TEST;
+		}
+
+		DEFINE_TEST(objectsRemovedInTheFrameTheyWereAddedAreDropped)
+		{
+			AnimationManagerData* am = AnimationManager::create();
+
+			AnimObject parent = AnimObject::createDefault(am, AnimObjectTypeV1::Square);
+			AnimationManager::addAnimObject(am, parent);
+			AnimationManager::endFrame(am);
+
+			// Same thing regenerating an object's children twice in one frame does
+			AnimObject firstChild = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::Square, parent.id, true);
+			AnimationManager::addAnimObject(am, firstChild);
+			AnimObject grandchild = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::Square, firstChild.id, true);
+			AnimationManager::addAnimObject(am, grandchild);
+			AnimationManager::removeAnimObject(am, firstChild.id);
+			AnimObject secondChild = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::Square, parent.id, true);
+			AnimationManager::addAnimObject(am, secondChild);
+			AnimationManager::endFrame(am);
+
+			ASSERT_NULL(AnimationManager::getObject(am, firstChild.id));
+			ASSERT_NULL(AnimationManager::getObject(am, grandchild.id));
+			std::vector<AnimObjId> children = AnimationManager::getChildren(am, parent.id);
+			ASSERT_EQUAL(children.size(), 1);
+			ASSERT_EQUAL(children[0], secondChild.id);
+
+			AnimationManager::free(am);
+			END_TEST;
+		}
+
 		void setupTestSuite()
 		{
 			Tests::TestSuite& testSuite = Tests::addTestSuite("AnimationManager");
 
 			ADD_TEST(testSuite, dummyOne);
 			ADD_TEST(testSuite, dummyTwo);
+			ADD_TEST(testSuite, scrubbingBackwardsMatchesForwardEvaluation);
+			ADD_TEST(testSuite, finishedAnimationsAreRestoredFromCheckpoints);
+			ADD_TEST(testSuite, editingAnimationInvalidatesLaterCheckpoints);
+			ADD_TEST(testSuite, childIndexFollowsHierarchyChanges);
+			ADD_TEST(testSuite, objectsRemovedInTheFrameTheyWereAddedAreDropped);
+		}
+
+		// -------------------- Private functions --------------------
+		static AnimationManagerData* createScene(AnimObjId* cubeId, AnimId* moveToId, AnimId* scaleId)
+		{
+			AnimationManagerData* am = AnimationManager::create();
+
+			AnimObject cube = AnimObject::createDefault(am, AnimObjectTypeV1::Cube);
+			*cubeId = cube.id;
+			AnimationManager::addAnimObject(am, cube);
+
+			// Spread the animations out over several checkpoint intervals
+			Animation moveTo = Animation::createDefault(AnimTypeV1::MoveTo, 30, 120);
+			moveTo.as.moveTo.object = *cubeId;
+			moveTo.as.moveTo.target = MOVE_TO_TARGET;
+			*moveToId = moveTo.id;
+			AnimationManager::addAnimation(am, moveTo);
+
+			Animation scale = Animation::createDefault(AnimTypeV1::AnimateScale, 400, 200);
+			scale.as.animateScale.object = *cubeId;
+			scale.as.animateScale.target = SCALE_TARGET;
+			*scaleId = scale.id;
+			AnimationManager::addAnimation(am, scale);
+
+			AnimationManager::endFrame(am);
+			AnimationManager::calculateAnimationKeyFrames(am);
+
+			return am;
 		}
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,97 @@
+#ifdef _MATH_ANIM_TESTS
+#include "AtlasAllocatorTests.h"
+#include "utils/AtlasAllocator.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace AtlasAllocatorTests
+	{
+		// -------------------- Constants --------------------
+		constexpr int ATLAS_SIZE = 256;
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(allocateShouldFillTheWholeAtlas)
+		{
+			AtlasAllocator atlas;
+			atlas.init(ATLAS_SIZE, ATLAS_SIZE);
+
+			AtlasRegion region;
+			for (int i = 0; i < 16; i++)
+			{
+				ASSERT_TRUE(atlas.allocate(ATLAS_SIZE / 4, ATLAS_SIZE / 4, &region));
+			}
+			ASSERT_FALSE(atlas.allocate(1, 1, &region));
+
+			AtlasStats stats = atlas.getStats();
+			ASSERT_EQUAL(stats.numAllocations, 16u);
+			ASSERT_EQUAL(stats.freeArea, 0ull);
+			ASSERT_EQUAL(stats.occupancy(), 1.0f);
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(releasedRegionShouldBeReusedInPlace)
+		{
+			AtlasAllocator atlas;
+			atlas.init(ATLAS_SIZE, ATLAS_SIZE);
+
+			AtlasRegion regions[4];
+			for (int i = 0; i < 4; i++)
+			{
+				ASSERT_TRUE(atlas.allocate(ATLAS_SIZE / 2, ATLAS_SIZE / 2, &regions[i]));
+			}
+
+			atlas.release(regions[2]);
+			AtlasRegion reused;
+			ASSERT_TRUE(atlas.allocate(ATLAS_SIZE / 2, ATLAS_SIZE / 2, &reused));
+			ASSERT_EQUAL(reused.x, regions[2].x);
+			ASSERT_EQUAL(reused.y, regions[2].y);
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(releasedNeighborsShouldCoalesce)
+		{
+			AtlasAllocator atlas;
+			atlas.init(ATLAS_SIZE, ATLAS_SIZE);
+
+			AtlasRegion regions[4];
+			for (int i = 0; i < 4; i++)
+			{
+				ASSERT_TRUE(atlas.allocate(ATLAS_SIZE / 2, ATLAS_SIZE / 2, &regions[i]));
+			}
+
+			// Free two quadrants stacked on top of each other. Merged, they should fit
+			// something neither of them could hold on their own.
+			AtlasRegion column = { regions[0].x, 0, ATLAS_SIZE / 2, ATLAS_SIZE };
+			ASSERT_FALSE(atlas.allocate(column.width, column.height, &column));
+			for (int i = 0; i < 4; i++)
+			{
+				if (regions[i].x == column.x)
+				{
+					atlas.release(regions[i]);
+				}
+			}
+
+			AtlasRegion merged;
+			ASSERT_TRUE(atlas.allocate(column.width, column.height, &merged));
+			ASSERT_EQUAL(merged.x, column.x);
+			ASSERT_EQUAL(merged.y, 0);
+
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("AtlasAllocator");
+
+			ADD_TEST(testSuite, allocateShouldFillTheWholeAtlas);
+			ADD_TEST(testSuite, releasedRegionShouldBeReusedInPlace);
+			ADD_TEST(testSuite, releasedNeighborsShouldCoalesce);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifdef _MATH_ANIM_TESTS
+#ifndef MATH_ANIM_ATLAS_ALLOCATOR_TESTS_H
+#define MATH_ANIM_ATLAS_ALLOCATOR_TESTS_H
+#include <cppUtils/cppTests.hpp>
+
+namespace MathAnim
+{
+	namespace AtlasAllocatorTests
+	{
+		void setupTestSuite();
+	}
+}
+
+#endif 
+#endif // _MATH_ANIM_TESTS
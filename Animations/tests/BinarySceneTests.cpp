@@ -0,0 +1,237 @@
+#ifdef _MATH_ANIM_TESTS
+#include "BinarySceneTests.h"
+
+#include "core.h"
+#include "core/BinaryScene.h"
+#include "animation/Animation.h"
+#include "animation/AnimationManager.h"
+#include "math/CMath.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace BinarySceneTests
+	{
+		// -------------------- Constants --------------------
+		static const Vec3 CUBE_POSITION = Vec3{ 1.0f, -2.0f, 3.0f };
+		static const Vec3 MOVE_TO_TARGET = Vec3{ 4.0f, 2.0f, 0.0f };
+
+		// -------------------- Private functions --------------------
+		static AnimationManagerData* createScene(AnimObjId* cubeId, AnimObjId* squareId, AnimId* moveToId);
+		static std::vector<uint8> saveScene(const AnimationManagerData* am);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(sceneShouldSurviveRoundTrip)
+		{
+			AnimObjId cubeId, squareId;
+			AnimId moveToId;
+			AnimationManagerData* am = createScene(&cubeId, &squareId, &moveToId);
+			std::vector<uint8> data = saveScene(am);
+
+			BinarySceneReader reader;
+			ASSERT_TRUE(reader.openMemory(data.data(), data.size()));
+			ASSERT_EQUAL((int)reader.getVersionMajor(), (int)SERIALIZER_VERSION_MAJOR);
+			ASSERT_EQUAL((int)reader.getVersionMinor(), (int)SERIALIZER_VERSION_MINOR);
+
+			AnimationManagerData* loaded = AnimationManager::create();
+			ASSERT_TRUE(AnimationManager::deserializeBinary(loaded, reader, 0));
+			AnimationManager::endFrame(loaded);
+			reader.close();
+
+			const AnimObject* cube = AnimationManager::getObject(loaded, cubeId);
+			ASSERT_NOT_NULL(cube);
+			ASSERT_EQUAL((int)cube->objectType, (int)AnimObjectTypeV1::Cube);
+			ASSERT_TRUE(cube->_positionStart == CUBE_POSITION);
+
+			const AnimObject* square = AnimationManager::getObject(loaded, squareId);
+			ASSERT_NOT_NULL(square);
+			ASSERT_EQUAL((int)square->objectType, (int)AnimObjectTypeV1::Square);
+			ASSERT_EQUAL(square->parentId, cubeId);
+			ASSERT_EQUAL(AnimationManager::getChildren(loaded, cubeId).size(), 1);
+
+			const Animation* moveTo = AnimationManager::getAnimation(loaded, moveToId);
+			ASSERT_NOT_NULL(moveTo);
+			ASSERT_EQUAL((int)moveTo->type, (int)AnimTypeV1::MoveTo);
+			ASSERT_EQUAL(moveTo->frameStart, 30);
+			ASSERT_EQUAL(moveTo->duration, 120);
+			ASSERT_EQUAL(moveTo->as.moveTo.object, cubeId);
+			ASSERT_TRUE(CMath::compare(moveTo->as.moveTo.target, MOVE_TO_TARGET, 0.0001f));
+
+			AnimationManager::free(loaded);
+			AnimationManager::free(am);
+			END_TEST;
+		}
+
+		DEFINE_TEST(unknownFormatVersionShouldFailToOpen)
+		{
+			AnimObjId cubeId, squareId;
+			AnimId moveToId;
+			AnimationManagerData* am = createScene(&cubeId, &squareId, &moveToId);
+			std::vector<uint8> data = saveScene(am);
+			AnimationManager::free(am);
+
+			BinarySceneHeader* header = (BinarySceneHeader*)data.data();
+			header->formatVersion = BINARY_SCENE_FORMAT_VERSION + 1;
+
+			BinarySceneReader reader;
+			ASSERT_FALSE(reader.openMemory(data.data(), data.size()));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(truncatedSceneShouldFailToOpen)
+		{
+			AnimObjId cubeId, squareId;
+			AnimId moveToId;
+			AnimationManagerData* am = createScene(&cubeId, &squareId, &moveToId);
+			std::vector<uint8> data = saveScene(am);
+			AnimationManager::free(am);
+
+			// Cut off in the middle of the header, the section table and the last section
+			size_t truncatedSizes[] = {
+				sizeof(BinarySceneHeader) / 2,
+				sizeof(BinarySceneHeader) + sizeof(BinarySceneSectionEntry) / 2,
+				data.size() - 1
+			};
+			for (size_t truncatedSize : truncatedSizes)
+			{
+				BinarySceneReader reader;
+				ASSERT_FALSE(reader.openMemory(data.data(), truncatedSize));
+			}
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(corruptedRecordsShouldBeSkipped)
+		{
+			AnimObjId cubeId, squareId;
+			AnimId moveToId;
+			AnimationManagerData* am = createScene(&cubeId, &squareId, &moveToId);
+			std::vector<uint8> data = saveScene(am);
+			AnimationManager::free(am);
+
+			// Give the square an object type that doesn't exist
+			BinarySceneReader reader;
+			ASSERT_TRUE(reader.openMemory(data.data(), data.size()));
+			size_t numObjects = 0;
+			const BinaryAnimObjectRecord* records = reader.getRecords<BinaryAnimObjectRecord>(BinarySceneSection::AnimObjects, &numObjects);
+			ASSERT_EQUAL(numObjects, 2);
+			bool foundSquare = false;
+			for (size_t i = 0; i < numObjects; i++)
+			{
+				if (records[i].id == squareId)
+				{
+					// NOTE: The reader reads the records in place, so this edits `data`
+					BinaryAnimObjectRecord* square = (BinaryAnimObjectRecord*)&records[i];
+					square->objectType = (uint32)AnimObjectTypeV1::Length;
+					foundSquare = true;
+				}
+			}
+			ASSERT_TRUE(foundSquare);
+
+			AnimationManagerData* loaded = AnimationManager::create();
+			ASSERT_FALSE(AnimationManager::deserializeBinary(loaded, reader, 0));
+			AnimationManager::endFrame(loaded);
+			reader.close();
+
+			// Everything that wasn't corrupted should still load
+			ASSERT_NULL(AnimationManager::getObject(loaded, squareId));
+			ASSERT_NOT_NULL(AnimationManager::getObject(loaded, cubeId));
+			ASSERT_NOT_NULL(AnimationManager::getAnimation(loaded, moveToId));
+			ASSERT_EQUAL(AnimationManager::getChildren(loaded, cubeId).size(), 0);
+
+			AnimationManager::free(loaded);
+			END_TEST;
+		}
+
+		DEFINE_TEST(corruptedTypeDataShouldBeSkipped)
+		{
+			AnimObjId cubeId, squareId;
+			AnimId moveToId;
+			AnimationManagerData* am = createScene(&cubeId, &squareId, &moveToId);
+			std::vector<uint8> data = saveScene(am);
+			AnimationManager::free(am);
+
+			// 0xFF is a CBOR break code, which isn't a valid start of a value
+			BinarySceneReader reader;
+			ASSERT_TRUE(reader.openMemory(data.data(), data.size()));
+			size_t numObjects = 0;
+			const BinaryAnimObjectRecord* records = reader.getRecords<BinaryAnimObjectRecord>(BinarySceneSection::AnimObjects, &numObjects);
+			bool foundSquare = false;
+			for (size_t i = 0; i < numObjects; i++)
+			{
+				if (records[i].id == squareId)
+				{
+					// NOTE: The reader reads the blobs in place, so this edits `data`
+					uint8* typeData = (uint8*)reader.getBlob(records[i].typeData);
+					ASSERT_NOT_NULL(typeData);
+					typeData[0] = 0xFF;
+					foundSquare = true;
+				}
+			}
+			ASSERT_TRUE(foundSquare);
+
+			AnimationManagerData* loaded = AnimationManager::create();
+			ASSERT_FALSE(AnimationManager::deserializeBinary(loaded, reader, 0));
+			AnimationManager::endFrame(loaded);
+			reader.close();
+
+			ASSERT_NULL(AnimationManager::getObject(loaded, squareId));
+			ASSERT_NOT_NULL(AnimationManager::getObject(loaded, cubeId));
+			ASSERT_NOT_NULL(AnimationManager::getAnimation(loaded, moveToId));
+
+			AnimationManager::free(loaded);
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("BinaryScene");
+
+			ADD_TEST(testSuite, sceneShouldSurviveRoundTrip);
+			ADD_TEST(testSuite, unknownFormatVersionShouldFailToOpen);
+			ADD_TEST(testSuite, truncatedSceneShouldFailToOpen);
+			ADD_TEST(testSuite, corruptedRecordsShouldBeSkipped);
+			ADD_TEST(testSuite, corruptedTypeDataShouldBeSkipped);
+		}
+
+		// -------------------- Private functions --------------------
+		static AnimationManagerData* createScene(AnimObjId* cubeId, AnimObjId* squareId, AnimId* moveToId)
+		{
+			AnimationManagerData* am = AnimationManager::create();
+
+			AnimObject cube = AnimObject::createDefault(am, AnimObjectTypeV1::Cube);
+			cube._positionStart = CUBE_POSITION;
+			*cubeId = cube.id;
+			AnimationManager::addAnimObject(am, cube);
+
+			AnimObject square = AnimObject::createDefaultFromParent(am, AnimObjectTypeV1::Square, cube.id);
+			*squareId = square.id;
+			AnimationManager::addAnimObject(am, square);
+
+			Animation moveTo = Animation::createDefault(AnimTypeV1::MoveTo, 30, 120);
+			moveTo.as.moveTo.object = *cubeId;
+			moveTo.as.moveTo.target = MOVE_TO_TARGET;
+			*moveToId = moveTo.id;
+			AnimationManager::addAnimation(am, moveTo);
+
+			AnimationManager::endFrame(am);
+			AnimationManager::calculateAnimationKeyFrames(am);
+
+			return am;
+		}
+
+		static std::vector<uint8> saveScene(const AnimationManagerData* am)
+		{
+			BinarySceneWriter writer;
+			AnimationManager::serializeBinary(am, writer);
+
+			std::vector<uint8> data = {};
+			writer.writeToMemory(data, SERIALIZER_VERSION_MAJOR, SERIALIZER_VERSION_MINOR);
+			return data;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifdef _MATH_ANIM_TESTS
+#include "FileSystemWatcherTests.h"
+#include "platform/FileSystemWatcher.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace FileSystemWatcherTests
+	{
+		// -------------------- Constants --------------------
+		static const std::chrono::milliseconds DEBOUNCE_WINDOW = std::chrono::milliseconds(100);
+
+		typedef std::vector<std::pair<std::filesystem::path, FileSystemEvent>> ReadyEvents;
+
+		// -------------------- Private functions --------------------
+		static ReadyEvents takeEventsAfterBurst(FileSystemEventCoalescer& coalescer, std::chrono::steady_clock::time_point burstStart);
+		static bool hasEvent(const ReadyEvents& events, const std::filesystem::path& file, FileSystemEvent event);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(renameOverShouldReportOneChange)
+		{
+			FileSystemEventCoalescer coalescer;
+			coalescer.addExistingFile("script.luau");
+
+			// How most editors save: write a temp file, then rename it onto the target
+			auto now = std::chrono::steady_clock::now();
+			coalescer.addEvent(RawFileSystemEvent::Created, "script.luau.tmp", 0, now);
+			coalescer.addEvent(RawFileSystemEvent::Modified, "script.luau.tmp", 0, now);
+			coalescer.addEvent(RawFileSystemEvent::MovedFrom, "script.luau.tmp", 7, now);
+			coalescer.addEvent(RawFileSystemEvent::MovedTo, "script.luau", 7, now);
+
+			ReadyEvents events = takeEventsAfterBurst(coalescer, now);
+			ASSERT_EQUAL((int)events.size(), 1);
+			ASSERT_TRUE(hasEvent(events, "script.luau", FileSystemEvent::Changed));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(renameOverFromOutsideTreeShouldReportChange)
+		{
+			FileSystemEventCoalescer coalescer;
+			coalescer.addExistingFile("nested/script.luau");
+
+			// The temp file lived outside the watched tree, so there's no matching MovedFrom
+			auto now = std::chrono::steady_clock::now();
+			coalescer.addEvent(RawFileSystemEvent::MovedTo, "nested/script.luau", 3, now);
+
+			ReadyEvents events = takeEventsAfterBurst(coalescer, now);
+			ASSERT_EQUAL((int)events.size(), 1);
+			ASSERT_TRUE(hasEvent(events, "nested/script.luau", FileSystemEvent::Changed));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(createThenModifyShouldReportOneCreate)
+		{
+			FileSystemEventCoalescer coalescer;
+
+			auto now = std::chrono::steady_clock::now();
+			coalescer.addEvent(RawFileSystemEvent::Created, "new.luau", 0, now);
+			coalescer.addEvent(RawFileSystemEvent::Modified, "new.luau", 0, now);
+			coalescer.addEvent(RawFileSystemEvent::Modified, "new.luau", 0, now);
+
+			ReadyEvents events = takeEventsAfterBurst(coalescer, now);
+			ASSERT_EQUAL((int)events.size(), 1);
+			ASSERT_TRUE(hasEvent(events, "new.luau", FileSystemEvent::Created));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(deleteThenRecreateShouldReportOneChange)
+		{
+			FileSystemEventCoalescer coalescer;
+			coalescer.addExistingFile("script.luau");
+
+			auto now = std::chrono::steady_clock::now();
+			coalescer.addEvent(RawFileSystemEvent::Deleted, "script.luau", 0, now);
+			coalescer.addEvent(RawFileSystemEvent::Created, "script.luau", 0, now);
+			coalescer.addEvent(RawFileSystemEvent::Modified, "script.luau", 0, now);
+
+			ReadyEvents events = takeEventsAfterBurst(coalescer, now);
+			ASSERT_EQUAL((int)events.size(), 1);
+			ASSERT_TRUE(hasEvent(events, "script.luau", FileSystemEvent::Changed));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(realRenameShouldReportRenameAndDelete)
+		{
+			FileSystemEventCoalescer coalescer;
+			coalescer.addExistingFile("old.luau");
+
+			auto now = std::chrono::steady_clock::now();
+			coalescer.addEvent(RawFileSystemEvent::MovedFrom, "old.luau", 5, now);
+			coalescer.addEvent(RawFileSystemEvent::MovedTo, "new.luau", 5, now);
+
+			ReadyEvents events = takeEventsAfterBurst(coalescer, now);
+			ASSERT_EQUAL((int)events.size(), 2);
+			ASSERT_TRUE(hasEvent(events, "old.luau", FileSystemEvent::Deleted));
+			ASSERT_TRUE(hasEvent(events, "new.luau", FileSystemEvent::Renamed));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(eventsShouldWaitForDebounceWindow)
+		{
+			FileSystemEventCoalescer coalescer;
+
+			auto now = std::chrono::steady_clock::now();
+			coalescer.addEvent(RawFileSystemEvent::Created, "new.luau", 0, now);
+
+			ASSERT_EQUAL((int)coalescer.takeReadyEvents(now + DEBOUNCE_WINDOW / 2, DEBOUNCE_WINDOW).size(), 0);
+			ASSERT_EQUAL((int)coalescer.takeReadyEvents(now + DEBOUNCE_WINDOW, DEBOUNCE_WINDOW).size(), 1);
+			ASSERT_EQUAL((int)coalescer.takeReadyEvents(now + DEBOUNCE_WINDOW * 2, DEBOUNCE_WINDOW).size(), 0);
+
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("FileSystemWatcher");
+
+			ADD_TEST(testSuite, renameOverShouldReportOneChange);
+			ADD_TEST(testSuite, renameOverFromOutsideTreeShouldReportChange);
+			ADD_TEST(testSuite, createThenModifyShouldReportOneCreate);
+			ADD_TEST(testSuite, deleteThenRecreateShouldReportOneChange);
+			ADD_TEST(testSuite, realRenameShouldReportRenameAndDelete);
+			ADD_TEST(testSuite, eventsShouldWaitForDebounceWindow);
+		}
+
+		// -------------------- Private functions --------------------
+		static ReadyEvents takeEventsAfterBurst(FileSystemEventCoalescer& coalescer, std::chrono::steady_clock::time_point burstStart)
+		{
+			return coalescer.takeReadyEvents(burstStart + DEBOUNCE_WINDOW, DEBOUNCE_WINDOW);
+		}
+
+		static bool hasEvent(const ReadyEvents& events, const std::filesystem::path& file, FileSystemEvent event)
+		{
+			for (auto const& [readyFile, readyEvent] : events)
+			{
+				if (readyFile == file && readyEvent == event)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+	}
+}
+
+#endif
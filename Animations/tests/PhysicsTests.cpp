@@ -0,0 +1,83 @@
+#ifdef _MATH_ANIM_TESTS
+#include "PhysicsTests.h"
+#include "physics/Physics.h"
+#include "physics/Bvh.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace PhysicsTests
+	{
+		// -------------------- Constants --------------------
+		constexpr int GRID_SIZE = 10;
+
+		// -------------------- Private functions --------------------
+		static Ray createDownwardRay(float x, float y);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(bvhRaycastShouldOnlyReturnBoxesTheRayHits)
+		{
+			// Grid of unit boxes with gaps in between them, box (x, y) is centered at (x * 2, y * 2)
+			std::vector<AABB> boxes = {};
+			for (int y = 0; y < GRID_SIZE; y++)
+			{
+				for (int x = 0; x < GRID_SIZE; x++)
+				{
+					boxes.push_back(Physics::createAABB(Vec3{ x * 2.0f, y * 2.0f, 0.0f }, Vec3{ 1.0f, 1.0f, 1.0f }));
+				}
+			}
+
+			Bvh bvh;
+			bvh.build(boxes);
+			ASSERT_TRUE(bvh.getNumNodes() < boxes.size());
+
+			std::vector<uint32> hits = {};
+			bvh.raycast(createDownwardRay(6.1f, 8.1f), hits);
+			ASSERT_EQUAL(hits.size(), 1);
+			ASSERT_EQUAL(hits[0], 4u * GRID_SIZE + 3u);
+
+			hits.clear();
+			bvh.raycast(createDownwardRay(7.1f, 8.1f), hits);
+			ASSERT_EQUAL(hits.size(), 0);
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(rayShouldHitRotatedOBB)
+		{
+			OBB obb = {};
+			obb.bbox.min = Vec2{ -0.5f, -0.5f };
+			obb.bbox.max = Vec2{ 0.5f, 0.5f };
+			obb.transformation = glm::rotate(glm::identity<glm::mat4>(), glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+
+			// Rotated 45 degrees, the corners reach out to sqrt(0.5) on the x and y axes
+			RaycastResult res = Physics::rayIntersectsOBB(createDownwardRay(0.65f, 0.01f), obb);
+			ASSERT_TRUE(res.hitEntry());
+			ASSERT_TRUE(glm::abs(res.hitEntryDistance - 10.0f) < 0.001f);
+			ASSERT_FALSE(Physics::rayIntersectsOBB(createDownwardRay(0.45f, 0.45f), obb).hit());
+
+			AABB bounds = Physics::createAABB(obb);
+			ASSERT_TRUE(glm::abs(bounds.max.x - glm::sqrt(0.5f)) < 0.001f);
+			ASSERT_TRUE(glm::abs(bounds.min.y + glm::sqrt(0.5f)) < 0.001f);
+
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("Physics");
+
+			ADD_TEST(testSuite, bvhRaycastShouldOnlyReturnBoxesTheRayHits);
+			ADD_TEST(testSuite, rayShouldHitRotatedOBB);
+		}
+
+		// -------------------- Private functions --------------------
+		static Ray createDownwardRay(float x, float y)
+		{
+			return Physics::createRay(Vec3{ x, y, 10.0f }, Vec3{ x, y, -10.0f });
+		}
+	}
+}
+
+#endif
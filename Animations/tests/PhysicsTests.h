@@ -0,0 +1,15 @@
+#ifdef _MATH_ANIM_TESTS
+#ifndef MATH_ANIM_PHYSICS_TESTS_H
+#define MATH_ANIM_PHYSICS_TESTS_H
+#include <cppUtils/cppTests.hpp>
+
+namespace MathAnim
+{
+	namespace PhysicsTests
+	{
+		void setupTestSuite();
+	}
+}
+
+#endif 
+#endif // _MATH_ANIM_TESTS
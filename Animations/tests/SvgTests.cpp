@@ -0,0 +1,239 @@
+#ifdef _MATH_ANIM_TESTS
+#include "SvgTests.h"
+#include "svg/Svg.h"
+#include "renderer/Renderer.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace SvgTests
+	{
+		// -------------------- Constants --------------------
+		constexpr float EPSILON = 0.0001f;
+		// Flattened curves are only accurate up to their segment length
+		constexpr float FLATTENED_EPSILON = 0.01f;
+
+		// -------------------- Private functions --------------------
+		static SvgObject createSquare();
+		static SvgObject createTriangle();
+		static SvgObject createThreeSquares();
+		static const StrokeTessellation* cacheStroke(uint64 key, Path2DContext* context);
+		static bool isNear(const Vec2& a, const Vec2& b, float epsilon = EPSILON);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(morphShouldStartAtSourceAndEndAtTarget)
+		{
+			SvgObject square = createSquare();
+			SvgObject triangle = createTriangle();
+			SvgMorph morph = Svg::createMorph(&square, &triangle);
+			ASSERT_TRUE(morph.isMorphBetween(&square, &triangle));
+			ASSERT_FALSE(morph.isMorphBetween(&triangle, &square));
+
+			SvgObject interpolated = Svg::createDefault();
+			Svg::interpolateInto(morph, 0.0f, &interpolated);
+			ASSERT_EQUAL(interpolated.numPaths, 1);
+			// Every curve from the square, plus the line closing the path
+			ASSERT_EQUAL(interpolated.paths[0].numCurves, 5);
+			ASSERT_TRUE(isNear(interpolated.paths[0].curves[0].p0, square.paths[0].curves[0].p0));
+			ASSERT_TRUE(isNear(interpolated.bbox.min, square.bbox.min));
+			ASSERT_TRUE(isNear(interpolated.bbox.max, square.bbox.max));
+
+			Svg::interpolateInto(morph, 1.0f, &interpolated);
+			ASSERT_TRUE(isNear(interpolated.paths[0].curves[0].p0, triangle.paths[0].curves[0].p0));
+			ASSERT_TRUE(isNear(interpolated.bbox.min, triangle.bbox.min));
+			ASSERT_TRUE(isNear(interpolated.bbox.max, triangle.bbox.max));
+			ASSERT_EQUAL(interpolated.md5Length, morph.md5Length);
+
+			interpolated.free();
+			morph.free();
+			square.free();
+			triangle.free();
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(interpolateIntoShouldReuseDestinationMemory)
+		{
+			SvgObject square = createSquare();
+			SvgObject triangle = createTriangle();
+			SvgMorph morph = Svg::createMorph(&triangle, &square);
+
+			SvgObject interpolated = Svg::createDefault();
+			Svg::interpolateInto(morph, 0.25f, &interpolated);
+			const Path* paths = interpolated.paths;
+			const Curve* curves = interpolated.paths[0].curves;
+			const uint8* md5 = interpolated.md5;
+
+			Svg::interpolateInto(morph, 0.75f, &interpolated);
+			ASSERT_TRUE(interpolated.paths == paths);
+			ASSERT_TRUE(interpolated.paths[0].curves == curves);
+			ASSERT_TRUE(interpolated.md5 == md5);
+
+			interpolated.free();
+			morph.free();
+			square.free();
+			triangle.free();
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(sharedObjectShouldBeFreedByLastOwner)
+		{
+			SvgObject* square = (SvgObject*)g_memory_allocate(sizeof(SvgObject));
+			*square = createSquare();
+			ASSERT_FALSE(Svg::isShared(square));
+
+			SvgObject* shared = Svg::retain(square);
+			ASSERT_TRUE(shared == square);
+			ASSERT_TRUE(Svg::isShared(square));
+
+			// Only drops the extra reference, the square is still usable here
+			Svg::release(shared);
+			ASSERT_FALSE(Svg::isShared(square));
+			ASSERT_EQUAL(square->numPaths, 1);
+
+			Svg::release(square);
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(lineStrokeShouldBeCutByArcLength)
+		{
+			Path2DContext* context = Renderer::beginPath(Vec2{ 0.0f, 0.0f });
+			Renderer::lineTo(context, Vec2{ 10.0f, 0.0f });
+			const StrokeTessellation* stroke = cacheStroke(0x5356475465737401, context);
+			ASSERT_NOT_NULL(stroke);
+
+			ASSERT_TRUE(glm::abs(Renderer::getStrokeLength(stroke) - 10.0f) < EPSILON);
+			ASSERT_TRUE(isNear(Renderer::getStrokeCutPoint(stroke, 0.0f), Vec2{ 0.0f, 0.0f }));
+			ASSERT_TRUE(isNear(Renderer::getStrokeCutPoint(stroke, 0.5f), Vec2{ 5.0f, 0.0f }));
+			ASSERT_TRUE(isNear(Renderer::getStrokeCutPoint(stroke, 1.0f), Vec2{ 10.0f, 0.0f }));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(cubicStrokeShouldBeCutByArcLength)
+		{
+			// A straight cubic with both control points on its start point. Half way through
+			// the curve parameter is only an eighth of the way along the line.
+			Path2DContext* context = Renderer::beginPath(Vec2{ 0.0f, 0.0f });
+			Renderer::cubicTo(context, Vec2{ 0.0f, 0.0f }, Vec2{ 0.0f, 0.0f }, Vec2{ 10.0f, 0.0f });
+			const StrokeTessellation* stroke = cacheStroke(0x5356475465737402, context);
+			ASSERT_NOT_NULL(stroke);
+
+			ASSERT_TRUE(glm::abs(Renderer::getStrokeLength(stroke) - 10.0f) < FLATTENED_EPSILON);
+			ASSERT_TRUE(isNear(Renderer::getStrokeCutPoint(stroke, 0.0f), Vec2{ 0.0f, 0.0f }));
+			ASSERT_TRUE(isNear(Renderer::getStrokeCutPoint(stroke, 0.5f), Vec2{ 5.0f, 0.0f }, FLATTENED_EPSILON));
+			ASSERT_TRUE(isNear(Renderer::getStrokeCutPoint(stroke, 1.0f), Vec2{ 10.0f, 0.0f }));
+
+			// This curve is symmetric about the line x + y = 10, so cutting it by arc length
+			// has to land on mirrored points
+			context = Renderer::beginPath(Vec2{ 0.0f, 0.0f });
+			Renderer::cubicTo(context, Vec2{ 5.5f, 0.0f }, Vec2{ 10.0f, 4.5f }, Vec2{ 10.0f, 10.0f });
+			stroke = cacheStroke(0x5356475465737403, context);
+			ASSERT_NOT_NULL(stroke);
+
+			ASSERT_TRUE(isNear(Renderer::getStrokeCutPoint(stroke, 0.5f), Vec2{ 7.0625f, 2.9375f }, FLATTENED_EPSILON));
+			Vec2 quarter = Renderer::getStrokeCutPoint(stroke, 0.25f);
+			Vec2 threeQuarters = Renderer::getStrokeCutPoint(stroke, 0.75f);
+			ASSERT_TRUE(isNear(threeQuarters, Vec2{ 10.0f - quarter.y, 10.0f - quarter.x }, FLATTENED_EPSILON));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(outlineShouldBeCutAcrossSubpaths)
+		{
+			// Squares with perimeters of 40, 80 and 40
+			SvgObject squares = createThreeSquares();
+			ASSERT_EQUAL(squares.numPaths, 3);
+			ASSERT_TRUE(glm::abs(squares.approximatePerimeter - 160.0f) < EPSILON);
+
+			float percentOfPath = 0.0f;
+			ASSERT_EQUAL(Svg::getOutlineCutPoint(&squares, 0.0f, &percentOfPath), -1);
+			ASSERT_TRUE(glm::abs(percentOfPath) < EPSILON);
+
+			// Half of the total perimeter ends half way through the second square
+			ASSERT_EQUAL(Svg::getOutlineCutPoint(&squares, 0.5f, &percentOfPath), 1);
+			ASSERT_TRUE(glm::abs(percentOfPath - 0.5f) < EPSILON);
+
+			ASSERT_EQUAL(Svg::getOutlineCutPoint(&squares, 0.125f, &percentOfPath), 0);
+			ASSERT_TRUE(glm::abs(percentOfPath - 0.5f) < EPSILON);
+
+			ASSERT_EQUAL(Svg::getOutlineCutPoint(&squares, 1.0f, &percentOfPath), 3);
+			ASSERT_TRUE(glm::abs(percentOfPath - 1.0f) < EPSILON);
+
+			squares.free();
+
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("Svg");
+
+			ADD_TEST(testSuite, morphShouldStartAtSourceAndEndAtTarget);
+			ADD_TEST(testSuite, interpolateIntoShouldReuseDestinationMemory);
+			ADD_TEST(testSuite, sharedObjectShouldBeFreedByLastOwner);
+			ADD_TEST(testSuite, lineStrokeShouldBeCutByArcLength);
+			ADD_TEST(testSuite, cubicStrokeShouldBeCutByArcLength);
+			ADD_TEST(testSuite, outlineShouldBeCutAcrossSubpaths);
+		}
+
+		// -------------------- Private functions --------------------
+		static SvgObject createSquare()
+		{
+			SvgObject res = Svg::createDefault();
+			Svg::beginPath(&res, Vec2{ 0.0f, 0.0f });
+			Svg::lineTo(&res, Vec2{ 10.0f, 0.0f });
+			Svg::lineTo(&res, Vec2{ 10.0f, 10.0f });
+			Svg::lineTo(&res, Vec2{ 0.0f, 10.0f });
+			Svg::closePath(&res, true);
+			res.finalize();
+			return res;
+		}
+
+		static SvgObject createTriangle()
+		{
+			SvgObject res = Svg::createDefault();
+			Svg::beginPath(&res, Vec2{ 5.0f, 20.0f });
+			Svg::lineTo(&res, Vec2{ 15.0f, 40.0f });
+			Svg::lineTo(&res, Vec2{ -5.0f, 40.0f });
+			Svg::closePath(&res, true);
+			res.finalize();
+			return res;
+		}
+
+		static SvgObject createThreeSquares()
+		{
+			SvgObject res = Svg::createDefault();
+			const float sizes[] = { 10.0f, 20.0f, 10.0f };
+			float x = 0.0f;
+			for (float size : sizes)
+			{
+				Svg::moveTo(&res, Vec2{ x, 0.0f });
+				Svg::lineTo(&res, Vec2{ x + size, 0.0f });
+				Svg::lineTo(&res, Vec2{ x + size, size });
+				Svg::lineTo(&res, Vec2{ x, size });
+				x += size + 5.0f;
+			}
+			Svg::closePath(&res, true);
+			res.finalize();
+			return res;
+		}
+
+		static const StrokeTessellation* cacheStroke(uint64 key, Path2DContext* context)
+		{
+			const StrokeTessellation* res = Renderer::cacheStroke(key, context);
+			Renderer::free(context);
+			return res;
+		}
+
+		static bool isNear(const Vec2& a, const Vec2& b, float epsilon)
+		{
+			return glm::abs(a.x - b.x) < epsilon && glm::abs(a.y - b.y) < epsilon;
+		}
+	}
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include "parsers/SyntaxHighlighter.h"
 #include "parsers/SyntaxTheme.h"
 #include "parsers/Grammar.h"
+#include "parsers/ScopeStack.h"
+#include "multithreading/GlobalThreadPool.h"
 
 using namespace CppUtils;
 
@@ -16,6 +18,7 @@ namespace MathAnim
 		static const char* luaGrammar = "./assets/customGrammars/lua.grammar.json";
 
 		// -------------------- Private functions --------------------
+		static std::string generateLargeCppSource(int numFunctions);
 
 		// -------------------- Init/Teardown --------------------
 		DEFINE_BEFORE_ALL(beforeAll)
@@ -211,6 +214,47 @@ namespace MathAnim
 			END_TEST;
 		}
 
+		DEFINE_TEST(withCpp_parallelParseMatchesSequentialParse)
+		{
+			const SyntaxHighlighter* highlighter = Highlighters::getHighlighter(HighlighterLanguage::Cpp);
+			const SyntaxTheme* theme = Highlighters::getTheme(HighlighterTheme::OneDark);
+			std::string src = generateLargeCppSource(500);
+
+			GlobalThreadPool pool(4);
+			std::string parallelParseTree = highlighter->getStringifiedParseTreeFor(src, *theme, &pool);
+			pool.free();
+			std::string sequentialParseTree = highlighter->getStringifiedParseTreeFor(src, *theme);
+
+			ASSERT_EQUAL(parallelParseTree, sequentialParseTree);
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(scopeStacks_sharedAncestorsAreInternedOnce)
+		{
+			std::vector<ScopedName> stack = { ScopedName::from("source.scopeStackTest"), ScopedName::from("meta.first.scopeStackTest") };
+			std::vector<ScopedName> sibling = { ScopedName::from("source.scopeStackTest"), ScopedName::from("meta.second.scopeStackTest") };
+
+			ScopeStackId stackId = ScopeStacks::intern(stack);
+			size_t numInternedScopes = ScopeStacks::getNumInternedScopes();
+			ScopeStackId siblingId = ScopeStacks::intern(sibling);
+
+			ASSERT_EQUAL(ScopeStacks::intern(stack), stackId);
+			ASSERT_NOT_EQUAL(siblingId, stackId);
+			// Only the top scope of the sibling is new, the `source.scopeStackTest` node is shared
+			ASSERT_EQUAL(ScopeStacks::getNumInternedScopes(), numInternedScopes + 1);
+			ASSERT_EQUAL(ScopeStacks::getDepth(siblingId), (size_t)2);
+			ASSERT_EQUAL(ScopeStacks::getTop(siblingId).getFriendlyName(), std::string("meta.second.scopeStackTest"));
+
+			std::vector<ScopedName> roundTrip = ScopeStacks::get(stackId);
+			ASSERT_EQUAL(roundTrip.size(), stack.size());
+			ASSERT_TRUE(roundTrip[0].strictEquals(stack[0]));
+			ASSERT_TRUE(roundTrip[1].strictEquals(stack[1]));
+			ASSERT_EQUAL(ScopeStacks::intern({}), EMPTY_SCOPE_STACK);
+
+			END_TEST;
+		}
+
 		void setupTestSuite()
 		{
 			Tests::TestSuite& testSuite = Tests::addTestSuite("SyntaxHighlighterTests");
@@ -235,9 +279,32 @@ namespace MathAnim
 			ADD_TEST(testSuite, withLua_backreferenceWith0SizedMatchWorks);
 			ADD_TEST(testSuite, withLua_backreferenceWithNoEndMatchParsesUntilTheEnd);
 			ADD_TEST(testSuite, withJs_scopeCaptureWithExtraTextGetsSetCorrectly);
+			ADD_TEST(testSuite, withCpp_parallelParseMatchesSequentialParse);
+			ADD_TEST(testSuite, scopeStacks_sharedAncestorsAreInternedOnce);
 		}
 
 		// -------------------- Private functions --------------------
+		static std::string generateLargeCppSource(int numFunctions)
+		{
+			// The only lines that look like a safe place to start a chunk are inside block comments,
+			// so every chunk seam has to be caught and re-parsed
+			std::string res = "";
+			for (int i = 0; i < numFunctions; i++)
+			{
+				std::string index = std::to_string(i);
+				res += "int function" + index + "(int a)\n";
+				res += "{\n";
+				res += "\treturn a * " + index + "; // Line comment\n";
+				res += "}\n";
+				res += "/*\n";
+				res += " * Block comment " + index + "\n";
+				res += "\n";
+				res += "int looksLikeCode" + index + " = \"but is still in the comment\";\n";
+				res += "*/\n";
+			}
+
+			return res;
+		}
 	}
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,220 @@
+#ifdef _MATH_ANIM_TESTS
+#include "TextDocumentTests.h"
+#include "utils/TextDocument.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace TextDocumentTests
+	{
+		// -------------------- Constants --------------------
+		static const std::string originalText = "int main()\n{\n\treturn 0;\n}\n";
+
+		// -------------------- Private functions --------------------
+		static void initDocument(TextDocument& document, std::string const& text);
+		static TextEdit insertString(TextDocument& document, size_t byteOffset, std::string const& text);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(lineIndexShouldMatchOriginalText)
+		{
+			TextDocument document;
+			initDocument(document, originalText);
+
+			ASSERT_EQUAL(document.getNumLines(), (size_t)5);
+			ASSERT_EQUAL(document.getLineStart(0), (size_t)0);
+			ASSERT_EQUAL(document.getLineStart(1), (size_t)11);
+			ASSERT_EQUAL(document.getLineStart(2), (size_t)13);
+			ASSERT_EQUAL(document.getLineStart(4), originalText.length());
+			ASSERT_EQUAL(document.getLineFromByte(10), (size_t)0);
+			ASSERT_EQUAL(document.getLineFromByte(11), (size_t)1);
+			ASSERT_EQUAL(document.getLineFromByte(originalText.length()), (size_t)4);
+
+			document.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(insertShouldUpdateTextAndLines)
+		{
+			TextDocument document;
+			initDocument(document, originalText);
+
+			TextEdit edit = insertString(document, 14, "int x = 1;\n\t");
+			std::string expectedText = "int main()\n{\n\tint x = 1;\n\treturn 0;\n}\n";
+			ASSERT_EQUAL(document.getText(0, document.getLength()), expectedText);
+			ASSERT_EQUAL(std::string((const char*)document.getFlattenedText()), expectedText);
+
+			ASSERT_EQUAL(edit.byteStart, (size_t)14);
+			ASSERT_EQUAL(edit.numBytesInserted, (size_t)12);
+			ASSERT_EQUAL(edit.lineStart, (size_t)2);
+			ASSERT_EQUAL(edit.numLinesInserted, (size_t)1);
+
+			ASSERT_EQUAL(document.getNumLines(), (size_t)6);
+			ASSERT_EQUAL(document.getLineStart(3), (size_t)25);
+			ASSERT_EQUAL(document.getLineFromByte(26), (size_t)3);
+
+			document.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(removeAcrossPiecesShouldUpdateTextAndLines)
+		{
+			TextDocument document;
+			initDocument(document, originalText);
+			insertString(document, 14, "int x = 1;\n\t");
+
+			// Removes "x = 1;\n\treturn " which spans the inserted text and the original text
+			TextEdit edit = document.remove(18, 15);
+			std::string expectedText = "int main()\n{\n\tint 0;\n}\n";
+			ASSERT_EQUAL(document.getText(0, document.getLength()), expectedText);
+
+			ASSERT_EQUAL(edit.numBytesRemoved, (size_t)15);
+			ASSERT_EQUAL(edit.lineStart, (size_t)2);
+			ASSERT_EQUAL(edit.numLinesRemoved, (size_t)1);
+			ASSERT_EQUAL(document.getNumLines(), (size_t)5);
+			ASSERT_EQUAL(document.getLineStart(3), (size_t)21);
+
+			document.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(consecutiveInsertsShouldGrowOnePiece)
+		{
+			TextDocument document;
+			initDocument(document, originalText);
+
+			std::string typedText = "foo(bar);";
+			for (size_t i = 0; i < typedText.length(); i++)
+			{
+				insertString(document, 13 + i, typedText.substr(i, 1));
+			}
+
+			// The original text gets split once, then every keystroke extends the same piece
+			ASSERT_EQUAL(document.getNumPieces(), (size_t)3);
+			ASSERT_EQUAL(document.getText(13, typedText.length()), typedText);
+
+			document.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(iteratorShouldStepOverUtf8Codepoints)
+		{
+			TextDocument document;
+			// "aé中" -> 1 + 2 + 3 bytes
+			initDocument(document, "a\xC3\xA9\xE4\xB8\xAD");
+
+			TextDocumentIter iter = document.makeIter();
+			ASSERT_EQUAL(*iter, (uint32)'a');
+			++iter;
+			ASSERT_EQUAL(*iter, (uint32)0xE9);
+			++iter;
+			ASSERT_EQUAL(iter.bytePos, (size_t)3);
+			ASSERT_EQUAL(*iter, (uint32)0x4E2D);
+			++iter;
+			ASSERT_EQUAL(iter.bytePos, document.getLength());
+			--iter;
+			ASSERT_EQUAL(iter.bytePos, (size_t)3);
+			--iter;
+			ASSERT_EQUAL(iter.bytePos, (size_t)1);
+
+			document.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(flattenedTextShouldBePatchedAfterEdits)
+		{
+			TextDocument document;
+			initDocument(document, originalText);
+
+			// Builds the cached copy so the edits below have something to patch
+			ASSERT_EQUAL(std::string((const char*)document.getFlattenedText()), originalText);
+
+			insertString(document, 14, "int x = 1;\n\t");
+			ASSERT_EQUAL(std::string((const char*)document.getFlattenedText()), std::string("int main()\n{\n\tint x = 1;\n\treturn 0;\n}\n"));
+
+			document.remove(18, 15);
+			ASSERT_EQUAL(std::string((const char*)document.getFlattenedText()), std::string("int main()\n{\n\tint 0;\n}\n"));
+
+			// Several edits queued between two reads
+			insertString(document, 0, "// ");
+			document.remove(document.getLength() - 2, 2);
+			insertString(document, document.getLength(), "}");
+			std::string expectedText = "// int main()\n{\n\tint 0;\n}";
+			ASSERT_EQUAL(std::string((const char*)document.getFlattenedText()), expectedText);
+			ASSERT_EQUAL(document.getText(0, document.getLength()), expectedText);
+
+			document.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(randomEditsShouldMatchPlainString)
+		{
+			std::string expectedText = originalText;
+			TextDocument document;
+			initDocument(document, expectedText);
+
+			uint32 seed = 12345;
+			for (int i = 0; i < 2000; i++)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				size_t byteOffset = (seed >> 8) % (expectedText.length() + 1);
+				if ((seed & 3) != 0 || expectedText.length() == 0)
+				{
+					std::string text = (seed & 16) ? "ab" : "\nc";
+					insertString(document, byteOffset, text);
+					expectedText.insert(byteOffset, text);
+				}
+				else
+				{
+					byteOffset = glm::min(byteOffset, expectedText.length() - 1);
+					size_t numBytes = glm::min((size_t)((seed >> 4) % 6) + 1, expectedText.length() - byteOffset);
+					document.remove(byteOffset, numBytes);
+					expectedText.erase(byteOffset, numBytes);
+				}
+			}
+
+			ASSERT_EQUAL(document.getText(0, document.getLength()), expectedText);
+			ASSERT_EQUAL(document.getNumLines(), (size_t)std::count(expectedText.begin(), expectedText.end(), '\n') + 1);
+
+			size_t line = 0;
+			for (size_t byteOffset = 0; byteOffset < expectedText.length(); byteOffset++)
+			{
+				ASSERT_EQUAL(document.getLineFromByte(byteOffset), line);
+				if (expectedText[byteOffset] == '\n')
+				{
+					line++;
+					ASSERT_EQUAL(document.getLineStart(line), byteOffset + 1);
+				}
+			}
+
+			document.free();
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("TextDocument");
+
+			ADD_TEST(testSuite, lineIndexShouldMatchOriginalText);
+			ADD_TEST(testSuite, insertShouldUpdateTextAndLines);
+			ADD_TEST(testSuite, removeAcrossPiecesShouldUpdateTextAndLines);
+			ADD_TEST(testSuite, consecutiveInsertsShouldGrowOnePiece);
+			ADD_TEST(testSuite, iteratorShouldStepOverUtf8Codepoints);
+			ADD_TEST(testSuite, flattenedTextShouldBePatchedAfterEdits);
+			ADD_TEST(testSuite, randomEditsShouldMatchPlainString);
+		}
+
+		// -------------------- Private functions --------------------
+		static void initDocument(TextDocument& document, std::string const& text)
+		{
+			document.init((uint8 const*)text.c_str(), text.length());
+		}
+
+		static TextEdit insertString(TextDocument& document, size_t byteOffset, std::string const& text)
+		{
+			return document.insert(byteOffset, (uint8 const*)text.c_str(), text.length());
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,202 @@
+#ifdef _MATH_ANIM_TESTS
+#include "ThreadPoolTests.h"
+#include "multithreading/GlobalThreadPool.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace ThreadPoolTests
+	{
+		// -------------------- Constants --------------------
+		constexpr uint32 NUM_THREADS = 4;
+
+		struct NestedWaitData
+		{
+			GlobalThreadPool* pool;
+			std::atomic<bool> workerBusy;
+			std::atomic<bool> releaseWorker;
+			std::atomic<bool> outerCallbackRan;
+			std::atomic<bool> innerCallbackRan;
+			int nestedResult;
+		};
+
+		// -------------------- Private functions --------------------
+		static void emptyTask(void* data, size_t dataSize);
+		static void waitOnNestedTaskCallback(void* data, size_t dataSize);
+		static void markInnerCallbackRan(void* data, size_t dataSize);
+		static bool processFinishedTasksUntil(GlobalThreadPool& pool, const std::atomic<bool>& condition);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(submitShouldReturnTaskResult)
+		{
+			GlobalThreadPool pool(NUM_THREADS);
+
+			TaskHandle<int> handle = pool.submit([]() { return 21 * 2; });
+			ASSERT_EQUAL(handle.get(), 42);
+			ASSERT_TRUE(handle.isReady());
+
+			pool.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(thenShouldChainOnParentResult)
+		{
+			GlobalThreadPool pool(NUM_THREADS);
+
+			TaskHandle<int> result = pool.submit([]() { return 20; })
+				.then([](const int& value) { return value + 1; })
+				.then([](const int& value) { return value * 2; });
+			ASSERT_EQUAL(result.get(), 42);
+
+			pool.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(cancelledTaskShouldNeverRun)
+		{
+			GlobalThreadPool pool(1);
+
+			// Keep the only worker busy so the next task is still pending when we cancel it
+			std::atomic<bool> workerBusy = false;
+			std::atomic<bool> releaseWorker = false;
+			TaskHandle<void> blocker = pool.submit([&]()
+			{
+				workerBusy = true;
+				while (!releaseWorker)
+				{
+					std::this_thread::yield();
+				}
+			});
+			while (!workerBusy)
+			{
+				std::this_thread::yield();
+			}
+
+			std::atomic<bool> didRun = false;
+			TaskHandle<void> handle = pool.submit([&]() { didRun = true; });
+			TaskHandle<void> continuation = handle.then([&]() { didRun = true; });
+			ASSERT_TRUE(handle.cancel());
+
+			releaseWorker = true;
+			blocker.wait();
+			continuation.wait();
+			ASSERT_TRUE(handle.isCancelled());
+			ASSERT_TRUE(continuation.isCancelled());
+			ASSERT_FALSE(didRun);
+
+			pool.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(parallelForShouldVisitEveryIndexOnce)
+		{
+			GlobalThreadPool pool(NUM_THREADS);
+
+			constexpr size_t numElements = 10000;
+			std::vector<uint8> visited(numElements, 0);
+			pool.parallelFor(0, numElements, 64, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					visited[i]++;
+				}
+			});
+
+			for (size_t i = 0; i < numElements; i++)
+			{
+				ASSERT_EQUAL((int)visited[i], 1);
+			}
+
+			pool.free();
+			END_TEST;
+		}
+
+		DEFINE_TEST(finishedCallbackShouldBeAbleToWaitOnNestedTask)
+		{
+			GlobalThreadPool pool(1);
+
+			NestedWaitData data = {};
+			data.pool = &pool;
+			pool.queueTask(emptyTask, "Outer", &data, sizeof(NestedWaitData), Priority::None, waitOnNestedTaskCallback);
+
+			ASSERT_TRUE(processFinishedTasksUntil(pool, data.outerCallbackRan));
+			ASSERT_EQUAL(data.nestedResult, 42);
+			// Queued while the outer callback was running, so it shows up in a later call
+			ASSERT_TRUE(processFinishedTasksUntil(pool, data.innerCallbackRan));
+
+			pool.free();
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("ThreadPool");
+
+			ADD_TEST(testSuite, submitShouldReturnTaskResult);
+			ADD_TEST(testSuite, thenShouldChainOnParentResult);
+			ADD_TEST(testSuite, cancelledTaskShouldNeverRun);
+			ADD_TEST(testSuite, parallelForShouldVisitEveryIndexOnce);
+			ADD_TEST(testSuite, finishedCallbackShouldBeAbleToWaitOnNestedTask);
+		}
+
+		// -------------------- Private functions --------------------
+		static void emptyTask(void*, size_t)
+		{
+		}
+
+		static void waitOnNestedTaskCallback(void* data, size_t)
+		{
+			NestedWaitData* waitData = (NestedWaitData*)data;
+			GlobalThreadPool* pool = waitData->pool;
+
+			// Keep the only worker busy so nobody but this thread is around to run the
+			// nested task. This thread must still leave the inner task (which has a
+			// finished callback of its own) alone while it waits.
+			TaskHandle<void> blocker = pool->submit([waitData]()
+			{
+				waitData->workerBusy = true;
+				while (!waitData->releaseWorker)
+				{
+					std::this_thread::yield();
+				}
+			});
+			while (!waitData->workerBusy)
+			{
+				std::this_thread::yield();
+			}
+
+			pool->queueTask(emptyTask, "Inner", data, sizeof(NestedWaitData), Priority::High, markInnerCallbackRan);
+			TaskHandle<int> nested = pool->submit([]() { return 42; }, "Nested", Priority::None);
+			waitData->nestedResult = nested.get();
+
+			waitData->releaseWorker = true;
+			blocker.wait();
+			waitData->outerCallbackRan = true;
+		}
+
+		static void markInnerCallbackRan(void* data, size_t)
+		{
+			((NestedWaitData*)data)->innerCallbackRan = true;
+		}
+
+		static bool processFinishedTasksUntil(GlobalThreadPool& pool, const std::atomic<bool>& condition)
+		{
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (!condition)
+			{
+				if (std::chrono::steady_clock::now() > deadline)
+				{
+					return false;
+				}
+
+				pool.processFinishedTasks();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			return true;
+		}
+	}
+}
+
+#endif
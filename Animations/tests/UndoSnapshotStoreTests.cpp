@@ -0,0 +1,138 @@
+#ifdef _MATH_ANIM_TESTS
+#include "UndoSnapshotStoreTests.h"
+#include "editor/UndoSnapshotStore.h"
+#include "multithreading/GlobalThreadPool.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace UndoSnapshotStoreTests
+	{
+		// -------------------- Constants --------------------
+		constexpr uint32 NUM_THREADS = 2;
+		constexpr size_t SNAPSHOT_SIZE = 64 * 1024;
+
+		// -------------------- Private functions --------------------
+		static std::vector<uint8> makeSnapshot(uint8 seed);
+		static std::filesystem::path getSpillDir();
+		static bool updateUntilCompressed(UndoSnapshotStore* store);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(snapshotShouldRoundTripCompressed)
+		{
+			UndoSnapshotStore* store = UndoSnapshots::init(nullptr, SIZE_MAX, getSpillDir());
+
+			UndoSnapshotId id = UndoSnapshots::add(store, makeSnapshot(1));
+			UndoSnapshotStats stats = UndoSnapshots::getStats(store);
+			ASSERT_EQUAL(stats.numSnapshots, (size_t)1);
+			ASSERT_EQUAL(stats.uncompressedBytes, SNAPSHOT_SIZE);
+			ASSERT_TRUE(stats.memoryBytes < SNAPSHOT_SIZE);
+			ASSERT_EQUAL(stats.diskBytes, (size_t)0);
+
+			std::vector<uint8> loaded = {};
+			ASSERT_TRUE(UndoSnapshots::load(store, id, loaded));
+			ASSERT_TRUE(loaded == makeSnapshot(1));
+
+			UndoSnapshots::release(store, id);
+			ASSERT_EQUAL(UndoSnapshots::getTotalBytes(store), (size_t)0);
+			ASSERT_TRUE(!UndoSnapshots::load(store, id, loaded));
+
+			UndoSnapshots::free(store);
+			END_TEST;
+		}
+
+		DEFINE_TEST(oldestSnapshotsShouldSpillOverBudget)
+		{
+			UndoSnapshotStore* store = UndoSnapshots::init(nullptr, 0, getSpillDir());
+
+			UndoSnapshotId first = UndoSnapshots::add(store, makeSnapshot(1));
+			UndoSnapshotId second = UndoSnapshots::add(store, makeSnapshot(2));
+			UndoSnapshotStats stats = UndoSnapshots::getStats(store);
+			ASSERT_EQUAL(stats.numSpilledSnapshots, (size_t)2);
+			ASSERT_EQUAL(stats.memoryBytes, (size_t)0);
+			ASSERT_TRUE(stats.diskBytes > 0);
+
+			std::vector<uint8> loaded = {};
+			ASSERT_TRUE(UndoSnapshots::load(store, first, loaded));
+			ASSERT_TRUE(loaded == makeSnapshot(1));
+			ASSERT_TRUE(UndoSnapshots::load(store, second, loaded));
+			ASSERT_TRUE(loaded == makeSnapshot(2));
+
+			UndoSnapshots::release(store, first);
+			UndoSnapshots::release(store, second);
+			ASSERT_EQUAL(UndoSnapshots::getTotalBytes(store), (size_t)0);
+
+			UndoSnapshots::free(store);
+			std::filesystem::remove_all(getSpillDir());
+			END_TEST;
+		}
+
+		DEFINE_TEST(backgroundCompressionShouldBeLoadableWhilePending)
+		{
+			GlobalThreadPool pool(NUM_THREADS);
+			UndoSnapshotStore* store = UndoSnapshots::init(&pool, SIZE_MAX, getSpillDir());
+
+			UndoSnapshotId id = UndoSnapshots::add(store, makeSnapshot(3));
+			std::vector<uint8> loaded = {};
+			ASSERT_TRUE(UndoSnapshots::load(store, id, loaded));
+			ASSERT_TRUE(loaded == makeSnapshot(3));
+
+			ASSERT_TRUE(updateUntilCompressed(store));
+			ASSERT_TRUE(UndoSnapshots::getStats(store).memoryBytes < SNAPSHOT_SIZE);
+			ASSERT_TRUE(UndoSnapshots::load(store, id, loaded));
+			ASSERT_TRUE(loaded == makeSnapshot(3));
+
+			UndoSnapshots::free(store);
+			pool.free();
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("UndoSnapshotStore");
+
+			ADD_TEST(testSuite, snapshotShouldRoundTripCompressed);
+			ADD_TEST(testSuite, oldestSnapshotsShouldSpillOverBudget);
+			ADD_TEST(testSuite, backgroundCompressionShouldBeLoadableWhilePending);
+		}
+
+		// -------------------- Private functions --------------------
+		// Repetitive enough to compress, but not so uniform that a bad decode could still match
+		static std::vector<uint8> makeSnapshot(uint8 seed)
+		{
+			std::vector<uint8> res = {};
+			res.resize(SNAPSHOT_SIZE);
+			for (size_t i = 0; i < res.size(); i++)
+			{
+				res[i] = (uint8)((i / 64) + seed);
+			}
+
+			return res;
+		}
+
+		static std::filesystem::path getSpillDir()
+		{
+			return std::filesystem::temp_directory_path() / "MathAnimUndoSnapshotTests";
+		}
+
+		static bool updateUntilCompressed(UndoSnapshotStore* store)
+		{
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (UndoSnapshots::getStats(store).numPendingCompressions > 0)
+			{
+				if (std::chrono::steady_clock::now() > deadline)
+				{
+					return false;
+				}
+
+				UndoSnapshots::update(store);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			return true;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,164 @@
+#ifdef _MATH_ANIM_TESTS
+#include "WavLoaderTests.h"
+#include "audio/WavLoader.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace WavLoaderTests
+	{
+		// -------------------- Private functions --------------------
+		static void writeU16(std::vector<uint8>& file, uint16 value);
+		static void writeU32(std::vector<uint8>& file, uint32 value);
+		static void writeChunk(std::vector<uint8>& file, const char* id, std::vector<uint8> const& data);
+		static std::vector<uint8> makeFormatChunk(uint16 formatTag, uint16 numChannels, uint32 sampleRate, uint16 bitsPerSample, uint16 subFormatTag = 0);
+		static std::vector<uint8> makeWavFile(std::vector<std::pair<const char*, std::vector<uint8>>> const& chunks);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(parseShouldSkipUnknownChunks)
+		{
+			std::vector<uint8> samples(4 * 2 * sizeof(float), 0);
+			float firstSample = -0.5f;
+			g_memory_copyMem(samples.data(), samples.size(), &firstSample, sizeof(float));
+
+			// Odd sized LIST chunk to make sure the padding byte gets skipped too
+			std::vector<uint8> file = makeWavFile({
+				{ "LIST", { 'I', 'N', 'F' } },
+				{ "fmt ", makeFormatChunk(0xFFFE, 2, 48'000, 32, 0x0003) },
+				{ "fact", { 4, 0, 0, 0 } },
+				{ "data", samples },
+			});
+
+			WavData wav = {};
+			ASSERT_TRUE(WavLoader::parse(file.data(), file.size(), wav));
+			ASSERT_TRUE(wav.sampleFormat == WavSampleFormat::Float32);
+			ASSERT_TRUE(wav.audioChannelType == AudioChannelType::Dual);
+			ASSERT_EQUAL(wav.sampleRate, (uint32)48'000);
+			ASSERT_EQUAL(wav.blockAlignment, (uint16)8);
+			ASSERT_EQUAL(wav.dataSize, (uint32)samples.size());
+			ASSERT_TRUE(wav.audioData == file.data() + file.size() - samples.size());
+			ASSERT_EQUAL(WavLoader::readSample(wav.audioData, wav.sampleFormat), (int16)(-0.5f * INT16_MAX));
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(parseShouldTrimTruncatedData)
+		{
+			// 24 bit mono that claims 10 frames but only has 2 and a half
+			std::vector<uint8> file = makeWavFile({
+				{ "fmt ", makeFormatChunk(0x0001, 1, 44'100, 24) },
+			});
+			file.insert(file.end(), { 'd', 'a', 't', 'a' });
+			writeU32(file, 30);
+			file.insert(file.end(), { 0x00, 0x00, 0x80, 0xFF, 0xFF, 0x7F, 0x12, 0x34 });
+
+			WavData wav = {};
+			ASSERT_TRUE(WavLoader::parse(file.data(), file.size(), wav));
+			ASSERT_TRUE(wav.sampleFormat == WavSampleFormat::Int24);
+			ASSERT_EQUAL(wav.dataSize, (uint32)6);
+			ASSERT_EQUAL(WavLoader::readSample(wav.audioData, wav.sampleFormat), (int16)INT16_MIN);
+			ASSERT_EQUAL(WavLoader::readSample(wav.audioData + 3, wav.sampleFormat), (int16)INT16_MAX);
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(parseShouldRejectBadFiles)
+		{
+			WavData wav = {};
+
+			std::vector<uint8> notAWav = { 'R', 'I', 'F', 'X', 0, 0, 0, 0, 'W', 'A', 'V', 'E' };
+			ASSERT_TRUE(!WavLoader::parse(notAWav.data(), notAWav.size(), wav));
+
+			std::vector<uint8> dataBeforeFormat = makeWavFile({
+				{ "data", { 0, 0 } },
+				{ "fmt ", makeFormatChunk(0x0001, 1, 44'100, 16) },
+			});
+			ASSERT_TRUE(!WavLoader::parse(dataBeforeFormat.data(), dataBeforeFormat.size(), wav));
+
+			std::vector<uint8> tooManyChannels = makeWavFile({
+				{ "fmt ", makeFormatChunk(0x0001, 6, 44'100, 16) },
+				{ "data", std::vector<uint8>(12, 0) },
+			});
+			ASSERT_TRUE(!WavLoader::parse(tooManyChannels.data(), tooManyChannels.size(), wav));
+			ASSERT_TRUE(wav.audioData == nullptr);
+
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("WavLoader");
+
+			ADD_TEST(testSuite, parseShouldSkipUnknownChunks);
+			ADD_TEST(testSuite, parseShouldTrimTruncatedData);
+			ADD_TEST(testSuite, parseShouldRejectBadFiles);
+		}
+
+		// -------------------- Private functions --------------------
+		static void writeU16(std::vector<uint8>& file, uint16 value)
+		{
+			file.push_back((uint8)(value & 0xFF));
+			file.push_back((uint8)(value >> 8));
+		}
+
+		static void writeU32(std::vector<uint8>& file, uint32 value)
+		{
+			writeU16(file, (uint16)(value & 0xFFFF));
+			writeU16(file, (uint16)(value >> 16));
+		}
+
+		static void writeChunk(std::vector<uint8>& file, const char* id, std::vector<uint8> const& data)
+		{
+			file.insert(file.end(), id, id + 4);
+			writeU32(file, (uint32)data.size());
+			file.insert(file.end(), data.begin(), data.end());
+			if (data.size() % 2 == 1)
+			{
+				file.push_back(0);
+			}
+		}
+
+		static std::vector<uint8> makeFormatChunk(uint16 formatTag, uint16 numChannels, uint32 sampleRate, uint16 bitsPerSample, uint16 subFormatTag)
+		{
+			uint16 blockAlignment = (uint16)(numChannels * bitsPerSample / 8);
+
+			std::vector<uint8> res = {};
+			writeU16(res, formatTag);
+			writeU16(res, numChannels);
+			writeU32(res, sampleRate);
+			writeU32(res, sampleRate * blockAlignment);
+			writeU16(res, blockAlignment);
+			writeU16(res, bitsPerSample);
+			if (formatTag == 0xFFFE)
+			{
+				// cbSize, valid bits and channel mask
+				writeU16(res, 22);
+				writeU16(res, bitsPerSample);
+				writeU32(res, 0x3);
+				// Only the first two bytes of the subformat GUID matter
+				writeU16(res, subFormatTag);
+				res.insert(res.end(), 14, 0);
+			}
+
+			return res;
+		}
+
+		static std::vector<uint8> makeWavFile(std::vector<std::pair<const char*, std::vector<uint8>>> const& chunks)
+		{
+			std::vector<uint8> body = {};
+			for (auto const& [id, data] : chunks)
+			{
+				writeChunk(body, id, data);
+			}
+
+			std::vector<uint8> res = { 'R', 'I', 'F', 'F' };
+			writeU32(res, (uint32)(body.size() + 4));
+			res.insert(res.end(), { 'W', 'A', 'V', 'E' });
+			res.insert(res.end(), body.begin(), body.end());
+			return res;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifdef _MATH_ANIM_TESTS
+#include "WaveformPyramidTests.h"
+#include "audio/WaveformPyramid.h"
+#include "audio/WavLoader.h"
+
+using namespace CppUtils;
+
+namespace MathAnim
+{
+	namespace WaveformPyramidTests
+	{
+		// -------------------- Constants --------------------
+		// Not a multiple of any bucket size so every level ends on a partial bucket
+		constexpr uint64 NUM_SAMPLES = 100'003;
+		constexpr uint16 NUM_CHANNELS = 2;
+
+		// -------------------- Private functions --------------------
+		static std::vector<int16> makeSamples();
+		static WaveformPyramid buildPyramid(std::vector<int16> const& samples);
+
+		// -------------------- Tests --------------------
+		DEFINE_TEST(everyLevelShouldMatchTheRawSamples)
+		{
+			std::vector<int16> samples = makeSamples();
+			WaveformPyramid pyramid = buildPyramid(samples);
+			ASSERT_EQUAL(pyramid.numSamples, NUM_SAMPLES);
+			ASSERT_EQUAL(pyramid.levels.size(), (size_t)Waveform::numLevels);
+
+			for (WaveformLevel const& level : pyramid.levels)
+			{
+				ASSERT_EQUAL(level.buckets.size(), (size_t)((NUM_SAMPLES + level.samplesPerBucket - 1) / level.samplesPerBucket));
+
+				for (size_t bucket = 0; bucket < level.buckets.size(); bucket++)
+				{
+					int16 expectedMin = INT16_MAX;
+					int16 expectedMax = INT16_MIN;
+					uint64 end = glm::min((uint64)(bucket + 1) * level.samplesPerBucket, NUM_SAMPLES);
+					for (uint64 sample = (uint64)bucket * level.samplesPerBucket; sample < end; sample++)
+					{
+						for (uint16 channel = 0; channel < NUM_CHANNELS; channel++)
+						{
+							expectedMin = glm::min(expectedMin, samples[sample * NUM_CHANNELS + channel]);
+							expectedMax = glm::max(expectedMax, samples[sample * NUM_CHANNELS + channel]);
+						}
+					}
+
+					ASSERT_EQUAL(level.buckets[bucket].min, expectedMin);
+					ASSERT_EQUAL(level.buckets[bucket].max, expectedMax);
+				}
+			}
+
+			END_TEST;
+		}
+
+		DEFINE_TEST(zoomingOutShouldPickCoarserLevels)
+		{
+			WaveformPyramid pyramid = buildPyramid(makeSamples());
+
+			ASSERT_EQUAL(Waveform::chooseLevel(pyramid, 10.0)->samplesPerBucket, Waveform::finestSamplesPerBucket);
+			ASSERT_EQUAL(Waveform::chooseLevel(pyramid, 5'000.0)->samplesPerBucket, Waveform::finestSamplesPerBucket * Waveform::branchFactor);
+			ASSERT_EQUAL(Waveform::chooseLevel(pyramid, 1'000'000.0)->samplesPerBucket, Waveform::finestSamplesPerBucket * Waveform::branchFactor * Waveform::branchFactor);
+
+			// Ranges past the end of the track are silent
+			WaveformBucket pastEnd = Waveform::getRange(pyramid.levels[0], NUM_SAMPLES + 1'000, NUM_SAMPLES + 2'000);
+			ASSERT_EQUAL(pastEnd.min, (int16)0);
+			ASSERT_EQUAL(pastEnd.max, (int16)0);
+
+			WaveformPyramid empty = Waveform::build(nullptr, 0, WavSampleFormat::Int16, 4, 2, 44'100);
+			ASSERT_TRUE(Waveform::chooseLevel(empty, 100.0) == nullptr);
+
+			END_TEST;
+		}
+
+		void setupTestSuite()
+		{
+			Tests::TestSuite& testSuite = Tests::addTestSuite("WaveformPyramid");
+
+			ADD_TEST(testSuite, everyLevelShouldMatchTheRawSamples);
+			ADD_TEST(testSuite, zoomingOutShouldPickCoarserLevels);
+		}
+
+		// -------------------- Private functions --------------------
+		// Interleaved stereo where the right channel is always quieter than the left
+		static std::vector<int16> makeSamples()
+		{
+			std::vector<int16> res = {};
+			res.resize(NUM_SAMPLES * NUM_CHANNELS);
+			for (uint64 i = 0; i < NUM_SAMPLES; i++)
+			{
+				int16 left = (int16)(((int64)(i * 7919) % 65536) - 32768);
+				res[i * NUM_CHANNELS + 0] = left;
+				res[i * NUM_CHANNELS + 1] = (int16)(left / 2);
+			}
+
+			return res;
+		}
+
+		static WaveformPyramid buildPyramid(std::vector<int16> const& samples)
+		{
+			return Waveform::build(
+				(uint8 const*)samples.data(),
+				samples.size() * sizeof(int16),
+				WavSampleFormat::Int16,
+				NUM_CHANNELS * sizeof(int16),
+				NUM_CHANNELS,
+				44'100
+			);
+		}
+	}
+}
+
+#endif
@@ -1,8 +1,18 @@
 #ifdef _MATH_ANIM_TESTS
 #include "LRUCacheTests.h"
 #include "AnimationManagerTests.h"
+#include "BinarySceneTests.h"
 #include "SyntaxHighlighterTests.h"
 #include "SyntaxThemeTests.h"
+#include "ThreadPoolTests.h"
+#include "AtlasAllocatorTests.h"
+#include "TextDocumentTests.h"
+#include "UndoSnapshotStoreTests.h"
+#include "FileSystemWatcherTests.h"
+#include "WaveformPyramidTests.h"
+#include "WavLoaderTests.h"
+#include "SvgTests.h"
+#include "PhysicsTests.h"
 
 #include <cppUtils/cppTests.hpp>
 #include <cppUtils/cppUtils.hpp>
@@ -18,8 +28,18 @@ int main()
 
 	LRUCacheTests::setupTestSuite();
 	AnimationManagerTests::setupTestSuite();
+	BinarySceneTests::setupTestSuite();
 	SyntaxHighlighterTests::setupTestSuite();
 	SyntaxThemeTests::setupTestSuite();
+	ThreadPoolTests::setupTestSuite();
+	AtlasAllocatorTests::setupTestSuite();
+	TextDocumentTests::setupTestSuite();
+	UndoSnapshotStoreTests::setupTestSuite();
+	FileSystemWatcherTests::setupTestSuite();
+	WaveformPyramidTests::setupTestSuite();
+	WavLoaderTests::setupTestSuite();
+	SvgTests::setupTestSuite();
+	PhysicsTests::setupTestSuite();
 
 	Tests::runTests();
 	Tests::free();